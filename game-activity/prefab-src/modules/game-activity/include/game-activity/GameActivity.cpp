@@ -939,6 +939,14 @@ static void onTextInput_native(JNIEnv *env, jobject activity, jlong handle,
     GameTextInput_processEvent(code->gameTextInput, textInputEvent);
 }
 
+static jboolean onTextInputDelta_native(JNIEnv *env, jobject activity,
+                                        jlong handle, jobject textInputDelta) {
+    if (handle == 0) return false;
+    NativeCode *code = (NativeCode *)handle;
+    return GameTextInput_processDeltaEvent(code->gameTextInput,
+                                           textInputDelta);
+}
+
 static void onWindowInsetsChanged_native(JNIEnv *env, jobject activity,
                                          jlong handle) {
     if (handle == 0) return;
@@ -1060,6 +1068,9 @@ static const JNINativeMethod g_methods[] = {
     {"onTextInputEventNative",
      "(JLcom/google/androidgamesdk/gametextinput/State;)V",
      (void *)onTextInput_native},
+    {"onTextInputDeltaEventNative",
+     "(JLcom/google/androidgamesdk/gametextinput/StateDelta;)Z",
+     (void *)onTextInputDelta_native},
     {"onWindowInsetsChangedNative", "(J)V",
      (void *)onWindowInsetsChanged_native},
     {"setInputConnectionNative",
@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+/**
+ * @cond INTERNAL
+ *
+ * The mailbox through which the main thread sends APP_CMD_* commands to the
+ * game thread, used by android_native_app_glue.
+ *
+ * Commands are posted to a bounded lock-free queue, so posting only waits for
+ * the game thread when the queue is full: android_cmd_mailbox_post then fails,
+ * and android_native_app_glue retries every millisecond, holding
+ * android_app->mutex, until the game thread reads a command. Reading frees a
+ * slot before the game thread takes that mutex, so this can't deadlock.
+ *
+ * Each queued command is signalled on an eventfd in semaphore mode, which the
+ * game thread's ALooper watches: the counter never exceeds the number of
+ * queued commands, so a read of the eventfd is always followed by a successful
+ * pop. With several posting threads, the command at the head may still be
+ * being written by another thread when a later one is signalled, so the pop
+ * then waits for it.
+ *
+ * Commands that only report that some state changed, like
+ * APP_CMD_CONTENT_RECT_CHANGED, can be coalesced: while one is queued and not
+ * yet read, posting it again does nothing. The bit of a command is cleared when
+ * it's read, before it's processed, so a change made after that is always
+ * followed by a new command.
+ *
+ * This has no Android dependency, so that it can be tested on any Linux host.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+/** Number of commands that can be queued, a power of 2. */
+#define ANDROID_CMD_MAILBOX_SIZE 64
+
+struct android_cmd_mailbox_slot {
+    /**
+     * Equal to the position of the next push into the slot when it's free, and
+     * to that position plus 1 once the command is written.
+     */
+    uint32_t sequence;
+    int8_t cmd;
+};
+
+struct android_cmd_mailbox {
+    /** Eventfd counting the queued commands. */
+    int eventFd;
+    /** Bit (1 << cmd) is set while a coalesced cmd is queued. */
+    uint32_t coalescedPending;
+    /** Position of the next push, shared by the posting threads. */
+    uint32_t tail;
+    /** Position of the next pop, only used by the reading thread. */
+    uint32_t head;
+    struct android_cmd_mailbox_slot slots[ANDROID_CMD_MAILBOX_SIZE];
+};
+
+/** Returns false, with errno set, if the eventfd can't be created. */
+static inline bool android_cmd_mailbox_init(
+    struct android_cmd_mailbox* mailbox) {
+    mailbox->coalescedPending = 0;
+    mailbox->tail = 0;
+    mailbox->head = 0;
+    for (uint32_t i = 0; i < ANDROID_CMD_MAILBOX_SIZE; ++i) {
+        mailbox->slots[i].sequence = i;
+        mailbox->slots[i].cmd = 0;
+    }
+    mailbox->eventFd = eventfd(0, EFD_CLOEXEC | EFD_SEMAPHORE);
+    return mailbox->eventFd >= 0;
+}
+
+static inline void android_cmd_mailbox_destroy(
+    struct android_cmd_mailbox* mailbox) {
+    if (mailbox->eventFd >= 0) close(mailbox->eventFd);
+    mailbox->eventFd = -1;
+}
+
+/**
+ * Queue a command and wake the reading thread, from any thread. If coalesce is
+ * true and the same command is already queued, nothing is done.
+ * @return false if the queue is full.
+ */
+static inline bool android_cmd_mailbox_post(
+    struct android_cmd_mailbox* mailbox, int8_t cmd, bool coalesce) {
+    uint32_t bit = 1u << (cmd & 31);
+    if (coalesce && (__atomic_fetch_or(&mailbox->coalescedPending, bit,
+                                       __ATOMIC_ACQ_REL) &
+                     bit)) {
+        return true;
+    }
+
+    uint32_t position = __atomic_load_n(&mailbox->tail, __ATOMIC_RELAXED);
+    struct android_cmd_mailbox_slot* slot;
+    for (;;) {
+        slot = &mailbox->slots[position & (ANDROID_CMD_MAILBOX_SIZE - 1)];
+        uint32_t sequence =
+            __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        int32_t difference = (int32_t)(sequence - position);
+        if (difference == 0) {
+            if (__atomic_compare_exchange_n(&mailbox->tail, &position,
+                                            position + 1, true,
+                                            __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (difference < 0) {
+            if (coalesce) {
+                __atomic_fetch_and(&mailbox->coalescedPending, ~bit,
+                                   __ATOMIC_ACQ_REL);
+            }
+            return false;
+        } else {
+            position = __atomic_load_n(&mailbox->tail, __ATOMIC_RELAXED);
+        }
+    }
+    slot->cmd = cmd;
+    __atomic_store_n(&slot->sequence, position + 1, __ATOMIC_RELEASE);
+
+    uint64_t one = 1;
+    while (write(mailbox->eventFd, &one, sizeof(one)) < 0 && errno == EINTR) {
+    }
+    return true;
+}
+
+/**
+ * Forget which coalesced commands are queued, so that the next post of each is
+ * queued after the commands already there. Call this before posting a command
+ * that changes what the coalesced ones refer to, like a new window.
+ */
+static inline void android_cmd_mailbox_reset_coalescing(
+    struct android_cmd_mailbox* mailbox) {
+    __atomic_store_n(&mailbox->coalescedPending, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * Read the next command, from the single reading thread, waiting for one if
+ * the queue is empty.
+ * @return the command, or -1 on error.
+ */
+static inline int8_t android_cmd_mailbox_read(
+    struct android_cmd_mailbox* mailbox) {
+    uint64_t count;
+    ssize_t result;
+    do {
+        result = read(mailbox->eventFd, &count, sizeof(count));
+    } while (result < 0 && errno == EINTR);
+    if (result != sizeof(count)) return -1;
+
+    uint32_t position = mailbox->head;
+    struct android_cmd_mailbox_slot* slot =
+        &mailbox->slots[position & (ANDROID_CMD_MAILBOX_SIZE - 1)];
+    // Slots are written right after being claimed, so this is short.
+    while (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != position + 1) {
+        sched_yield();
+    }
+    int8_t cmd = slot->cmd;
+    __atomic_store_n(&slot->sequence, position + ANDROID_CMD_MAILBOX_SIZE,
+                     __ATOMIC_RELEASE);
+    mailbox->head = position + 1;
+    __atomic_fetch_and(&mailbox->coalescedPending, ~(1u << (cmd & 31)),
+                       __ATOMIC_ACQ_REL);
+    return cmd;
+}
+
+/**
+ * Initialize a condition variable whose timed waits use CLOCK_MONOTONIC, for
+ * android_cmd_mailbox_wait.
+ */
+static inline void android_cmd_mailbox_cond_init(pthread_cond_t* cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/**
+ * Deadline, on CLOCK_MONOTONIC, of a wait of timeoutNanos from now, or -1 to
+ * wait without deadline if timeoutNanos is negative.
+ */
+static inline int64_t android_cmd_mailbox_deadline(int64_t timeoutNanos) {
+    if (timeoutNanos < 0) return -1;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec + timeoutNanos;
+}
+
+/**
+ * Wait on a condition variable initialized by android_cmd_mailbox_cond_init,
+ * with its mutex locked, until it's signalled or the deadline passes.
+ * @return false if the deadline has passed.
+ */
+static inline bool android_cmd_mailbox_wait(pthread_cond_t* cond,
+                                            pthread_mutex_t* mutex,
+                                            int64_t deadline) {
+    if (deadline < 0) {
+        pthread_cond_wait(cond, mutex);
+        return true;
+    }
+    struct timespec until;
+    until.tv_sec = (time_t)(deadline / 1000000000LL);
+    until.tv_nsec = (long)(deadline % 1000000000LL);
+    return pthread_cond_timedwait(cond, mutex, &until) != ETIMEDOUT;
+}
+
+/** @endcond */
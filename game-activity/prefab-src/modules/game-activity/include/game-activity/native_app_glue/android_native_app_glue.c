@@ -63,9 +63,9 @@ static void free_saved_state(struct android_app* android_app) {
 }
 
 int8_t android_app_read_cmd(struct android_app* android_app) {
-    int8_t cmd;
-    if (read(android_app->msgread, &cmd, sizeof(cmd)) != sizeof(cmd)) {
-        LOGE("No data on command pipe!");
+    int8_t cmd = android_cmd_mailbox_read(&android_app->cmdMailbox);
+    if (cmd < 0) {
+        LOGE("No data on command mailbox!");
         return -1;
     }
     if (cmd == APP_CMD_SAVE_STATE) free_saved_state(android_app);
@@ -224,7 +224,7 @@ static void* android_app_entry(void* param) {
     android_app->cmdPollSource.process = process_cmd;
 
     ALooper* looper = ALooper_prepare(ALOOPER_PREPARE_ALLOW_NON_CALLBACKS);
-    ALooper_addFd(looper, android_app->msgread, LOOPER_ID_MAIN,
+    ALooper_addFd(looper, android_app->cmdMailbox.eventFd, LOOPER_ID_MAIN,
                   ALOOPER_EVENT_INPUT, NULL, &android_app->cmdPollSource);
     android_app->looper = looper;
 
@@ -281,7 +281,8 @@ static struct android_app* android_app_create(GameActivity* activity,
     android_app->activity = activity;
 
     pthread_mutex_init(&android_app->mutex, NULL);
-    pthread_cond_init(&android_app->cond, NULL);
+    android_cmd_mailbox_cond_init(&android_app->cond);
+    android_app->cmdAckTimeoutNanos = NATIVE_APP_GLUE_CMD_ACK_TIMEOUT_INFINITE;
 
     if (savedState != NULL) {
         android_app->savedState = malloc(savedStateSize);
@@ -289,13 +290,10 @@ static struct android_app* android_app_create(GameActivity* activity,
         memcpy(android_app->savedState, savedState, savedStateSize);
     }
 
-    int msgpipe[2];
-    if (pipe(msgpipe)) {
-        LOGE("could not create pipe: %s", strerror(errno));
+    if (!android_cmd_mailbox_init(&android_app->cmdMailbox)) {
+        LOGE("could not create command mailbox: %s", strerror(errno));
         return NULL;
     }
-    android_app->msgread = msgpipe[0];
-    android_app->msgwrite = msgpipe[1];
 
     android_app->keyEventFilter = default_key_filter;
     android_app->motionEventFilter = default_motion_filter;
@@ -316,12 +314,53 @@ static struct android_app* android_app_create(GameActivity* activity,
     return android_app;
 }
 
+// Commands that only report a change of state that the game thread reads when
+// handling them, so that one queued command is enough for several changes.
+static bool android_app_is_coalesced_cmd(int8_t cmd) {
+    switch (cmd) {
+        case APP_CMD_WINDOW_RESIZED:
+        case APP_CMD_WINDOW_REDRAW_NEEDED:
+        case APP_CMD_CONTENT_RECT_CHANGED:
+        case APP_CMD_SOFTWARE_KB_VIS_CHANGED:
+        case APP_CMD_CONFIG_CHANGED:
+        case APP_CMD_LOW_MEMORY:
+        case APP_CMD_WINDOW_INSETS_CHANGED:
+        case APP_CMD_KEY_EVENT:
+        case APP_CMD_TOUCH_EVENT:
+            return true;
+        default:
+            return false;
+    }
+}
+
 static void android_app_write_cmd(struct android_app* android_app, int8_t cmd) {
-    if (write(android_app->msgwrite, &cmd, sizeof(cmd)) != sizeof(cmd)) {
-        LOGE("Failure writing android_app cmd: %s", strerror(errno));
+    bool coalesce = android_app_is_coalesced_cmd(cmd);
+    if (!coalesce) {
+        // Changes reported after this command, like the size of a new
+        // window, must be reported after it.
+        android_cmd_mailbox_reset_coalescing(&android_app->cmdMailbox);
+    }
+    // The mailbox is only full if the game thread hasn't read commands for a
+    // long time. Wait for room, as a write to a full pipe would.
+    bool logged = false;
+    while (!android_cmd_mailbox_post(&android_app->cmdMailbox, cmd,
+                                     coalesce)) {
+        if (!logged) {
+            LOGW("android_app command mailbox full, waiting for cmd %d", cmd);
+            logged = true;
+        }
+        usleep(1000);
     }
 }
 
+// Waits, with the mutex locked, for the game thread to signal the condition.
+// Returns false once the deadline from android_cmd_mailbox_deadline passed.
+static bool android_app_wait_locked(struct android_app* android_app,
+                                    int64_t deadline) {
+    return android_cmd_mailbox_wait(&android_app->cond, &android_app->mutex,
+                                    deadline);
+}
+
 static void android_app_set_window(struct android_app* android_app,
                                    ANativeWindow* window) {
     LOGV("android_app_set_window called");
@@ -333,6 +372,9 @@ static void android_app_set_window(struct android_app* android_app,
     if (window != NULL) {
         android_app_write_cmd(android_app, APP_CMD_INIT_WINDOW);
     }
+    // Not bounded by cmdAckTimeoutNanos: the surface of a terminated window is
+    // destroyed as soon as this returns, so the game thread must be done with
+    // it.
     while (android_app->window != android_app->pendingWindow) {
         pthread_cond_wait(&android_app->cond, &android_app->mutex);
     }
@@ -343,12 +385,24 @@ static void android_app_set_activity_state(struct android_app* android_app,
                                            int8_t cmd) {
     pthread_mutex_lock(&android_app->mutex);
     android_app_write_cmd(android_app, cmd);
+    int64_t deadline =
+        android_cmd_mailbox_deadline(android_app->cmdAckTimeoutNanos);
     while (android_app->activityState != cmd) {
-        pthread_cond_wait(&android_app->cond, &android_app->mutex);
+        if (!android_app_wait_locked(android_app, deadline)) {
+            LOGW("activityState=%d not acknowledged before the timeout", cmd);
+            break;
+        }
     }
     pthread_mutex_unlock(&android_app->mutex);
 }
 
+void android_app_set_cmd_ack_timeout(struct android_app* android_app,
+                                     int64_t timeoutNanos) {
+    pthread_mutex_lock(&android_app->mutex);
+    android_app->cmdAckTimeoutNanos = timeoutNanos;
+    pthread_mutex_unlock(&android_app->mutex);
+}
+
 static void android_app_free(struct android_app* android_app) {
     int input_buf_idx = 0;
 
@@ -367,8 +421,7 @@ static void android_app_free(struct android_app* android_app) {
         free(buf->keyEvents);
     }
 
-    close(android_app->msgread);
-    close(android_app->msgwrite);
+    android_cmd_mailbox_destroy(&android_app->cmdMailbox);
     pthread_cond_destroy(&android_app->cond);
     pthread_mutex_destroy(&android_app->mutex);
     free(android_app);
@@ -403,11 +456,17 @@ static void onSaveInstanceState(GameActivity* activity,
     pthread_mutex_lock(&android_app->mutex);
     android_app->stateSaved = 0;
     android_app_write_cmd(android_app, APP_CMD_SAVE_STATE);
+    int64_t deadline =
+        android_cmd_mailbox_deadline(android_app->cmdAckTimeoutNanos);
     while (!android_app->stateSaved) {
-        pthread_cond_wait(&android_app->cond, &android_app->mutex);
+        if (!android_app_wait_locked(android_app, deadline)) {
+            // The state will be freed when the command is read or on resume.
+            LOGW("APP_CMD_SAVE_STATE not acknowledged before the timeout");
+            break;
+        }
     }
 
-    if (android_app->savedState != NULL) {
+    if (android_app->stateSaved && android_app->savedState != NULL) {
         // Tell the Java side about our state.
         recallback((const char*)android_app->savedState,
                    android_app->savedStateSize, context);
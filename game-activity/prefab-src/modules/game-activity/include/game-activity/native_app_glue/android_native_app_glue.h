@@ -29,6 +29,7 @@
 #include <sched.h>
 
 #include "game-activity/GameActivity.h"
+#include "game-activity/native_app_glue/android_cmd_mailbox.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -256,8 +257,8 @@ struct android_app {
     pthread_mutex_t mutex;
     pthread_cond_t cond;
 
-    int msgread;
-    int msgwrite;
+    struct android_cmd_mailbox cmdMailbox;
+    int64_t cmdAckTimeoutNanos;
 
     pthread_t thread;
 
@@ -432,9 +433,20 @@ enum NativeAppGlueAppCmd {
 
 };
 
+/**
+ * Value of android_app_set_cmd_ack_timeout to wait until the game thread
+ * acknowledges each command, the default.
+ */
+#define NATIVE_APP_GLUE_CMD_ACK_TIMEOUT_INFINITE (-1)
+
 /**
  * Call when ALooper_pollAll() returns LOOPER_ID_MAIN, reading the next
  * app command message.
+ *
+ * Commands that only report a change, like APP_CMD_CONTENT_RECT_CHANGED,
+ * APP_CMD_TOUCH_EVENT or APP_CMD_KEY_EVENT, are coalesced: if the same command
+ * hasn't been read yet, another change doesn't queue it again. Read the current
+ * state when handling them.
  */
 int8_t android_app_read_cmd(struct android_app* android_app);
 
@@ -505,6 +517,23 @@ void android_app_set_key_event_filter(struct android_app* app,
 void android_app_set_motion_event_filter(struct android_app* app,
                                          android_motion_event_filter filter);
 
+/**
+ * Set how long the main thread waits for the game thread to handle
+ * APP_CMD_START, APP_CMD_RESUME, APP_CMD_PAUSE, APP_CMD_STOP and
+ * APP_CMD_SAVE_STATE, so that a long frame or load on the game thread doesn't
+ * block the main thread until an ANR. Once the timeout has passed, the
+ * lifecycle callback returns and the command is handled later. A state saved
+ * after the timeout of APP_CMD_SAVE_STATE is dropped.
+ *
+ * Window changes and APP_CMD_DESTROY are always waited for, since the window
+ * or the android_app are released after they are handled.
+ *
+ * @param timeoutNanos The timeout in nanoseconds, 0 not to wait at all, or
+ * NATIVE_APP_GLUE_CMD_ACK_TIMEOUT_INFINITE, the default, to always wait.
+ */
+void android_app_set_cmd_ack_timeout(struct android_app* app,
+                                     int64_t timeoutNanos);
+
 #ifdef __cplusplus
 }
 #endif
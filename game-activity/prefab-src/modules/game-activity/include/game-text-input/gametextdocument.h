@@ -0,0 +1 @@
+../../../../../../game-text-input/prefab-src/modules/game-text-input/include/game-text-input/gametextdocument.h
\ No newline at end of file
@@ -52,6 +52,7 @@ import com.google.androidgamesdk.gametextinput.GameTextInput;
 import com.google.androidgamesdk.gametextinput.Listener;
 import com.google.androidgamesdk.gametextinput.Settings;
 import com.google.androidgamesdk.gametextinput.State;
+import com.google.androidgamesdk.gametextinput.StateDelta;
 import dalvik.system.BaseDexClassLoader;
 import java.io.File;
 
@@ -137,6 +138,12 @@ public class GameActivity
     onTextInputEventNative(mNativeHandle, newState);
   }
 
+  // Called when the IME has changed part of the input
+  @Override
+  public boolean stateDeltaChanged(StateDelta delta, boolean dismissed) {
+    return onTextInputDeltaEventNative(mNativeHandle, delta);
+  }
+
   @Override
   public void onGlobalLayout() {
     mSurfaceView.getLocationInWindow(mLocation);
@@ -224,6 +231,8 @@ public class GameActivity
 
   protected native void onTextInputEventNative(long handle, State softKeyboardEvent);
 
+  protected native boolean onTextInputDeltaEventNative(long handle, StateDelta softKeyboardDelta);
+
   protected native void setInputConnectionNative(long handle, InputConnection c);
 
   protected native void onWindowInsetsChangedNative(long handle);
@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+/**
+ * The text edited through GameTextInput, stored in a gap buffer so that edits
+ * near the previous edit, typically at the cursor, only move the bytes between
+ * the two. It has no dependency on JNI, so that it can be tested on any host.
+ *
+ * Text is stored as UTF-8 bytes, while edit ranges are given in the UTF-16
+ * code units used by Java strings. Sequences of four bytes count as two units
+ * and any other sequence as one. Offsets are converted by scanning from the
+ * gap or, in long texts, from the nearest entry of an index of the byte offset
+ * every kIndexInterval code units. The index is kept up to the first edit
+ * since it was built and extended when needed.
+ */
+class GameTextDocument {
+   public:
+    static constexpr int32_t kIndexInterval = 256;
+    // Texts shorter than this, in bytes, are always scanned from the gap.
+    static constexpr int32_t kIndexMinLength = 4096;
+
+    /**
+     * @param capacity The maximum length of the text in bytes. The buffer is
+     * allocated here and never grows.
+     */
+    explicit GameTextDocument(uint32_t capacity)
+        : buffer_(capacity + 1), gapEnd_(static_cast<int32_t>(capacity)) {}
+
+    /**
+     * Replace the whole text, truncating it to the capacity.
+     */
+    void setText(const char *text, int32_t length) {
+        int32_t capacity = this->capacity();
+        if (length > capacity) length = capacity;
+        if (length < 0 || text == nullptr) length = 0;
+        if (length > 0) memcpy(buffer_.data(), text, length);
+        gapStart_ = length;
+        gapEnd_ = capacity;
+        gapStartUnits_ = countUnits(buffer_.data(), length);
+        units_ = gapStartUnits_;
+        index_.clear();
+    }
+
+    /**
+     * Replace the UTF-16 range [start, end) of the text with text, of length
+     * bytes.
+     * @return false, leaving the text unchanged, if the range isn't in the text
+     * or the result would be larger than the capacity.
+     */
+    bool replace(int32_t start, int32_t end, const char *text,
+                 int32_t length) {
+        if (start < 0 || start > end || end > units_ || length < 0) {
+            return false;
+        }
+        Position startPosition = findPosition(start);
+        if (startPosition.units != start) return false;
+        moveGap(startPosition.bytes);
+        Position endPosition = findPosition(end);
+        if (endPosition.units != end) return false;
+        int32_t removedBytes = endPosition.bytes - startPosition.bytes;
+        if (length > gapEnd_ - gapStart_ + removedBytes) return false;
+        // The removed bytes are right after the gap, so removing them only
+        // grows the gap.
+        gapEnd_ += removedBytes;
+        units_ -= end - start;
+        if (length > 0) memcpy(buffer_.data() + gapStart_, text, length);
+        gapStart_ += length;
+        int32_t insertedUnits = countUnits(text, length);
+        gapStartUnits_ += insertedUnits;
+        units_ += insertedUnits;
+        // Index entries up to the start of the edit are still valid.
+        if (index_.size() > static_cast<size_t>(start / kIndexInterval) + 1) {
+            index_.resize(start / kIndexInterval + 1);
+        }
+        return true;
+    }
+
+    /**
+     * Apply an edit of the IME: replace the UTF-16 range [start, end) of the
+     * text with text, of length bytes, then convert offsets in the new text,
+     * such as the ends of the selection, from UTF-16 offsets to byte offsets.
+     * Negative offsets are left unchanged. The gap stays at the end of the
+     * edit.
+     * @return false, leaving the text and the offsets unchanged, if replace
+     * fails.
+     */
+    bool applyDelta(int32_t start, int32_t end, const char *text,
+                    int32_t length, int32_t *offsets, int32_t offset_count) {
+        if (!replace(start, end, text, length)) return false;
+        for (int32_t i = 0; i < offset_count; ++i) {
+            if (offsets[i] >= 0) offsets[i] = byteOffset(offsets[i]);
+        }
+        return true;
+    }
+
+    /**
+     * Byte offset of a UTF-16 offset in the text. An offset in the middle of a
+     * character is converted to the end of the character and an offset past
+     * the end of the text to its length.
+     */
+    int32_t byteOffset(int32_t unitIndex) {
+        if (unitIndex <= 0) return 0;
+        Position position = findPosition(unitIndex);
+        if (position.units < unitIndex && position.bytes < length()) {
+            advance(&position);
+        }
+        return position.bytes;
+    }
+
+    /**
+     * Get the text, null-terminated. This moves the gap to the end, so the
+     * cost is proportional to the distance from the last edit to the end of
+     * the text: call it when the text is read rather than after each edit.
+     */
+    const char *text() {
+        moveGap(length());
+        buffer_[gapStart_] = 0;
+        return buffer_.data();
+    }
+
+    /** Length of the text in bytes. */
+    int32_t length() const { return capacity() - (gapEnd_ - gapStart_); }
+
+    /** Length of the text in UTF-16 code units. */
+    int32_t utf16Length() const { return units_; }
+
+    int32_t capacity() const {
+        return static_cast<int32_t>(buffer_.size()) - 1;
+    }
+
+   private:
+    // A character boundary in the text.
+    struct Position {
+        int32_t bytes;
+        int32_t units;
+    };
+
+    static bool isContinuationByte(char c) { return (c & 0xC0) == 0x80; }
+
+    // Number of UTF-16 code units encoded by a sequence starting with lead.
+    static int32_t unitsOfSequence(char lead) {
+        return (static_cast<uint8_t>(lead) >= 0xF0) ? 2 : 1;
+    }
+
+    static int32_t countUnits(const char *text, int32_t length) {
+        int32_t units = 0;
+        for (int32_t i = 0; i < length; ++i) {
+            if (!isContinuationByte(text[i])) {
+                units += unitsOfSequence(text[i]);
+            }
+        }
+        return units;
+    }
+
+    // Byte of the text at a byte offset, skipping the gap.
+    char byteAt(int32_t offset) const {
+        return buffer_[offset < gapStart_ ? offset
+                                          : offset + gapEnd_ - gapStart_];
+    }
+
+    // Moves a position over the next character.
+    void advance(Position *position) const {
+        int32_t textLength = length();
+        position->units += unitsOfSequence(byteAt(position->bytes));
+        ++position->bytes;
+        while (position->bytes < textLength &&
+               isContinuationByte(byteAt(position->bytes))) {
+            ++position->bytes;
+        }
+    }
+
+    // Scans from a position to the character boundary at unitIndex or, if
+    // unitIndex is in the middle of a character, the closest one.
+    Position scan(Position position, int32_t unitIndex) const {
+        if (unitIndex >= position.units) {
+            int32_t textLength = length();
+            while (position.units < unitIndex && position.bytes < textLength) {
+                advance(&position);
+            }
+        } else {
+            while (position.units > unitIndex && position.bytes > 0) {
+                --position.bytes;
+                char c = byteAt(position.bytes);
+                if (!isContinuationByte(c)) {
+                    position.units -= unitsOfSequence(c);
+                }
+            }
+        }
+        return position;
+    }
+
+    Position findPosition(int32_t unitIndex) {
+        Position start = {gapStart_, gapStartUnits_};
+        int32_t distance = unitIndex > start.units ? unitIndex - start.units
+                                                   : start.units - unitIndex;
+        if (distance > kIndexInterval && length() >= kIndexMinLength) {
+            updateIndex();
+            size_t entry = unitIndex / kIndexInterval;
+            if (entry >= index_.size()) entry = index_.size() - 1;
+            if (index_[entry].units > unitIndex) --entry;
+            if (unitIndex - index_[entry].units < distance) {
+                start = index_[entry];
+            }
+        }
+        return scan(start, unitIndex);
+    }
+
+    // Extends the index to the end of the text.
+    void updateIndex() {
+        if (index_.empty()) index_.push_back({0, 0});
+        Position position = index_.back();
+        int32_t textLength = length();
+        while (position.bytes < textLength) {
+            advance(&position);
+            if (position.units >=
+                static_cast<int32_t>(index_.size()) * kIndexInterval) {
+                index_.push_back(position);
+            }
+        }
+    }
+
+    void moveGap(int32_t position) {
+        char *data = buffer_.data();
+        int32_t gapSize = gapEnd_ - gapStart_;
+        if (position < gapStart_) {
+            int32_t moved = gapStart_ - position;
+            gapStartUnits_ -= countUnits(data + position, moved);
+            memmove(data + position + gapSize, data + position, moved);
+        } else if (position > gapStart_) {
+            int32_t moved = position - gapStart_;
+            gapStartUnits_ += countUnits(data + gapEnd_, moved);
+            memmove(data + gapStart_, data + gapEnd_, moved);
+        }
+        gapStart_ = position;
+        gapEnd_ = position + gapSize;
+    }
+
+    // The text is [0, gapStart_) followed by [gapEnd_, size - 1), with an
+    // extra byte for the null terminator.
+    std::vector<char> buffer_;
+    int32_t gapStart_ = 0;
+    int32_t gapEnd_;
+    // UTF-16 code units before the gap and in the whole text.
+    int32_t gapStartUnits_ = 0;
+    int32_t units_ = 0;
+    // Entry i is the first character boundary at or after i * kIndexInterval
+    // code units.
+    std::vector<Position> index_;
+};
@@ -15,6 +15,9 @@
  */
 #include "game-text-input/gametextinput.h"
 
+#include "game-text-input/gametextdocument.h"
+#include "game-text-input/gametextutf.h"
+
 #include <android/log.h>
 #include <jni.h>
 #include <stdlib.h>
@@ -38,18 +41,31 @@ struct StateClassInfo {
     jfieldID composingRegionEnd;
 };
 
+// Cache of field ids in the Java GameTextInputStateDelta class
+struct StateDeltaClassInfo {
+    jfieldID replaceStart;
+    jfieldID replaceEnd;
+    jfieldID text;
+    jfieldID selectionStart;
+    jfieldID selectionEnd;
+    jfieldID composingRegionStart;
+    jfieldID composingRegionEnd;
+};
+
 // Main GameTextInput object.
 struct GameTextInput {
    public:
     GameTextInput(JNIEnv *env, uint32_t max_string_size);
     ~GameTextInput();
     void setState(const GameTextInputState &state);
-    GameTextInputState getState() const {
+    GameTextInputState getState() {
         std::lock_guard<std::mutex> lock(currentStateMutex_);
+        updateStateText();
         return currentState_;
     }
     void setInputConnection(jobject inputConnection);
     void processEvent(jobject textInputEvent);
+    bool processDeltaEvent(jobject textInputDelta);
     void showIme(uint32_t flags);
     void hideIme(uint32_t flags);
     void restartInput();
@@ -67,10 +83,16 @@ struct GameTextInput {
     // Copy string and set other fields
     void setStateInner(const GameTextInputState &state);
     static void processCallback(void *context, const GameTextInputState *state);
+    // Set the text of currentState_ from document_ if deltas changed it.
+    // Must be called with currentStateMutex_ held.
+    void updateStateText();
     JNIEnv *env_ = nullptr;
     // Cached at initialization from
     // com/google/androidgamesdk/gametextinput/State.
     jclass stateJavaClass_ = nullptr;
+    // Cached at initialization from
+    // com/google/androidgamesdk/gametextinput/StateDelta.
+    jclass stateDeltaJavaClass_ = nullptr;
     // The latest text input update.
     GameTextInputState currentState_ = {};
     // A mutex to protect currentState_.
@@ -89,8 +111,16 @@ struct GameTextInput {
     ARect currentInsets_ = {};
     void *insetsCallbackContext_ = nullptr;
     StateClassInfo stateClassInfo_ = {};
-    // Constant-sized buffer used to store state text.
-    std::vector<char> stateStringBuffer_;
+    StateDeltaClassInfo stateDeltaClassInfo_ = {};
+    // Constant-sized document storing the state text, protected by
+    // currentStateMutex_.
+    GameTextDocument document_;
+    // True if deltas changed document_ since currentState_.text_UTF8 was last
+    // set. Getting the text moves the gap of document_ to the end, so it's
+    // deferred until the state is read. Protected by currentStateMutex_.
+    bool stateTextChanged_ = false;
+    // UTF-8 replacement text of the last delta, kept to reuse its allocation.
+    std::vector<char> deltaText_;
 };
 
 std::unique_ptr<GameTextInput> s_gameTextInput;
@@ -161,6 +191,11 @@ void GameTextInput_processEvent(GameTextInput *input, jobject textInputEvent) {
     input->processEvent(textInputEvent);
 }
 
+bool GameTextInput_processDeltaEvent(GameTextInput *input,
+                                     jobject textInputDelta) {
+    return input->processDeltaEvent(textInputDelta);
+}
+
 void GameTextInput_processImeInsets(GameTextInput *input, const ARect *insets) {
     input->processImeInsets(insets);
 }
@@ -201,10 +236,12 @@ void GameTextInput_getImeInsets(const GameTextInput *input, ARect *insets) {
 
 GameTextInput::GameTextInput(JNIEnv *env, uint32_t max_string_size)
     : env_(env),
-      stateStringBuffer_(max_string_size == 0 ? DEFAULT_MAX_STRING_SIZE
-                                              : max_string_size) {
+      document_(max_string_size == 0 ? DEFAULT_MAX_STRING_SIZE
+                                     : max_string_size) {
     stateJavaClass_ = (jclass)env_->NewGlobalRef(
         env_->FindClass("com/google/androidgamesdk/gametextinput/State"));
+    stateDeltaJavaClass_ = (jclass)env_->NewGlobalRef(env_->FindClass(
+        "com/google/androidgamesdk/gametextinput/StateDelta"));
     inputConnectionClass_ = (jclass)env_->NewGlobalRef(env_->FindClass(
         "com/google/androidgamesdk/gametextinput/InputConnection"));
     inputConnectionSetStateMethod_ =
@@ -225,6 +262,21 @@ GameTextInput::GameTextInput(JNIEnv *env, uint32_t max_string_size)
         env_->GetFieldID(stateJavaClass_, "composingRegionStart", "I");
     stateClassInfo_.composingRegionEnd =
         env_->GetFieldID(stateJavaClass_, "composingRegionEnd", "I");
+
+    stateDeltaClassInfo_.replaceStart =
+        env_->GetFieldID(stateDeltaJavaClass_, "replaceStart", "I");
+    stateDeltaClassInfo_.replaceEnd =
+        env_->GetFieldID(stateDeltaJavaClass_, "replaceEnd", "I");
+    stateDeltaClassInfo_.text =
+        env_->GetFieldID(stateDeltaJavaClass_, "text", "Ljava/lang/String;");
+    stateDeltaClassInfo_.selectionStart =
+        env_->GetFieldID(stateDeltaJavaClass_, "selectionStart", "I");
+    stateDeltaClassInfo_.selectionEnd =
+        env_->GetFieldID(stateDeltaJavaClass_, "selectionEnd", "I");
+    stateDeltaClassInfo_.composingRegionStart =
+        env_->GetFieldID(stateDeltaJavaClass_, "composingRegionStart", "I");
+    stateDeltaClassInfo_.composingRegionEnd =
+        env_->GetFieldID(stateDeltaJavaClass_, "composingRegionEnd", "I");
 }
 
 GameTextInput::~GameTextInput() {
@@ -232,6 +284,10 @@ GameTextInput::~GameTextInput() {
         env_->DeleteGlobalRef(stateJavaClass_);
         stateJavaClass_ = NULL;
     }
+    if (stateDeltaJavaClass_ != NULL) {
+        env_->DeleteGlobalRef(stateDeltaJavaClass_);
+        stateDeltaJavaClass_ = NULL;
+    }
     if (inputConnectionClass_ != NULL) {
         env_->DeleteGlobalRef(inputConnectionClass_);
         inputConnectionClass_ = NULL;
@@ -253,6 +309,7 @@ void GameTextInput::setState(const GameTextInputState &state) {
 
 void GameTextInput::setStateInner(const GameTextInputState &state) {
     std::lock_guard<std::mutex> lock(currentStateMutex_);
+    updateStateText();
 
     // Check if we're setting using our own string (other parts may be
     // different)
@@ -261,16 +318,18 @@ void GameTextInput::setStateInner(const GameTextInputState &state) {
         return;
     }
     // Otherwise, copy across the string.
-    auto bytes_needed =
-        std::min(static_cast<uint32_t>(state.text_length + 1),
-                 static_cast<uint32_t>(stateStringBuffer_.size()));
-    currentState_.text_UTF8 = stateStringBuffer_.data();
-    std::copy(state.text_UTF8, state.text_UTF8 + bytes_needed - 1,
-              stateStringBuffer_.data());
-    currentState_.text_length = state.text_length;
+    document_.setText(state.text_UTF8, state.text_length);
+    currentState_.text_UTF8 = document_.text();
+    currentState_.text_length = document_.length();
     currentState_.selection = state.selection;
     currentState_.composingRegion = state.composingRegion;
-    stateStringBuffer_[bytes_needed - 1] = 0;
+}
+
+void GameTextInput::updateStateText() {
+    if (!stateTextChanged_) return;
+    currentState_.text_UTF8 = document_.text();
+    currentState_.text_length = document_.length();
+    stateTextChanged_ = false;
 }
 
 void GameTextInput::setInputConnection(jobject inputConnection) {
@@ -294,6 +353,59 @@ void GameTextInput::processEvent(jobject textInputEvent) {
     }
 }
 
+bool GameTextInput::processDeltaEvent(jobject textInputDelta) {
+    jstring text = (jstring)env_->GetObjectField(textInputDelta,
+                                                 stateDeltaClassInfo_.text);
+    int replaceStart =
+        env_->GetIntField(textInputDelta, stateDeltaClassInfo_.replaceStart);
+    int replaceEnd =
+        env_->GetIntField(textInputDelta, stateDeltaClassInfo_.replaceEnd);
+    GameTextInputSpan selection{
+        env_->GetIntField(textInputDelta, stateDeltaClassInfo_.selectionStart),
+        env_->GetIntField(textInputDelta, stateDeltaClassInfo_.selectionEnd)};
+    GameTextInputSpan composingRegion{
+        env_->GetIntField(textInputDelta,
+                          stateDeltaClassInfo_.composingRegionStart),
+        env_->GetIntField(textInputDelta,
+                          stateDeltaClassInfo_.composingRegionEnd)};
+    // Only the replacement text is converted, which is typically a few
+    // characters.
+    int32_t text_len = 0;
+    if (text != nullptr) {
+        jsize text_units = env_->GetStringLength(text);
+        deltaText_.resize(text_units * gametextutf::kMaxUtf8BytesPerUtf16Unit +
+                          1);
+        const jchar *text_chars = env_->GetStringCritical(text, NULL);
+        if (text_chars != nullptr) {
+            text_len = gametextutf::utf16ToUtf8(
+                reinterpret_cast<const uint16_t *>(text_chars), text_units,
+                deltaText_.data(), static_cast<int32_t>(deltaText_.size()));
+            env_->ReleaseStringCritical(text, text_chars);
+        }
+        env_->DeleteLocalRef(text);
+    }
+    // The spans are UTF-16 offsets in the new text.
+    int32_t spans[] = {selection.start, selection.end, composingRegion.start,
+                       composingRegion.end};
+    bool applied;
+    {
+        std::lock_guard<std::mutex> lock(currentStateMutex_);
+        applied = document_.applyDelta(replaceStart, replaceEnd,
+                                       deltaText_.data(), text_len, spans, 4);
+        if (applied) {
+            currentState_.selection = {spans[0], spans[1]};
+            currentState_.composingRegion = {spans[2], spans[3]};
+            stateTextChanged_ = true;
+        }
+    }
+    if (applied && eventCallback_) {
+        std::lock_guard<std::mutex> lock(currentStateMutex_);
+        updateStateText();
+        eventCallback_(eventCallbackContext_, &currentState_);
+    }
+    return applied;
+}
+
 void GameTextInput::showIme(uint32_t flags) {
     if (inputConnection_ == nullptr) return;
     env_->CallVoidMethod(inputConnection_, setSoftKeyboardActiveMethod_, true,
@@ -341,18 +453,18 @@ jobject GameTextInput::stateToJava(const GameTextInputState &state) const {
             return nullptr;
         }
     }
-    const char *text = state.text_UTF8;
-    if (text == nullptr) {
-        static char empty_string[] = "";
-        text = empty_string;
-    }
-    // Note that this expects 'modified' UTF-8 which is not the same as UTF-8
-    // https://en.wikipedia.org/wiki/UTF-8#Modified_UTF-8
-    jstring jtext = env_->NewStringUTF(text);
-    jobject jobj =
-        env_->NewObject(stateJavaClass_, constructor, jtext,
-                        state.selection.start, state.selection.end,
-                        state.composingRegion.start, state.composingRegion.end);
+    int32_t text_len = state.text_UTF8 == nullptr ? 0 : state.text_length;
+    if (text_len < 0) text_len = 0;
+    // Java expects the spans as UTF-16 offsets.
+    int32_t spans[] = {state.selection.start, state.selection.end,
+                       state.composingRegion.start, state.composingRegion.end};
+    std::vector<jchar> text_chars(std::max(text_len, 1));
+    int32_t text_units = gametextutf::utf8ToUtf16(
+        state.text_UTF8, text_len,
+        reinterpret_cast<uint16_t *>(text_chars.data()), spans, 4);
+    jstring jtext = env_->NewString(text_chars.data(), text_units);
+    jobject jobj = env_->NewObject(stateJavaClass_, constructor, jtext,
+                                   spans[0], spans[1], spans[2], spans[3]);
     env_->DeleteLocalRef(jtext);
     return jobj;
 }
@@ -362,13 +474,6 @@ void GameTextInput::stateFromJava(jobject textInputEvent,
                                   void *context) const {
     jstring text =
         (jstring)env_->GetObjectField(textInputEvent, stateClassInfo_.text);
-    // Note this is 'modified' UTF-8, not true UTF-8. It has no NULLs in it,
-    // except at the end. It's actually not specified whether the value returned
-    // by GetStringUTFChars includes a null at the end, but it *seems to* on
-    // Android.
-    const char *text_chars = env_->GetStringUTFChars(text, NULL);
-    int text_len = env_->GetStringUTFLength(
-        text);  // Length in bytes, *not* including the null.
     int selectionStart =
         env_->GetIntField(textInputEvent, stateClassInfo_.selectionStart);
     int selectionEnd =
@@ -377,11 +482,28 @@ void GameTextInput::stateFromJava(jobject textInputEvent,
         env_->GetIntField(textInputEvent, stateClassInfo_.composingRegionStart);
     int composingRegionEnd =
         env_->GetIntField(textInputEvent, stateClassInfo_.composingRegionEnd);
-    GameTextInputState state{text_chars,
+    // The spans are converted from UTF-16 offsets to byte offsets along with
+    // the text. Text past the capacity of the document would be dropped by
+    // setState anyway, so it isn't converted.
+    int32_t spans[] = {selectionStart, selectionEnd, composingRegionStart,
+                       composingRegionEnd};
+    jsize text_units = env_->GetStringLength(text);
+    std::vector<char> text_utf8(
+        std::min<size_t>(static_cast<size_t>(text_units) *
+                             gametextutf::kMaxUtf8BytesPerUtf16Unit,
+                         document_.capacity()) +
+        1);
+    const jchar *text_chars = env_->GetStringCritical(text, NULL);
+    int32_t text_len = gametextutf::utf16ToUtf8(
+        reinterpret_cast<const uint16_t *>(text_chars), text_units,
+        text_utf8.data(), static_cast<int32_t>(text_utf8.size() - 1), spans,
+        4);
+    env_->ReleaseStringCritical(text, text_chars);
+    text_utf8[text_len] = 0;
+    GameTextInputState state{text_utf8.data(),
                              text_len,
-                             {selectionStart, selectionEnd},
-                             {composingRegionStart, composingRegionEnd}};
+                             {spans[0], spans[1]},
+                             {spans[2], spans[3]}};
     callback(context, &state);
-    env_->ReleaseStringUTFChars(text, text_chars);
     env_->DeleteLocalRef(text);
 }
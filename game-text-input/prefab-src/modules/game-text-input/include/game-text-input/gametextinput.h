@@ -24,6 +24,7 @@
 
 #include <android/rect.h>
 #include <jni.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "common/gamesdk_common.h"
@@ -33,8 +34,8 @@
 extern "C" {
 #endif
 
-#define GAMETEXTINPUT_MAJOR_VERSION 3
-#define GAMETEXTINPUT_MINOR_VERSION 1
+#define GAMETEXTINPUT_MAJOR_VERSION 4
+#define GAMETEXTINPUT_MINOR_VERSION 0
 #define GAMETEXTINPUT_BUGFIX_VERSION 0
 #define GAMETEXTINPUT_PACKED_VERSION                            \
     ANDROID_GAMESDK_PACKED_VERSION(GAMETEXTINPUT_MAJOR_VERSION, \
@@ -45,6 +46,8 @@ extern "C" {
  * This struct holds a span within a region of text from start (inclusive) to
  * end (exclusive). An empty span or cursor position is specified with
  * start==end. An undefined span is specified with start = end = SPAN_UNDEFINED.
+ * Positions are byte offsets in the UTF-8 text of the state and should be at
+ * character boundaries.
  */
 typedef struct GameTextInputSpan {
     /** The start of the region (inclusive). */
@@ -67,8 +70,8 @@ enum GameTextInputSpanFlag { SPAN_UNDEFINED = -1 };
  */
 typedef struct GameTextInputState {
     /**
-     * Text owned by the state, as a modified UTF-8 string. Null-terminated.
-     * https://en.wikipedia.org/wiki/UTF-8#Modified_UTF-8
+     * Text owned by the state, as a standard UTF-8 string. Null-terminated.
+     * Invalid sequences are replaced by U+FFFD when passed to Java.
      */
     const char *text_UTF8;
     /**
@@ -132,6 +135,19 @@ void GameTextInput_setInputConnection(GameTextInput *input,
  */
 void GameTextInput_processEvent(GameTextInput *input, jobject eventState);
 
+/**
+ * Apply an edit made by the IME to the current state and trigger any event
+ * callbacks, without converting the whole text. Unless using GameActivity,
+ * call this from your Java gametextinput.Listener.stateDeltaChanged method and
+ * return its result, so that the full state is sent with stateChanged when the
+ * delta can't be applied.
+ * @param input A valid GameTextInput library handle.
+ * @param eventDelta A Java gametextinput.StateDelta object.
+ * @return false, leaving the state unchanged, if the replaced range isn't in
+ * the current text or the new text would be larger than max_string_size.
+ */
+bool GameTextInput_processDeltaEvent(GameTextInput *input, jobject eventDelta);
+
 /**
  * Free any resources owned by the GameTextInput library.
  * Any subsequent calls to the library will fail until GameTextInput_init is
@@ -204,7 +220,7 @@ void GameTextInput_getState(GameTextInput *input,
 
 /**
  * Set the current GameTextInput state. This state is reflected to any active
- * IME.
+ * IME, with its spans converted to the UTF-16 offsets used by Java.
  * @param input A valid GameTextInput library handle.
  * @param state The state to set. Ownership is maintained by the caller and must
  * remain valid for the duration of the call.
@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Conversions between the UTF-16 of Java strings and standard UTF-8, which
+ * also convert offsets in the text, such as the ends of a selection, from one
+ * encoding to the other. Runs of ASCII are converted eight characters at a
+ * time, in loops that compilers can vectorize. Invalid sequences and unpaired
+ * surrogates are replaced by U+FFFD. There is no dependency on JNI, so that
+ * this can be tested on any host.
+ */
+namespace gametextutf {
+
+/** Longest UTF-8 encoding of a UTF-16 code unit, to size output buffers. */
+static constexpr int32_t kMaxUtf8BytesPerUtf16Unit = 3;
+
+/**
+ * Converts offsets in the input of a conversion, given in place, to offsets
+ * in its output. Negative offsets are left unchanged. An offset in the middle
+ * of a character is converted to the end of the character.
+ */
+class OffsetConverter {
+   public:
+    static constexpr int32_t kMaxOffsets = 32;
+
+    OffsetConverter(int32_t *offsets, int32_t count)
+        : offsets_(offsets), count_(count < kMaxOffsets ? count : kMaxOffsets) {
+        for (int32_t i = 0; i < count_; ++i) {
+            if (offsets_[i] >= 0) pending_ |= 1u << i;
+        }
+        updateNext();
+    }
+
+    /** Smallest input offset still to convert, INT32_MAX if none. */
+    int32_t next() const { return next_; }
+
+    /** Converts the offsets up to input, which is at output. */
+    void convert(int32_t input, int32_t output) {
+        if (next_ > input) return;
+        for (int32_t i = 0; i < count_; ++i) {
+            if ((pending_ & (1u << i)) && offsets_[i] <= input) {
+                offsets_[i] = output;
+                pending_ &= ~(1u << i);
+            }
+        }
+        updateNext();
+    }
+
+    /** Converts the remaining offsets, past the converted input, to output. */
+    void finish(int32_t output) { convert(INT32_MAX, output); }
+
+   private:
+    void updateNext() {
+        next_ = INT32_MAX;
+        for (int32_t i = 0; i < count_; ++i) {
+            if ((pending_ & (1u << i)) && offsets_[i] < next_) {
+                next_ = offsets_[i];
+            }
+        }
+    }
+
+    int32_t *offsets_;
+    int32_t count_;
+    uint32_t pending_ = 0;
+    int32_t next_ = INT32_MAX;
+};
+
+inline int32_t min3(int32_t a, int32_t b, int32_t c) {
+    int32_t ab = a < b ? a : b;
+    return ab < c ? ab : c;
+}
+
+inline bool isAsciiUtf16x8(const uint16_t *in) {
+    uint64_t a, b;
+    memcpy(&a, in, sizeof(a));
+    memcpy(&b, in + 4, sizeof(b));
+    return ((a | b) & 0xFF80FF80FF80FF80ULL) == 0;
+}
+
+inline bool isAsciiUtf8x8(const char *in) {
+    uint64_t a;
+    memcpy(&a, in, sizeof(a));
+    return (a & 0x8080808080808080ULL) == 0;
+}
+
+inline bool isContinuationByte(uint8_t c) { return (c & 0xC0) == 0x80; }
+
+/**
+ * Convert UTF-16 to UTF-8, stopping before the first character that doesn't
+ * fit in capacity bytes. The output isn't null-terminated.
+ * @param offsets UTF-16 offsets in the input, converted in place to byte
+ * offsets in the output. Offsets past the converted input are converted to its
+ * end.
+ * @return The number of bytes written.
+ */
+inline int32_t utf16ToUtf8(const uint16_t *in, int32_t length, char *out,
+                           int32_t capacity, int32_t *offsets = nullptr,
+                           int32_t offset_count = 0) {
+    OffsetConverter converter(offsets, offset_count);
+    int32_t i = 0;
+    int32_t o = 0;
+    while (i < length) {
+        converter.convert(i, o);
+        // ASCII, until the next offset to convert.
+        int32_t run_end = min3(length, converter.next(), i + (capacity - o));
+        if (i + 8 <= run_end && isAsciiUtf16x8(in + i)) {
+            do {
+                for (int32_t k = 0; k < 8; ++k) {
+                    out[o + k] = static_cast<char>(in[i + k]);
+                }
+                i += 8;
+                o += 8;
+            } while (i + 8 <= run_end && isAsciiUtf16x8(in + i));
+            continue;
+        }
+
+        uint32_t c = in[i];
+        int32_t units = 1;
+        if (c >= 0xD800 && c <= 0xDFFF) {
+            if (c <= 0xDBFF && i + 1 < length && in[i + 1] >= 0xDC00 &&
+                in[i + 1] <= 0xDFFF) {
+                c = 0x10000 + ((c - 0xD800) << 10) + (in[i + 1] - 0xDC00);
+                units = 2;
+            } else {
+                c = 0xFFFD;
+            }
+        }
+        int32_t bytes = c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+        if (o + bytes > capacity) break;
+        switch (bytes) {
+            case 1:
+                out[o] = static_cast<char>(c);
+                break;
+            case 2:
+                out[o] = static_cast<char>(0xC0 | (c >> 6));
+                out[o + 1] = static_cast<char>(0x80 | (c & 0x3F));
+                break;
+            case 3:
+                out[o] = static_cast<char>(0xE0 | (c >> 12));
+                out[o + 1] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                out[o + 2] = static_cast<char>(0x80 | (c & 0x3F));
+                break;
+            default:
+                out[o] = static_cast<char>(0xF0 | (c >> 18));
+                out[o + 1] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+                out[o + 2] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                out[o + 3] = static_cast<char>(0x80 | (c & 0x3F));
+                break;
+        }
+        i += units;
+        o += bytes;
+    }
+    converter.finish(o);
+    return o;
+}
+
+/**
+ * Convert UTF-8 to UTF-16. out must have room for length code units, which is
+ * the most that can be written.
+ * @param offsets Byte offsets in the input, converted in place to UTF-16
+ * offsets in the output.
+ * @return The number of code units written.
+ */
+inline int32_t utf8ToUtf16(const char *in, int32_t length, uint16_t *out,
+                           int32_t *offsets = nullptr,
+                           int32_t offset_count = 0) {
+    OffsetConverter converter(offsets, offset_count);
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(in);
+    int32_t i = 0;
+    int32_t o = 0;
+    while (i < length) {
+        converter.convert(i, o);
+        // ASCII, until the next offset to convert.
+        int32_t run_end = length < converter.next() ? length : converter.next();
+        if (i + 8 <= run_end && isAsciiUtf8x8(in + i)) {
+            do {
+                for (int32_t k = 0; k < 8; ++k) {
+                    out[o + k] = bytes[i + k];
+                }
+                i += 8;
+                o += 8;
+            } while (i + 8 <= run_end && isAsciiUtf8x8(in + i));
+            continue;
+        }
+
+        uint32_t b0 = bytes[i];
+        uint32_t c = 0xFFFD;
+        int32_t sequence = 1;
+        if (b0 < 0x80) {
+            c = b0;
+        } else if (b0 >= 0xC2 && b0 <= 0xDF) {
+            if (i + 1 < length && isContinuationByte(bytes[i + 1])) {
+                c = ((b0 & 0x1F) << 6) | (bytes[i + 1] & 0x3F);
+                sequence = 2;
+            }
+        } else if (b0 >= 0xE0 && b0 <= 0xEF) {
+            // Rule out overlong encodings and surrogates.
+            uint8_t low = b0 == 0xE0 ? 0xA0 : 0x80;
+            uint8_t high = b0 == 0xED ? 0x9F : 0xBF;
+            if (i + 2 < length && bytes[i + 1] >= low &&
+                bytes[i + 1] <= high && isContinuationByte(bytes[i + 2])) {
+                c = ((b0 & 0x0F) << 12) | ((bytes[i + 1] & 0x3F) << 6) |
+                    (bytes[i + 2] & 0x3F);
+                sequence = 3;
+            }
+        } else if (b0 >= 0xF0 && b0 <= 0xF4) {
+            // Rule out overlong encodings and values past U+10FFFF.
+            uint8_t low = b0 == 0xF0 ? 0x90 : 0x80;
+            uint8_t high = b0 == 0xF4 ? 0x8F : 0xBF;
+            if (i + 3 < length && bytes[i + 1] >= low &&
+                bytes[i + 1] <= high && isContinuationByte(bytes[i + 2]) &&
+                isContinuationByte(bytes[i + 3])) {
+                c = ((b0 & 0x07) << 18) | ((bytes[i + 1] & 0x3F) << 12) |
+                    ((bytes[i + 2] & 0x3F) << 6) | (bytes[i + 3] & 0x3F);
+                sequence = 4;
+            }
+        }
+        if (c >= 0x10000) {
+            c -= 0x10000;
+            out[o] = static_cast<uint16_t>(0xD800 + (c >> 10));
+            out[o + 1] = static_cast<uint16_t>(0xDC00 + (c & 0x3FF));
+            o += 2;
+        } else {
+            out[o] = static_cast<uint16_t>(c);
+            ++o;
+        }
+        i += sequence;
+    }
+    converter.finish(o);
+    return o;
+}
+
+}  // namespace gametextutf
@@ -25,6 +25,7 @@ import android.text.SpannableString;
 import android.text.Spanned;
 import android.text.SpannableStringBuilder;
 import android.text.TextUtils;
+import android.text.TextWatcher;
 import android.util.Log;
 import android.view.KeyEvent;
 import android.view.View;
@@ -99,6 +100,41 @@ public class InputConnection
   private Listener listener;
   private boolean mSoftKeyboardActive;
 
+  // The edits made since the last state update, merged into a single replacement of the range
+  // [mDeltaStart, mDeltaOldEnd) of the previous text by [mDeltaStart, mDeltaNewEnd) of the
+  // current text. mDeltaStart is -1 if the text is unchanged.
+  private int mDeltaStart = -1;
+  private int mDeltaOldEnd;
+  private int mDeltaNewEnd;
+  // Set when the listener may not have seen the previous state, so the full state must be sent.
+  private boolean mFullStateNeeded = true;
+
+  /*
+   * This class records the edits made to the Editable, whether by this class or directly by the
+   * IME, so that only the changed text is sent to the listener.
+   */
+  private class DeltaRecorder implements TextWatcher {
+    public void beforeTextChanged(CharSequence s, int start, int count, int after) {}
+
+    public void onTextChanged(CharSequence s, int start, int before, int count) {
+      int end = start + before;
+      if (mDeltaStart == -1) {
+        mDeltaStart = start;
+        mDeltaOldEnd = end;
+        mDeltaNewEnd = start + count;
+        return;
+      }
+      // Grow the pending range to cover this edit. The text after the pending range is unchanged
+      // in the previous text, shifted by mDeltaNewEnd - mDeltaOldEnd.
+      int coveredEnd = Math.max(mDeltaNewEnd, end);
+      mDeltaStart = Math.min(mDeltaStart, start);
+      mDeltaOldEnd = coveredEnd - mDeltaNewEnd + mDeltaOldEnd;
+      mDeltaNewEnd = coveredEnd + count - before;
+    }
+
+    public void afterTextChanged(Editable s) {}
+  }
+
   /*
    * This class filters EOL characters from the input. For details of how InputFilter.filter
    * function works, refer to its documentation. If the suggested change is accepted without
@@ -158,6 +194,8 @@ public class InputConnection
       this.imm = (InputMethodManager) imm;
       this.mEditable = (Editable) (new SpannableStringBuilder());
     }
+    // Like the watchers of TextView, this span covers the whole text as it grows.
+    this.mEditable.setSpan(new DeltaRecorder(), 0, 0, Spanned.SPAN_INCLUSIVE_INCLUSIVE);
     // BitSet.valueOf is only available in API 30 so insert manually.
     dontInsertChars = new BitSet();
     for (int c : notInsertedKeyCodes) {
@@ -251,6 +289,10 @@ public class InputConnection
     this.mEditable.insert(0, (CharSequence) state.text);
     this.setSelectionInternal(state.selectionStart, state.selectionEnd);
     this.setComposingRegionInternal(state.composingRegionStart, state.composingRegionEnd);
+    // The caller has the new state, but filters may have changed the text, so resynchronize with
+    // the full state on the next update.
+    this.mDeltaStart = -1;
+    this.mFullStateNeeded = true;
     this.informIMM();
   }
 
@@ -271,6 +313,7 @@ public class InputConnection
    */
   public final InputConnection setListener(Listener listener) {
     this.listener = listener;
+    this.mFullStateNeeded = true;
     return this;
   }
 
@@ -563,17 +606,34 @@ public class InputConnection
   private final void stateUpdated(boolean dismissed) {
     Pair selection = this.getSelection();
     Pair cr = this.getComposingRegion();
-    State state = new State(
-        this.mEditable.toString(), selection.first, selection.second, cr.first, cr.second);
 
     // Keep a reference to the listener to avoid a race condition when setting the listener.
     Listener listener = this.listener;
 
     // We always propagate state change events because unfortunately keyboard visibility functions
     // are unreliable, and text editor logic should not depend on them.
-    if (listener != null) {
-      listener.stateChanged(state, dismissed);
+    if (listener == null) {
+      this.mFullStateNeeded = true;
+    } else {
+      boolean deltaApplied = false;
+      if (!this.mFullStateNeeded) {
+        // An unchanged text is sent as an empty replacement, for selection changes.
+        int start = Math.max(this.mDeltaStart, 0);
+        int oldEnd = this.mDeltaStart == -1 ? 0 : this.mDeltaOldEnd;
+        int newEnd = this.mDeltaStart == -1 ? 0 : this.mDeltaNewEnd;
+        StateDelta delta = new StateDelta(start, oldEnd,
+            this.mEditable.subSequence(start, newEnd).toString(), selection.first,
+            selection.second, cr.first, cr.second);
+        deltaApplied = listener.stateDeltaChanged(delta, dismissed);
+      }
+      if (!deltaApplied) {
+        State state = new State(
+            this.mEditable.toString(), selection.first, selection.second, cr.first, cr.second);
+        listener.stateChanged(state, dismissed);
+      }
+      this.mFullStateNeeded = false;
     }
+    this.mDeltaStart = -1;
   }
 
   /**
@@ -31,6 +31,19 @@ public interface Listener {
    */
   void stateChanged(State newState, boolean dismissed);
 
+  /*
+   * Called instead of stateChanged when only part of the text has changed, so that the whole
+   * text doesn't need to be copied.
+   *
+   * @param delta The change from the previous state
+   * @param dismmissed Deprecated, don't use
+   * @return false if the delta was not applied, in which case stateChanged is called with the
+   * full state. The default implementation always returns false.
+   */
+  default boolean stateDeltaChanged(StateDelta delta, boolean dismissed) {
+    return false;
+  }
+
   /*
    * Called when the IME window insets change, i.e. the IME moves into or out of view.
    *
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file contains unit tests for the ControllerBatteryMonitor class. It has
+// no JNI dependency, so these can also be run on a Linux host.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "../../main/cpp/ControllerBatteryMonitor.h"
+#include "paddleboat.h"
+
+using namespace paddleboat;
+using namespace std;
+
+namespace {
+struct BatteryChange {
+    int32_t controllerIndex;
+    Paddleboat_Controller_Battery battery;
+};
+
+// Dispatches like GameControllerManager::update, recording the changes.
+vector<BatteryChange> dispatch(ControllerBatteryMonitor &monitor) {
+    vector<BatteryChange> changes;
+    monitor.dispatch([&changes](const int32_t controllerIndex,
+                                const Paddleboat_Controller_Battery &battery) {
+        changes.push_back({controllerIndex, battery});
+    });
+    return changes;
+}
+
+Paddleboat_Controller_Battery makeBattery(
+    const float level, const Paddleboat_BatteryStatus status =
+                           PADDLEBOAT_CONTROLLER_BATTERY_DISCHARGING) {
+    Paddleboat_Controller_Battery battery;
+    battery.batteryStatus = status;
+    battery.batteryLevel = level;
+    return battery;
+}
+}  // namespace
+
+TEST(ControllerBatteryMonitorTest, ChangesAreDeliveredOnce) {
+    ControllerBatteryMonitor monitor;
+    EXPECT_FALSE(monitor.hasPendingChanges());
+    EXPECT_TRUE(monitor.onBatteryChanged(2, makeBattery(0.5f)));
+    EXPECT_TRUE(monitor.hasPendingChanges());
+
+    vector<BatteryChange> changes = dispatch(monitor);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].controllerIndex, 2);
+    EXPECT_EQ(changes[0].battery.batteryLevel, 0.5f);
+    EXPECT_EQ(changes[0].battery.batteryStatus,
+              PADDLEBOAT_CONTROLLER_BATTERY_DISCHARGING);
+    EXPECT_FALSE(monitor.hasPendingChanges());
+    EXPECT_TRUE(dispatch(monitor).empty());
+
+    EXPECT_FALSE(monitor.onBatteryChanged(2, makeBattery(0.5f)));
+    EXPECT_TRUE(dispatch(monitor).empty());
+
+    EXPECT_TRUE(monitor.onBatteryChanged(
+        2, makeBattery(0.5f, PADDLEBOAT_CONTROLLER_BATTERY_CHARGING)));
+    changes = dispatch(monitor);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].battery.batteryStatus,
+              PADDLEBOAT_CONTROLLER_BATTERY_CHARGING);
+}
+
+TEST(ControllerBatteryMonitorTest, ReportsBetweenUpdatesAreCoalesced) {
+    ControllerBatteryMonitor monitor;
+    monitor.onBatteryChanged(0, makeBattery(0.9f));
+    monitor.onBatteryChanged(0, makeBattery(0.8f));
+    monitor.onBatteryChanged(0, makeBattery(0.7f));
+    vector<BatteryChange> changes = dispatch(monitor);
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].battery.batteryLevel, 0.7f);
+
+    // A change undone before the update isn't delivered.
+    monitor.onBatteryChanged(0, makeBattery(0.6f));
+    monitor.onBatteryChanged(0, makeBattery(0.7f));
+    EXPECT_TRUE(dispatch(monitor).empty());
+}
+
+TEST(ControllerBatteryMonitorTest, ControllersAreIndependent) {
+    ControllerBatteryMonitor monitor;
+    monitor.onBatteryChanged(PADDLEBOAT_MAX_CONTROLLERS - 1, makeBattery(0.2f));
+    monitor.onBatteryChanged(1, makeBattery(0.4f));
+    const vector<BatteryChange> changes = dispatch(monitor);
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[0].controllerIndex, 1);
+    EXPECT_EQ(changes[1].controllerIndex, PADDLEBOAT_MAX_CONTROLLERS - 1);
+
+    EXPECT_FALSE(monitor.onBatteryChanged(-1, makeBattery(0.4f)));
+    EXPECT_FALSE(monitor.onBatteryChanged(PADDLEBOAT_MAX_CONTROLLERS,
+                                          makeBattery(0.4f)));
+    EXPECT_FALSE(monitor.hasPendingChanges());
+}
+
+TEST(ControllerBatteryMonitorTest, FirstStateAfterResetIsDelivered) {
+    ControllerBatteryMonitor monitor;
+    const Paddleboat_Controller_Battery unknown =
+        makeBattery(0.0f, PADDLEBOAT_CONTROLLER_BATTERY_UNKNOWN);
+    EXPECT_TRUE(monitor.onBatteryChanged(3, unknown));
+    EXPECT_EQ(dispatch(monitor).size(), 1u);
+
+    // A state reported before the controller disconnects is dropped.
+    monitor.onBatteryChanged(3, makeBattery(0.3f));
+    monitor.reset(3);
+    EXPECT_FALSE(monitor.hasPendingChanges());
+
+    // The next controller with this index gets its first state, even if it's
+    // the state of the previous one.
+    EXPECT_TRUE(monitor.onBatteryChanged(3, unknown));
+    EXPECT_EQ(dispatch(monitor).size(), 1u);
+}
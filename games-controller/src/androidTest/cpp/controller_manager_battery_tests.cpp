@@ -0,0 +1,426 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file contains tests of the battery reporting of GameControllerManager,
+// through Paddleboat_init and Paddleboat_update, with a mock of the Java
+// GameControllerManager behind a fake JNIEnv.
+
+#include <gtest/gtest.h>
+#include <jni.h>
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../../main/cpp/GameControllerInternalConstants.h"
+#include "paddleboat.h"
+
+using namespace paddleboat;
+using namespace std;
+
+namespace {
+struct BatteryChange {
+    int32_t controllerIndex;
+    Paddleboat_Controller_Battery battery;
+};
+
+Paddleboat_Controller_Battery makeBattery(
+    const float level, const Paddleboat_BatteryStatus status =
+                           PADDLEBOAT_CONTROLLER_BATTERY_DISCHARGING) {
+    Paddleboat_Controller_Battery battery;
+    battery.batteryStatus = status;
+    battery.batteryLevel = level;
+    return battery;
+}
+
+// Stands in for the Java GameControllerManager. The battery states of its
+// devices change on their own, and are checked on a timer independent of the
+// game frames, like the GameControllerThread does, then pushed through the
+// native methods registered by Paddleboat_init.
+//
+// The library reaches it through env(), a JNIEnv implementing only the
+// functions used by Paddleboat_init, by the native methods and by
+// Paddleboat_destroy, each call of which is recorded in jniCalls. Any other
+// JNI function is a null pointer, which crashes the test if called.
+class MockManagerBackend {
+   public:
+    static constexpr int64_t BATTERY_CHECK_INTERVAL_MS = 60 * 1000;
+    // Device ids of the controllers, by index
+    static constexpr int32_t DEVICE_ID_BASE = 100;
+
+    MockManagerBackend() {
+        mFunctions.GetObjectClass = getObjectClass;
+        mFunctions.FindClass = findClass;
+        mFunctions.GetMethodID = getMethodID;
+        mFunctions.CallObjectMethodV = callObjectMethodV;
+        mFunctions.CallIntMethodV = callIntMethodV;
+        mFunctions.CallVoidMethodV = callVoidMethodV;
+        mFunctions.NewObjectV = newObjectV;
+        mFunctions.NewStringUTF = newStringUTF;
+        mFunctions.GetStringUTFChars = getStringUTFChars;
+        mFunctions.ReleaseStringUTFChars = releaseStringUTFChars;
+        mFunctions.RegisterNatives = registerNatives;
+        mFunctions.NewGlobalRef = newGlobalRef;
+        mFunctions.DeleteGlobalRef = deleteRef;
+        mFunctions.DeleteLocalRef = deleteRef;
+        mFunctions.GetArrayLength = getArrayLength;
+        mFunctions.GetIntArrayRegion = getIntArrayRegion;
+        mFunctions.GetFloatArrayRegion = getFloatArrayRegion;
+        mEnv.env.functions = &mFunctions;
+        mEnv.backend = this;
+    }
+
+    JNIEnv *env() { return &mEnv.env; }
+
+    jobject context() { return handle(&mContext); }
+
+    // A controller connects, and its state is sent right away.
+    void connect(const int32_t controllerIndex,
+                 const Paddleboat_Controller_Battery &battery) {
+        EXPECT_TRUE(mNativeReady);
+        const int32_t deviceId = DEVICE_ID_BASE + controllerIndex;
+        // GameControllerDeviceInfo::InfoFields
+        FakeArray info;
+        info.ints = {deviceId, 0x18d1, 0x9400, 0, 0, controllerIndex + 1, 0};
+        FakeArray axis;
+        axis.floats.assign(MAX_AXIS_COUNT, 0.0f);
+        const jfloatArray axisArray = static_cast<jfloatArray>(handle(&axis));
+        callNative<void (*)(JNIEnv *, jobject, jintArray, jfloatArray,
+                            jfloatArray, jfloatArray, jfloatArray)>(
+            "onControllerConnected", static_cast<jintArray>(handle(&info)),
+            axisArray, axisArray, axisArray, axisArray);
+        mDevices[controllerIndex] = {true, battery, battery};
+        push(controllerIndex);
+    }
+
+    void disconnect(const int32_t controllerIndex) {
+        mDevices[controllerIndex].connected = false;
+        callNative<void (*)(JNIEnv *, jobject, jint)>(
+            "onControllerDisconnected", DEVICE_ID_BASE + controllerIndex);
+    }
+
+    // The battery of a device changes, which is only seen at the next check.
+    void setBattery(const int32_t controllerIndex,
+                    const Paddleboat_Controller_Battery &battery) {
+        mDevices[controllerIndex].battery = battery;
+    }
+
+    void advanceTo(const int64_t timeMs) {
+        while (mNextCheckMs <= timeMs) {
+            for (int32_t i = 0; i < PADDLEBOAT_MAX_CONTROLLERS; ++i) {
+                const Device &device = mDevices[i];
+                if (device.connected &&
+                    (device.battery.batteryLevel !=
+                         device.sent.batteryLevel ||
+                     device.battery.batteryStatus !=
+                         device.sent.batteryStatus)) {
+                    push(i);
+                }
+            }
+            mNextCheckMs += BATTERY_CHECK_INTERVAL_MS;
+        }
+    }
+
+    // Calls from the library to Java, by function and method name
+    vector<string> jniCalls;
+    // Calls from Java to the native methods
+    int32_t nativeCalls = 0;
+
+   private:
+    struct Device {
+        bool connected = false;
+        Paddleboat_Controller_Battery battery;
+        Paddleboat_Controller_Battery sent;
+    };
+
+    struct FakeArray {
+        vector<jint> ints;
+        vector<jfloat> floats;
+    };
+
+    // The JNIEnv passed to the library, with the backend behind it.
+    struct FakeEnv {
+        JNIEnv env;
+        MockManagerBackend *backend;
+    };
+
+    static MockManagerBackend &fromEnv(JNIEnv *env, const char *function) {
+        MockManagerBackend &b = *reinterpret_cast<FakeEnv *>(env)->backend;
+        b.jniCalls.push_back(function);
+        return b;
+    }
+
+    template <typename T>
+    static jobject handle(T *object) {
+        return reinterpret_cast<jobject>(object);
+    }
+
+    template <typename T>
+    static T *object(jobject handle) {
+        return reinterpret_cast<T *>(handle);
+    }
+
+    static jclass getObjectClass(JNIEnv *env, jobject) {
+        return static_cast<jclass>(
+            handle(&fromEnv(env, "GetObjectClass").mClass));
+    }
+
+    static jclass findClass(JNIEnv *env, const char *) {
+        return static_cast<jclass>(handle(&fromEnv(env, "FindClass").mClass));
+    }
+
+    // Method ids are indices in mMethods, plus one.
+    static jmethodID getMethodID(JNIEnv *env, jclass, const char *name,
+                                 const char *) {
+        MockManagerBackend &b = fromEnv(env, "GetMethodID");
+        b.mMethods.push_back(name);
+        return reinterpret_cast<jmethodID>(b.mMethods.size());
+    }
+
+    static const string &methodName(MockManagerBackend &b,
+                                    jmethodID methodID) {
+        return b.mMethods[reinterpret_cast<uintptr_t>(methodID) - 1];
+    }
+
+    // getClassLoader, loadClass and getDeviceNameById
+    static jobject callObjectMethodV(JNIEnv *env, jobject, jmethodID methodID,
+                                     va_list) {
+        MockManagerBackend &b = fromEnv(env, "CallObjectMethod");
+        const string &name = methodName(b, methodID);
+        b.jniCalls.back() += " " + name;
+        if (name == "getDeviceNameById") return handle(b.mDeviceName);
+        return handle(name == "loadClass" ? &b.mClass : &b.mClassLoader);
+    }
+
+    // getApiLevel and getIntegratedSensorFlags
+    static jint callIntMethodV(JNIEnv *env, jobject, jmethodID methodID,
+                               va_list) {
+        MockManagerBackend &b = fromEnv(env, "CallIntMethod");
+        const string &name = methodName(b, methodID);
+        b.jniCalls.back() += " " + name;
+        return name == "getApiLevel" ? 33 : 0;
+    }
+
+    static void callVoidMethodV(JNIEnv *env, jobject, jmethodID methodID,
+                                va_list) {
+        MockManagerBackend &b = fromEnv(env, "CallVoidMethod");
+        const string &name = methodName(b, methodID);
+        b.jniCalls.back() += " " + name;
+        if (name == "setNativeReady") b.mNativeReady = true;
+    }
+
+    static jobject newObjectV(JNIEnv *env, jclass, jmethodID, va_list) {
+        return handle(&fromEnv(env, "NewObject").mObject);
+    }
+
+    static jstring newStringUTF(JNIEnv *env, const char *) {
+        return static_cast<jstring>(
+            handle(fromEnv(env, "NewStringUTF").mClassName));
+    }
+
+    static const char *getStringUTFChars(JNIEnv *env, jstring string,
+                                         jboolean *) {
+        fromEnv(env, "GetStringUTFChars");
+        return object<const char>(string);
+    }
+
+    static void releaseStringUTFChars(JNIEnv *env, jstring, const char *) {
+        fromEnv(env, "ReleaseStringUTFChars");
+    }
+
+    static jint registerNatives(JNIEnv *env, jclass,
+                                const JNINativeMethod *methods,
+                                jint methodCount) {
+        MockManagerBackend &b = fromEnv(env, "RegisterNatives");
+        b.mNatives.assign(methods, methods + methodCount);
+        return JNI_OK;
+    }
+
+    static jobject newGlobalRef(JNIEnv *env, jobject object) {
+        fromEnv(env, "NewGlobalRef");
+        return object;
+    }
+
+    static void deleteRef(JNIEnv *env, jobject) { fromEnv(env, "DeleteRef"); }
+
+    static jsize getArrayLength(JNIEnv *env, jarray array) {
+        fromEnv(env, "GetArrayLength");
+        const FakeArray *fakeArray = object<FakeArray>(array);
+        return static_cast<jsize>(
+            std::max(fakeArray->ints.size(), fakeArray->floats.size()));
+    }
+
+    static void getIntArrayRegion(JNIEnv *env, jintArray array, jsize start,
+                                  jsize length, jint *out) {
+        fromEnv(env, "GetIntArrayRegion");
+        memcpy(out, object<FakeArray>(array)->ints.data() + start,
+               length * sizeof(jint));
+    }
+
+    static void getFloatArrayRegion(JNIEnv *env, jfloatArray array,
+                                    jsize start, jsize length, jfloat *out) {
+        fromEnv(env, "GetFloatArrayRegion");
+        memcpy(out, object<FakeArray>(array)->floats.data() + start,
+               length * sizeof(jfloat));
+    }
+
+    // Calls a native method registered by Paddleboat_init.
+    template <typename Method, typename... Args>
+    void callNative(const char *name, Args... args) {
+        ++nativeCalls;
+        for (const JNINativeMethod &method : mNatives) {
+            if (strcmp(method.name, name) == 0) {
+                reinterpret_cast<Method>(method.fnPtr)(env(), handle(&mObject),
+                                                       args...);
+                return;
+            }
+        }
+        ADD_FAILURE() << name << " isn't registered";
+    }
+
+    // onBatteryChanged
+    void push(const int32_t controllerIndex) {
+        Device &device = mDevices[controllerIndex];
+        device.sent = device.battery;
+        // Java 'enum' starts at 1, not 0.
+        callNative<void (*)(JNIEnv *, jobject, jint, jfloat, jint)>(
+            "onBatteryChanged", DEVICE_ID_BASE + controllerIndex,
+            device.battery.batteryLevel,
+            static_cast<jint>(device.battery.batteryStatus) + 1);
+    }
+
+    JNINativeInterface mFunctions = {};
+    FakeEnv mEnv;
+    // Objects whose addresses are the handles of the Java objects
+    char mContext = 0;
+    char mClassLoader = 0;
+    char mClass = 0;
+    char mObject = 0;
+    char mClassName[1] = {0};
+    char mDeviceName[16] = "Mock controller";
+    vector<string> mMethods;
+    vector<JNINativeMethod> mNatives;
+    bool mNativeReady = false;
+    Device mDevices[PADDLEBOAT_MAX_CONTROLLERS];
+    int64_t mNextCheckMs = BATTERY_CHECK_INTERVAL_MS;
+};
+
+// Runs Paddleboat on the mock, recording the battery callbacks.
+class ControllerManagerBatteryTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        ASSERT_EQ(Paddleboat_init(backend.env(), backend.context()),
+                  PADDLEBOAT_NO_ERROR);
+        Paddleboat_setControllerStatusCallback(onStatus, this);
+        Paddleboat_setControllerBatteryCallback(onBattery, this);
+        // The first update after Paddleboat_init tells Java to start sending
+        // controllers.
+        Paddleboat_update(backend.env());
+    }
+
+    void TearDown() override { Paddleboat_destroy(backend.env()); }
+
+    // Paddleboat_update, returning the battery changes it delivered and
+    // checking it made no JNI call.
+    vector<BatteryChange> update() {
+        const size_t jniCallsBefore = backend.jniCalls.size();
+        changes.clear();
+        Paddleboat_update(backend.env());
+        for (size_t i = jniCallsBefore; i < backend.jniCalls.size(); ++i) {
+            ADD_FAILURE() << "Paddleboat_update called " << backend.jniCalls[i];
+        }
+        return changes;
+    }
+
+    static void onStatus(const int32_t, const Paddleboat_ControllerStatus,
+                         void *) {}
+
+    static void onBattery(const int32_t controllerIndex,
+                          const Paddleboat_Controller_Battery *battery,
+                          void *userData) {
+        ControllerManagerBatteryTest *test =
+            static_cast<ControllerManagerBatteryTest *>(userData);
+        test->changes.push_back({controllerIndex, *battery});
+    }
+
+    MockManagerBackend backend;
+    vector<BatteryChange> changes;
+};
+}  // namespace
+
+TEST_F(ControllerManagerBatteryTest, NoJniCallsPerFrameInSteadyState) {
+    for (int32_t i = 0; i < 4; ++i) {
+        backend.connect(i, makeBattery(0.9f));
+    }
+
+    // Ten minutes at 60Hz, with two battery changes
+    constexpr int64_t FRAME_COUNT = 10 * 60 * 60;
+    int32_t framesWithNativeCalls = 0;
+    vector<BatteryChange> delivered = update();
+    EXPECT_EQ(delivered.size(), 4u);
+    for (int64_t frame = 1; frame <= FRAME_COUNT; ++frame) {
+        const int64_t timeMs = frame * 1000 / 60;
+        if (frame == 5000) {
+            backend.setBattery(1, makeBattery(0.8f));
+        } else if (frame == 20000) {
+            backend.setBattery(
+                3, makeBattery(0.8f, PADDLEBOAT_CONTROLLER_BATTERY_CHARGING));
+        }
+        const int32_t nativeCallsBefore = backend.nativeCalls;
+        backend.advanceTo(timeMs);
+        const vector<BatteryChange> frameChanges = update();
+        delivered.insert(delivered.end(), frameChanges.begin(),
+                         frameChanges.end());
+
+        const int32_t nativeCalls = backend.nativeCalls - nativeCallsBefore;
+        if (nativeCalls > 0) {
+            ++framesWithNativeCalls;
+            EXPECT_EQ(frameChanges.size(), static_cast<size_t>(nativeCalls));
+        }
+        if (HasFailure()) break;
+    }
+
+    // Only the frames in which a battery changed had a call across JNI.
+    EXPECT_EQ(framesWithNativeCalls, 2);
+    ASSERT_EQ(delivered.size(), 6u);
+    EXPECT_EQ(delivered[4].controllerIndex, 1);
+    EXPECT_EQ(delivered[4].battery.batteryLevel, 0.8f);
+    EXPECT_EQ(delivered[5].controllerIndex, 3);
+    EXPECT_EQ(delivered[5].battery.batteryStatus,
+              PADDLEBOAT_CONTROLLER_BATTERY_CHARGING);
+
+    // The controller data holds the latest state.
+    Paddleboat_Controller_Data data;
+    ASSERT_EQ(Paddleboat_getControllerData(3, &data), PADDLEBOAT_NO_ERROR);
+    EXPECT_EQ(data.battery.batteryLevel, 0.8f);
+    EXPECT_EQ(data.battery.batteryStatus,
+              PADDLEBOAT_CONTROLLER_BATTERY_CHARGING);
+}
+
+TEST_F(ControllerManagerBatteryTest, ReconnectionDeliversFirstState) {
+    backend.connect(0, makeBattery(0.5f));
+    EXPECT_EQ(update().size(), 1u);
+    backend.disconnect(0);
+    EXPECT_TRUE(update().empty());
+    backend.connect(0, makeBattery(0.5f));
+    const vector<BatteryChange> delivered = update();
+    ASSERT_EQ(delivered.size(), 1u);
+    EXPECT_EQ(delivered[0].controllerIndex, 0);
+    EXPECT_EQ(backend.nativeCalls, 5);
+}
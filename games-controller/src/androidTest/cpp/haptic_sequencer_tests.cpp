@@ -0,0 +1,365 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// This file contains unit tests for the HapticSequencer class. It has no JNI
+// dependency, so these can also be run on a Linux host.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "../../main/cpp/HapticSequencer.h"
+#include "paddleboat.h"
+
+using namespace paddleboat;
+using namespace std;
+
+namespace {
+// Records the batches sent by the sequencer instead of vibrating.
+class RecordingBackend : public HapticBackend {
+   public:
+    void setVibration(const HapticCommand *commands,
+                      const int32_t commandCount) override {
+        calls.emplace_back(commands, commands + commandCount);
+    }
+
+    vector<vector<HapticCommand>> calls;
+};
+
+Paddleboat_Haptic_Pattern makePattern(
+    const vector<Paddleboat_Haptic_Keyframe> &keyframes,
+    const int32_t durationMs, const int32_t loopCount = 0,
+    const int32_t fadeInMs = 0, const int32_t fadeOutMs = 0) {
+    Paddleboat_Haptic_Pattern pattern;
+    pattern.keyframes = keyframes.data();
+    pattern.keyframeCount = static_cast<int32_t>(keyframes.size());
+    pattern.durationMs = durationMs;
+    pattern.loopCount = loopCount;
+    pattern.fadeInMs = fadeInMs;
+    pattern.fadeOutMs = fadeOutMs;
+    return pattern;
+}
+
+void expectCommand(const HapticCommand &command, const int32_t controllerIndex,
+                   const int32_t left, const int32_t right) {
+    EXPECT_EQ(command.controllerIndex, controllerIndex);
+    EXPECT_EQ(command.intensityLeft, left);
+    EXPECT_EQ(command.intensityRight, right);
+}
+}  // namespace
+
+TEST(HapticSequencerTest, StepKeyframes) {
+    const vector<Paddleboat_Haptic_Keyframe> keyframes = {
+        {0, 1.0f, 0.5f, PADDLEBOAT_HAPTIC_STEP},
+        {100, 0.0f, 0.0f, PADDLEBOAT_HAPTIC_STEP}};
+    const Paddleboat_Haptic_Pattern pattern = makePattern(keyframes, 200);
+    HapticSequencer sequencer;
+    RecordingBackend backend;
+    ASSERT_TRUE(sequencer.play(0, pattern, 1000));
+
+    sequencer.update(1000, backend);
+    ASSERT_EQ(backend.calls.size(), 1u);
+    ASSERT_EQ(backend.calls[0].size(), 1u);
+    expectCommand(backend.calls[0][0], 0, 255, 128);
+    // Held until the next keyframe, plus the margin.
+    EXPECT_EQ(backend.calls[0][0].durationMs,
+              100 + HapticSequencer::HOLD_MARGIN_MS);
+
+    // Nothing changes until the next keyframe.
+    for (int64_t t = 1010; t < 1100; t += 10) {
+        sequencer.update(t, backend);
+    }
+    EXPECT_EQ(backend.calls.size(), 1u);
+
+    sequencer.update(1100, backend);
+    ASSERT_EQ(backend.calls.size(), 2u);
+    expectCommand(backend.calls[1][0], 0, 0, 0);
+    EXPECT_EQ(backend.calls[1][0].durationMs, 0);
+
+    // The pattern ends with the motors already off.
+    sequencer.update(1200, backend);
+    EXPECT_EQ(backend.calls.size(), 2u);
+    EXPECT_FALSE(sequencer.isPlaying(0));
+}
+
+TEST(HapticSequencerTest, LinearKeyframes) {
+    const vector<Paddleboat_Haptic_Keyframe> keyframes = {
+        {0, 0.0f, 1.0f, PADDLEBOAT_HAPTIC_LINEAR},
+        {100, 1.0f, 0.0f, PADDLEBOAT_HAPTIC_STEP}};
+    const Paddleboat_Haptic_Pattern pattern = makePattern(keyframes, 200);
+    HapticSequencer sequencer;
+    RecordingBackend backend;
+    ASSERT_TRUE(sequencer.play(0, pattern, 0));
+
+    sequencer.update(0, backend);
+    sequencer.update(25, backend);
+    sequencer.update(50, backend);
+    sequencer.update(100, backend);
+    ASSERT_EQ(backend.calls.size(), 4u);
+    expectCommand(backend.calls[0][0], 0, 0, 255);
+    expectCommand(backend.calls[1][0], 0, 64, 191);
+    expectCommand(backend.calls[2][0], 0, 128, 128);
+    expectCommand(backend.calls[3][0], 0, 255, 0);
+
+    // The last keyframe is held until the end, where the motors are turned
+    // off.
+    sequencer.update(150, backend);
+    EXPECT_EQ(backend.calls.size(), 4u);
+    sequencer.update(200, backend);
+    ASSERT_EQ(backend.calls.size(), 5u);
+    expectCommand(backend.calls[4][0], 0, 0, 0);
+}
+
+TEST(HapticSequencerTest, OffBeforeFirstKeyframe) {
+    const vector<Paddleboat_Haptic_Keyframe> keyframes = {
+        {100, 1.0f, 1.0f, PADDLEBOAT_HAPTIC_STEP}};
+    const Paddleboat_Haptic_Pattern pattern = makePattern(keyframes, 200);
+    HapticSequencer sequencer;
+    RecordingBackend backend;
+    ASSERT_TRUE(sequencer.play(0, pattern, 0));
+
+    sequencer.update(0, backend);
+    sequencer.update(50, backend);
+    EXPECT_TRUE(backend.calls.empty());
+    sequencer.update(100, backend);
+    ASSERT_EQ(backend.calls.size(), 1u);
+    expectCommand(backend.calls[0][0], 0, 255, 255);
+}
+
+TEST(HapticSequencerTest, ConstantVibrationIsRefreshed) {
+    const vector<Paddleboat_Haptic_Keyframe> keyframes = {
+        {0, 1.0f, 1.0f, PADDLEBOAT_HAPTIC_STEP}};
+    const Paddleboat_Haptic_Pattern pattern = makePattern(keyframes, 5000);
+    HapticSequencer sequencer;
+    RecordingBackend backend;
+    ASSERT_TRUE(sequencer.play(0, pattern, 0));
+
+    // Updates at 60Hz only send the vibration again before it runs out.
+    int64_t sentUntilMs = 0;
+    for (int64_t t = 0; t < 2500; t += 16) {
+        const size_t callCount = backend.calls.size();
+        sequencer.update(t, backend);
+        if (backend.calls.size() > callCount) {
+            EXPECT_LE(t, sentUntilMs);
+            sentUntilMs = t + backend.calls.back()[0].durationMs;
+        }
+        EXPECT_GT(sentUntilMs, t);
+    }
+    EXPECT_EQ(backend.calls.size(), 3u);
+}
+
+TEST(HapticSequencerTest, ControllersAreBatched) {
+    const vector<Paddleboat_Haptic_Keyframe> keyframes = {
+        {0, 1.0f, 0.0f, PADDLEBOAT_HAPTIC_STEP},
+        {100, 0.0f, 1.0f, PADDLEBOAT_HAPTIC_STEP}};
+    const Paddleboat_Haptic_Pattern pattern = makePattern(keyframes, 200);
+    HapticSequencer sequencer;
+    RecordingBackend backend;
+    ASSERT_TRUE(sequencer.play(1, pattern, 0));
+    ASSERT_TRUE(sequencer.play(3, pattern, 50));
+
+    sequencer.update(50, backend);
+    ASSERT_EQ(backend.calls.size(), 1u);
+    ASSERT_EQ(backend.calls[0].size(), 2u);
+    expectCommand(backend.calls[0][0], 1, 255, 0);
+    expectCommand(backend.calls[0][1], 3, 255, 0);
+
+    // Only the controller whose keyframe is reached is sent.
+    sequencer.update(100, backend);
+    ASSERT_EQ(backend.calls.size(), 2u);
+    ASSERT_EQ(backend.calls[1].size(), 1u);
+    expectCommand(backend.calls[1][0], 1, 0, 255);
+}
+
+TEST(HapticSequencerTest, Loops) {
+    const vector<Paddleboat_Haptic_Keyframe> keyframes = {
+        {0, 1.0f, 1.0f, PADDLEBOAT_HAPTIC_STEP},
+        {50, 0.0f, 0.0f, PADDLEBOAT_HAPTIC_STEP}};
+    const Paddleboat_Haptic_Pattern pattern = makePattern(keyframes, 100, 2);
+    HapticSequencer sequencer;
+    RecordingBackend backend;
+    ASSERT_TRUE(sequencer.play(0, pattern, 0));
+
+    for (int64_t t = 0; t <= 400; t += 10) {
+        sequencer.update(t, backend);
+    }
+    // Played three times
+    ASSERT_EQ(backend.calls.size(), 6u);
+    for (size_t i = 0; i < backend.calls.size(); ++i) {
+        const int32_t level = (i % 2 == 0) ? 255 : 0;
+        expectCommand(backend.calls[i][0], 0, level, level);
+    }
+    EXPECT_FALSE(sequencer.isPlaying(0));
+}
+
+TEST(HapticSequencerTest, LoopsForever) {
+    const vector<Paddleboat_Haptic_Keyframe> keyframes = {
+        {0, 1.0f, 1.0f, PADDLEBOAT_HAPTIC_STEP},
+        {50, 0.0f, 0.0f, PADDLEBOAT_HAPTIC_STEP}};
+    const Paddleboat_Haptic_Pattern pattern =
+        makePattern(keyframes, 100, PADDLEBOAT_HAPTIC_LOOP_FOREVER);
+    HapticSequencer sequencer;
+    RecordingBackend backend;
+    ASSERT_TRUE(sequencer.play(0, pattern, 0));
+
+    sequencer.update(1000000, backend);
+    sequencer.update(1000050, backend);
+    EXPECT_TRUE(sequencer.isPlaying(0));
+    ASSERT_EQ(backend.calls.size(), 2u);
+    expectCommand(backend.calls[0][0], 0, 255, 255);
+    expectCommand(backend.calls[1][0], 0, 0, 0);
+}
+
+TEST(HapticSequencerTest, FadeInAndOut) {
+    const vector<Paddleboat_Haptic_Keyframe> keyframes = {
+        {0, 1.0f, 1.0f, PADDLEBOAT_HAPTIC_STEP}};
+    const Paddleboat_Haptic_Pattern pattern =
+        makePattern(keyframes, 1000, 0, 100, 200);
+    HapticSequencer sequencer;
+    RecordingBackend backend;
+    ASSERT_TRUE(sequencer.play(0, pattern, 0));
+
+    sequencer.update(50, backend);
+    sequencer.update(100, backend);
+    sequencer.update(900, backend);
+    sequencer.update(1000, backend);
+    ASSERT_EQ(backend.calls.size(), 4u);
+    expectCommand(backend.calls[0][0], 0, 128, 128);
+    expectCommand(backend.calls[1][0], 0, 255, 255);
+    expectCommand(backend.calls[2][0], 0, 128, 128);
+    expectCommand(backend.calls[3][0], 0, 0, 0);
+}
+
+TEST(HapticSequencerTest, StopFadesOut) {
+    const vector<Paddleboat_Haptic_Keyframe> keyframes = {
+        {0, 1.0f, 1.0f, PADDLEBOAT_HAPTIC_STEP}};
+    const Paddleboat_Haptic_Pattern pattern =
+        makePattern(keyframes, 100, PADDLEBOAT_HAPTIC_LOOP_FOREVER, 0, 100);
+    HapticSequencer sequencer;
+    RecordingBackend backend;
+    ASSERT_TRUE(sequencer.play(0, pattern, 0));
+
+    sequencer.update(0, backend);
+    sequencer.stop(0, 500);
+    sequencer.update(550, backend);
+    EXPECT_TRUE(sequencer.isPlaying(0));
+    sequencer.update(600, backend);
+    EXPECT_FALSE(sequencer.isPlaying(0));
+    ASSERT_EQ(backend.calls.size(), 3u);
+    expectCommand(backend.calls[1][0], 0, 128, 128);
+    expectCommand(backend.calls[2][0], 0, 0, 0);
+}
+
+TEST(HapticSequencerTest, StopWithoutFadeOut) {
+    const vector<Paddleboat_Haptic_Keyframe> keyframes = {
+        {0, 1.0f, 1.0f, PADDLEBOAT_HAPTIC_STEP}};
+    const Paddleboat_Haptic_Pattern pattern =
+        makePattern(keyframes, 100, PADDLEBOAT_HAPTIC_LOOP_FOREVER);
+    HapticSequencer sequencer;
+    RecordingBackend backend;
+    ASSERT_TRUE(sequencer.play(2, pattern, 0));
+
+    sequencer.update(0, backend);
+    sequencer.stop(2, 30);
+    sequencer.update(30, backend);
+    ASSERT_EQ(backend.calls.size(), 2u);
+    expectCommand(backend.calls[1][0], 2, 0, 0);
+}
+
+TEST(HapticSequencerTest, CancelSendsNothing) {
+    const vector<Paddleboat_Haptic_Keyframe> keyframes = {
+        {0, 1.0f, 1.0f, PADDLEBOAT_HAPTIC_STEP}};
+    const Paddleboat_Haptic_Pattern pattern =
+        makePattern(keyframes, 100, PADDLEBOAT_HAPTIC_LOOP_FOREVER);
+    HapticSequencer sequencer;
+    RecordingBackend backend;
+    ASSERT_TRUE(sequencer.play(0, pattern, 0));
+
+    sequencer.update(0, backend);
+    sequencer.cancel(0);
+    EXPECT_FALSE(sequencer.isPlaying(0));
+    sequencer.update(10, backend);
+    sequencer.update(5000, backend);
+    EXPECT_EQ(backend.calls.size(), 1u);
+}
+
+TEST(HapticSequencerTest, ReplacingKeepsSentAmplitudes) {
+    const vector<Paddleboat_Haptic_Keyframe> keyframes = {
+        {0, 1.0f, 1.0f, PADDLEBOAT_HAPTIC_STEP}};
+    const Paddleboat_Haptic_Pattern pattern = makePattern(keyframes, 500);
+    HapticSequencer sequencer;
+    RecordingBackend backend;
+    ASSERT_TRUE(sequencer.play(0, pattern, 0));
+    sequencer.update(0, backend);
+    ASSERT_TRUE(sequencer.play(0, pattern, 100));
+    sequencer.update(100, backend);
+    EXPECT_EQ(backend.calls.size(), 1u);
+}
+
+TEST(HapticSequencerTest, InvalidPatterns) {
+    const vector<Paddleboat_Haptic_Keyframe> valid = {
+        {0, 1.0f, 1.0f, PADDLEBOAT_HAPTIC_STEP},
+        {100, 0.0f, 0.0f, PADDLEBOAT_HAPTIC_LINEAR}};
+    EXPECT_TRUE(HapticSequencer::isValidPattern(makePattern(valid, 100)));
+
+    Paddleboat_Haptic_Pattern pattern = makePattern(valid, 100);
+    pattern.keyframes = nullptr;
+    EXPECT_FALSE(HapticSequencer::isValidPattern(pattern));
+    pattern = makePattern(valid, 100);
+    pattern.keyframeCount = 0;
+    EXPECT_FALSE(HapticSequencer::isValidPattern(pattern));
+    EXPECT_FALSE(HapticSequencer::isValidPattern(makePattern(valid, 0)));
+    EXPECT_FALSE(HapticSequencer::isValidPattern(makePattern(valid, 99)));
+    EXPECT_FALSE(HapticSequencer::isValidPattern(makePattern(valid, 100, -2)));
+    EXPECT_FALSE(
+        HapticSequencer::isValidPattern(makePattern(valid, 100, 0, -1)));
+    EXPECT_FALSE(
+        HapticSequencer::isValidPattern(makePattern(valid, 100, 0, 0, -1)));
+
+    const vector<Paddleboat_Haptic_Keyframe> tooMany(
+        PADDLEBOAT_HAPTIC_MAX_KEYFRAMES + 1,
+        {0, 1.0f, 1.0f, PADDLEBOAT_HAPTIC_STEP});
+    EXPECT_FALSE(HapticSequencer::isValidPattern(makePattern(tooMany, 100)));
+
+    const vector<Paddleboat_Haptic_Keyframe> decreasing = {
+        {50, 1.0f, 1.0f, PADDLEBOAT_HAPTIC_STEP},
+        {10, 0.0f, 0.0f, PADDLEBOAT_HAPTIC_STEP}};
+    EXPECT_FALSE(HapticSequencer::isValidPattern(makePattern(decreasing, 100)));
+
+    const vector<Paddleboat_Haptic_Keyframe> tooStrong = {
+        {0, 1.5f, 1.0f, PADDLEBOAT_HAPTIC_STEP}};
+    EXPECT_FALSE(HapticSequencer::isValidPattern(makePattern(tooStrong, 100)));
+
+    const vector<Paddleboat_Haptic_Keyframe> notANumber = {
+        {0, 1.0f, NAN, PADDLEBOAT_HAPTIC_STEP}};
+    EXPECT_FALSE(HapticSequencer::isValidPattern(makePattern(notANumber, 100)));
+
+    vector<Paddleboat_Haptic_Keyframe> badInterpolation = valid;
+    badInterpolation[0].interpolation =
+        static_cast<Paddleboat_Haptic_Interpolation>(7);
+    EXPECT_FALSE(
+        HapticSequencer::isValidPattern(makePattern(badInterpolation, 100)));
+
+    HapticSequencer sequencer;
+    RecordingBackend backend;
+    EXPECT_FALSE(sequencer.play(0, makePattern(decreasing, 100), 0));
+    EXPECT_FALSE(sequencer.play(PADDLEBOAT_MAX_CONTROLLERS,
+                                makePattern(valid, 100), 0));
+    EXPECT_FALSE(sequencer.isPlaying(0));
+    sequencer.update(0, backend);
+    EXPECT_TRUE(backend.calls.empty());
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ControllerBatteryMonitor.h"
+
+namespace paddleboat {
+
+bool ControllerBatteryMonitor::onBatteryChanged(
+    const int32_t controllerIndex,
+    const Paddleboat_Controller_Battery &battery) {
+    if (controllerIndex < 0 || controllerIndex >= PADDLEBOAT_MAX_CONTROLLERS) {
+        return false;
+    }
+    State &state = mStates[controllerIndex];
+    if (state.hasReported && isSameBattery(state.reported, battery)) {
+        return false;
+    }
+    state.reported = battery;
+    state.hasReported = true;
+    mPendingMask |= 1u << controllerIndex;
+    return true;
+}
+
+void ControllerBatteryMonitor::reset(const int32_t controllerIndex) {
+    if (controllerIndex < 0 || controllerIndex >= PADDLEBOAT_MAX_CONTROLLERS) {
+        return;
+    }
+    mStates[controllerIndex] = State();
+    mPendingMask &= ~(1u << controllerIndex);
+}
+}  // namespace paddleboat
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "paddleboat.h"
+
+namespace paddleboat {
+
+// Battery states pushed by the Java GameControllerManager, which checks them
+// on its own thread, and delivered to the game by Paddleboat_update. States
+// reported between two updates are coalesced, and a state equal to the one
+// last delivered isn't delivered again. It has no JNI dependency and isn't
+// thread safe: the caller serializes calls.
+class ControllerBatteryMonitor {
+   public:
+    // Returns false, doing nothing, if the state is the one already reported
+    // for the controller.
+    bool onBatteryChanged(const int32_t controllerIndex,
+                          const Paddleboat_Controller_Battery &battery);
+
+    // Forgets the controller, so that the first state reported for the next
+    // controller with this index is always delivered.
+    void reset(const int32_t controllerIndex);
+
+    bool hasPendingChanges() const { return mPendingMask != 0; }
+
+    // Calls onChange(controllerIndex, battery) for each controller whose state
+    // changed since the last dispatch.
+    template <typename OnChange>
+    void dispatch(OnChange onChange) {
+        uint32_t pendingMask = mPendingMask;
+        mPendingMask = 0;
+        for (int32_t i = 0; pendingMask != 0; ++i, pendingMask >>= 1) {
+            State &state = mStates[i];
+            if ((pendingMask & 1) == 0 ||
+                (state.hasDelivered &&
+                 isSameBattery(state.reported, state.delivered))) {
+                continue;
+            }
+            state.delivered = state.reported;
+            state.hasDelivered = true;
+            onChange(i, state.delivered);
+        }
+    }
+
+   private:
+    struct State {
+        Paddleboat_Controller_Battery reported = {
+            PADDLEBOAT_CONTROLLER_BATTERY_UNKNOWN, 0.0f};
+        Paddleboat_Controller_Battery delivered = {
+            PADDLEBOAT_CONTROLLER_BATTERY_UNKNOWN, 0.0f};
+        bool hasReported = false;
+        bool hasDelivered = false;
+    };
+
+    static bool isSameBattery(const Paddleboat_Controller_Battery &a,
+                              const Paddleboat_Controller_Battery &b) {
+        return a.batteryStatus == b.batteryStatus &&
+               a.batteryLevel == b.batteryLevel;
+    }
+
+    State mStates[PADDLEBOAT_MAX_CONTROLLERS];
+    // Bit i is set when controller i has a state reported since the last
+    // dispatch.
+    uint32_t mPendingMask = 0;
+};
+}  // namespace paddleboat
@@ -17,6 +17,7 @@
 
 #include <android/api-level.h>
 
+#include <chrono>
 #include <cstdlib>
 #include <fcntl.h>
 #include <memory>
@@ -106,6 +107,13 @@ void Java_com_google_android_games_paddleboat_GameControllerManager_onController
     paddleboat::GameControllerManager::onDisconnection(deviceId);
 }
 
+void Java_com_google_android_games_paddleboat_GameControllerManager_onBatteryChanged(
+    JNIEnv *env, jobject gcmObject, jint deviceId, jfloat batteryLevel,
+    jint batteryStatus) {
+    paddleboat::GameControllerManager::onBatteryChanged(deviceId, batteryLevel,
+                                                        batteryStatus);
+}
+
 void Java_com_google_android_games_paddleboat_GameControllerManager_onMotionData(
     JNIEnv *env, jobject gcmObject, jint deviceId, jint motionType,
     jlong timestamp, jfloat dataX, jfloat dataY, jfloat dataZ) {
@@ -153,10 +161,6 @@ constexpr const char *GCM_ONSTOP_METHOD_NAME = "onStop";
 constexpr const char *GCM_ONSTART_METHOD_NAME = "onStart";
 constexpr const char *GCM_GETAPILEVEL_METHOD_NAME = "getApiLevel";
 constexpr const char *GCM_GETAPILEVEL_METHOD_SIGNATURE = "()I";
-constexpr const char *GCM_GETBATTERYLEVEL_METHOD_NAME = "getBatteryLevel";
-constexpr const char *GCM_GETBATTERYLEVEL_METHOD_SIGNATURE = "(I)F";
-constexpr const char *GCM_GETBATTERYSTATUS_METHOD_NAME = "getBatteryStatus";
-constexpr const char *GCM_GETBATTERYSTATUS_METHOD_SIGNATURE = "(I)I";
 constexpr const char *GCM_GETINTEGRATED_METHOD_NAME = "getIntegratedSensorFlags";
 constexpr const char *GCM_GETINTEGRATED_METHOD_SIGNATURE = "()I";
 constexpr const char *GCM_SETACTIVESENSOR_METHOD_NAME = "setActiveIntegratedSensors";
@@ -168,11 +172,17 @@ constexpr const char *GCM_SETREPORTMOTIONEVENTS_METHOD_NAME =
     "setReportMotionEvents";
 constexpr const char *GCM_SETVIBRATION_METHOD_NAME = "setVibration";
 constexpr const char *GCM_SETVIBRATION_METHOD_SIGNATURE = "(IIIII)V";
+constexpr const char *GCM_SETVIBRATIONBATCH_METHOD_NAME = "setVibrationBatch";
+constexpr const char *GCM_SETVIBRATIONBATCH_METHOD_SIGNATURE = "([I)V";
 
 constexpr const char *VOID_METHOD_SIGNATURE = "()V";
 
 constexpr float VIBRATION_INTENSITY_SCALE = 255.0f;
 
+// Number of ints per vibration in the array passed to setVibrationBatch:
+// deviceId, leftIntensity, leftDuration, rightIntensity, rightDuration
+constexpr int32_t VIBRATION_BATCH_STRIDE = 5;
+
 typedef struct MethodTableEntry {
     const char *methodName;
     const char *methodSignature;
@@ -186,6 +196,9 @@ const JNINativeMethod GCM_NATIVE_METHODS[] = {
     {"onControllerDisconnected", "(I)V",
      reinterpret_cast<void *>(
          Java_com_google_android_games_paddleboat_GameControllerManager_onControllerDisconnected)},
+    {"onBatteryChanged", "(IFI)V",
+     reinterpret_cast<void *>(
+         Java_com_google_android_games_paddleboat_GameControllerManager_onBatteryChanged)},
     {"onMotionData", "(IIJFFF)V",
      reinterpret_cast<void *>(
          Java_com_google_android_games_paddleboat_GameControllerManager_onMotionData)},
@@ -320,16 +333,14 @@ Paddleboat_ErrorCode GameControllerManager::initMethods(JNIEnv *env) {
         {GCM_INIT_METHOD_NAME, GCM_INIT_METHOD_SIGNATURE, &mInitMethodId},
         {GCM_GETAPILEVEL_METHOD_NAME, GCM_GETAPILEVEL_METHOD_SIGNATURE,
          &mGetApiLevelMethodId},
-        {GCM_GETBATTERYLEVEL_METHOD_NAME, GCM_GETBATTERYLEVEL_METHOD_SIGNATURE,
-         &mGetBatteryLevelMethodId},
-        {GCM_GETBATTERYSTATUS_METHOD_NAME,
-         GCM_GETBATTERYSTATUS_METHOD_SIGNATURE, &mGetBatteryStatusMethodId},
         {GCM_GETINTEGRATED_METHOD_NAME,
          GCM_GETINTEGRATED_METHOD_SIGNATURE, &mGetIntegratedSensorMethodId},
         {GCM_SETACTIVESENSOR_METHOD_NAME,
          GCM_SETACTIVESENSOR_METHOD_SIGNATURE, &mSetActiveIntegratedSensorsMethodId},
         {GCM_SETVIBRATION_METHOD_NAME, GCM_SETVIBRATION_METHOD_SIGNATURE,
          &mSetVibrationMethodId},
+        {GCM_SETVIBRATIONBATCH_METHOD_NAME,
+         GCM_SETVIBRATIONBATCH_METHOD_SIGNATURE, &mSetVibrationBatchMethodId},
         {GCM_SETLIGHT_METHOD_NAME, GCM_SETLIGHT_METHOD_SIGNATURE,
          &mSetLightMethodId},
         {GCM_SETNATIVEREADY_METHOD_NAME, VOID_METHOD_SIGNATURE,
@@ -899,7 +910,8 @@ void GameControllerManager::update(JNIEnv *env) {
             }
         }
     }
-    gcm->updateBattery(env);
+    gcm->updateHaptics(env);
+    gcm->updateBattery();
 }
 
 Paddleboat_ErrorCode GameControllerManager::getControllerData(
@@ -1086,6 +1098,13 @@ Paddleboat_ErrorCode GameControllerManager::setControllerVibrationData(
                          PADDLEBOAT_CONTROLLER_FLAG_VIBRATION) != 0) {
                         if (gcm->mGameControllerObject != NULL &&
                             gcm->mSetVibrationMethodId != NULL) {
+                            {
+                                // The vibration set here replaces any
+                                // haptic pattern.
+                                std::lock_guard<std::mutex> lock(
+                                    gcm->mHapticMutex);
+                                gcm->mHapticSequencer.cancel(controllerIndex);
+                            }
                             const jint intensityLeft =
                                 static_cast<jint>(vibrationData->intensityLeft *
                                                   VIBRATION_INTENSITY_SCALE);
@@ -1120,6 +1139,117 @@ Paddleboat_ErrorCode GameControllerManager::setControllerVibrationData(
     return errorCode;
 }
 
+namespace {
+int64_t getHapticTimeMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Sends the vibration changes of an update with a single JNI call.
+class JniHapticBackend : public HapticBackend {
+   public:
+    JniHapticBackend(JNIEnv *env, jobject gameControllerObject,
+                     jmethodID setVibrationBatchMethodId,
+                     const GameController *gameControllers)
+        : mEnv(env),
+          mGameControllerObject(gameControllerObject),
+          mSetVibrationBatchMethodId(setVibrationBatchMethodId),
+          mGameControllers(gameControllers) {}
+
+    void setVibration(const HapticCommand *commands,
+                      const int32_t commandCount) override {
+        jint vibrations[PADDLEBOAT_MAX_CONTROLLERS * VIBRATION_BATCH_STRIDE];
+        for (int32_t i = 0; i < commandCount; ++i) {
+            const HapticCommand &command = commands[i];
+            jint *vibration = vibrations + i * VIBRATION_BATCH_STRIDE;
+            vibration[0] = mGameControllers[command.controllerIndex]
+                               .getControllerInfo()
+                               .deviceId;
+            vibration[1] = command.intensityLeft;
+            vibration[2] = command.durationMs;
+            vibration[3] = command.intensityRight;
+            vibration[4] = command.durationMs;
+        }
+        const jsize length = commandCount * VIBRATION_BATCH_STRIDE;
+        jintArray vibrationArray = mEnv->NewIntArray(length);
+        if (vibrationArray == NULL) {
+            return;
+        }
+        mEnv->SetIntArrayRegion(vibrationArray, 0, length, vibrations);
+        mEnv->CallVoidMethod(mGameControllerObject, mSetVibrationBatchMethodId,
+                             vibrationArray);
+        mEnv->DeleteLocalRef(vibrationArray);
+    }
+
+   private:
+    JNIEnv *mEnv;
+    jobject mGameControllerObject;
+    jmethodID mSetVibrationBatchMethodId;
+    const GameController *mGameControllers;
+};
+}  // namespace
+
+Paddleboat_ErrorCode GameControllerManager::playControllerHapticPattern(
+    const int32_t controllerIndex, const Paddleboat_Haptic_Pattern *pattern) {
+    Paddleboat_ErrorCode errorCode = PADDLEBOAT_NO_ERROR;
+
+    if (pattern != nullptr && HapticSequencer::isValidPattern(*pattern)) {
+        if (controllerIndex >= 0 &&
+            controllerIndex < PADDLEBOAT_MAX_CONTROLLERS) {
+            GameControllerManager *gcm = getInstance();
+            if (gcm) {
+                if (gcm->mGameControllers[controllerIndex]
+                        .getConnectionIndex() == controllerIndex) {
+                    const Paddleboat_Controller_Info &controllerInfo =
+                        gcm->mGameControllers[controllerIndex]
+                            .getControllerInfo();
+                    if ((controllerInfo.controllerFlags &
+                         PADDLEBOAT_CONTROLLER_FLAG_VIBRATION) != 0) {
+                        std::lock_guard<std::mutex> lock(gcm->mHapticMutex);
+                        gcm->mHapticSequencer.play(controllerIndex, *pattern,
+                                                   getHapticTimeMs());
+                    } else {
+                        errorCode = PADDLEBOAT_ERROR_FEATURE_NOT_SUPPORTED;
+                    }
+                } else {
+                    errorCode = PADDLEBOAT_ERROR_NO_CONTROLLER;
+                }
+            } else {
+                errorCode = PADDLEBOAT_ERROR_NOT_INITIALIZED;
+            }
+        } else {
+            errorCode = PADDLEBOAT_ERROR_INVALID_CONTROLLER_INDEX;
+        }
+    } else {
+        errorCode = PADDLEBOAT_ERROR_INVALID_PARAMETER;
+    }
+    return errorCode;
+}
+
+Paddleboat_ErrorCode GameControllerManager::stopControllerHapticPattern(
+    const int32_t controllerIndex) {
+    Paddleboat_ErrorCode errorCode = PADDLEBOAT_NO_ERROR;
+
+    if (controllerIndex >= 0 && controllerIndex < PADDLEBOAT_MAX_CONTROLLERS) {
+        GameControllerManager *gcm = getInstance();
+        if (gcm) {
+            if (gcm->mGameControllers[controllerIndex].getConnectionIndex() ==
+                controllerIndex) {
+                std::lock_guard<std::mutex> lock(gcm->mHapticMutex);
+                gcm->mHapticSequencer.stop(controllerIndex, getHapticTimeMs());
+            } else {
+                errorCode = PADDLEBOAT_ERROR_NO_CONTROLLER;
+            }
+        } else {
+            errorCode = PADDLEBOAT_ERROR_NOT_INITIALIZED;
+        }
+    } else {
+        errorCode = PADDLEBOAT_ERROR_INVALID_CONTROLLER_INDEX;
+    }
+    return errorCode;
+}
+
 GameControllerDeviceInfo *GameControllerManager::onConnection() {
     GameControllerDeviceInfo *deviceInfo = nullptr;
     GameControllerManager *gcm = getInstance();
@@ -1144,6 +1274,29 @@ GameControllerDeviceInfo *GameControllerManager::onConnection() {
     return deviceInfo;
 }
 
+void GameControllerManager::onBatteryChanged(const int32_t deviceId,
+                                             const float batteryLevel,
+                                             const int32_t batteryStatus) {
+    GameControllerManager *gcm = getInstance();
+    if (gcm) {
+        std::lock_guard<std::mutex> lock(gcm->mUpdateMutex);
+        for (size_t i = 0; i < PADDLEBOAT_MAX_CONTROLLERS; ++i) {
+            const GameControllerDeviceInfo &deviceInfo =
+                gcm->mGameControllers[i].getDeviceInfo();
+            if (gcm->mGameControllers[i].getConnectionIndex() >= 0 &&
+                deviceInfo.getInfo().mDeviceId == deviceId) {
+                Paddleboat_Controller_Battery battery;
+                battery.batteryLevel = batteryLevel;
+                // Java 'enum' starts at 1, not 0.
+                battery.batteryStatus =
+                    static_cast<Paddleboat_BatteryStatus>(batteryStatus - 1);
+                gcm->mBatteryMonitor.onBatteryChanged(i, battery);
+                break;
+            }
+        }
+    }
+}
+
 void GameControllerManager::onDisconnection(const int32_t deviceId) {
     GameControllerManager *gcm = getInstance();
     if (gcm) {
@@ -1155,6 +1308,9 @@ void GameControllerManager::onDisconnection(const int32_t deviceId) {
                 if (deviceInfo.getInfo().mDeviceId == deviceId) {
                     gcm->mGameControllers[i].setControllerStatus(
                         PADDLEBOAT_CONTROLLER_JUST_DISCONNECTED);
+                    gcm->mBatteryMonitor.reset(i);
+                    std::lock_guard<std::mutex> hapticLock(gcm->mHapticMutex);
+                    gcm->mHapticSequencer.cancel(i);
 #if defined LOG_INPUT_EVENTS
                     ALOGI(
                         "Setting PADDLEBOAT_CONTROLLER_JUST_DISCONNECTED on "
@@ -1428,6 +1584,15 @@ void GameControllerManager::setControllerStatusCallback(
     }
 }
 
+void GameControllerManager::setControllerBatteryCallback(
+    Paddleboat_ControllerBatteryCallback batteryCallback, void *userData) {
+    GameControllerManager *gcm = getInstance();
+    if (gcm) {
+        gcm->mBatteryCallback = batteryCallback;
+        gcm->mBatteryCallbackUserData = userData;
+    }
+}
+
 // device debug helper function
 int32_t GameControllerManager::getLastKeycode() {
     GameControllerManager *gcm = getInstance();
@@ -1467,37 +1632,30 @@ void GameControllerManager::onStart(JNIEnv *env) {
     }
 }
 
-void GameControllerManager::updateBattery(JNIEnv *env) {
-    if (mBatteryWait <= 0) {
-        mBatteryWait = BATTERY_REFRESH_WAIT;
-
-        for (size_t i = 0; i < PADDLEBOAT_MAX_CONTROLLERS; ++i) {
-            if (mGameControllers[i].getControllerStatus() ==
-                PADDLEBOAT_CONTROLLER_ACTIVE) {
-                const Paddleboat_Controller_Info &controllerInfo =
-                    mGameControllers[i].getControllerInfo();
-                if ((controllerInfo.controllerFlags &
-                     PADDLEBOAT_CONTROLLER_FLAG_BATTERY) != 0) {
-                    Paddleboat_Controller_Data &controllerData =
-                        mGameControllers[i].getControllerData();
-                    const jint deviceId = controllerInfo.deviceId;
-                    jfloat batteryLevel = env->CallFloatMethod(
-                        mGameControllerObject, mGetBatteryLevelMethodId,
-                        deviceId);
-                    jint batteryStatus =
-                        env->CallIntMethod(mGameControllerObject,
-                                           mGetBatteryStatusMethodId, deviceId);
-                    controllerData.battery.batteryLevel = batteryLevel;
-                    // Java 'enum' starts at 1, not 0.
-                    controllerData.battery.batteryStatus =
-                        static_cast<Paddleboat_BatteryStatus>(batteryStatus -
-                                                              1);
-                }
+void GameControllerManager::updateBattery() {
+    if (!mBatteryMonitor.hasPendingChanges()) {
+        return;
+    }
+    mBatteryMonitor.dispatch(
+        [this](const int32_t controllerIndex,
+               const Paddleboat_Controller_Battery &battery) {
+            mGameControllers[controllerIndex].getControllerData().battery =
+                battery;
+            if (mBatteryCallback != nullptr) {
+                mBatteryCallback(controllerIndex, &battery,
+                                 mBatteryCallbackUserData);
             }
-        }
-    } else {
-        --mBatteryWait;
+        });
+}
+
+void GameControllerManager::updateHaptics(JNIEnv *env) {
+    if (mGameControllerObject == NULL || mSetVibrationBatchMethodId == NULL) {
+        return;
     }
+    JniHapticBackend backend(env, mGameControllerObject,
+                             mSetVibrationBatchMethodId, mGameControllers);
+    std::lock_guard<std::mutex> lock(mHapticMutex);
+    mHapticSequencer.update(getHapticTimeMs(), backend);
 }
 
 void GameControllerManager::updateMouseDataTimestamp() {
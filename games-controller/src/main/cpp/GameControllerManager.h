@@ -21,8 +21,10 @@
 
 #include <mutex>
 
+#include "ControllerBatteryMonitor.h"
 #include "GameController.h"
 #include "GameControllerMappingInfo.h"
+#include "HapticSequencer.h"
 #include "ThreadUtil.h"
 
 namespace paddleboat {
@@ -37,10 +39,6 @@ class GameControllerManager {
     static constexpr int32_t MAX_MOUSE_DEVICES = 2;
     static constexpr int32_t INVALID_MOUSE_ID = -1;
 
-    // Assuming update is getting called at 60Hz, wait one minute in between
-    // checking battery status
-    static constexpr int32_t BATTERY_REFRESH_WAIT = 60 * 60;
-
    public:
     GameControllerManager(JNIEnv *env, jobject jcontext, ConstructorTag);
 
@@ -71,6 +69,9 @@ class GameControllerManager {
     static void setControllerStatusCallback(
         Paddleboat_ControllerStatusCallback statusCallback, void *userData);
 
+    static void setControllerBatteryCallback(
+        Paddleboat_ControllerBatteryCallback batteryCallback, void *userData);
+
     static Paddleboat_ErrorCode setMotionDataCallback(
         Paddleboat_MotionDataCallback motionDataCallback,
         Paddleboat_Integrated_Motion_Sensor_Flags integratedFlags, void *userData);
@@ -105,6 +106,13 @@ class GameControllerManager {
         const int32_t controllerIndex,
         const Paddleboat_Vibration_Data *vibrationData, JNIEnv *env);
 
+    static Paddleboat_ErrorCode playControllerHapticPattern(
+        const int32_t controllerIndex,
+        const Paddleboat_Haptic_Pattern *pattern);
+
+    static Paddleboat_ErrorCode stopControllerHapticPattern(
+        const int32_t controllerIndex);
+
     static Paddleboat_ErrorCode getMouseData(Paddleboat_Mouse_Data *mouseData);
 
     static Paddleboat_MouseStatus getMouseStatus();
@@ -142,6 +150,10 @@ class GameControllerManager {
 
     static void onDisconnection(const int32_t deviceId);
 
+    static void onBatteryChanged(const int32_t deviceId,
+                                 const float batteryLevel,
+                                 const int32_t batteryStatus);
+
     static void onKeyboardConnection(const int32_t deviceId);
 
     static void onKeyboardDisconnection(const int32_t deviceId);
@@ -188,7 +200,9 @@ class GameControllerManager {
 
     void rescanVirtualMouseControllers();
 
-    void updateBattery(JNIEnv *env);
+    void updateBattery();
+
+    void updateHaptics(JNIEnv *env);
 
     void updateMouseDataTimestamp();
 
@@ -205,21 +219,19 @@ class GameControllerManager {
     bool mPhysicalKeyboardConnected = false;
 
     int32_t mApiLevel = 16;
-    int32_t mBatteryWait = BATTERY_REFRESH_WAIT;
     uint32_t mIntegratedSensorFlags = 0;
     jobject mContext = NULL;
     jclass mGameControllerClass = NULL;
     jobject mGameControllerObject = NULL;
     jmethodID mInitMethodId = NULL;
     jmethodID mGetApiLevelMethodId = NULL;
-    jmethodID mGetBatteryLevelMethodId = NULL;
-    jmethodID mGetBatteryStatusMethodId = NULL;
     jmethodID mGetIntegratedSensorMethodId = NULL;
     jmethodID mSetActiveIntegratedSensorsMethodId = NULL;
     jmethodID mSetLightMethodId = NULL;
     jmethodID mSetNativeReadyMethodId = NULL;
     jmethodID mSetReportMotionEventsMethodId = NULL;
     jmethodID mSetVibrationMethodId = NULL;
+    jmethodID mSetVibrationBatchMethodId = NULL;
 
     uint64_t mActiveAxisMask = 0;
 
@@ -233,6 +245,11 @@ class GameControllerManager {
     GameController mGameControllers[PADDLEBOAT_MAX_CONTROLLERS];
     Paddleboat_ControllerStatusCallback mStatusCallback = nullptr;
     void *mStatusCallbackUserData = nullptr;
+    // Battery states pushed from the Java side, delivered by update
+    ControllerBatteryMonitor mBatteryMonitor;
+    Paddleboat_ControllerBatteryCallback mBatteryCallback = nullptr;
+    void *mBatteryCallbackUserData = nullptr;
+    HapticSequencer mHapticSequencer;
     // device debug helper
     int32_t mLastKeyEventKeyCode = 0;
 
@@ -248,6 +265,9 @@ class GameControllerManager {
     void *mMouseCallbackUserData = nullptr;
 
     std::mutex mUpdateMutex;
+    // Guards mHapticSequencer, which games may use from the status callback
+    // while mUpdateMutex is held. Locked after mUpdateMutex when both are.
+    std::mutex mHapticMutex;
     static std::mutex sInstanceMutex;
     static std::unique_ptr<GameControllerManager> sInstance
         GUARDED_BY(sInstanceMutex);
@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "HapticSequencer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace paddleboat {
+
+namespace {
+bool isValidIntensity(const float intensity) {
+    return intensity >= 0.0f && intensity <= 1.0f;
+}
+
+int32_t toAmplitude(const float intensity, const float gain) {
+    const int32_t amplitude = static_cast<int32_t>(
+        std::lround(intensity * gain * HapticSequencer::INTENSITY_SCALE));
+    return std::clamp(amplitude, 0, HapticSequencer::INTENSITY_SCALE);
+}
+}  // namespace
+
+bool HapticSequencer::isValidPattern(const Paddleboat_Haptic_Pattern &pattern) {
+    if (pattern.keyframes == nullptr || pattern.keyframeCount < 1 ||
+        pattern.keyframeCount > PADDLEBOAT_HAPTIC_MAX_KEYFRAMES ||
+        pattern.durationMs <= 0 ||
+        pattern.loopCount < PADDLEBOAT_HAPTIC_LOOP_FOREVER ||
+        pattern.fadeInMs < 0 || pattern.fadeOutMs < 0) {
+        return false;
+    }
+    int32_t previousTimeMs = 0;
+    for (int32_t i = 0; i < pattern.keyframeCount; ++i) {
+        const Paddleboat_Haptic_Keyframe &keyframe = pattern.keyframes[i];
+        if (keyframe.timeMs < previousTimeMs ||
+            keyframe.timeMs > pattern.durationMs ||
+            !isValidIntensity(keyframe.intensityLeft) ||
+            !isValidIntensity(keyframe.intensityRight) ||
+            (keyframe.interpolation != PADDLEBOAT_HAPTIC_STEP &&
+             keyframe.interpolation != PADDLEBOAT_HAPTIC_LINEAR)) {
+            return false;
+        }
+        previousTimeMs = keyframe.timeMs;
+    }
+    return true;
+}
+
+bool HapticSequencer::play(const int32_t controllerIndex,
+                           const Paddleboat_Haptic_Pattern &pattern,
+                           const int64_t nowMs) {
+    if (controllerIndex < 0 || controllerIndex >= PADDLEBOAT_MAX_CONTROLLERS ||
+        !isValidPattern(pattern)) {
+        return false;
+    }
+    // The amplitudes last sent are kept, so that a pattern replacing another
+    // doesn't send them again.
+    Playback &playback = mPlaybacks[controllerIndex];
+    memcpy(playback.keyframes, pattern.keyframes,
+           sizeof(Paddleboat_Haptic_Keyframe) * pattern.keyframeCount);
+    playback.keyframeCount = pattern.keyframeCount;
+    playback.durationMs = pattern.durationMs;
+    playback.fadeInMs = pattern.fadeInMs;
+    playback.fadeOutMs = pattern.fadeOutMs;
+    playback.startMs = nowMs;
+    playback.endMs =
+        pattern.loopCount == PADDLEBOAT_HAPTIC_LOOP_FOREVER
+            ? INT64_MAX
+            : nowMs + static_cast<int64_t>(pattern.durationMs) *
+                          (static_cast<int64_t>(pattern.loopCount) + 1);
+    playback.active = true;
+    return true;
+}
+
+void HapticSequencer::stop(const int32_t controllerIndex, const int64_t nowMs) {
+    if (controllerIndex < 0 || controllerIndex >= PADDLEBOAT_MAX_CONTROLLERS) {
+        return;
+    }
+    Playback &playback = mPlaybacks[controllerIndex];
+    if (playback.active) {
+        playback.endMs = std::min(playback.endMs, nowMs + playback.fadeOutMs);
+    }
+}
+
+void HapticSequencer::cancel(const int32_t controllerIndex) {
+    if (controllerIndex < 0 || controllerIndex >= PADDLEBOAT_MAX_CONTROLLERS) {
+        return;
+    }
+    Playback &playback = mPlaybacks[controllerIndex];
+    playback.active = false;
+    playback.sentLeft = 0;
+    playback.sentRight = 0;
+    playback.sentUntilMs = 0;
+}
+
+bool HapticSequencer::isPlaying(const int32_t controllerIndex) const {
+    if (controllerIndex < 0 || controllerIndex >= PADDLEBOAT_MAX_CONTROLLERS) {
+        return false;
+    }
+    return mPlaybacks[controllerIndex].active;
+}
+
+void HapticSequencer::sample(const Playback &playback, const int64_t timeMs,
+                             int32_t *left, int32_t *right,
+                             int64_t *holdUntilMs) {
+    const int64_t elapsedMs = timeMs - playback.startMs;
+    const int64_t loopStartMs = timeMs - elapsedMs % playback.durationMs;
+    const int32_t patternMs =
+        static_cast<int32_t>(elapsedMs % playback.durationMs);
+
+    // The motors are off until the first keyframe.
+    float intensityLeft = 0.0f;
+    float intensityRight = 0.0f;
+    int32_t nextChangeMs = playback.keyframes[0].timeMs;
+    if (patternMs >= playback.keyframes[0].timeMs) {
+        int32_t index = 0;
+        while (index + 1 < playback.keyframeCount &&
+               playback.keyframes[index + 1].timeMs <= patternMs) {
+            ++index;
+        }
+        const Paddleboat_Haptic_Keyframe &keyframe = playback.keyframes[index];
+        intensityLeft = keyframe.intensityLeft;
+        intensityRight = keyframe.intensityRight;
+        if (index + 1 < playback.keyframeCount) {
+            const Paddleboat_Haptic_Keyframe &next =
+                playback.keyframes[index + 1];
+            nextChangeMs = next.timeMs;
+            if (keyframe.interpolation == PADDLEBOAT_HAPTIC_LINEAR) {
+                const float t =
+                    static_cast<float>(patternMs - keyframe.timeMs) /
+                    static_cast<float>(next.timeMs - keyframe.timeMs);
+                intensityLeft +=
+                    t * (next.intensityLeft - keyframe.intensityLeft);
+                intensityRight +=
+                    t * (next.intensityRight - keyframe.intensityRight);
+            }
+        } else {
+            // The last keyframe is held until the end of the pattern.
+            nextChangeMs = playback.durationMs;
+        }
+    }
+
+    // Envelope of the whole playback
+    float gain = 1.0f;
+    if (elapsedMs < playback.fadeInMs) {
+        gain = static_cast<float>(elapsedMs) /
+               static_cast<float>(playback.fadeInMs);
+    }
+    if (playback.endMs - timeMs < playback.fadeOutMs) {
+        gain = std::min(gain, static_cast<float>(playback.endMs - timeMs) /
+                                  static_cast<float>(playback.fadeOutMs));
+    }
+
+    *left = toAmplitude(intensityLeft, gain);
+    *right = toAmplitude(intensityRight, gain);
+    *holdUntilMs = std::min({loopStartMs + nextChangeMs, playback.endMs,
+                             timeMs + MAX_HOLD_MS});
+}
+
+void HapticSequencer::update(const int64_t nowMs, HapticBackend &backend) {
+    HapticCommand commands[PADDLEBOAT_MAX_CONTROLLERS];
+    int32_t commandCount = 0;
+
+    for (int32_t i = 0; i < PADDLEBOAT_MAX_CONTROLLERS; ++i) {
+        Playback &playback = mPlaybacks[i];
+        if (playback.active && nowMs >= playback.endMs) {
+            playback.active = false;
+        }
+        int32_t left = 0;
+        int32_t right = 0;
+        int64_t holdUntilMs = nowMs;
+        if (playback.active) {
+            sample(playback, nowMs, &left, &right, &holdUntilMs);
+        }
+
+        const bool on = left != 0 || right != 0;
+        const bool changed =
+            left != playback.sentLeft || right != playback.sentRight;
+        const bool runningOut =
+            on && nowMs >= playback.sentUntilMs - HOLD_MARGIN_MS;
+        if (!changed && !runningOut) {
+            continue;
+        }
+        const int32_t durationMs =
+            on ? static_cast<int32_t>(holdUntilMs - nowMs) + HOLD_MARGIN_MS
+               : 0;
+        commands[commandCount++] = {i, left, right, durationMs};
+        playback.sentLeft = left;
+        playback.sentRight = right;
+        playback.sentUntilMs = nowMs + durationMs;
+    }
+
+    if (commandCount > 0) {
+        backend.setVibration(commands, commandCount);
+    }
+}
+}  // namespace paddleboat
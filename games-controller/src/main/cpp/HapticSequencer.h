@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "paddleboat.h"
+
+namespace paddleboat {
+
+// A change of the vibration of a controller, with intensities scaled to the
+// 0-255 amplitudes of the Java side. An intensity of 0 turns the motor off.
+struct HapticCommand {
+    int32_t controllerIndex;
+    int32_t intensityLeft;
+    int32_t intensityRight;
+    int32_t durationMs;
+};
+
+// Where HapticSequencer sends vibration changes, JNI calls to the Java
+// GameControllerManager, or a recording in tests.
+class HapticBackend {
+   public:
+    virtual ~HapticBackend() = default;
+
+    // Called at most once per HapticSequencer::update, with the changes of
+    // all controllers.
+    virtual void setVibration(const HapticCommand *commands,
+                              const int32_t commandCount) = 0;
+};
+
+// Plays the Paddleboat_Haptic_Pattern of each controller. Patterns are sampled
+// at each update, and only changes of the amplitudes sent to the Java side
+// are emitted. It has no JNI dependency and isn't thread safe: the caller
+// serializes calls.
+class HapticSequencer {
+   public:
+    static constexpr int32_t INTENSITY_SCALE = 255;
+    // A vibration is sent with a duration that ends this long after the next
+    // keyframe, so an update a little late doesn't leave a gap.
+    static constexpr int32_t HOLD_MARGIN_MS = 100;
+    // Constant vibrations are sent again after this long, to bound how long a
+    // controller keeps vibrating if updates stop.
+    static constexpr int32_t MAX_HOLD_MS = 1000;
+
+    static bool isValidPattern(const Paddleboat_Haptic_Pattern &pattern);
+
+    // Returns false, doing nothing, if the pattern isn't valid.
+    bool play(const int32_t controllerIndex,
+              const Paddleboat_Haptic_Pattern &pattern, const int64_t nowMs);
+
+    // Fades out the pattern from now.
+    void stop(const int32_t controllerIndex, const int64_t nowMs);
+
+    // Forgets the pattern without turning the motors off, when the controller
+    // is disconnected or its vibration is set directly.
+    void cancel(const int32_t controllerIndex);
+
+    bool isPlaying(const int32_t controllerIndex) const;
+
+    void update(const int64_t nowMs, HapticBackend &backend);
+
+   private:
+    struct Playback {
+        bool active = false;
+        Paddleboat_Haptic_Keyframe keyframes[PADDLEBOAT_HAPTIC_MAX_KEYFRAMES];
+        int32_t keyframeCount = 0;
+        int32_t durationMs = 0;
+        int32_t fadeInMs = 0;
+        int32_t fadeOutMs = 0;
+        int64_t startMs = 0;
+        // INT64_MAX while looping forever and not stopped
+        int64_t endMs = 0;
+        // Last amplitudes sent and when they run out
+        int32_t sentLeft = 0;
+        int32_t sentRight = 0;
+        int64_t sentUntilMs = 0;
+    };
+
+    // Amplitudes of a playback at a time before its end, and the time until
+    // which they may stay constant.
+    static void sample(const Playback &playback, const int64_t timeMs,
+                       int32_t *left, int32_t *right, int64_t *holdUntilMs);
+
+    Playback mPlaybacks[PADDLEBOAT_MAX_CONTROLLERS];
+};
+}  // namespace paddleboat
@@ -44,7 +44,7 @@ extern "C" {
 #endif
 
 #define PADDLEBOAT_MAJOR_VERSION 2
-#define PADDLEBOAT_MINOR_VERSION 1
+#define PADDLEBOAT_MINOR_VERSION 2
 #define PADDLEBOAT_BUGFIX_VERSION 0
 #define PADDLEBOAT_PACKED_VERSION                            \
     ANDROID_GAMESDK_PACKED_VERSION(PADDLEBOAT_MAJOR_VERSION, \
@@ -69,6 +69,17 @@ extern "C" {
  */
 #define PADDLEBOAT_MAPPING_FILE_IDENTIFIER 0xadd1eb0a
 
+/**
+ * @brief The maximum number of keyframes in a `Paddleboat_Haptic_Pattern`.
+ */
+#define PADDLEBOAT_HAPTIC_MAX_KEYFRAMES 32
+
+/**
+ * @brief Value of `Paddleboat_Haptic_Pattern.loopCount` to repeat a pattern
+ * until it is stopped or replaced.
+ */
+#define PADDLEBOAT_HAPTIC_LOOP_FOREVER (-1)
+
 /**
  * @brief Paddleboat error code results.
  */
@@ -546,6 +557,17 @@ enum Paddleboat_LightType : uint32_t {
                               ///< `lightData` is a ARGB (8888) light value.
 };
 
+/**
+ * @brief How the vibration intensities change from a
+ * `Paddleboat_Haptic_Keyframe` to the next one.
+ */
+enum Paddleboat_Haptic_Interpolation : uint32_t {
+    PADDLEBOAT_HAPTIC_STEP = 0,   ///< Intensities are held until the next
+                                  ///< keyframe
+    PADDLEBOAT_HAPTIC_LINEAR = 1  ///< Intensities ramp linearly to those of
+                                  ///< the next keyframe
+};
+
 /**
  * @brief The type of motion data being reported in a Paddleboat_Motion_Data
  * structure
@@ -674,7 +696,9 @@ typedef struct Paddleboat_Controller_Data {
     /**
      * @brief Battery status. This structure will only be populated if the
      * controller has `PADDLEBOAT_CONTROLLER_FLAG_BATTERY` set in
-     * `Paddleboat_Controller_Info.controllerFlags`
+     * `Paddleboat_Controller_Info.controllerFlags`. It is updated by
+     * ::Paddleboat_update when the battery state changes, see
+     * ::Paddleboat_setControllerBatteryCallback.
      */
     Paddleboat_Controller_Battery battery;
 } Paddleboat_Controller_Data;
@@ -759,6 +783,52 @@ typedef struct Paddleboat_Vibration_Data {
     float intensityRight;
 } Paddleboat_Vibration_Data;
 
+/**
+ * @brief A point of a `Paddleboat_Haptic_Pattern`, setting the intensities of
+ * both motors at a time of the pattern.
+ */
+typedef struct Paddleboat_Haptic_Keyframe {
+    /** @brief Time of the keyframe from the start of the pattern in
+     * milliseconds. */
+    int32_t timeMs;
+    /** @brief Intensity of the left motor, valid range is 0.0 to 1.0. */
+    float intensityLeft;
+    /** @brief Intensity of the right motor, valid range is 0.0 to 1.0. */
+    float intensityRight;
+    /** @brief How the intensities change until the next keyframe. */
+    Paddleboat_Haptic_Interpolation interpolation;
+} Paddleboat_Haptic_Keyframe;
+
+/**
+ * @brief A structure that describes a vibration pattern played by
+ * ::Paddleboat_playControllerHapticPattern.
+ *
+ * The motors are off until the first keyframe, and the intensities of the last
+ * keyframe are held until the end of the pattern. The whole playback, with its
+ * repeats, is scaled by an envelope that fades in at its start and fades out
+ * at its end or when it is stopped.
+ */
+typedef struct Paddleboat_Haptic_Pattern {
+    /** @brief Keyframes of the pattern, in increasing order of time. */
+    const Paddleboat_Haptic_Keyframe *keyframes;
+    /** @brief Number of keyframes, between 1 and
+     * PADDLEBOAT_HAPTIC_MAX_KEYFRAMES. */
+    int32_t keyframeCount;
+    /** @brief Duration of the pattern in milliseconds, at least the time of
+     * the last keyframe and more than 0. */
+    int32_t durationMs;
+    /** @brief Number of times the pattern is repeated after it is played
+     * once, or PADDLEBOAT_HAPTIC_LOOP_FOREVER. */
+    int32_t loopCount;
+    /** @brief Duration of the fade in at the start of the playback in
+     * milliseconds, 0 for none. */
+    int32_t fadeInMs;
+    /** @brief Duration of the fade out at the end of the playback, or after
+     * ::Paddleboat_stopControllerHapticPattern, in milliseconds, 0 for
+     * none. */
+    int32_t fadeOutMs;
+} Paddleboat_Haptic_Pattern;
+
 /**
  * @brief A structure that describes the button and axis mappings
  * for a specified controller device running on a specified range of Android API
@@ -819,6 +889,23 @@ typedef void (*Paddleboat_ControllerStatusCallback)(
     const int32_t controllerIndex,
     const Paddleboat_ControllerStatus controllerStatus, void *userData);
 
+/**
+ * @brief Signature of a function that can be passed to
+ * ::Paddleboat_setControllerBatteryCallback to receive the battery state of
+ * controllers when it changes.
+ * @param controllerIndex Index of the controller whose battery state changed,
+ * will range from 0 to PADDLEBOAT_MAX_CONTROLLERS - 1.
+ * @param battery The new battery state. Pointer is only valid until the
+ * callback returns.
+ * @param userData The value of the userData parameter passed
+ * to ::Paddleboat_setControllerBatteryCallback
+ *
+ * Function will be called on the same thread that calls ::Paddleboat_update.
+ */
+typedef void (*Paddleboat_ControllerBatteryCallback)(
+    const int32_t controllerIndex,
+    const Paddleboat_Controller_Battery *battery, void *userData);
+
 /**
  * @brief Signature of a function that can be passed to
  * ::Paddleboat_setMouseStatusCallback to receive information about mouse
@@ -993,6 +1080,22 @@ void Paddleboat_setBackButtonConsumed(bool consumeBackButton);
 void Paddleboat_setControllerStatusCallback(
     Paddleboat_ControllerStatusCallback statusCallback, void *userData);
 
+/**
+ * @brief Set a callback to be called when the battery state of a controller
+ * with `PADDLEBOAT_CONTROLLER_FLAG_BATTERY` changes, and once with its first
+ * state after it connects. Battery states are checked about once a minute on a
+ * Java thread, independently of ::Paddleboat_update, and the changes are
+ * delivered by the next call to ::Paddleboat_update.
+ * @param batteryCallback function pointer to the battery change callback,
+ * passing NULL or nullptr will remove any currently registered callback.
+ * @param userData optional pointer (may be NULL or nullptr) to user data that
+ * will be passed as a parameter to the battery callback. A reference to this
+ * pointer will be retained internally until changed by a future call to
+ * ::Paddleboat_setControllerBatteryCallback
+ */
+void Paddleboat_setControllerBatteryCallback(
+    Paddleboat_ControllerBatteryCallback batteryCallback, void *userData);
+
 /**
  * @brief Set a callback which is called whenever a controller managed by
  * Paddleboat reports a motion data event.
@@ -1145,6 +1248,35 @@ Paddleboat_ErrorCode Paddleboat_setControllerLight(
 Paddleboat_ErrorCode Paddleboat_setControllerVibrationData(
     const int32_t controllerIndex,
     const Paddleboat_Vibration_Data *vibrationData, JNIEnv *env);
+/**
+ * @brief Play a vibration pattern on the controller with the specified index,
+ * replacing any pattern it is playing.
+ *
+ * The pattern is played by ::Paddleboat_update, which only sends the changes
+ * of intensity, of all controllers at once, to the Java side. Each intensity
+ * is sent with a duration that ends shortly after the next keyframe, so the
+ * motors stop if ::Paddleboat_update is no longer called. A call to
+ * ::Paddleboat_setControllerVibrationData stops the pattern.
+ * @param controllerIndex The index of the controller to vibrate, must be
+ * between 0 and PADDLEBOAT_MAX_CONTROLLERS - 1.
+ * @param pattern The pattern to play. The pattern and its keyframes are copied
+ * and do not need to persist after function return.
+ * @return `PADDLEBOAT_NO_ERROR` if successful, otherwise an error code.
+ * `PADDLEBOAT_ERROR_INVALID_PARAMETER` if the pattern is not valid.
+ */
+Paddleboat_ErrorCode Paddleboat_playControllerHapticPattern(
+    const int32_t controllerIndex, const Paddleboat_Haptic_Pattern *pattern);
+
+/**
+ * @brief Stop the vibration pattern played on the controller with the
+ * specified index, after the fade out of the pattern if it has one.
+ * @param controllerIndex The index of the controller, must be between 0 and
+ * PADDLEBOAT_MAX_CONTROLLERS - 1.
+ * @return `PADDLEBOAT_NO_ERROR` if successful, otherwise an error code.
+ */
+Paddleboat_ErrorCode Paddleboat_stopControllerHapticPattern(
+    const int32_t controllerIndex);
+
 /**
  * @brief Retrieve the current mouse data.
  * @param[out] mouseData pointer to the mouse data struct to populate.
@@ -96,6 +96,12 @@ void Paddleboat_setControllerStatusCallback(
                                                        userData);
 }
 
+void Paddleboat_setControllerBatteryCallback(
+    Paddleboat_ControllerBatteryCallback batteryCallback, void *userData) {
+    GameControllerManager::setControllerBatteryCallback(batteryCallback,
+                                                        userData);
+}
+
 void Paddleboat_setMotionDataCallback(
     Paddleboat_MotionDataCallback motionDataCallback, void *userData) {
     GameControllerManager::setMotionDataCallback(motionDataCallback,
@@ -159,6 +165,17 @@ Paddleboat_ErrorCode Paddleboat_setControllerVibrationData(
         controllerIndex, vibrationData, env);
 }
 
+Paddleboat_ErrorCode Paddleboat_playControllerHapticPattern(
+    const int32_t controllerIndex, const Paddleboat_Haptic_Pattern *pattern) {
+    return GameControllerManager::playControllerHapticPattern(controllerIndex,
+                                                              pattern);
+}
+
+Paddleboat_ErrorCode Paddleboat_stopControllerHapticPattern(
+    const int32_t controllerIndex) {
+    return GameControllerManager::stopControllerHapticPattern(controllerIndex);
+}
+
 Paddleboat_ErrorCode Paddleboat_getMouseData(Paddleboat_Mouse_Data *mouseData) {
     return GameControllerManager::getMouseData(mouseData);
 }
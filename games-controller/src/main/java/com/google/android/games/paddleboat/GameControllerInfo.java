@@ -48,6 +48,11 @@ public class GameControllerInfo {
 
     private GameControllerListener mListener = null;
 
+    // Last battery state sent to the native side
+    private boolean mBatteryStateSent = false;
+    private float mBatteryLevel = 0.0f;
+    private int mBatteryStatus = 0;
+
     GameControllerInfo(InputDevice inputDevice) {
         mGameControllerDeviceInfoArray = new int[DEVICEINFO_ARRAY_SIZE];
         mGameControllerAxisMinArray = new float[MAX_AXIS_COUNT];
@@ -82,6 +87,18 @@ public class GameControllerInfo {
         mListener = listener;
     }
 
+    // Returns true, and records the battery state as sent, if it differs from the last one sent
+    public boolean UpdateBatteryState(float batteryLevel, int batteryStatus) {
+        if (mBatteryStateSent && mBatteryLevel == batteryLevel &&
+                mBatteryStatus == batteryStatus) {
+            return false;
+        }
+        mBatteryStateSent = true;
+        mBatteryLevel = batteryLevel;
+        mBatteryStatus = batteryStatus;
+        return true;
+    }
+
     public int GetGameControllerDeviceId() {
         return mGameControllerDeviceInfoArray[DEVICEINFO_INDEX_DEVICEID];
     }
@@ -448,6 +448,7 @@ public class GameControllerManager {
             gameControllerInfo.SetListener(gameControllerListener);
             gameControllers.add(gameControllerInfo);
             notifyNativeConnection(gameControllerInfo);
+            checkBatteryState(gameControllerInfo);
         }
         return gameControllerInfo;
     }
@@ -727,6 +728,28 @@ public class GameControllerManager {
         return BatteryManager.BATTERY_STATUS_UNKNOWN;
     }
 
+    // Sends the battery state of each controller to the native side if it changed. Called
+    // periodically by the GameControllerThread, so the native update never has to poll it.
+    void checkBatteryStates() {
+        if (!nativeReady) {
+            return;
+        }
+        for (int index = 0; index < gameControllers.size(); ++index) {
+            checkBatteryState(gameControllers.get(index));
+        }
+    }
+
+    private void checkBatteryState(GameControllerInfo controller) {
+        if ((controller.GetGameControllerFlags() & DEVICEFLAG_BATTERY) != 0) {
+            int deviceId = controller.GetGameControllerDeviceId();
+            float batteryLevel = getBatteryLevel(deviceId);
+            int batteryStatus = getBatteryStatus(deviceId);
+            if (controller.UpdateBatteryState(batteryLevel, batteryStatus)) {
+                onBatteryChanged(deviceId, batteryLevel, batteryStatus);
+            }
+        }
+    }
+
     public void setLight(int deviceId, int lightType, int lightValue) {
         for (int index = 0; index < gameControllers.size(); ++index) {
             GameControllerInfo controller = gameControllers.get(index);
@@ -785,6 +808,15 @@ public class GameControllerManager {
         }
     }
 
+    // Called by the native haptic pattern sequencer with all of the vibration changes of an
+    // update, as groups of deviceId, leftIntensity, leftDuration, rightIntensity, rightDuration.
+    public void setVibrationBatch(int[] vibrations) {
+        for (int i = 0; i + 4 < vibrations.length; i += 5) {
+            setVibration(vibrations[i], vibrations[i + 1], vibrations[i + 2], vibrations[i + 3],
+                    vibrations[i + 4]);
+        }
+    }
+
     public String getDeviceNameById(int deviceId) {
         InputDevice inputDevice = inputManager.getInputDevice(deviceId);
         if (inputDevice != null) {
@@ -1012,6 +1044,8 @@ public class GameControllerManager {
 
     public native void onControllerDisconnected(int deviceId);
 
+    public native void onBatteryChanged(int deviceId, float batteryLevel, int batteryStatus);
+
     public native void onKeyboardConnected(int deviceId);
 
     public native void onKeyboardDisconnected(int deviceid);
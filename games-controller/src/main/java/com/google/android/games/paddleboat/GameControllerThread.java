@@ -22,9 +22,18 @@ import java.lang.Thread;
 
 public class GameControllerThread extends Thread implements InputManager.InputDeviceListener {
     private static final String TAG = "GameControllerThread";
+    // Interval between checks of the battery state of controllers
+    private static final long BATTERY_CHECK_INTERVAL_MS = 60 * 1000;
     private boolean activeInputDeviceListener = false;
     private GameControllerManager mGameControllerManager;
     private Handler mHandler;
+    private final Runnable mBatteryCheck = new Runnable() {
+        @Override
+        public void run() {
+            mGameControllerManager.checkBatteryStates();
+            mHandler.postDelayed(this, BATTERY_CHECK_INTERVAL_MS);
+        }
+    };
 
     public void setGameControllerManager(GameControllerManager gcManager) {
         mGameControllerManager = gcManager;
@@ -42,6 +51,7 @@ public class GameControllerThread extends Thread implements InputManager.InputDe
         if (activeInputDeviceListener) {
             Log.d(TAG, "unregisterInputDeviceListener");
             mGameControllerManager.getAppInputManager().unregisterInputDeviceListener(this);
+            mHandler.removeCallbacks(mBatteryCheck);
             activeInputDeviceListener = false;
         }
     }
@@ -50,6 +60,8 @@ public class GameControllerThread extends Thread implements InputManager.InputDe
         if (!activeInputDeviceListener) {
             Log.d(TAG, "registerInputDeviceListener");
             mGameControllerManager.getAppInputManager().registerInputDeviceListener(this, mHandler);
+            // Check now, since battery states may have changed while stopped
+            mHandler.post(mBatteryCheck);
             activeInputDeviceListener = true;
         }
     }
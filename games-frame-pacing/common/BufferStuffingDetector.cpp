@@ -0,0 +1,88 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BufferStuffingDetector.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "Trace.h"
+
+namespace swappy {
+
+constexpr int32_t BufferStuffingDetector::DEFAULT_STUFFED_FRAMES;
+constexpr int32_t BufferStuffingDetector::MAX_DRAIN_FRAMES;
+
+void BufferStuffingDetector::setStuffedFramesThreshold(int32_t nFrames) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mThreshold = std::max(0, nFrames);
+    mStuffedFrames = 0;
+}
+
+void BufferStuffingDetector::onFramePresented(int64_t desiredPresentTime,
+                                              int64_t actualPresentTime,
+                                              int64_t refreshPeriod) {
+    if (desiredPresentTime <= 0 || actualPresentTime <= 0 ||
+        refreshPeriod <= 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mThreshold == 0) return;
+
+    const int64_t lateness = actualPresentTime - desiredPresentTime;
+    const int64_t margin = refreshPeriod / 2;
+
+    if (mDrainFrames > 0) {
+        // Frames queued before the drain are as late as before it.
+        if (lateness > mDrainLateness - margin) {
+            --mDrainFrames;
+            return;
+        }
+        mDrainFrames = 0;
+    }
+
+    const bool stuffed = lateness >= margin;
+    const bool sameLateness =
+        mStuffedFrames == 0 || std::abs(lateness - mLastLateness) < margin;
+    if (!stuffed) {
+        mStuffedFrames = 0;
+    } else if (sameLateness) {
+        ++mStuffedFrames;
+    } else {
+        mStuffedFrames = 1;
+    }
+    mLastLateness = lateness;
+    TRACE_INT("StuffedFrames", mStuffedFrames);
+
+    if (mStuffedFrames >= mThreshold) {
+        mDrainRequested = true;
+        mStuffedFrames = 0;
+        mDrainFrames = MAX_DRAIN_FRAMES;
+        mDrainLateness = lateness;
+    }
+}
+
+void BufferStuffingDetector::reset() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStuffedFrames = 0;
+    mLastLateness = 0;
+    mDrainFrames = 0;
+    mDrainLateness = 0;
+    mDrainRequested = false;
+}
+
+}  // namespace swappy
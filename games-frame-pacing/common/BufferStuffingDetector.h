@@ -0,0 +1,74 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "Thread.h"
+
+namespace swappy {
+
+// Detects buffer stuffing from the desired and actual present times of frames.
+//
+// When a frame is presented late, e.g. because its GPU work took too long, the
+// frames queued behind it are presented late too. If the app keeps submitting
+// one frame per swap interval, the compositor queue never drains: every frame
+// is then presented the same number of vsyncs after its desired time, and the
+// extra latency stays. Such a build-up is recognized as a run of consecutive
+// frames presented at least half a refresh period late, by the same amount.
+// Once a run reaches the threshold, one drain is requested: the caller delays
+// its next frame by one vsync, which removes exactly one buffer from the
+// queue. Frames that were already queued when the drain happened are ignored,
+// up to MAX_DRAIN_FRAMES, before looking again.
+class BufferStuffingDetector {
+   public:
+    static constexpr int32_t DEFAULT_STUFFED_FRAMES = 3;
+    static constexpr int32_t MAX_DRAIN_FRAMES = 20;
+
+    // Number of consecutive stuffed frames needed to request a drain, 0 to
+    // disable the detection.
+    void setStuffedFramesThreshold(int32_t nFrames);
+
+    // Called for each frame whose present timings are known, in order. Times
+    // are in nanoseconds on the same clock. Frames without a desired or actual
+    // present time are ignored.
+    void onFramePresented(int64_t desiredPresentTime, int64_t actualPresentTime,
+                          int64_t refreshPeriod);
+
+    // Returns true once for each drain requested.
+    bool consumeDrainRequest() {
+        return mDrainRequested.load(std::memory_order_relaxed) &&
+               mDrainRequested.exchange(false);
+    }
+
+    void reset();
+
+   private:
+    std::mutex mMutex;
+    int32_t mThreshold GUARDED_BY(mMutex) = DEFAULT_STUFFED_FRAMES;
+    int32_t mStuffedFrames GUARDED_BY(mMutex) = 0;
+    int64_t mLastLateness GUARDED_BY(mMutex) = 0;
+    // While non zero, frames presented as late as the ones that triggered the
+    // last drain are ignored.
+    int32_t mDrainFrames GUARDED_BY(mMutex) = 0;
+    int64_t mDrainLateness GUARDED_BY(mMutex) = 0;
+    std::atomic<bool> mDrainRequested = {false};
+};
+
+}  // namespace swappy
@@ -16,64 +16,38 @@
 
 #include "CPUTracer.h"
 
-#include <memory>
-
 #include "Trace.h"
 
 namespace swappy {
 
-CPUTracer::CPUTracer() {}
-
-CPUTracer::~CPUTracer() { joinThread(); }
-
-void CPUTracer::joinThread() {
-    bool join = false;
-    if (mThread && mThread->joinable()) {
-        std::lock_guard<std::mutex> lock(mMutex);
-        mTrace = false;
-        mRunning = false;
-        mCond.notify_one();
-        join = true;
-    }
-    if (join) {
-        mThread->join();
-    }
-    mThread.reset();
-}
+namespace {
+constexpr const char* CPU_FRAME_TIME_SECTION = "Swappy: CPU frame time";
+constexpr const char* CPU_FRAME_TIME_COUNTER = "Swappy: CPU frame time (ns)";
+}  // anonymous namespace
 
 void CPUTracer::startTrace() {
-    if (TRACE_ENABLED()) {
-        std::lock_guard<std::mutex> lock(mMutex);
-        if (!mThread) {
-            mRunning = true;
-            mThread = std::make_unique<Thread>([this]() { threadMain(); });
-        }
-        mTrace = true;
-        mCond.notify_one();
-    } else {
-        joinThread();
+    if (!TRACE_ENABLED()) {
+        return;
     }
+
+    mCookie++;
+    mTracing = true;
+    gamesdk::Trace::getInstance()->beginAsyncSection(CPU_FRAME_TIME_SECTION,
+                                                     mCookie);
 }
 
-void CPUTracer::endTrace() {
-    if (TRACE_ENABLED()) {
-        std::lock_guard<std::mutex> lock(mMutex);
-        mTrace = false;
-        mCond.notify_one();
-    } else {
-        joinThread();
+void CPUTracer::endTrace(std::chrono::nanoseconds cpuTime) {
+    // A section is closed even if tracing was turned off in the meantime, so
+    // that it is not left dangling.
+    if (mTracing) {
+        gamesdk::Trace::getInstance()->endAsyncSection(CPU_FRAME_TIME_SECTION,
+                                                       mCookie);
+        mTracing = false;
     }
-}
 
-void CPUTracer::threadMain() NO_THREAD_SAFETY_ANALYSIS {
-    std::unique_lock<std::mutex> lock(mMutex);
-    while (mRunning) {
-        if (mTrace) {
-            gamesdk::ScopedTrace trace("Swappy: CPU frame time");
-            mCond.wait(lock);
-        } else {
-            mCond.wait(lock);
-        }
+    if (TRACE_ENABLED()) {
+        gamesdk::Trace::getInstance()->setCounter(CPU_FRAME_TIME_COUNTER,
+                                                  cpuTime.count());
     }
 }
 
@@ -16,33 +16,27 @@
 
 #pragma once
 
-#include <condition_variable>
-#include <memory>
-#include <mutex>
-
-#include "Thread.h"
+#include <chrono>
+#include <cstdint>
 
 namespace swappy {
 
+// Shows the CPU time of each frame in traces: as an async section from the
+// start of the frame to the next swap, with the frame number as cookie, and as
+// a counter holding the frame's CPU time. Both calls are made from the thread
+// calling swap.
 class CPUTracer {
    public:
-    CPUTracer();
-    ~CPUTracer();
+    CPUTracer() = default;
 
     CPUTracer(CPUTracer&) = delete;
 
     void startTrace();
-    void endTrace();
+    void endTrace(std::chrono::nanoseconds cpuTime);
 
    private:
-    void threadMain();
-    void joinThread();
-
-    std::mutex mMutex;
-    std::condition_variable_any mCond GUARDED_BY(mMutex);
-    std::unique_ptr<Thread> mThread;
-    bool mRunning GUARDED_BY(mMutex) = true;
-    bool mTrace GUARDED_BY(mMutex) = false;
+    int32_t mCookie = 0;
+    bool mTracing = false;
 };
 
 }  // namespace swappy
@@ -99,7 +99,7 @@ class Timer {
 
    private:
     std::chrono::nanoseconds mRefreshPeriod;
-    const std::chrono::nanoseconds mAppToSfDelay;
+    std::chrono::nanoseconds mAppToSfDelay;
     time_point mBaseTime = std::chrono::steady_clock::now();
 
     time_point mLastTimestamp = std::chrono::steady_clock::now();
@@ -107,6 +107,35 @@ class Timer {
     int32_t mRepeatCount = 0;
 };
 
+void applySettings(const swappy::Settings::Snapshot& settings, int cpu,
+                   bool* useAffinity, std::chrono::nanoseconds* refreshPeriod,
+                   Timer* timer) {
+    if (settings.useAffinity != *useAffinity && cpu >= 0) {
+        if (settings.useAffinity) {
+            swappy::setAffinity(cpu);
+        } else {
+            swappy::setAffinity(swappy::Affinity::None);
+        }
+    }
+    *useAffinity = settings.useAffinity;
+
+    // Display timings are not known until Swappy sets them
+    const auto& displayTimings = settings.displayTimings;
+    if (displayTimings.refreshPeriod == 0ns ||
+        displayTimings.refreshPeriod == *refreshPeriod) {
+        return;
+    }
+
+    *refreshPeriod = displayTimings.refreshPeriod;
+    *timer = Timer(displayTimings.refreshPeriod,
+                   displayTimings.sfOffset - displayTimings.appOffset);
+    SWAPPY_LOGV(
+        "applySettings(): refreshPeriod=%lld, appOffset=%lld, sfOffset=%lld",
+        (long long)displayTimings.refreshPeriod.count(),
+        (long long)displayTimings.appOffset.count(),
+        (long long)displayTimings.sfOffset.count());
+}
+
 }  // anonymous namespace
 
 namespace swappy {
@@ -117,17 +146,10 @@ ChoreographerFilter::ChoreographerFilter(std::chrono::nanoseconds refreshPeriod,
     : mRefreshPeriod(refreshPeriod),
       mAppToSfDelay(appToSfDelay),
       mDoWork(doWork) {
-    Settings::getInstance()->addListener([this]() { onSettingsChanged(); });
-
-    std::lock_guard<std::mutex> lock(mThreadPoolMutex);
-    mUseAffinity = Settings::getInstance()->getUseAffinity();
-    launchThreadsLocked();
+    launchThreads();
 }
 
-ChoreographerFilter::~ChoreographerFilter() {
-    std::lock_guard<std::mutex> lock(mThreadPoolMutex);
-    terminateThreadsLocked();
-}
+ChoreographerFilter::~ChoreographerFilter() { terminateThreads(); }
 
 void ChoreographerFilter::onChoreographer(
     std::optional<std::chrono::nanoseconds> sfToVsyncDelay) {
@@ -138,7 +160,7 @@ void ChoreographerFilter::onChoreographer(
     mCondition.notify_all();
 }
 
-void ChoreographerFilter::launchThreadsLocked() {
+void ChoreographerFilter::launchThreads() {
     {
         std::lock_guard<std::mutex> lock(mMutex);
         mIsRunning = true;
@@ -147,11 +169,11 @@ void ChoreographerFilter::launchThreadsLocked() {
     const int32_t numThreads = getNumCpus() > 2 ? 2 : 1;
     for (int32_t thread = 0; thread < numThreads; ++thread) {
         mThreadPool.push_back(
-            Thread([this, thread]() { threadMain(mUseAffinity, thread); }));
+            Thread([this, thread]() { threadMain(thread); }));
     }
 }
 
-void ChoreographerFilter::terminateThreadsLocked() {
+void ChoreographerFilter::terminateThreads() {
     {
         std::lock_guard<std::mutex> lock(mMutex);
         mIsRunning = false;
@@ -164,38 +186,13 @@ void ChoreographerFilter::terminateThreadsLocked() {
     mThreadPool.clear();
 }
 
-void ChoreographerFilter::onSettingsChanged() {
-    const bool useAffinity = Settings::getInstance()->getUseAffinity();
-    const Settings::DisplayTimings& displayTimings =
-        Settings::getInstance()->getDisplayTimings();
-    std::lock_guard<std::mutex> lock(mThreadPoolMutex);
-    if (useAffinity == mUseAffinity &&
-        mRefreshPeriod == displayTimings.refreshPeriod) {
-        return;
-    }
-
-    terminateThreadsLocked();
-    mUseAffinity = useAffinity;
-    mRefreshPeriod = displayTimings.refreshPeriod;
-    mAppToSfDelay = displayTimings.sfOffset - displayTimings.appOffset;
-    SWAPPY_LOGV(
-        "onSettingsChanged(): refreshPeriod=%lld, appOffset=%lld, "
-        "sfOffset=%lld",
-        (long long)displayTimings.refreshPeriod.count(),
-        (long long)displayTimings.appOffset.count(),
-        (long long)displayTimings.sfOffset.count());
-    launchThreadsLocked();
-}
+void ChoreographerFilter::threadMain(int32_t thread) {
+    std::chrono::nanoseconds refreshPeriod = mRefreshPeriod;
+    Timer timer(refreshPeriod, mAppToSfDelay);
 
-void ChoreographerFilter::threadMain(bool useAffinity, int32_t thread) {
-    Timer timer(mRefreshPeriod, mAppToSfDelay);
-
-    {
-        int cpu = getNumCpus() - 1 - thread;
-        if (cpu >= 0) {
-            setAffinity(cpu);
-        }
-    }
+    const int cpu = getNumCpus() - 1 - thread;
+    bool useAffinity = false;
+    uint64_t settingsVersion = 0;
 
     std::string threadName = "Filter";
     threadName += swappy::to_string(thread);
@@ -207,6 +204,14 @@ void ChoreographerFilter::threadMain(bool useAffinity, int32_t thread) {
         auto workDuration = mWorkDuration;
         lock.unlock();
 
+        // Pick up new settings once per frame, without restarting the thread
+        const Settings* settings = Settings::getInstance();
+        if (settings->getVersion() != settingsVersion) {
+            const auto snapshot = settings->getSnapshot();
+            settingsVersion = snapshot->version;
+            applySettings(*snapshot, cpu, &useAffinity, &refreshPeriod, &timer);
+        }
+
         // If we have received the same timestamp multiple times, it probably
         // means that the app has stopped sending them to us, which could
         // indicate that it's no longer running. If we detect that, we stop
@@ -228,7 +233,7 @@ void ChoreographerFilter::threadMain(bool useAffinity, int32_t thread) {
         {
             std::unique_lock<std::mutex> workLock(mWorkMutex);
             const auto now = std::chrono::steady_clock::now();
-            if (now - mLastWorkRun > mRefreshPeriod / 2) {
+            if (now - mLastWorkRun > refreshPeriod / 2) {
                 // Assume we got here first and there's work to do
                 gamesdk::ScopedTrace trace("doWork");
                 mWorkDuration = mDoWork(mSfToVsyncDelay);
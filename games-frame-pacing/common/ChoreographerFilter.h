@@ -40,15 +40,12 @@ class ChoreographerFilter {
         std::optional<std::chrono::nanoseconds> sfToVsyncDelay);
 
    private:
-    void launchThreadsLocked();
-    void terminateThreadsLocked();
+    void launchThreads();
+    void terminateThreads();
 
-    void onSettingsChanged();
+    // Threads apply changes to the Settings when they wake up for a frame.
+    void threadMain(int32_t thread);
 
-    void threadMain(bool useAffinity, int32_t thread);
-
-    std::mutex mThreadPoolMutex;
-    bool mUseAffinity = true;
     std::vector<Thread> mThreadPool;
 
     std::mutex mMutex;
@@ -62,8 +59,9 @@ class ChoreographerFilter {
     std::chrono::steady_clock::time_point mLastWorkRun;
     std::chrono::nanoseconds mWorkDuration;
 
-    std::chrono::nanoseconds mRefreshPeriod;
-    std::chrono::nanoseconds mAppToSfDelay;
+    // Timings the threads start with
+    const std::chrono::nanoseconds mRefreshPeriod;
+    const std::chrono::nanoseconds mAppToSfDelay;
     const Worker mDoWork;
 };
 
@@ -435,19 +435,21 @@ class NoChoreographerThread : public ChoreographerThread {
     void postFrameCallbacks() override;
     void scheduleNextFrameCallback() override REQUIRES(mWaitingMutex);
     void looperThread();
-    void onSettingsChanged();
+    void pollSettings() REQUIRES(mWaitingMutex);
 
     Thread mThread;
     bool mThreadRunning GUARDED_BY(mWaitingMutex);
     std::condition_variable_any mWaitingCondition GUARDED_BY(mWaitingMutex);
-    std::chrono::nanoseconds mRefreshPeriod GUARDED_BY(mWaitingMutex);
+    std::chrono::nanoseconds mRefreshPeriod GUARDED_BY(mWaitingMutex) =
+        std::chrono::nanoseconds(16'666'667L);
+    uint64_t mSettingsVersion GUARDED_BY(mWaitingMutex) = 0;
 };
 
 NoChoreographerThread::NoChoreographerThread(
     ChoreographerCallback onChoreographer)
     : ChoreographerThread(onChoreographer) {
     std::lock_guard<std::mutex> lock(mWaitingMutex);
-    Settings::getInstance()->addListener([this]() { onSettingsChanged(); });
+    pollSettings();
     mThreadRunning = true;
     mThread = Thread([this]() { looperThread(); });
     mInitialized = true;
@@ -463,13 +465,21 @@ NoChoreographerThread::~NoChoreographerThread() {
     mThread.join();
 }
 
-void NoChoreographerThread::onSettingsChanged() {
-    const Settings::DisplayTimings &displayTimings =
-        Settings::getInstance()->getDisplayTimings();
-    std::lock_guard<std::mutex> lock(mWaitingMutex);
-    mRefreshPeriod = displayTimings.refreshPeriod;
-    SWAPPY_LOGV("onSettingsChanged(): refreshPeriod=%lld",
-                (long long)displayTimings.refreshPeriod.count());
+void NoChoreographerThread::pollSettings() {
+    const Settings *settings = Settings::getInstance();
+    if (settings->getVersion() == mSettingsVersion) {
+        return;
+    }
+    const auto snapshot = settings->getSnapshot();
+    mSettingsVersion = snapshot->version;
+    const auto refreshPeriod = snapshot->displayTimings.refreshPeriod;
+    if (refreshPeriod == std::chrono::nanoseconds(0) ||
+        refreshPeriod == mRefreshPeriod) {
+        return;
+    }
+    mRefreshPeriod = refreshPeriod;
+    SWAPPY_LOGV("pollSettings(): refreshPeriod=%lld",
+                (long long)refreshPeriod.count());
 }
 
 void NoChoreographerThread::looperThread() {
@@ -509,6 +519,7 @@ void NoChoreographerThread::looperThread() {
                 break;
             }
 
+            pollSettings();
             const auto timePassed = std::chrono::steady_clock::now() - wakeTime;
             const int intervals = std::floor(timePassed / mRefreshPeriod);
             wakeTime += (intervals + 1) * mRefreshPeriod;
@@ -19,6 +19,7 @@
 #include <jni.h>
 
 #include <mutex>
+#include <optional>
 
 #include "SwappyDisplayManager.h"
 #include "Thread.h"
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Thread.h"
+
+namespace swappy {
+
+// Holds a value that is read far more often than it is written. Readers get
+// the current immutable snapshot without taking a lock or allocating. Writers
+// copy the snapshot, modify the copy and publish it atomically. Replaced
+// snapshots are freed by a later writer once no reader is in flight.
+template <typename T>
+class CopyOnWrite {
+   public:
+    CopyOnWrite() : mCurrent(new T()) {}
+    ~CopyOnWrite() { delete mCurrent.load(); }
+
+    CopyOnWrite(const CopyOnWrite&) = delete;
+    CopyOnWrite& operator=(const CopyOnWrite&) = delete;
+
+    // Calls f with the current snapshot. f must not call update() on the same
+    // object.
+    template <typename F>
+    void read(F&& f) const {
+        // The reader count has to be raised before the snapshot is loaded so
+        // that a writer which sees no readers knows that nobody can still be
+        // using a snapshot it replaced.
+        mReaders.fetch_add(1);
+        f(static_cast<const T&>(*mCurrent.load()));
+        mReaders.fetch_sub(1);
+    }
+
+    // Calls f with a copy of the current snapshot and publishes the result.
+    template <typename F>
+    void update(F&& f) {
+        std::lock_guard<std::mutex> lock(mWriterMutex);
+        T* current = mCurrent.load();
+        auto next = std::make_unique<T>(*current);
+        f(*next);
+        mCurrent.store(next.release());
+        mRetired.emplace_back(current);
+
+        if (mReaders.load() == 0) {
+            mRetired.clear();
+        }
+    }
+
+   private:
+    std::atomic<T*> mCurrent;
+    mutable std::atomic<int> mReaders = {0};
+
+    std::mutex mWriterMutex;
+    std::vector<std::unique_ptr<T>> mRetired GUARDED_BY(mWriterMutex);
+};
+
+}  // namespace swappy
@@ -21,11 +21,12 @@
 #include <cstring>
 #include <limits>
 
+#include "procfs.h"
+
 namespace {
 
-bool startsWith(std::string &mainStr, const char *toMatch) {
-    // std::string::find returns 0 if toMatch is found at beginning
-    return mainStr.find(toMatch) == 0;
+bool startsWith(const char *str, const char *toMatch) {
+    return strncmp(str, toMatch, strlen(toMatch)) == 0;
 }
 
 std::vector<std::string> split(const std::string &s, char c) {
@@ -45,14 +46,13 @@ std::vector<std::string> split(const std::string &s, char c) {
     return v;
 }
 
-std::string ReadFile(const std::string &path) {
-    char buf[10240];
-    FILE *fp = fopen(path.c_str(), "r");
-    if (fp == nullptr) return std::string();
-
-    fgets(buf, 10240, fp);
-    fclose(fp);
-    return std::string(buf);
+long ReadCpuValue(int cpu, const char *name) {
+    char path[gamesdk::procfs::kMaxPathLength];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/%s", cpu,
+             name);
+    int64_t value = 0;
+    gamesdk::procfs::ReadInt64(path, &value);
+    return static_cast<long>(value);
 }
 
 }  // anonymous namespace
@@ -67,35 +67,23 @@ std::string to_string(int n) {
 }
 
 CpuInfo::CpuInfo() {
-    const auto BUFFER_LENGTH = 10240;
-
-    char buf[BUFFER_LENGTH];
-    FILE *fp = fopen("/proc/cpuinfo", "r");
+    gamesdk::procfs::LineReader cpuinfo("/proc/cpuinfo");
 
-    if (!fp) {
+    if (!cpuinfo.IsOpen()) {
         return;
     }
 
     long mMaxFrequency = 0;
     long mMinFrequency = std::numeric_limits<long>::max();
 
-    while (fgets(buf, BUFFER_LENGTH, fp) != NULL) {
-        buf[strlen(buf) - 1] = '\0';  // eat the newline fgets() stores
-        std::string line = buf;
-
+    while (const char *line = cpuinfo.NextLine()) {
         if (startsWith(line, "processor")) {
             Cpu core;
             core.id = mCpus.size();
 
-            auto core_path =
-                std::string("/sys/devices/system/cpu/cpu") + to_string(core.id);
-
-            auto package_id =
-                ReadFile(core_path + "/topology/physical_package_id");
-            auto frequency = ReadFile(core_path + "/cpufreq/cpuinfo_max_freq");
-
-            core.package_id = atol(package_id.c_str());
-            core.frequency = atol(frequency.c_str());
+            core.package_id =
+                ReadCpuValue(core.id, "topology/physical_package_id");
+            core.frequency = ReadCpuValue(core.id, "cpufreq/cpuinfo_max_freq");
 
             mMinFrequency = std::min(mMinFrequency, core.frequency);
             mMaxFrequency = std::max(mMaxFrequency, core.frequency);
@@ -105,7 +93,6 @@ CpuInfo::CpuInfo() {
             mHardware = split(line, ':')[1];
         }
     }
-    fclose(fp);
 
     CPU_ZERO(&mLittleCoresMask);
     CPU_ZERO(&mBigCoresMask);
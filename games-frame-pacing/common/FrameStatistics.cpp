@@ -51,12 +51,11 @@ void FrameStatistics::invalidateLastFrame() { mLast = {0, 0, 0, 0}; }
 void FrameStatistics::updateFrameStats(FrameTimings current,
                                        uint64_t refreshPeriod) {
     std::lock_guard<std::mutex> lock(mMutex);
-    // Latency is always collected
-    int latency = getFrameDelta(
-        current.actualPresentTime - current.startFrameTime, refreshPeriod);
 
     // Use incoming frame timings to build the histogram.
     if (mFullStatsEnabled) {
+        int latency = getFrameDelta(
+            current.actualPresentTime - current.startFrameTime, refreshPeriod);
         int idle = getFrameDelta(current.presentMargin, refreshPeriod);
         int late = getFrameDelta(
             current.actualPresentTime - current.desiredPresentTime,
@@ -76,10 +75,13 @@ void FrameStatistics::updateFrameStats(FrameTimings current,
             mStats.offsetFromPreviousFrame[offset]++;
         }
 
+#if ENABLE_SWAPPY_LOGGING
+        // Building the log messages allocates, so skip it entirely when the
+        // messages would be discarded anyway.
         logFrames();
+#endif
     }
 
-    mLastLatency = latency;
     mLast = current;
 }
 void FrameStatistics::logFrames() {
@@ -50,8 +50,6 @@ class FrameStatistics {
     void clearStats();
     void invalidateLastFrame();
 
-    int32_t lastLatencyRecorded() { return mLastLatency; }
-
    private:
     static constexpr std::chrono::nanoseconds LOG_EVERY_N_NS = 1s;
     void logFrames() REQUIRES(mMutex);
@@ -60,7 +58,6 @@ class FrameStatistics {
 
     std::mutex mMutex;
     SwappyStats mStats GUARDED_BY(mMutex) = {};
-    std::atomic<int32_t> mLastLatency = {0};
     FrameTimings mLast;
 
     // A flag to enable or disable frame stats histogram update.
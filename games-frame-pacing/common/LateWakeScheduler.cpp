@@ -0,0 +1,71 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LateWakeScheduler.h"
+
+#include <algorithm>
+
+namespace swappy {
+
+using std::chrono::nanoseconds;
+
+constexpr size_t LateWakeScheduler::HISTORY_SIZE;
+constexpr size_t LateWakeScheduler::MIN_SAMPLES;
+constexpr nanoseconds LateWakeScheduler::MIN_MARGIN;
+constexpr nanoseconds LateWakeScheduler::MAX_MARGIN;
+constexpr int LateWakeScheduler::MARGIN_DECAY_FRAMES;
+
+void LateWakeScheduler::onFrameEnd(nanoseconds workTime, bool missedDeadline) {
+    if (mWorkTimes.full()) mWorkTimes.pop_front();
+    mWorkTimes.push_back(std::max(workTime, 0ns));
+
+    if (missedDeadline) {
+        mMargin = std::min(mMargin * 2, MAX_MARGIN);
+        mFallbackFrames = HISTORY_SIZE;
+        mFramesOnTime = 0;
+        return;
+    }
+
+    if (mFallbackFrames > 0) --mFallbackFrames;
+    if (++mFramesOnTime >= MARGIN_DECAY_FRAMES) {
+        mMargin = std::max(mMargin - mMargin / 4, MIN_MARGIN);
+        mFramesOnTime = 0;
+    }
+}
+
+nanoseconds LateWakeScheduler::getPredictedWorkTime() const {
+    nanoseconds predicted = 0ns;
+    for (size_t i = 0; i < mWorkTimes.size(); ++i) {
+        predicted = std::max(predicted, mWorkTimes[i]);
+    }
+    return predicted;
+}
+
+nanoseconds LateWakeScheduler::getWakeDelay(nanoseconds timeToDeadline) const {
+    if (mFallbackFrames > 0 || mWorkTimes.size() < MIN_SAMPLES) {
+        return 0ns;
+    }
+    return std::max(timeToDeadline - getPredictedWorkTime() - mMargin, 0ns);
+}
+
+void LateWakeScheduler::reset() {
+    mWorkTimes.clear();
+    mMargin = MIN_MARGIN;
+    mFallbackFrames = 0;
+    mFramesOnTime = 0;
+}
+
+}  // namespace swappy
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+
+#include "RingBuffer.h"
+
+namespace swappy {
+
+using namespace std::chrono_literals;
+
+// Decides how long to delay the start of a frame so that its work ends just
+// before the frame's deadline, which reduces the time between the app reading
+// input and the frame being presented.
+//
+// The work time is predicted as the longest of the last HISTORY_SIZE frames,
+// and the frame is started that long, plus a safety margin, before the
+// deadline. A frame that misses its deadline doubles the margin and disables
+// the delay until the history has been refilled. The margin then shrinks back
+// by a quarter every MARGIN_DECAY_FRAMES frames that make their deadline.
+class LateWakeScheduler {
+   public:
+    static constexpr size_t HISTORY_SIZE = 16;
+    // Frames needed before delaying any frame.
+    static constexpr size_t MIN_SAMPLES = 4;
+    static constexpr std::chrono::nanoseconds MIN_MARGIN = 1ms;
+    static constexpr std::chrono::nanoseconds MAX_MARGIN = 8ms;
+    static constexpr int MARGIN_DECAY_FRAMES = 60;
+
+    // Records the work time of the last frame, and whether it missed its
+    // deadline.
+    void onFrameEnd(std::chrono::nanoseconds workTime, bool missedDeadline);
+
+    // Returns how long to wait before starting a frame whose deadline is
+    // timeToDeadline from now, or 0 to start right away.
+    std::chrono::nanoseconds getWakeDelay(
+        std::chrono::nanoseconds timeToDeadline) const;
+
+    std::chrono::nanoseconds getPredictedWorkTime() const;
+    std::chrono::nanoseconds getMargin() const { return mMargin; }
+
+    void reset();
+
+   private:
+    RingBuffer<std::chrono::nanoseconds, HISTORY_SIZE> mWorkTimes;
+    std::chrono::nanoseconds mMargin = MIN_MARGIN;
+    // Frames left to start right away after a missed deadline.
+    size_t mFallbackFrames = 0;
+    int mFramesOnTime = 0;
+};
+
+}  // namespace swappy
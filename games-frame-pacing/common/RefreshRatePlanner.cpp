@@ -0,0 +1,160 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RefreshRatePlanner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace swappy {
+
+using std::chrono::nanoseconds;
+
+constexpr nanoseconds RefreshRatePlanner::MODE_SWITCH_HOLD_TIME;
+constexpr nanoseconds RefreshRatePlanner::MAX_SWAP_DURATION;
+constexpr nanoseconds RefreshRatePlanner::FRAME_MARGIN;
+constexpr nanoseconds RefreshRatePlanner::REFRESH_RATE_MARGIN;
+constexpr nanoseconds RefreshRatePlanner::MODE_MATCH_MARGIN;
+
+int RefreshRatePlanner::calculateSwapInterval(nanoseconds frameTime,
+                                              nanoseconds refreshPeriod) {
+    if (frameTime < refreshPeriod) {
+        return 1;
+    }
+
+    auto div_result = div(frameTime.count(), refreshPeriod.count());
+    auto framesPerRefresh = div_result.quot;
+    auto framesPerRefreshRemainder = div_result.rem;
+
+    return (framesPerRefresh +
+            (framesPerRefreshRemainder > REFRESH_RATE_MARGIN.count() ? 1 : 0));
+}
+
+void RefreshRatePlanner::setSupportedRefreshPeriods(
+    const RefreshPeriodMap& refreshPeriods) {
+    mOptions.clear();
+    for (const auto& mode : refreshPeriods) {
+        const nanoseconds period = mode.first;
+        if (period <= 0ns) continue;
+        const int32_t powerCost =
+            static_cast<int32_t>(std::lround(1e9 / period.count()));
+        for (int32_t swapInterval = 1;
+             period * swapInterval <= MAX_SWAP_DURATION + FRAME_MARGIN;
+             ++swapInterval) {
+            mOptions.push_back({period, mode.second, swapInterval,
+                                period * swapInterval, powerCost});
+        }
+    }
+    std::sort(mOptions.begin(), mOptions.end(),
+              [](const Option& a, const Option& b) {
+                  if (a.swapDuration != b.swapDuration) {
+                      return a.swapDuration < b.swapDuration;
+                  }
+                  return a.powerCost < b.powerCost;
+              });
+    reset();
+}
+
+void RefreshRatePlanner::reset() {
+    mPlan = nullptr;
+    mCandidate = nullptr;
+}
+
+bool RefreshRatePlanner::isFeasible(const Option& option, nanoseconds frameTime,
+                                    nanoseconds minSwapDuration) const {
+    // Don't allow swapping faster than minSwapDuration (see public header)
+    if (option.swapDuration + FRAME_MARGIN < minSwapDuration) {
+        return false;
+    }
+    return option.swapInterval >=
+           calculateSwapInterval(frameTime, option.refreshPeriod);
+}
+
+const RefreshRatePlanner::Option* RefreshRatePlanner::findBest(
+    nanoseconds frameTime, nanoseconds minSwapDuration, int modeId) const {
+    const Option* best = nullptr;
+    for (const auto& option : mOptions) {
+        if (modeId != -1 && option.modeId != modeId) continue;
+        if (best && option.swapDuration >= best->swapDuration + FRAME_MARGIN) {
+            break;
+        }
+        if (!isFeasible(option, frameTime, minSwapDuration)) continue;
+        // Options are sorted by swap duration, so everything after the first
+        // feasible option within FRAME_MARGIN is as fast: keep the cheapest.
+        if (!best || option.powerCost < best->powerCost) {
+            best = &option;
+        }
+    }
+    return best;
+}
+
+const RefreshRatePlanner::Option* RefreshRatePlanner::plan(
+    nanoseconds frameTime, nanoseconds minSwapDuration,
+    std::chrono::steady_clock::time_point now) {
+    frameTime = std::min(frameTime, MAX_SWAP_DURATION);
+    minSwapDuration = std::min(minSwapDuration, MAX_SWAP_DURATION);
+
+    const Option* best = findBest(frameTime, minSwapDuration, -1);
+    if (!best || best == mPlan) {
+        mCandidate = nullptr;
+        return mPlan;
+    }
+
+    if (!mPlan) {
+        mPlan = best;
+        return mPlan;
+    }
+
+    if (!isFeasible(*mPlan, frameTime, minSwapDuration)) {
+        // The current option can't keep up: switch now, staying on the same
+        // mode if it has an option as fast as the best one.
+        const Option* sameMode =
+            findBest(frameTime, minSwapDuration, mPlan->modeId);
+        if (sameMode &&
+            sameMode->swapDuration < best->swapDuration + FRAME_MARGIN) {
+            best = sameMode;
+        }
+        mPlan = best;
+        mCandidate = nullptr;
+        return mPlan;
+    }
+
+    // Changing the swap interval only is free.
+    if (best->modeId == mPlan->modeId) {
+        mPlan = best;
+        mCandidate = nullptr;
+        return mPlan;
+    }
+
+    // Switching mode would be better: wait for it to stay better long enough.
+    if (best != mCandidate) {
+        mCandidate = best;
+        mCandidateSince = now;
+    } else if (now - mCandidateSince >= mHoldTime) {
+        mPlan = best;
+        mCandidate = nullptr;
+    }
+    return mPlan;
+}
+
+bool RefreshRatePlanner::isPlanned(nanoseconds refreshPeriod) const {
+    return mPlan &&
+           std::abs((mPlan->refreshPeriod - refreshPeriod).count()) <
+               MODE_MATCH_MARGIN.count();
+}
+
+}  // namespace swappy
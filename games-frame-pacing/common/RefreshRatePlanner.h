@@ -0,0 +1,107 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace swappy {
+
+using namespace std::chrono_literals;
+
+// Chooses the display mode and swap interval to present at, out of the full
+// table of modes supported by the display.
+//
+// Every (refresh period, swap interval) pair of every mode is precomputed
+// once, with its power cost. Planning picks the shortest swap duration that
+// still fits the frame time, and the cheapest option among those with the
+// same duration. A mode switch that only saves power, or only speeds up
+// presentation, has to be planned for MODE_SWITCH_HOLD_TIME before it is
+// taken, so that a frame time hovering around a boundary does not make the
+// display switch back and forth. A switch that is needed because the current
+// option cannot keep up with the frame time is taken immediately.
+class RefreshRatePlanner {
+   public:
+    using RefreshPeriodMap = std::map<std::chrono::nanoseconds, int>;
+
+    struct Option {
+        std::chrono::nanoseconds refreshPeriod;
+        int modeId;
+        int32_t swapInterval;
+        std::chrono::nanoseconds swapDuration;
+        // Refresh rate in Hz: the display's power draw grows with how often
+        // it scans out, while the number of frames rendered only depends on
+        // the swap duration.
+        int32_t powerCost;
+    };
+
+    static constexpr std::chrono::nanoseconds MODE_SWITCH_HOLD_TIME = 1s;
+    // Options presenting slower than this (10 FPS) are not considered.
+    static constexpr std::chrono::nanoseconds MAX_SWAP_DURATION = 100ms;
+    static constexpr std::chrono::nanoseconds FRAME_MARGIN = 1ms;
+    static constexpr std::chrono::nanoseconds REFRESH_RATE_MARGIN = 500ns;
+    // Refresh periods reported for the same mode may differ by rounding.
+    static constexpr std::chrono::nanoseconds MODE_MATCH_MARGIN = 100us;
+
+    explicit RefreshRatePlanner(
+        std::chrono::nanoseconds holdTime = MODE_SWITCH_HOLD_TIME)
+        : mHoldTime(holdTime) {}
+
+    // Number of refresh periods needed to present a frame taking frameTime.
+    static int calculateSwapInterval(std::chrono::nanoseconds frameTime,
+                                     std::chrono::nanoseconds refreshPeriod);
+
+    // Rebuilds the option table and forgets the current plan.
+    void setSupportedRefreshPeriods(const RefreshPeriodMap& refreshPeriods);
+
+    // Returns the option to present frames taking frameTime at, never
+    // presenting faster than minSwapDuration, or nullptr when there is no
+    // supported mode. The returned pointer is valid until the next call to
+    // setSupportedRefreshPeriods.
+    const Option* plan(std::chrono::nanoseconds frameTime,
+                       std::chrono::nanoseconds minSwapDuration,
+                       std::chrono::steady_clock::time_point now);
+
+    // Forgets the current plan: the next call to plan() switches to the best
+    // option right away.
+    void reset();
+
+    const Option* getPlan() const { return mPlan; }
+    const std::vector<Option>& getOptions() const { return mOptions; }
+
+    // Whether refreshPeriod is the refresh period of the current plan.
+    bool isPlanned(std::chrono::nanoseconds refreshPeriod) const;
+
+   private:
+    bool isFeasible(const Option& option, std::chrono::nanoseconds frameTime,
+                    std::chrono::nanoseconds minSwapDuration) const;
+    const Option* findBest(std::chrono::nanoseconds frameTime,
+                           std::chrono::nanoseconds minSwapDuration,
+                           int modeId) const;
+
+    // Options are sorted by swap duration, then by power cost.
+    std::vector<Option> mOptions;
+    const std::chrono::nanoseconds mHoldTime;
+
+    const Option* mPlan = nullptr;
+    const Option* mCandidate = nullptr;
+    std::chrono::steady_clock::time_point mCandidateSince;
+};
+
+}  // namespace swappy
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace swappy {
+
+// Fixed-capacity FIFO queue stored inline. Used on the per-frame paths instead
+// of std::list / std::deque / std::vector so that pushing and popping never
+// touches the heap. Callers are responsible for checking full() before
+// push_back().
+template <typename T, size_t N>
+class RingBuffer {
+    static_assert(N > 0, "RingBuffer capacity must be non-zero");
+
+   public:
+    static constexpr size_t capacity() { return N; }
+
+    size_t size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+    bool full() const { return mSize == N; }
+
+    // Returns false, without modifying the queue, if it is already full.
+    bool push_back(const T& value) {
+        if (full()) return false;
+        mData[(mHead + mSize) % N] = value;
+        ++mSize;
+        return true;
+    }
+
+    void pop_front() {
+        if (empty()) return;
+        mHead = (mHead + 1) % N;
+        --mSize;
+    }
+
+    T& front() { return mData[mHead]; }
+    const T& front() const { return mData[mHead]; }
+
+    T& back() { return mData[(mHead + mSize - 1) % N]; }
+    const T& back() const { return mData[(mHead + mSize - 1) % N]; }
+
+    // Index 0 is the front of the queue.
+    T& operator[](size_t i) { return mData[(mHead + i) % N]; }
+    const T& operator[](size_t i) const { return mData[(mHead + i) % N]; }
+
+    void clear() {
+        mHead = 0;
+        mSize = 0;
+    }
+
+   private:
+    std::array<T, N> mData = {};
+    size_t mHead = 0;
+    size_t mSize = 0;
+};
+
+}  // namespace swappy
@@ -18,80 +18,75 @@
 
 namespace swappy {
 
-std::unique_ptr<Settings> Settings::instance;
+Settings::Settings(ConstructorTag) : mSnapshot(std::make_shared<Snapshot>()) {}
 
 Settings* Settings::getInstance() {
-    if (!instance) {
-        instance = std::make_unique<Settings>(ConstructorTag{});
-    }
-    return instance.get();
+    static Settings instance{ConstructorTag{}};
+    return &instance;
 }
 
-void Settings::reset() { instance.reset(); }
-
-void Settings::addListener(Listener listener) {
+template <typename Update>
+void Settings::publish(Update update) {
     std::lock_guard<std::mutex> lock(mMutex);
-    mListeners.emplace_back(std::move(listener));
+    publishLocked(update);
 }
 
-void Settings::removeAllListeners() {
-    std::lock_guard<std::mutex> lock(mMutex);
-    mListeners.clear();
+template <typename Update>
+void Settings::publishLocked(Update update) {
+    auto snapshot = std::make_shared<Snapshot>(*getSnapshot());
+    update(*snapshot);
+    snapshot->version = mVersion.load(std::memory_order_relaxed) + 1;
+    std::atomic_store_explicit(
+        &mSnapshot, std::shared_ptr<const Snapshot>(std::move(snapshot)),
+        std::memory_order_release);
+    // Published after the snapshot so that a reader seeing the new version
+    // also sees the new snapshot.
+    mVersion.fetch_add(1, std::memory_order_release);
 }
 
-void Settings::setDisplayTimings(const DisplayTimings& displayTimings) {
-    {
-        std::lock_guard<std::mutex> lock(mMutex);
-        mDisplayTimings = displayTimings;
-    }
-    // Notify the listeners without the lock held
-    notifyListeners();
+void Settings::reset() {
+    getInstance()->publish([](Snapshot& snapshot) { snapshot = Snapshot(); });
 }
-void Settings::setSwapDuration(uint64_t swapNs) {
-    {
-        std::lock_guard<std::mutex> lock(mMutex);
-        mSwapDuration = std::chrono::nanoseconds(swapNs);
-    }
-    // Notify the listeners without the lock held
-    notifyListeners();
+
+void Settings::addUser() {
+    Settings* settings = getInstance();
+    std::lock_guard<std::mutex> lock(settings->mMutex);
+    settings->mUsers++;
 }
 
-void Settings::setUseAffinity(bool tf) {
-    {
-        std::lock_guard<std::mutex> lock(mMutex);
-        mUseAffinity = tf;
+void Settings::removeUser() {
+    Settings* settings = getInstance();
+    std::lock_guard<std::mutex> lock(settings->mMutex);
+    if (--settings->mUsers == 0) {
+        settings->publishLocked(
+            [](Snapshot& snapshot) { snapshot = Snapshot(); });
     }
-    // Notify the listeners without the lock held
-    notifyListeners();
 }
 
-const Settings::DisplayTimings& Settings::getDisplayTimings() const {
-    std::lock_guard<std::mutex> lock(mMutex);
-    return mDisplayTimings;
+void Settings::setDisplayTimings(const DisplayTimings& displayTimings) {
+    publish([&](Snapshot& snapshot) {
+        snapshot.displayTimings = displayTimings;
+    });
 }
 
-std::chrono::nanoseconds Settings::getSwapDuration() const {
-    std::lock_guard<std::mutex> lock(mMutex);
-    return mSwapDuration;
+void Settings::setSwapDuration(uint64_t swapNs) {
+    publish([&](Snapshot& snapshot) {
+        snapshot.swapDuration = std::chrono::nanoseconds(swapNs);
+    });
 }
 
-bool Settings::getUseAffinity() const {
-    std::lock_guard<std::mutex> lock(mMutex);
-    return mUseAffinity;
+void Settings::setUseAffinity(bool tf) {
+    publish([&](Snapshot& snapshot) { snapshot.useAffinity = tf; });
 }
 
-void Settings::notifyListeners() {
-    // Grab a local copy of the listeners
-    std::vector<Listener> listeners;
-    {
-        std::lock_guard<std::mutex> lock(mMutex);
-        listeners = mListeners;
-    }
+Settings::DisplayTimings Settings::getDisplayTimings() const {
+    return getSnapshot()->displayTimings;
+}
 
-    // Call the listeners without the lock held
-    for (const auto& listener : listeners) {
-        listener();
-    }
+std::chrono::nanoseconds Settings::getSwapDuration() const {
+    return getSnapshot()->swapDuration;
 }
 
+bool Settings::getUseAffinity() const { return getSnapshot()->useAffinity; }
+
 }  // namespace swappy
@@ -16,20 +16,27 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <memory>
 #include <mutex>
-#include <string>
-#include <vector>
-
-#include "Thread.h"
 
 namespace swappy {
 
+// Process-wide settings, published as immutable snapshots.
+//
+// Setters copy the current snapshot, modify it and publish the copy with a
+// new version. Readers never take a lock: consumers on a hot path compare
+// getVersion() with the version of the snapshot they hold, and only load a new
+// snapshot when it changed, e.g. once per frame.
+//
+// The instance lives as long as the process, so that the threads of any
+// SwappyCommon can read it while another one is destroyed. The defaults are
+// restored when the last SwappyCommon using the settings goes away.
 class Settings {
    private:
-    // Allows construction with std::unique_ptr from a static method, but
+    // Allows construction from a static method, but
     // disallows construction outside of the class since no one else can
     // construct a ConstructorTag
     struct ConstructorTag {};
@@ -41,36 +48,55 @@ class Settings {
         std::chrono::nanoseconds sfOffset{0};
     };
 
-    explicit Settings(ConstructorTag){};
+    struct Snapshot {
+        uint64_t version = 0;
+        DisplayTimings displayTimings;
+        std::chrono::nanoseconds swapDuration =
+            std::chrono::nanoseconds(16'666'667L);
+        bool useAffinity = true;
+    };
+
+    explicit Settings(ConstructorTag);
 
     static Settings* getInstance();
 
+    // Publishes the default settings, with a new version.
     static void reset();
 
-    using Listener = std::function<void()>;
-    void addListener(Listener listener);
-    void removeAllListeners();
+    // Counts the SwappyCommon instances using the settings: the last
+    // removeUser() resets them.
+    static void addUser();
+    static void removeUser();
 
     void setDisplayTimings(const DisplayTimings& displayTimings);
     void setSwapDuration(uint64_t swapNs);
     void setUseAffinity(bool);
 
-    const DisplayTimings& getDisplayTimings() const;
+    std::shared_ptr<const Snapshot> getSnapshot() const {
+        return std::atomic_load_explicit(&mSnapshot,
+                                         std::memory_order_acquire);
+    }
+    uint64_t getVersion() const {
+        return mVersion.load(std::memory_order_acquire);
+    }
+
+    DisplayTimings getDisplayTimings() const;
     std::chrono::nanoseconds getSwapDuration() const;
     bool getUseAffinity() const;
 
    private:
-    void notifyListeners();
-
-    static std::unique_ptr<Settings> instance;
-
-    mutable std::mutex mMutex;
-    std::vector<Listener> mListeners GUARDED_BY(mMutex);
-
-    DisplayTimings mDisplayTimings GUARDED_BY(mMutex);
-    std::chrono::nanoseconds mSwapDuration GUARDED_BY(mMutex) =
-        std::chrono::nanoseconds(16'666'667L);
-    bool mUseAffinity GUARDED_BY(mMutex) = true;
+    template <typename Update>
+    void publish(Update update);
+    // Same as publish(), with mMutex held.
+    template <typename Update>
+    void publishLocked(Update update);
+
+    // Serializes the writers
+    std::mutex mMutex;
+    // Guarded by mMutex
+    int mUsers = 0;
+    std::shared_ptr<const Snapshot> mSnapshot;
+    std::atomic<uint64_t> mVersion = {0};
 };
 
 }  // namespace swappy
@@ -16,9 +16,11 @@
 
 #include "SwappyCommon.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
+#include <thread>
 
 #include "Settings.h"
 #include "Thread.h"
@@ -36,11 +38,11 @@ using std::chrono::nanoseconds;
 constexpr nanoseconds SwappyCommon::FrameDuration::MAX_DURATION;
 constexpr nanoseconds SwappyCommon::FRAME_MARGIN;
 constexpr nanoseconds SwappyCommon::DURATION_ROUNDING_MARGIN;
-constexpr nanoseconds SwappyCommon::REFRESH_RATE_MARGIN;
 constexpr int SwappyCommon::NON_PIPELINE_PERCENT;
 constexpr int SwappyCommon::FRAME_DROP_THRESHOLD;
 constexpr std::chrono::nanoseconds
     SwappyCommon::FrameDurations::FRAME_DURATION_SAMPLE_SECONDS;
+constexpr size_t SwappyCommon::FrameDurations::MAX_FRAME_DURATION_SAMPLES;
 
 #if __ANDROID_API__ < 30
 // Define ANATIVEWINDOW_FRAME_RATE_COMPATIBILITY_* to allow compilation on older
@@ -135,6 +137,8 @@ SwappyCommon::SwappyCommon(JNIEnv* env, jobject jactivity)
       mMeasuredSwapDuration(nanoseconds(0)),
       mAutoSwapInterval(1),
       mValid(false) {
+    Settings::addUser();
+
     mLibAndroid = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
     if (mLibAndroid == nullptr) {
         SWAPPY_LOGE("FATAL: cannot open libandroid.so: %s", strerror(errno));
@@ -187,7 +191,6 @@ SwappyCommon::SwappyCommon(JNIEnv* env, jobject jactivity)
         }
     }
 
-    Settings::getInstance()->addListener([this]() { onSettingsChanged(); });
     Settings::getInstance()->setDisplayTimings({mCommonSettings.refreshPeriod,
                                                 mCommonSettings.appVsyncOffset,
                                                 mCommonSettings.sfVsyncOffset});
@@ -209,6 +212,8 @@ SwappyCommon::SwappyCommon(const SwappyCommonSettings& settings)
       mMeasuredSwapDuration(nanoseconds(0)),
       mAutoSwapInterval(1),
       mValid(true) {
+    Settings::addUser();
+
     mChoreographerFilter = std::make_unique<ChoreographerFilter>(
         mCommonSettings.refreshPeriod,
         mCommonSettings.sfVsyncOffset - mCommonSettings.appVsyncOffset,
@@ -223,7 +228,6 @@ SwappyCommon::SwappyCommon(const SwappyCommonSettings& settings)
         },
         [] {}, mCommonSettings.sdkVersion);
 
-    Settings::getInstance()->addListener([this]() { onSettingsChanged(); });
     Settings::getInstance()->setDisplayTimings({mCommonSettings.refreshPeriod,
                                                 mCommonSettings.appVsyncOffset,
                                                 mCommonSettings.sfVsyncOffset});
@@ -238,14 +242,13 @@ SwappyCommon::SwappyCommon(const SwappyCommonSettings& settings)
 }
 
 SwappyCommon::~SwappyCommon() {
-    // Remove the settings' listeners before destroying Choreographer objects
-    // because the listeners may contain references to the objects
-    Settings::getInstance()->removeAllListeners();
     // destroy all threads first before the other members of this class
     mChoreographerThread.reset();
     mChoreographerFilter.reset();
 
-    Settings::reset();
+    // Other instances may still be reading the settings: they're only reset
+    // once the last one is gone.
+    Settings::removeUser();
 
     if (mJactivity != nullptr) {
         JNIEnv* env;
@@ -278,6 +281,7 @@ nanoseconds SwappyCommon::wakeClient(
     std::optional<std::chrono::nanoseconds> sfToVsyncDelay) {
     std::lock_guard<std::mutex> lock(mWaitingMutex);
     ++mCurrentFrame;
+    mCurrentFrameWakeTime = std::chrono::steady_clock::now();
     // We're attempting to align with SurfaceFlinger's vsync, but it's always
     // better to be a little late than a little early (since a little early
     // could cause our frame to be picked up prematurely), so we pad by an
@@ -325,7 +329,7 @@ bool SwappyCommon::waitForNextFrame(const SwapHandlers& h) {
         (mStartFrameTime.time_since_epoch().count() == 0)
             ? 0ns
             : std::chrono::steady_clock::now() - mStartFrameTime;
-    mCPUTracer.endTrace();
+    mCPUTracer.endTrace(cpuTime);
 
     preWaitCallbacks();
 
@@ -339,7 +343,7 @@ bool SwappyCommon::waitForNextFrame(const SwapHandlers& h) {
 
         if (localBlockingWaitEnabled) {
             // wait for the previous frame to be rendered
-            while (!h.lastFrameIsComplete()) {
+            while (!h.lastFrameIsComplete(h.userData)) {
                 lateFrames++;
                 waitOneFrame();
             }
@@ -352,13 +356,25 @@ bool SwappyCommon::waitForNextFrame(const SwapHandlers& h) {
     }
 
     // If last frame is not finished, return -1 for GPU time.
-    const nanoseconds gpuTime =
-        (h.lastFrameIsComplete()) ? h.getPrevFrameGpuTime() : -1ns;
+    const nanoseconds gpuTime = (h.lastFrameIsComplete(h.userData))
+                                    ? h.getPrevFrameGpuTime(h.userData)
+                                    : -1ns;
 
     // Keep track of durations only if frame pacing is enabled.
-    if (localFramePacingEnabled)
+    if (localFramePacingEnabled) {
         addFrameDuration({cpuTime, gpuTime, mCurrentFrame > mTargetFrame});
 
+        // Without pipelining, the GPU work has to be done by the deadline too.
+        const nanoseconds workTime =
+            mPipelineMode == PipelineMode::On
+                ? cpuTime
+                : cpuTime + std::max(gpuTime, nanoseconds(0));
+        if (mFrameDeadline.time_since_epoch().count() != 0) {
+            mLateWake.onFrameEnd(workTime,
+                                 mStartFrameTime + workTime > mFrameDeadline);
+        }
+    }
+
     postWaitCallbacks(cpuTime, gpuTime);
 
     return presentationTimeIsNeeded;
@@ -383,6 +399,9 @@ void SwappyCommon::updateDisplayTimings() {
     }
     if (mFramePacingResetRequested) {
         // In case of reset, just issue the update for setting refresh period.
+        mRefreshRatePlanner.reset();
+        mLateWake.reset();
+        mBufferStuffing.reset();
         setPreferredRefreshPeriod(mInitialRefreshPeriod);
         mFramePacingResetRequested = false;
         return;
@@ -392,6 +411,7 @@ void SwappyCommon::updateDisplayTimings() {
         return;
     }
 
+    pollSettings();
     if (!mTimingSettingsNeedUpdate && !mWindowChanged) {
         return;
     }
@@ -404,6 +424,14 @@ void SwappyCommon::updateDisplayTimings() {
         return;
     }
 
+    // Frame durations don't depend on the refresh rate: when the display
+    // switched to the mode planned from them, they are still valid.
+    const bool plannedModeSwitch =
+        !mWindowChanged &&
+        mCommonSettings.refreshPeriod != mNextTimingSettings.refreshPeriod &&
+        mSwapDuration == mNextTimingSettings.swapDuration &&
+        mRefreshRatePlanner.isPlanned(mNextTimingSettings.refreshPeriod);
+
     mWindowChanged = false;
     mCommonSettings.refreshPeriod = mNextTimingSettings.refreshPeriod;
 
@@ -434,7 +462,9 @@ void SwappyCommon::updateDisplayTimings() {
         setPreferredRefreshPeriod(mSwapDuration);
     }
 
-    mFrameDurations.clear();
+    if (!plannedModeSwitch) {
+        mFrameDurations.clear();
+    }
 
     TRACE_INT("mSwapDuration", int(mSwapDuration.count()));
     TRACE_INT("mAutoSwapInterval", mAutoSwapInterval);
@@ -505,6 +535,9 @@ nanoseconds SwappyCommon::getSwapDuration() {
 
 void SwappyCommon::FrameDurations::add(FrameDuration frameDuration) {
     const auto now = std::chrono::steady_clock::now();
+    if (mFrames.full()) {
+        popFront();
+    }
     mFrames.push_back({now, frameDuration});
     mFrameDurationsSum += frameDuration;
     if (frameDuration.frameMiss()) {
@@ -512,16 +545,23 @@ void SwappyCommon::FrameDurations::add(FrameDuration frameDuration) {
     }
 
     while (mFrames.size() >= 2 &&
-           now - (mFrames.begin() + 1)->first > FRAME_DURATION_SAMPLE_SECONDS) {
-        mFrameDurationsSum -= mFrames.front().second;
-        if (mFrames.front().second.frameMiss()) {
-            mMissedFrameCount--;
-        }
-        mFrames.pop_front();
+           now - mFrames[1].first > FRAME_DURATION_SAMPLE_SECONDS) {
+        popFront();
+    }
+}
+
+void SwappyCommon::FrameDurations::popFront() {
+    mFrameDurationsSum -= mFrames.front().second;
+    if (mFrames.front().second.frameMiss()) {
+        mMissedFrameCount--;
     }
+    mFrames.pop_front();
 }
 
 bool SwappyCommon::FrameDurations::hasEnoughSamples() const {
+    // A full buffer means frames are arriving faster than we can keep for the
+    // whole sample period, which is plenty of samples.
+    if (mFrames.full()) return true;
     return (!mFrames.empty()) && (mFrames.back().first - mFrames.front().first >
                                   FRAME_DURATION_SAMPLE_SECONDS);
 }
@@ -708,70 +748,86 @@ void addToTracers(Tracers& tracers, Func func, void* userData) {
 template <typename Tracers, typename Func>
 void removeFromTracers(Tracers& tracers, Func func) {
     if (func != nullptr) {
-        for (auto it = tracers.begin(); it != tracers.end();) {
-            auto jt = it;
-            it++;
-            if (jt->function == func) {
-                tracers.erase(jt);
-            }
-        }
+        tracers.erase(std::remove_if(tracers.begin(), tracers.end(),
+                                     [func](const auto& tracer) {
+                                         return tracer.function == func;
+                                     }),
+                      tracers.end());
     }
 }
 
 void SwappyCommon::addTracerCallbacks(const SwappyTracer& tracer) {
-    addToTracers(mInjectedTracers.preWait, tracer.preWait, tracer.userData);
-    addToTracers(mInjectedTracers.postWait, tracer.postWait, tracer.userData);
-    addToTracers(mInjectedTracers.preSwapBuffers, tracer.preSwapBuffers,
-                 tracer.userData);
-    addToTracers(mInjectedTracers.postSwapBuffers, tracer.postSwapBuffers,
-                 tracer.userData);
-    addToTracers(mInjectedTracers.startFrame, tracer.startFrame,
-                 tracer.userData);
-    addToTracers(mInjectedTracers.swapIntervalChanged,
-                 tracer.swapIntervalChanged, tracer.userData);
+    mInjectedTracers.update([&tracer](SwappyTracerCallbacks& tracers) {
+        addToTracers(tracers.preWait, tracer.preWait, tracer.userData);
+        addToTracers(tracers.postWait, tracer.postWait, tracer.userData);
+        addToTracers(tracers.preSwapBuffers, tracer.preSwapBuffers,
+                     tracer.userData);
+        addToTracers(tracers.postSwapBuffers, tracer.postSwapBuffers,
+                     tracer.userData);
+        addToTracers(tracers.startFrame, tracer.startFrame, tracer.userData);
+        addToTracers(tracers.swapIntervalChanged, tracer.swapIntervalChanged,
+                     tracer.userData);
+    });
 }
 
 void SwappyCommon::removeTracerCallbacks(const SwappyTracer& tracer) {
-    removeFromTracers(mInjectedTracers.preWait, tracer.preWait);
-    removeFromTracers(mInjectedTracers.postWait, tracer.postWait);
-    removeFromTracers(mInjectedTracers.preSwapBuffers, tracer.preSwapBuffers);
-    removeFromTracers(mInjectedTracers.postSwapBuffers, tracer.postSwapBuffers);
-    removeFromTracers(mInjectedTracers.startFrame, tracer.startFrame);
-    removeFromTracers(mInjectedTracers.swapIntervalChanged,
-                      tracer.swapIntervalChanged);
+    mInjectedTracers.update([&tracer](SwappyTracerCallbacks& tracers) {
+        removeFromTracers(tracers.preWait, tracer.preWait);
+        removeFromTracers(tracers.postWait, tracer.postWait);
+        removeFromTracers(tracers.preSwapBuffers, tracer.preSwapBuffers);
+        removeFromTracers(tracers.postSwapBuffers, tracer.postSwapBuffers);
+        removeFromTracers(tracers.startFrame, tracer.startFrame);
+        removeFromTracers(tracers.swapIntervalChanged,
+                          tracer.swapIntervalChanged);
+    });
 }
 
 template <typename T, typename... Args>
-void executeTracers(T& tracers, Args... args) {
+void executeTracers(const T& tracers, Args... args) {
     for (const auto& tracer : tracers) {
         tracer.function(tracer.userData, std::forward<Args>(args)...);
     }
 }
 
 void SwappyCommon::preSwapBuffersCallbacks() {
-    executeTracers(mInjectedTracers.preSwapBuffers);
+    mInjectedTracers.read([](const SwappyTracerCallbacks& tracers) {
+        executeTracers(tracers.preSwapBuffers);
+    });
 }
 
 void SwappyCommon::postSwapBuffersCallbacks() {
-    executeTracers(mInjectedTracers.postSwapBuffers,
-                   (int64_t)mPresentationTime.time_since_epoch().count());
+    const int64_t presentationTime =
+        mPresentationTime.time_since_epoch().count();
+    mInjectedTracers.read([=](const SwappyTracerCallbacks& tracers) {
+        executeTracers(tracers.postSwapBuffers, presentationTime);
+    });
 }
 
 void SwappyCommon::preWaitCallbacks() {
-    executeTracers(mInjectedTracers.preWait);
+    mInjectedTracers.read([](const SwappyTracerCallbacks& tracers) {
+        executeTracers(tracers.preWait);
+    });
 }
 
 void SwappyCommon::postWaitCallbacks(nanoseconds cpuTime, nanoseconds gpuTime) {
-    executeTracers(mInjectedTracers.postWait, cpuTime.count(), gpuTime.count());
+    mInjectedTracers.read([=](const SwappyTracerCallbacks& tracers) {
+        executeTracers(tracers.postWait, cpuTime.count(), gpuTime.count());
+    });
 }
 
 void SwappyCommon::startFrameCallbacks() {
-    executeTracers(mInjectedTracers.startFrame, mCurrentFrame,
-                   (int64_t)mPresentationTime.time_since_epoch().count());
+    const int32_t currentFrame = mCurrentFrame;
+    const int64_t presentationTime =
+        mPresentationTime.time_since_epoch().count();
+    mInjectedTracers.read([=](const SwappyTracerCallbacks& tracers) {
+        executeTracers(tracers.startFrame, currentFrame, presentationTime);
+    });
 }
 
 void SwappyCommon::swapIntervalChangedCallbacks() {
-    executeTracers(mInjectedTracers.swapIntervalChanged);
+    mInjectedTracers.read([](const SwappyTracerCallbacks& tracers) {
+        executeTracers(tracers.swapIntervalChanged);
+    });
 }
 
 void SwappyCommon::setAutoSwapInterval(bool enabled) {
@@ -807,16 +863,7 @@ void SwappyCommon::setPreferredDisplayModeId(int modeId) {
 
 int SwappyCommon::calculateSwapInterval(nanoseconds frameTime,
                                         nanoseconds refreshPeriod) {
-    if (frameTime < refreshPeriod) {
-        return 1;
-    }
-
-    auto div_result = div(frameTime.count(), refreshPeriod.count());
-    auto framesPerRefresh = div_result.quot;
-    auto framesPerRefreshRemainder = div_result.rem;
-
-    return (framesPerRefresh +
-            (framesPerRefreshRemainder > REFRESH_RATE_MARGIN.count() ? 1 : 0));
+    return RefreshRatePlanner::calculateSwapInterval(frameTime, refreshPeriod);
 }
 
 void SwappyCommon::setPreferredRefreshPeriod(nanoseconds frameTime) {
@@ -838,51 +885,37 @@ void SwappyCommon::setPreferredRefreshPeriod(nanoseconds frameTime) {
         if (!mDisplayManager || !mSupportedRefreshPeriods) {
             return;
         }
-        // Loop across all supported refresh periods to find the best refresh
-        // period. Best refresh period means:
-        //      Shortest swap period that can still accommodate the frame time
-        //      and that has the longest refresh period possible to optimize
-        //      power consumption.
-        std::pair<nanoseconds, int> bestRefreshConfig;
-        nanoseconds minSwapDuration = 1s;
-        for (const auto& refreshConfig : *mSupportedRefreshPeriods) {
-            const auto period = refreshConfig.first;
-            const int swapIntervalForPeriod =
-                calculateSwapInterval(frameTime, period);
-            const nanoseconds swapDuration = period * swapIntervalForPeriod;
-
-            // Don't allow swapping faster than mSwapDuration (see public
-            // header)
-            if (swapDuration + FRAME_MARGIN < mSwapDuration) {
-                continue;
-            }
-
-            // We iterate in ascending order of refresh period, so accepting any
-            // better or equal-within-margin duration here chooses the longest
-            // refresh period possible.
-            if (swapDuration < minSwapDuration + FRAME_MARGIN) {
-                minSwapDuration = swapDuration;
-                bestRefreshConfig = refreshConfig;
-            }
+        if (mPlannedRefreshPeriods != mSupportedRefreshPeriods) {
+            mPlannedRefreshPeriods = mSupportedRefreshPeriods;
+            mRefreshRatePlanner.setSupportedRefreshPeriods(
+                *mSupportedRefreshPeriods);
         }
 
-        // Switch if we have a potentially better refresh rate
-        {
-            TRACE_INT("preferredRefreshPeriod",
-                      bestRefreshConfig.first.count());
-            setPreferredDisplayModeId(bestRefreshConfig.second);
+        // Shortest swap duration that can still accommodate the frame time,
+        // at the lowest refresh rate possible to optimize power consumption.
+        const RefreshRatePlanner::Option* plan = mRefreshRatePlanner.plan(
+            frameTime, mSwapDuration, std::chrono::steady_clock::now());
+        if (!plan) {
+            return;
         }
+
+        TRACE_INT("preferredRefreshPeriod", plan->refreshPeriod.count());
+        setPreferredDisplayModeId(plan->modeId);
     }
 }
 
-void SwappyCommon::onSettingsChanged() {
-    std::lock_guard<std::mutex> lock(mMutex);
+void SwappyCommon::pollSettings() {
+    // Cheap check: the snapshot is only loaded when a new one was published.
+    const Settings* settings = Settings::getInstance();
+    if (settings->getVersion() == mSettingsVersion) {
+        return;
+    }
+    const auto snapshot = settings->getSnapshot();
+    mSettingsVersion = snapshot->version;
 
-    TimingSettings timingSettings =
-        TimingSettings::from(*Settings::getInstance());
+    TimingSettings timingSettings = TimingSettings::from(*snapshot);
 
-    // If display timings has changed, cache the update and apply them on the
-    // next frame
+    // If display timings have changed, flag them to be applied on this frame
     if (timingSettings != mNextTimingSettings) {
         mNextTimingSettings = timingSettings;
         mTimingSettingsNeedUpdate = true;
@@ -894,43 +927,22 @@ void SwappyCommon::startFrame() {
 
     int32_t currentFrame;
     std::chrono::steady_clock::time_point currentFrameTimestamp;
+    std::chrono::steady_clock::time_point currentFrameWakeTime;
     std::optional<std::chrono::nanoseconds> sfToVsyncDelay;
     {
         std::unique_lock<std::mutex> lock(mWaitingMutex);
         currentFrame = mCurrentFrame;
         currentFrameTimestamp = mCurrentFrameTimestamp;
+        currentFrameWakeTime = mCurrentFrameWakeTime;
         sfToVsyncDelay = mSfToVsyncDelay;
     }
 
-    // Whether to add a wait to fix buffer stuffing.
-    bool waitFrame = false;
-
     const int intervals = (mPipelineMode == PipelineMode::On) ? 2 : 1;
 
-    // Use frame statistics to fix any buffer stuffing
-    if (mBufferStuffingFixWait > 0 && mLastLatencyRecorded) {
-        int32_t lastLatency = mLastLatencyRecorded();
-        int expectedLatency = mAutoSwapInterval * intervals;
-        if (sfToVsyncDelay) {
-            expectedLatency += *sfToVsyncDelay / mCommonSettings.refreshPeriod;
-        }
-        TRACE_INT("ExpectedLatency", expectedLatency);
-        if (mBufferStuffingFixCounter == 0) {
-            if (lastLatency > expectedLatency) {
-                mMissedFrameCounter++;
-                if (mMissedFrameCounter >= mBufferStuffingFixWait) {
-                    waitFrame = true;
-                    mBufferStuffingFixCounter = 2 * lastLatency;
-                    TRACE_INT("BufferStuffingFix", mBufferStuffingFixCounter);
-                }
-            } else {
-                mMissedFrameCounter = 0;
-            }
-        } else {
-            --mBufferStuffingFixCounter;
-            TRACE_INT("BufferStuffingFix", mBufferStuffingFixCounter);
-        }
-    }
+    // Waiting one more vsync drops one frame from the compositor queue, which
+    // fixes buffer stuffing.
+    const bool waitFrame = mBufferStuffing.consumeDrainRequest();
+    TRACE_INT("BufferStuffingFix", waitFrame ? 1 : 0);
     mTargetFrame = currentFrame + mAutoSwapInterval;
     if (waitFrame) mTargetFrame += 1;
 
@@ -949,6 +961,31 @@ void SwappyCommon::startFrame() {
         currentFrameTimestamp +
         (mAutoSwapInterval * intervals) * mCommonSettings.refreshPeriod;
 
+    // The frame is queued once Choreographer wakes us up for the target frame.
+    std::chrono::steady_clock::time_point frameDeadline;
+    if (currentFrameWakeTime.time_since_epoch().count() != 0) {
+        frameDeadline =
+            currentFrameWakeTime +
+            (mTargetFrame - currentFrame) * mCommonSettings.refreshPeriod;
+    }
+
+    bool lowLatencyMode;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        lowLatencyMode = mLowLatencyModeEnabled && mFramePacingEnabled;
+    }
+    if (lowLatencyMode) {
+        // Start the frame as late as possible so the app reads the freshest
+        // input.
+        const nanoseconds delay = mLateWake.getWakeDelay(
+            frameDeadline - std::chrono::steady_clock::now());
+        TRACE_INT("LateWakeDelay", delay.count());
+        if (delay > 0ns) {
+            std::this_thread::sleep_for(delay);
+        }
+    }
+
+    mFrameDeadline = frameDeadline;
     mStartFrameTime = std::chrono::steady_clock::now();
     mCPUTracer.startTrace();
 
@@ -971,6 +1008,13 @@ void SwappyCommon::waitUntil(int32_t target) {
 
 void SwappyCommon::waitUntilTargetFrame() { waitUntil(mTargetFrame); }
 
+int32_t SwappyCommon::getCurrentFrame(
+    std::chrono::steady_clock::time_point* timestamp) {
+    std::lock_guard<std::mutex> lock(mWaitingMutex);
+    if (timestamp) *timestamp = mCurrentFrameTimestamp;
+    return mCurrentFrame;
+}
+
 void SwappyCommon::waitOneFrame() { waitUntil(mCurrentFrame + 1); }
 
 SdkVersion SwappyCommonSettings::getSDKVersion(JNIEnv* env) {
@@ -1131,6 +1175,25 @@ int SwappyCommon::getSupportedRefreshPeriodsNS(uint64_t* out_refreshrates,
     return (*mSupportedRefreshPeriods).size();
 }
 
+void SwappyCommon::onFramePresented(int64_t desiredPresentTimeNs,
+                                    int64_t actualPresentTimeNs) {
+    mBufferStuffing.onFramePresented(desiredPresentTimeNs, actualPresentTimeNs,
+                                     mCommonSettings.refreshPeriod.count());
+}
+
+bool SwappyCommon::getRefreshRatePlan(SwappyRefreshRatePlan* out_plan) {
+    if (!out_plan) return false;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    const RefreshRatePlanner::Option* plan = mRefreshRatePlanner.getPlan();
+    if (!plan) return false;
+
+    out_plan->refreshPeriodNS = plan->refreshPeriod.count();
+    out_plan->swapInterval = plan->swapInterval;
+    out_plan->modeId = plan->modeId;
+    return true;
+}
+
 void SwappyCommon::resetFramePacing() {
     std::lock_guard<std::mutex> lock(mMutex);
 
@@ -1154,4 +1217,15 @@ void SwappyCommon::enableBlockingWait(bool enable) {
     mBlockingWaitEnabled = enable;
 }
 
+void SwappyCommon::enableLowLatencyMode(bool enable) {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mLowLatencyModeEnabled = enable;
+}
+
+bool SwappyCommon::isFramePacingEnabled() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mFramePacingEnabled;
+}
+
 }  // namespace swappy
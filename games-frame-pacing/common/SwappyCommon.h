@@ -20,14 +20,18 @@
 
 #include <atomic>
 #include <chrono>
-#include <deque>
-#include <list>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include "CPUTracer.h"
 #include "ChoreographerFilter.h"
 #include "ChoreographerThread.h"
+#include "BufferStuffingDetector.h"
+#include "CopyOnWrite.h"
+#include "LateWakeScheduler.h"
+#include "RefreshRatePlanner.h"
+#include "RingBuffer.h"
 #include "SwappyDisplayManager.h"
 #include "Thread.h"
 #include "swappy/swappyGL.h"
@@ -62,10 +66,13 @@ class SwappyCommon {
    public:
     enum class PipelineMode { Off, On };
 
-    // callbacks to be called during pre/post swap
+    // callbacks to be called during pre/post swap. These are plain function
+    // pointers sharing one userData so that building them on every swap does
+    // not allocate.
     struct SwapHandlers {
-        std::function<bool()> lastFrameIsComplete;
-        std::function<std::chrono::nanoseconds()> getPrevFrameGpuTime;
+        bool (*lastFrameIsComplete)(void* userData);
+        std::chrono::nanoseconds (*getPrevFrameGpuTime)(void* userData);
+        void* userData;
     };
 
     SwappyCommon(JNIEnv* env, jobject jactivity);
@@ -118,25 +125,42 @@ class SwappyCommon {
     void setANativeWindow(ANativeWindow* window);
 
     void setBufferStuffingFixWait(int32_t nFrames) {
-        mBufferStuffingFixWait = std::max(0, nFrames);
+        mBufferStuffing.setStuffedFramesThreshold(nFrames);
     }
 
+    // Present timings of past frames, used to detect buffer stuffing. Frames
+    // must be reported in order, with times in nanoseconds on the
+    // CLOCK_MONOTONIC timeline.
+    void onFramePresented(int64_t desiredPresentTimeNs,
+                          int64_t actualPresentTimeNs);
+
     int getSupportedRefreshPeriodsNS(uint64_t* out_refreshrates,
                                      int allocated_entries);
-
-    void setLastLatencyRecordedCallback(std::function<int32_t()> callback) {
-        mLastLatencyRecorded = callback;
-    }
+    bool getRefreshRatePlan(SwappyRefreshRatePlan* out_plan);
 
     void resetFramePacing();
 
     void enableFramePacing(bool enable);
     void enableBlockingWait(bool enable);
+    void enableLowLatencyMode(bool enable);
+    bool isFramePacingEnabled();
+
+    // Vsync timeline driven by Choreographer. Outputs other than the one paced
+    // by onPreSwap/onPostSwap can use it to pace themselves on the same vsync
+    // source.
+    int32_t getCurrentFrame(std::chrono::steady_clock::time_point* timestamp);
+    void waitUntilFrame(int32_t frame) { waitUntil(frame); }
+
+    static int calculateSwapInterval(std::chrono::nanoseconds frameTime,
+                                     std::chrono::nanoseconds refreshPeriod);
 
    protected:
     // Used for testing
     SwappyCommon(const SwappyCommonSettings& settings);
 
+    // Lets the Vulkan backend use the testing constructor in its own tests.
+    friend class SwappyVkBase;
+
    private:
     class FrameDuration {
        public:
@@ -213,7 +237,7 @@ class SwappyCommon {
                            std::chrono::nanoseconds gpuTime);
     void startFrameCallbacks();
     void swapIntervalChangedCallbacks();
-    void onSettingsChanged();
+    void pollSettings() REQUIRES(mMutex);
     void updateMeasuredSwapDuration(std::chrono::nanoseconds duration);
     void startFrame();
     void waitUntil(int32_t target);
@@ -222,8 +246,6 @@ class SwappyCommon {
     void setPreferredDisplayModeId(int index);
     void setPreferredRefreshPeriod(std::chrono::nanoseconds frameTime)
         REQUIRES(mMutex);
-    int calculateSwapInterval(std::chrono::nanoseconds frameTime,
-                              std::chrono::nanoseconds refreshPeriod);
     void updateDisplayTimings();
 
     // Waits for the next frame, considering both Choreographer and the prior
@@ -255,6 +277,8 @@ class SwappyCommon {
     std::condition_variable mWaitingCondition;
     std::chrono::steady_clock::time_point mCurrentFrameTimestamp =
         std::chrono::steady_clock::now();
+    // When Choreographer last woke the client up.
+    std::chrono::steady_clock::time_point mCurrentFrameWakeTime;
     int32_t mCurrentFrame = 0;
     std::optional<std::chrono::nanoseconds> mSfToVsyncDelay;
     std::atomic<std::chrono::nanoseconds> mMeasuredSwapDuration;
@@ -271,11 +295,16 @@ class SwappyCommon {
         void clear();
 
        private:
+        void popFront();
+
         static constexpr std::chrono::nanoseconds
             FRAME_DURATION_SAMPLE_SECONDS = 2s;
+        // Enough for FRAME_DURATION_SAMPLE_SECONDS at 240Hz with some slack.
+        static constexpr size_t MAX_FRAME_DURATION_SAMPLES = 512;
 
-        std::deque<std::pair<std::chrono::time_point<std::chrono::steady_clock>,
-                             FrameDuration>>
+        RingBuffer<std::pair<std::chrono::time_point<std::chrono::steady_clock>,
+                             FrameDuration>,
+                   MAX_FRAME_DURATION_SAMPLES>
             mFrames;
         FrameDuration mFrameDurationsSum = {};
         int mMissedFrameCount = 0;
@@ -295,20 +324,24 @@ class SwappyCommon {
     int32_t mAutoSwapInterval;
     std::atomic<std::chrono::nanoseconds> mAutoSwapIntervalThreshold = {
         50ms};  // 20FPS
-    static constexpr std::chrono::nanoseconds REFRESH_RATE_MARGIN = 500ns;
 
     std::chrono::steady_clock::time_point mStartFrameTime;
+    // Wake up time of mTargetFrame: the frame's work should be done by then.
+    std::chrono::steady_clock::time_point mFrameDeadline;
+    LateWakeScheduler mLateWake;
 
     struct SwappyTracerCallbacks {
-        std::list<Tracer<>> preWait;
-        std::list<Tracer<int64_t, int64_t>> postWait;
-        std::list<Tracer<>> preSwapBuffers;
-        std::list<Tracer<int64_t>> postSwapBuffers;
-        std::list<Tracer<int32_t, int64_t>> startFrame;
-        std::list<Tracer<>> swapIntervalChanged;
+        std::vector<Tracer<>> preWait;
+        std::vector<Tracer<int64_t, int64_t>> postWait;
+        std::vector<Tracer<>> preSwapBuffers;
+        std::vector<Tracer<int64_t>> postSwapBuffers;
+        std::vector<Tracer<int32_t, int64_t>> startFrame;
+        std::vector<Tracer<>> swapIntervalChanged;
     };
 
-    SwappyTracerCallbacks mInjectedTracers;
+    // Dispatched every frame from the swap thread while tracers can be added
+    // or removed from any thread.
+    CopyOnWrite<SwappyTracerCallbacks> mInjectedTracers;
 
     int32_t mTargetFrame = 0;
     std::chrono::steady_clock::time_point mPresentationTime =
@@ -326,17 +359,21 @@ class SwappyCommon {
 
     std::shared_ptr<SwappyDisplayManager::RefreshPeriodMap>
         mSupportedRefreshPeriods;
+    // Table mRefreshRatePlanner was last loaded with.
+    std::shared_ptr<SwappyDisplayManager::RefreshPeriodMap>
+        mPlannedRefreshPeriods GUARDED_BY(mMutex);
+    RefreshRatePlanner mRefreshRatePlanner GUARDED_BY(mMutex);
 
     struct TimingSettings {
         std::chrono::nanoseconds refreshPeriod = {};
         std::chrono::nanoseconds swapDuration = {};
 
-        static TimingSettings from(const Settings& settings) {
+        static TimingSettings from(const Settings::Snapshot& settings) {
             TimingSettings timingSettings;
 
             timingSettings.refreshPeriod =
-                settings.getDisplayTimings().refreshPeriod;
-            timingSettings.swapDuration = settings.getSwapDuration();
+                settings.displayTimings.refreshPeriod;
+            timingSettings.swapDuration = settings.swapDuration;
             return timingSettings;
         }
 
@@ -350,6 +387,8 @@ class SwappyCommon {
         }
     };
     TimingSettings mNextTimingSettings GUARDED_BY(mMutex) = {};
+    // Version of the Settings snapshot mNextTimingSettings was read from.
+    uint64_t mSettingsVersion GUARDED_BY(mMutex) = 0;
     bool mTimingSettingsNeedUpdate GUARDED_BY(mMutex) = false;
 
     CPUTracer mCPUTracer;
@@ -359,20 +398,7 @@ class SwappyCommon {
     float mLatestFrameRateVote GUARDED_BY(mMutex) = 0.f;
     static constexpr float FRAME_RATE_VOTE_MARGIN = 1.f;  // 1Hz
 
-    // Callback for last latency recorded - used for buffer stuffing fix.
-    // Latency is returned in number of V-syncs
-    std::function<int32_t()> mLastLatencyRecorded;
-
-    // If zero, don't apply the double buffering fix. If non-zero, apply
-    // the fix after this number of bad frames.
-    int mBufferStuffingFixWait = 0;
-    // When zero, buffer stuffing fixing may occur.
-    // After a fix has been applied, this is non-zero and counts down to avoid
-    // consecutive fixes.
-    int mBufferStuffingFixCounter = 0;
-    // Counts the number of consecutive missed frames (as judged by expected
-    // latency).
-    int mMissedFrameCounter = 0;
+    BufferStuffingDetector mBufferStuffing;
 
     bool mFramePacingResetRequested GUARDED_BY(mMutex) = false;
 
@@ -381,6 +407,7 @@ class SwappyCommon {
     bool mFramePacingToggleRequested GUARDED_BY(mMutex) = false;
     bool mFramePacingEnabled GUARDED_BY(mMutex) = true;
     bool mBlockingWaitEnabled GUARDED_BY(mMutex) = true;
+    bool mLowLatencyModeEnabled GUARDED_BY(mMutex) = false;
 };
 
 }  // namespace swappy
@@ -1,7 +1,10 @@
 package com.google.androidgamesdk;
 
+import java.io.File;
+
 /** JNI api for getting device information */
 public class GameSdkDeviceInfoJni {
+  private static final String CACHE_FILE_NAME = "game_sdk_device_info.bin";
   private static Throwable initializationExceptionOrError;
 
   static {
@@ -33,6 +36,26 @@ public class GameSdkDeviceInfoJni {
     return getProtoSerialized();
   }
 
+  /**
+   * Same as {@link #tryGetProtoSerialized()}, but the device information is cached in a file in
+   * the given directory, typically the application's cache directory. The cache is used until the
+   * library or the system is updated, so that only the first call collects the information.
+   *
+   * @param cacheDir The directory of the cache file, or null not to use a cache.
+   * @return Optional with the serialized byte array, representing game sdk device info with errors,
+   * or null.
+   */
+  public static byte[] tryGetProtoSerialized(File cacheDir) {
+    if (initializationExceptionOrError != null) {
+      return null;
+    }
+
+    if (cacheDir == null) {
+      return getProtoSerialized();
+    }
+    return getProtoSerializedCached(new File(cacheDir, CACHE_FILE_NAME).getPath());
+  }
+
 
   /**
    * Returns the exception or error that was caught when trying to load the library, if any.
@@ -51,5 +74,13 @@ public class GameSdkDeviceInfoJni {
    */
   private static native byte[] getProtoSerialized();
 
+  /**
+   * Returns a byte array, which is a serialized proto, read from or written to the cache file.
+   *
+   * @param cacheFileName path of the cache file.
+   * @return serialized byte array, representing game sdk device info with errors.
+   */
+  private static native byte[] getProtoSerializedCached(String cacheFileName);
+
   private GameSdkDeviceInfoJni() {}
 }
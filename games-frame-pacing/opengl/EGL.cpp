@@ -19,7 +19,8 @@
 #include <Trace.h>
 #include <dlfcn.h>
 
-#include <vector>
+#include <algorithm>
+#include <array>
 
 #define LOG_TAG "Swappy::EGL"
 
@@ -49,6 +50,16 @@ std::unique_ptr<EGL> EGL::create(std::chrono::nanoseconds fenceTimeout) {
         return nullptr;
     }
 
+    auto egl = create(fenceTimeout, eglGetProcAddress, eglSwapBuffers);
+    if (egl) {
+        egl->eglLib = eglLib;
+    }
+    return egl;
+}
+
+std::unique_ptr<EGL> EGL::create(std::chrono::nanoseconds fenceTimeout,
+                                 eglGetProcAddress_type eglGetProcAddress,
+                                 eglSwapBuffers_type eglSwapBuffers) {
     auto eglPresentationTimeANDROID =
         reinterpret_cast<eglPresentationTimeANDROID_type>(
             eglGetProcAddress("eglPresentationTimeANDROID"));
@@ -116,7 +127,6 @@ std::unique_ptr<EGL> EGL::create(std::chrono::nanoseconds fenceTimeout) {
 
     auto egl = std::make_unique<EGL>(fenceTimeout, eglGetProcAddress,
                                      ConstructorTag{});
-    egl->eglLib = eglLib;
     egl->eglSwapBuffers = eglSwapBuffers;
     egl->eglGetProcAddress = eglGetProcAddress;
     egl->eglPresentationTimeANDROID = eglPresentationTimeANDROID;
@@ -130,12 +140,18 @@ std::unique_ptr<EGL> EGL::create(std::chrono::nanoseconds fenceTimeout) {
     egl->eglGetFrameTimestampsANDROID = eglGetFrameTimestampsANDROID;
 
     std::lock_guard<std::mutex> lock(egl->mWaiterThreadContext.lock);
-    egl->mWaiterThreadContext.thread =
-        Thread([egl = egl.get()]() { egl->waitForFenceThreadMain(); });
+    egl->startWaiterThread();
 
     return egl;
 }
 
+void EGL::startWaiterThread() {
+    mWaiterThreadContext.running = true;
+    mWaiterThreadContext.hasPendingWork = !mWaitPendingSyncs.empty();
+    mWaiterThreadContext.thread =
+        Thread([this]() { waitForFenceThreadMain(); });
+}
+
 EGL::~EGL() {
     // Stop the fence waiter thread
     {
@@ -146,7 +162,7 @@ EGL::~EGL() {
 
     mWaiterThreadContext.thread.join();
 
-    while (mWaitPendingSyncs.size() > 0) {
+    while (!mWaitPendingSyncs.empty()) {
         auto sync = mWaitPendingSyncs.front();
         mWaitPendingSyncs.pop_front();
         // There is no need to wait here as the API allows for queueing pending
@@ -190,21 +206,22 @@ std::pair<bool, EGLuint64KHR> EGL::getNextFrameId(EGLDisplay dpy,
     return {true, frameId};
 }
 
-std::unique_ptr<EGL::FrameTimestamps> EGL::getFrameTimestamps(
-    EGLDisplay dpy, EGLSurface surface, EGLuint64KHR frameId) const {
+bool EGL::getFrameTimestamps(EGLDisplay dpy, EGLSurface surface,
+                             EGLuint64KHR frameId,
+                             FrameTimestamps *out) const {
 #if (not defined ANDROID_NDK_VERSION) || ANDROID_NDK_VERSION >= 15
     if (eglGetFrameTimestampsANDROID == nullptr) {
         SWAPPY_LOGE("stats are not supported on this platform");
-        return nullptr;
+        return false;
     }
-    const std::vector<EGLint> timestamps = {
+    static constexpr std::array<EGLint, 4> timestamps = {
         EGL_REQUESTED_PRESENT_TIME_ANDROID,
         EGL_RENDERING_COMPLETE_TIME_ANDROID,
         EGL_COMPOSITION_LATCH_TIME_ANDROID,
         EGL_DISPLAY_PRESENT_TIME_ANDROID,
     };
 
-    std::vector<EGLnsecsANDROID> values(timestamps.size());
+    std::array<EGLnsecsANDROID, timestamps.size()> values;
 
     EGLBoolean result =
         eglGetFrameTimestampsANDROID(dpy, surface, frameId, timestamps.size(),
@@ -217,38 +234,60 @@ std::unique_ptr<EGL::FrameTimestamps> EGL::getFrameTimestamps(
             SWAPPY_LOGE_ONCE("Failed to get timestamps for frame %llu",
                              (unsigned long long)frameId);
         }
-        return nullptr;
+        return false;
     }
 
     // try again if we got some pending stats
     for (auto i : values) {
-        if (i == EGL_TIMESTAMP_PENDING_ANDROID) return nullptr;
+        if (i == EGL_TIMESTAMP_PENDING_ANDROID) return false;
     }
 
-    std::unique_ptr<EGL::FrameTimestamps> frameTimestamps =
-        std::make_unique<EGL::FrameTimestamps>();
-    frameTimestamps->requested = values[0];
-    frameTimestamps->renderingCompleted = values[1];
-    frameTimestamps->compositionLatched = values[2];
-    frameTimestamps->presented = values[3];
+    out->requested = values[0];
+    out->renderingCompleted = values[1];
+    out->compositionLatched = values[2];
+    out->presented = values[3];
 
-    return frameTimestamps;
+    return true;
 #else
-    return nullptr;
+    return false;
 #endif
 }
 
-void EGL::insertSyncFence(EGLDisplay display) {
+void EGL::insertSyncFence(EGLDisplay display, EGLSurface surface) {
+    bool polling;
+    {
+        std::lock_guard<std::mutex> lock(mWaiterThreadContext.lock);
+        polling = mFencePolling;
+        if (polling) {
+            pollSyncFencesLocked();
+        }
+        if (mWaitPendingSyncs.full()) {
+            SWAPPY_LOGW_ONCE("Too many pending sync fences, skipping fence");
+            return;
+        }
+    }
+
     EGLSyncKHR sync_fence =
         eglCreateSyncKHR(display, EGL_SYNC_FENCE_KHR, nullptr);
 
     if (sync_fence != EGL_NO_SYNC_KHR) {
-        EGLSync sync = {display, sync_fence};
-        // kick off the thread work to wait for the fence and measure its time
+        const auto now = std::chrono::steady_clock::now();
+        EGLSync sync = {display, surface, sync_fence, now, now, {false, 0}};
+        // Remember which frame the fence belongs to so that its rendering
+        // complete timestamp can be used once the fence is signaled.
+        if (polling && statsSupported()) {
+            sync.frameId = getNextFrameId(display, surface);
+        }
+
+        // Only this thread pushes, so there is still room in the queue.
         std::lock_guard<std::mutex> lock(mWaiterThreadContext.lock);
         mWaitPendingSyncs.push_back(sync);
-        mWaiterThreadContext.hasPendingWork = true;
-        mWaiterThreadContext.condition.notify_all();
+        if (!mFencePolling) {
+            // kick off the thread work to wait for the fence and measure its
+            // time.
+            mWaiterThreadContext.hasPendingWork = true;
+            mWaiterThreadContext.condition.notify_all();
+        }
     } else {
         SWAPPY_LOGE("Failed to create sync fence");
     }
@@ -256,6 +295,9 @@ void EGL::insertSyncFence(EGLDisplay display) {
 
 bool EGL::lastFrameIsComplete(EGLDisplay display, bool pipelineMode) {
     std::lock_guard<std::mutex> lock(mWaiterThreadContext.lock);
+    if (mFencePolling) {
+        pollSyncFencesLocked();
+    }
     if (pipelineMode) {
         // We are in pipeline mode so we need to check the fence of frame N-1
         return mWaitPendingSyncs.size() < 2;
@@ -265,6 +307,102 @@ bool EGL::lastFrameIsComplete(EGLDisplay display, bool pipelineMode) {
     return mWaitPendingSyncs.empty();
 }
 
+void EGL::setFencePolling(bool enabled) {
+    std::lock_guard<std::mutex> modeLock(mFenceModeMutex);
+    if (enabled) {
+        {
+            std::lock_guard<std::mutex> lock(mWaiterThreadContext.lock);
+            if (mFencePolling) return;
+            mWaiterThreadContext.running = false;
+            mWaiterThreadContext.condition.notify_one();
+        }
+
+        mWaiterThreadContext.thread.join();
+        mWaiterThreadContext.thread = Thread();
+
+        // Only start polling once the waiter thread is gone, so that the
+        // pending fences are never retired from two threads.
+        std::lock_guard<std::mutex> lock(mWaiterThreadContext.lock);
+        mFencePolling = true;
+    } else {
+        std::lock_guard<std::mutex> lock(mWaiterThreadContext.lock);
+        if (!mFencePolling) return;
+        mFencePolling = false;
+        startWaiterThread();
+    }
+}
+
+void EGL::pollSyncFences() {
+    std::lock_guard<std::mutex> lock(mWaiterThreadContext.lock);
+    if (mFencePolling) {
+        pollSyncFencesLocked();
+    }
+}
+
+void EGL::pollSyncFencesLocked() {
+    const auto now = std::chrono::steady_clock::now();
+    while (!mWaitPendingSyncs.empty()) {
+        EGLSync &sync = mWaitPendingSyncs.front();
+
+        EGLint status = EGL_UNSIGNALED_KHR;
+        EGLBoolean result = eglGetSyncAttribKHR(sync.display, sync.fence,
+                                                EGL_SYNC_STATUS_KHR, &status);
+        if (result == EGL_FALSE) {
+            SWAPPY_LOGE("Failed to get sync status");
+        } else if (status == EGL_SIGNALED_KHR) {
+            // The fence was signaled somewhere between the previous poll and
+            // this one, unless the driver tells us exactly when.
+            auto completeTime = getRenderingCompleteTime(sync);
+            if (!completeTime) {
+                completeTime =
+                    sync.lastPollTime + (now - sync.lastPollTime) / 2;
+            }
+            mFencePendingTime =
+                std::max(std::chrono::nanoseconds(0),
+                         std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             *completeTime - sync.insertTime));
+        } else if (now - sync.insertTime >= mFenceTimeout) {
+            SWAPPY_LOGE("Timeout waiting for fence");
+            mFencePendingTime =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    now - sync.insertTime);
+        } else {
+            // Fences are signaled in order, no need to check the later ones.
+            sync.lastPollTime = now;
+            return;
+        }
+
+        result = eglDestroySyncKHR(sync.display, sync.fence);
+        if (result == EGL_FALSE) {
+            SWAPPY_LOGE("Failed to destroy sync fence");
+        }
+        mWaitPendingSyncs.pop_front();
+    }
+}
+
+std::optional<std::chrono::steady_clock::time_point>
+EGL::getRenderingCompleteTime(const EGLSync &sync) const {
+#if (not defined ANDROID_NDK_VERSION) || ANDROID_NDK_VERSION >= 15
+    if (!sync.frameId.first || eglGetFrameTimestampsANDROID == nullptr) {
+        return std::nullopt;
+    }
+
+    const EGLint name = EGL_RENDERING_COMPLETE_TIME_ANDROID;
+    EGLnsecsANDROID value;
+    EGLBoolean result = eglGetFrameTimestampsANDROID(
+        sync.display, sync.surface, sync.frameId.second, 1, &name, &value);
+    // Pending and invalid timestamps are negative.
+    if (result == EGL_FALSE || value <= 0) {
+        return std::nullopt;
+    }
+
+    return std::chrono::steady_clock::time_point(
+        std::chrono::nanoseconds(value));
+#else
+    return std::nullopt;
+#endif
+}
+
 void EGL::waitForFenceThreadMain() {
     while (true) {
         bool waitingSyncsEmpty;
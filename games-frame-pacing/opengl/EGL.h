@@ -22,10 +22,12 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
-#include <list>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <utility>
 
+#include "RingBuffer.h"
 #include "Thread.h"
 
 namespace swappy {
@@ -46,6 +48,7 @@ class EGL {
     };
 
     using eglGetProcAddress_type = void (*(*)(const char *))(void);
+    using eglSwapBuffers_type = EGLBoolean (*)(EGLDisplay, EGLSurface);
 
     explicit EGL(std::chrono::nanoseconds fenceTimeout,
                  eglGetProcAddress_type getProcAddress, ConstructorTag)
@@ -53,8 +56,23 @@ class EGL {
     ~EGL();
     static std::unique_ptr<EGL> create(std::chrono::nanoseconds fenceTimeout);
 
-    void insertSyncFence(EGLDisplay display);
+    // Resolves the remaining EGL entry points through getProcAddress instead
+    // of libEGL. This allows tests to supply a fake EGL function table.
+    static std::unique_ptr<EGL> create(std::chrono::nanoseconds fenceTimeout,
+                                       eglGetProcAddress_type getProcAddress,
+                                       eglSwapBuffers_type swapBuffers);
+
+    void insertSyncFence(EGLDisplay display, EGLSurface surface);
     bool lastFrameIsComplete(EGLDisplay display, bool pipelineMode);
+    // By default a dedicated thread blocks on each fence to measure the GPU
+    // time. With fence polling enabled that thread is stopped and fences are
+    // instead checked without blocking whenever a fence is inserted, the last
+    // frame's completion is queried or pollSyncFences is called. The GPU
+    // completion time is then taken from the rendering complete timestamp of
+    // the frame if available, or estimated as the midpoint between the last
+    // poll that saw the fence pending and the one that saw it signaled.
+    void setFencePolling(bool enabled);
+    void pollSyncFences();
     bool setPresentationTime(EGLDisplay display, EGLSurface surface,
                              std::chrono::steady_clock::time_point time);
     std::chrono::nanoseconds getFencePendingTime() const {
@@ -65,8 +83,10 @@ class EGL {
     bool statsSupported();
     std::pair<bool, EGLuint64KHR> getNextFrameId(EGLDisplay dpy,
                                                  EGLSurface surface) const;
-    std::unique_ptr<FrameTimestamps> getFrameTimestamps(
-        EGLDisplay dpy, EGLSurface surface, EGLuint64KHR frameId) const;
+    // Returns false if the timestamps are not available (yet), in which case
+    // out is left untouched.
+    bool getFrameTimestamps(EGLDisplay dpy, EGLSurface surface,
+                            EGLuint64KHR frameId, FrameTimestamps *out) const;
     EGLBoolean swapBuffers(EGLDisplay dpy, EGLSurface surface) {
         return this->eglSwapBuffers(dpy, surface);
     }
@@ -74,7 +94,6 @@ class EGL {
    private:
     void *eglLib = nullptr;
     eglGetProcAddress_type eglGetProcAddress = nullptr;
-    using eglSwapBuffers_type = EGLBoolean (*)(EGLDisplay, EGLSurface);
     eglSwapBuffers_type eglSwapBuffers = nullptr;
     using eglPresentationTimeANDROID_type = EGLBoolean (*)(EGLDisplay,
                                                            EGLSurface,
@@ -110,9 +129,17 @@ class EGL {
 
     struct EGLSync {
         EGLDisplay display;
+        EGLSurface surface;
         EGLSyncKHR fence;
+        // Only used when polling
+        std::chrono::steady_clock::time_point insertTime;
+        std::chrono::steady_clock::time_point lastPollTime;
+        std::pair<bool, EGLuint64KHR> frameId;
     };
-    std::list<EGLSync> mWaitPendingSyncs;
+    // Fences are normally retired within a couple of frames. If the GPU falls
+    // further behind than this, new fences are skipped until it catches up.
+    static constexpr size_t MAX_PENDING_SYNCS = 8;
+    RingBuffer<EGLSync, MAX_PENDING_SYNCS> mWaitPendingSyncs;
     std::atomic<std::chrono::nanoseconds> mFencePendingTime;
 
     // Thread Context for the thread waiting on EGL fences
@@ -127,6 +154,14 @@ class EGL {
 
     WaiterThreadContext mWaiterThreadContext;
     void waitForFenceThreadMain();
+
+    // Serializes starting and stopping the waiter thread
+    std::mutex mFenceModeMutex;
+    bool mFencePolling GUARDED_BY(mWaiterThreadContext.lock) = false;
+    void pollSyncFencesLocked() REQUIRES(mWaiterThreadContext.lock);
+    void startWaiterThread() REQUIRES(mWaiterThreadContext.lock);
+    std::optional<std::chrono::steady_clock::time_point>
+    getRenderingCompleteTime(const EGLSync &sync) const;
 };
 
 }  // namespace swappy
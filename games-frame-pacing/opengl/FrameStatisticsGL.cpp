@@ -29,9 +29,7 @@ namespace swappy {
 
 FrameStatisticsGL::FrameStatisticsGL(const EGL& egl,
                                      const SwappyCommon& swappyCommon)
-    : mEgl(egl), mSwappyCommon(swappyCommon) {
-    mPendingFrames.reserve(MAX_FRAME_LAG + 1);
-}
+    : mEgl(egl), mSwappyCommon(swappyCommon) {}
 
 FrameStatisticsGL::ThisFrame FrameStatisticsGL::getThisFrame(
     EGLDisplay dpy, EGLSurface surface) {
@@ -41,6 +39,10 @@ FrameStatisticsGL::ThisFrame FrameStatisticsGL::getThisFrame(
     std::pair<bool, EGLuint64KHR> nextFrameId =
         mEgl.getNextFrameId(dpy, surface);
     if (nextFrameId.first) {
+        if (mPendingFrames.full()) {
+            mPendingFrames.pop_front();
+            mFrameStatsCommon.invalidateLastFrame();
+        }
         mPendingFrames.push_back(
             {dpy, surface, nextFrameId.second, frameStartTime});
     }
@@ -52,28 +54,27 @@ FrameStatisticsGL::ThisFrame FrameStatisticsGL::getThisFrame(
     EGLFrame frame = mPendingFrames.front();
     // make sure we don't lag behind the stats too much
     if (nextFrameId.first && nextFrameId.second - frame.id > MAX_FRAME_LAG) {
-        while (mPendingFrames.size() > 1)
-            mPendingFrames.erase(mPendingFrames.begin());
+        while (mPendingFrames.size() > 1) mPendingFrames.pop_front();
         mFrameStatsCommon.invalidateLastFrame();
         frame = mPendingFrames.front();
     }
-    std::unique_ptr<EGL::FrameTimestamps> frameStats =
-        mEgl.getFrameTimestamps(frame.dpy, frame.surface, frame.id);
-
-    if (!frameStats) {
+    EGL::FrameTimestamps frameStats;
+    if (!mEgl.getFrameTimestamps(frame.dpy, frame.surface, frame.id,
+                                 &frameStats)) {
         return {frame.startFrameTime};
     }
 
-    mPendingFrames.erase(mPendingFrames.begin());
+    mPendingFrames.pop_front();
 
-    return {frame.startFrameTime, std::move(frameStats)};
+    return {frame.startFrameTime, frameStats};
 }
 
 // called once per swap
-void FrameStatisticsGL::capture(EGLDisplay dpy, EGLSurface surface) {
+std::optional<FrameTimings> FrameStatisticsGL::capture(EGLDisplay dpy,
+                                                       EGLSurface surface) {
     auto frame = getThisFrame(dpy, surface);
 
-    if (!frame.stats) return;
+    if (!frame.stats) return std::nullopt;
 
     FrameTimings current = {
         static_cast<uint64_t>(frame.startTime.time_since_epoch().count()),
@@ -84,6 +85,7 @@ void FrameStatisticsGL::capture(EGLDisplay dpy, EGLSurface surface) {
 
     mFrameStatsCommon.updateFrameStats(
         current, mSwappyCommon.getRefreshPeriod().count());
+    return current;
 }
 
 void FrameStatisticsGL::enableStats(bool enabled) {
@@ -95,8 +97,4 @@ SwappyStats FrameStatisticsGL::getStats() {
 }
 
 void FrameStatisticsGL::clearStats() { mFrameStatsCommon.clearStats(); }
-
-int32_t FrameStatisticsGL::lastLatencyRecorded() {
-    return mFrameStatsCommon.lastLatencyRecorded();
-}
 }  // namespace swappy
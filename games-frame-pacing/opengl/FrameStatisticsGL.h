@@ -19,10 +19,11 @@
 #include <array>
 #include <atomic>
 #include <map>
-#include <vector>
+#include <optional>
 
 #include "EGL.h"
 #include "FrameStatistics.h"
+#include "RingBuffer.h"
 #include "SwappyCommon.h"
 #include "Thread.h"
 
@@ -37,17 +38,17 @@ class FrameStatisticsGL {
     ~FrameStatisticsGL() = default;
 
     void enableStats(bool enabled);
-    void capture(EGLDisplay dpy, EGLSurface surface);
+    // Returns the timings of the oldest frame whose timestamps became
+    // available, if any.
+    std::optional<FrameTimings> capture(EGLDisplay dpy, EGLSurface surface);
     SwappyStats getStats();
     void clearStats();
 
-    int32_t lastLatencyRecorded();
-
    protected:
     static constexpr int MAX_FRAME_LAG = 10;
     struct ThisFrame {
         TimePoint startTime;
-        std::unique_ptr<EGL::FrameTimestamps> stats;
+        std::optional<EGL::FrameTimestamps> stats;
     };
     ThisFrame getThisFrame(EGLDisplay dpy, EGLSurface surface);
 
@@ -60,7 +61,7 @@ class FrameStatisticsGL {
         EGLuint64KHR id;
         TimePoint startFrameTime;
     };
-    std::vector<EGLFrame> mPendingFrames;
+    RingBuffer<EGLFrame, MAX_FRAME_LAG + 1> mPendingFrames;
     FrameStatistics mFrameStatsCommon;
 };
 
@@ -58,6 +58,9 @@ void SwappyGL::onChoreographer(int64_t frameTimeNanos) {
     }
 
     swappy->mCommonBase.onChoreographer(frameTimeNanos);
+    if (EGL *egl = swappy->getEgl()) {
+        egl->pollSyncFences();
+    }
 }
 
 bool SwappyGL::setWindow(ANativeWindow *window) {
@@ -100,13 +103,22 @@ bool SwappyGL::lastFrameIsComplete(EGLDisplay display) {
 }
 
 bool SwappyGL::swapInternal(EGLDisplay display, EGLSurface surface) {
+    SwapContext context = {this, display};
     const SwappyCommon::SwapHandlers handlers = {
-        .lastFrameIsComplete = [&]() { return lastFrameIsComplete(display); },
+        .lastFrameIsComplete =
+            [](void *userData) {
+                auto context = static_cast<SwapContext *>(userData);
+                return context->swappy->lastFrameIsComplete(context->display);
+            },
         .getPrevFrameGpuTime =
-            [&]() { return getEgl()->getFencePendingTime(); },
+            [](void *userData) {
+                auto context = static_cast<SwapContext *>(userData);
+                return context->swappy->getEgl()->getFencePendingTime();
+            },
+        .userData = &context,
     };
 
-    getEgl()->insertSyncFence(display);
+    getEgl()->insertSyncFence(display, surface);
 
     mCommonBase.onPreSwap(handlers);
 
@@ -195,7 +207,11 @@ void SwappyGL::recordFrameStart(EGLDisplay display, EGLSurface surface) {
     }
 
     if (swappy->mFrameStatistics) {
-        swappy->mFrameStatistics->capture(display, surface);
+        auto timings = swappy->mFrameStatistics->capture(display, surface);
+        if (timings) {
+            swappy->mCommonBase.onFramePresented(timings->desiredPresentTime,
+                                                 timings->actualPresentTime);
+        }
     }
 }
 
@@ -293,8 +309,6 @@ SwappyGL::SwappyGL(JNIEnv *env, jobject jactivity, ConstructorTag)
     if (mEgl->statsSupported()) {
         mFrameStatistics =
             std::make_unique<FrameStatisticsGL>(*mEgl, mCommonBase);
-        mCommonBase.setLastLatencyRecordedCallback(
-            [this]() { return this->mFrameStatistics->lastLatencyRecorded(); });
     } else {
         SWAPPY_LOGI("stats are not suppored on this platform");
     }
@@ -336,6 +350,15 @@ int SwappyGL::getSupportedRefreshPeriodsNS(uint64_t *out_refreshrates,
                                                             allocated_entries);
 }
 
+bool SwappyGL::getRefreshRatePlan(SwappyRefreshRatePlan *out_plan) {
+    TRACE_CALL();
+    SwappyGL *swappy = getInstance();
+    if (!swappy) {
+        return false;
+    }
+    return swappy->mCommonBase.getRefreshRatePlan(out_plan);
+}
+
 void SwappyGL::resetFramePacing() {
     TRACE_CALL();
     SwappyGL *swappy = getInstance();
@@ -363,4 +386,24 @@ void SwappyGL::enableBlockingWait(bool enable) {
     swappy->mCommonBase.enableBlockingWait(enable);
 }
 
+void SwappyGL::enableLowLatencyMode(bool enable) {
+    TRACE_INT("enableLowLatencyMode", (int)enable);
+    SwappyGL *swappy = getInstance();
+    if (!swappy) {
+        return;
+    }
+    swappy->mCommonBase.enableLowLatencyMode(enable);
+}
+
+void SwappyGL::enableFencePolling(bool enable) {
+    TRACE_INT("enableFencePolling", (int)enable);
+    SwappyGL *swappy = getInstance();
+    if (!swappy) {
+        return;
+    }
+    if (EGL *egl = swappy->getEgl()) {
+        egl->setFencePolling(enable);
+    }
+}
+
 }  // namespace swappy
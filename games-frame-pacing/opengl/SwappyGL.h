@@ -79,11 +79,14 @@ class SwappyGL {
 
     static int getSupportedRefreshPeriodsNS(uint64_t *out_refreshrates,
                                             int allocated_entries);
+    static bool getRefreshRatePlan(SwappyRefreshRatePlan *out_plan);
 
     static void resetFramePacing();
 
     static void enableFramePacing(bool enable);
     static void enableBlockingWait(bool enable);
+    static void enableFencePolling(bool enable);
+    static void enableLowLatencyMode(bool enable);
 
    private:
     static SwappyGL *getInstance();
@@ -92,6 +95,12 @@ class SwappyGL {
 
     EGL *getEgl();
 
+    // State passed to the SwappyCommon swap handlers.
+    struct SwapContext {
+        SwappyGL *swappy;
+        EGLDisplay display;
+    };
+
     bool swapInternal(EGLDisplay display, EGLSurface surface);
 
     bool lastFrameIsComplete(EGLDisplay display);
@@ -127,6 +127,10 @@ int SwappyGL_getSupportedRefreshPeriodsNS(uint64_t *out_refreshrates,
                                                   allocated_entries);
 }
 
+bool SwappyGL_getRefreshRatePlan(SwappyRefreshRatePlan *out_plan) {
+    return SwappyGL::getRefreshRatePlan(out_plan);
+}
+
 void SwappyGL_resetFramePacing() { SwappyGL::resetFramePacing(); }
 
 void SwappyGL_enableFramePacing(bool enable) {
@@ -137,4 +141,12 @@ void SwappyGL_enableBlockingWait(bool enable) {
     SwappyGL::enableBlockingWait(enable);
 }
 
+void SwappyGL_enableFencePolling(bool enable) {
+    SwappyGL::enableFencePolling(enable);
+}
+
+void SwappyGL_enableLowLatencyMode(bool enable) {
+    SwappyGL::enableLowLatencyMode(enable);
+}
+
 }  // extern "C" {
@@ -290,8 +290,17 @@ class Simulator : public ITimeProvider {
     }
     bool swapInternal() {
         const SwappyCommon::SwapHandlers handlers = {
-            .lastFrameIsComplete = [&]() { return lastFrameIsComplete(); },
-            .getPrevFrameGpuTime = [&]() { return getFencePendingTime(); },
+            .lastFrameIsComplete =
+                [](void* userData) {
+                    return static_cast<Simulator*>(userData)
+                        ->lastFrameIsComplete();
+                },
+            .getPrevFrameGpuTime =
+                [](void* userData) {
+                    return static_cast<Simulator*>(userData)
+                        ->getFencePendingTime();
+                },
+            .userData = this,
         };
 
         commonBase_->onPreSwap(handlers);
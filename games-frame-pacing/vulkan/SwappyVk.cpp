@@ -154,6 +154,12 @@ bool SwappyVk::GetRefreshCycleDuration(JNIEnv* env, jobject jactivity,
                                        VkSwapchainKHR swapchain,
                                        uint64_t* pRefreshDuration) {
     auto& pImplementation = perSwapchainImplementation[swapchain];
+    if (!pImplementation) {
+        auto device_it = perDeviceImplementation.find(device);
+        if (device_it != perDeviceImplementation.end()) {
+            pImplementation = device_it->second;
+        }
+    }
     if (!pImplementation) {
         if (!InitFunctions()) {
             // If Vulkan doesn't exist, bail-out early
@@ -189,16 +195,19 @@ bool SwappyVk::GetRefreshCycleDuration(JNIEnv* env, jobject jactivity,
                 physicalDevice, device);
             return false;
         }
-    }
 
-    // SwappyBase is constructed by this point, so we can add the tracers we
-    // have so far.
-    {
-        std::lock_guard<std::mutex> lock(tracer_list_lock);
-        for (const auto& tracer : tracer_list) {
-            pImplementation->addTracer(&tracer);
+        // SwappyBase is constructed by this point, so we can add the tracers
+        // we have so far.
+        {
+            std::lock_guard<std::mutex> lock(tracer_list_lock);
+            for (const auto& tracer : tracer_list) {
+                pImplementation->addTracer(&tracer);
+            }
         }
+        perDeviceImplementation[device] = pImplementation;
     }
+    pImplementation->addSwapchain(swapchain);
+
     // Now, call that derived class to get the refresh duration to return
     return pImplementation->doGetRefreshCycleDuration(swapchain,
                                                       pRefreshDuration);
@@ -213,7 +222,7 @@ void SwappyVk::SetWindow(VkDevice device, VkSwapchainKHR swapchain,
     if (!pImplementation) {
         return;
     }
-    pImplementation->doSetWindow(window);
+    pImplementation->doSetWindow(swapchain, window);
 }
 
 /**
@@ -264,7 +273,13 @@ VkResult SwappyVk::QueuePresent(VkQueue queue,
 void SwappyVk::DestroySwapchain(VkDevice /*device*/, VkSwapchainKHR swapchain) {
     auto swapchain_it = perSwapchainImplementation.find(swapchain);
     if (swapchain_it == perSwapchainImplementation.end()) return;
-    perSwapchainImplementation.erase(swapchain);
+    auto pImplementation = swapchain_it->second;
+    perSwapchainImplementation.erase(swapchain_it);
+
+    // The implementation goes away with the last swapchain of the device.
+    if (pImplementation && pImplementation->removeSwapchain(swapchain) == 0) {
+        perDeviceImplementation.erase(pImplementation->getDevice());
+    }
 }
 
 void SwappyVk::DestroyDevice(VkDevice device) {
@@ -272,12 +287,13 @@ void SwappyVk::DestroyDevice(VkDevice device) {
         // Erase swapchains
         auto it = perSwapchainImplementation.begin();
         while (it != perSwapchainImplementation.end()) {
-            if (it->second->getDevice() == device) {
+            if (it->second && it->second->getDevice() == device) {
                 it = perSwapchainImplementation.erase(it);
             } else {
                 ++it;
             }
         }
+        perDeviceImplementation.erase(device);
     }
     {
         // Erase the device
@@ -293,32 +309,32 @@ void SwappyVk::DestroyDevice(VkDevice device) {
 }
 
 void SwappyVk::SetAutoSwapInterval(bool enabled) {
-    for (auto i : perSwapchainImplementation) {
+    for (auto i : perDeviceImplementation) {
         i.second->setAutoSwapInterval(enabled);
     }
 }
 
 void SwappyVk::SetAutoPipelineMode(bool enabled) {
-    for (auto i : perSwapchainImplementation) {
+    for (auto i : perDeviceImplementation) {
         i.second->setAutoPipelineMode(enabled);
     }
 }
 
 void SwappyVk::SetMaxAutoSwapDuration(std::chrono::nanoseconds maxDuration) {
-    for (auto i : perSwapchainImplementation) {
+    for (auto i : perDeviceImplementation) {
         i.second->setMaxAutoSwapDuration(maxDuration);
     }
 }
 
 void SwappyVk::SetFenceTimeout(std::chrono::nanoseconds t) {
-    for (auto i : perSwapchainImplementation) {
+    for (auto i : perDeviceImplementation) {
         i.second->setFenceTimeout(t);
     }
 }
 
 std::chrono::nanoseconds SwappyVk::GetFenceTimeout() const {
-    auto it = perSwapchainImplementation.begin();
-    if (it != perSwapchainImplementation.end()) {
+    auto it = perDeviceImplementation.begin();
+    if (it != perDeviceImplementation.end()) {
         return it->second->getFenceTimeout();
     }
     return std::chrono::nanoseconds(0);
@@ -327,7 +343,7 @@ std::chrono::nanoseconds SwappyVk::GetFenceTimeout() const {
 std::chrono::nanoseconds SwappyVk::GetSwapInterval(VkSwapchainKHR swapchain) {
     auto it = perSwapchainImplementation.find(swapchain);
     if (it != perSwapchainImplementation.end())
-        return it->second->getSwapInterval();
+        return it->second->getSwapInterval(swapchain);
     return std::chrono::nanoseconds(0);
 }
 
@@ -336,7 +352,7 @@ void SwappyVk::addTracer(const SwappyTracer* t) {
         std::lock_guard<std::mutex> lock(tracer_list_lock);
         tracer_list.push_back(*t);
 
-        for (const auto& i : perSwapchainImplementation) {
+        for (const auto& i : perDeviceImplementation) {
             i.second->addTracer(t);
         }
     }
@@ -347,7 +363,7 @@ void SwappyVk::removeTracer(const SwappyTracer* t) {
         std::lock_guard<std::mutex> lock(tracer_list_lock);
         tracer_list.remove(*t);
 
-        for (const auto& i : perSwapchainImplementation) {
+        for (const auto& i : perDeviceImplementation) {
             i.second->removeTracer(t);
         }
     }
@@ -360,6 +376,13 @@ int SwappyVk::GetSupportedRefreshPeriodsNS(uint64_t* out_refreshrates,
         .getSupportedRefreshPeriodsNS(out_refreshrates, allocated_entries);
 }
 
+bool SwappyVk::GetRefreshRatePlan(VkSwapchainKHR swapchain,
+                                  SwappyRefreshRatePlan* out_plan) {
+    auto it = perSwapchainImplementation.find(swapchain);
+    if (it == perSwapchainImplementation.end()) return false;
+    return it->second->getRefreshRatePlan(out_plan);
+}
+
 bool SwappyVk::IsEnabled(VkSwapchainKHR swapchain, bool* isEnabled) {
     auto& pImplementation = perSwapchainImplementation[swapchain];
     if (!pImplementation || !isEnabled) return false;
@@ -370,25 +393,26 @@ bool SwappyVk::IsEnabled(VkSwapchainKHR swapchain, bool* isEnabled) {
 void SwappyVk::enableStats(VkSwapchainKHR swapchain, bool enabled) {
     auto it = perSwapchainImplementation.find(swapchain);
     if (it != perSwapchainImplementation.end())
-        it->second->enableStats(enabled);
+        it->second->enableStats(swapchain, enabled);
 }
 
 void SwappyVk::getStats(VkSwapchainKHR swapchain, SwappyStats* swappyStats) {
     auto it = perSwapchainImplementation.find(swapchain);
     if (it != perSwapchainImplementation.end())
-        it->second->getStats(swappyStats);
+        it->second->getStats(swapchain, swappyStats);
 }
 
 void SwappyVk::recordFrameStart(VkQueue queue, VkSwapchainKHR swapchain,
                                 uint32_t image) {
     auto it = perSwapchainImplementation.find(swapchain);
     if (it != perSwapchainImplementation.end())
-        it->second->recordFrameStart(queue, image);
+        it->second->recordFrameStart(queue, swapchain, image);
 }
 
 void SwappyVk::clearStats(VkSwapchainKHR swapchain) {
     auto it = perSwapchainImplementation.find(swapchain);
-    if (it != perSwapchainImplementation.end()) it->second->clearStats();
+    if (it != perSwapchainImplementation.end())
+        it->second->clearStats(swapchain);
 }
 
 void SwappyVk::resetFramePacing(VkSwapchainKHR swapchain) {
@@ -408,4 +432,10 @@ void SwappyVk::enableBlockingWait(VkSwapchainKHR swapchain, bool enable) {
         it->second->enableBlockingWait(enable);
 }
 
+void SwappyVk::enableLowLatencyMode(VkSwapchainKHR swapchain, bool enable) {
+    auto it = perSwapchainImplementation.find(swapchain);
+    if (it != perSwapchainImplementation.end())
+        it->second->enableLowLatencyMode(enable);
+}
+
 }  // namespace swappy
@@ -82,6 +82,8 @@ class SwappyVk {
     int GetSupportedRefreshPeriodsNS(uint64_t* out_refreshrates,
                                      int allocated_entries,
                                      VkSwapchainKHR swapchain);
+    bool GetRefreshRatePlan(VkSwapchainKHR swapchain,
+                            SwappyRefreshRatePlan* out_plan);
 
     void addTracer(const SwappyTracer* t);
     void removeTracer(const SwappyTracer* t);
@@ -101,9 +103,13 @@ class SwappyVk {
     void resetFramePacing(VkSwapchainKHR swapchain);
     void enableFramePacing(VkSwapchainKHR swapchain, bool enable);
     void enableBlockingWait(VkSwapchainKHR swapchain, bool enable);
+    void enableLowLatencyMode(VkSwapchainKHR swapchain, bool enable);
 
    private:
     std::map<VkPhysicalDevice, bool> doesPhysicalDeviceHaveGoogleDisplayTiming;
+    // All the swapchains of a device share its implementation, and so its
+    // Choreographer and fence-wait threads.
+    std::map<VkDevice, std::shared_ptr<SwappyVkBase>> perDeviceImplementation;
     std::map<VkSwapchainKHR, std::shared_ptr<SwappyVkBase>>
         perSwapchainImplementation;
 
@@ -106,6 +106,24 @@ SwappyVkBase::SwappyVkBase(JNIEnv* env, jobject jactivity,
         !gamesdk::GetSystemPropAsBool(SWAPPY_SYSTEM_PROP_KEY_DISABLE, false);
 }
 
+// Used for testing
+SwappyVkBase::SwappyVkBase(const SwappyCommonSettings& settings,
+                           VkPhysicalDevice physicalDevice, VkDevice device,
+                           const SwappyVkFunctionProvider* pFunctionProvider)
+    : mCommonBase(settings),
+      mPhysicalDevice(physicalDevice),
+      mDevice(device),
+      mpFunctionProvider(pFunctionProvider),
+      mInitialized(false),
+      mEnabled(true) {
+    mpfnGetDeviceProcAddr = reinterpret_cast<PFN_vkGetDeviceProcAddr>(
+        mpFunctionProvider->getProcAddr("vkGetDeviceProcAddr"));
+    mpfnQueuePresentKHR = reinterpret_cast<PFN_vkQueuePresentKHR>(
+        mpfnGetDeviceProcAddr(mDevice, "vkQueuePresentKHR"));
+
+    initGoogExtension();
+}
+
 void SwappyVkBase::initGoogExtension() {
 #if (not defined ANDROID_NDK_VERSION) || ANDROID_NDK_VERSION >= 15
     mpfnGetRefreshCycleDurationGOOGLE =
@@ -120,129 +138,242 @@ void SwappyVkBase::initGoogExtension() {
 
 SwappyVkBase::~SwappyVkBase() { destroyVkSyncObjects(); }
 
-void SwappyVkBase::doSetWindow(ANativeWindow* window) {
+void SwappyVkBase::doSetWindow(VkSwapchainKHR swapchain,
+                               ANativeWindow* window) {
+    {
+        std::lock_guard<std::mutex> lock(mSwapchainsMutex);
+        // Only the primary output votes for a display frame rate.
+        if (!isPrimarySwapchain(swapchain)) return;
+    }
     mCommonBase.setANativeWindow(window);
 }
 
 void SwappyVkBase::doSetSwapInterval(VkSwapchainKHR swapchain,
                                      uint64_t swapNs) {
+    {
+        std::lock_guard<std::mutex> lock(mSwapchainsMutex);
+        if (!isPrimarySwapchain(swapchain)) {
+            mSwapchains[swapchain].swapDuration =
+                std::chrono::nanoseconds(swapNs);
+            return;
+        }
+    }
     Settings::getInstance()->setSwapDuration(swapNs);
 }
 
+void SwappyVkBase::addSwapchain(VkSwapchainKHR swapchain) {
+    const auto swapDuration = mCommonBase.getSwapDuration();
+    std::lock_guard<std::mutex> lock(mSwapchainsMutex);
+    if (mSwapchains.find(swapchain) != mSwapchains.end()) return;
+
+    mSwapchains[swapchain] = {swapDuration};
+    if (mPrimarySwapchain == VK_NULL_HANDLE) {
+        mPrimarySwapchain = swapchain;
+    }
+}
+
+size_t SwappyVkBase::removeSwapchain(VkSwapchainKHR swapchain) {
+    {
+        std::lock_guard<std::mutex> lock(mFenceThread.lock);
+        mLastFenceTimes.erase(swapchain);
+        retireVkSyncObjectsLocked(swapchain);
+    }
+
+    uint64_t primarySwapNs;
+    size_t remaining;
+    {
+        std::lock_guard<std::mutex> lock(mSwapchainsMutex);
+        mSwapchains.erase(swapchain);
+        remaining = mSwapchains.size();
+        if (mPrimarySwapchain != swapchain) return remaining;
+
+        // Promote the next swapchain, keeping its swap interval.
+        if (mSwapchains.empty()) {
+            mPrimarySwapchain = VK_NULL_HANDLE;
+            return 0;
+        }
+        mPrimarySwapchain = mSwapchains.begin()->first;
+        primarySwapNs = mSwapchains.begin()->second.swapDuration.count();
+    }
+    Settings::getInstance()->setSwapDuration(primarySwapNs);
+    return remaining;
+}
+
+bool SwappyVkBase::isPrimarySwapchain(VkSwapchainKHR swapchain) {
+    // Swapchains that were never added are paced as the primary one.
+    return swapchain == mPrimarySwapchain ||
+           mSwapchains.find(swapchain) == mSwapchains.end();
+}
+
 VkResult SwappyVkBase::initializeVkSyncObjects(VkQueue queue,
+                                               VkSwapchainKHR swapchain,
                                                uint32_t queueFamilyIndex) {
-    if (mCommandPool.find(queue) != mCommandPool.end()) {
+    std::lock_guard<std::mutex> lock(mFenceThread.lock);
+    const SyncKey key = {queue, swapchain};
+    if (mFreeSyncPool.find(key) != mFreeSyncPool.end() &&
+        mRetiredSyncs.find(key) == mRetiredSyncs.end()) {
         return VK_SUCCESS;
     }
 
-    VkSync sync;
-
-    const VkCommandPoolCreateInfo cmd_pool_info = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .queueFamilyIndex = queueFamilyIndex,
-    };
-
-    VkResult res = vkCreateCommandPool(mDevice, &cmd_pool_info, NULL,
-                                       &mCommandPool[queue]);
+    VkResult res = createVkSyncObjectsLocked(key, queueFamilyIndex);
     if (res) {
-        SWAPPY_LOGE("vkCreateCommandPool failed %d", res);
         return res;
     }
-    const VkCommandBufferAllocateInfo present_cmd_info = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .pNext = NULL,
-        .commandPool = mCommandPool[queue],
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = 1,
-    };
 
-    for (int i = 0; i < MAX_PENDING_FENCES; i++) {
-        VkFenceCreateInfo fence_ci = {
-            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-            .pNext = NULL,
-            .flags = VK_FENCE_CREATE_SIGNALED_BIT};
-        res = vkCreateFence(mDevice, &fence_ci, NULL, &sync.fence);
-        if (res) {
-            SWAPPY_LOGE("failed to create fence: %d", res);
-            return res;
-        }
+    // Start the thread that waits for the fences of all the queues
+    if (!mFenceThread.thread.joinable()) {
+        mFenceThread.thread =
+            Thread([this]() { waitForFenceThreadMain(); });
+    }
+    return VK_SUCCESS;
+}
 
-        VkSemaphoreCreateInfo semaphore_ci = {
-            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+VkResult SwappyVkBase::createVkSyncObjectsLocked(const SyncKey& key,
+                                                 uint32_t queueFamilyIndex) {
+    const VkQueue queue = key.first;
+    if (mCommandPool.find(queue) == mCommandPool.end()) {
+        const VkCommandPoolCreateInfo cmd_pool_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
             .pNext = NULL,
-            .flags = 0};
-        res = vkCreateSemaphore(mDevice, &semaphore_ci, NULL, &sync.semaphore);
-        if (res) {
-            SWAPPY_LOGE("failed to create semaphore: %d", res);
-            return res;
-        }
+            .flags = 0,
+            .queueFamilyIndex = queueFamilyIndex,
+        };
 
-        res =
-            vkAllocateCommandBuffers(mDevice, &present_cmd_info, &sync.command);
+        VkCommandPool commandPool;
+        VkResult res =
+            vkCreateCommandPool(mDevice, &cmd_pool_info, NULL, &commandPool);
         if (res) {
-            SWAPPY_LOGE("vkAllocateCommandBuffers failed %d", res);
+            SWAPPY_LOGE("vkCreateCommandPool failed %d", res);
             return res;
         }
+        mCommandPool[queue] = commandPool;
+    }
 
-        const VkCommandBufferBeginInfo cmd_buf_info = {
-            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-            .pNext = NULL,
-            .flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT,
-            .pInheritanceInfo = NULL,
-        };
-        res = vkBeginCommandBuffer(sync.command, &cmd_buf_info);
-        if (res) {
-            SWAPPY_LOGE("vkAllocateCommandBuffers failed %d", res);
-            return res;
+    // A swapchain that was removed and added again may still have fences in
+    // flight, which it takes back.
+    mRetiredSyncs.erase(key);
+    std::list<VkSync>& freeSyncs = mFreeSyncPool[key];
+    std::list<VkSync>& spareSyncs = mSpareSyncs[queue];
+    size_t count = freeSyncs.size() + mWaitingSyncs[key].size() +
+                   mSignaledSyncs[key].size();
+    for (; count < MAX_PENDING_FENCES; count++) {
+        if (!spareSyncs.empty()) {
+            freeSyncs.splice(freeSyncs.end(), spareSyncs, spareSyncs.begin());
+            continue;
         }
-
-        VkEventCreateInfo event_info = {
-            .sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO,
-            .pNext = NULL,
-            .flags = 0,
-        };
-        res = vkCreateEvent(mDevice, &event_info, NULL, &sync.event);
+        VkSync sync;
+        VkResult res = createVkSync(mCommandPool[queue], &sync);
         if (res) {
-            SWAPPY_LOGE("vkCreateEvent failed %d", res);
             return res;
         }
+        freeSyncs.push_back(sync);
+    }
+    return VK_SUCCESS;
+}
 
-        vkCmdSetEvent(sync.command, sync.event,
-                      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+VkResult SwappyVkBase::createVkSync(VkCommandPool commandPool, VkSync* sync) {
+    const VkCommandBufferAllocateInfo present_cmd_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = NULL,
+        .commandPool = commandPool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+    };
 
-        res = vkEndCommandBuffer(sync.command);
-        if (res) {
-            SWAPPY_LOGE("vkCreateEvent failed %d", res);
-            return res;
-        }
+    VkFenceCreateInfo fence_ci = {.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+                                  .pNext = NULL,
+                                  .flags = VK_FENCE_CREATE_SIGNALED_BIT};
+    VkResult res = vkCreateFence(mDevice, &fence_ci, NULL, &sync->fence);
+    if (res) {
+        SWAPPY_LOGE("failed to create fence: %d", res);
+        return res;
+    }
 
-        mFreeSyncPool[queue].push_back(sync);
+    VkSemaphoreCreateInfo semaphore_ci = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0};
+    res = vkCreateSemaphore(mDevice, &semaphore_ci, NULL, &sync->semaphore);
+    if (res) {
+        SWAPPY_LOGE("failed to create semaphore: %d", res);
+        return res;
     }
 
-    // Create a thread that will wait for the fences
-    auto emplaceResult =
-        mThreads.emplace(queue, std::make_unique<ThreadContext>(queue));
-    auto& threadContext = emplaceResult.first->second;
+    res = vkAllocateCommandBuffers(mDevice, &present_cmd_info, &sync->command);
+    if (res) {
+        SWAPPY_LOGE("vkAllocateCommandBuffers failed %d", res);
+        return res;
+    }
 
-    // Start the thread
-    std::lock_guard<std::mutex> lock(threadContext->lock);
-    threadContext->thread =
-        Thread([&]() { waitForFenceThreadMain(*threadContext); });
+    const VkCommandBufferBeginInfo cmd_buf_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT,
+        .pInheritanceInfo = NULL,
+    };
+    res = vkBeginCommandBuffer(sync->command, &cmd_buf_info);
+    if (res) {
+        SWAPPY_LOGE("vkAllocateCommandBuffers failed %d", res);
+        return res;
+    }
+
+    VkEventCreateInfo event_info = {
+        .sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+    };
+    res = vkCreateEvent(mDevice, &event_info, NULL, &sync->event);
+    if (res) {
+        SWAPPY_LOGE("vkCreateEvent failed %d", res);
+        return res;
+    }
+
+    vkCmdSetEvent(sync->command, sync->event,
+                  VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+    res = vkEndCommandBuffer(sync->command);
+    if (res) {
+        SWAPPY_LOGE("vkCreateEvent failed %d", res);
+        return res;
+    }
     return VK_SUCCESS;
 }
 
-void SwappyVkBase::destroyVkSyncObjects() {
-    // Stop all waiters threads
-    for (auto it = mThreads.begin(); it != mThreads.end(); it++) {
-        {
-            std::lock_guard<std::mutex> lock(it->second->lock);
-            it->second->running = false;
-            it->second->condition.notify_one();
+void SwappyVkBase::retireVkSyncObjectsLocked(VkSwapchainKHR swapchain) {
+    for (auto it = mFreeSyncPool.begin(); it != mFreeSyncPool.end();) {
+        const SyncKey key = it->first;
+        if (key.second != swapchain) {
+            ++it;
+            continue;
+        }
+
+        std::list<VkSync>& spareSyncs = mSpareSyncs[key.first];
+        spareSyncs.splice(spareSyncs.end(), it->second);
+        spareSyncs.splice(spareSyncs.end(), mSignaledSyncs[key]);
+        mSignaledSyncs.erase(key);
+        if (mWaitingSyncs[key].empty()) {
+            mWaitingSyncs.erase(key);
+            it = mFreeSyncPool.erase(it);
+        } else {
+            // The fence thread moves them to the spares once signaled.
+            mRetiredSyncs.insert(key);
+            ++it;
         }
-        it->second->thread.join();
     }
+}
+
+void SwappyVkBase::destroyVkSyncObjects() {
+    // Stop the waiter thread
+    {
+        std::lock_guard<std::mutex> lock(mFenceThread.lock);
+        mFenceThread.running = false;
+        mFenceThread.condition.notify_one();
+    }
+    if (mFenceThread.thread.joinable()) {
+        mFenceThread.thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mFenceThread.lock);
 
     // Wait for all unsignaled fences to get signlaed
     for (auto it = mWaitingSyncs.begin(); it != mWaitingSyncs.end(); it++) {
@@ -256,14 +387,18 @@ void SwappyVkBase::destroyVkSyncObjects() {
         }
     }
 
-    // Move all signaled fences to the free pool
+    // Move all signaled fences to the spare pool of their queue
     for (auto it = mSignaledSyncs.begin(); it != mSignaledSyncs.end(); it++) {
-        auto queue = it->first;
-        reclaimSignaledFences(queue);
+        mSpareSyncs[it->first.first].splice(mSpareSyncs[it->first.first].end(),
+                                            it->second);
+    }
+    for (auto it = mFreeSyncPool.begin(); it != mFreeSyncPool.end(); it++) {
+        mSpareSyncs[it->first.first].splice(mSpareSyncs[it->first.first].end(),
+                                            it->second);
     }
 
     // Free all sync objects
-    for (auto it = mFreeSyncPool.begin(); it != mFreeSyncPool.end(); it++) {
+    for (auto it = mSpareSyncs.begin(); it != mSpareSyncs.end(); it++) {
         auto syncList = it->second;
         while (syncList.size() > 0) {
             VkSync sync = syncList.front();
@@ -284,44 +419,69 @@ void SwappyVkBase::destroyVkSyncObjects() {
     }
 }
 
-void SwappyVkBase::reclaimSignaledFences(VkQueue queue) {
-    std::lock_guard<std::mutex> lock(mThreads[queue]->lock);
-    while (!mSignaledSyncs[queue].empty()) {
-        VkSync sync = mSignaledSyncs[queue].front();
-        mSignaledSyncs[queue].pop_front();
-        mFreeSyncPool[queue].push_back(sync);
+void SwappyVkBase::reclaimSignaledFences(const SyncKey& key) {
+    std::lock_guard<std::mutex> lock(mFenceThread.lock);
+    while (!mSignaledSyncs[key].empty()) {
+        VkSync sync = mSignaledSyncs[key].front();
+        mSignaledSyncs[key].pop_front();
+        mFreeSyncPool[key].push_back(sync);
     }
 }
 
-bool SwappyVkBase::lastFrameIsCompleted(VkQueue queue) {
+bool SwappyVkBase::lastFrameIsCompleted(const SyncKey& key) {
     auto pipelineMode = mCommonBase.getCurrentPipelineMode();
-    std::lock_guard<std::mutex> lock(mThreads[queue]->lock);
+    std::lock_guard<std::mutex> lock(mFenceThread.lock);
     if (pipelineMode == SwappyCommon::PipelineMode::On) {
         // We are in pipeline mode so we need to check the fence of frame N-1
-        return mWaitingSyncs[queue].size() < 2;
+        return mWaitingSyncs[key].size() < 2;
     }
 
     // We are not in pipeline mode so we need to check the fence the current
     // frame. i.e. there are not unsignaled frames
-    return mWaitingSyncs[queue].empty();
+    return mWaitingSyncs[key].empty();
+}
+
+SwappyCommon::SwapHandlers SwappyVkBase::makeSwapHandlers(
+    SwapContext* context) {
+    return {
+        .lastFrameIsComplete =
+            [](void* userData) {
+                auto context = static_cast<SwapContext*>(userData);
+                return context->swappy->lastFrameIsCompleted(
+                    {context->queue, context->swapchain});
+            },
+        .getPrevFrameGpuTime =
+            [](void* userData) {
+                auto context = static_cast<SwapContext*>(userData);
+                return context->swappy->getLastFenceTime(context->swapchain);
+            },
+        .userData = context,
+    };
 }
 
 VkResult SwappyVkBase::injectFence(VkQueue queue,
                                    const VkPresentInfoKHR* pPresentInfo,
                                    VkSemaphore* pSemaphore) {
-    reclaimSignaledFences(queue);
-
-    // If we cross the swap interval threshold, we don't pace at all.
-    // In this case we might not have a free fence, so just don't use the fence.
-    if (mFreeSyncPool[queue].empty() ||
-        vkGetFenceStatus(mDevice, mFreeSyncPool[queue].front().fence) !=
-            VK_SUCCESS) {
-        *pSemaphore = VK_NULL_HANDLE;
-        return VK_SUCCESS;
-    }
+    // Pacing, and so the GPU time, follows the first swapchain of the present.
+    const SyncKey key = {queue, pPresentInfo->pSwapchains[0]};
+    reclaimSignaledFences(key);
 
-    VkSync sync = mFreeSyncPool[queue].front();
-    mFreeSyncPool[queue].pop_front();
+    VkSync sync;
+    {
+        std::lock_guard<std::mutex> lock(mFenceThread.lock);
+        // If we cross the swap interval threshold, we don't pace at all.
+        // In this case we might not have a free fence, so just don't use the
+        // fence.
+        if (mFreeSyncPool[key].empty() ||
+            vkGetFenceStatus(mDevice, mFreeSyncPool[key].front().fence) !=
+                VK_SUCCESS) {
+            *pSemaphore = VK_NULL_HANDLE;
+            return VK_SUCCESS;
+        }
+
+        sync = mFreeSyncPool[key].front();
+        mFreeSyncPool[key].pop_front();
+    }
 
     vkResetFences(mDevice, 1, &sync.fence);
 
@@ -340,14 +500,62 @@ VkResult SwappyVkBase::injectFence(VkQueue queue,
     VkResult res = vkQueueSubmit(queue, 1, &submit_info, sync.fence);
     *pSemaphore = sync.semaphore;
 
-    std::lock_guard<std::mutex> lock(mThreads[queue]->lock);
-    mWaitingSyncs[queue].push_back(sync);
-    mThreads[queue]->hasPendingWork = true;
-    mThreads[queue]->condition.notify_all();
+    std::lock_guard<std::mutex> lock(mFenceThread.lock);
+    mWaitingSyncs[key].push_back(sync);
+    mFenceThread.pendingFences.push_back({queue, key.second});
+    mFenceThread.condition.notify_all();
 
     return res;
 }
 
+uint64_t SwappyVkBase::onPreSwap(VkSwapchainKHR swapchain,
+                                 const SwappyCommon::SwapHandlers& handlers) {
+    bool primary;
+    SwapchainPacing swapchainPacing;
+    {
+        std::lock_guard<std::mutex> lock(mSwapchainsMutex);
+        primary = isPrimarySwapchain(swapchain);
+        if (!primary) swapchainPacing = mSwapchains[swapchain];
+    }
+
+    if (primary) {
+        mCommonBase.onPreSwap(handlers);
+        if (!mCommonBase.needToSetPresentationTime()) return 0;
+        return mCommonBase.getPresentationTime().time_since_epoch().count();
+    }
+
+    // Wait for the swap interval of this swapchain on the shared vsync
+    // timeline.
+    const auto refreshPeriod = mCommonBase.getRefreshPeriod();
+    const int swapInterval = SwappyCommon::calculateSwapInterval(
+        swapchainPacing.swapDuration, refreshPeriod);
+    const bool pacing = mCommonBase.isFramePacingEnabled();
+    if (pacing) {
+        mCommonBase.waitUntilFrame(swapchainPacing.lastPresentFrame +
+                                   swapInterval);
+    }
+
+    std::chrono::steady_clock::time_point frameTimestamp;
+    const int32_t currentFrame = mCommonBase.getCurrentFrame(&frameTimestamp);
+    {
+        std::lock_guard<std::mutex> lock(mSwapchainsMutex);
+        auto it = mSwapchains.find(swapchain);
+        if (it != mSwapchains.end()) {
+            it->second.lastPresentFrame = currentFrame;
+        }
+    }
+    return pacing ? frameTimestamp.time_since_epoch().count() : 0;
+}
+
+void SwappyVkBase::onPostSwap(VkSwapchainKHR swapchain,
+                              const SwappyCommon::SwapHandlers& handlers) {
+    {
+        std::lock_guard<std::mutex> lock(mSwapchainsMutex);
+        if (!isPrimarySwapchain(swapchain)) return;
+    }
+    mCommonBase.onPostSwap(handlers);
+}
+
 void SwappyVkBase::setAutoSwapInterval(bool enabled) {
     mCommonBase.setAutoSwapInterval(enabled);
 }
@@ -360,56 +568,66 @@ void SwappyVkBase::setAutoPipelineMode(bool enabled) {
     mCommonBase.setAutoPipelineMode(enabled);
 }
 
-void SwappyVkBase::waitForFenceThreadMain(ThreadContext& thread) {
+void SwappyVkBase::waitForFenceThreadMain() {
     while (true) {
-        bool waitingSyncsEmpty;
-        {
-            std::lock_guard<std::mutex> lock(thread.lock);
+        PendingFence pending;
+        VkSync sync;
+        {  // Get the oldest sync object, from any queue, with a lock
+            std::lock_guard<std::mutex> lock(mFenceThread.lock);
             // Wait for new fence object
-            thread.condition.wait(thread.lock, [&]() REQUIRES(thread.lock) {
-                return thread.hasPendingWork || !thread.running;
-            });
+            mFenceThread.condition.wait(
+                mFenceThread.lock, [&]() REQUIRES(mFenceThread.lock) {
+                    return !mFenceThread.pendingFences.empty() ||
+                           !mFenceThread.running;
+                });
 
-            thread.hasPendingWork = false;
-
-            if (!thread.running) {
+            if (!mFenceThread.running) {
                 break;
             }
 
-            waitingSyncsEmpty = mWaitingSyncs[thread.queue].empty();
+            pending = mFenceThread.pendingFences.front();
+            sync = mWaitingSyncs[{pending.queue, pending.swapchain}].front();
         }
 
-        while (!waitingSyncsEmpty) {
-            VkSync sync;
-            {  // Get the sync object with a lock
-                std::lock_guard<std::mutex> lock(thread.lock);
-                sync = mWaitingSyncs[thread.queue].front();
-            }
-
-            gamesdk::ScopedTrace tracer("Swappy: GPU frame time");
-            const auto startTime = std::chrono::steady_clock::now();
-            VkResult result =
-                vkWaitForFences(mDevice, 1, &sync.fence, VK_TRUE,
-                                mCommonBase.getFenceTimeout().count());
-            if (result) {
-                SWAPPY_LOGW_ONCE("Failed to wait for fence %d", result);
-            }
-            mLastFenceTime = std::chrono::steady_clock::now() - startTime;
-
-            // Move the sync object to the signaled list
-            {
-                std::lock_guard<std::mutex> lock(thread.lock);
-                mWaitingSyncs[thread.queue].pop_front();
+        gamesdk::ScopedTrace tracer("Swappy: GPU frame time");
+        const auto startTime = std::chrono::steady_clock::now();
+        VkResult result =
+            vkWaitForFences(mDevice, 1, &sync.fence, VK_TRUE,
+                            mCommonBase.getFenceTimeout().count());
+        if (result) {
+            SWAPPY_LOGW_ONCE("Failed to wait for fence %d", result);
+        }
+        const auto fenceTime = std::chrono::steady_clock::now() - startTime;
 
-                mSignaledSyncs[thread.queue].push_back(sync);
-                waitingSyncsEmpty = mWaitingSyncs[thread.queue].empty();
+        // Move the sync object to the signaled list
+        {
+            std::lock_guard<std::mutex> lock(mFenceThread.lock);
+            const SyncKey key = {pending.queue, pending.swapchain};
+            mFenceThread.pendingFences.pop_front();
+            mWaitingSyncs[key].pop_front();
+
+            if (mRetiredSyncs.find(key) == mRetiredSyncs.end()) {
+                mSignaledSyncs[key].push_back(sync);
+                mLastFenceTimes[pending.swapchain] = fenceTime;
+            } else {
+                // The swapchain was removed while the fence was in flight.
+                mSpareSyncs[pending.queue].push_back(sync);
+                if (mWaitingSyncs[key].empty()) {
+                    mWaitingSyncs.erase(key);
+                    mFreeSyncPool.erase(key);
+                    mRetiredSyncs.erase(key);
+                }
             }
         }
     }
 }
 
-std::chrono::nanoseconds SwappyVkBase::getLastFenceTime(VkQueue queue) {
-    return mLastFenceTime;
+std::chrono::nanoseconds SwappyVkBase::getLastFenceTime(
+    VkSwapchainKHR swapchain) {
+    std::lock_guard<std::mutex> lock(mFenceThread.lock);
+    auto it = mLastFenceTimes.find(swapchain);
+    return it != mLastFenceTimes.end() ? it->second
+                                       : std::chrono::nanoseconds(0);
 }
 
 void SwappyVkBase::setFenceTimeout(std::chrono::nanoseconds duration) {
@@ -420,7 +638,14 @@ std::chrono::nanoseconds SwappyVkBase::getFenceTimeout() const {
     return mCommonBase.getFenceTimeout();
 }
 
-std::chrono::nanoseconds SwappyVkBase::getSwapInterval() {
+std::chrono::nanoseconds SwappyVkBase::getSwapInterval(
+    VkSwapchainKHR swapchain) {
+    {
+        std::lock_guard<std::mutex> lock(mSwapchainsMutex);
+        if (!isPrimarySwapchain(swapchain)) {
+            return mSwapchains[swapchain].swapDuration;
+        }
+    }
     return mCommonBase.getSwapDuration();
 }
 
@@ -448,4 +673,8 @@ void SwappyVkBase::enableBlockingWait(bool enable) {
     mCommonBase.enableBlockingWait(enable);
 }
 
+void SwappyVkBase::enableLowLatencyMode(bool enable) {
+    mCommonBase.enableLowLatencyMode(enable);
+}
+
 }  // namespace swappy
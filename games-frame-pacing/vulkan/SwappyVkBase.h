@@ -26,6 +26,13 @@
  * It is expected that one concrete class will be instantiated per VkDevice, and
  * that all VkSwapchainKHR's for a given VkDevice will share the same instance.
  *
+ * The swapchains of a device share one Choreographer/vsync source and one
+ * fence-wait worker, but each has its own fences on each queue it is presented
+ * on. The first swapchain added is the primary output: it is
+ * paced by @mCommonBase, with auto swap interval and pipelining. The others
+ * (e.g. an external display) keep their own swap interval and are paced on the
+ * same vsync timeline.
+ *
  * Base class members are used by the derived classes to unify the behavior
  * across implementations:
  *  @mThread - Thread used for getting Choreographer events.
@@ -55,6 +62,8 @@
 #include <list>
 #include <map>
 #include <mutex>
+#include <set>
+#include <utility>
 
 #include "ChoreographerShim.h"
 #include "Settings.h"
@@ -119,9 +128,13 @@ class SwappyVkBase {
     virtual VkResult doQueuePresent(VkQueue queue, uint32_t queueFamilyIndex,
                                     const VkPresentInfoKHR* pPresentInfo) = 0;
 
-    void doSetWindow(ANativeWindow* window);
+    void doSetWindow(VkSwapchainKHR swapchain, ANativeWindow* window);
     void doSetSwapInterval(VkSwapchainKHR swapchain, uint64_t swapNs);
 
+    void addSwapchain(VkSwapchainKHR swapchain);
+    // Returns the number of swapchains left.
+    virtual size_t removeSwapchain(VkSwapchainKHR swapchain);
+
     VkResult injectFence(VkQueue queue, const VkPresentInfoKHR* pPresentInfo,
                          VkSemaphore* pSemaphore);
 
@@ -134,7 +147,7 @@ class SwappyVkBase {
 
     void setFenceTimeout(std::chrono::nanoseconds duration);
     std::chrono::nanoseconds getFenceTimeout() const;
-    std::chrono::nanoseconds getSwapInterval();
+    std::chrono::nanoseconds getSwapInterval(VkSwapchainKHR swapchain);
 
     void addTracer(const SwappyTracer* tracer);
     void removeTracer(const SwappyTracer* tracer);
@@ -143,17 +156,28 @@ class SwappyVkBase {
 
     int getSupportedRefreshPeriodsNS(uint64_t* out_refreshrates,
                                      int allocated_entries);
+    bool getRefreshRatePlan(SwappyRefreshRatePlan* out_plan) {
+        return mCommonBase.getRefreshRatePlan(out_plan);
+    }
 
-    virtual void enableStats(bool enabled) = 0;
-    virtual void getStats(SwappyStats* swappyStats) = 0;
-    virtual void recordFrameStart(VkQueue queue, uint32_t image) = 0;
-    virtual void clearStats() = 0;
+    virtual void enableStats(VkSwapchainKHR swapchain, bool enabled) = 0;
+    virtual void getStats(VkSwapchainKHR swapchain,
+                          SwappyStats* swappyStats) = 0;
+    virtual void recordFrameStart(VkQueue queue, VkSwapchainKHR swapchain,
+                                  uint32_t image) = 0;
+    virtual void clearStats(VkSwapchainKHR swapchain) = 0;
 
     void resetFramePacing();
     void enableFramePacing(bool enable);
     void enableBlockingWait(bool enable);
+    void enableLowLatencyMode(bool enable);
 
    protected:
+    // Used for testing
+    SwappyVkBase(const SwappyCommonSettings& settings,
+                 VkPhysicalDevice physicalDevice, VkDevice device,
+                 const SwappyVkFunctionProvider* pFunctionProvider);
+
     struct VkSync {
         VkFence fence;
         VkSemaphore semaphore;
@@ -161,15 +185,31 @@ class SwappyVkBase {
         VkEvent event;
     };
 
-    struct ThreadContext {
-        ThreadContext(VkQueue queue) : queue(queue) {}
+    // Sync objects are kept per queue and swapchain, so that swapchains
+    // presented on the same queue (e.g. the main and an external display)
+    // neither throttle each other nor run out of fences.
+    using SyncKey = std::pair<VkQueue, VkSwapchainKHR>;
+
+    // A sync object in mWaitingSyncs, and the swapchain it was injected for.
+    struct PendingFence {
+        VkQueue queue;
+        VkSwapchainKHR swapchain;
+    };
 
+    // Waits for the fences of all the queues of the device.
+    struct ThreadContext {
         Thread thread;
         bool running GUARDED_BY(lock) = true;
-        bool hasPendingWork GUARDED_BY(lock);
         std::mutex lock;
         std::condition_variable_any condition;
-        VkQueue queue GUARDED_BY(lock);
+        // The sync objects in mWaitingSyncs, in submission order.
+        std::list<PendingFence> pendingFences GUARDED_BY(lock);
+    };
+
+    // Pacing state of a swapchain other than the primary one.
+    struct SwapchainPacing {
+        std::chrono::nanoseconds swapDuration;
+        int32_t lastPresentFrame = 0;
     };
 
     SwappyCommon mCommonBase;
@@ -190,29 +230,76 @@ class SwappyVkBase {
     PFN_vkGetPastPresentationTimingGOOGLE mpfnGetPastPresentationTimingGOOGLE =
         nullptr;
 #endif
+    // The sync objects of all the queues are guarded by the lock of the fence
+    // thread, so that swapchains can be presented from different threads.
+    ThreadContext mFenceThread;
+
     // Holds VKSync objects ready to be used
-    std::map<VkQueue, std::list<VkSync>> mFreeSyncPool;
+    std::map<SyncKey, std::list<VkSync>> mFreeSyncPool
+        GUARDED_BY(mFenceThread.lock);
 
     // Holds VKSync objects queued and but signaled yet
-    std::map<VkQueue, std::list<VkSync>> mWaitingSyncs;
+    std::map<SyncKey, std::list<VkSync>> mWaitingSyncs
+        GUARDED_BY(mFenceThread.lock);
 
     // Holds VKSync objects that were signaled
-    std::map<VkQueue, std::list<VkSync>> mSignaledSyncs;
+    std::map<SyncKey, std::list<VkSync>> mSignaledSyncs
+        GUARDED_BY(mFenceThread.lock);
+
+    // Sync objects of removed swapchains that still have fences in flight.
+    // They go to mSpareSyncs as they are signaled.
+    std::set<SyncKey> mRetiredSyncs GUARDED_BY(mFenceThread.lock);
 
-    std::map<VkQueue, VkCommandPool> mCommandPool;
-    std::map<VkQueue, std::unique_ptr<ThreadContext>> mThreads;
+    // Sync objects of removed swapchains, reused by the next swapchain
+    // presented on the same queue.
+    std::map<VkQueue, std::list<VkSync>> mSpareSyncs
+        GUARDED_BY(mFenceThread.lock);
+
+    std::map<VkQueue, VkCommandPool> mCommandPool GUARDED_BY(mFenceThread.lock);
+
+    // GPU time of the last frame of each swapchain
+    std::map<VkSwapchainKHR, std::chrono::nanoseconds> mLastFenceTimes
+        GUARDED_BY(mFenceThread.lock);
+
+    std::mutex mSwapchainsMutex;
+    VkSwapchainKHR mPrimarySwapchain GUARDED_BY(mSwapchainsMutex) =
+        VK_NULL_HANDLE;
+    std::map<VkSwapchainKHR, SwapchainPacing> mSwapchains
+        GUARDED_BY(mSwapchainsMutex);
 
     static constexpr int MAX_PENDING_FENCES = 2;
 
-    std::atomic<std::chrono::nanoseconds> mLastFenceTime = {};
+    // State passed to the SwappyCommon swap handlers.
+    struct SwapContext {
+        SwappyVkBase* swappy;
+        VkQueue queue;
+        VkSwapchainKHR swapchain;
+    };
+    static SwappyCommon::SwapHandlers makeSwapHandlers(SwapContext* context);
 
     void initGoogExtension();
-    VkResult initializeVkSyncObjects(VkQueue queue, uint32_t queueFamilyIndex);
+    VkResult initializeVkSyncObjects(VkQueue queue, VkSwapchainKHR swapchain,
+                                     uint32_t queueFamilyIndex);
+    VkResult createVkSyncObjectsLocked(const SyncKey& key,
+                                       uint32_t queueFamilyIndex)
+        REQUIRES(mFenceThread.lock);
+    VkResult createVkSync(VkCommandPool commandPool, VkSync* sync);
+    void retireVkSyncObjectsLocked(VkSwapchainKHR swapchain)
+        REQUIRES(mFenceThread.lock);
     void destroyVkSyncObjects();
-    void reclaimSignaledFences(VkQueue queue);
-    bool lastFrameIsCompleted(VkQueue queue);
-    std::chrono::nanoseconds getLastFenceTime(VkQueue queue);
-    void waitForFenceThreadMain(ThreadContext& thread);
+    void reclaimSignaledFences(const SyncKey& key);
+    bool lastFrameIsCompleted(const SyncKey& key);
+    std::chrono::nanoseconds getLastFenceTime(VkSwapchainKHR swapchain);
+    void waitForFenceThreadMain();
+
+    // Paces a present to swapchain and returns its desired presentation time,
+    // or 0 if there is none.
+    uint64_t onPreSwap(VkSwapchainKHR swapchain,
+                       const SwappyCommon::SwapHandlers& handlers);
+    void onPostSwap(VkSwapchainKHR swapchain,
+                    const SwappyCommon::SwapHandlers& handlers);
+    bool isPrimarySwapchain(VkSwapchainKHR swapchain)
+        REQUIRES(mSwapchainsMutex);
 };
 
 }  // namespace swappy
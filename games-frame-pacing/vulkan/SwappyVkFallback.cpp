@@ -27,6 +27,13 @@ SwappyVkFallback::SwappyVkFallback(JNIEnv* env, jobject jactivity,
                                    const SwappyVkFunctionProvider* provider)
     : SwappyVkBase(env, jactivity, physicalDevice, device, provider) {}
 
+// Used for testing
+SwappyVkFallback::SwappyVkFallback(const SwappyCommonSettings& settings,
+                                   VkPhysicalDevice physicalDevice,
+                                   VkDevice device,
+                                   const SwappyVkFunctionProvider* provider)
+    : SwappyVkBase(settings, physicalDevice, device, provider) {}
+
 bool SwappyVkFallback::doGetRefreshCycleDuration(VkSwapchainKHR swapchain,
                                                  uint64_t* pRefreshDuration) {
     if (!isEnabled()) {
@@ -55,17 +62,16 @@ VkResult SwappyVkFallback::doQueuePresent(
         return VK_ERROR_INITIALIZATION_FAILED;
     }
 
-    VkResult result = initializeVkSyncObjects(queue, queueFamilyIndex);
+    VkResult result = initializeVkSyncObjects(
+        queue, pPresentInfo->pSwapchains[0], queueFamilyIndex);
     if (result) {
         return result;
     }
 
-    const SwappyCommon::SwapHandlers handlers = {
-        .lastFrameIsComplete =
-            std::bind(&SwappyVkFallback::lastFrameIsCompleted, this, queue),
-        .getPrevFrameGpuTime =
-            std::bind(&SwappyVkFallback::getLastFenceTime, this, queue),
-    };
+    // Pacing follows the first swapchain of the present.
+    const VkSwapchainKHR swapchain = pPresentInfo->pSwapchains[0];
+    SwapContext context = {this, queue, swapchain};
+    const SwappyCommon::SwapHandlers handlers = makeSwapHandlers(&context);
 
     // Inject the fence first and wait for it in onPreSwap() as we don't want to
     // submit a frame before rendering is completed.
@@ -86,7 +92,7 @@ VkResult SwappyVkFallback::doQueuePresent(
         pWaitSemaphores = pPresentInfo->pWaitSemaphores;
     }
 
-    mCommonBase.onPreSwap(handlers);
+    onPreSwap(swapchain, handlers);
 
     VkPresentInfoKHR replacementPresentInfo = {
         pPresentInfo->sType,          nullptr,
@@ -96,24 +102,27 @@ VkResult SwappyVkFallback::doQueuePresent(
 
     result = mpfnQueuePresentKHR(queue, &replacementPresentInfo);
 
-    mCommonBase.onPostSwap(handlers);
+    onPostSwap(swapchain, handlers);
 
     return result;
 }
 
-void SwappyVkFallback::enableStats(bool enabled) {
+void SwappyVkFallback::enableStats(VkSwapchainKHR swapchain, bool enabled) {
     SWAPPY_LOGE("Frame Statistics Unsupported - API ignored");
 }
 
-void SwappyVkFallback::getStats(SwappyStats* swappyStats) {
+void SwappyVkFallback::getStats(VkSwapchainKHR swapchain,
+                                SwappyStats* swappyStats) {
     SWAPPY_LOGE("Frame Statistics Unsupported - API ignored");
 }
 
-void SwappyVkFallback::recordFrameStart(VkQueue queue, uint32_t image) {
+void SwappyVkFallback::recordFrameStart(VkQueue queue,
+                                        VkSwapchainKHR swapchain,
+                                        uint32_t image) {
     SWAPPY_LOGE("Frame Statistics Unsupported - API ignored");
 }
 
-void SwappyVkFallback::clearStats() {
+void SwappyVkFallback::clearStats(VkSwapchainKHR swapchain) {
     SWAPPY_LOGE("Frame Statistics Unsupported - API ignored");
 }
 
@@ -40,10 +40,18 @@ class SwappyVkFallback : public SwappyVkBase {
         VkQueue queue, uint32_t queueFamilyIndex,
         const VkPresentInfoKHR* pPresentInfo) override final;
 
-    void enableStats(bool enabled) override final;
-    void recordFrameStart(VkQueue queue, uint32_t image) override final;
-    void getStats(SwappyStats* swappyStats) override final;
-    void clearStats() override final;
+    void enableStats(VkSwapchainKHR swapchain, bool enabled) override final;
+    void recordFrameStart(VkQueue queue, VkSwapchainKHR swapchain,
+                          uint32_t image) override final;
+    void getStats(VkSwapchainKHR swapchain,
+                  SwappyStats* swappyStats) override final;
+    void clearStats(VkSwapchainKHR swapchain) override final;
+
+   protected:
+    // Used for testing
+    SwappyVkFallback(const SwappyCommonSettings& settings,
+                     VkPhysicalDevice physicalDevice, VkDevice device,
+                     const SwappyVkFunctionProvider* provider);
 };
 
 }  // namespace swappy
@@ -28,8 +28,14 @@ namespace swappy {
 SwappyVkGoogleDisplayTiming::SwappyVkGoogleDisplayTiming(
     JNIEnv* env, jobject jactivity, VkPhysicalDevice physicalDevice,
     VkDevice device, const SwappyVkFunctionProvider* provider)
-    : SwappyVkBase(env, jactivity, physicalDevice, device, provider) {
-    mPendingFrames.reserve(MAX_FRAME_LAG + 1);
+    : SwappyVkBase(env, jactivity, physicalDevice, device, provider) {}
+
+size_t SwappyVkGoogleDisplayTiming::removeSwapchain(VkSwapchainKHR swapchain) {
+    {
+        std::lock_guard<std::mutex> lock(mTimingsMutex);
+        mTimings.erase(swapchain);
+    }
+    return SwappyVkBase::removeSwapchain(swapchain);
 }
 
 bool SwappyVkGoogleDisplayTiming::doGetRefreshCycleDuration(
@@ -54,7 +60,6 @@ bool SwappyVkGoogleDisplayTiming::doGetRefreshCycleDuration(
     SWAPPY_LOGI("Returning refresh duration of %" PRIu64 " nsec (approx %f Hz)",
                 *pRefreshDuration, refreshRate);
 
-    mSwapchain = swapchain;
     return true;
 }
 
@@ -66,17 +71,16 @@ VkResult SwappyVkGoogleDisplayTiming::doQueuePresent(
         return VK_ERROR_INITIALIZATION_FAILED;
     }
 
-    VkResult res = initializeVkSyncObjects(queue, queueFamilyIndex);
+    VkResult res = initializeVkSyncObjects(
+        queue, pPresentInfo->pSwapchains[0], queueFamilyIndex);
     if (res) {
         return res;
     }
 
-    const SwappyCommon::SwapHandlers handlers = {
-        .lastFrameIsComplete = std::bind(
-            &SwappyVkGoogleDisplayTiming::lastFrameIsCompleted, this, queue),
-        .getPrevFrameGpuTime = std::bind(
-            &SwappyVkGoogleDisplayTiming::getLastFenceTime, this, queue),
-    };
+    // Pacing follows the first swapchain of the present.
+    const VkSwapchainKHR swapchain = pPresentInfo->pSwapchains[0];
+    SwapContext context = {this, queue, swapchain};
+    const SwappyCommon::SwapHandlers handlers = makeSwapHandlers(&context);
 
     VkSemaphore semaphore;
     res = injectFence(queue, pPresentInfo, &semaphore);
@@ -95,20 +99,20 @@ VkResult SwappyVkGoogleDisplayTiming::doQueuePresent(
         pWaitSemaphores = pPresentInfo->pWaitSemaphores;
     }
 
-    mCommonBase.onPreSwap(handlers);
+    // if 0 is passed as desired present time, it is ignored by the loader.
+    const uint64_t desiredPresentTime = onPreSwap(swapchain, handlers);
 
     VkPresentTimeGOOGLE pPresentTimes[pPresentInfo->swapchainCount];
     VkPresentInfoKHR replacementPresentInfo;
     VkPresentTimesInfoGOOGLE presentTimesInfo;
     // Set up the new structures to pass:
-    // if 0 is passed as desired present time, it is ignored by the loader.
-    uint64_t desiredPresentTime =
-        mCommonBase.needToSetPresentationTime()
-            ? mCommonBase.getPresentationTime().time_since_epoch().count()
-            : 0;
-    for (uint32_t i = 0; i < pPresentInfo->swapchainCount; i++) {
-        pPresentTimes[i].presentID = mPresentID;
-        pPresentTimes[i].desiredPresentTime = desiredPresentTime;
+    {
+        std::lock_guard<std::mutex> lock(mTimingsMutex);
+        for (uint32_t i = 0; i < pPresentInfo->swapchainCount; i++) {
+            pPresentTimes[i].presentID =
+                mTimings[pPresentInfo->pSwapchains[i]].presentID++;
+            pPresentTimes[i].desiredPresentTime = desiredPresentTime;
+        }
     }
 
     presentTimesInfo = {VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE,
@@ -121,29 +125,39 @@ VkResult SwappyVkGoogleDisplayTiming::doQueuePresent(
         pPresentInfo->swapchainCount, pPresentInfo->pSwapchains,
         pPresentInfo->pImageIndices,  pPresentInfo->pResults};
 
-    mPresentID++;
-
     res = mpfnQueuePresentKHR(queue, &replacementPresentInfo);
-    mCommonBase.onPostSwap(handlers);
+    onPostSwap(swapchain, handlers);
 
     return res;
 }
 
-void SwappyVkGoogleDisplayTiming::enableStats(bool enabled) {
-    mFrameStatisticsCommon.enableStats(enabled);
+void SwappyVkGoogleDisplayTiming::enableStats(VkSwapchainKHR swapchain,
+                                              bool enabled) {
+    std::lock_guard<std::mutex> lock(mTimingsMutex);
+    mTimings[swapchain].frameStatistics.enableStats(enabled);
 }
 
 void SwappyVkGoogleDisplayTiming::recordFrameStart(VkQueue queue,
+                                                   VkSwapchainKHR swapchain,
                                                    uint32_t image) {
+    // Only the primary swapchain is paced by mCommonBase.
+    bool primary;
+    {
+        std::lock_guard<std::mutex> lock(mSwapchainsMutex);
+        primary = isPrimarySwapchain(swapchain);
+    }
+
+    std::lock_guard<std::mutex> lock(mTimingsMutex);
+    SwapchainTimings& timings = mTimings[swapchain];
     uint64_t frameStartTime = static_cast<uint64_t>(
         std::chrono::steady_clock::now().time_since_epoch().count());
-    mPendingFrames.push_back({mPresentID, frameStartTime});
+    timings.pendingFrames.push_back({timings.presentID, frameStartTime});
 
     // No point in querying if the history is too short, as vulkan loader does
     // not return any history newer than 5 frames.
     // See MIN_NUM_FRAMES_AGO in
     // https://android.googlesource.com/platform/frameworks/native/+/refs/heads/master/vulkan/libvulkan/swapchain.cpp
-    if (mPendingFrames.size() < MIN_FRAME_LAG) return;
+    if (timings.pendingFrames.size() < MIN_FRAME_LAG) return;
 
     // The query for vulkan past presentation timings does not point to any
     // specific id. Instead, the loader just returns whatever timings are
@@ -156,7 +170,7 @@ void SwappyVkGoogleDisplayTiming::recordFrameStart(VkQueue queue,
     //  * The maximum size of the vectors here is 10, so simplicity is
     //  prioritized.
     //  * The frames are in order.
-    //  * If any of the presentTimings ids are not present in mPendingFrames,
+    //  * If any of the presentTimings ids are not present in pendingFrames,
     //  those are frames that must have been cleared and we do not care about
     //  the timings anymore.
     //  * [Performance] Under normal smooth circumstances, this should be 1
@@ -166,7 +180,7 @@ void SwappyVkGoogleDisplayTiming::recordFrameStart(VkQueue queue,
     //  frames is not going to impact overall performance.
     uint32_t pastTimingsCount = MAX_FRAME_LAG;
     VkResult result = mpfnGetPastPresentationTimingGOOGLE(
-        mDevice, mSwapchain, &pastTimingsCount, &mPastTimes[0]);
+        mDevice, swapchain, &pastTimingsCount, &timings.pastTimes[0]);
 
     if (result == VK_INCOMPLETE) {
         SWAPPY_LOGI(
@@ -180,38 +194,47 @@ void SwappyVkGoogleDisplayTiming::recordFrameStart(VkQueue queue,
     }
 
     int i = 0;
-    while (i < pastTimingsCount && mPendingFrames.size() > 1) {
-        auto frame = mPendingFrames.front();
+    while (i < pastTimingsCount && timings.pendingFrames.size() > 1) {
+        auto frame = timings.pendingFrames.front();
 
-        if (frame.id == mPastTimes[i].presentID) {
+        if (frame.id == timings.pastTimes[i].presentID) {
+            const VkPastPresentationTimingGOOGLE& pastTime =
+                timings.pastTimes[i];
             FrameTimings current = {
-                frame.startFrameTime, mPastTimes[i].desiredPresentTime,
-                mPastTimes[i].actualPresentTime, mPastTimes[i].presentMargin};
+                frame.startFrameTime, pastTime.desiredPresentTime,
+                pastTime.actualPresentTime, pastTime.presentMargin};
 
-            mFrameStatisticsCommon.updateFrameStats(
+            timings.frameStatistics.updateFrameStats(
                 current, mCommonBase.getRefreshPeriod().count());
+            if (primary) {
+                mCommonBase.onFramePresented(pastTime.desiredPresentTime,
+                                             pastTime.actualPresentTime);
+            }
             i++;
         }
         // If the past timings returned do not match, then the pending frame is
         // too old. So remove it from the list.
-        mPendingFrames.erase(mPendingFrames.begin());
+        timings.pendingFrames.erase(timings.pendingFrames.begin());
     }
 
     // Clear the pending frames if we are lagging too much.
-    if (mPendingFrames.size() > MAX_FRAME_LAG) {
-        while (mPendingFrames.size() > MIN_FRAME_LAG) {
-            mPendingFrames.erase(mPendingFrames.begin());
+    if (timings.pendingFrames.size() > MAX_FRAME_LAG) {
+        while (timings.pendingFrames.size() > MIN_FRAME_LAG) {
+            timings.pendingFrames.erase(timings.pendingFrames.begin());
         }
-        mFrameStatisticsCommon.invalidateLastFrame();
+        timings.frameStatistics.invalidateLastFrame();
     }
 }
 
-void SwappyVkGoogleDisplayTiming::getStats(SwappyStats* swappyStats) {
-    *swappyStats = mFrameStatisticsCommon.getStats();
+void SwappyVkGoogleDisplayTiming::getStats(VkSwapchainKHR swapchain,
+                                           SwappyStats* swappyStats) {
+    std::lock_guard<std::mutex> lock(mTimingsMutex);
+    *swappyStats = mTimings[swapchain].frameStatistics.getStats();
 }
 
-void SwappyVkGoogleDisplayTiming::clearStats() {
-    mFrameStatisticsCommon.clearStats();
+void SwappyVkGoogleDisplayTiming::clearStats(VkSwapchainKHR swapchain) {
+    std::lock_guard<std::mutex> lock(mTimingsMutex);
+    mTimings[swapchain].frameStatistics.clearStats();
 }
 }  // namespace swappy
 
@@ -34,9 +34,9 @@ namespace swappy {
  * - We assume a fixed refresh-rate (FRR) display that's between 60 Hz and 120
  *Hz.
  *
- * - While Vulkan allows applications to create and use multiple
- *VkSwapchainKHR's per VkDevice, and to re-create VkSwapchainKHR's, we assume
- *that the application uses a single VkSwapchainKHR, and never re-creates it.
+ * - Vulkan allows applications to create and use multiple VkSwapchainKHR's per
+ *VkDevice. Each of them keeps its own present IDs and frame statistics, while
+ *pacing is shared as described in SwappyVkBase.
  *
  * - The values reported back by the VK_GOOGLE_display_timing extension (which
  *comes from lower-level Android interfaces) are not precise, and that values
@@ -78,19 +78,20 @@ class SwappyVkGoogleDisplayTiming : public SwappyVkBase {
         VkQueue queue, uint32_t queueFamilyIndex,
         const VkPresentInfoKHR* pPresentInfo) override final;
 
-    void enableStats(bool enabled) override final;
-    void recordFrameStart(VkQueue queue, uint32_t image) override final;
-    void getStats(SwappyStats* swappyStats) override final;
-    void clearStats() override final;
+    size_t removeSwapchain(VkSwapchainKHR swapchain) override final;
+
+    void enableStats(VkSwapchainKHR swapchain, bool enabled) override final;
+    void recordFrameStart(VkQueue queue, VkSwapchainKHR swapchain,
+                          uint32_t image) override final;
+    void getStats(VkSwapchainKHR swapchain,
+                  SwappyStats* swappyStats) override final;
+    void clearStats(VkSwapchainKHR swapchain) override final;
 
    private:
     static constexpr int MAX_FRAME_LAG = 10;
     // Vulkan loader does not give any frame timings unless they are 5 frames
     // old. We use this internally to not waste calls.
     static constexpr int MIN_FRAME_LAG = 5;
-    uint32_t mPresentID = 0;
-
-    VkSwapchainKHR mSwapchain;
 
     struct VKFrame {
         uint32_t id;
@@ -98,10 +99,21 @@ class SwappyVkGoogleDisplayTiming : public SwappyVkBase {
         int pastTimingIndex;
     };
 
-    std::vector<VKFrame> mPendingFrames;
-    // Storage for querying past presentation frames, allocated upfront.
-    VkPastPresentationTimingGOOGLE mPastTimes[MAX_FRAME_LAG];
-    FrameStatistics mFrameStatisticsCommon;
+    struct SwapchainTimings {
+        SwapchainTimings() { pendingFrames.reserve(MAX_FRAME_LAG + 1); }
+
+        uint32_t presentID = 0;
+        std::vector<VKFrame> pendingFrames;
+        // Storage for querying past presentation frames, allocated upfront.
+        VkPastPresentationTimingGOOGLE pastTimes[MAX_FRAME_LAG];
+        FrameStatistics frameStatistics;
+    };
+
+    // The timings of a swapchain are only used with mTimingsMutex held, since
+    // removeSwapchain can free them from another thread.
+    std::mutex mTimingsMutex;
+    std::map<VkSwapchainKHR, SwapchainTimings> mTimings
+        GUARDED_BY(mTimingsMutex);
 };
 
 }  // namespace swappy
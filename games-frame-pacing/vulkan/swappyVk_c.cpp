@@ -151,6 +151,13 @@ int SwappyVk_getSupportedRefreshPeriodsNS(uint64_t* out_refreshrates,
                                                allocated_entries, swapchain);
 }
 
+bool SwappyVk_getRefreshRatePlan(VkSwapchainKHR swapchain,
+                                 SwappyRefreshRatePlan* out_plan) {
+    TRACE_CALL();
+    swappy::SwappyVk& swappy = swappy::SwappyVk::getInstance();
+    return swappy.GetRefreshRatePlan(swapchain, out_plan);
+}
+
 bool SwappyVk_isEnabled(VkSwapchainKHR swapchain, bool* isEnabled) {
     TRACE_CALL();
     swappy::SwappyVk& swappy = swappy::SwappyVk::getInstance();
@@ -200,4 +207,10 @@ void SwappyVk_enableBlockingWait(VkSwapchainKHR swapchain, bool enable) {
     swappy.enableBlockingWait(swapchain, enable);
 }
 
+void SwappyVk_enableLowLatencyMode(VkSwapchainKHR swapchain, bool enable) {
+    TRACE_INT("enableLowLatencyMode", (int)enable);
+    swappy::SwappyVk& swappy = swappy::SwappyVk::getInstance();
+    swappy.enableLowLatencyMode(swapchain, enable);
+}
+
 }  // extern "C"
@@ -20,36 +20,30 @@
 #include <unistd.h>
 
 #include <chrono>
-#include <fstream>
-#include <iterator>
 #include <map>
-#include <regex>
-#include <sstream>
-#include <streambuf>
 #include <utility>
 #include <vector>
 
 #include "jni/jni_wrap.h"
+#include "procfs.h"
 
 using namespace gamesdk::jni;
 
 constexpr double BYTES_IN_KB = 1024;
 constexpr double BYTES_IN_MB = 1024 * 1024;
-const std::regex MEMINFO_REGEX("([^:]+)[^\\d]*(\\d+).*\n");
-const std::regex STATUS_REGEX("([a-zA-Z]+)[^\\d]*(\\d+) kB.*\n");
 
 namespace memory_advice {
 
 using namespace json11;
 
 Json::object DefaultMetricsProvider::GetMeminfoValues() {
-    return GetMemoryValuesFromFile("/proc/meminfo", MEMINFO_REGEX);
+    return GetMemoryValuesFromFile("/proc/meminfo", false);
 }
 
 Json::object DefaultMetricsProvider::GetStatusValues() {
-    std::stringstream ss_path;
-    ss_path << "/proc/" << getpid() << "/status";
-    return GetMemoryValuesFromFile(ss_path.str(), STATUS_REGEX);
+    char path[gamesdk::procfs::kMaxPathLength];
+    snprintf(path, sizeof(path), "/proc/%d/status", getpid());
+    return GetMemoryValuesFromFile(path, true);
 }
 
 Json::object DefaultMetricsProvider::GetProcValues() {
@@ -100,39 +94,36 @@ Json::object DefaultMetricsProvider::GetDebugValues() {
     return metrics_map;
 }
 
-Json::object DefaultMetricsProvider::GetMemoryValuesFromFile(
-    const std::string &path, const std::regex &pattern) {
-    std::ifstream file_stream(path);
+Json::object DefaultMetricsProvider::GetMemoryValuesFromFile(const char *path,
+                                                             bool kb_only) {
     Json::object metrics_map;
-    if (!file_stream) {
-        ALOGE("Could not open %s", path.c_str());
+    gamesdk::procfs::LineReader reader(path);
+    if (!reader.IsOpen()) {
+        ALOGE("Could not open %s", path);
         return metrics_map;
     }
 
-    std::string file((std::istreambuf_iterator<char>(file_stream)),
-                     std::istreambuf_iterator<char>());
-    std::smatch match;
-    while (std::regex_search(file, match, pattern)) {
-        metrics_map[match[1].str()] =
-            Json((double)(strtoll(match[2].str().c_str(), nullptr, 10) *
-                          BYTES_IN_KB));
-        file = match.suffix().str();
+    gamesdk::procfs::Field field;
+    while (const char *line = reader.NextLine()) {
+        if (!gamesdk::procfs::ParseField(line, &field) || !field.has_number ||
+            (kb_only && !field.in_kb)) {
+            continue;
+        }
+        metrics_map[std::string(field.key, field.key_length)] =
+            Json((double)(field.number * BYTES_IN_KB));
     }
     return metrics_map;
 }
 
 int32_t DefaultMetricsProvider::GetOomScore() {
-    std::stringstream ss_path;
-    ss_path << "/proc/" << getpid() << "/oom_score";
-    std::ifstream oom_file(ss_path.str());
-    if (!oom_file) {
-        ALOGE_ONCE("Could not open %s", ss_path.str().c_str());
+    char path[gamesdk::procfs::kMaxPathLength];
+    snprintf(path, sizeof(path), "/proc/%d/oom_score", getpid());
+    int64_t oom_score;
+    if (!gamesdk::procfs::ReadInt64(path, &oom_score)) {
+        ALOGE_ONCE("Could not open %s", path);
         return -1;
-    } else {
-        int32_t oom_score;
-        oom_file >> oom_score;
-        return oom_score;
     }
+    return static_cast<int32_t>(oom_score);
 }
 
 }  // namespace memory_advice
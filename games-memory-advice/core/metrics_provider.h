@@ -18,7 +18,6 @@
 
 #include <map>
 #include <memory>
-#include <regex>
 #include <string>
 
 #include "jni/jni_wrap.h"
@@ -88,9 +87,9 @@ class DefaultMetricsProvider : public IMetricsProvider {
     android::os::DebugClass android_debug_;
     /**
      * @brief Reads the given file and dumps the memory values within as a map
+     * @param kb_only Only read the values followed by "kB".
      */
-    Json::object GetMemoryValuesFromFile(const std::string &path,
-                                         const std::regex &pattern);
+    Json::object GetMemoryValuesFromFile(const char *path, bool kb_only);
     /** @brief Reads the OOM Score of the app from /proc/{pid}/oom_score */
     int32_t GetOomScore();
 };
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "annotation_registry.h"
+
+#include "annotation_util.h"
+
+namespace tuningfork {
+
+constexpr uint32_t AnnotationRegistry::kBlockSize;
+constexpr uint32_t AnnotationRegistry::kMaxBlocks;
+constexpr AnnotationHandle AnnotationRegistry::kMaxHandles;
+
+TuningFork_ErrorCode AnnotationRegistry::GetOrRegister(
+    AnnotationId id, const SerializedAnnotation& ser,
+    AnnotationHandle& handle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = handles_.find(id);
+    if (it != handles_.end()) {
+        handle = it->second;
+        return TUNINGFORK_ERROR_OK;
+    }
+    uint32_t size = size_.load(std::memory_order_relaxed);
+    if (size >= kMaxHandles) return TUNINGFORK_ERROR_INVALID_ANNOTATION;
+
+    auto& block = blocks_[size / kBlockSize];
+    if (!block) block.reset(new Entry[kBlockSize]);
+    block[size % kBlockSize] = {
+        id, "APTAnnotation@" + annotation_util::HumanReadableAnnotation(ser)};
+    handles_[id] = size;
+    handle = size;
+    // Publish the entry.
+    size_.store(size + 1, std::memory_order_release);
+    return TUNINGFORK_ERROR_OK;
+}
+
+}  // namespace tuningfork
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "common.h"
+
+namespace tuningfork {
+
+// Hands out compact handles for annotation ids, so that switching to an
+// annotation doesn't need its serialization to be hashed or decoded again.
+//
+// Entries are stored in fixed-size blocks that never move once allocated and
+// are published by incrementing the size, so Get() doesn't lock.
+class AnnotationRegistry {
+   public:
+    static constexpr uint32_t kBlockSize = 256;
+    static constexpr uint32_t kMaxBlocks = 256;
+    static constexpr AnnotationHandle kMaxHandles = kBlockSize * kMaxBlocks;
+
+    struct Entry {
+        AnnotationId id;
+        // Name of the ATrace section recorded while the annotation is current.
+        std::string trace_marker;
+    };
+
+    // Return the handle of the annotation with this id, registering it if
+    // needed. The serialization is only decoded on registration.
+    TuningFork_ErrorCode GetOrRegister(AnnotationId id,
+                                       const SerializedAnnotation& ser,
+                                       AnnotationHandle& handle);
+
+    // Return the entry for handle, or nullptr if it wasn't registered.
+    const Entry* Get(AnnotationHandle handle) const {
+        if (handle >= size_.load(std::memory_order_acquire)) return nullptr;
+        return &blocks_[handle / kBlockSize][handle % kBlockSize];
+    }
+
+    uint32_t Size() const { return size_.load(std::memory_order_acquire); }
+
+   private:
+    std::mutex mutex_;
+    std::unordered_map<AnnotationId, AnnotationHandle> handles_;
+    std::unique_ptr<Entry[]> blocks_[kMaxBlocks];
+    std::atomic<uint32_t> size_{0};
+};
+
+}  // namespace tuningfork
@@ -32,8 +32,10 @@ namespace tuningfork {
 // segment
 typedef uint16_t InstrumentationKey;
 typedef uint32_t AnnotationId;
+typedef TuningFork_AnnotationHandle AnnotationHandle;
 typedef uint64_t TraceHandle;
 typedef uint64_t LoadingHandle;
+typedef TuningFork_LoadingSpanHandle LoadingSpanHandle;
 typedef uint16_t LoadingTimeMetadataId;
 typedef ProtobufSerialization SerializedAnnotation;
 typedef TuningFork_LoadingTimeMetadata LoadingTimeMetadata;
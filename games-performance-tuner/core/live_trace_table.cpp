@@ -0,0 +1,99 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "live_trace_table.h"
+
+#include <functional>
+#include <thread>
+
+namespace tuningfork {
+
+constexpr uint32_t LiveTraceTable::kSlotsPerBlock;
+constexpr uint32_t LiveTraceTable::kNumBlocks;
+constexpr uint32_t LiveTraceTable::kNumSlots;
+
+LiveTraceTable::LiveTraceTable() {
+    for (auto& block : blocks_) {
+        for (auto& slot : block.slots) {
+            slot.sequence.store(0, std::memory_order_relaxed);
+            slot.metric_id.store(0, std::memory_order_relaxed);
+            slot.start.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+TuningFork_ErrorCode LiveTraceTable::Start(MetricId id, TimePoint t,
+                                           TraceHandle& handle) {
+    uint32_t home = HomeBlock();
+    for (uint32_t b = 0; b < kNumBlocks; ++b) {
+        uint32_t block = (home + b) % kNumBlocks;
+        for (uint32_t s = 0; s < kSlotsPerBlock; ++s) {
+            uint32_t index = block * kSlotsPerBlock + s;
+            Slot& slot = GetSlot(index);
+            uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+            if (sequence & 1) continue;
+            if (!slot.sequence.compare_exchange_strong(
+                    sequence, sequence + 1, std::memory_order_acquire,
+                    std::memory_order_relaxed))
+                continue;
+            // Whoever ends the trace gets the handle from us after this.
+            slot.metric_id.store(id.base, std::memory_order_relaxed);
+            slot.start.store(t.time_since_epoch().count(),
+                             std::memory_order_relaxed);
+            handle = (static_cast<uint64_t>(sequence + 1) << 32) | index;
+            return TUNINGFORK_ERROR_OK;
+        }
+    }
+    return TUNINGFORK_ERROR_NO_MORE_SPACE_FOR_FRAME_TIME_DATA;
+}
+
+TuningFork_ErrorCode LiveTraceTable::End(TraceHandle handle, TimePoint t,
+                                         MetricId& id, Duration& duration) {
+    uint32_t index = SlotIndex(handle);
+    uint32_t sequence = static_cast<uint32_t>(handle >> 32);
+    if (index >= kNumSlots || (sequence & 1) == 0)
+        return TUNINGFORK_ERROR_INVALID_TRACE_HANDLE;
+    Slot& slot = GetSlot(index);
+    // Read before freeing the slot: once it's free, another trace can start
+    // in it. If the handle is stale, the exchange below fails.
+    uint64_t metric_id = slot.metric_id.load(std::memory_order_relaxed);
+    auto start = slot.start.load(std::memory_order_relaxed);
+    if (!slot.sequence.compare_exchange_strong(sequence, sequence + 1,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed))
+        return TUNINGFORK_ERROR_INVALID_TRACE_HANDLE;
+    id = MetricId{metric_id};
+    duration = t - TimePoint(Duration(start));
+    return TUNINGFORK_ERROR_OK;
+}
+
+uint32_t LiveTraceTable::Size() const {
+    uint32_t size = 0;
+    for (auto& block : blocks_) {
+        for (auto& slot : block.slots) {
+            if (slot.sequence.load(std::memory_order_relaxed) & 1) ++size;
+        }
+    }
+    return size;
+}
+
+uint32_t LiveTraceTable::HomeBlock() {
+    static thread_local uint32_t home =
+        std::hash<std::thread::id>()(std::this_thread::get_id()) % kNumBlocks;
+    return home;
+}
+
+}  // namespace tuningfork
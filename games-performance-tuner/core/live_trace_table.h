@@ -0,0 +1,81 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include "common.h"
+#include "metric.h"
+
+namespace tuningfork {
+
+// The traces started with TuningFork_startTrace and not yet ended.
+//
+// Traces can be started and ended from any thread, without locking, and there
+// can be several live traces for the same instrumentation key. Each thread
+// starts its traces in a home block of slots chosen from its thread id, so
+// nested traces on a thread stack up in the same cache lines. If the home
+// block is full, the following blocks are used.
+//
+// Each slot has a sequence number that is odd while a trace is live in it.
+// The handle of a trace is made of the slot index and the sequence number, so
+// ending a trace twice or with a stale handle fails instead of ending a later
+// trace that reused the slot.
+class LiveTraceTable {
+   public:
+    static constexpr uint32_t kSlotsPerBlock = 16;
+    static constexpr uint32_t kNumBlocks = 64;
+    static constexpr uint32_t kNumSlots = kSlotsPerBlock * kNumBlocks;
+
+    LiveTraceTable();
+
+    // Returns TUNINGFORK_ERROR_NO_MORE_SPACE_FOR_FRAME_TIME_DATA if there are
+    // already kNumSlots live traces.
+    TuningFork_ErrorCode Start(MetricId id, TimePoint t, TraceHandle& handle);
+
+    // Fills in the metric and duration of the trace.
+    // Returns TUNINGFORK_ERROR_INVALID_TRACE_HANDLE if handle isn't a live
+    // trace.
+    TuningFork_ErrorCode End(TraceHandle handle, TimePoint t, MetricId& id,
+                             Duration& duration);
+
+    // Index of the slot of a live trace, unique among the live traces.
+    static uint32_t SlotIndex(TraceHandle handle) {
+        return static_cast<uint32_t>(handle);
+    }
+
+    // Number of live traces. Only exact when no trace starts or ends.
+    uint32_t Size() const;
+
+   private:
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        std::atomic<uint64_t> metric_id;
+        std::atomic<TimePoint::rep> start;
+    };
+    struct alignas(64) Block {
+        Slot slots[kSlotsPerBlock];
+    };
+    Slot& GetSlot(uint32_t index) {
+        return blocks_[index / kSlotsPerBlock].slots[index % kSlotsPerBlock];
+    }
+    static uint32_t HomeBlock();
+
+    Block blocks_[kNumBlocks];
+};
+
+}  // namespace tuningfork
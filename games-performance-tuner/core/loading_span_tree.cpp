@@ -0,0 +1,136 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "loading_span_tree.h"
+
+#include <algorithm>
+
+#include "loadingtime_metric.h"
+
+namespace tuningfork {
+
+constexpr LoadingSpanTree::SpanId LoadingSpanTree::kRoot;
+constexpr size_t LoadingSpanTree::kMaxSpans;
+constexpr size_t LoadingSpanTree::kMaxNameLength;
+
+LoadingSpanTree::LoadingSpanTree(ProcessTime start) {
+    spans_.push_back({"", kRoot, start, start, false});
+}
+
+TuningFork_ErrorCode LoadingSpanTree::Begin(const std::string& name,
+                                            SpanId parent, ProcessTime t,
+                                            SpanId& span) {
+    if (parent >= spans_.size() || (parent != kRoot && spans_[parent].ended))
+        return TUNINGFORK_ERROR_INVALID_LOADING_HANDLE;
+    if (Size() >= kMaxSpans) {
+        ++dropped_spans_;
+        return TUNINGFORK_ERROR_NO_MORE_SPACE_FOR_LOADING_TIME_DATA;
+    }
+    span = spans_.size();
+    spans_.push_back({name.substr(0, kMaxNameLength), parent, t, t, false});
+    return TUNINGFORK_ERROR_OK;
+}
+
+TuningFork_ErrorCode LoadingSpanTree::End(SpanId span, ProcessTime t) {
+    if (span == kRoot || span >= spans_.size() || spans_[span].ended)
+        return TUNINGFORK_ERROR_INVALID_LOADING_HANDLE;
+    spans_[span].end = std::max(t, spans_[span].start);
+    spans_[span].ended = true;
+    return TUNINGFORK_ERROR_OK;
+}
+
+LoadingSpanSummary LoadingSpanTree::Summarize(ProcessTime end,
+                                              size_t max_slowest_spans) const {
+    const size_t n = spans_.size();
+    std::vector<ProcessTimeInterval> intervals(n);
+    std::vector<std::vector<SpanId>> children(n);
+    std::vector<uint32_t> depth(n, 0);
+    LoadingSpanSummary summary;
+    for (SpanId i = 0; i < n; ++i) {
+        const auto& span = spans_[i];
+        intervals[i] = {span.start, span.ended ? span.end : end};
+        if (i == kRoot) continue;
+        children[span.parent].push_back(i);
+        depth[i] = depth[span.parent] + 1;
+        summary.max_depth = std::max(summary.max_depth, depth[i]);
+    }
+
+    // Self time is the time not covered by the union of the children.
+    std::vector<Duration> self_time(n);
+    Duration total_self_time = Duration::zero();
+    for (SpanId i = 0; i < n; ++i) {
+        std::vector<ProcessTimeInterval> covered;
+        for (auto child : children[i]) covered.push_back(intervals[child]);
+        std::sort(covered.begin(), covered.end(),
+                  [](const ProcessTimeInterval& a,
+                     const ProcessTimeInterval& b) {
+                      return a.Start() < b.Start();
+                  });
+        ProcessTime t = intervals[i].Start();
+        Duration covered_time = Duration::zero();
+        for (const auto& c : covered) {
+            auto start = std::max(c.Start(), t);
+            auto stop = std::min(c.End(), intervals[i].End());
+            if (stop > start) {
+                covered_time += stop - start;
+                t = stop;
+            }
+        }
+        self_time[i] = intervals[i].Duration() - covered_time;
+        total_self_time += self_time[i];
+    }
+
+    // Follow the critical path down from the root: at each level, it goes
+    // through the longest chain of children that ran one after the other.
+    std::vector<bool> on_critical_path(n, false);
+    on_critical_path[kRoot] = true;
+    for (SpanId i = 0; i < n; ++i) {
+        if (!on_critical_path[i] || children[i].empty()) continue;
+        std::vector<ProcessTimeInterval> child_intervals;
+        for (auto child : children[i])
+            child_intervals.push_back(intervals[child]);
+        std::vector<size_t> chain;
+        auto length = LoadingCriticalPath(child_intervals, &chain);
+        if (i == kRoot) summary.critical_path = length;
+        for (auto c : chain) on_critical_path[children[i][c]] = true;
+    }
+
+    summary.span_count = n - 1;
+    summary.dropped_spans = dropped_spans_;
+    auto group_duration = intervals[kRoot].Duration();
+    if (group_duration > Duration::zero()) {
+        summary.parallelism = static_cast<double>(total_self_time.count()) /
+                              group_duration.count();
+    }
+
+    std::vector<SpanId> slowest;
+    for (SpanId i = 1; i < n; ++i) slowest.push_back(i);
+    auto n_slowest = std::min(max_slowest_spans, slowest.size());
+    std::partial_sort(slowest.begin(), slowest.begin() + n_slowest,
+                      slowest.end(), [&](SpanId a, SpanId b) {
+                          return intervals[a].Duration() >
+                                 intervals[b].Duration();
+                      });
+    for (size_t k = 0; k < n_slowest; ++k) {
+        auto i = slowest[k];
+        summary.slowest_spans.push_back({spans_[i].name, intervals[i],
+                                         self_time[i], depth[i],
+                                         on_critical_path[i]});
+    }
+    return summary;
+}
+
+}  // namespace tuningfork
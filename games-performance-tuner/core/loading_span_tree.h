@@ -0,0 +1,96 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "process_time.h"
+
+namespace tuningfork {
+
+// What is uploaded for the spans of a loading group.
+struct LoadingSpanSummary {
+    struct Span {
+        std::string name;
+        ProcessTimeInterval interval;
+        // Time not covered by any of the span's children.
+        Duration self_time;
+        // Top-level spans have depth 1.
+        uint32_t depth;
+        bool on_critical_path;
+    };
+    uint32_t span_count = 0;
+    // Spans that weren't recorded because the tree was full.
+    uint32_t dropped_spans = 0;
+    uint32_t max_depth = 0;
+    // Duration of the longest chain of top-level spans that ran one after the
+    // other.
+    Duration critical_path = Duration::zero();
+    // Sum of the self times of the group and all its spans, divided by the
+    // duration of the group: 1 if nothing ran in parallel.
+    double parallelism = 0;
+    // The slowest spans, slowest first.
+    std::vector<Span> slowest_spans;
+};
+
+// A tree of named spans recorded in a loading group, the group itself being
+// the root. Spans have to start after their parent, so they are stored in an
+// order where parents come before their children. The number of spans is
+// bounded.
+class LoadingSpanTree {
+   public:
+    typedef uint32_t SpanId;
+    static constexpr SpanId kRoot = 0;
+    static constexpr size_t kMaxSpans = 256;
+    static constexpr size_t kMaxNameLength = 64;
+
+    explicit LoadingSpanTree(ProcessTime start);
+
+    // Start a span, a child of parent, which is kRoot for top-level spans.
+    // Returns TUNINGFORK_ERROR_INVALID_LOADING_HANDLE if parent isn't a span or
+    // TUNINGFORK_ERROR_NO_MORE_SPACE_FOR_LOADING_TIME_DATA if the tree is full.
+    TuningFork_ErrorCode Begin(const std::string& name, SpanId parent,
+                               ProcessTime t, SpanId& span);
+
+    // End a span. Spans that aren't ended end with the group.
+    // Returns TUNINGFORK_ERROR_INVALID_LOADING_HANDLE if span isn't a span
+    // that was started and not ended.
+    TuningFork_ErrorCode End(SpanId span, ProcessTime t);
+
+    // Analyze the tree of a group that ended at end and return a summary with
+    // the max_slowest_spans slowest spans.
+    LoadingSpanSummary Summarize(ProcessTime end,
+                                 size_t max_slowest_spans) const;
+
+    // Number of spans, not including the root.
+    size_t Size() const { return spans_.size() - 1; }
+
+   private:
+    struct Span {
+        std::string name;
+        SpanId parent;
+        ProcessTime start;
+        ProcessTime end;
+        bool ended;
+    };
+    std::vector<Span> spans_;
+    uint32_t dropped_spans_ = 0;
+};
+
+}  // namespace tuningfork
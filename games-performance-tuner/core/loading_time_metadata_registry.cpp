@@ -0,0 +1,197 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "loading_time_metadata_registry.h"
+
+namespace tuningfork {
+
+constexpr uint32_t LoadingTimeMetadataRegistry::kBlockSize;
+constexpr uint32_t LoadingTimeMetadataRegistry::kMaxBlocks;
+constexpr uint32_t LoadingTimeMetadataRegistry::kMaxIds;
+constexpr uint32_t LoadingTimeMetadataRegistry::kNumBuckets;
+
+LoadingTimeMetadataRegistry::LoadingTimeMetadataRegistry()
+    : buckets_(new Slot[kNumBuckets]()) {
+    for (auto& block : blocks_) block.store(nullptr);
+}
+
+LoadingTimeMetadataRegistry::~LoadingTimeMetadataRegistry() {
+    for (auto& block : blocks_) {
+        Slot* slots = block.load();
+        if (slots == nullptr) continue;
+        for (uint32_t i = 0; i < kBlockSize; ++i) delete slots[i].load();
+        delete[] slots;
+    }
+    for (auto e : retired_) delete e;
+}
+
+TuningFork_ErrorCode LoadingTimeMetadataRegistry::GetOrRegister(
+    const LoadingTimeMetadataWithGroup& metadata, LoadingTimeMetadataId& id) {
+    size_t hash = std::hash<LoadingTimeMetadataWithGroup>()(metadata);
+    StartRead();
+    Entry* e = Find(metadata, hash);
+    bool found = e != nullptr && Touch(e);
+    if (found) id = e->id;
+    readers_.fetch_sub(1);
+    if (found) return TUNINGFORK_ERROR_OK;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Recycle can't run while we hold the lock, so no entry found now is dead.
+    e = Find(metadata, hash);
+    if (e != nullptr) {
+        MarkUsed(e, epoch_.load());
+        id = e->id;
+        return TUNINGFORK_ERROR_OK;
+    }
+    uint32_t new_id;
+    if (!free_ids_.empty()) {
+        new_id = free_ids_.back();
+        free_ids_.pop_back();
+    } else if (next_id_ < kMaxIds) {
+        new_id = next_id_++;
+    } else {
+        return TUNINGFORK_ERROR_NO_MORE_SPACE_FOR_LOADING_TIME_DATA;
+    }
+    auto& block = blocks_[new_id / kBlockSize];
+    if (block.load(std::memory_order_relaxed) == nullptr)
+        block.store(new Slot[kBlockSize](), std::memory_order_release);
+
+    e = new Entry;
+    e->metadata = metadata;
+    e->hash = hash;
+    e->id = new_id;
+    e->last_used.store(epoch_.load());
+    auto& bucket = buckets_[hash % kNumBuckets];
+    e->next.store(bucket.load(std::memory_order_relaxed));
+    // Publish the entry.
+    IdSlot(new_id)->store(e, std::memory_order_release);
+    bucket.store(e, std::memory_order_release);
+    size_.fetch_add(1, std::memory_order_relaxed);
+    id = new_id;
+    return TUNINGFORK_ERROR_OK;
+}
+
+TuningFork_ErrorCode LoadingTimeMetadataRegistry::Get(
+    LoadingTimeMetadataId id, LoadingTimeMetadataWithGroup& md) const {
+    // Keeps Recycle from deleting the entry while it's copied.
+    StartRead();
+    Slot* slot = IdSlot(id);
+    Entry* e = slot ? slot->load(std::memory_order_acquire) : nullptr;
+    if (e != nullptr) md = e->metadata;
+    readers_.fetch_sub(1);
+    return e != nullptr ? TUNINGFORK_ERROR_OK : TUNINGFORK_ERROR_BAD_PARAMETER;
+}
+
+TuningFork_ErrorCode LoadingTimeMetadataRegistry::Use(
+    LoadingTimeMetadataId id) {
+    StartRead();
+    Slot* slot = IdSlot(id);
+    Entry* e = slot ? slot->load(std::memory_order_acquire) : nullptr;
+    bool used = e != nullptr && Touch(e);
+    readers_.fetch_sub(1);
+    return used ? TUNINGFORK_ERROR_OK : TUNINGFORK_ERROR_BAD_PARAMETER;
+}
+
+void LoadingTimeMetadataRegistry::Recycle(
+    const std::vector<LoadingTimeMetadataId>& pinned) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t epoch = epoch_.load();
+    // A pinned loading event can end and record into the next session without
+    // looking its metadata up again, so keep it through the next call too.
+    for (auto id : pinned) {
+        Slot* slot = IdSlot(id);
+        Entry* e = slot ? slot->load(std::memory_order_relaxed) : nullptr;
+        if (e != nullptr) MarkUsed(e, epoch + 1);
+    }
+    for (uint32_t id = 1; id < next_id_; ++id) {
+        Slot* slot = IdSlot(id);
+        Entry* e = slot->load(std::memory_order_relaxed);
+        if (e == nullptr || e->last_used.load() >= epoch) continue;
+        // Touch() sets last_used before checking dead, so either it sees the
+        // entry as dead or we see it was used.
+        e->dead.store(true);
+        if (e->last_used.load() >= epoch) {
+            e->dead.store(false);
+            continue;
+        }
+        Unlink(e);
+        slot->store(nullptr, std::memory_order_release);
+        retired_.push_back(e);
+        free_ids_.push_back(id);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    epoch_.store(epoch + 1);
+    // Pairs with the fence in StartRead: a lookup that we don't count here
+    // starts after the unlinking and can't reach the retired entries.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (readers_.load() == 0) {
+        for (auto e : retired_) delete e;
+        retired_.clear();
+    }
+}
+
+LoadingTimeMetadataRegistry::Entry* LoadingTimeMetadataRegistry::Find(
+    const LoadingTimeMetadataWithGroup& metadata, size_t hash) const {
+    const Slot& bucket = buckets_[hash % kNumBuckets];
+    for (Entry* e = bucket.load(std::memory_order_acquire); e != nullptr;
+         e = e->next.load(std::memory_order_acquire)) {
+        if (e->hash == hash && e->metadata == metadata) return e;
+    }
+    return nullptr;
+}
+
+void LoadingTimeMetadataRegistry::StartRead() const {
+    readers_.fetch_add(1);
+    // Keeps the loads of the lookup from being done before the increment is
+    // visible to Recycle.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void LoadingTimeMetadataRegistry::MarkUsed(Entry* e, uint64_t epoch) {
+    // Never lower last_used, which may hold the next epoch for a pinned id.
+    uint64_t last_used = e->last_used.load();
+    while (last_used < epoch &&
+           !e->last_used.compare_exchange_weak(last_used, epoch)) {
+    }
+}
+
+bool LoadingTimeMetadataRegistry::Touch(Entry* e) const {
+    while (true) {
+        uint64_t epoch = epoch_.load();
+        MarkUsed(e, epoch);
+        if (e->dead.load()) return false;
+        // If Recycle ran meanwhile, mark the entry as used in the new epoch.
+        if (epoch_.load() == epoch) return true;
+    }
+}
+
+LoadingTimeMetadataRegistry::Slot* LoadingTimeMetadataRegistry::IdSlot(
+    LoadingTimeMetadataId id) const {
+    Slot* block = blocks_[id / kBlockSize].load(std::memory_order_acquire);
+    if (block == nullptr) return nullptr;
+    return &block[id % kBlockSize];
+}
+
+void LoadingTimeMetadataRegistry::Unlink(Entry* e) {
+    Slot* link = &buckets_[e->hash % kNumBuckets];
+    while (link->load(std::memory_order_relaxed) != e)
+        link = &link->load(std::memory_order_relaxed)->next;
+    // Lookups already at e can still follow its next pointer.
+    link->store(e->next.load(std::memory_order_relaxed),
+                std::memory_order_release);
+}
+
+}  // namespace tuningfork
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "loadingtime_metric.h"
+
+namespace tuningfork {
+
+// Interns loading time metadata, mapping it to the compact id stored in
+// loading time MetricIds and back.
+//
+// Metadata is kept in a fixed array of hash chains whose nodes are never
+// modified once published, so looking up metadata that is already registered
+// doesn't lock. Ids index a table of fixed-size blocks, so the reverse lookup
+// done when serializing is O(1).
+//
+// Ids are recycled by Recycle(), which should be called each time a session
+// has been handed over for upload: metadata that wasn't used since the
+// previous call can't be referenced by a session still waiting to be
+// serialized, so its id is freed. Data recorded through an id that was looked
+// up earlier, e.g. with the handle of a live loading event, must be followed
+// by a call to Use().
+class LoadingTimeMetadataRegistry {
+   public:
+    static constexpr uint32_t kBlockSize = 256;
+    static constexpr uint32_t kMaxBlocks = 256;
+    // Id 0 is implicitly an empty LoadingTimeMetadata struct.
+    static constexpr uint32_t kMaxIds = kBlockSize * kMaxBlocks;
+    static constexpr uint32_t kNumBuckets = 8192;
+
+    LoadingTimeMetadataRegistry();
+    ~LoadingTimeMetadataRegistry();
+
+    // Return the id for metadata, registering it if needed.
+    // Returns TUNINGFORK_ERROR_NO_MORE_SPACE_FOR_LOADING_TIME_DATA if all ids
+    // are in use.
+    TuningFork_ErrorCode GetOrRegister(
+        const LoadingTimeMetadataWithGroup& metadata,
+        LoadingTimeMetadataId& id);
+
+    // Copy the metadata registered with id into md.
+    // Returns TUNINGFORK_ERROR_BAD_PARAMETER if id isn't registered.
+    TuningFork_ErrorCode Get(LoadingTimeMetadataId id,
+                             LoadingTimeMetadataWithGroup& md) const;
+
+    // Mark id as used by the current session, so that it isn't freed before
+    // that session is serialized.
+    // Returns TUNINGFORK_ERROR_BAD_PARAMETER if id isn't registered.
+    TuningFork_ErrorCode Use(LoadingTimeMetadataId id);
+
+    // Free the ids that weren't used since the last call, except for those in
+    // pinned, which are still referenced by live loading events. Pinned ids
+    // are kept until the next call, even if the loading events end before it.
+    void Recycle(const std::vector<LoadingTimeMetadataId>& pinned);
+
+    // Number of registered ids, not including id 0.
+    uint32_t Size() const { return size_.load(std::memory_order_relaxed); }
+
+   private:
+    struct Entry {
+        LoadingTimeMetadataWithGroup metadata;
+        size_t hash;
+        LoadingTimeMetadataId id;
+        std::atomic<Entry*> next{nullptr};
+        // Epoch of the last lookup.
+        std::atomic<uint64_t> last_used{0};
+        // Set while Recycle is freeing the entry.
+        std::atomic<bool> dead{false};
+    };
+    typedef std::atomic<Entry*> Slot;
+
+    Entry* Find(const LoadingTimeMetadataWithGroup& metadata,
+                size_t hash) const;
+    bool Touch(Entry* e) const;
+    // Raise the epoch of the last lookup of e to at least epoch.
+    static void MarkUsed(Entry* e, uint64_t epoch);
+    // Count a lock-free lookup or read, ended by decrementing readers_.
+    void StartRead() const;
+    Slot* IdSlot(LoadingTimeMetadataId id) const;
+    void Unlink(Entry* e);
+
+    std::unique_ptr<Slot[]> buckets_;
+    std::atomic<Slot*> blocks_[kMaxBlocks];
+    std::atomic<uint64_t> epoch_{0};
+    std::atomic<uint32_t> size_{0};
+    // Number of lock-free lookups and reads in progress.
+    mutable std::atomic<uint32_t> readers_{0};
+    std::mutex mutex_;
+    // The following are guarded by mutex_.
+    uint32_t next_id_ = 1;
+    std::vector<LoadingTimeMetadataId> free_ids_;
+    // Unlinked entries, deleted once no lock-free lookup could still be
+    // walking their chain.
+    std::vector<Entry*> retired_;
+};
+
+}  // namespace tuningfork
@@ -17,6 +17,8 @@
 
 #include "loadingtime_metric.h"
 
+#include <algorithm>
+
 namespace tuningfork {
 
 void LoadingTimeMetricData::Record(Duration dt) {
@@ -31,4 +33,43 @@ void LoadingTimeMetricData::Record(ProcessTimeInterval dt) {
     duration_ += dt.Duration();
 }
 
+Duration LoadingCriticalPath(const std::vector<ProcessTimeInterval>& intervals,
+                             std::vector<size_t>* chain) {
+    std::vector<size_t> order;
+    for (size_t i = 0; i < intervals.size(); ++i) {
+        if (!intervals[i].IsDuration()) order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return intervals[a].End() < intervals[b].End();
+    });
+    // longest[i] is the longest chain made of the first i intervals and
+    // previous[i] is the number of intervals that end before the i-th starts.
+    std::vector<Duration> longest(order.size() + 1, Duration::zero());
+    std::vector<size_t> previous(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        const auto& interval = intervals[order[i]];
+        previous[i] = std::upper_bound(order.begin(), order.begin() + i,
+                                       interval.Start(),
+                                       [&](ProcessTime t, size_t j) {
+                                           return t < intervals[j].End();
+                                       }) -
+                      order.begin();
+        longest[i + 1] = std::max(
+            longest[i], longest[previous[i]] + interval.Duration());
+    }
+    if (chain != nullptr) {
+        chain->clear();
+        for (size_t i = order.size(); i > 0;) {
+            if (longest[i] == longest[i - 1]) {
+                --i;
+            } else {
+                chain->push_back(order[i - 1]);
+                i = previous[i - 1];
+            }
+        }
+        std::reverse(chain->begin(), chain->end());
+    }
+    return longest.back();
+}
+
 }  // namespace tuningfork
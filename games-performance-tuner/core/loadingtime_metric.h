@@ -16,6 +16,9 @@
 
 #pragma once
 
+#include <vector>
+
+#include "loading_span_tree.h"
 #include "metricdata.h"
 #include "process_time.h"
 #include "settings.h"
@@ -35,15 +38,22 @@ struct LoadingTimeMetricData : public MetricData {
         : MetricData(MetricType()),
           metric_id_(metric_id),
           data_(kDefaultTimeSeriesCapacity),
-          duration_(Duration::zero()) {}
+          duration_(Duration::zero()),
+          critical_path_(Duration::zero()) {}
     MetricId metric_id_;
     TimeSeries<ProcessTimeInterval> data_;
     Duration duration_;
+    // For loading group events, the time on the critical path of the group.
+    Duration critical_path_;
+    // For loading group events, the analysis of the group's spans.
+    LoadingSpanSummary span_summary_;
     void Record(Duration dt);
     void Record(ProcessTimeInterval interval);
     virtual void Clear() override {
         data_.Clear();
         duration_ = Duration::zero();
+        critical_path_ = Duration::zero();
+        span_summary_ = {};
     }
     virtual size_t Count() const override { return data_.Count(); }
     static Metric::Type MetricType() { return Metric::Type::LOADING_TIME; }
@@ -52,6 +62,9 @@ struct LoadingTimeMetricData : public MetricData {
 struct LoadingTimeMetadataWithGroup {
     LoadingTimeMetadata metadata;
     std::string group_id;
+    // For loading group events, the id of the group that was current when the
+    // group was started.
+    std::string parent_group_id;
     bool operator==(const tuningfork::LoadingTimeMetadataWithGroup& rhs) const {
         const tuningfork::LoadingTimeMetadata& x = metadata;
         const tuningfork::LoadingTimeMetadata& y = rhs.metadata;
@@ -60,10 +73,19 @@ struct LoadingTimeMetadataWithGroup {
                x.network_connectivity == y.network_connectivity &&
                x.network_transfer_speed_bps == y.network_transfer_speed_bps &&
                x.network_latency_ns == y.network_latency_ns &&
-               group_id == rhs.group_id;
+               group_id == rhs.group_id &&
+               parent_group_id == rhs.parent_group_id;
     }
 };
 
+// The total duration of the longest chain of intervals in which each interval
+// ends before the next one starts. Loads that overlap happen in parallel, so
+// only the longest of them contributes.
+// If chain is non-null, the indices of the intervals in the chain are
+// returned in it, in order.
+Duration LoadingCriticalPath(const std::vector<ProcessTimeInterval>& intervals,
+                             std::vector<size_t>* chain = nullptr);
+
 }  // namespace tuningfork
 
 namespace std {
@@ -88,6 +110,7 @@ class hash<tuningfork::LoadingTimeMetadataWithGroup> {
         hash_combine(result, x.network_transfer_speed_bps);
         hash_combine(result, x.network_latency_ns);
         hash_combine(result, md.group_id);
+        hash_combine(result, md.parent_group_id);
         return result;
     }
 };
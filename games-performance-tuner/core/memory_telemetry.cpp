@@ -20,12 +20,8 @@
 #include <unistd.h>
 
 #include <chrono>
-#include <fstream>
-#include <iterator>
-#include <sstream>
 #include <unordered_map>
 #include <utility>
-#include <vector>
 
 #define LOG_TAG "TuningFork"
 #include <iostream>
@@ -33,6 +29,7 @@
 
 #include "Log.h"
 #include "jni.h"
+#include "procfs.h"
 #include "session.h"
 
 namespace tuningfork {
@@ -91,24 +88,24 @@ uint64_t DefaultMemInfoProvider::GetAvailMem() {
 
 // Add entries to the given memInfoMap structure, or update the entries if the
 // new value is higher.
-static void getMemInfoFromFile(memInfoMap &data, const std::string &path) {
-    std::ifstream file_stream(path);
-    if (!file_stream) {
-        ALOGE("Could not open %s", path.c_str());
+static void getMemInfoFromFile(memInfoMap &data, const char *path) {
+    gamesdk::procfs::LineReader reader(path);
+    if (!reader.IsOpen()) {
+        ALOGE("Could not open %s", path);
         return;
     }
-    for (std::string line; std::getline(file_stream, line);) {
-        std::istringstream ss(line);
-        std::vector<std::string> split(std::istream_iterator<std::string>{ss},
-                                       std::istream_iterator<std::string>());
-        if (split.size() == 3 && split[2] == "kB") {
-            std::string &key = split[0];
-            // Remove colon at end of first word
-            key.pop_back();
-            size_t value = atoi(split[1].c_str()) * BYTES_IN_KB;
-            if (data.find(key) == data.end() || data[key] < value) {
-                data[split[0]] = value;
-            }
+    gamesdk::procfs::Field field;
+    while (const char *line = reader.NextLine()) {
+        if (!gamesdk::procfs::ParseField(line, &field) || !field.in_kb) {
+            continue;
+        }
+        std::string key(field.key, field.key_length);
+        size_t value = field.number * BYTES_IN_KB;
+        auto it = data.find(key);
+        if (it == data.end()) {
+            data.emplace(std::move(key), value);
+        } else if (it->second < value) {
+            it->second = value;
         }
     }
 }
@@ -123,12 +120,12 @@ static std::pair<uint64_t, bool> getMemInfoValueFromData(
 }
 
 void DefaultMemInfoProvider::UpdateMemInfo() {
-    std::stringstream ss_path;
+    char path[gamesdk::procfs::kMaxPathLength];
     memInfoMap data;
 
     getMemInfoFromFile(data, "/proc/meminfo");
-    ss_path << "/proc/" << memInfo.pid << "/status";
-    getMemInfoFromFile(data, ss_path.str());
+    snprintf(path, sizeof(path), "/proc/%u/status", memInfo.pid);
+    getMemInfoFromFile(data, path);
 
     // For the time being, only swap total is being used.
     // Disabling the rest for efficiency
@@ -153,16 +150,13 @@ void DefaultMemInfoProvider::UpdateMemInfo() {
 }
 
 void DefaultMemInfoProvider::UpdateOomScore() {
-    std::stringstream ss_path;
-    ss_path << "/proc/" << memInfo.pid << "/oom_score";
-    std::ifstream oom_file(ss_path.str());
-    if (!oom_file) {
-        ALOGE_ONCE("Could not open %s", ss_path.str().c_str());
+    char path[gamesdk::procfs::kMaxPathLength];
+    snprintf(path, sizeof(path), "/proc/%u/oom_score", memInfo.pid);
+    int64_t oom_score;
+    if (gamesdk::procfs::ReadInt64(path, &oom_score)) {
+        memInfo.oom_score = static_cast<int>(oom_score);
     } else {
-        oom_file >> memInfo.oom_score;
-        if (!oom_file) {
-            ALOGE_ONCE("Bad conversion in %s", ss_path.str().c_str());
-        }
+        ALOGE_ONCE("Could not read %s", path);
     }
 }
 DefaultMemInfoProvider::DefaultMemInfoProvider() {
@@ -22,6 +22,7 @@
 #include <sstream>
 
 #include "jni/jni_wrap.h"
+#include "procfs.h"
 #include "system_utils.h"
 #include "tuningfork_utils.h"
 
@@ -32,16 +33,6 @@ using namespace gamesdk::jni;
 
 namespace {
 
-std::string slurpFile(const char* fname) {
-    std::ifstream f(fname);
-    if (f.good()) {
-        std::stringstream str;
-        str << f.rdbuf();
-        return str.str();
-    }
-    return "";
-}
-
 const char* skipSpace(const char* q) {
     while (*q && (*q == ' ' || *q == '\t')) ++q;
     return q;
@@ -92,14 +83,12 @@ RequestInfo RequestInfo::ForThisGameAndDevice(const Settings& settings) {
 
     info.cpu_max_freq_hz.clear();
     for (int index = 0;; ++index) {
-        std::stringstream str;
-        str << "/sys/devices/system/cpu/cpu" << index
-            << "/cpufreq/cpuinfo_max_freq";
-        auto cpu_freq_file = slurpFile(str.str().c_str());
-        if (cpu_freq_file.empty()) break;
-        uint64_t freq;
-        std::istringstream cstr(cpu_freq_file);
-        cstr >> freq;
+        char path[gamesdk::procfs::kMaxPathLength];
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq",
+                 index);
+        int64_t freq;
+        if (!gamesdk::procfs::ReadInt64(path, &freq)) break;
         info.cpu_max_freq_hz.push_back(freq * 1000);  // File is in kHz
     }
 
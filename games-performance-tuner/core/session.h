@@ -53,36 +53,18 @@ class Session {
     template <typename T>
     T* GetData(MetricId id) {
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = metric_data_.find(id);
-        if (it == metric_data_.end()) {
-            MetricData* d;
-            switch (T::MetricType()) {
-                case Metric::Type::FRAME_TIME:
-                    d = TakeFrameTimeData(id);
-                    break;
-                case Metric::Type::LOADING_TIME:
-                    d = TakeLoadingTimeData(id);
-                    break;
-                case Metric::Type::MEMORY:
-                    d = TakeMemoryData(id);
-                    break;
-                case Metric::Type::BATTERY:
-                    d = TakeBatteryData(id);
-                    break;
-                case Metric::Type::THERMAL:
-                    d = TakeThermalData(id);
-                    break;
-                case Metric::Type::ERROR:
-                    return nullptr;
-            }
-            if (d == nullptr) return nullptr;
-            metric_data_.insert({id, d});
-            return reinterpret_cast<T*>(d);
-        }
-        if (it->second->type == T::MetricType())
-            return reinterpret_cast<T*>(it->second);
-        else
-            return nullptr;
+        return GetDataLocked<T>(id);
+    }
+
+    // Record a frame time while holding the session lock, for metrics that
+    // can be recorded from several threads at once, like traces.
+    // Returns false if there is no frame time data left for this metric.
+    bool RecordFrameTime(MetricId id, Duration dt) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto h = GetDataLocked<FrameTimeMetricData>(id);
+        if (h == nullptr) return false;
+        h->Record(dt);
+        return true;
     }
 
     // Create a FrameTimeHistogram and add it to the available histograms.
@@ -144,6 +126,40 @@ class Session {
     }
 
    private:
+    template <typename T>
+    T* GetDataLocked(MetricId id) {
+        auto it = metric_data_.find(id);
+        if (it == metric_data_.end()) {
+            MetricData* d;
+            switch (T::MetricType()) {
+                case Metric::Type::FRAME_TIME:
+                    d = TakeFrameTimeData(id);
+                    break;
+                case Metric::Type::LOADING_TIME:
+                    d = TakeLoadingTimeData(id);
+                    break;
+                case Metric::Type::MEMORY:
+                    d = TakeMemoryData(id);
+                    break;
+                case Metric::Type::BATTERY:
+                    d = TakeBatteryData(id);
+                    break;
+                case Metric::Type::THERMAL:
+                    d = TakeThermalData(id);
+                    break;
+                case Metric::Type::ERROR:
+                    return nullptr;
+            }
+            if (d == nullptr) return nullptr;
+            metric_data_.insert({id, d});
+            return reinterpret_cast<T*>(d);
+        }
+        if (it->second->type == T::MetricType())
+            return reinterpret_cast<T*>(it->second);
+        else
+            return nullptr;
+    }
+
     // Get an available metric that has been set up to work with this id.
     FrameTimeMetricData* TakeFrameTimeData(MetricId id) {
         for (auto it = available_frame_time_data_.begin();
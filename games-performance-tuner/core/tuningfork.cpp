@@ -155,6 +155,23 @@ TuningFork_ErrorCode SetCurrentAnnotation(const ProtobufSerialization &ann) {
     }
 }
 
+TuningFork_ErrorCode RegisterAnnotation(const ProtobufSerialization &ann,
+                                        AnnotationHandle &handle) {
+    if (!s_impl) {
+        return TUNINGFORK_ERROR_TUNINGFORK_NOT_INITIALIZED;
+    } else {
+        return s_impl->RegisterAnnotation(ann, handle);
+    }
+}
+
+TuningFork_ErrorCode SetCurrentAnnotation(AnnotationHandle handle) {
+    if (!s_impl) {
+        return TUNINGFORK_ERROR_TUNINGFORK_NOT_INITIALIZED;
+    } else {
+        return s_impl->SetCurrentAnnotation(handle);
+    }
+}
+
 TuningFork_ErrorCode SetUploadCallback(TuningFork_UploadCallback cbk) {
     if (!s_impl) {
         return TUNINGFORK_ERROR_TUNINGFORK_NOT_INITIALIZED;
@@ -265,6 +282,22 @@ TuningFork_ErrorCode StopLoadingGroup(LoadingHandle handle) {
         return s_impl->StopLoadingGroup(handle);
 }
 
+TuningFork_ErrorCode BeginLoadingSpan(const std::string &name,
+                                      LoadingSpanHandle parent,
+                                      LoadingSpanHandle &handle) {
+    if (!s_impl)
+        return TUNINGFORK_ERROR_TUNINGFORK_NOT_INITIALIZED;
+    else
+        return s_impl->BeginLoadingSpan(name, parent, handle);
+}
+
+TuningFork_ErrorCode EndLoadingSpan(LoadingSpanHandle handle) {
+    if (!s_impl)
+        return TUNINGFORK_ERROR_TUNINGFORK_NOT_INITIALIZED;
+    else
+        return s_impl->EndLoadingSpan(handle);
+}
+
 TuningFork_ErrorCode ReportLifecycleEvent(TuningFork_LifecycleState state) {
     if (!s_impl)
         return TUNINGFORK_ERROR_TUNINGFORK_NOT_INITIALIZED;
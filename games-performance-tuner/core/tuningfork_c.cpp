@@ -82,6 +82,22 @@ TuningFork_ErrorCode TuningFork_setCurrentAnnotation(
         return TUNINGFORK_ERROR_INVALID_ANNOTATION;
 }
 
+// Register an annotation to be set by handle
+TuningFork_ErrorCode TuningFork_registerAnnotation(
+    const TuningFork_CProtobufSerialization *annotation,
+    TuningFork_AnnotationHandle *handle) {
+    if (annotation == nullptr || handle == nullptr)
+        return TUNINGFORK_ERROR_INVALID_ANNOTATION;
+    return tf::RegisterAnnotation(tf::ToProtobufSerialization(*annotation),
+                                  *handle);
+}
+
+// Set the current annotation from a registered handle
+TuningFork_ErrorCode TuningFork_setCurrentAnnotationHandle(
+    TuningFork_AnnotationHandle handle) {
+    return tf::SetCurrentAnnotation(handle);
+}
+
 // Record a frame tick that will be associated with the instrumentation key and
 // the current
 //   annotation
@@ -220,6 +236,19 @@ TuningFork_ErrorCode TuningFork_stopLoadingGroup(
     return tf::StopLoadingGroup(handle);
 }
 
+TuningFork_ErrorCode TuningFork_beginLoadingSpan(
+    const char *name, TuningFork_LoadingSpanHandle parent,
+    TuningFork_LoadingSpanHandle *handle) {
+    if (name == nullptr || handle == nullptr)
+        return TUNINGFORK_ERROR_BAD_PARAMETER;
+    return tf::BeginLoadingSpan(name, parent, *handle);
+}
+
+TuningFork_ErrorCode TuningFork_endLoadingSpan(
+    TuningFork_LoadingSpanHandle handle) {
+    return tf::EndLoadingSpan(handle);
+}
+
 void TUNINGFORK_VERSION_SYMBOL() {
     // Intentionally empty: this function is used to ensure that the proper
     // version of the library is linked against the proper headers.
@@ -49,7 +49,7 @@ TuningForkImpl::TuningForkImpl(const Settings &settings, IBackend *backend,
       trace_(gamesdk::Trace::create()),
       backend_(backend),
       upload_thread_(this),
-      current_annotation_id_(MetricId::FrameTime(0, 0)),
+      current_annotation_id_(0),
       time_provider_(time_provider),
       meminfo_provider_(meminfo_provider),
       battery_provider_(battery_provider),
@@ -131,8 +131,6 @@ TuningForkImpl::TuningForkImpl(const Settings &settings, IBackend *backend,
                                      settings.c_settings.max_num_metrics);
     }
     current_session_ = sessions_[0].get();
-    live_traces_.resize(max_num_frametime_metrics);
-    for (auto &t : live_traces_) t = TimePoint::min();
     auto crash_callback = [this]() -> bool {
         std::stringstream ss;
         ss << std::this_thread::get_id();
@@ -210,57 +208,67 @@ void TuningForkImpl::CreateSessionFrameHistograms(
 // Return the set annotation id or -1 if it could not be set
 MetricId TuningForkImpl::SetCurrentAnnotation(
     const ProtobufSerialization &annotation) {
-    current_annotation_ = annotation;
-    AnnotationId id;
-    SerializedAnnotationToAnnotationId(annotation, id);
-    if (id == annotation_util::kAnnotationError) {
+    AnnotationHandle handle;
+    if (RegisterAnnotation(annotation, handle) != TUNINGFORK_ERROR_OK) {
         ALOGW("Error setting annotation of size %zu", annotation.size());
-        current_annotation_id_ = MetricId::FrameTime(0, 0);
+        current_annotation_id_ = 0;
         return MetricId{annotation_util::kAnnotationError};
-    } else {
-        ALOGV("Set annotation id to %" PRIu32, id);
-        bool changed = current_annotation_id_.detail.annotation != id;
-        if (!changed) return current_annotation_id_;
-        if (trace_->isEnabled()) {
-            std::lock_guard<std::mutex> lock(trace_marker_cache_mutex_);
-            // Finish the last section if there was one and start a new one.
-            static constexpr int32_t kATraceAsyncCookie = 0x5eaf00d;
-            if (trace_started_) {
-                auto last_annotation = trace_marker_cache_.find(last_id_);
-                if (last_annotation == trace_marker_cache_.end()) {
-                    ALOGE("Annotation %u has vanished!", last_id_);
-                } else {
-                    trace_->endAsyncSection(last_annotation->second.c_str(),
-                                            kATraceAsyncCookie);
-                    trace_marker_cache_.erase(last_annotation);
-                }
-            } else {
-                trace_started_ = true;
-            }
-            // Guard against concurrent access to the cache
-            auto it = trace_marker_cache_.find(id);
-            if (it == trace_marker_cache_.end()) {
-                it = trace_marker_cache_
-                         .insert(
-                             {id, "APTAnnotation@" +
-                                      annotation_util::HumanReadableAnnotation(
-                                          annotation)})
-                         .first;
-            }
-            trace_->beginAsyncSection(it->second.c_str(), kATraceAsyncCookie);
-            last_id_ = id;
-        }
-        current_annotation_id_ = MetricId::FrameTime(id, 0);
-        if (battery_reporting_task_) {
-            battery_reporting_task_->UpdateMetricId(MetricId::Battery(id));
-        }
-        if (thermal_reporting_task_) {
-            thermal_reporting_task_->UpdateMetricId(MetricId::Thermal(id));
-        }
-        if (memory_reporting_task_) {
-            memory_reporting_task_->UpdateMetricId(MetricId::Memory(id));
+    }
+    SetCurrentAnnotation(handle);
+    AnnotationId id = current_annotation_id_.load(std::memory_order_relaxed);
+    ALOGV("Set annotation id to %" PRIu32, id);
+    return MetricId::FrameTime(id, 0);
+}
+
+TuningFork_ErrorCode TuningForkImpl::RegisterAnnotation(
+    const ProtobufSerialization &annotation, AnnotationHandle &handle) {
+    AnnotationId id;
+    SerializedAnnotationToAnnotationId(annotation, id);
+    if (id == annotation_util::kAnnotationError)
+        return TUNINGFORK_ERROR_INVALID_ANNOTATION;
+    return annotation_registry_.GetOrRegister(id, annotation, handle);
+}
+
+TuningFork_ErrorCode TuningForkImpl::SetCurrentAnnotation(
+    AnnotationHandle handle) {
+    const AnnotationRegistry::Entry *entry = annotation_registry_.Get(handle);
+    if (entry == nullptr) return TUNINGFORK_ERROR_INVALID_ANNOTATION;
+    if (current_annotation_id_.exchange(entry->id,
+                                        std::memory_order_relaxed) !=
+        entry->id) {
+        OnCurrentAnnotationChanged(*entry);
+    }
+    return TUNINGFORK_ERROR_OK;
+}
+
+void TuningForkImpl::OnCurrentAnnotationChanged(
+    const AnnotationRegistry::Entry &entry) {
+    std::lock_guard<std::mutex> lock(annotation_change_mutex_);
+    // If another thread has changed the annotation since, it will apply its
+    // own change after this one.
+    if (current_annotation_id_.load(std::memory_order_relaxed) != entry.id ||
+        last_changed_annotation_id_ == entry.id) {
+        return;
+    }
+    last_changed_annotation_id_ = entry.id;
+
+    if (trace_->isEnabled()) {
+        // Finish the last section if there was one and start a new one.
+        static constexpr int32_t kATraceAsyncCookie = 0x5eaf00d;
+        if (trace_marker_ != nullptr) {
+            trace_->endAsyncSection(trace_marker_->c_str(), kATraceAsyncCookie);
         }
-        return current_annotation_id_;
+        trace_marker_ = &entry.trace_marker;
+        trace_->beginAsyncSection(trace_marker_->c_str(), kATraceAsyncCookie);
+    }
+    if (battery_reporting_task_) {
+        battery_reporting_task_->UpdateMetricId(MetricId::Battery(entry.id));
+    }
+    if (thermal_reporting_task_) {
+        thermal_reporting_task_->UpdateMetricId(MetricId::Thermal(entry.id));
+    }
+    if (memory_reporting_task_) {
+        memory_reporting_task_->UpdateMetricId(MetricId::Memory(entry.id));
     }
 }
 
@@ -338,40 +346,39 @@ TuningFork_ErrorCode TuningForkImpl::StartTrace(InstrumentationKey key,
     if (Loading()) return TUNINGFORK_ERROR_OK;  // No recording when loading
 
     MetricId id{0};
-    auto err =
-        MakeCompoundId(key, current_annotation_id_.detail.annotation, id);
+    auto err = MakeCompoundId(
+        key, current_annotation_id_.load(std::memory_order_relaxed), id);
     if (err != TUNINGFORK_ERROR_OK) return err;
-    handle = id.detail.annotation *
-                 settings_.aggregation_strategy.max_instrumentation_keys +
-             id.detail.frame_time.ikey;
-    trace_->beginSection("TFTrace");
-    if (handle < live_traces_.size()) {
-        live_traces_[handle] = time_provider_->Now();
-        return TUNINGFORK_ERROR_OK;
-    } else {
-        return TUNINGFORK_ERROR_INVALID_ANNOTATION;
-    }
+    err = live_traces_.Start(id, time_provider_->Now(), handle);
+    if (err != TUNINGFORK_ERROR_OK) return err;
+    // Traces can end on another thread, so use async sections.
+    trace_->beginAsyncSection("TFTrace", LiveTraceTable::SlotIndex(handle));
+    return TUNINGFORK_ERROR_OK;
 }
 
 TuningFork_ErrorCode TuningForkImpl::EndTrace(TraceHandle h) {
-    if (Loading()) return TUNINGFORK_ERROR_OK;  // No recording when loading
-    if (h >= live_traces_.size()) return TUNINGFORK_ERROR_INVALID_TRACE_HANDLE;
-    auto i = live_traces_[h];
-    if (i != TimePoint::min()) {
-        trace_->endSection();
-        auto err = TraceNanos(MetricId{h}, time_provider_->Now() - i, nullptr);
-        live_traces_[h] = TimePoint::min();
-        return err;
-    } else {
-        return TUNINGFORK_ERROR_INVALID_TRACE_HANDLE;
+    MetricId id;
+    Duration dt;
+    // A trace started before loading must still free its slot.
+    auto err = live_traces_.End(h, time_provider_->Now(), id, dt);
+    if (err != TUNINGFORK_ERROR_OK) {
+        // StartTrace doesn't start traces while loading.
+        return Loading() ? TUNINGFORK_ERROR_OK : err;
     }
+    trace_->endAsyncSection("TFTrace", LiveTraceTable::SlotIndex(h));
+    if (Loading()) return TUNINGFORK_ERROR_OK;  // No recording when loading
+    if (logging_paused_) return TUNINGFORK_ERROR_OK;
+    // Traces of the same key can end on several threads at once.
+    if (!current_session_->RecordFrameTime(id, dt))
+        return TUNINGFORK_ERROR_NO_MORE_SPACE_FOR_FRAME_TIME_DATA;
+    return TUNINGFORK_ERROR_OK;
 }
 
 TuningFork_ErrorCode TuningForkImpl::FrameTick(InstrumentationKey key) {
     if (Loading()) return TUNINGFORK_ERROR_OK;  // No recording when loading
     MetricId id{0};
-    auto err =
-        MakeCompoundId(key, current_annotation_id_.detail.annotation, id);
+    auto err = MakeCompoundId(
+        key, current_annotation_id_.load(std::memory_order_relaxed), id);
     if (err != TUNINGFORK_ERROR_OK) return err;
     trace_->beginSection("TFTick");
     current_session_->Ping(time_provider_->SystemNow());
@@ -388,8 +395,8 @@ TuningFork_ErrorCode TuningForkImpl::FrameDeltaTimeNanos(InstrumentationKey key,
                                                          Duration dt) {
     if (Loading()) return TUNINGFORK_ERROR_OK;  // No recording when loading
     MetricId id{0};
-    auto err =
-        MakeCompoundId(key, current_annotation_id_.detail.annotation, id);
+    auto err = MakeCompoundId(
+        key, current_annotation_id_.load(std::memory_order_relaxed), id);
     if (err != TUNINGFORK_ERROR_OK) return err;
     MetricData *p;
     err = TraceNanos(id, dt, &p);
@@ -563,11 +570,35 @@ void TuningForkImpl::SwapSessions() {
         async_telemetry_->SetSession(current_session_);
     }
 }
+
+// Called after a session was submitted, which means that the one submitted
+// before it has been serialized and no longer needs its loading time metadata.
+// This is done before swapping sessions so that metadata used after it is
+// always recorded in the next session.
+void TuningForkImpl::RecycleLoadingTimeMetadata() {
+    std::vector<LoadingTimeMetadataId> pinned;
+    {
+        std::lock_guard<std::mutex> lock(live_loading_events_mutex_);
+        for (auto &a : live_loading_events_) {
+            pinned.push_back(MetricId{a.first}.detail.loading_time.metadata);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(live_loading_groups_mutex_);
+        for (auto &group : live_loading_groups_) {
+            pinned.push_back(
+                MetricId{group.handle}.detail.loading_time.metadata);
+        }
+    }
+    loading_time_metadata_registry_.Recycle(pinned);
+}
+
 TuningFork_ErrorCode TuningForkImpl::Flush(TimePoint t, bool upload) {
     ALOGV("Flush %d", upload);
     TuningFork_ErrorCode ret_code;
     current_session_->SetInstrumentationKeys(ikeys_);
     if (upload_thread_.Submit(current_session_, upload)) {
+        RecycleLoadingTimeMetadata();
         SwapSessions();
         ret_code = TUNINGFORK_ERROR_OK;
     } else {
@@ -662,45 +693,34 @@ TuningFork_ErrorCode TuningForkImpl::LoadingTimeMetadataToId(
             TuningFork_LoadingTimeMetadata::UNKNOWN_STATE ||
         metadata.metadata.state > TuningFork_LoadingTimeMetadata::INTER_LEVEL)
         return TUNINGFORK_ERROR_INVALID_LOADING_STATE;
-    std::lock_guard<std::mutex> lock(loading_time_metadata_map_mutex_);
-    auto it = loading_time_metadata_map_.find(metadata);
-    if (it != loading_time_metadata_map_.end()) {
-        id = it->second;
-    } else {
-        id = loading_time_metadata_next_id_++;
-        loading_time_metadata_map_.insert({metadata, id});
-    }
-    return TUNINGFORK_ERROR_OK;
+    return loading_time_metadata_registry_.GetOrRegister(metadata, id);
 }
 
 TuningFork_ErrorCode TuningForkImpl::MetricIdToLoadingTimeMetadata(
     MetricId id, LoadingTimeMetadataWithGroup &md) {
-    std::lock_guard<std::mutex> lock(loading_time_metadata_map_mutex_);
-    auto metadata_id = id.detail.loading_time.metadata;
-    for (auto &m : loading_time_metadata_map_) {
-        if (m.second == metadata_id) {
-            md = m.first;
-            return TUNINGFORK_ERROR_OK;
-        }
-    }
-    return TUNINGFORK_ERROR_BAD_PARAMETER;
+    return loading_time_metadata_registry_.Get(
+        id.detail.loading_time.metadata, md);
 }
 
 TuningFork_ErrorCode TuningForkImpl::RecordLoadingTime(
     Duration duration, const LoadingTimeMetadata &metadata,
     const ProtobufSerialization &annotation, bool relativeToStart) {
     LoadingTimeMetadataId metadata_id;
-    LoadingTimeMetadataWithGroup metadata_with_group_id{
-        metadata, relativeToStart ? "" : current_loading_group_};
-    if (LoadingTimeMetadataToId(metadata_with_group_id, metadata_id) !=
-        TUNINGFORK_ERROR_OK) {
+    LoadingTimeMetadataWithGroup metadata_with_group_id{metadata};
+    if (!relativeToStart) {
+        std::lock_guard<std::mutex> lock(live_loading_groups_mutex_);
+        auto group = CurrentLoadingGroup();
+        if (group != nullptr) metadata_with_group_id.group_id = group->id;
+    }
+    auto err = LoadingTimeMetadataToId(metadata_with_group_id, metadata_id);
+    if (err == TUNINGFORK_ERROR_INVALID_LOADING_STATE) {
         ALOGW_ONCE_IF(
             true,
             "You must set the loading state when using RecordLoadingTime");
-        return TUNINGFORK_ERROR_INVALID_LOADING_STATE;
     }
+    if (err != TUNINGFORK_ERROR_OK) return err;
     AnnotationId ann_id = 0;
-    auto err = SerializedAnnotationToAnnotationId(annotation, ann_id);
+    err = SerializedAnnotationToAnnotationId(annotation, ann_id);
     if (err != TUNINGFORK_ERROR_OK) return err;
     auto metric_id = MetricId::LoadingTime(ann_id, metadata_id);
     auto data = current_session_->GetData<LoadingTimeMetricData>(metric_id);
@@ -710,6 +730,8 @@ TuningFork_ErrorCode TuningForkImpl::RecordLoadingTime(
         data->Record({std::chrono::nanoseconds(0), duration});
     else
         data->Record(duration);
+    // A Flush since the lookup may have swapped the session recorded into.
+    loading_time_metadata_registry_.Use(metadata_id);
     return TUNINGFORK_ERROR_OK;
 }
 
@@ -717,24 +739,35 @@ TuningFork_ErrorCode TuningForkImpl::StartRecordingLoadingTime(
     const LoadingTimeMetadata &metadata,
     const ProtobufSerialization &annotation, LoadingHandle &handle) {
     LoadingTimeMetadataId metadata_id;
-    LoadingTimeMetadataWithGroup metadata_with_group_id{metadata,
-                                                        current_loading_group_};
-    if (LoadingTimeMetadataToId(metadata_with_group_id, metadata_id) !=
-        TUNINGFORK_ERROR_OK) {
+    LoadingTimeMetadataWithGroup metadata_with_group_id{metadata};
+    LoadingHandle group_handle = 0;
+    {
+        std::lock_guard<std::mutex> lock(live_loading_groups_mutex_);
+        auto group = CurrentLoadingGroup();
+        if (group != nullptr) {
+            metadata_with_group_id.group_id = group->id;
+            group_handle = group->handle;
+        }
+    }
+    auto err = LoadingTimeMetadataToId(metadata_with_group_id, metadata_id);
+    if (err == TUNINGFORK_ERROR_INVALID_LOADING_STATE) {
         ALOGW_ONCE_IF(true,
                       "You must set the loading state when using "
                       "StartRecordingLoadingTime");
-        return TUNINGFORK_ERROR_INVALID_LOADING_STATE;
     }
+    if (err != TUNINGFORK_ERROR_OK) return err;
     AnnotationId ann_id = 0;
-    auto err = SerializedAnnotationToAnnotationId(annotation, ann_id);
+    err = SerializedAnnotationToAnnotationId(annotation, ann_id);
     if (err != TUNINGFORK_ERROR_OK) return err;
     auto metric_id = MetricId::LoadingTime(ann_id, metadata_id);
     handle = metric_id.base;
     std::lock_guard<std::mutex> lock(live_loading_events_mutex_);
     if (live_loading_events_.find(handle) != live_loading_events_.end())
         return TUNINGFORK_ERROR_DUPLICATE_START_LOADING_EVENT;
-    live_loading_events_[handle] = time_provider_->TimeSinceProcessStart();
+    live_loading_events_[handle] = {time_provider_->TimeSinceProcessStart(),
+                                    group_handle};
+    num_live_loading_events_.store(live_loading_events_.size(),
+                                   std::memory_order_relaxed);
     return TUNINGFORK_ERROR_OK;
 }
 
@@ -746,20 +779,28 @@ TuningFork_ErrorCode TuningForkImpl::RecordLoadingTime(
     if (data == nullptr)
         return TUNINGFORK_ERROR_NO_MORE_SPACE_FOR_LOADING_TIME_DATA;
     data->Record(interval);
+    // The metadata was looked up when the loading event started, so tell the
+    // registry that the current session now references it.
+    loading_time_metadata_registry_.Use(metric_id.detail.loading_time.metadata);
     return TUNINGFORK_ERROR_OK;
 }
 
 TuningFork_ErrorCode TuningForkImpl::StopRecordingLoadingTime(
     LoadingHandle handle) {
     ProcessTimeInterval interval;
+    LoadingHandle group;
     {
         std::lock_guard<std::mutex> lock(live_loading_events_mutex_);
         auto it = live_loading_events_.find(handle);
         if (it == live_loading_events_.end())
             return TUNINGFORK_ERROR_INVALID_LOADING_HANDLE;
-        interval = {it->second, time_provider_->TimeSinceProcessStart()};
+        interval = {it->second.start, time_provider_->TimeSinceProcessStart()};
+        group = it->second.group;
         live_loading_events_.erase(it);
+        num_live_loading_events_.store(live_loading_events_.size(),
+                                       std::memory_order_relaxed);
     }
+    AddToLoadingGroup(group, interval);
     return RecordLoadingTime(handle, interval);
 }
 
@@ -776,15 +817,24 @@ TuningFork_ErrorCode TuningForkImpl::StartLoadingGroup(
     auto new_loading_group = UniqueId();
     metadata_in.metadata.source = LoadingSource::TOTAL_USER_WAIT_FOR_GROUP;
     metadata_in.group_id = new_loading_group;
-    if (LoadingTimeMetadataToId(metadata_in, metadata_id) !=
-        TUNINGFORK_ERROR_OK) {
+    LoadingHandle parent = 0;
+    {
+        std::lock_guard<std::mutex> lock(live_loading_groups_mutex_);
+        auto group = CurrentLoadingGroup();
+        if (group != nullptr) {
+            metadata_in.parent_group_id = group->id;
+            parent = group->handle;
+        }
+    }
+    auto err = LoadingTimeMetadataToId(metadata_in, metadata_id);
+    if (err == TUNINGFORK_ERROR_INVALID_LOADING_STATE) {
         ALOGW_ONCE_IF(
             true,
             "You must set the loading state when using StartLoadingGroup");
-        return TUNINGFORK_ERROR_INVALID_LOADING_STATE;
     }
+    if (err != TUNINGFORK_ERROR_OK) return err;
     if (pAnnotation != nullptr) {
-        auto err = SerializedAnnotationToAnnotationId(*pAnnotation, ann_id);
+        err = SerializedAnnotationToAnnotationId(*pAnnotation, ann_id);
         if (err != TUNINGFORK_ERROR_OK) return err;
     }
     auto metric_id = MetricId::LoadingTime(ann_id, metadata_id);
@@ -792,41 +842,150 @@ TuningFork_ErrorCode TuningForkImpl::StartLoadingGroup(
     if (pHandle != nullptr) {
         *pHandle = handle;
     }
-    current_loading_group_ = new_loading_group;
-    current_loading_group_metric_ = metric_id;
-    current_loading_group_start_time_ = time_provider_->TimeSinceProcessStart();
+    std::lock_guard<std::mutex> lock(live_loading_groups_mutex_);
+    if (live_loading_groups_.size() >= kMaxLiveLoadingGroups) {
+        ALOGW_ONCE_IF(true,
+                      "Too many loading groups: abandoning the oldest one. "
+                      "Did you forget to call StopLoadingGroup?");
+        live_loading_groups_.erase(live_loading_groups_.begin());
+    }
+    live_loading_groups_.push_back({handle, next_loading_group_serial_++,
+                                    new_loading_group, parent,
+                                    std::this_thread::get_id(),
+                                    time_provider_->TimeSinceProcessStart()});
     return TUNINGFORK_ERROR_OK;
 }
 
 TuningFork_ErrorCode TuningForkImpl::StopLoadingGroup(LoadingHandle handle) {
-    if (handle == 0) {
-        // This happens when there is no active loading group e.g.,
-        // because StartLoadingGroup failed.
-        if (current_loading_group_metric_.base == 0)
-            return TUNINGFORK_ERROR_NO_ACTIVE_LOADING_GROUP;
-        handle = current_loading_group_metric_.base;
-    }
-    if (current_loading_group_metric_.base != handle) {
-        return TUNINGFORK_ERROR_BAD_PARAMETER;
+    ProcessTimeInterval interval;
+    std::vector<ProcessTimeInterval> intervals;
+    std::unique_ptr<LoadingSpanTree> spans;
+    {
+        std::lock_guard<std::mutex> lock(live_loading_groups_mutex_);
+        auto group = handle == 0 ? CurrentLoadingGroup()
+                                 : FindLoadingGroup(handle);
+        if (group == nullptr) {
+            // This happens when there is no active loading group e.g.,
+            // because StartLoadingGroup failed.
+            if (handle == 0) return TUNINGFORK_ERROR_NO_ACTIVE_LOADING_GROUP;
+            return TUNINGFORK_ERROR_BAD_PARAMETER;
+        }
+        handle = group->handle;
+        interval = {group->start, time_provider_->TimeSinceProcessStart()};
+        intervals = std::move(group->intervals);
+        spans = std::move(group->spans);
+        auto parent = FindLoadingGroup(group->parent);
+        if (parent != nullptr) parent->intervals.push_back(interval);
+        live_loading_groups_.erase(live_loading_groups_.begin() +
+                                   (group - live_loading_groups_.data()));
     }
-    ProcessTimeInterval interval = {current_loading_group_start_time_,
-                                    time_provider_->TimeSinceProcessStart()};
-    current_loading_group_metric_.base = 0;
-    current_loading_group_.clear();
-    current_loading_group_start_time_ = {};
-    return RecordLoadingTime(handle, interval);
+    auto err = RecordLoadingTime(handle, interval);
+    if (err != TUNINGFORK_ERROR_OK) return err;
+    auto data = current_session_->GetData<LoadingTimeMetricData>(handle);
+    if (data != nullptr) {
+        data->critical_path_ += LoadingCriticalPath(intervals);
+        if (spans) {
+            data->span_summary_ =
+                spans->Summarize(interval.End(), kMaxUploadedLoadingSpans);
+        }
+    }
+    return TUNINGFORK_ERROR_OK;
+}
+
+// Span handles are made of the serial number of the group in the high 32 bits
+// and the id of the span in its tree in the low ones.
+TuningFork_ErrorCode TuningForkImpl::BeginLoadingSpan(
+    const std::string &name, LoadingSpanHandle parent,
+    LoadingSpanHandle &handle) {
+    std::lock_guard<std::mutex> lock(live_loading_groups_mutex_);
+    LoadingGroup *group;
+    LoadingSpanTree::SpanId parent_span = LoadingSpanTree::kRoot;
+    if (parent == 0) {
+        group = CurrentLoadingGroup();
+        if (group == nullptr) return TUNINGFORK_ERROR_NO_ACTIVE_LOADING_GROUP;
+    } else {
+        group = FindLoadingSpan(parent, parent_span);
+        if (group == nullptr) return TUNINGFORK_ERROR_INVALID_LOADING_HANDLE;
+    }
+    if (!group->spans) group->spans.reset(new LoadingSpanTree(group->start));
+    LoadingSpanTree::SpanId span;
+    auto err = group->spans->Begin(name, parent_span,
+                                   time_provider_->TimeSinceProcessStart(),
+                                   span);
+    if (err != TUNINGFORK_ERROR_OK) return err;
+    handle = (static_cast<LoadingSpanHandle>(group->serial) << 32) | span;
+    return TUNINGFORK_ERROR_OK;
+}
+
+TuningFork_ErrorCode TuningForkImpl::EndLoadingSpan(LoadingSpanHandle handle) {
+    std::lock_guard<std::mutex> lock(live_loading_groups_mutex_);
+    LoadingSpanTree::SpanId span;
+    auto group = FindLoadingSpan(handle, span);
+    if (group == nullptr) return TUNINGFORK_ERROR_INVALID_LOADING_HANDLE;
+    return group->spans->End(span, time_provider_->TimeSinceProcessStart());
+}
+
+TuningForkImpl::LoadingGroup *TuningForkImpl::FindLoadingSpan(
+    LoadingSpanHandle handle, LoadingSpanTree::SpanId &span) {
+    uint32_t serial = handle >> 32;
+    span = static_cast<LoadingSpanTree::SpanId>(handle);
+    for (auto &group : live_loading_groups_) {
+        if (group.serial == serial) {
+            if (!group.spans || span == LoadingSpanTree::kRoot ||
+                span > group.spans->Size())
+                return nullptr;
+            return &group;
+        }
+    }
+    return nullptr;
+}
+
+TuningForkImpl::LoadingGroup *TuningForkImpl::CurrentLoadingGroup() {
+    if (live_loading_groups_.empty()) return nullptr;
+    auto innermost = [this](std::thread::id thread) -> LoadingGroup * {
+        for (auto it = live_loading_groups_.rbegin();
+             it != live_loading_groups_.rend(); ++it) {
+            if (it->thread == thread) return &*it;
+        }
+        return nullptr;
+    };
+    auto group = innermost(std::this_thread::get_id());
+    if (group != nullptr) return group;
+    // Groups started on other threads, e.g. for loads streamed in parallel,
+    // are children of the group that is current on the thread of the
+    // outermost group, usually the main thread.
+    return innermost(live_loading_groups_.front().thread);
+}
+
+TuningForkImpl::LoadingGroup *TuningForkImpl::FindLoadingGroup(
+    LoadingHandle handle) {
+    if (handle == 0) return nullptr;
+    for (auto &group : live_loading_groups_) {
+        if (group.handle == handle) return &group;
+    }
+    return nullptr;
+}
+
+void TuningForkImpl::AddToLoadingGroup(LoadingHandle handle,
+                                       ProcessTimeInterval interval) {
+    std::lock_guard<std::mutex> lock(live_loading_groups_mutex_);
+    auto group = FindLoadingGroup(handle);
+    if (group != nullptr) group->intervals.push_back(interval);
 }
 
 std::vector<LifecycleLoadingEvent> TuningForkImpl::GetLiveLoadingEvents() {
     std::vector<LifecycleLoadingEvent> ret;
     auto current_time = time_provider_->TimeSinceProcessStart();
-    for (auto &a : live_loading_events_) {
-        ret.push_back({a.first, {a.second, current_time}});
+    {
+        std::lock_guard<std::mutex> lock(live_loading_events_mutex_);
+        for (auto &a : live_loading_events_) {
+            ret.push_back({a.first, {a.second.start, current_time}});
+        }
     }
-    // Add the event group event too
-    if (current_loading_group_metric_.base != 0) {
-        ret.push_back({current_loading_group_metric_.base,
-                       {current_loading_group_start_time_, current_time}});
+    // Add the event group events too
+    std::lock_guard<std::mutex> lock(live_loading_groups_mutex_);
+    for (auto &group : live_loading_groups_) {
+        ret.push_back({group.handle, {group.start, current_time}});
     }
     return ret;
 }
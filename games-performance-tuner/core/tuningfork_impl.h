@@ -17,15 +17,21 @@
 #include <atomic>
 #include <map>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include "Trace.h"
 #include "activity_lifecycle_state.h"
 #include "annotation_map.h"
+#include "annotation_registry.h"
 #include "async_telemetry.h"
 #include "battery_metric.h"
 #include "battery_reporting_task.h"
 #include "crash_handler.h"
 #include "http_backend/http_backend.h"
+#include "live_trace_table.h"
+#include "loading_span_tree.h"
+#include "loading_time_metadata_registry.h"
 #include "meminfo_provider.h"
 #include "memory_telemetry.h"
 #include "session.h"
@@ -46,12 +52,12 @@ class TuningForkImpl : public IdProvider {
     Session *current_session_ = nullptr;
     TimePoint last_submit_time_ = TimePoint::min();
     std::unique_ptr<gamesdk::Trace> trace_;
-    std::vector<TimePoint> live_traces_;
+    LiveTraceTable live_traces_;
     IBackend *backend_;
     UploadThread upload_thread_;
-    SerializedAnnotation current_annotation_;
     std::vector<uint32_t> annotation_radix_mult_;
-    MetricId current_annotation_id_;
+    // Set with a single atomic exchange: see SetCurrentAnnotation.
+    std::atomic<AnnotationId> current_annotation_id_;
     ITimeProvider *time_provider_ = nullptr;
     IMemInfoProvider *meminfo_provider_ = nullptr;
     IBatteryProvider *battery_provider_ = nullptr;
@@ -59,17 +65,21 @@ class TuningForkImpl : public IdProvider {
     std::atomic<int> next_ikey_;
     std::unique_ptr<ProtobufSerialization> training_mode_params_;
     std::unique_ptr<AsyncTelemetry> async_telemetry_;
-    LoadingTimeMetadataId loading_time_metadata_next_id_ =
-        1;  // 0 is implicitly an empty LoadingTimeMetadata struct
-    std::mutex loading_time_metadata_map_mutex_;
-    std::unordered_map<LoadingTimeMetadataWithGroup, LoadingTimeMetadataId>
-        loading_time_metadata_map_;
+    LoadingTimeMetadataRegistry loading_time_metadata_registry_;
     ActivityLifecycleState activity_lifecycle_state_;
     bool before_first_tick_ = true;
     bool app_first_run_ = true;
-    std::unordered_map<LoadingHandle, ProcessTime> live_loading_events_;
+    struct LiveLoadingEvent {
+        ProcessTime start;
+        // The loading group that was current when the event started, or 0.
+        LoadingHandle group;
+    };
+    std::unordered_map<LoadingHandle, LiveLoadingEvent> live_loading_events_;
     std::mutex live_loading_events_mutex_;
+    // Size of live_loading_events_, read without the lock on every tick.
+    std::atomic<size_t> num_live_loading_events_{0};
     AnnotationMap annotation_map_;
+    AnnotationRegistry annotation_registry_;
     std::shared_ptr<BatteryReportingTask> battery_reporting_task_;
     std::shared_ptr<ThermalReportingTask> thermal_reporting_task_;
     std::shared_ptr<MemoryReportingTask> memory_reporting_task_;
@@ -84,15 +94,34 @@ class TuningForkImpl : public IdProvider {
     bool lifecycle_stop_event_sent_ = false;
     bool logging_paused_ = false;
 
-    std::string current_loading_group_;
-    MetricId current_loading_group_metric_;
-    Duration current_loading_group_start_time_ = Duration::zero();
-
-    // Caching of ATrace markers
-    bool trace_started_ = false;
-    std::mutex trace_marker_cache_mutex_;
-    std::map<AnnotationId, std::string> trace_marker_cache_;
-    AnnotationId last_id_;
+    struct LoadingGroup {
+        LoadingHandle handle;
+        // Identifies the group in span handles.
+        uint32_t serial;
+        std::string id;
+        // The group that was current when this one started, or 0.
+        LoadingHandle parent;
+        std::thread::id thread;
+        ProcessTime start;
+        // Intervals of the loading events and child groups that finished
+        // while the group was live.
+        std::vector<ProcessTimeInterval> intervals;
+        // Only allocated if spans are recorded in the group.
+        std::unique_ptr<LoadingSpanTree> spans;
+    };
+    static constexpr size_t kMaxLiveLoadingGroups = 32;
+    static constexpr size_t kMaxUploadedLoadingSpans = 5;
+    uint32_t next_loading_group_serial_ = 0;
+    // Groups that have been started and not stopped, in the order they were
+    // started.
+    std::vector<LoadingGroup> live_loading_groups_;
+    std::mutex live_loading_groups_mutex_;
+
+    // Serializes the side effects of changing the current annotation
+    std::mutex annotation_change_mutex_;
+    AnnotationId last_changed_annotation_id_ = 0;
+    // ATrace section of the current annotation, owned by annotation_registry_
+    const std::string *trace_marker_ = nullptr;
 
    public:
     TuningForkImpl(const Settings &settings, IBackend *backend,
@@ -120,6 +149,11 @@ class TuningForkImpl : public IdProvider {
     // Returns the set annotation id or -1 if it could not be set
     MetricId SetCurrentAnnotation(const ProtobufSerialization &annotation);
 
+    TuningFork_ErrorCode RegisterAnnotation(
+        const ProtobufSerialization &annotation, AnnotationHandle &handle);
+
+    TuningFork_ErrorCode SetCurrentAnnotation(AnnotationHandle handle);
+
     TuningFork_ErrorCode FrameTick(InstrumentationKey id);
 
     TuningFork_ErrorCode FrameDeltaTimeNanos(InstrumentationKey id,
@@ -166,6 +200,12 @@ class TuningForkImpl : public IdProvider {
 
     TuningFork_ErrorCode StopLoadingGroup(LoadingHandle handle);
 
+    TuningFork_ErrorCode BeginLoadingSpan(const std::string &name,
+                                          LoadingSpanHandle parent,
+                                          LoadingSpanHandle &handle);
+
+    TuningFork_ErrorCode EndLoadingSpan(LoadingSpanHandle handle);
+
     TuningFork_ErrorCode ReportLifecycleEvent(TuningFork_LifecycleState state);
 
     TuningFork_ErrorCode InitializationErrorCode() {
@@ -192,6 +232,10 @@ class TuningForkImpl : public IdProvider {
 
     bool ShouldSubmit(TimePoint t, MetricData *metric_data);
 
+    // Update the telemetry tasks and the ATrace section after the current
+    // annotation was changed to entry.
+    void OnCurrentAnnotationChanged(const AnnotationRegistry::Entry &entry);
+
     TuningFork_ErrorCode SerializedAnnotationToAnnotationId(
         const SerializedAnnotation &ser, AnnotationId &id) override;
 
@@ -216,10 +260,28 @@ class TuningForkImpl : public IdProvider {
     TuningFork_ErrorCode GetOrCreateInstrumentKeyIndex(InstrumentationKey key,
                                                        int &index);
 
-    bool Loading() const { return live_loading_events_.size() > 0; }
+    bool Loading() const {
+        return num_live_loading_events_.load(std::memory_order_relaxed) > 0;
+    }
+
+    // The innermost live group started on this thread or, if there is none,
+    // on the thread that started the oldest live group.
+    // Requires live_loading_groups_mutex_.
+    LoadingGroup *CurrentLoadingGroup();
+
+    LoadingGroup *FindLoadingGroup(LoadingHandle handle);
+
+    // Find the group and span that handle refers to.
+    // Requires live_loading_groups_mutex_.
+    LoadingGroup *FindLoadingSpan(LoadingSpanHandle handle,
+                                  LoadingSpanTree::SpanId &span);
+
+    void AddToLoadingGroup(LoadingHandle group, ProcessTimeInterval interval);
 
     void SwapSessions();
 
+    void RecycleLoadingTimeMetadata();
+
     bool Debugging() const;
 
     void InitAsyncTelemetry();
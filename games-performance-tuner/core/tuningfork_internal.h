@@ -69,6 +69,13 @@ TuningFork_ErrorCode GetFidelityParameters(
 TuningFork_ErrorCode SetCurrentAnnotation(
     const ProtobufSerialization& annotation);
 
+// Register an annotation, returning a handle that can be used to set it
+TuningFork_ErrorCode RegisterAnnotation(const ProtobufSerialization& annotation,
+                                        AnnotationHandle& handle);
+
+// Set the current annotation from a registered handle
+TuningFork_ErrorCode SetCurrentAnnotation(AnnotationHandle handle);
+
 // Record a frame tick that will be associated with the instrumentation key and
 // the current
 //   annotation
@@ -132,9 +139,18 @@ TuningFork_ErrorCode StartLoadingGroup(const LoadingTimeMetadata* metadata,
                                        LoadingHandle* handle);
 
 // Stop a loading group.
-// handle should be null in current implementation.
+// handle is 0 to stop the current group.
 TuningFork_ErrorCode StopLoadingGroup(LoadingHandle handle);
 
+// Begin a span in a loading group, as a child of parent or, if it is 0, as a
+// top-level span of the current group.
+TuningFork_ErrorCode BeginLoadingSpan(const std::string& name,
+                                      LoadingSpanHandle parent,
+                                      LoadingSpanHandle& handle);
+
+// End a loading span.
+TuningFork_ErrorCode EndLoadingSpan(LoadingSpanHandle handle);
+
 TuningFork_ErrorCode ReportLifecycleEvent(TuningFork_LifecycleState state);
 
 // Check if we have recorded a file in the app's cache dir yet.
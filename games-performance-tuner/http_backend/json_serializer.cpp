@@ -178,6 +178,8 @@ Json::object JsonSerializer::LoadingTimeMetadataJson(
         ret["network_info"] = network_info;
     }
     if (!mdg.group_id.empty()) ret["group_id"] = mdg.group_id;
+    if (!mdg.parent_group_id.empty())
+        ret["parent_group_id"] = mdg.parent_group_id;
     return ret;
 }
 
@@ -192,6 +194,30 @@ static Json::array SerializeIntervalVector(
     return result;
 }
 
+static Json::object SerializeLoadingSpanSummary(
+    const LoadingSpanSummary& summary) {
+    Json::array slowest_spans;
+    for (const auto& span : summary.slowest_spans) {
+        Json::object o{
+            {"name", span.name},
+            {"start", DurationToSecondsString(span.interval.Start())},
+            {"end", DurationToSecondsString(span.interval.End())},
+            {"self_time", DurationToSecondsString(span.self_time)},
+            {"depth", static_cast<int>(span.depth)}};
+        if (span.on_critical_path) o["on_critical_path"] = true;
+        slowest_spans.push_back(o);
+    }
+    Json::object ret{
+        {"span_count", static_cast<int>(summary.span_count)},
+        {"max_depth", static_cast<int>(summary.max_depth)},
+        {"critical_path", DurationToSecondsString(summary.critical_path)},
+        {"parallelism", summary.parallelism},
+        {"slowest_spans", slowest_spans}};
+    if (summary.dropped_spans > 0)
+        ret["dropped_spans"] = static_cast<int>(summary.dropped_spans);
+    return ret;
+}
+
 Json::object JsonSerializer::TelemetryReportJson(const AnnotationId& annotation,
                                                  bool& empty,
                                                  Duration& duration) {
@@ -243,6 +269,12 @@ Json::object JsonSerializer::TelemetryReportJson(const AnnotationId& annotation,
                     o["intervals"] =
                         SerializeIntervalVector(loading_events_intervals);
                 o["loading_metadata"] = LoadingTimeMetadataJson(md);
+                if (th->critical_path_ > Duration::zero())
+                    o["critical_path"] =
+                        DurationToSecondsString(th->critical_path_);
+                if (th->span_summary_.span_count > 0)
+                    o["span_summary"] =
+                        SerializeLoadingSpanSummary(th->span_summary_);
                 loading_events.push_back(o);
             }
         }
@@ -71,6 +71,7 @@ struct ProtoDataHolder {
 
         void addCopy(const char* newString);
         bool has(const char* element);
+        void addAll(const StringVector& other);
 
         // Forbid implicit copy.
         StringVector(const StringVector&) = delete;
@@ -148,4 +149,12 @@ struct ProtoDataHolder {
 int createProto(androidgamesdk_deviceinfo_GameSdkDeviceInfoWithErrors& proto,
                 ProtoDataHolder& dataHolder);
 
+// Serializes the proto from createProto into result.
+// If cacheFileName is not null, a proto cached there is used when it was
+// collected by this version of the library since the last system update, and
+// a newly collected proto without errors is cached there.
+// Returns true on success.
+bool createSerializedProto(const char* cacheFileName,
+                           ProtoDataHolder::Array<uint8_t>& result);
+
 }  // namespace androidgamesdk_deviceinfo
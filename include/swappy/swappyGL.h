@@ -127,7 +127,14 @@ uint64_t SwappyGL_getFenceTimeoutNS();
 
 /**
  * @brief Set the number of bad frames to wait before applying a fix for buffer
- * stuffing. Set to zero in order to turn off this feature. Default value = 0.
+ * stuffing. Set to zero in order to turn off this feature. Default value = 3.
+ *
+ * Buffer stuffing is detected from the desired and actual present times of
+ * past frames, which are collected when ::SwappyGL_recordFrameStart is called.
+ * A bad frame is one presented at least half a refresh period later than
+ * desired, by the same amount as the previous one. After n_frames consecutive
+ * bad frames, Swappy delays the next frame by one refresh period, which drops
+ * exactly one frame from the compositor queue.
  */
 void SwappyGL_setBufferStuffingFixWait(int32_t n_frames);
 
@@ -141,6 +148,18 @@ void SwappyGL_setBufferStuffingFixWait(int32_t n_frames);
 int SwappyGL_getSupportedRefreshPeriodsNS(uint64_t *out_refreshrates,
                                           int allocated_entries);
 
+/**
+ * @brief Get the display mode and swap interval Swappy currently plans to
+ * present at.
+ *
+ * @return false if Swappy is not initialized or has no plan yet, e.g. when
+ * the supported display modes are unknown or the frame rate is voted through
+ * ANativeWindow_setFrameRate, true otherwise.
+ *
+ * @see SwappyRefreshRatePlan
+ */
+bool SwappyGL_getRefreshRatePlan(SwappyRefreshRatePlan *out_plan);
+
 #ifdef __cplusplus
 };
 #endif
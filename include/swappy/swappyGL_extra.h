@@ -167,6 +167,35 @@ void SwappyGL_enableFramePacing(bool enable);
  */
 void SwappyGL_enableBlockingWait(bool enable);
 
+/**
+ * @brief Enable/Disable polling of the GPU fences
+ * By default Swappy measures the GPU time of each frame with a dedicated thread
+ * that blocks on the frame's sync fence. Calling
+ * `SwappyGL_enableFencePolling(true)` stops that thread: fences are then
+ * checked without blocking when ::SwappyGL_swap is called (and on
+ * ::SwappyGL_onChoreographer ticks, if the app forwards them). The GPU
+ * completion time is taken from the EGL_ANDROID_get_frame_timestamps
+ * rendering complete time when available, and otherwise estimated from the
+ * poll times, so the GPU time delivered in the ::SwappyPostWaitCallback
+ * callback is less precise.
+ * @param enable  If true, fences are polled instead of waited on.
+ */
+void SwappyGL_enableFencePolling(bool enable);
+
+/**
+ * @brief Enable/Disable the low latency mode
+ * By default Swappy starts a frame as soon as the previous one has been
+ * swapped, so the app reads its input up to a full swap interval before the
+ * frame is presented. In low latency mode, Swappy instead delays the return of
+ * ::SwappyGL_swap so that the next frame starts just early enough for its
+ * predicted work time, the longest of the recent frames, to end by the time it
+ * has to be queued. A frame that misses its deadline increases the safety
+ * margin and turns the delay off until enough frames have been measured
+ * again. This setting has no impact when frame pacing is disabled.
+ * @param enable  If true, frames are started as late as possible.
+ */
+void SwappyGL_enableLowLatencyMode(bool enable);
+
 #ifdef __cplusplus
 };
 #endif
@@ -340,6 +340,19 @@ uint64_t SwappyVk_getSwapIntervalNS(VkSwapchainKHR swapchain);
 int SwappyVk_getSupportedRefreshPeriodsNS(uint64_t* out_refreshrates,
                                           int allocated_entries,
                                           VkSwapchainKHR swapchain);
+
+/**
+ * @brief Get the display mode and swap interval Swappy currently plans to
+ * present the given swapchain at.
+ *
+ * @return false if Swappy is not enabled for the swapchain or has no plan
+ * yet, e.g. when the supported display modes are unknown or the frame rate is
+ * voted through ANativeWindow_setFrameRate, true otherwise.
+ *
+ * @see SwappyRefreshRatePlan
+ */
+bool SwappyVk_getRefreshRatePlan(VkSwapchainKHR swapchain,
+                                 SwappyRefreshRatePlan* out_plan);
 /**
  * @brief Check if Swappy is enabled for the specified swapchain.
  *
@@ -463,6 +476,23 @@ void SwappyVk_enableFramePacing(VkSwapchainKHR swapchain, bool enable);
  */
 void SwappyVk_enableBlockingWait(VkSwapchainKHR swapchain, bool enable);
 
+/**
+ * @brief Enable/Disable the low latency mode
+ *
+ * By default Swappy starts a frame as soon as the previous one has been
+ * presented, so the app reads its input up to a full swap interval before the
+ * frame is displayed. In low latency mode, Swappy instead delays the return of
+ * ::SwappyVk_queuePresent so that the next frame starts just early enough for
+ * its predicted work time, the longest of the recent frames, to end by the
+ * time it has to be queued. A frame that misses its deadline increases the
+ * safety margin and turns the delay off until enough frames have been
+ * measured again. This setting has no impact when frame pacing is disabled.
+ *
+ * @param[in]  swapchain   - The swapchain to configure.
+ * @param      enable      - If true, frames are started as late as possible.
+ */
+void SwappyVk_enableLowLatencyMode(VkSwapchainKHR swapchain, bool enable);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
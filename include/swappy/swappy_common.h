@@ -178,6 +178,29 @@ typedef struct SwappyStats {
     uint64_t latencyFrames[MAX_FRAME_BUCKETS];
 } SwappyStats;
 
+/**
+ * @brief Display mode and swap interval Swappy currently plans to present at.
+ *
+ * Swappy plans over all the modes supported by the display, picking the
+ * shortest swap duration that accommodates the frame time and, among those,
+ * the lowest refresh rate. Mode switches that are not needed to keep up with
+ * the frame time are delayed until they have been planned for a while.
+ *
+ * @see SwappyGL_getRefreshRatePlan
+ * @see SwappyVk_getRefreshRatePlan
+ */
+typedef struct SwappyRefreshRatePlan {
+    /** @brief Refresh period of the planned display mode, in nanoseconds. */
+    uint64_t refreshPeriodNS;
+
+    /** @brief Number of refresh periods each frame is presented for. */
+    int32_t swapInterval;
+
+    /** @brief Id of the planned display mode, as in Display.Mode.getModeId().
+     */
+    int32_t modeId;
+} SwappyRefreshRatePlan;
+
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -103,10 +103,14 @@ typedef struct TuningFork_CProtobufSerialization {
 typedef uint16_t TuningFork_InstrumentKey;
 /// A trace handle used in TuningFork_startTrace
 typedef uint64_t TuningFork_TraceHandle;
+/// A handle returned by TuningFork_registerAnnotation
+typedef uint32_t TuningFork_AnnotationHandle;
 /// A  handle used in TuningFork_startRecordingLoadingTime
 typedef uint64_t TuningFork_LoadingEventHandle;
 /// A  handle used in TuningFork_startLoadingGroup
 typedef uint64_t TuningFork_LoadingGroupHandle;
+/// A  handle used in TuningFork_beginLoadingSpan
+typedef uint64_t TuningFork_LoadingSpanHandle;
 /// A time as milliseconds past the epoch.
 typedef uint64_t TuningFork_TimePoint;
 /// A duration in nanoseconds.
@@ -457,6 +461,32 @@ TuningFork_ErrorCode TuningFork_getFidelityParameters(
 TuningFork_ErrorCode TuningFork_setCurrentAnnotation(
     const TuningFork_CProtobufSerialization* annotation);
 
+/**
+ * @brief Register an annotation so that it can be made current by handle.
+ * Registering the same annotation again returns the same handle.
+ * @param annotation the protobuf serialization of the annotation.
+ * @param[out] handle the handle to pass to
+ * TuningFork_setCurrentAnnotationHandle.
+ * @return TUNINGFORK_ERROR_INVALID_ANNOTATION if a parameter is null or if too
+ * many different annotations have been registered.
+ * @return TUNINGFORK_ERROR_OK on success.
+ */
+TuningFork_ErrorCode TuningFork_registerAnnotation(
+    const TuningFork_CProtobufSerialization* annotation,
+    TuningFork_AnnotationHandle* handle);
+
+/**
+ * @brief Set the current annotation from a handle returned by
+ * TuningFork_registerAnnotation.
+ * Unlike TuningFork_setCurrentAnnotation, the annotation isn't copied or
+ * decoded: this is cheap enough to be called whenever the game state changes.
+ * @param handle a registered annotation handle.
+ * @return TUNINGFORK_ERROR_INVALID_ANNOTATION if the handle is unknown.
+ * @return TUNINGFORK_ERROR_OK on success.
+ */
+TuningFork_ErrorCode TuningFork_setCurrentAnnotationHandle(
+    TuningFork_AnnotationHandle handle);
+
 /**
  * @brief Record a frame tick that will be associated with the instrumentation
  * key and the current annotation. NB: calling the tick or trace functions from
@@ -484,11 +514,15 @@ TuningFork_ErrorCode TuningFork_frameDeltaTimeNanos(
 
 /**
  * @brief Start a trace segment.
+ * Traces can be started and ended on any thread, and several traces with the
+ * same instrument key can be live at once, e.g. when nested.
  * @param key an instrument key
  * @see the reserved instrument keys above
  * @param[out] handle this is filled with a new handle on success.
  * @return TUNINGFORK_ERROR_INVALID_INSTRUMENT_KEY if the instrument key is
  * invalid.
+ * @return TUNINGFORK_ERROR_NO_MORE_SPACE_FOR_FRAME_TIME_DATA if there are
+ * already 1024 live traces.
  * @return TUNINGFORK_ERROR_OK on success.
  */
 TuningFork_ErrorCode TuningFork_startTrace(TuningFork_InstrumentKey key,
@@ -497,7 +531,8 @@ TuningFork_ErrorCode TuningFork_startTrace(TuningFork_InstrumentKey key,
 /**
  * @brief Stop and record a trace segment.
  * @param handle this is a handle previously returned by TuningFork_startTrace
- * @return TUNINGFORK_ERROR_INVALID_TRACE_HANDLE if the handle is invalid.
+ * @return TUNINGFORK_ERROR_INVALID_TRACE_HANDLE if the handle is invalid or
+ * the trace was already stopped.
  * @return TUNINGFORK_ERROR_OK on success.
  */
 TuningFork_ErrorCode TuningFork_endTrace(TuningFork_TraceHandle handle);
@@ -679,14 +714,21 @@ TuningFork_ErrorCode TuningFork_stopRecordingLoadingTime(
 
 /**
  * @brief Start a loading group. Subsequent loading times will be tagged
- * with this group's id until startLoadingGroup is called again or
- * stopLoadingGroup is called.
+ * with this group's id until another group is started or this one is stopped.
+ *
+ * Groups can nest and overlap: a group started while another one is current
+ * becomes its child. The current group is the innermost group started on the
+ * calling thread or, if there is none, the innermost group started on the
+ * thread of the oldest live group, usually the main thread. So groups for
+ * loads streamed in parallel can be started on their own threads, as
+ * children of a group started on the main thread. When a group is stopped,
+ * the time on its critical path, the longest chain of loading events and
+ * child groups that ran one after the other, is recorded along with it.
  * @param eventMetadata A LoadingTimeMetadata structure.
  * @param eventMetadataSize Size in bytes of the LoadingTimeMetadata structure
  *(for versioning of the structure).
  * @param annotation The annotation to use with this event.
- * @param[out] handle A handle for this event (currently is always null since
- * there can only be one loading group active).
+ * @param[out] handle A handle for this group.
  * @return TUNINGFORK_ERROR_OK on success.
  * @return TUNINGFORK_ERROR_INVALID_LOADING_STATE if state was not set in the
  *metadata.
@@ -700,12 +742,52 @@ TuningFork_ErrorCode TuningFork_startLoadingGroup(
 /**
  * @brief Stop recording events as belonging to a group and record a group
  * event.
- * @param handle A handle generated by startLoadingGroup (currently should be
- * 0).
+ * @param handle A handle generated by startLoadingGroup, or 0 to stop the
+ * current group.
+ * @return TUNINGFORK_ERROR_OK on success.
+ * @return TUNINGFORK_ERROR_NO_ACTIVE_LOADING_GROUP if handle is 0 and there is
+ * no current group.
+ * @return TUNINGFORK_ERROR_BAD_PARAMETER if the group isn't live.
  **/
 TuningFork_ErrorCode TuningFork_stopLoadingGroup(
     TuningFork_LoadingGroupHandle handle);
 
+/**
+ * @brief Begin a named span in a loading group, to find out which part of a
+ * long load takes the most time.
+ *
+ * Spans form a tree whose root is the group. When the group is stopped, the
+ * tree is analyzed and its critical path, the self time of the spans and how
+ * much they ran in parallel are uploaded with the group event, along with the
+ * slowest spans. Spans that aren't ended when the group stops end with it.
+ * The number of spans in a group is bounded: spans beyond the limit are only
+ * counted.
+ * @param name The name of the span. It is truncated to 64 characters.
+ * @param parent The handle of the parent span, or 0 to begin a top-level span
+ * in the current loading group.
+ * @param[out] handle A handle for this span.
+ * @return TUNINGFORK_ERROR_OK on success.
+ * @return TUNINGFORK_ERROR_NO_ACTIVE_LOADING_GROUP if parent is 0 and there is
+ * no current loading group.
+ * @return TUNINGFORK_ERROR_INVALID_LOADING_HANDLE if parent isn't a span of a
+ * live loading group that is still running.
+ * @return TUNINGFORK_ERROR_NO_MORE_SPACE_FOR_LOADING_TIME_DATA if the group
+ * has too many spans.
+ **/
+TuningFork_ErrorCode TuningFork_beginLoadingSpan(
+    const char* name, TuningFork_LoadingSpanHandle parent,
+    TuningFork_LoadingSpanHandle* handle);
+
+/**
+ * @brief End a span started with TuningFork_beginLoadingSpan.
+ * @param handle A handle generated by beginLoadingSpan.
+ * @return TUNINGFORK_ERROR_OK on success.
+ * @return TUNINGFORK_ERROR_INVALID_LOADING_HANDLE if the span was already
+ * ended or its group was stopped.
+ **/
+TuningFork_ErrorCode TuningFork_endLoadingSpan(
+    TuningFork_LoadingSpanHandle handle);
+
 /**
  * @brief The set of states that the TuningFork_reportLifecycleEvent method
  * accepts.
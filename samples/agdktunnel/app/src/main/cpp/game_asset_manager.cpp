@@ -43,15 +43,25 @@ public:
 
     uint64_t GetInternalGameAssetSize(const char *assetName);
 
-    void LoadGameAssetAsync(const char *assetName, const uint64_t bufferSize,
-                            void *loadBuffer, LoadingCompleteCallback callback,
-                            AssetPackInfo *packInfo, bool isInternal, void* userData);
+    LoadingJobId LoadGameAssetAsync(const char *assetName, const uint64_t bufferSize,
+                                    void *loadBuffer, LoadingCompleteCallback callback,
+                                    AssetPackInfo *packInfo, bool isInternal, void* userData,
+                                    LoadingPriority priority);
+
+    bool CancelGameAssetLoad(LoadingJobId jobId) {
+        return mLoadingThread->CancelAssetLoad(jobId);
+    }
 
     bool LoadExternalGameAsset(const char *assetName, const uint64_t bufferSize, void *loadBuffer,
                                AssetPackInfo *packInfo);
 
     bool LoadInternalGameAsset(const char *assetName, const uint64_t bufferSize, void *loadBuffer);
 
+    std::shared_ptr<GameAssetView> MapExternalGameAsset(const char *assetName,
+                                                        AssetPackInfo *packInfo);
+
+    std::shared_ptr<GameAssetView> MapInternalGameAsset(const char *assetName);
+
     void ChangeAssetPackStatus(AssetPackInfo *packInfo,
                                const GameAssetManager::GameAssetStatus newStatus) {
         if (packInfo->mAssetPackStatus != newStatus) {
@@ -223,14 +233,15 @@ uint64_t GameAssetManagerInternals::GetInternalGameAssetSize(const char *assetNa
     return assetSize;
 }
 
-void
+LoadingJobId
 GameAssetManagerInternals::LoadGameAssetAsync(const char *assetName, const uint64_t bufferSize,
                                               void *loadBuffer, LoadingCompleteCallback callback,
                                               AssetPackInfo *packInfo,
                                               bool isInternal,
-                                              void* userData) {
+                                              void* userData,
+                                              LoadingPriority priority) {
 
-    char *assetPath = NULL;
+    char assetPath[MAX_ASSET_PATH_LENGTH];
     if (packInfo->mAssetPackBasePath == NULL) {
         // If a parent directory base path was not set, assume this is actually an internal
         // asset
@@ -238,11 +249,11 @@ GameAssetManagerInternals::LoadGameAssetAsync(const char *assetName, const uint6
     }
 
     if (!isInternal) {
-        assetPath = new char[MAX_ASSET_PATH_LENGTH];
         GenerateFullAssetPath(assetName, packInfo, assetPath, MAX_ASSET_PATH_LENGTH);
     }
-    mLoadingThread->StartAssetLoad(assetName, assetPath, bufferSize, loadBuffer, callback,
-                                   isInternal, userData);
+    // The loading thread copies the path.
+    return mLoadingThread->StartAssetLoad(assetName, isInternal ? NULL : assetPath, bufferSize,
+                                          loadBuffer, callback, isInternal, userData, priority);
 }
 
 bool
@@ -294,6 +305,27 @@ GameAssetManagerInternals::LoadInternalGameAsset(const char *assetName, const ui
     return loadSuccess;
 }
 
+std::shared_ptr<GameAssetView>
+GameAssetManagerInternals::MapExternalGameAsset(const char *assetName, AssetPackInfo *packInfo) {
+    if (packInfo->mAssetPackBasePath == NULL) {
+        // If a parent directory base path was not set, assume this is actually an internal
+        // asset
+        return MapInternalGameAsset(assetName);
+    }
+
+    char fullAssetFilePath[MAX_ASSET_PATH_LENGTH];
+    if (!GenerateFullAssetPath(assetName, packInfo, fullAssetFilePath, MAX_ASSET_PATH_LENGTH)) {
+        return NULL;
+    }
+    return GameAssetView::MapFile(fullAssetFilePath);
+}
+
+std::shared_ptr<GameAssetView>
+GameAssetManagerInternals::MapInternalGameAsset(const char *assetName) {
+    return GameAssetView::FromAsset(
+            AAssetManager_open(mAssetManager, assetName, AASSET_MODE_BUFFER));
+}
+
 AssetPackInfo *GameAssetManagerInternals::GetAssetPackByName(const char *assetPackName) {
     AssetPackInfo *packInfo = NULL;
 
@@ -720,11 +752,40 @@ GameAssetManager::LoadGameAsset(const char *assetName, const size_t bufferSize,
     return loadSuccess;
 }
 
+std::shared_ptr<GameAssetView> GameAssetManager::MapGameAsset(const char *assetName) {
+    std::shared_ptr<GameAssetView> view;
+
+    if (assetName != NULL) {
+#if defined NO_ASSET_PACKS
+        view = mInternals->MapInternalGameAsset(assetName);
+#else
+        AssetPackInfo *packInfo = mInternals->GetAssetPackForAssetName(assetName);
+        if (packInfo != NULL) {
+            if (packInfo->mAssetPackStatus == GameAssetManager::GAMEASSET_READY) {
+                switch (packInfo->mDefinition->mPackType) {
+                    case GAMEASSET_PACKTYPE_INTERNAL:
+                        view = mInternals->MapInternalGameAsset(assetName);
+                        break;
+                    case GAMEASSET_PACKTYPE_FASTFOLLOW:
+                    case GAMEASSET_PACKTYPE_ONDEMAND:
+                        view = mInternals->MapExternalGameAsset(assetName, packInfo);
+                        break;
+                }
+            }
+        }
+#endif
+    }
+
+    return view;
+}
+
 bool
 GameAssetManager::LoadGameAssetAsync(const char *assetName, const size_t bufferSize,
                                      void *loadBuffer,
                                      LoadingCompleteCallback callback,
-                                     void* userData) {
+                                     void* userData,
+                                     LoadingPriority priority,
+                                     LoadingJobId *jobId) {
     bool startSuccess = false;
 
     if (assetName != NULL) {
@@ -744,9 +805,14 @@ GameAssetManager::LoadGameAssetAsync(const char *assetName, const size_t bufferS
                         break;
                 }
 #endif
-                mInternals->LoadGameAssetAsync(assetName, bufferSize, loadBuffer, callback,
-                                               packInfo, isInternal, userData);
-                startSuccess = true;
+                LoadingJobId newJobId =
+                        mInternals->LoadGameAssetAsync(assetName, bufferSize, loadBuffer,
+                                                       callback, packInfo, isInternal, userData,
+                                                       priority);
+                if (jobId != NULL) {
+                    *jobId = newJobId;
+                }
+                startSuccess = newJobId != INVALID_LOADING_JOB_ID;
             }
         }
     }
@@ -754,6 +820,10 @@ GameAssetManager::LoadGameAssetAsync(const char *assetName, const size_t bufferS
     return startSuccess;
 }
 
+bool GameAssetManager::CancelGameAssetLoad(LoadingJobId jobId) {
+    return mInternals->CancelGameAssetLoad(jobId);
+}
+
 const char *GameAssetManager::GetGameAssetParentPackName(const char *assetName) {
     const char *assetPackName = NULL;
 
@@ -19,6 +19,7 @@
 
 #include <jni.h>
 #include <stddef.h>
+#include "game_asset_view.hpp"
 #include "loading_thread.hpp"
 #include "util.hpp"
 
@@ -99,12 +100,25 @@ public:
     // returns true if successful
     bool LoadGameAsset(const char *assetName, const size_t bufferSize, void *loadBuffer);
 
+    // If the status of the asset is GAMEASSET_READY, returns a read-only view of the asset
+    // data without copying it: external asset files are memory-mapped, internal assets
+    // use the buffer of the asset manager. The data stays valid while the view is
+    // referenced. Returns NULL on failure.
+    std::shared_ptr<GameAssetView> MapGameAsset(const char *assetName);
+
     // If the status of the asset is GAMEASSET_READY, start asynchronously loading
     // file data into the specified buffer. Callback will be called when load completes.
     // returns true if async load began successfully.
     // userData is passed without modification to the callback.
+    // If jobId is not NULL, it receives an id to pass to CancelGameAssetLoad.
     bool LoadGameAssetAsync(const char *assetName, const size_t bufferSize, void *loadBuffer,
-                            LoadingCompleteCallback callback, void* userData);
+                            LoadingCompleteCallback callback, void* userData,
+                            LoadingPriority priority = LOADING_PRIORITY_NORMAL,
+                            LoadingJobId *jobId = NULL);
+
+    // Cancels an asynchronous load started by LoadGameAssetAsync, returns false if it
+    // already completed.
+    bool CancelGameAssetLoad(LoadingJobId jobId);
 
     // Returns an array of filenames of files present in the specified asset pack,
     // returns NULL if the asset pack name was not found
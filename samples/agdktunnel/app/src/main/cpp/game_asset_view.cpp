@@ -0,0 +1,81 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <android/asset_manager.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "game_asset_view.hpp"
+
+// Not common.hpp, which pulls in EGL, GLES and JNI, so that this also builds on a host.
+#define LOG_TAG "AGDKTunnel"
+#include "Log.h"
+
+std::shared_ptr<GameAssetView> GameAssetView::MapFile(const char *path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat fileStats;
+    if (fstat(fd, &fileStats) != 0) {
+        close(fd);
+        return NULL;
+    }
+    size_t size = fileStats.st_size;
+    if (size == 0) {
+        // mmap doesn't accept empty mappings.
+        close(fd);
+        return std::shared_ptr<GameAssetView>(new GameAssetView(NULL, 0, false, NULL));
+    }
+    void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file alive.
+    close(fd);
+    if (data == MAP_FAILED) {
+        ALOGE("GameAssetView: failed to map %s", path);
+        return NULL;
+    }
+    // Assets are usually consumed right away, start reading them in.
+    madvise(data, size, MADV_WILLNEED);
+    return std::shared_ptr<GameAssetView>(new GameAssetView(data, size, true, NULL));
+}
+
+std::shared_ptr<GameAssetView> GameAssetView::FromAsset(AAsset *asset) {
+    if (asset == NULL) {
+        return NULL;
+    }
+    size_t size = AAsset_getLength(asset);
+    const void *data = AAsset_getBuffer(asset);
+    if (data == NULL && size > 0) {
+        AAsset_close(asset);
+        return NULL;
+    }
+    return std::shared_ptr<GameAssetView>(new GameAssetView(data, size, false, asset));
+}
+
+GameAssetView::GameAssetView(const void *data, size_t size, bool isMapped, AAsset *asset) :
+        mData(data), mSize(size), mIsMapped(isMapped), mAsset(asset) {
+}
+
+GameAssetView::~GameAssetView() {
+    if (mIsMapped) {
+        munmap(const_cast<void *>(mData), mSize);
+    }
+    if (mAsset != NULL) {
+        AAsset_close(mAsset);
+    }
+}
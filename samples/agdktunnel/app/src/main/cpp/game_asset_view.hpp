@@ -0,0 +1,58 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef agdktunnel_game_asset_view_hpp
+#define agdktunnel_game_asset_view_hpp
+
+#include <memory>
+#include <stddef.h>
+
+struct AAsset;
+
+// A read-only view of the data of an asset, which isn't copied: the view is backed either
+// by a memory mapping of the asset file, or by the buffer of an open AAsset.
+// Views are shared through std::shared_ptr, the data stays valid until the last reference
+// is released.
+class GameAssetView {
+public:
+    // Maps the file at path. Returns NULL on failure.
+    static std::shared_ptr<GameAssetView> MapFile(const char *path);
+
+    // Takes ownership of asset, which should be opened with AASSET_MODE_BUFFER. Assets stored
+    // uncompressed are mapped from the APK, compressed ones are decompressed into memory
+    // owned by the asset. Returns NULL on failure, in which case asset is closed.
+    static std::shared_ptr<GameAssetView> FromAsset(AAsset *asset);
+
+    ~GameAssetView();
+
+    GameAssetView(const GameAssetView &) = delete;
+    GameAssetView &operator=(const GameAssetView &) = delete;
+
+    const void *GetData() const { return mData; }
+
+    size_t GetSize() const { return mSize; }
+
+private:
+    GameAssetView(const void *data, size_t size, bool isMapped, AAsset *asset);
+
+    const void *mData;
+    size_t mSize;
+    // True if mData was mapped by MapFile and needs munmap.
+    bool mIsMapped;
+    AAsset *mAsset;
+};
+
+#endif
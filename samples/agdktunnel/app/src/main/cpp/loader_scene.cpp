@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <atomic>
+#include <mutex>
+
 #include "anim.hpp"
 #include "game_asset_manager.hpp"
 #include "game_asset_manifest.hpp"
@@ -33,8 +36,10 @@
 class LoaderScene::TextureLoader {
  private:
     int _totalLoadCount = 0;
+    // Load callbacks come from the loading workers, possibly concurrently.
+    std::mutex _loadedTexturesMutex;
     int _currentLoadIndex = 0;
-    int _remainingLoadCount = 0;
+    std::atomic<int> _remainingLoadCount{0};
     bool _on_demand_assets_installed = false;
     bool _install_time_assets_installed = false;
 
@@ -70,6 +75,7 @@ class LoaderScene::TextureLoader {
 
     void LoadingCallback(const LoadingCompleteMessage *message) {
         if (message->loadSuccessful) {
+            std::lock_guard<std::mutex> lock(_loadedTexturesMutex);
             if (_currentLoadIndex < MAX_ASSET_TEXTURES) {
                 _loadedTextures[_currentLoadIndex].textureSize = message->bytesRead;
                 _loadedTextures[_currentLoadIndex].textureData = message->loadBuffer;
@@ -154,6 +160,7 @@ class LoaderScene::TextureLoader {
 
     void CreateTextures() {
         TextureManager *textureManager = NativeEngine::GetInstance()->GetTextureManager();
+        std::lock_guard<std::mutex> lock(_loadedTexturesMutex);
         for (int i = 0; i < _currentLoadIndex; ++i) {
             textureManager->CreateTexture(_loadedTextures[i].textureName,
                 _loadedTextures[i].textureSize,
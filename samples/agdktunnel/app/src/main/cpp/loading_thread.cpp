@@ -15,119 +15,320 @@
  */
 
 #include <android/asset_manager.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
 #include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
 
-#include "common.hpp"
 #include "loading_thread.hpp"
 
+// Not common.hpp, which pulls in EGL, GLES and JNI, so that this also builds on a host.
+#define LOG_TAG "AGDKTunnel"
+#include "Log.h"
+
 namespace {
 
+// Size of each read, after which progress is reported and cancellation checked.
+constexpr size_t READ_CHUNK_SIZE = 256 * 1024;
+
+// Files at least this big are split into ranges read in parallel, with ranges no
+// smaller than this.
+constexpr size_t MIN_PARALLEL_RANGE_SIZE = 1024 * 1024;
+
+constexpr int MAX_DEFAULT_WORKER_COUNT = 4;
+
+int DefaultWorkerCount() {
+    // Leave a core for the game and render threads.
+    int cores = static_cast<int>(std::thread::hardware_concurrency());
+    return std::max(1, std::min(MAX_DEFAULT_WORKER_COUNT, cores - 1));
 }
 
-LoadingThread::LoadingThread(AAssetManager *assetManager) {
+}
+
+LoadingThread::LoadingThread(AAssetManager *assetManager, int workerCount) {
     mAssetManager = assetManager;
-    LaunchThread();
+    mWorkerCount = workerCount > 0 ? workerCount : DefaultWorkerCount();
+    LaunchThreads();
 }
 
 LoadingThread::~LoadingThread() {
     std::lock_guard<std::mutex> threadLock(mThreadMutex);
-    TerminateThread();
+    TerminateThreads();
 }
 
-void
+LoadingJobId
 LoadingThread::StartAssetLoad(const char *assetName, const char *assetPath,
                               const size_t bufferSize, void *loadBuffer,
                               LoadingCompleteCallback callback, bool useAssetManager,
-                              void* userData) {
+                              void* userData, LoadingPriority priority,
+                              LoadingProgressCallback progressCallback) {
+    if (assetPath != NULL && strlen(assetPath) >= LOADING_MAX_PATH_LENGTH) {
+        ALOGE("LoadingThread: path too long for %s", assetName);
+        return INVALID_LOADING_JOB_ID;
+    }
+    if (priority < 0 || priority >= LOADING_PRIORITY_COUNT) {
+        priority = LOADING_PRIORITY_NORMAL;
+    }
+
     std::lock_guard<std::mutex> workLock(mWorkMutex);
-    LoadingJob *loadingJob = new LoadingJob();
+    LoadingJob *loadingJob;
+    if (mFreeJobs.empty()) {
+        mJobs.emplace_back();
+        loadingJob = &mJobs.back();
+    } else {
+        loadingJob = mFreeJobs.back();
+        mFreeJobs.pop_back();
+    }
+    loadingJob->id = ++mLastJobId;
     loadingJob->assetName = assetName;
-    loadingJob->assetPath = assetPath;
+    if (assetPath != NULL) {
+        strcpy(loadingJob->assetPath, assetPath);
+    } else {
+        loadingJob->assetPath[0] = '\0';
+    }
     loadingJob->bufferSize = bufferSize;
     loadingJob->loadBuffer = loadBuffer;
     loadingJob->callback = callback;
+    loadingJob->progressCallback = progressCallback;
     loadingJob->useAssetManager = useAssetManager;
     loadingJob->userData = userData;
-    mWorkQueue.emplace(loadingJob);
-    mWorkCondition.notify_all();
+    loadingJob->priority = priority;
+    loadingJob->fd = -1;
+    loadingJob->baseOffset = 0;
+    loadingJob->size = 0;
+    loadingJob->cancelled = false;
+    loadingJob->failed = false;
+    loadingJob->bytesRead = 0;
+    loadingJob->pendingRanges = 0;
+
+    mLanes[priority].push_back({loadingJob, true, 0, 0});
+    mWorkCondition.notify_one();
+    return loadingJob->id;
 }
 
-void LoadingThread::LaunchThread() {
+bool LoadingThread::CancelAssetLoad(LoadingJobId jobId) {
+    if (jobId == INVALID_LOADING_JOB_ID) return false;
+    std::lock_guard<std::mutex> workLock(mWorkMutex);
+    for (LoadingJob &job : mJobs) {
+        if (job.id != jobId) continue;
+        job.cancelled = true;
+        // If the job hasn't started, move it to the front so its callback is called promptly
+        // rather than after the rest of its lane.
+        std::deque<LoadingTask> &lane = mLanes[job.priority];
+        for (auto it = lane.begin(); it != lane.end(); ++it) {
+            if (it->job == &job) {
+                LoadingTask task = *it;
+                lane.erase(it);
+                mLanes[LOADING_PRIORITY_HIGH].push_front(task);
+                break;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+void LoadingThread::LaunchThreads() {
     std::lock_guard<std::mutex> threadLock(mThreadMutex);
-    if (mThread.joinable()) {
-        TerminateThread();
+    if (!mThreads.empty()) {
+        TerminateThreads();
+    }
+    for (int i = 0; i < mWorkerCount; ++i) {
+        mThreads.emplace_back([this, i]() { WorkerMain(i); });
     }
-    mThread = std::thread([this]() { ThreadMain(); });
 }
 
-void LoadingThread::TerminateThread() REQUIRES(mThreadMutex) {
+void LoadingThread::TerminateThreads() REQUIRES(mThreadMutex) {
     {
         std::lock_guard<std::mutex> workLock(mWorkMutex);
         mIsActive = false;
         mWorkCondition.notify_all();
     }
-    mThread.join();
+    for (std::thread &thread : mThreads) {
+        thread.join();
+    }
+    mThreads.clear();
+
+    // Loads still queued are dropped, but not their open files.
+    std::lock_guard<std::mutex> workLock(mWorkMutex);
+    for (LoadingJob &job : mJobs) {
+        if (job.id != INVALID_LOADING_JOB_ID && job.fd >= 0) {
+            close(job.fd);
+            job.fd = -1;
+        }
+    }
 }
 
-void LoadingThread::ThreadMain() {
-    pthread_setname_np(pthread_self(), "LoadingThread");
+bool LoadingThread::PopTask(LoadingTask *task) REQUIRES(mWorkMutex) {
+    for (std::deque<LoadingTask> &lane : mLanes) {
+        if (!lane.empty()) {
+            *task = lane.front();
+            lane.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void LoadingThread::WorkerMain(int workerIndex) {
+    char threadName[16];
+    snprintf(threadName, sizeof(threadName), "LoadingThread%d", workerIndex);
+    pthread_setname_np(pthread_self(), threadName);
 
     std::lock_guard<std::mutex> lock(mWorkMutex);
     while (mIsActive) {
-        mWorkCondition.wait(
-                mWorkMutex,
-                [this]() REQUIRES(mWorkMutex) {
-                    return !mWorkQueue.empty() || !mIsActive;
-                });
-        if (!mWorkQueue.empty()) {
-            LoadingJob *loadingJob = mWorkQueue.front();
-            mWorkQueue.pop();
-
-            // Drop the mutex while we execute
-            mWorkMutex.unlock();
-
-            LoadingCompleteMessage loadingCompleteMessage;
-            loadingCompleteMessage.assetName = loadingJob->assetName;
-            loadingCompleteMessage.bytesRead = 0;
-            loadingCompleteMessage.loadBuffer = loadingJob->loadBuffer;
-            loadingCompleteMessage.loadSuccessful = false;
-            loadingCompleteMessage.userData = loadingJob->userData;
-
-            if (loadingJob->useAssetManager) {
-                AAsset *asset = AAssetManager_open(mAssetManager, loadingJob->assetName,
-                                                   AASSET_MODE_STREAMING);
-                if (asset != NULL) {
-                    size_t assetSize = AAsset_getLength(asset);
-                    if (assetSize <= loadingJob->bufferSize) {
-                        AAsset_read(asset, loadingJob->loadBuffer, assetSize);
-                        loadingCompleteMessage.bytesRead = assetSize;
-                        loadingCompleteMessage.loadSuccessful = true;
-                    }
-                    AAsset_close(asset);
-                }
-            } else {
-                FILE *fp = fopen(loadingJob->assetPath, "rb");
-                if (fp != NULL) {
-                    struct stat fileStats;
-                    size_t assetSize = 0;
-                    int statResult = fstat(fileno(fp), &fileStats);
-                    if (statResult == 0) {
-                        assetSize = fileStats.st_size;
-                        if (assetSize <= loadingJob->bufferSize) {
-                            fread(loadingJob->loadBuffer, assetSize, 1, fp);
-                            loadingCompleteMessage.bytesRead = assetSize;
-                            loadingCompleteMessage.loadSuccessful = true;
-                        }
-                    }
-                    fclose(fp);
-                }
-                delete[] loadingJob->assetPath;
-            }
+        LoadingTask task;
+        if (!PopTask(&task)) {
+            mWorkCondition.wait(mWorkMutex);
+            continue;
+        }
+
+        // Drop the mutex while we execute
+        mWorkMutex.unlock();
+
+        if (task.open) {
+            OpenJob(task.job);
+        } else {
+            ReadRange(task.job, task.offset, task.length);
+        }
 
-            loadingJob->callback(&loadingCompleteMessage);
-            delete loadingJob;
+        mWorkMutex.lock();
+    }
+}
+
+void LoadingThread::OpenJob(LoadingJob *job) {
+    if (job->cancelled) {
+        FinishJob(job, false);
+        return;
+    }
+
+    if (job->useAssetManager) {
+        AAsset *asset = AAssetManager_open(mAssetManager, job->assetName,
+                                           AASSET_MODE_STREAMING);
+        if (asset == NULL) {
+            FinishJob(job, false);
+            return;
+        }
+        job->size = AAsset_getLength(asset);
+        if (job->size > job->bufferSize) {
+            AAsset_close(asset);
+            FinishJob(job, false);
+            return;
+        }
+        // Assets stored uncompressed can be read directly from the APK, like any file.
+        off64_t start, length;
+        job->fd = AAsset_openFileDescriptor64(asset, &start, &length);
+        if (job->fd < 0) {
+            ReadAsset(job, asset);
+            AAsset_close(asset);
+            FinishJob(job, !job->failed && !job->cancelled);
+            return;
+        }
+        job->baseOffset = start;
+        AAsset_close(asset);
+    } else {
+        job->fd = open(job->assetPath, O_RDONLY | O_CLOEXEC);
+        struct stat fileStats;
+        if (job->fd < 0 || fstat(job->fd, &fileStats) != 0 ||
+            static_cast<size_t>(fileStats.st_size) > job->bufferSize) {
+            FinishJob(job, false);
+            return;
+        }
+        job->size = fileStats.st_size;
+    }
+
+    // Split big files so that idle workers can help read them. The other ranges go to
+    // the front of the lane, so they are picked up before the next job starts.
+    size_t rangeCount = std::min<size_t>(mWorkerCount,
+                                         job->size / MIN_PARALLEL_RANGE_SIZE);
+    rangeCount = std::max<size_t>(rangeCount, 1);
+    size_t rangeSize = (job->size + rangeCount - 1) / rangeCount;
+    job->pendingRanges = static_cast<int>(rangeCount);
+    if (rangeCount > 1) {
+        std::lock_guard<std::mutex> workLock(mWorkMutex);
+        std::deque<LoadingTask> &lane = mLanes[job->priority];
+        for (size_t i = rangeCount - 1; i > 0; --i) {
+            size_t offset = i * rangeSize;
+            lane.push_front({job, false, offset, std::min(rangeSize, job->size - offset)});
+        }
+        mWorkCondition.notify_all();
+    }
+    ReadRange(job, 0, std::min(rangeSize, job->size));
+}
 
-            mWorkMutex.lock();
+void LoadingThread::ReadAsset(LoadingJob *job, AAsset *asset) {
+    uint8_t *buffer = static_cast<uint8_t *>(job->loadBuffer);
+    size_t bytesRead = 0;
+    while (bytesRead < job->size && !job->cancelled) {
+        size_t chunkSize = std::min(READ_CHUNK_SIZE, job->size - bytesRead);
+        int result = AAsset_read(asset, buffer + bytesRead, chunkSize);
+        if (result <= 0) {
+            job->failed = true;
+            return;
         }
+        bytesRead += result;
+        job->bytesRead = bytesRead;
+        ReportProgress(job, bytesRead);
     }
 }
+
+void LoadingThread::ReadRange(LoadingJob *job, size_t offset, size_t length) {
+    uint8_t *buffer = static_cast<uint8_t *>(job->loadBuffer);
+    size_t rangeRead = 0;
+    while (rangeRead < length && !job->cancelled && !job->failed) {
+        size_t chunkSize = std::min(READ_CHUNK_SIZE, length - rangeRead);
+        ssize_t result = pread64(job->fd, buffer + offset + rangeRead, chunkSize,
+                                 job->baseOffset + offset + rangeRead);
+        if (result < 0 && errno == EINTR) continue;
+        if (result <= 0) {
+            job->failed = true;
+            break;
+        }
+        rangeRead += result;
+        ReportProgress(job, job->bytesRead.fetch_add(result) + result);
+    }
+    // The last range to finish completes the job.
+    if (job->pendingRanges.fetch_sub(1) == 1) {
+        FinishJob(job, !job->failed && !job->cancelled);
+    }
+}
+
+void LoadingThread::ReportProgress(LoadingJob *job, size_t bytesRead) {
+    if (job->progressCallback == NULL) return;
+    LoadingProgressMessage progressMessage;
+    progressMessage.assetName = job->assetName;
+    progressMessage.bytesRead = bytesRead;
+    progressMessage.totalBytes = job->size;
+    progressMessage.userData = job->userData;
+    job->progressCallback(&progressMessage);
+}
+
+void LoadingThread::FinishJob(LoadingJob *job, bool loadSuccessful) {
+    if (job->fd >= 0) {
+        close(job->fd);
+        job->fd = -1;
+    }
+
+    LoadingCompleteMessage loadingCompleteMessage;
+    {
+        // Retire the id before the callback, so that CancelAssetLoad returns false
+        // for a load whose completion is being delivered, and a cancel is either
+        // reported in the message or refused. The job isn't reused until it is freed.
+        std::lock_guard<std::mutex> workLock(mWorkMutex);
+        job->id = INVALID_LOADING_JOB_ID;
+        loadingCompleteMessage.loadCancelled = job->cancelled;
+    }
+    loadSuccessful = loadSuccessful && !loadingCompleteMessage.loadCancelled;
+    loadingCompleteMessage.assetName = job->assetName;
+    loadingCompleteMessage.bytesRead = loadSuccessful ? job->size : 0;
+    loadingCompleteMessage.loadBuffer = job->loadBuffer;
+    loadingCompleteMessage.loadSuccessful = loadSuccessful;
+    loadingCompleteMessage.userData = job->userData;
+    job->callback(&loadingCompleteMessage);
+
+    std::lock_guard<std::mutex> workLock(mWorkMutex);
+    mFreeJobs.push_back(job);
+}
@@ -17,12 +17,17 @@
 #ifndef agdktunnel_loading_thread_hpp
 #define agdktunnel_loading_thread_hpp
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
-#include <queue>
 #include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
 #include <thread>
+#include <vector>
 
+struct AAsset;
 struct AAssetManager;
 
 // Enable thread safety attributes only with clang.
@@ -39,52 +44,136 @@ struct AAssetManager;
 #define REQUIRES(...) \
   THREAD_ANNOTATION_ATTRIBUTE__(requires_capability(__VA_ARGS__))
 
+#define LOADING_MAX_PATH_LENGTH 512
+
+// Jobs of a higher priority lane are always started before jobs of a lower one.
+enum LoadingPriority {
+    LOADING_PRIORITY_HIGH = 0,
+    LOADING_PRIORITY_NORMAL,
+    LOADING_PRIORITY_LOW,
+    LOADING_PRIORITY_COUNT
+};
+
+// Identifies a load started by StartAssetLoad, to cancel it.
+typedef uint64_t LoadingJobId;
+
+static const LoadingJobId INVALID_LOADING_JOB_ID = 0;
+
 struct LoadingCompleteMessage {
     const char *assetName;
     size_t bytesRead;
     void *loadBuffer;
     bool loadSuccessful;
+    bool loadCancelled;
     void* userData; // Opaque pointer to data owned by the load requester.
 };
 
 typedef void (*LoadingCompleteCallback)(const LoadingCompleteMessage *message);
 
+struct LoadingProgressMessage {
+    const char *assetName;
+    size_t bytesRead;
+    size_t totalBytes;
+    void* userData; // Opaque pointer to data owned by the load requester.
+};
+
+typedef void (*LoadingProgressCallback)(const LoadingProgressMessage *message);
+
+// A pool of worker threads streaming assets into caller buffers.
+// Files are read in chunks, reporting progress after each chunk. Large files,
+// and assets stored uncompressed in the APK, are split into ranges read in
+// parallel with pread by several workers.
+// Callbacks are called on the worker threads. Progress callbacks of a split
+// file can be called concurrently by several workers.
 class LoadingThread {
 public:
-    LoadingThread(AAssetManager *assetManager);
+    // workerCount of 0 picks a count from the number of CPU cores.
+    LoadingThread(AAssetManager *assetManager, int workerCount = 0);
 
     ~LoadingThread();
 
-    // userData is passed without modification to the callback.
-    void StartAssetLoad(const char *assetName, const char *assetPath, const size_t bufferSize,
-                        void *loadBuffer, LoadingCompleteCallback callback, bool useAssetManager,
-                        void* userData);
+    // assetPath is copied, so it only needs to be valid during the call.
+    // userData is passed without modification to the callbacks.
+    // Returns an id to cancel the load, or INVALID_LOADING_JOB_ID if assetPath is too long.
+    LoadingJobId StartAssetLoad(const char *assetName, const char *assetPath,
+                                const size_t bufferSize, void *loadBuffer,
+                                LoadingCompleteCallback callback, bool useAssetManager,
+                                void* userData,
+                                LoadingPriority priority = LOADING_PRIORITY_NORMAL,
+                                LoadingProgressCallback progressCallback = NULL);
 
-private:
-    void LaunchThread();
+    // Stops a load as soon as possible. The completion callback is still called, with
+    // loadCancelled set, unless the load already completed.
+    // Returns false if the load already completed.
+    bool CancelAssetLoad(LoadingJobId jobId);
 
-    void TerminateThread() REQUIRES(mThreadMutex);
-
-    void ThreadMain();
-
-    AAssetManager *mAssetManager;
+    int GetWorkerCount() const { return mWorkerCount; }
 
+private:
     struct LoadingJob {
+        LoadingJobId id = INVALID_LOADING_JOB_ID;
         const char *assetName;
-        const char *assetPath;
+        char assetPath[LOADING_MAX_PATH_LENGTH];
         size_t bufferSize;
         void *loadBuffer;
         LoadingCompleteCallback callback;
+        LoadingProgressCallback progressCallback;
         bool useAssetManager;
         void* userData; // Opaque pointer to data owned by the load requester.
+        LoadingPriority priority;
+
+        // Set when the file is opened. The asset data starts at baseOffset in fd.
+        int fd;
+        off64_t baseOffset;
+        size_t size;
+
+        std::atomic<bool> cancelled;
+        std::atomic<bool> failed;
+        std::atomic<size_t> bytesRead;
+        // Number of ranges still being read.
+        std::atomic<int> pendingRanges;
+    };
+
+    // Either opens a job, or reads a range of an opened job.
+    struct LoadingTask {
+        LoadingJob *job;
+        bool open;
+        size_t offset;
+        size_t length;
     };
 
+    void LaunchThreads();
+
+    void TerminateThreads() REQUIRES(mThreadMutex);
+
+    void WorkerMain(int workerIndex);
+
+    bool PopTask(LoadingTask *task) REQUIRES(mWorkMutex);
+
+    void OpenJob(LoadingJob *job);
+
+    void ReadAsset(LoadingJob *job, AAsset *asset);
+
+    void ReadRange(LoadingJob *job, size_t offset, size_t length);
+
+    void ReportProgress(LoadingJob *job, size_t bytesRead);
+
+    void FinishJob(LoadingJob *job, bool loadSuccessful);
+
+    AAssetManager *mAssetManager;
+    int mWorkerCount;
+
     std::mutex mThreadMutex;
-    std::thread mThread GUARDED_BY(mThreadMutex);
+    std::vector<std::thread> mThreads GUARDED_BY(mThreadMutex);
 
     std::mutex mWorkMutex;
     bool mIsActive GUARDED_BY(mWorkMutex) = true;
-    std::queue<LoadingJob *> mWorkQueue GUARDED_BY(mWorkMutex);
+    LoadingJobId mLastJobId GUARDED_BY(mWorkMutex) = INVALID_LOADING_JOB_ID;
+    std::deque<LoadingTask> mLanes[LOADING_PRIORITY_COUNT] GUARDED_BY(mWorkMutex);
+    // Jobs are recycled rather than allocated for each load. A deque keeps them at
+    // stable addresses as it grows.
+    std::deque<LoadingJob> mJobs GUARDED_BY(mWorkMutex);
+    std::vector<LoadingJob *> mFreeJobs GUARDED_BY(mWorkMutex);
     std::condition_variable_any mWorkCondition;
 };
 
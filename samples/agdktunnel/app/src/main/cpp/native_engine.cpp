@@ -39,6 +39,9 @@
 // max # of GL errors to print before giving up
 #define MAX_GL_ERRORS 200
 
+// max # of texture mip levels to upload each frame once textures are created
+#define TEXTURE_STREAMING_LEVELS_PER_FRAME 1
+
 static NativeEngine *_singleton = NULL;
 
 // workaround for internal bug b/149866792
@@ -902,6 +905,11 @@ void NativeEngine::DoFrame() {
     // render!
     mgr->DoFrame();
 
+    // upload the next mip levels of recently created textures
+    if (mTextureManager != NULL) {
+        mTextureManager->UpdateStreaming(TEXTURE_STREAMING_LEVELS_PER_FRAME);
+    }
+
     // swap buffers
     if (!SwappyGL_swap(mEglDisplay, mEglSurface)) {        // failed to swap buffers...
         ALOGW("NativeEngine: SwappyGL_swap failed, EGL error %d", eglGetError());
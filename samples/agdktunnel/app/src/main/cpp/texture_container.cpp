@@ -0,0 +1,319 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "texture_container.hpp"
+
+namespace {
+
+const char *ASTC_EXTENSION = "GL_OES_texture_compression_astc";
+const char *S3TC_EXTENSION = "GL_EXT_texture_compression_s3tc";
+
+// glInternalFormat, vkFormat, block width, block height, bytes per block, GL extension
+const TextureFormatInfo TEXTURE_FORMATS[] = {
+        // ETC2
+        {0x9274, 147, 4, 4, 8, NULL},  // GL_COMPRESSED_RGB8_ETC2
+        {0x9275, 148, 4, 4, 8, NULL},  // GL_COMPRESSED_SRGB8_ETC2
+        {0x9276, 149, 4, 4, 8, NULL},  // GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2
+        {0x9277, 150, 4, 4, 8, NULL},  // GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2
+        {0x9278, 151, 4, 4, 16, NULL}, // GL_COMPRESSED_RGBA8_ETC2_EAC
+        {0x9279, 152, 4, 4, 16, NULL}, // GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC
+        // S3TC / BC1-3
+        {0x83F0, 131, 4, 4, 8, S3TC_EXTENSION},  // GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+        {0x83F1, 133, 4, 4, 8, S3TC_EXTENSION},  // GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+        {0x83F2, 135, 4, 4, 16, S3TC_EXTENSION}, // GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+        {0x83F3, 137, 4, 4, 16, S3TC_EXTENSION}, // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+        // ASTC, linear then sRGB
+        {0x93B0, 157, 4, 4, 16, ASTC_EXTENSION},
+        {0x93B1, 159, 5, 4, 16, ASTC_EXTENSION},
+        {0x93B2, 161, 5, 5, 16, ASTC_EXTENSION},
+        {0x93B3, 163, 6, 5, 16, ASTC_EXTENSION},
+        {0x93B4, 165, 6, 6, 16, ASTC_EXTENSION},
+        {0x93B5, 167, 8, 5, 16, ASTC_EXTENSION},
+        {0x93B6, 169, 8, 6, 16, ASTC_EXTENSION},
+        {0x93B7, 171, 8, 8, 16, ASTC_EXTENSION},
+        {0x93B8, 173, 10, 5, 16, ASTC_EXTENSION},
+        {0x93B9, 175, 10, 6, 16, ASTC_EXTENSION},
+        {0x93BA, 177, 10, 8, 16, ASTC_EXTENSION},
+        {0x93BB, 179, 10, 10, 16, ASTC_EXTENSION},
+        {0x93BC, 181, 12, 10, 16, ASTC_EXTENSION},
+        {0x93BD, 183, 12, 12, 16, ASTC_EXTENSION},
+        {0x93D0, 158, 4, 4, 16, ASTC_EXTENSION},
+        {0x93D1, 160, 5, 4, 16, ASTC_EXTENSION},
+        {0x93D2, 162, 5, 5, 16, ASTC_EXTENSION},
+        {0x93D3, 164, 6, 5, 16, ASTC_EXTENSION},
+        {0x93D4, 166, 6, 6, 16, ASTC_EXTENSION},
+        {0x93D5, 168, 8, 5, 16, ASTC_EXTENSION},
+        {0x93D6, 170, 8, 6, 16, ASTC_EXTENSION},
+        {0x93D7, 172, 8, 8, 16, ASTC_EXTENSION},
+        {0x93D8, 174, 10, 5, 16, ASTC_EXTENSION},
+        {0x93D9, 176, 10, 6, 16, ASTC_EXTENSION},
+        {0x93DA, 178, 10, 8, 16, ASTC_EXTENSION},
+        {0x93DB, 180, 10, 10, 16, ASTC_EXTENSION},
+        {0x93DC, 182, 12, 10, 16, ASTC_EXTENSION},
+        {0x93DD, 184, 12, 12, 16, ASTC_EXTENSION},
+};
+
+const size_t TEXTURE_FORMAT_COUNT = sizeof(TEXTURE_FORMATS) / sizeof(TEXTURE_FORMATS[0]);
+
+// .astc file format info
+const size_t ASTC_HEADER_SIZE = 16;
+const uint8_t ASTC_MAGIC[] = {0x13, 0xAB, 0xA1, 0x5C};
+
+// .ktx file format info
+const size_t KTX_IDENTIFIER_SIZE = 12;
+const uint8_t KTX_11_IDENTIFIER[KTX_IDENTIFIER_SIZE] = {
+        0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+const uint8_t KTX_20_IDENTIFIER[KTX_IDENTIFIER_SIZE] = {
+        0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+const uint32_t KTX_ENDIAN_REF = 0x04030201;
+// Identifier and 13 uint32_t fields
+const size_t KTX_HEADER_SIZE = KTX_IDENTIFIER_SIZE + 13 * 4;
+// Identifier, 9 uint32_t fields, then the index: 4 uint32_t and 2 uint64_t fields
+const size_t KTX2_HEADER_SIZE = KTX_IDENTIFIER_SIZE + 9 * 4 + 4 * 4 + 2 * 8;
+// byteOffset, byteLength and uncompressedByteLength
+const size_t KTX2_LEVEL_INDEX_ENTRY_SIZE = 3 * 8;
+
+// Container fields are little-endian and not necessarily aligned
+uint32_t ReadU32(const uint8_t *data) {
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+uint64_t ReadU64(const uint8_t *data) {
+    return static_cast<uint64_t>(ReadU32(data)) | (static_cast<uint64_t>(ReadU32(data + 4)) << 32);
+}
+
+uint32_t ReadU24(const uint8_t *data) {
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16);
+}
+
+size_t Align4(size_t value) {
+    return (value + 3) & ~static_cast<size_t>(3);
+}
+
+uint32_t MipDimension(uint32_t dimension, uint32_t level) {
+    uint32_t mipDimension = dimension >> level;
+    return mipDimension > 0 ? mipDimension : 1;
+}
+
+// Checks that [offset, offset + size) is inside the file, without overflowing
+bool IsInFile(uint64_t offset, uint64_t size, size_t fileSize) {
+    return offset <= fileSize && size <= fileSize - offset;
+}
+
+// Fills the dimensions of each level and checks the level data
+bool ValidateLevels(TextureContainer *container, const size_t fileSize) {
+    for (uint32_t level = 0; level < container->mipCount; ++level) {
+        TextureMipLevel &mip = container->mips[level];
+        mip.width = MipDimension(container->width, level);
+        mip.height = MipDimension(container->height, level);
+        if (!IsInFile(mip.offset, mip.size, fileSize)) {
+            return false;
+        }
+        if (container->format != NULL &&
+            container->supercompressionScheme == TEXTURESUPERCOMPRESSION_NONE &&
+            mip.size != GetTextureLevelSize(container->format, mip.width, mip.height)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ParseASTC(const uint8_t *fileData, const size_t fileSize, TextureContainer *container) {
+    const uint8_t blockWidth = fileData[4];
+    const uint8_t blockHeight = fileData[5];
+    const uint8_t blockDepth = fileData[6];
+    if (blockDepth != 1 || ReadU24(fileData + 13) != 1) {
+        // 3D textures aren't supported
+        return false;
+    }
+    container->format = FindASTCTextureFormat(blockWidth, blockHeight);
+    if (container->format == NULL) {
+        return false;
+    }
+    container->glInternalFormat = container->format->glInternalFormat;
+    container->vkFormat = container->format->vkFormat;
+    container->width = ReadU24(fileData + 7);
+    container->height = ReadU24(fileData + 10);
+    container->mipCount = 1;
+    container->mips[0].offset = ASTC_HEADER_SIZE;
+    container->mips[0].size = fileSize - ASTC_HEADER_SIZE;
+    container->mips[0].uncompressedSize = container->mips[0].size;
+    return ValidateLevels(container, fileSize);
+}
+
+bool ParseKTX(const uint8_t *fileData, const size_t fileSize, TextureContainer *container) {
+    const uint8_t *fields = fileData + KTX_IDENTIFIER_SIZE;
+    if (ReadU32(fields) != KTX_ENDIAN_REF) {
+        // Big-endian files would need swapping
+        return false;
+    }
+    container->glInternalFormat = ReadU32(fields + 16);
+    container->width = ReadU32(fields + 24);
+    container->height = ReadU32(fields + 28);
+    const uint32_t pixelDepth = ReadU32(fields + 32);
+    const uint32_t arrayElements = ReadU32(fields + 36);
+    const uint32_t faces = ReadU32(fields + 40);
+    const uint32_t mipLevels = ReadU32(fields + 44);
+    const uint32_t bytesOfKeyValueData = ReadU32(fields + 48);
+    if (container->height == 0 || pixelDepth != 0 || arrayElements != 0 || faces != 1 ||
+        mipLevels > MAX_TEXTURE_MIP_LEVELS) {
+        // Only 2D textures are supported
+        return false;
+    }
+    container->format = FindTextureFormatByGL(container->glInternalFormat);
+    container->vkFormat = container->format != NULL ? container->format->vkFormat : 0;
+    // 0 levels means the mips should be generated when loaded
+    container->mipCount = mipLevels > 0 ? mipLevels : 1;
+
+    // Each level is its uint32_t imageSize then its data, padded to four-byte alignment, as
+    // is the end of the key-value data
+    uint64_t offset = Align4(KTX_HEADER_SIZE + static_cast<uint64_t>(bytesOfKeyValueData));
+    for (uint32_t level = 0; level < container->mipCount; ++level) {
+        if (!IsInFile(offset, 4, fileSize)) {
+            return false;
+        }
+        TextureMipLevel &mip = container->mips[level];
+        mip.size = ReadU32(fileData + offset);
+        mip.offset = offset + 4;
+        mip.uncompressedSize = mip.size;
+        offset = Align4(mip.offset + mip.size);
+    }
+    return ValidateLevels(container, fileSize);
+}
+
+bool ParseKTX2(const uint8_t *fileData, const size_t fileSize, TextureContainer *container) {
+    const uint8_t *fields = fileData + KTX_IDENTIFIER_SIZE;
+    container->vkFormat = ReadU32(fields);
+    container->width = ReadU32(fields + 8);
+    container->height = ReadU32(fields + 12);
+    const uint32_t pixelDepth = ReadU32(fields + 16);
+    const uint32_t layerCount = ReadU32(fields + 20);
+    const uint32_t faceCount = ReadU32(fields + 24);
+    const uint32_t levelCount = ReadU32(fields + 28);
+    container->supercompressionScheme = ReadU32(fields + 32);
+    const uint8_t *index = fields + 36;
+    const uint64_t sgdByteOffset = ReadU64(index + 16);
+    const uint64_t sgdByteLength = ReadU64(index + 24);
+    if (container->height == 0 || pixelDepth != 0 || layerCount != 0 || faceCount != 1 ||
+        levelCount > MAX_TEXTURE_MIP_LEVELS) {
+        // Only 2D textures are supported
+        return false;
+    }
+    // Formats are undefined (0) for BasisLZ, which is transcoded to a format picked at load
+    container->format = FindTextureFormatByVk(container->vkFormat);
+    container->glInternalFormat =
+            container->format != NULL ? container->format->glInternalFormat : 0;
+    container->mipCount = levelCount > 0 ? levelCount : 1;
+    if (!IsInFile(sgdByteOffset, sgdByteLength, fileSize)) {
+        return false;
+    }
+    container->supercompressionGlobalDataOffset = sgdByteLength > 0 ? sgdByteOffset : 0;
+    container->supercompressionGlobalDataSize = sgdByteLength;
+
+    const size_t levelIndexSize = container->mipCount * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+    if (!IsInFile(KTX2_HEADER_SIZE, levelIndexSize, fileSize)) {
+        return false;
+    }
+    const uint8_t *levelIndex = fileData + KTX2_HEADER_SIZE;
+    for (uint32_t level = 0; level < container->mipCount; ++level) {
+        const uint8_t *entry = levelIndex + level * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+        const uint64_t byteOffset = ReadU64(entry);
+        const uint64_t byteLength = ReadU64(entry + 8);
+        if (!IsInFile(byteOffset, byteLength, fileSize)) {
+            return false;
+        }
+        TextureMipLevel &mip = container->mips[level];
+        mip.offset = byteOffset;
+        mip.size = byteLength;
+        mip.uncompressedSize = ReadU64(entry + 16);
+    }
+    return ValidateLevels(container, fileSize);
+}
+
+}
+
+const TextureFormatInfo *FindTextureFormatByGL(uint32_t glInternalFormat) {
+    for (size_t i = 0; i < TEXTURE_FORMAT_COUNT; ++i) {
+        if (TEXTURE_FORMATS[i].glInternalFormat == glInternalFormat) {
+            return &TEXTURE_FORMATS[i];
+        }
+    }
+    return NULL;
+}
+
+const TextureFormatInfo *FindTextureFormatByVk(uint32_t vkFormat) {
+    for (size_t i = 0; i < TEXTURE_FORMAT_COUNT; ++i) {
+        if (TEXTURE_FORMATS[i].vkFormat == vkFormat) {
+            return &TEXTURE_FORMATS[i];
+        }
+    }
+    return NULL;
+}
+
+const TextureFormatInfo *FindASTCTextureFormat(uint32_t blockWidth, uint32_t blockHeight) {
+    // .astc files don't tell linear from sRGB, the linear formats come first in the table
+    for (size_t i = 0; i < TEXTURE_FORMAT_COUNT; ++i) {
+        const TextureFormatInfo &format = TEXTURE_FORMATS[i];
+        if (format.glExtension == ASTC_EXTENSION && format.blockWidth == blockWidth &&
+            format.blockHeight == blockHeight) {
+            return &format;
+        }
+    }
+    return NULL;
+}
+
+size_t GetTextureLevelSize(const TextureFormatInfo *format, uint32_t width, uint32_t height) {
+    const size_t blocksWide = (width + format->blockWidth - 1) / format->blockWidth;
+    const size_t blocksHigh = (height + format->blockHeight - 1) / format->blockHeight;
+    return blocksWide * blocksHigh * format->bytesPerBlock;
+}
+
+TextureContainerType GetTextureContainerType(const uint8_t *fileData, const size_t fileSize) {
+    if (fileSize > ASTC_HEADER_SIZE && memcmp(fileData, ASTC_MAGIC, sizeof(ASTC_MAGIC)) == 0) {
+        return TEXTURECONTAINER_ASTC;
+    }
+    if (fileSize > KTX_HEADER_SIZE &&
+        memcmp(fileData, KTX_11_IDENTIFIER, KTX_IDENTIFIER_SIZE) == 0) {
+        return TEXTURECONTAINER_KTX;
+    }
+    if (fileSize > KTX2_HEADER_SIZE &&
+        memcmp(fileData, KTX_20_IDENTIFIER, KTX_IDENTIFIER_SIZE) == 0) {
+        return TEXTURECONTAINER_KTX2;
+    }
+    return TEXTURECONTAINER_UNKNOWN;
+}
+
+bool ParseTextureContainer(const uint8_t *fileData, const size_t fileSize,
+                           TextureContainer *container) {
+    memset(container, 0, sizeof(*container));
+    container->type = GetTextureContainerType(fileData, fileSize);
+    switch (container->type) {
+        case TEXTURECONTAINER_ASTC:
+            return ParseASTC(fileData, fileSize, container);
+        case TEXTURECONTAINER_KTX:
+            return ParseKTX(fileData, fileSize, container);
+        case TEXTURECONTAINER_KTX2:
+            return ParseKTX2(fileData, fileSize, container);
+        default:
+            return false;
+    }
+}
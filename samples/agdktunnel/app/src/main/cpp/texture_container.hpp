@@ -0,0 +1,103 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     https://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef agdktunnel_texture_container_hpp
+#define agdktunnel_texture_container_hpp
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Parsing of texture container files (.ktx, .ktx2 and .astc) into a format description and
+ * the layout of their mip levels. This doesn't use GL, so it can run on any thread or host:
+ * formats are described by their GL and Vulkan enum values.
+ */
+
+#define MAX_TEXTURE_MIP_LEVELS 16
+
+enum TextureContainerType {
+    TEXTURECONTAINER_UNKNOWN = 0,
+    TEXTURECONTAINER_KTX,
+    TEXTURECONTAINER_KTX2,
+    TEXTURECONTAINER_ASTC
+};
+
+// KTX2 supercompressionScheme values
+enum TextureSupercompression {
+    TEXTURESUPERCOMPRESSION_NONE = 0,
+    TEXTURESUPERCOMPRESSION_BASISLZ = 1,
+    TEXTURESUPERCOMPRESSION_ZSTD = 2,
+    TEXTURESUPERCOMPRESSION_ZLIB = 3
+};
+
+struct TextureFormatInfo {
+    uint32_t glInternalFormat;
+    uint32_t vkFormat;
+    uint32_t blockWidth;
+    uint32_t blockHeight;
+    uint32_t bytesPerBlock;
+    // GL extension required for the format, NULL for formats of core GLES 3.0
+    const char *glExtension;
+};
+
+struct TextureMipLevel {
+    uint32_t width;
+    uint32_t height;
+    // Position of the level data from the start of the file and its size in the file
+    size_t offset;
+    size_t size;
+    // Size of the level data once supercompression is removed, equal to size without it
+    uint64_t uncompressedSize;
+};
+
+struct TextureContainer {
+    TextureContainerType type;
+    // NULL if the format isn't in the format table, in which case the values of the file are
+    // still in glInternalFormat and vkFormat
+    const TextureFormatInfo *format;
+    uint32_t glInternalFormat;
+    uint32_t vkFormat;
+    uint32_t width;
+    uint32_t height;
+    uint32_t supercompressionScheme;
+    // Supercompression global data of the file, like the BasisLZ codebooks, 0 size if none
+    size_t supercompressionGlobalDataOffset;
+    size_t supercompressionGlobalDataSize;
+    // mips[0] is the full size level
+    uint32_t mipCount;
+    TextureMipLevel mips[MAX_TEXTURE_MIP_LEVELS];
+};
+
+// Format table lookups, return NULL for unknown formats
+const TextureFormatInfo *FindTextureFormatByGL(uint32_t glInternalFormat);
+
+const TextureFormatInfo *FindTextureFormatByVk(uint32_t vkFormat);
+
+const TextureFormatInfo *FindASTCTextureFormat(uint32_t blockWidth, uint32_t blockHeight);
+
+// Size in bytes of a level of a 2D texture in a block compressed format
+size_t GetTextureLevelSize(const TextureFormatInfo *format, uint32_t width, uint32_t height);
+
+// Identifies the container from the start of the file
+TextureContainerType GetTextureContainerType(const uint8_t *fileData, const size_t fileSize);
+
+// Parses the header and mip level layout of a 2D texture file, checking that every level is
+// inside the file and, for known formats without supercompression, of the expected size.
+// Returns false if the file is unsupported or corrupted.
+bool ParseTextureContainer(const uint8_t *fileData, const size_t fileSize,
+                           TextureContainer *container);
+
+#endif
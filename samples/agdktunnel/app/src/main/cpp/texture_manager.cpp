@@ -21,243 +21,29 @@
 #include <GLES3/gl3.h>
 #include <GLES3/gl3ext.h>
 
-enum TextureFileFormat {
-    TEXTUREFILE_KTX = 0,
-    TEXTUREFILE_ASTC,
-    TEXTUREFILE_UNKNOWN
-};
-
-// ETC2 bpp sizes
-#if 0
-static const uint32_t ETC2_BitsPerPixel[] = {
-        4, // GL_COMPRESSED_RGB8_ETC2
-        4, // GL_COMPRESSED_SRGB8_ETC2
-        4, // GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2
-        4, // GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2
-        8, // GL_COMPRESSED_RGBA8_ETC2_EAC
-        8  // GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC
-};
-#endif
-// ASTC GL internalformat values
-static const GLenum COMPRESSED_RGBA_ASTC_4x4_KHR = 0x93B0;
-static const GLenum COMPRESSED_RGBA_ASTC_5x4_KHR = 0x93B1;
-static const GLenum COMPRESSED_RGBA_ASTC_5x5_KHR = 0x93B2;
-static const GLenum COMPRESSED_RGBA_ASTC_6x5_KHR = 0x93B3;
-static const GLenum COMPRESSED_RGBA_ASTC_6x6_KHR = 0x93B4;
-static const GLenum COMPRESSED_RGBA_ASTC_8x5_KHR = 0x93B5;
-static const GLenum COMPRESSED_RGBA_ASTC_8x6_KHR = 0x93B6;
-static const GLenum COMPRESSED_RGBA_ASTC_8x8_KHR = 0x93B7;
-static const GLenum COMPRESSED_RGBA_ASTC_10x5_KHR = 0x93B8;
-static const GLenum COMPRESSED_RGBA_ASTC_10x6_KHR = 0x93B9;
-static const GLenum COMPRESSED_RGBA_ASTC_10x8_KHR = 0x93BA;
-static const GLenum COMPRESSED_RGBA_ASTC_10x10_KHR = 0x93BB;
-static const GLenum COMPRESSED_RGBA_ASTC_12x10_KHR = 0x93BC;
-static const GLenum COMPRESSED_RGBA_ASTC_12x12_KHR = 0x93BD;
-
-// .astc file format info
 static const char *ASTC_EXTENSION_STRING = "GL_OES_texture_compression_astc";
-static const int ASTC_MAGIC_SIZE = 4;
-static const uint8_t ASTC_MAGIC[ASTC_MAGIC_SIZE] = {0x13, 0xAB, 0xA1, 0x5C};
-
-struct ASTCHeader {
-    uint8_t magic[ASTC_MAGIC_SIZE];
-    uint8_t blockWidth;
-    uint8_t blockHeight;
-    uint8_t blockDepth;
-    uint8_t texWidth[3];
-    uint8_t texHeight[3];
-    uint8_t texDepth[3];
-};
-
-
-// .ktx file format info
-static const int KTX_IDENTIFIER_SIZE = 12;
-static const uint8_t KTX_11_IDENTIFIER[KTX_IDENTIFIER_SIZE] = {
-        0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
-};
-
-struct KTXHeader {
-    uint8_t identifier[12];
-    uint32_t endianness;
-    uint32_t glType;
-    uint32_t glTypeSize;
-    uint32_t glFormat;
-    uint32_t glInternalFormat;
-    uint32_t glBaseInternalFormat;
-    uint32_t pixelWidth;
-    uint32_t pixelHeight;
-    uint32_t pixelDepth;
-    uint32_t numberOfArrayElements;
-    uint32_t numberOfFaces;
-    uint32_t numberOfMipmapLevels;
-    uint32_t bytesOfKeyValueData;
-};
-
-// File format identification utility function
-static TextureFileFormat GetFileFormat(const uint8_t *fileData, const size_t fileSize) {
-    if (fileSize > sizeof(ASTCHeader)) {
-        bool bValidMagic = true;
-        for (int i = 0; i < ASTC_MAGIC_SIZE; ++i) {
-            if (fileData[i] != ASTC_MAGIC[i]) {
-                bValidMagic = false;
-                break;
-            }
-        }
-        if (bValidMagic) {
-            return TEXTUREFILE_ASTC;
-        }
-    }
 
-    if (fileSize > sizeof(KTXHeader)) {
-        bool bValidIdentifier = true;
-        for (int i = 0; i < KTX_IDENTIFIER_SIZE; ++i) {
-            if (fileData[i] != KTX_11_IDENTIFIER[i]) {
-                bValidIdentifier = false;
-                break;
-            }
-        }
-        if (bValidIdentifier) {
-            return TEXTUREFILE_KTX;
-        }
+// Levels whose dimensions fall to the block size or below aren't used
+static uint32_t GetUsableMipCount(const TextureContainer &container) {
+    uint32_t usableMipCount = 1;
+    while (usableMipCount < container.mipCount &&
+           container.mips[usableMipCount].width > container.format->blockWidth &&
+           container.mips[usableMipCount].height > container.format->blockHeight) {
+        ++usableMipCount;
     }
-    return TEXTUREFILE_UNKNOWN;
+    return usableMipCount;
 }
 
-// .astc texture file loader
-static bool
-CreateFromASTCFile(const uint8_t *fileData, const size_t fileSize, GLuint *textureID) {
-    bool success = false;
-    const ASTCHeader *header = reinterpret_cast<const ASTCHeader *>(fileData);
-    if (header->blockDepth == 1 && header->texDepth[0] == 1) {
-        GLsizei textureWidth =
-                header->texWidth[0] | (header->texWidth[1] << 8) | (header->texWidth[2] << 8);
-        GLsizei textureHeight = header->texHeight[0] | (header->texHeight[1] << 8) |
-                                (header->texHeight[2] << 8);
-        GLenum textureFormat = 0;
-        const GLsizei textureSize = static_cast<const GLsizei>(fileSize - sizeof(ASTCHeader));
-
-        switch (header->blockWidth) {
-            case 4:
-                if (header->blockHeight == 4) textureFormat = COMPRESSED_RGBA_ASTC_4x4_KHR;
-                break;
-            case 5:
-                if (header->blockHeight == 4) textureFormat = COMPRESSED_RGBA_ASTC_5x4_KHR;
-                else if (header->blockHeight == 5) textureFormat = COMPRESSED_RGBA_ASTC_5x5_KHR;
-                break;
-            case 6:
-                if (header->blockHeight == 5) textureFormat = COMPRESSED_RGBA_ASTC_6x5_KHR;
-                else if (header->blockHeight == 6) textureFormat = COMPRESSED_RGBA_ASTC_6x6_KHR;
-                break;
-            case 8:
-                if (header->blockHeight == 5) textureFormat = COMPRESSED_RGBA_ASTC_8x5_KHR;
-                else if (header->blockHeight == 6) textureFormat = COMPRESSED_RGBA_ASTC_8x6_KHR;
-                else if (header->blockHeight == 8) textureFormat = COMPRESSED_RGBA_ASTC_8x8_KHR;
-                break;
-            case 10:
-                if (header->blockHeight == 5) textureFormat = COMPRESSED_RGBA_ASTC_10x5_KHR;
-                else if (header->blockHeight == 6)
-                    textureFormat = COMPRESSED_RGBA_ASTC_10x6_KHR;
-                else if (header->blockHeight == 8)
-                    textureFormat = COMPRESSED_RGBA_ASTC_10x8_KHR;
-                else if (header->blockHeight == 10)
-                    textureFormat = COMPRESSED_RGBA_ASTC_10x10_KHR;
-                break;
-            case 12:
-                if (header->blockHeight == 10) textureFormat = COMPRESSED_RGBA_ASTC_12x10_KHR;
-                else if (header->blockHeight == 12)
-                    textureFormat = COMPRESSED_RGBA_ASTC_12x12_KHR;
-                break;
-            default:
-                break;
-        }
-
-        if (textureFormat > 0) {
-            const void *textureData = reinterpret_cast<const void *>(header + 1);
-            glGetError();
-            glGenTextures(1, textureID);
-            glBindTexture(GL_TEXTURE_2D, *textureID);
-            glCompressedTexImage2D(GL_TEXTURE_2D, 0, textureFormat, textureWidth, textureHeight,
-                                   0, textureSize, textureData);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            GLenum glErr = glGetError();
-            if (glErr == GL_NO_ERROR) {
-                success = true;
-            } else {
-                ALOGE("CreateFromASTCFile glCompressedTexImage2D error %d", glErr);
-            }
-        }
+static TextureManager::TextureFormat GetTextureFormatFamily(const TextureFormatInfo *format) {
+    if (format->glExtension == NULL) {
+        return TextureManager::TEXTUREFORMAT_ETC2;
+    } else if (strcmp(format->glExtension, ASTC_EXTENSION_STRING) == 0) {
+        return TextureManager::TEXTUREFORMAT_ASTC;
     }
-    return success;
-}
-
-// .ktx texture file loader
-// This is not a robust KTX loader, ala libktx. It is only intended to load the KTX 1.1
-// ETC2 format, mip-mapped 2D texture files included with this example
-static bool
-CreateFromKTXFile(const uint8_t *fileData, const size_t /*fileSize*/, GLuint *textureID,
-                  uint32_t *textureMipCount) {
-    bool success = false;
-    const KTXHeader *header = reinterpret_cast<const KTXHeader *>(fileData);
-    // end of key-value data is padded to four-byte alignment
-    const size_t textureOffset = (sizeof(KTXHeader) + header->bytesOfKeyValueData + 3) & (~3);
-    const uint32_t *textureSize = reinterpret_cast<const uint32_t *>(fileData + textureOffset);
-    const uint8_t *textureData = reinterpret_cast<const uint8_t *>(textureSize + 1);
-
-    uint32_t currentMipWidth = header->pixelWidth;
-    uint32_t currentMipHeight = header->pixelHeight;
-    if (header->glInternalFormat >= GL_COMPRESSED_RGB8_ETC2 &&
-        header->glInternalFormat <= GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC) {
-        const GLint minFilter = header->numberOfMipmapLevels > 1 ?
-                                GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
-        // Clear error
-        glGetError();
-
-        glGenTextures(1, textureID);
-        glBindTexture(GL_TEXTURE_2D, *textureID);
-
-        uint32_t actualMipCount = 0;
-        for (uint32_t currentMipLevel = 0; currentMipLevel < header->numberOfMipmapLevels;
-             ++currentMipLevel) {
-            const uint32_t currentMipSize = *textureSize;
-            glCompressedTexImage2D(GL_TEXTURE_2D, currentMipLevel, header->glInternalFormat,
-                                   currentMipWidth, currentMipHeight,
-                                   0, currentMipSize, textureData);
-
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-            GLenum glErr = glGetError();
-            if (glErr == GL_NO_ERROR) {
-                success = true;
-            } else {
-                success = false;
-                ALOGE("CreateFromKTXFile glCompressedTexImage2D error %d", glErr);
-                break;
-            }
-            textureSize = reinterpret_cast<const uint32_t *>(textureData + currentMipSize);
-            textureData = reinterpret_cast<const uint8_t *>(textureSize + 1);
-
-            currentMipWidth >>= 1;
-            currentMipHeight >>= 1;
-            ++actualMipCount;
-            // Drop out if we fall block the 4x4 block size
-            if (currentMipWidth <= 4 || currentMipHeight <= 4) {
-                break;
-            }
-        }
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, actualMipCount - 1);
-        *textureMipCount = actualMipCount;
-    }
-    return success;
+    return TextureManager::TEXTUREFORMAT_S3TC;
 }
 
 TextureManager::TextureManager() {
-    mDeviceSupportsASTC = false;
     mLastTextureFormat = TEXTUREFORMAT_ETC2;
 
     GLint extensionCount = 0;
@@ -265,15 +51,18 @@ TextureManager::TextureManager() {
     glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
     for (GLint i = 0; i < extensionCount; i++) {
         const GLubyte *extensionString = glGetStringi(GL_EXTENSIONS, i);
-        if (strcmp(reinterpret_cast<const char *>(extensionString), ASTC_EXTENSION_STRING) == 0) {
-            mDeviceSupportsASTC = true;
-            break;
-        }
+        mExtensions.push_back(reinterpret_cast<const char *>(extensionString));
     }
-    ALOGI("ASTC Textures: %s", (mDeviceSupportsASTC ? "Supported" : "Not Supported"));
+    ALOGI("ASTC Textures: %s",
+          (IsExtensionSupported(ASTC_EXTENSION_STRING) ? "Supported" : "Not Supported"));
 }
 
 TextureManager::~TextureManager() {
+    for (std::vector<StreamingTexture>::iterator iter = mStreamingTextures.begin();
+         iter != mStreamingTextures.end(); ++iter) {
+        free((void *) iter->fileData);
+    }
+    mStreamingTextures.clear();
     glBindTexture(GL_TEXTURE_2D, 0);
     for (std::vector<TextureReference>::iterator iter = mTextures.begin(); iter != mTextures.end();
          ++iter) {
@@ -307,27 +96,112 @@ bool TextureManager::LoadTexture(const char *textureName) {
 
 bool TextureManager::CreateTexture(const char *textureName, const size_t textureSize,
                                    const uint8_t *textureData) {
-    bool success = false;
-    const TextureFileFormat fileFormat = GetFileFormat(textureData, textureSize);
+    TextureContainer container;
+    if (!ParseTextureContainer(textureData, textureSize, &container)) {
+        ALOGE("TextureManager: unknown or corrupted texture file: %s", textureName);
+        free((void *) textureData);
+        return false;
+    }
+    if (container.supercompressionScheme != TEXTURESUPERCOMPRESSION_NONE) {
+        ALOGE("TextureManager: unsupported supercompression scheme %u in file: %s",
+              container.supercompressionScheme, textureName);
+        free((void *) textureData);
+        return false;
+    }
+    if (container.format == NULL) {
+        ALOGE("TextureManager: unknown texture format 0x%x in file: %s",
+              container.glInternalFormat, textureName);
+        free((void *) textureData);
+        return false;
+    }
+    if (container.format->glExtension != NULL &&
+        !IsExtensionSupported(container.format->glExtension)) {
+        ALOGE("TextureManager: %s not supported for file: %s", container.format->glExtension,
+              textureName);
+        free((void *) textureData);
+        return false;
+    }
+
+    const uint32_t textureMipCount = GetUsableMipCount(container);
+    const GLint minFilter = textureMipCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+    // Clear error
+    glGetError();
+
     GLuint textureID = 0;
-    uint32_t textureMipCount = 1;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexStorage2D(GL_TEXTURE_2D, textureMipCount, container.glInternalFormat, container.width,
+                   container.height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, textureMipCount - 1);
+
+    // Upload from the smallest level, the smallest is always uploaded so the texture is complete
+    uint32_t baseLevel = textureMipCount;
+    bool success = true;
+    do {
+        --baseLevel;
+        success = UploadLevel(textureID, textureData, container, baseLevel);
+    } while (success && baseLevel > 0 &&
+             container.mips[baseLevel - 1].width <= STREAMING_INITIAL_MAX_DIMENSION &&
+             container.mips[baseLevel - 1].height <= STREAMING_INITIAL_MAX_DIMENSION);
+
+    if (!success) {
+        glDeleteTextures(1, &textureID);
+        free((void *) textureData);
+        return false;
+    }
 
-    if (fileFormat == TEXTUREFILE_ASTC && mDeviceSupportsASTC) {
-        success = CreateFromASTCFile(textureData, textureSize, &textureID);
-        mLastTextureFormat = TEXTUREFORMAT_ASTC;
-    } else if (fileFormat == TEXTUREFILE_KTX) {
-        success = CreateFromKTXFile(textureData, textureSize, &textureID, &textureMipCount);
-        mLastTextureFormat = TEXTUREFORMAT_ETC2;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseLevel);
+    if (baseLevel > 0) {
+        mStreamingTextures.push_back({textureID, textureData, container, baseLevel});
     } else {
-        ALOGE("TextureManager: unknown texture file format in file: %s", textureName);
+        free((void *) textureData);
     }
+    mLastTextureFormat = GetTextureFormatFamily(container.format);
+    mTextures.push_back(TextureManager::TextureReference(textureMipCount, textureName,
+                                                         static_cast<uint64_t>(textureID)));
+    return true;
+}
 
-    if (success) {
-        mTextures.push_back(TextureManager::TextureReference(textureMipCount, textureName,
-                                                             static_cast<uint64_t>(textureID)));
+void TextureManager::UpdateStreaming(uint32_t maxLevelUploads) {
+    if (mStreamingTextures.empty()) {
+        return;
     }
-    free((void *) textureData);
-    return success;
+    // Clear error
+    glGetError();
+    std::vector<StreamingTexture>::iterator iter = mStreamingTextures.begin();
+    while (iter != mStreamingTextures.end() && maxLevelUploads > 0) {
+        --maxLevelUploads;
+        bool success = UploadLevel(iter->textureID, iter->fileData, iter->container,
+                                   iter->baseLevel - 1);
+        if (success) {
+            --iter->baseLevel;
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, iter->baseLevel);
+        }
+        // On failure, keep rendering with the levels already uploaded
+        if (!success || iter->baseLevel == 0) {
+            free((void *) iter->fileData);
+            iter = mStreamingTextures.erase(iter);
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool TextureManager::UploadLevel(uint32_t textureID, const uint8_t *fileData,
+                                 const TextureContainer &container, uint32_t level) {
+    const TextureMipLevel &mip = container.mips[level];
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, mip.width, mip.height,
+                              container.glInternalFormat, mip.size, fileData + mip.offset);
+    GLenum glErr = glGetError();
+    if (glErr != GL_NO_ERROR) {
+        ALOGE("TextureManager: glCompressedTexSubImage2D error %d on level %u", glErr, level);
+        return false;
+    }
+    return true;
 }
 
 uint32_t TextureManager::GetTextureMipCount(const char *textureName) {
@@ -350,3 +224,13 @@ TextureManager::TextureReference TextureManager::FindReferenceForName(const char
     TextureManager::TextureReference emptyReference(0, NULL, INVALID_TEXTURE_REF);
     return emptyReference;
 }
+
+bool TextureManager::IsExtensionSupported(const char *extension) {
+    for (std::vector<const char *>::iterator iter = mExtensions.begin();
+         iter != mExtensions.end(); ++iter) {
+        if (strcmp(extension, *iter) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -19,6 +19,7 @@
 
 #include <cstdint>
 #include <vector>
+#include "texture_container.hpp"
 #include "util.hpp"
 
 class GameAssetManager;
@@ -26,6 +27,8 @@ class GameAssetManager;
 /*
  * A very basic texture manager that handles loading compressed texture
  * files and generating GLES textures.
+ * Textures are created with their small mip levels only, the larger levels
+ * are uploaded over the following frames by UpdateStreaming, largest last.
  */
 class TextureManager {
 public:
@@ -34,9 +37,13 @@ public:
     enum TextureFormat {
         TEXTUREFORMAT_RGBA8888 = 0,
         TEXTUREFORMAT_ETC2,
-        TEXTUREFORMAT_ASTC
+        TEXTUREFORMAT_ASTC,
+        TEXTUREFORMAT_S3TC
     };
 
+    // Levels up to this size are uploaded when the texture is created
+    static const uint32_t STREAMING_INITIAL_MAX_DIMENSION = 512;
+
     TextureManager();
 
     ~TextureManager();
@@ -45,9 +52,15 @@ public:
 
     bool LoadTexture(const char *textureName);
 
+    // Takes ownership of textureData, which was allocated with malloc
     bool
     CreateTexture(const char *textureName, const size_t textureSize, const uint8_t *textureData);
 
+    // Uploads up to maxLevelUploads of the mip levels still pending, to be called once per frame
+    void UpdateStreaming(uint32_t maxLevelUploads);
+
+    bool IsStreaming() const { return !mStreamingTextures.empty(); }
+
     uint32_t GetTextureMipCount(const char *textureName);
 
     uint64_t GetTextureReference(const char *textureName);
@@ -69,11 +82,26 @@ private:
         uint64_t mTextureReference;
     };
 
+    // A texture with mip levels still to upload, from baseLevel - 1 down to 0
+    struct StreamingTexture {
+        uint32_t textureID;
+        const uint8_t *fileData;
+        TextureContainer container;
+        uint32_t baseLevel;
+    };
+
     TextureReference FindReferenceForName(const char *textureName);
 
+    bool IsExtensionSupported(const char *extension);
+
+    bool UploadLevel(uint32_t textureID, const uint8_t *fileData,
+                     const TextureContainer &container, uint32_t level);
+
     std::vector<TextureReference> mTextures;
+    std::vector<StreamingTexture> mStreamingTextures;
+    // Owned by the GL context
+    std::vector<const char *> mExtensions;
     TextureFormat mLastTextureFormat;
-    bool mDeviceSupportsASTC;
 };
 
 #endif
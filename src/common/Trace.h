@@ -22,6 +22,8 @@
 
 #include <memory>
 
+#include "TraceRecorder.h"
+
 namespace gamesdk {
 
 class Trace {
@@ -101,11 +103,16 @@ class Trace {
 
     bool isAvailable() const { return ATrace_beginSection != nullptr; }
 
+    // True if either systrace or the in-process TraceRecorder is recording.
     bool isEnabled() const {
-        return (ATrace_isEnabled != nullptr) && ATrace_isEnabled();
+        return TraceRecorder::isRecording() || isATraceEnabled();
     }
 
     void beginSection(const char *name) const {
+        if (TraceRecorder::isRecording()) {
+            TraceRecorder::getInstance()->beginSection(name);
+        }
+
         if (!ATrace_beginSection) {
             return;
         }
@@ -114,6 +121,10 @@ class Trace {
     }
 
     void endSection() const {
+        if (TraceRecorder::isRecording()) {
+            TraceRecorder::getInstance()->endSection();
+        }
+
         if (!ATrace_endSection) {
             return;
         }
@@ -122,7 +133,11 @@ class Trace {
     }
 
     void beginAsyncSection(const char *name, int64_t value) {
-        if (!ATrace_beginAsyncSection || !isEnabled()) {
+        if (TraceRecorder::isRecording()) {
+            TraceRecorder::getInstance()->beginAsyncSection(name, value);
+        }
+
+        if (!ATrace_beginAsyncSection || !isATraceEnabled()) {
             return;
         }
 
@@ -130,7 +145,11 @@ class Trace {
     }
 
     void endAsyncSection(const char *name, int64_t value) {
-        if (!ATrace_endAsyncSection || !isEnabled()) {
+        if (TraceRecorder::isRecording()) {
+            TraceRecorder::getInstance()->endAsyncSection(name, value);
+        }
+
+        if (!ATrace_endAsyncSection || !isATraceEnabled()) {
             return;
         }
 
@@ -138,7 +157,11 @@ class Trace {
     }
 
     void setCounter(const char *name, int64_t value) {
-        if (!ATrace_setCounter || !isEnabled()) {
+        if (TraceRecorder::isRecording()) {
+            TraceRecorder::getInstance()->setCounter(name, value);
+        }
+
+        if (!ATrace_setCounter || !isATraceEnabled()) {
             return;
         }
 
@@ -160,6 +183,10 @@ class Trace {
     };
 
    private:
+    bool isATraceEnabled() const {
+        return (ATrace_isEnabled != nullptr) && ATrace_isEnabled();
+    }
+
     const ATrace_beginSection_type ATrace_beginSection = nullptr;
     const ATrace_endSection_type ATrace_endSection = nullptr;
     const ATrace_isEnabled_type ATrace_isEnabled = nullptr;
@@ -172,7 +199,7 @@ class Trace {
 struct ScopedTrace {
     ScopedTrace(const char *name) {
         Trace *trace = Trace::getInstance();
-        if (!trace->isAvailable() || !trace->isEnabled()) {
+        if (!trace->isEnabled()) {
             return;
         }
 
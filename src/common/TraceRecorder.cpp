@@ -0,0 +1,479 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TraceRecorder.h"
+
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <set>
+#include <utility>
+
+namespace gamesdk {
+
+constexpr size_t TraceRecorder::DEFAULT_EVENTS_PER_THREAD;
+
+std::atomic<bool> TraceRecorder::sRecording = {false};
+
+// Written only by the thread that owns it. Other threads only read the events
+// below count, and only for the generation they expect.
+struct TraceRecorder::ThreadBuffer {
+    bool inUse = true;  // guarded by mThreadsMutex
+    int32_t tid = 0;
+    std::atomic<uint32_t> generation = {0};
+    std::unique_ptr<Event[]> events;
+    size_t capacity = 0;
+    std::atomic<size_t> count = {0};
+    std::atomic<size_t> dropped = {0};
+
+    // Whether the buffer has events that a snapshot of the given generation
+    // would export.
+    bool hasEvents(uint32_t current) const {
+        return generation.load(std::memory_order_acquire) == current &&
+               count.load(std::memory_order_acquire) != 0;
+    }
+    void release() {
+        count.store(0, std::memory_order_release);
+        events.reset();
+        capacity = 0;
+    }
+};
+
+namespace {
+
+int64_t monotonicNowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+int64_t bootNowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+void appendJsonString(std::string& out, const char* s) {
+    out += '"';
+    for (; s != nullptr && *s != '\0'; ++s) {
+        const char c = *s;
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+// Minimal protobuf encoding for the subset of the Perfetto trace format used
+// below (perfetto/trace/trace_packet.proto).
+namespace proto {
+
+enum WireType { VARINT = 0, LENGTH_DELIMITED = 2 };
+
+void appendVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void appendTag(std::string& out, uint32_t field, WireType type) {
+    appendVarint(out, (field << 3) | type);
+}
+
+void appendVarintField(std::string& out, uint32_t field, uint64_t value) {
+    appendTag(out, field, VARINT);
+    appendVarint(out, value);
+}
+
+void appendBytesField(std::string& out, uint32_t field,
+                      const std::string& bytes) {
+    appendTag(out, field, LENGTH_DELIMITED);
+    appendVarint(out, bytes.size());
+    out += bytes;
+}
+
+void appendStringField(std::string& out, uint32_t field, const char* s) {
+    appendBytesField(out, field, s != nullptr ? s : "");
+}
+
+// Field numbers
+constexpr uint32_t TRACE_PACKET = 1;
+constexpr uint32_t PACKET_TIMESTAMP = 8;
+constexpr uint32_t PACKET_SEQUENCE_ID = 10;
+constexpr uint32_t PACKET_TRACK_EVENT = 11;
+constexpr uint32_t PACKET_CLOCK_SNAPSHOT = 6;
+constexpr uint32_t PACKET_TIMESTAMP_CLOCK_ID = 58;
+constexpr uint32_t PACKET_TRACK_DESCRIPTOR = 60;
+constexpr uint32_t CLOCK_SNAPSHOT_CLOCKS = 1;
+constexpr uint32_t CLOCK_ID = 1;
+constexpr uint32_t CLOCK_TIMESTAMP = 2;
+constexpr uint32_t TRACK_UUID = 1;
+constexpr uint32_t TRACK_NAME = 2;
+constexpr uint32_t TRACK_THREAD = 4;
+constexpr uint32_t TRACK_COUNTER = 8;
+constexpr uint32_t THREAD_PID = 1;
+constexpr uint32_t THREAD_TID = 2;
+constexpr uint32_t EVENT_TYPE = 9;
+constexpr uint32_t EVENT_TRACK_UUID = 11;
+constexpr uint32_t EVENT_NAME = 23;
+constexpr uint32_t EVENT_COUNTER_VALUE = 30;
+
+// Enum values
+constexpr uint64_t CLOCK_MONOTONIC_ID = 3;
+constexpr uint64_t CLOCK_BOOTTIME_ID = 6;
+constexpr uint64_t TYPE_SLICE_BEGIN = 1;
+constexpr uint64_t TYPE_SLICE_END = 2;
+constexpr uint64_t TYPE_COUNTER = 4;
+
+constexpr uint32_t SEQUENCE_ID = 1;
+
+}  // namespace proto
+
+uint64_t hashName(const char* s) {
+    uint64_t hash = 0xcbf29ce484222325ULL;  // FNV-1a
+    for (; s != nullptr && *s != '\0'; ++s) {
+        hash = (hash ^ static_cast<unsigned char>(*s)) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Track uuids for the different kinds of tracks, kept apart by their top bits.
+uint64_t threadTrackUuid(int32_t tid) {
+    return (1ULL << 62) | static_cast<uint32_t>(tid);
+}
+uint64_t counterTrackUuid(const char* name) {
+    return (2ULL << 62) | (hashName(name) >> 2);
+}
+uint64_t asyncTrackUuid(const char* name, int64_t cookie) {
+    return (3ULL << 62) |
+           ((hashName(name) ^ (static_cast<uint64_t>(cookie) *
+                               0x9e3779b97f4a7c15ULL)) >>
+            2);
+}
+
+}  // anonymous namespace
+
+TraceRecorder* TraceRecorder::getInstance() {
+    static TraceRecorder recorder;
+    return &recorder;
+}
+
+void TraceRecorder::start(size_t eventsPerThread) {
+    mEventsPerThread = eventsPerThread;
+    // Each thread discards its previous events the next time it records.
+    mGeneration++;
+    {
+        // Events of exited threads were only kept for the previous recording.
+        std::lock_guard<std::mutex> lock(mThreadsMutex);
+        for (const auto& buffer : mThreads) {
+            if (!buffer->inUse) buffer->release();
+        }
+    }
+    sRecording = true;
+}
+
+void TraceRecorder::stop() { sRecording = false; }
+
+// Returns the buffer of a thread to its recorder when the thread exits.
+struct TraceRecorder::ThreadBufferOwner {
+    TraceRecorder* recorder = nullptr;
+    ThreadBuffer* buffer = nullptr;
+    ~ThreadBufferOwner() {
+        if (buffer != nullptr) recorder->releaseThread(buffer);
+    }
+};
+
+TraceRecorder::ThreadBuffer* TraceRecorder::registerThread() {
+    const int32_t tid = static_cast<int32_t>(syscall(SYS_gettid));
+    const uint32_t generation = mGeneration.load(std::memory_order_acquire);
+    std::lock_guard<std::mutex> lock(mThreadsMutex);
+    for (const auto& buffer : mThreads) {
+        if (!buffer->inUse && !buffer->hasEvents(generation)) {
+            // Force a reset on the first record() of the new owner.
+            buffer->generation.store(generation - 1, std::memory_order_release);
+            buffer->inUse = true;
+            buffer->tid = tid;
+            return buffer.get();
+        }
+    }
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->tid = tid;
+    mThreads.push_back(std::move(buffer));
+    return mThreads.back().get();
+}
+
+void TraceRecorder::releaseThread(ThreadBuffer* buffer) {
+    const uint32_t generation = mGeneration.load(std::memory_order_acquire);
+    std::lock_guard<std::mutex> lock(mThreadsMutex);
+    buffer->inUse = false;
+    // Events of the current recording are kept for export, the memory of the
+    // others can be released right away.
+    if (!buffer->hasEvents(generation)) {
+        buffer->release();
+    }
+}
+
+size_t TraceRecorder::threadBufferCount() const {
+    std::lock_guard<std::mutex> lock(mThreadsMutex);
+    return mThreads.size();
+}
+
+void TraceRecorder::record(EventType type, const char* name, int64_t value) {
+    static thread_local ThreadBuffer* buffer = nullptr;
+    if (buffer == nullptr) {
+        // Only constructed on the first event of the thread, so that the hot
+        // path doesn't pay for a thread_local with a destructor.
+        static thread_local ThreadBufferOwner owner;
+        buffer = registerThread();
+        owner.recorder = this;
+        owner.buffer = buffer;
+    }
+
+    const uint32_t generation = mGeneration.load(std::memory_order_acquire);
+    if (buffer->generation.load(std::memory_order_relaxed) != generation) {
+        const size_t capacity = mEventsPerThread;
+        if (buffer->capacity != capacity) {
+            // Value-initialized so that the pages are touched here rather
+            // than while recording.
+            buffer->events.reset(new Event[capacity]());
+            buffer->capacity = capacity;
+        }
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+        buffer->generation.store(generation, std::memory_order_release);
+    }
+
+    const size_t count = buffer->count.load(std::memory_order_relaxed);
+    if (count >= buffer->capacity) {
+        buffer->dropped.store(
+            buffer->dropped.load(std::memory_order_relaxed) + 1,
+            std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[count] = {monotonicNowNs(), name, value, type};
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+std::vector<TraceRecorder::ThreadEvents> TraceRecorder::snapshot() const {
+    std::vector<ThreadEvents> result;
+    const uint32_t generation = mGeneration.load(std::memory_order_acquire);
+    std::lock_guard<std::mutex> lock(mThreadsMutex);
+    for (const auto& buffer : mThreads) {
+        if (buffer->generation.load(std::memory_order_acquire) != generation) {
+            continue;
+        }
+        const size_t count = buffer->count.load(std::memory_order_acquire);
+        if (count == 0) {
+            continue;
+        }
+        result.push_back({buffer->tid,
+                          std::vector<Event>(buffer->events.get(),
+                                             buffer->events.get() + count),
+                          buffer->dropped.load(std::memory_order_relaxed)});
+    }
+    return result;
+}
+
+void TraceRecorder::exportChromeJson(std::string& out) const {
+    const int pid = getpid();
+    char buffer[128];
+    bool first = true;
+
+    out += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (const auto& thread : snapshot()) {
+        for (const auto& event : thread.events) {
+            out += first ? "\n" : ",\n";
+            first = false;
+
+            out += "{\"name\":";
+            appendJsonString(out, event.name);
+            switch (event.type) {
+                case EventType::Begin:
+                    out += ",\"ph\":\"B\"";
+                    break;
+                case EventType::End:
+                    out += ",\"ph\":\"E\"";
+                    break;
+                case EventType::AsyncBegin:
+                case EventType::AsyncEnd:
+                    snprintf(buffer, sizeof(buffer),
+                             ",\"cat\":\"gamesdk\",\"ph\":\"%c\","
+                             "\"id\":\"0x%" PRIx64 "\"",
+                             event.type == EventType::AsyncBegin ? 'b' : 'e',
+                             static_cast<uint64_t>(event.value));
+                    out += buffer;
+                    break;
+                case EventType::Counter:
+                    snprintf(buffer, sizeof(buffer),
+                             ",\"ph\":\"C\",\"args\":{\"value\":%" PRId64 "}",
+                             event.value);
+                    out += buffer;
+                    break;
+            }
+            // Chrome timestamps are in microseconds
+            snprintf(buffer, sizeof(buffer),
+                     ",\"ts\":%" PRId64 ".%03d,\"pid\":%d,\"tid\":%d}",
+                     event.timestampNs / 1000,
+                     static_cast<int>(event.timestampNs % 1000), pid,
+                     thread.tid);
+            out += buffer;
+        }
+    }
+    out += "\n]}\n";
+}
+
+void TraceRecorder::exportPerfetto(std::string& out) const {
+    using namespace proto;
+
+    const int pid = getpid();
+    const auto threads = snapshot();
+    std::string packet;
+    std::string message;
+    std::string nested;
+
+    auto appendPacket = [&]() {
+        appendBytesField(out, TRACE_PACKET, packet);
+        packet.clear();
+    };
+
+    // Tell the trace processor how to map our CLOCK_MONOTONIC timestamps to
+    // its default CLOCK_BOOTTIME.
+    const std::pair<uint64_t, int64_t> clocks[] = {
+        {CLOCK_MONOTONIC_ID, monotonicNowNs()},
+        {CLOCK_BOOTTIME_ID, bootNowNs()},
+    };
+    for (const auto& clock : clocks) {
+        nested.clear();
+        appendVarintField(nested, CLOCK_ID, clock.first);
+        appendVarintField(nested, CLOCK_TIMESTAMP, clock.second);
+        appendBytesField(message, CLOCK_SNAPSHOT_CLOCKS, nested);
+    }
+    appendBytesField(packet, PACKET_CLOCK_SNAPSHOT, message);
+    appendVarintField(packet, PACKET_SEQUENCE_ID, SEQUENCE_ID);
+    appendPacket();
+
+    // Track descriptors
+    std::set<uint64_t> describedTracks;
+    auto describeTrack = [&](uint64_t uuid, const char* name, bool counter) {
+        if (!describedTracks.insert(uuid).second) return;
+        message.clear();
+        appendVarintField(message, TRACK_UUID, uuid);
+        appendStringField(message, TRACK_NAME, name);
+        if (counter) {
+            appendBytesField(message, TRACK_COUNTER, "");
+        }
+        appendBytesField(packet, PACKET_TRACK_DESCRIPTOR, message);
+        appendVarintField(packet, PACKET_SEQUENCE_ID, SEQUENCE_ID);
+        appendPacket();
+    };
+    for (const auto& thread : threads) {
+        const uint64_t uuid = threadTrackUuid(thread.tid);
+        describedTracks.insert(uuid);
+        nested.clear();
+        appendVarintField(nested, THREAD_PID, pid);
+        appendVarintField(nested, THREAD_TID, thread.tid);
+        message.clear();
+        appendVarintField(message, TRACK_UUID, uuid);
+        appendBytesField(message, TRACK_THREAD, nested);
+        appendBytesField(packet, PACKET_TRACK_DESCRIPTOR, message);
+        appendVarintField(packet, PACKET_SEQUENCE_ID, SEQUENCE_ID);
+        appendPacket();
+
+        for (const auto& event : thread.events) {
+            if (event.type == EventType::Counter) {
+                describeTrack(counterTrackUuid(event.name), event.name, true);
+            } else if (event.type == EventType::AsyncBegin ||
+                       event.type == EventType::AsyncEnd) {
+                describeTrack(asyncTrackUuid(event.name, event.value),
+                              event.name, false);
+            }
+        }
+    }
+
+    // Events
+    for (const auto& thread : threads) {
+        for (const auto& event : thread.events) {
+            message.clear();
+            switch (event.type) {
+                case EventType::Begin:
+                    appendVarintField(message, EVENT_TYPE, TYPE_SLICE_BEGIN);
+                    appendVarintField(message, EVENT_TRACK_UUID,
+                                      threadTrackUuid(thread.tid));
+                    appendStringField(message, EVENT_NAME, event.name);
+                    break;
+                case EventType::End:
+                    appendVarintField(message, EVENT_TYPE, TYPE_SLICE_END);
+                    appendVarintField(message, EVENT_TRACK_UUID,
+                                      threadTrackUuid(thread.tid));
+                    break;
+                case EventType::AsyncBegin:
+                    appendVarintField(message, EVENT_TYPE, TYPE_SLICE_BEGIN);
+                    appendVarintField(message, EVENT_TRACK_UUID,
+                                      asyncTrackUuid(event.name, event.value));
+                    appendStringField(message, EVENT_NAME, event.name);
+                    break;
+                case EventType::AsyncEnd:
+                    appendVarintField(message, EVENT_TYPE, TYPE_SLICE_END);
+                    appendVarintField(message, EVENT_TRACK_UUID,
+                                      asyncTrackUuid(event.name, event.value));
+                    break;
+                case EventType::Counter:
+                    appendVarintField(message, EVENT_TYPE, TYPE_COUNTER);
+                    appendVarintField(message, EVENT_TRACK_UUID,
+                                      counterTrackUuid(event.name));
+                    appendVarintField(message, EVENT_COUNTER_VALUE,
+                                      static_cast<uint64_t>(event.value));
+                    break;
+            }
+            appendVarintField(packet, PACKET_TIMESTAMP, event.timestampNs);
+            appendVarintField(packet, PACKET_TIMESTAMP_CLOCK_ID,
+                              CLOCK_MONOTONIC_ID);
+            appendBytesField(packet, PACKET_TRACK_EVENT, message);
+            appendVarintField(packet, PACKET_SEQUENCE_ID, SEQUENCE_ID);
+            appendPacket();
+        }
+    }
+}
+
+bool TraceRecorder::writeToFile(const char* path, Format format) const {
+    std::string out;
+    if (format == Format::ChromeJson) {
+        exportChromeJson(out);
+    } else {
+        exportPerfetto(out);
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    const bool written = fwrite(out.data(), 1, out.size(), file) == out.size();
+    return fclose(file) == 0 && written;
+}
+
+}  // namespace gamesdk
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gamesdk {
+
+// In-process backend for gamesdk::Trace. While recording, every section,
+// async section and counter emitted through Trace is appended to a buffer
+// owned by the emitting thread, so recording takes no lock. The recording can
+// then be exported as Chrome trace JSON (chrome://tracing, ui.perfetto.dev) or
+// as a Perfetto protobuf trace.
+//
+// Event names are stored by pointer: they must outlive the recording, which is
+// the case for the string literals and cached names passed to Trace.
+class TraceRecorder {
+   public:
+    enum class EventType : uint8_t {
+        Begin,
+        End,
+        AsyncBegin,
+        AsyncEnd,
+        Counter
+    };
+
+    struct Event {
+        int64_t timestampNs;  // CLOCK_MONOTONIC
+        const char* name;
+        int64_t value;  // cookie for async sections, value for counters
+        EventType type;
+    };
+
+    struct ThreadEvents {
+        int32_t tid;
+        std::vector<Event> events;
+        size_t dropped;
+    };
+
+    enum class Format { ChromeJson, Perfetto };
+
+    static constexpr size_t DEFAULT_EVENTS_PER_THREAD = 64 * 1024;
+
+    static TraceRecorder* getInstance();
+
+    // Discards any previous recording and starts a new one. Each thread keeps
+    // at most eventsPerThread events, later ones are dropped and counted.
+    void start(size_t eventsPerThread = DEFAULT_EVENTS_PER_THREAD);
+    void stop();
+    static bool isRecording() {
+        return sRecording.load(std::memory_order_relaxed);
+    }
+
+    void beginSection(const char* name) { record(EventType::Begin, name, 0); }
+    void endSection() { record(EventType::End, nullptr, 0); }
+    void beginAsyncSection(const char* name, int64_t cookie) {
+        record(EventType::AsyncBegin, name, cookie);
+    }
+    void endAsyncSection(const char* name, int64_t cookie) {
+        record(EventType::AsyncEnd, name, cookie);
+    }
+    void setCounter(const char* name, int64_t value) {
+        record(EventType::Counter, name, value);
+    }
+
+    // Returns the events of the current (or last) recording, per thread. This
+    // should be called after stop(), or at least not concurrently with start().
+    std::vector<ThreadEvents> snapshot() const;
+
+    void exportChromeJson(std::string& out) const;
+    void exportPerfetto(std::string& out) const;
+    bool writeToFile(const char* path, Format format) const;
+
+    // Number of per-thread buffers currently allocated, for tests.
+    size_t threadBufferCount() const;
+
+   private:
+    struct ThreadBuffer;
+    struct ThreadBufferOwner;
+
+    void record(EventType type, const char* name, int64_t value);
+    ThreadBuffer* registerThread();
+    void releaseThread(ThreadBuffer* buffer);
+
+    static std::atomic<bool> sRecording;
+
+    std::atomic<uint32_t> mGeneration = {0};
+    std::atomic<size_t> mEventsPerThread = {DEFAULT_EVENTS_PER_THREAD};
+
+    mutable std::mutex mThreadsMutex;
+    // Buffers are never destroyed so that threads can keep a raw pointer to
+    // theirs. When a thread exits, its buffer is handed over to the next new
+    // thread once its events are no longer part of the current recording.
+    std::vector<std::unique_ptr<ThreadBuffer>> mThreads;
+};
+
+}  // namespace gamesdk
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "procfs.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace gamesdk {
+namespace procfs {
+
+namespace {
+
+char s_root[kMaxPathLength] = "";
+
+bool IsSpace(char c) { return c == ' ' || c == '\t'; }
+
+const char* SkipSpaces(const char* s) {
+    while (IsSpace(*s)) ++s;
+    return s;
+}
+
+}  // namespace
+
+bool SetRoot(const char* root) {
+    if (root == nullptr) root = "";
+    size_t length = strlen(root);
+    if (length >= kMaxPathLength) return false;
+    memcpy(s_root, root, length + 1);
+    return true;
+}
+
+const char* GetRoot() { return s_root; }
+
+int Open(const char* path) {
+    char full_path[kMaxPathLength];
+    int length = snprintf(full_path, sizeof(full_path), "%s%s", s_root, path);
+    if (length <= 0 || static_cast<size_t>(length) >= sizeof(full_path)) {
+        return -1;
+    }
+    int fd;
+    do {
+        fd = open(full_path, O_RDONLY | O_CLOEXEC);
+    } while (fd < 0 && errno == EINTR);
+    return fd;
+}
+
+int ReadFile(const char* path, char* buffer, size_t size) {
+    if (size == 0) return -1;
+    int fd = Open(path);
+    if (fd < 0) return -1;
+    size_t total = 0;
+    while (total < size - 1) {
+        ssize_t n = read(fd, buffer + total, size - 1 - total);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            close(fd);
+            return -1;
+        }
+        if (n == 0) break;
+        total += n;
+    }
+    close(fd);
+    buffer[total] = '\0';
+    return static_cast<int>(total);
+}
+
+bool ReadLine(const char* path, char* buffer, size_t size) {
+    if (ReadFile(path, buffer, size) < 0) return false;
+    char* newline = strchr(buffer, '\n');
+    if (newline != nullptr) *newline = '\0';
+    return true;
+}
+
+bool ReadInt64(const char* path, int64_t* value) {
+    char buffer[32];
+    if (ReadFile(path, buffer, sizeof(buffer)) < 0) return false;
+    const char* start = SkipSpaces(buffer);
+    char* end;
+    // NOLINTNEXTLINE
+    long long result = strtoll(start, &end, 10);
+    if (end == start) return false;
+    *value = result;
+    return true;
+}
+
+bool Field::KeyIs(const char* k) const {
+    return strlen(k) == key_length && memcmp(key, k, key_length) == 0;
+}
+
+bool ParseField(const char* line, Field* field) {
+    const char* colon = strchr(line, ':');
+    if (colon == nullptr) return false;
+    const char* key = SkipSpaces(line);
+    const char* key_end = colon;
+    while (key_end > key && IsSpace(key_end[-1])) --key_end;
+    field->key = key;
+    field->key_length = key_end - key;
+
+    field->value = SkipSpaces(colon + 1);
+    char* end;
+    // NOLINTNEXTLINE
+    field->number = strtoll(field->value, &end, 10);
+    field->has_number = end != field->value;
+    field->in_kb = false;
+    if (field->has_number) {
+        const char* unit = SkipSpaces(end);
+        field->in_kb = unit != end && strncmp(unit, "kB", 2) == 0 &&
+                       *SkipSpaces(unit + 2) == '\0';
+    }
+    return true;
+}
+
+LineReader::LineReader(const char* path) : fd_(Open(path)) {}
+
+LineReader::~LineReader() {
+    if (fd_ >= 0) close(fd_);
+}
+
+bool LineReader::Fill() {
+    if (eof_ || fd_ < 0) return false;
+    if (begin_ > 0) {
+        memmove(buffer_, buffer_ + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+    ssize_t n;
+    do {
+        n = read(fd_, buffer_ + end_, kBufferSize - end_);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        eof_ = true;
+        return false;
+    }
+    end_ += n;
+    return true;
+}
+
+char* LineReader::NextLine(size_t* length) {
+    while (true) {
+        char* begin = buffer_ + begin_;
+        char* newline =
+            static_cast<char*>(memchr(begin, '\n', end_ - begin_));
+        if (newline != nullptr) {
+            begin_ = newline - buffer_ + 1;
+            if (skip_) {
+                // End of a truncated line.
+                skip_ = false;
+                continue;
+            }
+            *newline = '\0';
+            if (length != nullptr) *length = newline - begin;
+            return begin;
+        }
+        if (skip_) {
+            // Still in a truncated line: drop everything buffered.
+            begin_ = end_ = 0;
+            if (!Fill()) return nullptr;
+            continue;
+        }
+        if (begin_ == 0 && end_ == kBufferSize) {
+            // The buffer is full without a newline: truncate the line.
+            buffer_[kBufferSize] = '\0';
+            begin_ = end_ = 0;
+            skip_ = true;
+            if (length != nullptr) *length = kBufferSize;
+            return buffer_;
+        }
+        if (!Fill()) {
+            // The last line may not end with a newline.
+            if (begin_ == end_) return nullptr;
+            buffer_[end_] = '\0';
+            if (length != nullptr) *length = end_ - begin_;
+            char* line = buffer_ + begin_;
+            begin_ = end_;
+            return line;
+        }
+    }
+}
+
+}  // namespace procfs
+}  // namespace gamesdk
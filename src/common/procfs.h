@@ -0,0 +1,117 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Readers for /proc and /sys shared by all the libraries.
+// This doesn't use the STL or allocate, so that device_info can use it too.
+// All paths are absolute paths on the device, like "/proc/meminfo", which are
+// resolved under the root set by SetRoot. This allows running the readers
+// against a snapshot of a device's /proc and /sys copied to a directory.
+
+namespace gamesdk {
+namespace procfs {
+
+// Large enough for any /proc or /sys path under a snapshot root.
+constexpr size_t kMaxPathLength = 512;
+
+// Sets the directory under which paths are resolved. nullptr or "" means the
+// real file system, which is the default. Not thread safe: call it before any
+// reader runs, for example at the start of a test.
+// Returns false, leaving the root unchanged, if root is too long.
+bool SetRoot(const char* root);
+
+// Returns the current root, "" by default.
+const char* GetRoot();
+
+// Opens path under the current root with open(2).
+// Returns the file descriptor or -1 on failure.
+int Open(const char* path);
+
+// Reads up to size - 1 bytes of a small file like a sysfs attribute into
+// buffer and NUL-terminates it. Returns the number of bytes read or -1.
+int ReadFile(const char* path, char* buffer, size_t size);
+
+// Reads the first line of a file into buffer, without the newline.
+// Returns false on failure.
+bool ReadLine(const char* path, char* buffer, size_t size);
+
+// Reads a file holding a single decimal integer, like
+// /sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq or
+// /proc/<pid>/oom_score. Returns false on failure or if there is no number.
+bool ReadInt64(const char* path, int64_t* value);
+
+// A "<key>: <value>" line of /proc/meminfo, /proc/<pid>/status or
+// /proc/cpuinfo. Pointers point into the parsed line.
+struct Field {
+    const char* key;
+    size_t key_length;
+    // The value with leading whitespace skipped, up to the end of the line.
+    const char* value;
+    // The number at the start of value, if has_number.
+    int64_t number;
+    bool has_number;
+    // True if the number is followed by " kB" and nothing else.
+    bool in_kb;
+
+    // Returns true if key is exactly k.
+    bool KeyIs(const char* k) const;
+};
+
+// Splits a line at the first colon. Whitespace around the key is trimmed.
+// Returns false if there is no colon.
+bool ParseField(const char* line, Field* field);
+
+// Reads a file line by line through a fixed buffer, without allocating.
+// Lines longer than the buffer are truncated to its size.
+class LineReader {
+   public:
+    static constexpr size_t kBufferSize = 4096;
+
+    // Opens path under the current root.
+    explicit LineReader(const char* path);
+    ~LineReader();
+
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+
+    bool IsOpen() const { return fd_ >= 0; }
+
+    // Returns the next NUL-terminated line without its newline, or nullptr at
+    // the end of the file or on error. The line may be modified in place and
+    // is valid until the next call. If length is not null, it receives the
+    // length of the line.
+    char* NextLine(size_t* length = nullptr);
+
+   private:
+    // Reads more data after the buffered data. Returns false at EOF or error.
+    bool Fill();
+
+    int fd_;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    bool eof_ = false;
+    // True if the rest of a truncated line needs to be skipped.
+    bool skip_ = false;
+    // One more for the terminator of a truncated line.
+    char buffer_[kBufferSize + 1];
+};
+
+}  // namespace procfs
+}  // namespace gamesdk
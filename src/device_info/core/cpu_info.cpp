@@ -0,0 +1,153 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cpu_info.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "procfs.h"
+#include "string_util.h"
+
+namespace {
+using androidgamesdk_deviceinfo::ProtoDataHolder;
+using String = ProtoDataHolder::String;
+using StringVector = ProtoDataHolder::StringVector;
+namespace procfs = gamesdk::procfs;
+
+// Returns true on success.
+bool readFileString(const char* path, String& result) {
+    char buffer[256];
+    if (!procfs::ReadLine(path, buffer, sizeof(buffer))) return false;
+    result.copy(buffer);
+    return true;
+}
+
+// Calls f(cpuIndex) for each CPU in a list like "0-3,6", which is the
+// format of /sys/devices/system/cpu/possible.
+template <typename F>
+void forEachCpu(const char* list, F f) {
+    const char* it = list;
+    while (*it != '\0') {
+        char* end;
+        // NOLINTNEXTLINE
+        long first = strtol(it, &end, 10);
+        if (end == it) return;
+        long last = first;
+        if (*end == '-') {
+            it = end + 1;
+            // NOLINTNEXTLINE
+            last = strtol(it, &end, 10);
+            if (end == it) return;
+        }
+        for (long cpu = first; cpu <= last; ++cpu) f(static_cast<int>(cpu));
+        it = end;
+        if (*it == ',') ++it;
+    }
+}
+
+// Reads the maximum frequency of each CPU. Only the possible CPUs are read if
+// known, as kernel_max can be much larger than the number of CPUs.
+void readCpuFreqs(ProtoDataHolder& dataHolder) {
+    auto& cpuFreqs = dataHolder.cpuFreqs;
+    cpuFreqs.setSize(dataHolder.cpuIndexMax + 1);
+    for (size_t cpuIndex = 0; cpuIndex < cpuFreqs.size; cpuIndex++) {
+        cpuFreqs.data[cpuIndex] = 0;
+    }
+    auto readCpuFreqMax = [&](int cpuIndex) {
+        if (cpuIndex < 0 || cpuIndex > dataHolder.cpuIndexMax) return;
+        char path[procfs::kMaxPathLength];
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq",
+                 cpuIndex);
+        // Don't mark a missing cpu frequency as an error, as there might be
+        // CPUs with non sequential indexes. The frequency will stay to 0 and
+        // omitted when encoded to the proto.
+        procfs::ReadInt64(path, &cpuFreqs.data[cpuIndex]);
+    };
+    const char* possible = dataHolder.cpu_possible.data.get();
+    if (possible != nullptr) {
+        forEachCpu(possible, readCpuFreqMax);
+    } else {
+        for (int cpuIndex = 0; cpuIndex <= dataHolder.cpuIndexMax; cpuIndex++)
+            readCpuFreqMax(cpuIndex);
+    }
+}
+
+// Returns true on success.
+// Reads /proc/cpuinfo once, for lines starting with "Hardware" and
+// "Features". Puts the rest of the "Hardware" lines into dataHolder and
+// splits the "Features" lines into CPU extensions.
+bool readProcCpuInfo(ProtoDataHolder& dataHolder) {
+    procfs::LineReader cpuinfo("/proc/cpuinfo");
+    if (!cpuinfo.IsOpen()) return false;
+
+    procfs::Field field;
+    while (char* line = cpuinfo.NextLine()) {
+        if (!procfs::ParseField(line, &field)) continue;
+        if (field.KeyIs("Hardware")) {
+            dataHolder.hardware.addCopy(field.value);
+        } else if (field.KeyIs("Features")) {
+            // It is safe to cast away const, as the line is owned by the
+            // reader until the next line is read.
+            ::string_util::splitAddUnique(const_cast<char*>(field.value), " ",
+                                          dataHolder.cpu_extension);
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+namespace androidgamesdk_deviceinfo {
+
+int readCpuInfo(ProtoDataHolder& dataHolder, StringVector& errors) {
+    int numErrors = 0;
+
+    if (!readFileString("/sys/devices/system/cpu/present",
+                        dataHolder.cpu_present)) {
+        numErrors++;
+        errors.addCopy("Cpu present: Could not read file.");
+    }
+
+    if (!readFileString("/sys/devices/system/cpu/possible",
+                        dataHolder.cpu_possible)) {
+        numErrors++;
+        errors.addCopy("Cpu possible: Could not read file.");
+    }
+
+    int64_t cpuIndexMax;
+    if (procfs::ReadInt64("/sys/devices/system/cpu/kernel_max",
+                          &cpuIndexMax) &&
+        cpuIndexMax >= 0) {
+        dataHolder.cpuIndexMax = static_cast<int>(cpuIndexMax);
+        readCpuFreqs(dataHolder);
+    } else {
+        numErrors++;
+        errors.addCopy("Cpu index max: Could not read file.");
+    }
+
+    if (!readProcCpuInfo(dataHolder)) {
+        numErrors += 2;
+        errors.addCopy("Hardware: Could not read file.");
+        errors.addCopy("Features: Could not read file.");
+    }
+
+    return numErrors;
+}
+
+}  // namespace androidgamesdk_deviceinfo
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "device_info/device_info.h"
+
+namespace androidgamesdk_deviceinfo {
+
+// Reads the CPU data from /proc and /sys into dataHolder: cpuIndexMax,
+// cpuFreqs, cpu_present, cpu_possible, hardware and cpu_extension.
+// Files are read through gamesdk::procfs, so a snapshot of /proc and /sys can
+// be used instead of the device's own file system. This doesn't use EGL or
+// system properties, so it can run on any thread and on any Linux host.
+// Returns number of errors, which are added to errors.
+int readCpuInfo(ProtoDataHolder& dataHolder,
+                ProtoDataHolder::StringVector& errors);
+
+}  // namespace androidgamesdk_deviceinfo
@@ -19,12 +19,15 @@
 #include <EGL/egl.h>
 
 #include "basic_texture_renderer.h"
-#include "stream_util/getdelim.h"
+#include "cpu_info.h"
+#include "device_info_cache.h"
+#include "string_util.h"
 #include "texture_test_cases.h"
 // clang-format off
 #include <GLES3/gl32.h>
 #include <GLES2/gl2ext.h>
 // clang-format on
+#include <pthread.h>
 #include <sys/system_properties.h>
 
 #include <cassert>
@@ -43,168 +46,6 @@ using Int32Array = ProtoDataHolder::Array<int32_t>;
 using Int64Array = ProtoDataHolder::Array<int64_t>;
 using FloatArray = ProtoDataHolder::Array<float>;
 
-namespace string_util {
-bool startsWith(const char* text, const char* start) {
-    return strncmp(text, start, strlen(start)) == 0;
-}
-
-void copyAndTerminate(char* to, const char* from, size_t len) {
-    memcpy(to, from, len);
-    to[len] = '\0';
-}
-
-// Mutates toSplit.
-// Splits toSpit with given delimiters into tokens.
-// Each char in delimiters is a possible delimiter.
-// Adds unique tokens into result.
-void splitAddUnique(char* toSplit, const char* delimiters,
-                    StringVector& result) {
-    char* strtokState;
-    for (char* it = strtok_r(toSplit, delimiters, &strtokState); it != nullptr;
-         it = strtok_r(nullptr, delimiters, &strtokState)) {
-        if (strlen(it) > 0 && !result.has(it)) {
-            result.addCopy(it);
-        }
-    }
-}
-
-// Returns a pointer to the position where toSkip chars are skipped.
-const char* skipChars(const char* begin, const char* toSkip) {
-    const char* result = begin;
-    while (strchr(toSkip, *result)) result++;
-    return result;
-}
-}  // namespace string_util
-
-// Returns nullptr on failure, including EOF
-// Result is allocated via new[]
-// Caller is responsible for delete[]
-char* readFileLine(FILE* file) {
-    // getline uses malloc/free.
-    // Rest of the program uses new/delete.
-    // So we copy the buffer and return the new[] result.
-    char* mallocBuffer = nullptr;
-    size_t mallocBufferSize = 0;
-
-    // Use our own implementation of getline as some C libraries are missing it.
-    int resultLen =
-        stream_util::getline(&mallocBuffer, &mallocBufferSize, file);
-
-    if (resultLen < 0) {  // Error.
-        free(mallocBuffer);
-        return nullptr;
-    }
-
-    // Trim the result.
-    if (resultLen > 0 && mallocBuffer[resultLen - 1] == '\n') {
-        resultLen--;
-    }
-    char* result = new char[resultLen + 1];
-    ::string_util::copyAndTerminate(result, mallocBuffer, resultLen);
-    free(mallocBuffer);
-    return result;
-}
-
-// Returns nullptr on failure.
-// Caller is responsible for delete[]
-char* readFileSingleLine(const char* fileName) {
-    FILE* file = fopen(fileName, "r");
-    if (file == nullptr) return nullptr;
-    return readFileLine(file);
-}
-
-// Returns true on success.
-bool readFileInt32(const char* fileName, int32_t& result) {
-    std::unique_ptr<char[]> fileContent(readFileSingleLine(fileName));
-    if (fileContent.get() == nullptr) return false;
-    // Using strto32/64 increases binary file size beyond limit.
-    // NOLINTNEXTLINE
-    result = strtol(fileContent.get(), nullptr, 10);
-    return true;
-}
-
-// Returns true on success.
-bool readFileInt64(const char* fileName, int64_t& result) {
-    std::unique_ptr<char[]> fileContent(readFileSingleLine(fileName));
-    if (fileContent.get() == nullptr) return false;
-    // Using strto32/64 increases binary file size beyond limit.
-    // NOLINTNEXTLINE
-    result = strtoll(fileContent.get(), nullptr, 10);
-    return true;
-}
-
-// Returns true on success.
-bool readCpuPresent(String& result) {
-    result.data.reset(readFileSingleLine("/sys/devices/system/cpu/present"));
-    return result.data.get() != nullptr;
-}
-
-// Returns true on success.
-bool readCpuPossible(String& result) {
-    result.data.reset(readFileSingleLine("/sys/devices/system/cpu/possible"));
-    return result.data.get() != nullptr;
-}
-
-// Returns true on success.
-bool readCpuIndexMax(int& result) {
-    return readFileInt32("/sys/devices/system/cpu/kernel_max", result);
-}
-
-// Returns true on success.
-bool readCpuFreqMax(int cpuIndex, int64_t& result) {
-    char fileName[64];
-    snprintf(fileName, sizeof(fileName), "%s%d%s",
-             "/sys/devices/system/cpu/cpu", cpuIndex,
-             "/cpufreq/cpuinfo_max_freq");
-    return readFileInt64(fileName, result);
-}
-
-// Returns true on success.
-// Reads the system file for lines starting with "Hardware".
-// Puts the rest of the lines into dataHolder.
-bool readHardware(ProtoDataHolder& dataHolder) {
-    FILE* file = fopen("/proc/cpuinfo", "r");
-    if (file == nullptr) return false;
-
-    const char* FIELD_KEY = "Hardware";
-    while (true) {
-        std::unique_ptr<char[]> line(readFileLine(file));
-        if (line.get() == nullptr) break;  // Error or EOF
-        if (::string_util::startsWith(line.get(), FIELD_KEY)) {
-            const char* value = line.get() + strlen(FIELD_KEY);
-            // Skip space, tab and colon.
-            value = ::string_util::skipChars(value, " \t:");
-            dataHolder.hardware.addCopy(value);
-        }
-    }
-    return true;
-}
-
-// Returns true on success.
-// Reads the system file for lines starting with "Features".
-// Splits the rest of the lines.
-// Puts the values into dataHolder.
-bool readCpuExtensions(ProtoDataHolder& dataHolder) {
-    FILE* file = fopen("/proc/cpuinfo", "r");
-    if (file == nullptr) return false;
-
-    const char* FIELD_KEY = "Features";
-    while (true) {
-        std::unique_ptr<char[]> line(readFileLine(file));
-        if (line.get() == nullptr) break;  // Error or EOF
-        if (::string_util::startsWith(line.get(), FIELD_KEY)) {
-            const char* value = line.get() + strlen(FIELD_KEY);
-            // Skip space, tab and colon.
-            value = ::string_util::skipChars(value, " \t:");
-            // It is safe to cast away const, because it will be deleted right
-            // after.
-            ::string_util::splitAddUnique(const_cast<char*>(value), " ",
-                                          dataHolder.cpu_extension);
-        }
-    }
-    return true;
-}
-
 // 26 is the required android api version for __system_property_read_callback
 // In the time of writing it is 18.
 #if __ANDROID_API__ >= 26
@@ -231,17 +72,31 @@ int getSystemProp(const char* key, String& result, StringVector& errors) {
 }
 
 // returns number of errors
-int addSystemProperties(ProtoDataHolder& dataHolder) {
+int addSystemProperties(ProtoDataHolder& dataHolder, StringVector& errors) {
     int numErrors = 0;
-    numErrors +=
-        getSystemProp("ro.build.version.sdk", dataHolder.ro_build_version_sdk,
-                      dataHolder.errors);
-    numErrors +=
-        getSystemProp("ro.build.fingerprint", dataHolder.ro_build_fingerprint,
-                      dataHolder.errors);
+    numErrors += getSystemProp("ro.build.version.sdk",
+                               dataHolder.ro_build_version_sdk, errors);
+    numErrors += getSystemProp("ro.build.fingerprint",
+                               dataHolder.ro_build_fingerprint, errors);
     return numErrors;
 }
 
+// Collects the data that doesn't need the EGL context, so that it can be read
+// on another thread while the OpenGL data is queried.
+struct CpuAndSystemTask {
+    ProtoDataHolder* dataHolder;
+    StringVector errors;
+    int numErrors = 0;
+};
+
+void* runCpuAndSystemTask(void* arg) {
+    CpuAndSystemTask& task = *static_cast<CpuAndSystemTask*>(arg);
+    task.numErrors +=
+        androidgamesdk_deviceinfo::readCpuInfo(*task.dataHolder, task.errors);
+    task.numErrors += addSystemProperties(*task.dataHolder, task.errors);
+    return nullptr;
+}
+
 // Returns number of errors.
 int checkEglError(const char* title, StringVector& errors) {
     EGLint eglError = eglGetError();
@@ -1276,33 +1131,6 @@ void addGlCompressedTexturesRendering(
     }
 }
 
-void String::copy(const char* from) {
-    size_t len = strlen(from);
-    char* dataNew = new char[len + 1];
-    ::string_util::copyAndTerminate(dataNew, from, len);
-    data.reset(dataNew);
-}
-
-void StringVector::addCopy(const char* orig) {
-    if (size == sizeMax) {
-        sizeMax *= 2;
-        String* dataNew = new String[sizeMax]();
-        for (int i = 0; i < size; i++) {
-            dataNew[i].data.swap(data[i].data);
-        }
-        data.reset(dataNew);
-    }
-    String& newElement = data[size++];
-    newElement.copy(orig);
-}
-
-bool StringVector::has(const char* element) {
-    for (int i = 0; i < size; i++) {
-        if (strcmp(data[i].data.get(), element) == 0) return true;
-    }
-    return false;
-}
-
 int createProto(androidgamesdk_deviceinfo_GameSdkDeviceInfoWithErrors& proto,
                 ProtoDataHolder& dataHolder) {
     int numErrors = 0;
@@ -1313,75 +1141,27 @@ int createProto(androidgamesdk_deviceinfo_GameSdkDeviceInfoWithErrors& proto,
     proto.has_info = true;
     androidgamesdk_deviceinfo_GameSdkDeviceInfo& info = proto.info;
 
-    if (readCpuIndexMax(dataHolder.cpuIndexMax)) {
-        info.has_cpu_max_index = true;
-        info.cpu_max_index = dataHolder.cpuIndexMax;
-        dataHolder.cpuFreqs.setSize(dataHolder.cpuIndexMax + 1);
-        for (int cpuIndex = 0; cpuIndex <= dataHolder.cpuIndexMax; cpuIndex++) {
-            dataHolder.cpuFreqs.data[cpuIndex] = 0;
-
-            if (!readCpuFreqMax(cpuIndex, dataHolder.cpuFreqs.data[cpuIndex])) {
-                // Don't mark a missing cpu frequency as an error, as there
-                // might be CPUs with non sequential indexes. The frequency will
-                // stay to 0 and omitted when encoded to the proto.
-            }
-        }
-        info.cpu_core.arg = &dataHolder;
-        info.cpu_core.funcs.encode = &protoEncodeCpuFreqs;
-    } else {
-        numErrors++;
-        dataHolder.errors.addCopy("Cpu index max: Could not read file.");
-    }
-
-    if (readCpuPresent(dataHolder.cpu_present)) {
-        info.cpu_present.arg = &dataHolder.cpu_present;
-        info.cpu_present.funcs.encode = &protoEncodeString;
-    } else {
-        numErrors++;
-        dataHolder.errors.addCopy("Cpu present: Could not read file.");
-    }
-
-    if (readCpuPossible(dataHolder.cpu_possible)) {
-        info.cpu_possible.arg = &dataHolder.cpu_possible;
-        info.cpu_possible.funcs.encode = &protoEncodeString;
-    } else {
-        numErrors++;
-        dataHolder.errors.addCopy("Cpu possible: Could not read file.");
-    }
-
-    if (readHardware(dataHolder)) {
-        info.hardware.arg = &dataHolder.hardware;
-        info.hardware.funcs.encode = &protoEncodeStringVector;
-    } else {
-        numErrors++;
-        dataHolder.errors.addCopy("Hardware: Could not read file.");
-    }
-
-    if (readCpuExtensions(dataHolder)) {
-        info.cpu_extension.arg = &dataHolder.cpu_extension;
-        info.cpu_extension.funcs.encode = &protoEncodeStringVector;
-    } else {
-        numErrors++;
-        dataHolder.errors.addCopy("Features: Could not read file.");
-    }
-
-    numErrors += addSystemProperties(dataHolder);
-    info.ro_build_version_sdk.arg = &dataHolder.ro_build_version_sdk;
-    info.ro_build_version_sdk.funcs.encode = &protoEncodeString;
-    info.ro_build_fingerprint.arg = &dataHolder.ro_build_fingerprint;
-    info.ro_build_fingerprint.funcs.encode = &protoEncodeString;
-
+    // The CPU data and system properties are read on another thread while
+    // this one, which owns the EGL context, queries OpenGL.
+    CpuAndSystemTask task;
+    task.dataHolder = &dataHolder;
+    pthread_t thread;
+    bool threadStarted =
+        pthread_create(&thread, nullptr, &runCpuAndSystemTask, &task) == 0;
+    if (!threadStarted) runCpuAndSystemTask(&task);
+
+    // Errors are added after those of the CPU data, once it's read.
+    StringVector glErrors;
     EGLDisplay eglDisplay = nullptr;
     EGLContext eglContext = nullptr;
     EGLSurface eglSurface = nullptr;
-    int numErrorsEgl =
-        setupEGl(eglDisplay, eglContext, eglSurface, dataHolder.errors);
+    int numErrorsEgl = setupEGl(eglDisplay, eglContext, eglSurface, glErrors);
     numErrors += numErrorsEgl;
     if (numErrorsEgl == 0) {
         info.has_open_gl = true;
         androidgamesdk_deviceinfo_GameSdkDeviceInfo_OpenGl& protoGl =
             info.open_gl;
-        numErrors += addGl(protoGl, dataHolder.ogl, dataHolder.errors);
+        numErrors += addGl(protoGl, dataHolder.ogl, glErrors);
 
         protoGl.renderer.arg = &dataHolder.ogl.renderer;
         protoGl.renderer.funcs.encode = &protoEncodeString;
@@ -1433,16 +1213,86 @@ int createProto(androidgamesdk_deviceinfo_GameSdkDeviceInfoWithErrors& proto,
     if (numErrorsEgl == 0 && eglDisplay != nullptr && eglContext != nullptr &&
         eglSurface != nullptr) {
         addGlCompressedTexturesRendering(eglDisplay, eglSurface, info.open_gl,
-                                         dataHolder.ogl, dataHolder.errors);
+                                         dataHolder.ogl, glErrors);
     } else {
         numErrors++;
-        dataHolder.errors.addCopy(
-            "Compressed textures: skipping because EGL errors");
+        glErrors.addCopy("Compressed textures: skipping because EGL errors");
     }
 
+    if (threadStarted) pthread_join(thread, nullptr);
+    numErrors += task.numErrors;
+    dataHolder.errors.addAll(task.errors);
+    dataHolder.errors.addAll(glErrors);
+
+    if (dataHolder.cpuFreqs.size > 0) {
+        info.has_cpu_max_index = true;
+        info.cpu_max_index = dataHolder.cpuIndexMax;
+        info.cpu_core.arg = &dataHolder;
+        info.cpu_core.funcs.encode = &protoEncodeCpuFreqs;
+    }
+    if (dataHolder.cpu_present.data != nullptr) {
+        info.cpu_present.arg = &dataHolder.cpu_present;
+        info.cpu_present.funcs.encode = &protoEncodeString;
+    }
+    if (dataHolder.cpu_possible.data != nullptr) {
+        info.cpu_possible.arg = &dataHolder.cpu_possible;
+        info.cpu_possible.funcs.encode = &protoEncodeString;
+    }
+    info.hardware.arg = &dataHolder.hardware;
+    info.hardware.funcs.encode = &protoEncodeStringVector;
+    info.cpu_extension.arg = &dataHolder.cpu_extension;
+    info.cpu_extension.funcs.encode = &protoEncodeStringVector;
+    info.ro_build_version_sdk.arg = &dataHolder.ro_build_version_sdk;
+    info.ro_build_version_sdk.funcs.encode = &protoEncodeString;
+    info.ro_build_fingerprint.arg = &dataHolder.ro_build_fingerprint;
+    info.ro_build_fingerprint.funcs.encode = &protoEncodeString;
+
     proto.error.arg = &dataHolder.errors;
     proto.error.funcs.encode = &protoEncodeStringVector;
 
     return numErrors;
 }
+
+bool createSerializedProto(const char* cacheFileName,
+                           ProtoDataHolder::Array<uint8_t>& result) {
+    // Reading the fingerprint alone is cheap: on a cache hit, nothing else is
+    // collected.
+    String fingerprint;
+    StringVector fingerprintErrors;
+    bool cacheable =
+        cacheFileName != nullptr &&
+        getSystemProp("ro.build.fingerprint", fingerprint, fingerprintErrors) ==
+            0;
+    if (cacheable &&
+        readCachedProto(cacheFileName, fingerprint.data.get(), result)) {
+        return true;
+    }
+
+    androidgamesdk_deviceinfo_GameSdkDeviceInfoWithErrors proto;
+    ProtoDataHolder dataHolder;
+    int numErrors = createProto(proto, dataHolder);
+
+    size_t bufferSize = 0;
+    if (!pb_get_encoded_size(
+            &bufferSize,
+            androidgamesdk_deviceinfo_GameSdkDeviceInfoWithErrors_fields,
+            &proto)) {
+        return false;
+    }
+    result.setSize(bufferSize);
+    pb_ostream_t stream = pb_ostream_from_buffer(result.data.get(), bufferSize);
+    if (!pb_encode(&stream,
+                   androidgamesdk_deviceinfo_GameSdkDeviceInfoWithErrors_fields,
+                   &proto)) {
+        return false;
+    }
+
+    // Errors, like EGL failing, can be transient: don't keep them until the
+    // next system update.
+    if (cacheable && numErrors == 0) {
+        writeCachedProto(cacheFileName, fingerprint.data.get(),
+                         result.data.get(), result.size);
+    }
+    return true;
+}
 }  // namespace androidgamesdk_deviceinfo
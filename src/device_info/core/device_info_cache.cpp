@@ -0,0 +1,100 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "device_info_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+namespace {
+
+// "GSDI" in little-endian order.
+constexpr uint32_t CACHE_MAGIC = 0x49445347;
+
+// No cached proto is anywhere near this big: anything larger is corrupt.
+constexpr uint32_t MAX_SIZE = 1 << 20;
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t fingerprintSize;
+    uint32_t protoSize;
+};
+
+bool readExactly(FILE* file, void* data, size_t size) {
+    return fread(data, 1, size, file) == size;
+}
+
+bool writeExactly(FILE* file, const void* data, size_t size) {
+    return fwrite(data, 1, size, file) == size;
+}
+
+}  // namespace
+
+namespace androidgamesdk_deviceinfo {
+
+bool readCachedProto(const char* fileName, const char* fingerprint,
+                     ProtoDataHolder::Array<uint8_t>& result) {
+    FILE* file = fopen(fileName, "rb");
+    if (file == nullptr) return false;
+
+    bool success = false;
+    CacheHeader header;
+    size_t fingerprintSize = strlen(fingerprint);
+    if (readExactly(file, &header, sizeof(header)) &&
+        header.magic == CACHE_MAGIC && header.version == CACHE_VERSION &&
+        header.fingerprintSize == fingerprintSize &&
+        header.protoSize <= MAX_SIZE) {
+        std::unique_ptr<char[]> cachedFingerprint(new char[fingerprintSize]);
+        if (readExactly(file, cachedFingerprint.get(), fingerprintSize) &&
+            memcmp(cachedFingerprint.get(), fingerprint, fingerprintSize) ==
+                0) {
+            result.setSize(header.protoSize);
+            success = readExactly(file, result.data.get(), header.protoSize);
+        }
+    }
+    fclose(file);
+    return success;
+}
+
+bool writeCachedProto(const char* fileName, const char* fingerprint,
+                      const uint8_t* data, size_t size) {
+    if (size > MAX_SIZE) return false;
+    size_t fileNameLen = strlen(fileName);
+    const char* TMP_SUFFIX = ".tmp";
+    std::unique_ptr<char[]> tmpFileName(
+        new char[fileNameLen + strlen(TMP_SUFFIX) + 1]);
+    memcpy(tmpFileName.get(), fileName, fileNameLen);
+    strcpy(tmpFileName.get() + fileNameLen, TMP_SUFFIX);
+
+    FILE* file = fopen(tmpFileName.get(), "wb");
+    if (file == nullptr) return false;
+    CacheHeader header;
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.fingerprintSize = strlen(fingerprint);
+    header.protoSize = size;
+    bool success = writeExactly(file, &header, sizeof(header)) &&
+                   writeExactly(file, fingerprint, header.fingerprintSize) &&
+                   writeExactly(file, data, size);
+    success = fclose(file) == 0 && success;
+    if (success) success = rename(tmpFileName.get(), fileName) == 0;
+    if (!success) remove(tmpFileName.get());
+    return success;
+}
+
+}  // namespace androidgamesdk_deviceinfo
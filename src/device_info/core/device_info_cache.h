@@ -0,0 +1,43 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "device_info/device_info.h"
+
+namespace androidgamesdk_deviceinfo {
+
+// The serialized proto is cached in a file with a header holding
+// CACHE_VERSION and the build fingerprint of the device. A cache written by
+// another version of the collection code or before a system update is
+// ignored.
+// Increase when the proto or what is collected changes.
+constexpr uint32_t CACHE_VERSION = 1;
+
+// Returns true if the file was written with the current CACHE_VERSION and
+// fingerprint, in which case result holds the serialized proto.
+bool readCachedProto(const char* fileName, const char* fingerprint,
+                     ProtoDataHolder::Array<uint8_t>& result);
+
+// Writes to a temporary file which is then renamed, so that a reader never
+// sees a partial cache. Returns true on success.
+bool writeCachedProto(const char* fileName, const char* fingerprint,
+                      const uint8_t* data, size_t size);
+
+}  // namespace androidgamesdk_deviceinfo
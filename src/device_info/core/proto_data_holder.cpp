@@ -0,0 +1,58 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "device_info/device_info.h"
+#include "string_util.h"
+
+namespace androidgamesdk_deviceinfo {
+
+using String = ProtoDataHolder::String;
+using StringVector = ProtoDataHolder::StringVector;
+
+void String::copy(const char* from) {
+    size_t len = strlen(from);
+    char* dataNew = new char[len + 1];
+    ::string_util::copyAndTerminate(dataNew, from, len);
+    data.reset(dataNew);
+}
+
+void StringVector::addCopy(const char* orig) {
+    if (size == sizeMax) {
+        sizeMax *= 2;
+        String* dataNew = new String[sizeMax]();
+        for (int i = 0; i < size; i++) {
+            dataNew[i].data.swap(data[i].data);
+        }
+        data.reset(dataNew);
+    }
+    String& newElement = data[size++];
+    newElement.copy(orig);
+}
+
+bool StringVector::has(const char* element) {
+    for (int i = 0; i < size; i++) {
+        if (strcmp(data[i].data.get(), element) == 0) return true;
+    }
+    return false;
+}
+
+void StringVector::addAll(const StringVector& other) {
+    for (size_t i = 0; i < other.size; i++) {
+        addCopy(other.data[i].data.get());
+    }
+}
+
+}  // namespace androidgamesdk_deviceinfo
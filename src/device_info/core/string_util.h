@@ -0,0 +1,57 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstring>
+
+#include "device_info/device_info.h"
+
+namespace string_util {
+
+inline bool startsWith(const char* text, const char* start) {
+    return strncmp(text, start, strlen(start)) == 0;
+}
+
+inline void copyAndTerminate(char* to, const char* from, size_t len) {
+    memcpy(to, from, len);
+    to[len] = '\0';
+}
+
+// Mutates toSplit.
+// Splits toSpit with given delimiters into tokens.
+// Each char in delimiters is a possible delimiter.
+// Adds unique tokens into result.
+inline void splitAddUnique(
+    char* toSplit, const char* delimiters,
+    androidgamesdk_deviceinfo::ProtoDataHolder::StringVector& result) {
+    char* strtokState;
+    for (char* it = strtok_r(toSplit, delimiters, &strtokState); it != nullptr;
+         it = strtok_r(nullptr, delimiters, &strtokState)) {
+        if (strlen(it) > 0 && !result.has(it)) {
+            result.addCopy(it);
+        }
+    }
+}
+
+// Returns a pointer to the position where toSkip chars are skipped.
+inline const char* skipChars(const char* begin, const char* toSkip) {
+    const char* result = begin;
+    while (*result != '\0' && strchr(toSkip, *result)) result++;
+    return result;
+}
+
+}  // namespace string_util
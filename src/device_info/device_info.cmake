@@ -11,7 +11,6 @@ set ( THIRD_PARTY_LOCATION "${_MY_DIR}/../../third_party")
 
 include_directories( ${_MY_DIR}/../../include )
 include_directories( ${_MY_DIR}/../../include/third_party/nanopb )
-include_directories( ${THIRD_PARTY_LOCATION}/stream_util/include )
 include_directories( ${_MY_DIR}/../common )
 
 include_directories( ${PROTO_GENS_DIR} )
@@ -23,9 +22,12 @@ add_library( device_info_static
 
              STATIC
 
-             ${THIRD_PARTY_LOCATION}/stream_util/src/getdelim.cpp
+             ${SOURCE_LOCATION}/../common/procfs.cpp
              ${SOURCE_LOCATION}/core/basic_texture_renderer.cpp
+             ${SOURCE_LOCATION}/core/cpu_info.cpp
              ${SOURCE_LOCATION}/core/device_info.cpp
+             ${SOURCE_LOCATION}/core/device_info_cache.cpp
+             ${SOURCE_LOCATION}/core/proto_data_holder.cpp
              ${SOURCE_LOCATION}/core/texture_test_cases.cpp
              ${Texture_test_cases_SOURCES}
              ${PROTO_GENS_DIR}/nano/device_info.pb.c
@@ -20,37 +20,39 @@
 #include <cstdlib>
 
 #include "device_info/device_info.h"
-#include "third_party/nanopb/pb_encode.h"
+
+namespace {
+
+// Returns nullptr in case of failure.
+jbyteArray getProtoSerialized(JNIEnv* env, const char* cacheFileName) {
+    androidgamesdk_deviceinfo::ProtoDataHolder::Array<uint8_t> serialized;
+    if (!androidgamesdk_deviceinfo::createSerializedProto(cacheFileName,
+                                                          serialized)) {
+        return nullptr;
+    }
+    jbyteArray result = env->NewByteArray(serialized.size);
+    env->SetByteArrayRegion(
+        result, 0, serialized.size,
+        static_cast<jbyte*>(static_cast<void*>(serialized.data.get())));
+    return result;
+}
+
+}  // namespace
 
 extern "C" {
 JNIEXPORT jbyteArray JNICALL
 Java_com_google_androidgamesdk_GameSdkDeviceInfoJni_getProtoSerialized(
     JNIEnv* env, jobject) {
-    androidgamesdk_deviceinfo_GameSdkDeviceInfoWithErrors proto;
-    androidgamesdk_deviceinfo::ProtoDataHolder protoDataHolder;
-    androidgamesdk_deviceinfo::createProto(proto, protoDataHolder);
-
-    // Serialize the proto, returning nullptr in case of failure.
-    jbyteArray result = nullptr;
-    size_t bufferSize = -1;
-    if (pb_get_encoded_size(
-            &bufferSize,
-            androidgamesdk_deviceinfo_GameSdkDeviceInfoWithErrors_fields,
-            &proto)) {
-        pb_byte_t* buffer = new pb_byte_t[bufferSize];
-        pb_ostream_t stream = pb_ostream_from_buffer(buffer, bufferSize);
-        if (pb_encode(
-                &stream,
-                androidgamesdk_deviceinfo_GameSdkDeviceInfoWithErrors_fields,
-                &proto)) {
-            result = env->NewByteArray(bufferSize);
-            env->SetByteArrayRegion(
-                result, 0, bufferSize,
-                static_cast<jbyte*>(static_cast<void*>(buffer)));
-        }
-        delete[] buffer;
-    }
+    return getProtoSerialized(env, nullptr);
+}
 
+JNIEXPORT jbyteArray JNICALL
+Java_com_google_androidgamesdk_GameSdkDeviceInfoJni_getProtoSerializedCached(
+    JNIEnv* env, jobject, jstring cacheFileName) {
+    if (cacheFileName == nullptr) return getProtoSerialized(env, nullptr);
+    const char* fileName = env->GetStringUTFChars(cacheFileName, nullptr);
+    jbyteArray result = getProtoSerialized(env, fileName);
+    env->ReleaseStringUTFChars(cacheFileName, fileName);
     return result;
 }
 }  // extern "C"
@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+#
+# Copyright 2023 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""Writes the .ktx2 and .astc files of texture_container_test.
+
+The files follow the layout of the KTX 2.0 specification and of the header
+written by astcenc. The parser only reads that layout, so the block data and
+the supercompressed payloads are filler bytes rather than encoded images.
+
+Usage: make_textures.py [output directory, defaults to this one]
+"""
+
+import os
+import struct
+import sys
+
+KTX2_IDENTIFIER = b'\xabKTX 20\xbb\r\n\x1a\n'
+ASTC_MAGIC = b'\x13\xab\xa1\x5c'
+
+VK_FORMAT_UNDEFINED = 0
+VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK = 147
+VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK = 151
+
+SUPERCOMPRESSION_NONE = 0
+SUPERCOMPRESSION_BASISLZ = 1
+SUPERCOMPRESSION_ZSTD = 2
+
+# Data format descriptor colour models
+KHR_DF_MODEL_UNSPECIFIED = 0
+KHR_DF_MODEL_ETC2 = 161
+KHR_DF_MODEL_ETC1S = 163
+
+
+def filler(size, seed):
+    state = seed
+    data = bytearray(size)
+    for i in range(size):
+        state = (state * 1103515245 + 12345) & 0x7fffffff
+        data[i] = state >> 16 & 0xff
+    return bytes(data)
+
+
+def pad(data, alignment):
+    return data + b'\0' * (-len(data) % alignment)
+
+
+def u24(value):
+    return struct.pack('<I', value)[:3]
+
+
+def astc(block_width, block_height, width, height):
+    blocks = (-(-width // block_width)) * (-(-height // block_height))
+    header = (ASTC_MAGIC + bytes([block_width, block_height, 1]) +
+              u24(width) + u24(height) + u24(1))
+    return header + filler(blocks * 16, width * height)
+
+
+def dfd(model, bytes_plane0, channels):
+    """A basic data format descriptor of a 4x4 block format.
+
+    channels is a list of (channel id, bit length) of the samples.
+    """
+    samples = b''
+    bit_offset = 0
+    for channel, bit_length in channels:
+        samples += struct.pack('<HBB4BII', bit_offset, bit_length - 1,
+                               channel, 0, 0, 0, 0, 0, 0xffffffff)
+        bit_offset += bit_length
+    block_size = 24 + len(samples)
+    # vendorId 0 and descriptorType 0, versionNumber 2, then the model,
+    # primaries BT709, transfer linear, flags, texel block dimensions minus
+    # one and the bytes of each plane.
+    block = struct.pack('<IHHBBBB4B8B', 0, 2, block_size, model, 1, 1, 0,
+                        3, 3, 0, 0, bytes_plane0, 0, 0, 0, 0, 0, 0, 0)
+    return struct.pack('<I', 4 + len(block) + len(samples)) + block + samples
+
+
+def ktx2(vk_format, width, height, supercompression, levels, descriptor,
+         sgd=b''):
+    """levels holds (data, uncompressed size) from the full size level down.
+
+    As the specification requires, levels are stored from the smallest one up.
+    """
+    writer = b'KTXwriter\0make_textures.py\0'
+    kvd = pad(struct.pack('<I', len(writer)) + writer, 4)
+    data = bytearray(80 + 24 * len(levels))
+    dfd_offset = len(data)
+    data += descriptor
+    kvd_offset = len(data)
+    data += kvd
+    sgd_offset = 0
+    if sgd:
+        data = bytearray(pad(bytes(data), 8))
+        sgd_offset = len(data)
+        data += sgd
+    # Levels without supercompression are aligned to the least common
+    # multiple of the texel block size and 4.
+    alignment = 16 if supercompression == SUPERCOMPRESSION_NONE else 1
+    offsets = [0] * len(levels)
+    for level in reversed(range(len(levels))):
+        data = bytearray(pad(bytes(data), alignment))
+        offsets[level] = len(data)
+        data += levels[level][0]
+
+    header = KTX2_IDENTIFIER + struct.pack(
+        '<9I', vk_format, 1, width, height, 0, 0, 1, len(levels),
+        supercompression)
+    header += struct.pack('<4I2Q', dfd_offset, len(descriptor), kvd_offset,
+                          len(kvd), sgd_offset, len(sgd))
+    level_index = b''.join(
+        struct.pack('<3Q', offsets[level], len(level_data), uncompressed)
+        for level, (level_data, uncompressed) in enumerate(levels))
+    return header + level_index + bytes(data[len(header) + len(level_index):])
+
+
+def etc2_levels(width, height, bytes_per_block):
+    levels = []
+    level = 0
+    while True:
+        w = max(width >> level, 1)
+        h = max(height >> level, 1)
+        size = (-(-w // 4)) * (-(-h // 4)) * bytes_per_block
+        levels.append((filler(size, level + 1), size))
+        if w == 1 and h == 1:
+            return levels
+        level += 1
+
+
+def main():
+    directory = sys.argv[1] if len(sys.argv) > 1 else os.path.dirname(
+        os.path.abspath(__file__))
+    files = {
+        'astc_4x4_16x8.astc': astc(4, 4, 16, 8),
+        'astc_6x6_13x7.astc': astc(6, 6, 13, 7),
+        'etc2_rgba8_32x16.ktx2': ktx2(
+            VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK, 32, 16,
+            SUPERCOMPRESSION_NONE, etc2_levels(32, 16, 16),
+            dfd(KHR_DF_MODEL_ETC2, 16, [(15, 64), (0, 64)])),
+        'etc2_rgb8_zstd_8x8.ktx2': ktx2(
+            VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK, 8, 8,
+            SUPERCOMPRESSION_ZSTD, [(filler(21, 7), 32)],
+            dfd(KHR_DF_MODEL_ETC2, 8, [(0, 64)])),
+        'basislz_64x32.ktx2': ktx2(
+            VK_FORMAT_UNDEFINED, 64, 32, SUPERCOMPRESSION_BASISLZ,
+            [(filler(75, 3), 0), (filler(30, 4), 0)],
+            dfd(KHR_DF_MODEL_ETC1S, 0, [(0, 64)]),
+            sgd=filler(52, 9)),
+    }
+    for name, data in files.items():
+        with open(os.path.join(directory, name), 'wb') as f:
+            f.write(data)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The views of agdktunnel over asset files and AAssets: contents, lifetime
+// of the mapping, and empty or missing files.
+
+#include "game_asset_view.hpp"
+
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fake_asset_manager.h"
+#include "gtest/gtest.h"
+#include "test_files.h"
+
+namespace agdktunnel_test {
+
+namespace {
+
+// Whether path is mapped in this process.
+bool IsMapped(const std::string &path) {
+    std::ifstream maps("/proc/self/maps");
+    std::string line;
+    while (std::getline(maps, line)) {
+        if (line.find(path) != std::string::npos) return true;
+    }
+    return false;
+}
+
+bool HasContents(const GameAssetView &view,
+                 const std::vector<uint8_t> &contents) {
+    return view.GetSize() == contents.size() &&
+           (contents.empty() ||
+            memcmp(view.GetData(), contents.data(), contents.size()) == 0);
+}
+
+}  // namespace
+
+TEST(GameAssetView, MapsFileContents) {
+    TempDir dir;
+    // Sizes around the page size and one spanning many pages.
+    for (size_t size : {1, 4095, 4096, 4097, 3 * 1024 * 1024 + 7}) {
+        SCOPED_TRACE(size);
+        std::vector<uint8_t> contents = MakeContents(size, size);
+        std::string path = dir.Write("asset", contents);
+        std::shared_ptr<GameAssetView> view =
+            GameAssetView::MapFile(path.c_str());
+        ASSERT_NE(view, nullptr);
+        EXPECT_TRUE(HasContents(*view, contents));
+    }
+}
+
+TEST(GameAssetView, MappingLivesAsLongAsTheView) {
+    TempDir dir;
+    std::vector<uint8_t> contents = MakeContents(64 * 1024, 1);
+    std::string path = dir.Write("asset", contents);
+
+    std::shared_ptr<GameAssetView> view = GameAssetView::MapFile(path.c_str());
+    ASSERT_NE(view, nullptr);
+    EXPECT_TRUE(IsMapped(path));
+    std::shared_ptr<GameAssetView> copy = view;
+
+    // The mapping holds the file: removing it, or releasing one reference,
+    // leaves the data in place.
+    ASSERT_EQ(unlink(path.c_str()), 0);
+    view.reset();
+    EXPECT_TRUE(HasContents(*copy, contents));
+
+    // The last reference unmaps it.
+    copy.reset();
+    EXPECT_FALSE(IsMapped(path));
+}
+
+TEST(GameAssetView, MapsEmptyFile) {
+    TempDir dir;
+    std::string path = dir.Write("empty", nullptr, 0);
+    std::shared_ptr<GameAssetView> view = GameAssetView::MapFile(path.c_str());
+    ASSERT_NE(view, nullptr);
+    EXPECT_EQ(view->GetSize(), 0u);
+    EXPECT_EQ(view->GetData(), nullptr);
+    EXPECT_FALSE(IsMapped(path));
+}
+
+TEST(GameAssetView, FailsOnMissingFile) {
+    TempDir dir;
+    EXPECT_EQ(GameAssetView::MapFile((dir.path() + "/missing").c_str()),
+              nullptr);
+}
+
+TEST(GameAssetView, ViewsAssets) {
+    TempDir dir;
+    std::vector<uint8_t> contents = MakeContents(100 * 1000, 2);
+    dir.Write("asset", contents);
+    dir.Write("empty", nullptr, 0);
+
+    AAssetManager *assets = FakeAssetManager_create(dir.path().c_str(), false);
+    std::shared_ptr<GameAssetView> view = GameAssetView::FromAsset(
+        AAssetManager_open(assets, "asset", AASSET_MODE_BUFFER));
+    ASSERT_NE(view, nullptr);
+    EXPECT_TRUE(HasContents(*view, contents));
+
+    view = GameAssetView::FromAsset(
+        AAssetManager_open(assets, "empty", AASSET_MODE_BUFFER));
+    ASSERT_NE(view, nullptr);
+    EXPECT_EQ(view->GetSize(), 0u);
+
+    EXPECT_EQ(GameAssetView::FromAsset(
+                  AAssetManager_open(assets, "missing", AASSET_MODE_BUFFER)),
+              nullptr);
+    view.reset();
+    FakeAssetManager_destroy(assets);
+}
+
+}  // namespace agdktunnel_test
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// The part of the NDK's android/asset_manager.h used by the sample, for a
+// Linux host. See fake_asset_manager.h for the implementation.
+
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct AAssetManager;
+typedef struct AAssetManager AAssetManager;
+
+struct AAsset;
+typedef struct AAsset AAsset;
+
+enum {
+    AASSET_MODE_UNKNOWN = 0,
+    AASSET_MODE_RANDOM = 1,
+    AASSET_MODE_STREAMING = 2,
+    AASSET_MODE_BUFFER = 3
+};
+
+AAsset *AAssetManager_open(AAssetManager *mgr, const char *filename, int mode);
+
+int AAsset_read(AAsset *asset, void *buf, size_t count);
+
+off_t AAsset_getLength(AAsset *asset);
+
+const void *AAsset_getBuffer(AAsset *asset);
+
+int AAsset_openFileDescriptor64(AAsset *asset, off64_t *outStart,
+                                off64_t *outLength);
+
+void AAsset_close(AAsset *asset);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "fake_asset_manager.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+struct AAssetManager {
+    std::string directory;
+    bool uncompressed;
+};
+
+struct AAsset {
+    int fd;
+    off_t length;
+    bool uncompressed;
+    std::unique_ptr<char[]> buffer;
+};
+
+AAssetManager *FakeAssetManager_create(const char *directory,
+                                       bool uncompressed) {
+    return new AAssetManager{directory, uncompressed};
+}
+
+void FakeAssetManager_destroy(AAssetManager *mgr) { delete mgr; }
+
+AAsset *AAssetManager_open(AAssetManager *mgr, const char *filename,
+                           int /*mode*/) {
+    if (mgr == nullptr) return nullptr;
+    std::string path = mgr->directory + "/" + filename;
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+    struct stat fileStats;
+    if (fstat(fd, &fileStats) != 0) {
+        close(fd);
+        return nullptr;
+    }
+    return new AAsset{fd, fileStats.st_size, mgr->uncompressed, nullptr};
+}
+
+int AAsset_read(AAsset *asset, void *buf, size_t count) {
+    ssize_t result;
+    do {
+        result = read(asset->fd, buf, count);
+    } while (result < 0 && errno == EINTR);
+    return static_cast<int>(result);
+}
+
+off_t AAsset_getLength(AAsset *asset) { return asset->length; }
+
+const void *AAsset_getBuffer(AAsset *asset) {
+    if (!asset->buffer) {
+        std::unique_ptr<char[]> buffer(new char[asset->length]);
+        off_t bytesRead = 0;
+        while (bytesRead < asset->length) {
+            ssize_t result = pread(asset->fd, buffer.get() + bytesRead,
+                                   asset->length - bytesRead, bytesRead);
+            if (result < 0 && errno == EINTR) continue;
+            if (result <= 0) return nullptr;
+            bytesRead += result;
+        }
+        asset->buffer = std::move(buffer);
+    }
+    return asset->buffer.get();
+}
+
+int AAsset_openFileDescriptor64(AAsset *asset, off64_t *outStart,
+                                off64_t *outLength) {
+    if (!asset->uncompressed) return -1;
+    *outStart = 0;
+    *outLength = asset->length;
+    return fcntl(asset->fd, F_DUPFD_CLOEXEC, 0);
+}
+
+void AAsset_close(AAsset *asset) {
+    close(asset->fd);
+    delete asset;
+}
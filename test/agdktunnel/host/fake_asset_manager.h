@@ -0,0 +1,28 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android/asset_manager.h>
+
+// An asset manager serving the files of a directory, for tests on a host.
+// If uncompressed, the assets behave like assets stored uncompressed in an
+// APK: AAsset_openFileDescriptor64 returns a descriptor of the file. If not,
+// they can only be read with AAsset_read or AAsset_getBuffer.
+AAssetManager *FakeAssetManager_create(const char *directory,
+                                       bool uncompressed);
+
+void FakeAssetManager_destroy(AAssetManager *mgr);
@@ -0,0 +1,366 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The streaming loader of agdktunnel: contents, failures, progress and
+// cancellation, and a throughput benchmark against the previous loader,
+// which read each file whole with stdio on a single thread.
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fake_asset_manager.h"
+#include "gtest/gtest.h"
+#include "loading_thread.hpp"
+#include "test_files.h"
+
+using namespace std::chrono_literals;
+
+namespace agdktunnel_test {
+
+namespace {
+
+// Records the completion and progress messages of the loads sharing it as
+// userData.
+class LoadRecorder {
+   public:
+    static void OnComplete(const LoadingCompleteMessage *message) {
+        LoadRecorder *recorder = static_cast<LoadRecorder *>(message->userData);
+        std::lock_guard<std::mutex> lock(recorder->mutex_);
+        recorder->messages_.push_back(*message);
+        recorder->condition_.notify_all();
+    }
+
+    // Progress of a split file is reported concurrently by several workers.
+    static void OnProgress(const LoadingProgressMessage *message) {
+        LoadRecorder *recorder = static_cast<LoadRecorder *>(message->userData);
+        size_t previous = recorder->maxBytesRead;
+        while (previous < message->bytesRead &&
+               !recorder->maxBytesRead.compare_exchange_weak(
+                   previous, message->bytesRead)) {
+        }
+        recorder->totalBytes = message->totalBytes;
+        ++recorder->progressReports;
+    }
+
+    // Waits for count completions, returning them in completion order.
+    std::vector<LoadingCompleteMessage> WaitFor(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        EXPECT_TRUE(condition_.wait_for(lock, 10s, [&]() {
+            return messages_.size() >= count;
+        })) << "Timeout";
+        return messages_;
+    }
+
+    std::atomic<size_t> maxBytesRead{0};
+    std::atomic<size_t> totalBytes{0};
+    std::atomic<int> progressReports{0};
+
+   private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::vector<LoadingCompleteMessage> messages_;
+};
+
+// Sizes around the chunk and split thresholds of the loader.
+const size_t kFileSizes[] = {0,           1,          100000,
+                             256 * 1024,  256 * 1024 + 1,
+                             1024 * 1024, 3 * 1024 * 1024 + 17};
+
+}  // namespace
+
+TEST(LoadingThread, LoadsFilesOfAllSizes) {
+    TempDir dir;
+    std::vector<std::vector<uint8_t>> contents;
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < std::size(kFileSizes); ++i) {
+        contents.push_back(MakeContents(kFileSizes[i], i));
+        paths.push_back(dir.Write("file" + std::to_string(i), contents.back()));
+    }
+
+    for (int workers : {1, 4}) {
+        SCOPED_TRACE(workers);
+        LoadingThread loader(nullptr, workers);
+        EXPECT_EQ(loader.GetWorkerCount(), workers);
+        LoadRecorder recorder;
+        std::vector<std::vector<uint8_t>> buffers;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            buffers.emplace_back(kFileSizes[i] + 1, 0xcd);
+        }
+        for (size_t i = 0; i < paths.size(); ++i) {
+            EXPECT_NE(loader.StartAssetLoad(
+                          paths[i].c_str(), paths[i].c_str(), buffers[i].size(),
+                          buffers[i].data(), LoadRecorder::OnComplete, false,
+                          &recorder),
+                      INVALID_LOADING_JOB_ID);
+        }
+        auto messages = recorder.WaitFor(paths.size());
+        ASSERT_EQ(messages.size(), paths.size());
+        for (const LoadingCompleteMessage &message : messages) {
+            size_t i = std::find(paths.begin(), paths.end(),
+                                 message.assetName) -
+                       paths.begin();
+            ASSERT_LT(i, paths.size());
+            EXPECT_TRUE(message.loadSuccessful) << i;
+            EXPECT_FALSE(message.loadCancelled) << i;
+            EXPECT_EQ(message.bytesRead, kFileSizes[i]);
+            EXPECT_EQ(message.loadBuffer, buffers[i].data());
+            EXPECT_TRUE(std::equal(contents[i].begin(), contents[i].end(),
+                                   buffers[i].begin()))
+                << i;
+            // Nothing is written past the file.
+            EXPECT_EQ(buffers[i].back(), 0xcd) << i;
+        }
+    }
+}
+
+TEST(LoadingThread, FailsOnMissingFileOrSmallBuffer) {
+    TempDir dir;
+    std::string path = dir.Write("file", MakeContents(1000, 1));
+    std::string missing = dir.path() + "/missing";
+    std::vector<uint8_t> buffer(999);
+
+    LoadingThread loader(nullptr, 2);
+    LoadRecorder recorder;
+    loader.StartAssetLoad("missing", missing.c_str(), 1000, buffer.data(),
+                          LoadRecorder::OnComplete, false, &recorder);
+    loader.StartAssetLoad("small", path.c_str(), buffer.size(), buffer.data(),
+                          LoadRecorder::OnComplete, false, &recorder);
+    for (const LoadingCompleteMessage &message : recorder.WaitFor(2)) {
+        EXPECT_FALSE(message.loadSuccessful) << message.assetName;
+        EXPECT_FALSE(message.loadCancelled) << message.assetName;
+        EXPECT_EQ(message.bytesRead, 0u) << message.assetName;
+    }
+
+    std::string tooLong(LOADING_MAX_PATH_LENGTH, 'a');
+    EXPECT_EQ(loader.StartAssetLoad("long", tooLong.c_str(), buffer.size(),
+                                    buffer.data(), LoadRecorder::OnComplete, false,
+                                    &recorder),
+              INVALID_LOADING_JOB_ID);
+}
+
+TEST(LoadingThread, ReportsProgressOfSplitFiles) {
+    TempDir dir;
+    const size_t size = 5 * 1024 * 1024 + 3;
+    std::vector<uint8_t> contents = MakeContents(size, 2);
+    std::string path = dir.Write("file", contents);
+    std::vector<uint8_t> buffer(size);
+
+    LoadingThread loader(nullptr, 4);
+    LoadRecorder recorder;
+    loader.StartAssetLoad("file", path.c_str(), size, buffer.data(),
+                          LoadRecorder::OnComplete, false, &recorder,
+                          LOADING_PRIORITY_HIGH, LoadRecorder::OnProgress);
+    auto messages = recorder.WaitFor(1);
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_TRUE(messages[0].loadSuccessful);
+    EXPECT_EQ(recorder.maxBytesRead, size);
+    EXPECT_EQ(recorder.totalBytes, size);
+    // At least one report per 256KB chunk.
+    EXPECT_GE(recorder.progressReports, 20);
+    EXPECT_EQ(buffer, contents);
+}
+
+TEST(LoadingThread, CancelsQueuedLoad) {
+    TempDir dir;
+    std::string first = dir.Write("first", MakeContents(1000, 3));
+    std::string second = dir.Write("second", MakeContents(1000, 4));
+    std::vector<uint8_t> buffer1(1000), buffer2(1000);
+
+    // The single worker is held in the first load's progress callback while
+    // the second load is cancelled.
+    static std::mutex sMutex;
+    static std::condition_variable sCondition;
+    static bool sInFirst, sRelease;
+    sInFirst = sRelease = false;
+    LoadingProgressCallback hold = [](const LoadingProgressMessage *) {
+        std::unique_lock<std::mutex> lock(sMutex);
+        sInFirst = true;
+        sCondition.notify_all();
+        sCondition.wait(lock, []() { return sRelease; });
+    };
+
+    LoadingThread loader(nullptr, 1);
+    LoadRecorder recorder;
+    loader.StartAssetLoad("first", first.c_str(), buffer1.size(),
+                          buffer1.data(), LoadRecorder::OnComplete, false,
+                          &recorder, LOADING_PRIORITY_NORMAL, hold);
+    LoadingJobId id = loader.StartAssetLoad(
+        "second", second.c_str(), buffer2.size(), buffer2.data(),
+        LoadRecorder::OnComplete, false, &recorder);
+    {
+        std::unique_lock<std::mutex> lock(sMutex);
+        sCondition.wait(lock, []() { return sInFirst; });
+    }
+    EXPECT_TRUE(loader.CancelAssetLoad(id));
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        sRelease = true;
+        sCondition.notify_all();
+    }
+
+    auto messages = recorder.WaitFor(2);
+    ASSERT_EQ(messages.size(), 2u);
+    EXPECT_STREQ(messages[0].assetName, "first");
+    EXPECT_TRUE(messages[0].loadSuccessful);
+    EXPECT_STREQ(messages[1].assetName, "second");
+    EXPECT_FALSE(messages[1].loadSuccessful);
+    EXPECT_TRUE(messages[1].loadCancelled);
+    // Completed loads can't be cancelled.
+    EXPECT_FALSE(loader.CancelAssetLoad(id));
+}
+
+TEST(LoadingThread, LoadsThroughAssetManager) {
+    TempDir dir;
+    const size_t size = 2 * 1024 * 1024 + 5;
+    std::vector<uint8_t> contents = MakeContents(size, 5);
+    dir.Write("asset", contents);
+
+    // Compressed assets are streamed with AAsset_read, uncompressed ones are
+    // read with pread from the descriptor of the APK.
+    for (bool uncompressed : {false, true}) {
+        SCOPED_TRACE(uncompressed);
+        AAssetManager *assets =
+            FakeAssetManager_create(dir.path().c_str(), uncompressed);
+        {
+            LoadingThread loader(assets, 2);
+            LoadRecorder recorder;
+            std::vector<uint8_t> buffer(size);
+            loader.StartAssetLoad("asset", NULL, buffer.size(), buffer.data(),
+                                  LoadRecorder::OnComplete, true, &recorder);
+            loader.StartAssetLoad("missing", NULL, buffer.size(),
+                                  buffer.data(), LoadRecorder::OnComplete, true,
+                                  &recorder);
+            for (const auto &message : recorder.WaitFor(2)) {
+                bool isAsset = strcmp(message.assetName, "asset") == 0;
+                EXPECT_EQ(message.loadSuccessful, isAsset);
+                EXPECT_EQ(message.bytesRead, isAsset ? size : 0);
+            }
+            EXPECT_EQ(buffer, contents);
+        }
+        FakeAssetManager_destroy(assets);
+    }
+}
+
+namespace {
+
+// The previous loader: each file read whole with stdio, one after the other.
+bool LoadWithStdio(const std::string &path, size_t bufferSize, void *buffer) {
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (fp == NULL) return false;
+    struct stat fileStats;
+    bool loaded = fstat(fileno(fp), &fileStats) == 0 &&
+                  static_cast<size_t>(fileStats.st_size) <= bufferSize &&
+                  fread(buffer, fileStats.st_size, 1, fp) == 1;
+    fclose(fp);
+    return loaded;
+}
+
+void EvictFromPageCache(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    ASSERT_GE(fd, 0) << path;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+}  // namespace
+
+// Loads 200 files of 64KB to 32MB, 957MB in total, with and without the
+// files in the page cache, and prints the best throughput of 5 runs. Run it
+// with --gtest_also_run_disabled_tests --gtest_filter=*Benchmark.
+// Set TMPDIR to put the files on the storage to measure.
+TEST(LoadingThread, DISABLED_Benchmark) {
+    constexpr int kNumFiles = 200;
+    constexpr int kNumRuns = 5;
+
+    TempDir dir;
+    std::mt19937 random(1);
+    std::uniform_real_distribution<double> log2Size(16, 25);
+    std::vector<std::string> paths;
+    std::vector<std::vector<uint8_t>> buffers;
+    size_t totalBytes = 0;
+    for (int i = 0; i < kNumFiles; ++i) {
+        size_t size = static_cast<size_t>(std::exp2(log2Size(random)));
+        paths.push_back(dir.Write("file" + std::to_string(i),
+                                  MakeContents(size, i)));
+        buffers.emplace_back(size);
+        totalBytes += size;
+    }
+    printf("%d files, %.0f MB\n", kNumFiles, totalBytes / 1e6);
+
+    auto loadAll = [&](int workers) {
+        if (workers == 0) {
+            for (size_t i = 0; i < paths.size(); ++i) {
+                EXPECT_TRUE(LoadWithStdio(paths[i], buffers[i].size(),
+                                          buffers[i].data()));
+            }
+            return;
+        }
+        LoadingThread loader(nullptr, workers);
+        LoadRecorder recorder;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            loader.StartAssetLoad(paths[i].c_str(), paths[i].c_str(),
+                                  buffers[i].size(), buffers[i].data(),
+                                  LoadRecorder::OnComplete, false, &recorder);
+        }
+        for (const auto &message : recorder.WaitFor(paths.size())) {
+            EXPECT_TRUE(message.loadSuccessful);
+        }
+    };
+
+    for (bool evict : {true, false}) {
+        for (int workers : {0, 1, 4}) {
+            double best = 0;
+            for (int run = 0; run < kNumRuns; ++run) {
+                if (evict) {
+                    for (const std::string &path : paths) {
+                        EvictFromPageCache(path);
+                    }
+                } else {
+                    loadAll(workers);
+                }
+                auto start = std::chrono::steady_clock::now();
+                loadAll(workers);
+                std::chrono::duration<double> elapsed =
+                    std::chrono::steady_clock::now() - start;
+                best = std::max(best, totalBytes / elapsed.count() / 1e6);
+            }
+            printf("%s, %s: %.0f MB/s\n",
+                   evict ? "page cache evicted" : "hot cache",
+                   workers == 0 ? "previous loader"
+                                : (std::to_string(workers) + " worker(s)")
+                                      .c_str(),
+                   best);
+        }
+    }
+}
+
+}  // namespace agdktunnel_test
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "test_files.h"
+
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gtest/gtest.h"
+
+namespace agdktunnel_test {
+
+namespace {
+
+int RemoveEntry(const char* path, const struct stat*, int, struct FTW*) {
+    return remove(path);
+}
+
+}  // namespace
+
+TempDir::TempDir() {
+    const char* parent = getenv("TMPDIR");
+    std::string pattern = std::string(parent != nullptr ? parent : "/tmp") +
+                          "/agdktunnel_test_XXXXXX";
+    std::vector<char> dir(pattern.begin(), pattern.end());
+    dir.push_back('\0');
+    EXPECT_NE(mkdtemp(dir.data()), nullptr);
+    path_ = dir.data();
+}
+
+TempDir::~TempDir() {
+    nftw(path_.c_str(), RemoveEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+std::string TempDir::Write(const std::string& name, const void* data,
+                           size_t size) {
+    std::string path = path_ + "/" + name;
+    FILE* f = fopen(path.c_str(), "wb");
+    EXPECT_NE(f, nullptr) << path;
+    if (f != nullptr) {
+        EXPECT_EQ(fwrite(data, 1, size, f), size);
+        fclose(f);
+    }
+    return path;
+}
+
+std::vector<uint8_t> MakeContents(size_t size, uint32_t seed) {
+    std::vector<uint8_t> contents(size);
+    uint32_t state = seed * 2654435761u + 1;
+    for (size_t i = 0; i < size; ++i) {
+        state = state * 1664525u + 1013904223u;
+        contents[i] = static_cast<uint8_t>(state >> 24);
+    }
+    return contents;
+}
+
+}  // namespace agdktunnel_test
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace agdktunnel_test {
+
+// A new directory under $TMPDIR, or /tmp, removed with its files by the
+// destructor.
+class TempDir {
+   public:
+    TempDir();
+    ~TempDir();
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    const std::string& path() const { return path_; }
+
+    // Writes a file in the directory and returns its path.
+    std::string Write(const std::string& name, const void* data, size_t size);
+    std::string Write(const std::string& name,
+                      const std::vector<uint8_t>& data) {
+        return Write(name, data.data(), data.size());
+    }
+
+   private:
+    std::string path_;
+};
+
+// size bytes that differ between files of different seeds.
+std::vector<uint8_t> MakeContents(size_t size, uint32_t seed);
+
+}  // namespace agdktunnel_test
@@ -0,0 +1,380 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The texture container parsers of agdktunnel on the .ktx textures of the
+// sample, on the .ktx2 and .astc files of data/, written by
+// data/make_textures.py, and on truncated and corrupted copies of them.
+
+#include "texture_container.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace agdktunnel_test {
+
+namespace {
+
+const uint32_t GL_COMPRESSED_RGB8_ETC2 = 0x9274;
+const uint32_t GL_COMPRESSED_RGBA8_ETC2_EAC = 0x9278;
+const uint32_t GL_COMPRESSED_RGB_S3TC_DXT1_EXT = 0x83F0;
+const uint32_t GL_COMPRESSED_RGBA_ASTC_4x4_KHR = 0x93B0;
+const uint32_t GL_COMPRESSED_RGBA_ASTC_6x6_KHR = 0x93B4;
+const uint32_t VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK = 147;
+
+std::vector<uint8_t> ReadFile(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    EXPECT_TRUE(file.good()) << path;
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file),
+                                std::istreambuf_iterator<char>());
+}
+
+std::vector<uint8_t> ReadTestFile(const char *name) {
+    return ReadFile(std::string(AGDKTUNNEL_TEST_DATA_DIR) + "/" + name);
+}
+
+bool Parse(const std::vector<uint8_t> &file, TextureContainer *container) {
+    return ParseTextureContainer(file.data(), file.size(), container);
+}
+
+void WriteU32(std::vector<uint8_t> *file, size_t offset, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        (*file)[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+void WriteU64(std::vector<uint8_t> *file, size_t offset, uint64_t value) {
+    WriteU32(file, offset, static_cast<uint32_t>(value));
+    WriteU32(file, offset + 4, static_cast<uint32_t>(value >> 32));
+}
+
+// What holds for every container that parses, whatever its contents.
+void ExpectLevelsInFile(const TextureContainer &container, size_t fileSize) {
+    ASSERT_GE(container.mipCount, 1u);
+    ASSERT_LE(container.mipCount,
+              static_cast<uint32_t>(MAX_TEXTURE_MIP_LEVELS));
+    for (uint32_t level = 0; level < container.mipCount; ++level) {
+        const TextureMipLevel &mip = container.mips[level];
+        EXPECT_LE(mip.offset, fileSize);
+        EXPECT_LE(mip.size, fileSize - mip.offset);
+        EXPECT_GE(mip.width, 1u);
+        EXPECT_GE(mip.height, 1u);
+    }
+}
+
+// Prefixes of file, every step bytes and the one missing only the last byte,
+// are rejected.
+void ExpectTruncationsFail(const std::vector<uint8_t> &file, size_t step) {
+    TextureContainer container;
+    for (size_t size = 0; size < file.size(); size += step) {
+        // A heap copy of exactly size bytes, so that a read past its end is
+        // caught by sanitizers.
+        std::vector<uint8_t> prefix(file.begin(), file.begin() + size);
+        EXPECT_FALSE(Parse(prefix, &container)) << "size " << size;
+    }
+    std::vector<uint8_t> prefix(file.begin(), file.end() - 1);
+    EXPECT_FALSE(Parse(prefix, &container));
+}
+
+// Each header byte set to values that break length and count fields: the
+// parsers either reject the file or return levels inside it.
+void ExpectCorruptHeadersAreSafe(const std::vector<uint8_t> &file,
+                                 size_t headerSize) {
+    TextureContainer container;
+    for (size_t i = 0; i < headerSize; ++i) {
+        for (uint8_t value : {0x00, 0x01, 0x7f, 0x80, 0xff}) {
+            std::vector<uint8_t> corrupt = file;
+            corrupt[i] = value;
+            if (Parse(corrupt, &container)) {
+                SCOPED_TRACE(testing::Message() << "byte " << i << " set to "
+                                                << static_cast<int>(value));
+                ExpectLevelsInFile(container, corrupt.size());
+            }
+        }
+    }
+}
+
+}  // namespace
+
+TEST(TextureContainer, SampleKTXTextures) {
+    const std::string sample = AGDKTUNNEL_SAMPLE_DIR;
+    const char *textures[] = {
+        "install_time_assets/src/main/assets/textures/wall1.ktx",
+        "install_time_assets/src/main/assets/textures/wall2.ktx",
+        "on_demand_assets/src/main/assets/textures/wall3.ktx",
+        "on_demand_assets/src/main/assets/textures/wall8.ktx",
+        "install_time_assets/src/main/assets/textures#tcf_dxt1/wall1.ktx",
+        "on_demand_assets/src/main/assets/textures#tcf_dxt1/wall8.ktx",
+    };
+    for (const char *texture : textures) {
+        SCOPED_TRACE(texture);
+        std::vector<uint8_t> file = ReadFile(sample + "/" + texture);
+        bool isDXT1 = strstr(texture, "#tcf_dxt1") != nullptr;
+
+        TextureContainer container;
+        ASSERT_TRUE(Parse(file, &container));
+        EXPECT_EQ(container.type, TEXTURECONTAINER_KTX);
+        EXPECT_EQ(container.glInternalFormat,
+                  isDXT1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+                         : GL_COMPRESSED_RGB8_ETC2);
+        ASSERT_NE(container.format, nullptr);
+        EXPECT_EQ(container.vkFormat, container.format->vkFormat);
+        EXPECT_EQ(container.width, 2048u);
+        EXPECT_EQ(container.height, 2048u);
+        EXPECT_EQ(container.supercompressionScheme,
+                  static_cast<uint32_t>(TEXTURESUPERCOMPRESSION_NONE));
+        // The ETC2 textures have a full mip chain, the DXT1 ones the first
+        // level only.
+        ASSERT_EQ(container.mipCount, isDXT1 ? 1u : 12u);
+        for (uint32_t level = 0; level < container.mipCount; ++level) {
+            const TextureMipLevel &mip = container.mips[level];
+            EXPECT_EQ(mip.width, 2048u >> level);
+            EXPECT_EQ(mip.height, 2048u >> level);
+            EXPECT_EQ(mip.size, (std::max(mip.width, 4u) / 4) *
+                                    (std::max(mip.height, 4u) / 4) * 8);
+            EXPECT_EQ(mip.uncompressedSize, mip.size);
+            EXPECT_EQ(mip.offset % 4, 0u);
+        }
+        const TextureMipLevel &last = container.mips[container.mipCount - 1];
+        EXPECT_EQ(last.offset + last.size, file.size());
+    }
+}
+
+TEST(TextureContainer, ASTC) {
+    std::vector<uint8_t> file = ReadTestFile("astc_4x4_16x8.astc");
+    TextureContainer container;
+    ASSERT_TRUE(Parse(file, &container));
+    EXPECT_EQ(container.type, TEXTURECONTAINER_ASTC);
+    ASSERT_NE(container.format, nullptr);
+    EXPECT_EQ(container.glInternalFormat, GL_COMPRESSED_RGBA_ASTC_4x4_KHR);
+    EXPECT_STREQ(container.format->glExtension,
+                 "GL_OES_texture_compression_astc");
+    EXPECT_EQ(container.width, 16u);
+    EXPECT_EQ(container.height, 8u);
+    ASSERT_EQ(container.mipCount, 1u);
+    EXPECT_EQ(container.mips[0].offset, 16u);
+    EXPECT_EQ(container.mips[0].size, 4u * 2 * 16);
+
+    // Partial blocks at the right and bottom edges.
+    file = ReadTestFile("astc_6x6_13x7.astc");
+    ASSERT_TRUE(Parse(file, &container));
+    EXPECT_EQ(container.glInternalFormat, GL_COMPRESSED_RGBA_ASTC_6x6_KHR);
+    EXPECT_EQ(container.width, 13u);
+    EXPECT_EQ(container.height, 7u);
+    EXPECT_EQ(container.mips[0].size, 3u * 2 * 16);
+}
+
+TEST(TextureContainer, KTX2) {
+    std::vector<uint8_t> file = ReadTestFile("etc2_rgba8_32x16.ktx2");
+    TextureContainer container;
+    ASSERT_TRUE(Parse(file, &container));
+    EXPECT_EQ(container.type, TEXTURECONTAINER_KTX2);
+    ASSERT_NE(container.format, nullptr);
+    EXPECT_EQ(container.glInternalFormat, GL_COMPRESSED_RGBA8_ETC2_EAC);
+    EXPECT_EQ(container.width, 32u);
+    EXPECT_EQ(container.height, 16u);
+    EXPECT_EQ(container.supercompressionGlobalDataSize, 0u);
+    ASSERT_EQ(container.mipCount, 6u);
+    const uint32_t widths[] = {32, 16, 8, 4, 2, 1};
+    const uint32_t heights[] = {16, 8, 4, 2, 1, 1};
+    const size_t sizes[] = {512, 128, 32, 16, 16, 16};
+    for (uint32_t level = 0; level < container.mipCount; ++level) {
+        const TextureMipLevel &mip = container.mips[level];
+        EXPECT_EQ(mip.width, widths[level]);
+        EXPECT_EQ(mip.height, heights[level]);
+        EXPECT_EQ(mip.size, sizes[level]);
+        EXPECT_EQ(mip.uncompressedSize, sizes[level]);
+        // Levels are stored from the smallest up.
+        if (level > 0) {
+            EXPECT_LT(mip.offset, container.mips[level - 1].offset);
+        }
+    }
+    EXPECT_EQ(container.mips[0].offset + container.mips[0].size, file.size());
+}
+
+TEST(TextureContainer, SupercompressedKTX2) {
+    std::vector<uint8_t> file = ReadTestFile("etc2_rgb8_zstd_8x8.ktx2");
+    TextureContainer container;
+    ASSERT_TRUE(Parse(file, &container));
+    EXPECT_EQ(container.supercompressionScheme,
+              static_cast<uint32_t>(TEXTURESUPERCOMPRESSION_ZSTD));
+    EXPECT_EQ(container.vkFormat, VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK);
+    EXPECT_EQ(container.glInternalFormat, GL_COMPRESSED_RGB8_ETC2);
+    ASSERT_EQ(container.mipCount, 1u);
+    // The level size isn't checked against the format until decompressed.
+    EXPECT_EQ(container.mips[0].size, 21u);
+    EXPECT_EQ(container.mips[0].uncompressedSize, 32u);
+
+    // BasisLZ leaves the format to the transcoder.
+    file = ReadTestFile("basislz_64x32.ktx2");
+    ASSERT_TRUE(Parse(file, &container));
+    EXPECT_EQ(container.supercompressionScheme,
+              static_cast<uint32_t>(TEXTURESUPERCOMPRESSION_BASISLZ));
+    EXPECT_EQ(container.format, nullptr);
+    EXPECT_EQ(container.vkFormat, 0u);
+    EXPECT_EQ(container.glInternalFormat, 0u);
+    EXPECT_EQ(container.width, 64u);
+    EXPECT_EQ(container.height, 32u);
+    EXPECT_EQ(container.supercompressionGlobalDataOffset, 208u);
+    EXPECT_EQ(container.supercompressionGlobalDataSize, 52u);
+    ASSERT_EQ(container.mipCount, 2u);
+    EXPECT_EQ(container.mips[0].size, 75u);
+    EXPECT_EQ(container.mips[1].size, 30u);
+    EXPECT_EQ(container.mips[1].width, 32u);
+    EXPECT_EQ(container.mips[1].height, 16u);
+}
+
+TEST(TextureContainer, TruncatedFiles) {
+    for (const char *name :
+         {"astc_4x4_16x8.astc", "astc_6x6_13x7.astc", "etc2_rgba8_32x16.ktx2",
+          "etc2_rgb8_zstd_8x8.ktx2", "basislz_64x32.ktx2"}) {
+        SCOPED_TRACE(name);
+        ExpectTruncationsFail(ReadTestFile(name), 1);
+    }
+    ExpectTruncationsFail(
+        ReadFile(std::string(AGDKTUNNEL_SAMPLE_DIR) +
+                 "/install_time_assets/src/main/assets/textures/wall1.ktx"),
+        4099);
+}
+
+TEST(TextureContainer, CorruptASTCHeaders) {
+    const std::vector<uint8_t> file = ReadTestFile("astc_4x4_16x8.astc");
+    TextureContainer container;
+
+    std::vector<uint8_t> corrupt = file;
+    corrupt[0] = 0x12;  // magic
+    EXPECT_FALSE(Parse(corrupt, &container));
+    EXPECT_EQ(container.type, TEXTURECONTAINER_UNKNOWN);
+
+    corrupt = file;
+    corrupt[4] = 7;  // no 7x4 block format
+    EXPECT_FALSE(Parse(corrupt, &container));
+
+    corrupt = file;
+    corrupt[6] = 2;  // 3D blocks
+    EXPECT_FALSE(Parse(corrupt, &container));
+
+    corrupt = file;
+    corrupt[13] = 2;  // depth
+    EXPECT_FALSE(Parse(corrupt, &container));
+
+    corrupt = file;
+    corrupt[7] = 20;  // width, one more column of blocks than in the file
+    EXPECT_FALSE(Parse(corrupt, &container));
+
+    ExpectCorruptHeadersAreSafe(file, 16);
+}
+
+TEST(TextureContainer, CorruptKTXHeaders) {
+    const std::vector<uint8_t> file =
+        ReadFile(std::string(AGDKTUNNEL_SAMPLE_DIR) +
+                 "/install_time_assets/src/main/assets/textures#tcf_dxt1/"
+                 "wall1.ktx");
+    TextureContainer container;
+    ASSERT_TRUE(Parse(file, &container));
+
+    // Field offsets from the start of the file.
+    const size_t endianness = 12, pixelHeight = 40, pixelDepth = 44,
+                 arrayElements = 48, faces = 52, mipLevels = 56,
+                 bytesOfKeyValueData = 60, imageSize = 92;
+    const std::pair<size_t, uint32_t> corruptions[] = {
+        {endianness, 0x01020304},
+        {pixelHeight, 0},
+        {pixelDepth, 1},
+        {arrayElements, 2},
+        {faces, 6},
+        {mipLevels, MAX_TEXTURE_MIP_LEVELS + 1},
+        {mipLevels, 2},
+        {bytesOfKeyValueData, 0xfffffffc},
+        {bytesOfKeyValueData, 32},
+        {imageSize, 0xfffffffc},
+        {imageSize, 2048 * 2048 / 2 - 8},
+    };
+    for (const auto &corruption : corruptions) {
+        SCOPED_TRACE(testing::Message() << "field at " << corruption.first
+                                        << " set to " << corruption.second);
+        std::vector<uint8_t> corrupt = file;
+        WriteU32(&corrupt, corruption.first, corruption.second);
+        EXPECT_FALSE(Parse(corrupt, &container));
+    }
+
+    ExpectCorruptHeadersAreSafe(file, imageSize + 4);
+}
+
+TEST(TextureContainer, CorruptKTX2Headers) {
+    const std::vector<uint8_t> file = ReadTestFile("etc2_rgba8_32x16.ktx2");
+    const std::vector<uint8_t> basis = ReadTestFile("basislz_64x32.ktx2");
+    TextureContainer container;
+
+    // Field offsets from the start of the file.
+    const size_t pixelHeight = 24, pixelDepth = 28, layerCount = 32,
+                 faceCount = 36, levelCount = 40, sgdByteOffset = 64,
+                 sgdByteLength = 72, levelIndex = 80;
+    const std::pair<size_t, uint32_t> corruptions[] = {
+        {pixelHeight, 0},
+        {pixelDepth, 1},
+        {layerCount, 2},
+        {faceCount, 6},
+        {levelCount, MAX_TEXTURE_MIP_LEVELS + 1},
+        // Level 0 one byte short, which the format catches.
+        {levelIndex + 8, 511},
+    };
+    for (const auto &corruption : corruptions) {
+        SCOPED_TRACE(testing::Message() << "field at " << corruption.first
+                                        << " set to " << corruption.second);
+        std::vector<uint8_t> corrupt = file;
+        WriteU32(&corrupt, corruption.first, corruption.second);
+        EXPECT_FALSE(Parse(corrupt, &container));
+    }
+
+    // Offsets and lengths that overflow when added.
+    for (size_t field : {levelIndex, levelIndex + 8}) {
+        std::vector<uint8_t> corrupt = file;
+        WriteU64(&corrupt, field, UINT64_MAX - 8);
+        EXPECT_FALSE(Parse(corrupt, &container));
+    }
+    for (size_t field : {sgdByteOffset, sgdByteLength}) {
+        std::vector<uint8_t> corrupt = basis;
+        WriteU64(&corrupt, field, UINT64_MAX - 8);
+        EXPECT_FALSE(Parse(corrupt, &container));
+    }
+    // More levels than the index in the file has room for.
+    std::vector<uint8_t> corrupt(file.begin(), file.begin() + levelIndex + 24);
+    corrupt.push_back(0);
+    WriteU32(&corrupt, levelCount, 2);
+    EXPECT_FALSE(Parse(corrupt, &container));
+
+    ExpectCorruptHeadersAreSafe(file, levelIndex + 6 * 24);
+    ExpectCorruptHeadersAreSafe(basis, levelIndex + 2 * 24);
+}
+
+TEST(TextureContainer, UnknownContainers) {
+    TextureContainer container;
+    EXPECT_FALSE(ParseTextureContainer(nullptr, 0, &container));
+    EXPECT_EQ(container.type, TEXTURECONTAINER_UNKNOWN);
+    std::vector<uint8_t> file = ReadTestFile("etc2_rgba8_32x16.ktx2");
+    file[5] = '1';  // "KTX 10"
+    EXPECT_FALSE(Parse(file, &container));
+    EXPECT_EQ(container.type, TEXTURECONTAINER_UNKNOWN);
+}
+
+}  // namespace agdktunnel_test
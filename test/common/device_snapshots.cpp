@@ -0,0 +1,779 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "device_snapshots.h"
+
+#include <ftw.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <cstdio>
+
+#include "gtest/gtest.h"
+#include "procfs.h"
+
+namespace gamesdk_test {
+
+namespace {
+
+#ifdef __ANDROID__
+constexpr char kSnapshotTemplate[] = "/data/local/tmp/device_snapshot_XXXXXX";
+#else
+constexpr char kSnapshotTemplate[] = "/tmp/device_snapshot_XXXXXX";
+#endif
+
+int RemoveEntry(const char* path, const struct stat*, int, struct FTW*) {
+    return remove(path);
+}
+
+// One entry of an arm64 /proc/cpuinfo.
+std::string Arm64Processor(int id, const char* bogomips, const char* features,
+                           const char* implementer, const char* variant,
+                           const char* part, const char* revision) {
+    return "processor\t: " + std::to_string(id) +
+           "\n"
+           "BogoMIPS\t: " +
+           bogomips +
+           "\n"
+           "Features\t: " +
+           features +
+           "\n"
+           "CPU implementer\t: " +
+           implementer +
+           "\n"
+           "CPU architecture: 8\n"
+           "CPU variant\t: " +
+           variant +
+           "\n"
+           "CPU part\t: " +
+           part +
+           "\n"
+           "CPU revision\t: " +
+           revision + "\n\n";
+}
+
+constexpr char kArmV82Features[] =
+    "fp asimd evtstrm aes pmull sha1 sha2 crc32 atomics fphp asimdhp cpuid "
+    "asimdrdm lrcpc dcpop asimddp";
+constexpr char kArmV82SsbsFeatures[] =
+    "fp asimd evtstrm aes pmull sha1 sha2 crc32 atomics fphp asimdhp cpuid "
+    "asimdrdm lrcpc dcpop asimddp ssbs";
+
+// Tensor GS101: 4 Cortex-A55, 2 Cortex-A76 and 2 Cortex-X1. Recent arm64
+// kernels have no "Hardware" line.
+DeviceSnapshot Pixel6() {
+    std::string cpuinfo;
+    for (int i = 0; i < 4; ++i)
+        cpuinfo += Arm64Processor(i, "49.15", kArmV82Features, "0x41", "0x2",
+                                  "0xd05", "0");
+    for (int i = 4; i < 6; ++i)
+        cpuinfo += Arm64Processor(i, "49.15", kArmV82SsbsFeatures, "0x41",
+                                  "0x4", "0xd0b", "0");
+    for (int i = 6; i < 8; ++i)
+        cpuinfo += Arm64Processor(i, "49.15", kArmV82SsbsFeatures, "0x41",
+                                  "0x1", "0xd44", "0");
+    return {
+        "pixel_6",
+        "0-7",
+        "0-7",
+        7,
+        {1803000, 1803000, 1803000, 1803000, 2253000, 2253000, 2802000,
+         2802000},
+        cpuinfo,
+        "MemTotal:        7869560 kB\n"
+        "MemFree:          183712 kB\n"
+        "MemAvailable:    3126120 kB\n"
+        "Buffers:            3868 kB\n"
+        "Cached:          3018248 kB\n"
+        "SwapCached:        21084 kB\n"
+        "Active:          2189356 kB\n"
+        "Inactive:        2476628 kB\n"
+        "Active(anon):     935872 kB\n"
+        "Inactive(anon):   944680 kB\n"
+        "Active(file):    1253484 kB\n"
+        "Inactive(file):  1531948 kB\n"
+        "Unevictable:      262360 kB\n"
+        "Mlocked:          253356 kB\n"
+        "SwapTotal:       4194300 kB\n"
+        "SwapFree:        3283704 kB\n"
+        "Dirty:               540 kB\n"
+        "Writeback:             0 kB\n"
+        "AnonPages:       1882224 kB\n"
+        "Mapped:          1270188 kB\n"
+        "Shmem:             16004 kB\n"
+        "KReclaimable:     212960 kB\n"
+        "Slab:             459292 kB\n"
+        "SReclaimable:     138892 kB\n"
+        "SUnreclaim:       320400 kB\n"
+        "KernelStack:       72832 kB\n"
+        "ShadowCallStack:   18232 kB\n"
+        "PageTables:       141124 kB\n"
+        "NFS_Unstable:          0 kB\n"
+        "Bounce:                0 kB\n"
+        "WritebackTmp:          0 kB\n"
+        "CommitLimit:     8129080 kB\n"
+        "Committed_AS:  138063344 kB\n"
+        "VmallocTotal:   262930368 kB\n"
+        "VmallocUsed:      271328 kB\n"
+        "VmallocChunk:          0 kB\n"
+        "Percpu:            11136 kB\n"
+        "AnonHugePages:         0 kB\n"
+        "ShmemHugePages:        0 kB\n"
+        "ShmemPmdMapped:        0 kB\n"
+        "FileHugePages:         0 kB\n"
+        "FilePmdMapped:         0 kB\n"
+        "CmaTotal:         196608 kB\n"
+        "CmaFree:            2812 kB\n",
+        "Name:\tcom.example.game\n"
+        "Umask:\t0077\n"
+        "State:\tS (sleeping)\n"
+        "Tgid:\t12345\n"
+        "Ngid:\t0\n"
+        "Pid:\t12345\n"
+        "PPid:\t712\n"
+        "TracerPid:\t0\n"
+        "Uid:\t10245\t10245\t10245\t10245\n"
+        "Gid:\t10245\t10245\t10245\t10245\n"
+        "FDSize:\t256\n"
+        "Groups:\t3002 3003 9997 20245 50245\n"
+        "VmPeak:\t22315512 kB\n"
+        "VmSize:\t21650628 kB\n"
+        "VmLck:\t       0 kB\n"
+        "VmPin:\t       0 kB\n"
+        "VmHWM:\t  812344 kB\n"
+        "VmRSS:\t  745120 kB\n"
+        "RssAnon:\t  402916 kB\n"
+        "RssFile:\t  336880 kB\n"
+        "RssShmem:\t    5324 kB\n"
+        "VmData:\t 2731260 kB\n"
+        "VmStk:\t    8192 kB\n"
+        "VmExe:\t      12 kB\n"
+        "VmLib:\t  237348 kB\n"
+        "VmPTE:\t    5168 kB\n"
+        "VmSwap:\t   46828 kB\n"
+        "CoreDumping:\t0\n"
+        "THP_enabled:\t1\n"
+        "Threads:\t98\n"
+        "SigQ:\t0/29928\n"
+        "SigPnd:\t0000000000000000\n"
+        "ShdPnd:\t0000000000000000\n"
+        "SigBlk:\t0000000080001204\n"
+        "SigIgn:\t0000000000000001\n"
+        "SigCgt:\t0000006e400084f8\n"
+        "CapInh:\t0000000000000000\n"
+        "CapPrm:\t0000000000000000\n"
+        "CapEff:\t0000000000000000\n"
+        "CapBnd:\t0000000000000000\n"
+        "CapAmb:\t0000000000000000\n"
+        "NoNewPrivs:\t0\n"
+        "Seccomp:\t2\n"
+        "Seccomp_filters:\t1\n"
+        "Speculation_Store_Bypass:\tthread vulnerable\n"
+        "Cpus_allowed:\tff\n"
+        "Cpus_allowed_list:\t0-7\n"
+        "Mems_allowed:\t1\n"
+        "Mems_allowed_list:\t0\n"
+        "voluntary_ctxt_switches:\t1822\n"
+        "nonvoluntary_ctxt_switches:\t611\n",
+        0,
+        "",
+        8,
+        4,
+        17,
+        44,
+        15,
+        7869560,
+        4194300,
+        745120,
+    };
+}
+
+// Exynos 9820: 4 Cortex-A55, 2 Mongoose M4 and 2 Cortex-A75.
+DeviceSnapshot GalaxyS10() {
+    std::string cpuinfo;
+    for (int i = 0; i < 4; ++i)
+        cpuinfo += Arm64Processor(i, "52.00", kArmV82Features, "0x41", "0x1",
+                                  "0xd05", "0");
+    for (int i = 4; i < 6; ++i)
+        cpuinfo += Arm64Processor(i, "52.00", kArmV82Features, "0x53", "0x1",
+                                  "0x002", "0");
+    for (int i = 6; i < 8; ++i)
+        cpuinfo += Arm64Processor(i, "52.00", kArmV82Features, "0x41", "0x3",
+                                  "0xd0a", "0");
+    cpuinfo += "Hardware\t: Samsung EXYNOS9820\n";
+    return {
+        "galaxy_s10",
+        "0-7",
+        "0-7",
+        7,
+        {1950000, 1950000, 1950000, 1950000, 2314000, 2314000, 2730000,
+         2730000},
+        cpuinfo,
+        "MemTotal:        7700864 kB\n"
+        "MemFree:          402512 kB\n"
+        "MemAvailable:    3552276 kB\n"
+        "Buffers:          125696 kB\n"
+        "Cached:          3151240 kB\n"
+        "SwapCached:        52840 kB\n"
+        "Active:          2658532 kB\n"
+        "Inactive:        2061428 kB\n"
+        "Active(anon):    1218620 kB\n"
+        "Inactive(anon):   563320 kB\n"
+        "Active(file):    1439912 kB\n"
+        "Inactive(file):  1498108 kB\n"
+        "Unevictable:      128848 kB\n"
+        "Mlocked:          128848 kB\n"
+        "RbinTotal:        409600 kB\n"
+        "RbinAlloced:        2048 kB\n"
+        "RbinPool:          34040 kB\n"
+        "RbinFree:         373512 kB\n"
+        "SwapTotal:       2097148 kB\n"
+        "SwapFree:        1235668 kB\n"
+        "Dirty:               116 kB\n"
+        "Writeback:             0 kB\n"
+        "AnonPages:       1545096 kB\n"
+        "Mapped:           967732 kB\n"
+        "Shmem:             20900 kB\n"
+        "Slab:             378016 kB\n"
+        "SReclaimable:     136820 kB\n"
+        "SUnreclaim:       241196 kB\n"
+        "KernelStack:       82432 kB\n"
+        "PageTables:       121564 kB\n"
+        "NFS_Unstable:          0 kB\n"
+        "Bounce:                0 kB\n"
+        "WritebackTmp:          0 kB\n"
+        "CommitLimit:     5947580 kB\n"
+        "Committed_AS:  126771712 kB\n"
+        "VmallocTotal:   263061440 kB\n"
+        "VmallocUsed:           0 kB\n"
+        "VmallocChunk:          0 kB\n"
+        "CmaTotal:         200704 kB\n"
+        "CmaFree:               0 kB\n",
+        "Name:\tcom.example.game\n"
+        "Umask:\t0077\n"
+        "State:\tS (sleeping)\n"
+        "Tgid:\t23456\n"
+        "Ngid:\t0\n"
+        "Pid:\t23456\n"
+        "PPid:\t4310\n"
+        "TracerPid:\t0\n"
+        "Uid:\t10312\t10312\t10312\t10312\n"
+        "Gid:\t10312\t10312\t10312\t10312\n"
+        "FDSize:\t512\n"
+        "Groups:\t3002 3003 9997 20312 50312\n"
+        "VmPeak:\t 8211580 kB\n"
+        "VmSize:\t 7980112 kB\n"
+        "VmLck:\t       0 kB\n"
+        "VmPin:\t       0 kB\n"
+        "VmHWM:\t  998268 kB\n"
+        "VmRSS:\t  921404 kB\n"
+        "RssAnon:\t  611876 kB\n"
+        "RssFile:\t  305292 kB\n"
+        "RssShmem:\t    4236 kB\n"
+        "VmData:\t 2114544 kB\n"
+        "VmStk:\t    8192 kB\n"
+        "VmExe:\t      20 kB\n"
+        "VmLib:\t  201884 kB\n"
+        "VmPTE:\t    3908 kB\n"
+        "VmPMD:\t      40 kB\n"
+        "VmSwap:\t  103288 kB\n"
+        "Threads:\t121\n"
+        "SigQ:\t0/29636\n"
+        "SigPnd:\t0000000000000000\n"
+        "ShdPnd:\t0000000000000000\n"
+        "SigBlk:\t0000000080001204\n"
+        "SigIgn:\t0000000000000001\n"
+        "SigCgt:\t0000000e400084f8\n"
+        "CapInh:\t0000000000000000\n"
+        "CapPrm:\t0000000000000000\n"
+        "CapEff:\t0000000000000000\n"
+        "CapBnd:\t0000000000000000\n"
+        "CapAmb:\t0000000000000000\n"
+        "NoNewPrivs:\t0\n"
+        "Seccomp:\t2\n"
+        "Speculation_Store_Bypass:\tthread vulnerable\n"
+        "Cpus_allowed:\tff\n"
+        "Cpus_allowed_list:\t0-7\n"
+        "voluntary_ctxt_switches:\t40211\n"
+        "nonvoluntary_ctxt_switches:\t8892\n",
+        200,
+        "Samsung EXYNOS9820",
+        8,
+        4,
+        16,
+        40,
+        16,
+        7700864,
+        2097148,
+        921404,
+    };
+}
+
+// Snapdragon 888 with its two biggest cores offline: /proc/cpuinfo only
+// lists the online CPUs, while sysfs has all of them.
+DeviceSnapshot Snapdragon888WithOfflineCores() {
+    std::string cpuinfo;
+    for (int i = 0; i < 4; ++i)
+        cpuinfo += Arm64Processor(i, "38.40", kArmV82Features, "0x41", "0x2",
+                                  "0xd05", "0");
+    for (int i = 4; i < 6; ++i)
+        cpuinfo += Arm64Processor(i, "38.40", kArmV82SsbsFeatures, "0x41",
+                                  "0x1", "0xd41", "1");
+    cpuinfo += "Hardware\t: Qualcomm Technologies, Inc SM8350\n";
+    return {
+        "snapdragon_888_offline_cores",
+        "0-7",
+        "0-7",
+        7,
+        {1804800, 1804800, 1804800, 1804800, 2419200, 2419200, 2419200,
+         2841600},
+        cpuinfo,
+        "MemTotal:       11631668 kB\n"
+        "MemFree:          512904 kB\n"
+        "MemAvailable:    6120036 kB\n"
+        "Buffers:            5296 kB\n"
+        "Cached:          5654540 kB\n"
+        "SwapCached:         7360 kB\n"
+        "Active:          3319596 kB\n"
+        "Inactive:        4301192 kB\n"
+        "Active(anon):     968012 kB\n"
+        "Inactive(anon):  1127732 kB\n"
+        "Active(file):    2351584 kB\n"
+        "Inactive(file):  3173460 kB\n"
+        "Unevictable:      144880 kB\n"
+        "Mlocked:          144880 kB\n"
+        "SwapTotal:       4194300 kB\n"
+        "SwapFree:        3804204 kB\n"
+        "Dirty:              1436 kB\n"
+        "Writeback:             0 kB\n"
+        "AnonPages:       2098040 kB\n"
+        "Mapped:          1596080 kB\n"
+        "Shmem:             33628 kB\n"
+        "KReclaimable:     431288 kB\n"
+        "Slab:             630604 kB\n"
+        "SReclaimable:     226400 kB\n"
+        "SUnreclaim:       404204 kB\n"
+        "KernelStack:       67360 kB\n"
+        "ShadowCallStack:   16860 kB\n"
+        "PageTables:       116504 kB\n"
+        "NFS_Unstable:          0 kB\n"
+        "Bounce:                0 kB\n"
+        "WritebackTmp:          0 kB\n"
+        "CommitLimit:    10010132 kB\n"
+        "Committed_AS:  103652108 kB\n"
+        "VmallocTotal:   262930368 kB\n"
+        "VmallocUsed:      244428 kB\n"
+        "VmallocChunk:          0 kB\n"
+        "Percpu:            10496 kB\n"
+        "CmaTotal:         200704 kB\n"
+        "CmaFree:           22048 kB\n",
+        "Name:\tcom.example.game\n"
+        "Umask:\t0077\n"
+        "State:\tR (running)\n"
+        "Tgid:\t8800\n"
+        "Ngid:\t0\n"
+        "Pid:\t8800\n"
+        "PPid:\t1016\n"
+        "TracerPid:\t0\n"
+        "Uid:\t10198\t10198\t10198\t10198\n"
+        "Gid:\t10198\t10198\t10198\t10198\n"
+        "FDSize:\t256\n"
+        "Groups:\t3002 3003 9997 20198 50198\n"
+        "VmPeak:\t16520224 kB\n"
+        "VmSize:\t16310948 kB\n"
+        "VmLck:\t       0 kB\n"
+        "VmPin:\t       0 kB\n"
+        "VmHWM:\t 1310732 kB\n"
+        "VmRSS:\t 1288204 kB\n"
+        "RssAnon:\t  884416 kB\n"
+        "RssFile:\t  395544 kB\n"
+        "RssShmem:\t    8244 kB\n"
+        "VmData:\t 3309452 kB\n"
+        "VmStk:\t    8192 kB\n"
+        "VmExe:\t      12 kB\n"
+        "VmLib:\t  256964 kB\n"
+        "VmPTE:\t    6504 kB\n"
+        "VmSwap:\t       0 kB\n"
+        "CoreDumping:\t0\n"
+        "THP_enabled:\t1\n"
+        "Threads:\t143\n"
+        "SigQ:\t0/44731\n"
+        "SigPnd:\t0000000000000000\n"
+        "ShdPnd:\t0000000000000000\n"
+        "SigBlk:\t0000000080001204\n"
+        "SigIgn:\t0000000000000001\n"
+        "SigCgt:\t0000006e400084f8\n"
+        "CapInh:\t0000000000000000\n"
+        "CapPrm:\t0000000000000000\n"
+        "CapEff:\t0000000000000000\n"
+        "CapBnd:\t0000000000000000\n"
+        "CapAmb:\t0000000000000000\n"
+        "NoNewPrivs:\t0\n"
+        "Seccomp:\t2\n"
+        "Seccomp_filters:\t1\n"
+        "Speculation_Store_Bypass:\tthread vulnerable\n"
+        "Cpus_allowed:\tff\n"
+        "Cpus_allowed_list:\t0-7\n"
+        "Mems_allowed:\t1\n"
+        "Mems_allowed_list:\t0\n"
+        "voluntary_ctxt_switches:\t5107\n"
+        "nonvoluntary_ctxt_switches:\t2630\n",
+        0,
+        "Qualcomm Technologies, Inc SM8350",
+        6,
+        4,
+        17,
+        39,
+        15,
+        11631668,
+        4194300,
+        1288204,
+    };
+}
+
+// Android Go device with a 32-bit kernel on a quad Cortex-A53 MT6739. The
+// /proc/cpuinfo format of arm differs from arm64, and /proc/meminfo has the
+// HighTotal and LowTotal lines of highmem kernels.
+DeviceSnapshot GoDeviceArm32() {
+    std::string cpuinfo;
+    for (int i = 0; i < 4; ++i) {
+        cpuinfo += "processor\t: " + std::to_string(i) +
+                   "\n"
+                   "model name\t: ARMv7 Processor rev 4 (v7l)\n"
+                   "BogoMIPS\t: 26.00\n"
+                   "Features\t: half thumb fastmult vfp edsp neon vfpv3 tls "
+                   "vfpv4 idiva idivt lpae evtstrm aes pmull sha1 sha2 "
+                   "crc32\n"
+                   "CPU implementer\t: 0x41\n"
+                   "CPU architecture: 7\n"
+                   "CPU variant\t: 0x0\n"
+                   "CPU part\t: 0xd03\n"
+                   "CPU revision\t: 4\n\n";
+    }
+    cpuinfo +=
+        "Hardware\t: MT6739WA\n"
+        "Revision\t: 0000\n"
+        "Serial\t\t: 0000000000000000\n";
+    return {
+        "go_device_arm32",
+        "0-3",
+        "0-3",
+        7,
+        {1500000, 1500000, 1500000, 1500000},
+        cpuinfo,
+        "MemTotal:        1916772 kB\n"
+        "MemFree:           43492 kB\n"
+        "MemAvailable:     612104 kB\n"
+        "Buffers:           12228 kB\n"
+        "Cached:           619560 kB\n"
+        "SwapCached:        14148 kB\n"
+        "Active:           621848 kB\n"
+        "Inactive:         575932 kB\n"
+        "Active(anon):     339044 kB\n"
+        "Inactive(anon):   246208 kB\n"
+        "Active(file):     282804 kB\n"
+        "Inactive(file):   329724 kB\n"
+        "Unevictable:       20848 kB\n"
+        "Mlocked:           20848 kB\n"
+        "HighTotal:       1223680 kB\n"
+        "HighFree:          10240 kB\n"
+        "LowTotal:         693092 kB\n"
+        "LowFree:           33252 kB\n"
+        "SwapTotal:        958384 kB\n"
+        "SwapFree:         522816 kB\n"
+        "Dirty:                64 kB\n"
+        "Writeback:             0 kB\n"
+        "AnonPages:        584776 kB\n"
+        "Mapped:           402112 kB\n"
+        "Shmem:              5720 kB\n"
+        "Slab:              95312 kB\n"
+        "SReclaimable:      33040 kB\n"
+        "SUnreclaim:        62272 kB\n"
+        "KernelStack:       23584 kB\n"
+        "PageTables:        35832 kB\n"
+        "NFS_Unstable:          0 kB\n"
+        "Bounce:                0 kB\n"
+        "WritebackTmp:          0 kB\n"
+        "CommitLimit:     1916768 kB\n"
+        "Committed_AS:   47291436 kB\n"
+        "VmallocTotal:     245760 kB\n"
+        "VmallocUsed:           0 kB\n"
+        "VmallocChunk:          0 kB\n"
+        "HugePages_Total:       0\n"
+        "HugePages_Free:        0\n"
+        "HugePages_Rsvd:        0\n"
+        "HugePages_Surp:        0\n"
+        "Hugepagesize:       2048 kB\n",
+        "Name:\tcom.example.game\n"
+        "State:\tS (sleeping)\n"
+        "Tgid:\t3120\n"
+        "Ngid:\t0\n"
+        "Pid:\t3120\n"
+        "PPid:\t410\n"
+        "TracerPid:\t0\n"
+        "Uid:\t10087\t10087\t10087\t10087\n"
+        "Gid:\t10087\t10087\t10087\t10087\n"
+        "FDSize:\t128\n"
+        "Groups:\t3002 3003 9997 50087\n"
+        "VmPeak:\t 1402368 kB\n"
+        "VmSize:\t 1372320 kB\n"
+        "VmLck:\t       0 kB\n"
+        "VmPin:\t       0 kB\n"
+        "VmHWM:\t  268416 kB\n"
+        "VmRSS:\t  241356 kB\n"
+        "VmData:\t  412888 kB\n"
+        "VmStk:\t    8192 kB\n"
+        "VmExe:\t      16 kB\n"
+        "VmLib:\t  104256 kB\n"
+        "VmPTE:\t     636 kB\n"
+        "VmPMD:\t       0 kB\n"
+        "VmSwap:\t   58844 kB\n"
+        "Threads:\t61\n"
+        "SigQ:\t0/7283\n"
+        "SigPnd:\t0000000000000000\n"
+        "ShdPnd:\t0000000000000000\n"
+        "SigBlk:\t0000000000001204\n"
+        "SigIgn:\t0000000000000001\n"
+        "SigCgt:\t00000006400096f8\n"
+        "CapInh:\t0000000000000000\n"
+        "CapPrm:\t0000000000000000\n"
+        "CapEff:\t0000000000000000\n"
+        "CapBnd:\t0000000000000000\n"
+        "CapAmb:\t0000000000000000\n"
+        "Seccomp:\t2\n"
+        "Cpus_allowed:\tf\n"
+        "Cpus_allowed_list:\t0-3\n"
+        "voluntary_ctxt_switches:\t9871\n"
+        "nonvoluntary_ctxt_switches:\t4433\n",
+        905,
+        "MT6739WA",
+        4,
+        4,
+        18,
+        43,
+        13,
+        1916772,
+        958384,
+        241356,
+    };
+}
+
+// x86_64 emulator: no cpufreq, and "flags" instead of "Features".
+DeviceSnapshot EmulatorX86_64() {
+    std::string cpuinfo;
+    for (int i = 0; i < 4; ++i) {
+        cpuinfo += "processor\t: " + std::to_string(i) +
+                   "\n"
+                   "vendor_id\t: GenuineIntel\n"
+                   "cpu family\t: 6\n"
+                   "model\t\t: 85\n"
+                   "model name\t: Intel(R) Xeon(R) CPU @ 2.80GHz\n"
+                   "stepping\t: 7\n"
+                   "cpu MHz\t\t: 2800.000\n"
+                   "cache size\t: 33792 KB\n"
+                   "physical id\t: 0\n"
+                   "siblings\t: 4\n"
+                   "core id\t\t: " +
+                   std::to_string(i) +
+                   "\n"
+                   "cpu cores\t: 4\n"
+                   "fpu\t\t: yes\n"
+                   "flags\t\t: fpu vme de pse tsc msr pae mce cx8 apic sep "
+                   "mtrr pge mca cmov pat pse36 clflush mmx fxsr sse sse2 ss "
+                   "ht syscall nx rdtscp lm constant_tsc rep_good nopl "
+                   "xtopology nonstop_tsc cpuid pni ssse3 cx16 sse4_1 sse4_2 "
+                   "x2apic popcnt aes xsave avx hypervisor lahf_lm\n"
+                   "bogomips\t: 5600.00\n"
+                   "clflush size\t: 64\n"
+                   "address sizes\t: 39 bits physical, 48 bits virtual\n\n";
+    }
+    return {
+        "emulator_x86_64",
+        "0-3",
+        "0-3",
+        63,
+        {0, 0, 0, 0},
+        cpuinfo,
+        "MemTotal:        2020900 kB\n"
+        "MemFree:          280588 kB\n"
+        "MemAvailable:    1089652 kB\n"
+        "Buffers:            5396 kB\n"
+        "Cached:           893960 kB\n"
+        "SwapCached:            0 kB\n"
+        "Active:           488920 kB\n"
+        "Inactive:         931444 kB\n"
+        "Active(anon):       2360 kB\n"
+        "Inactive(anon):   531852 kB\n"
+        "Active(file):     486560 kB\n"
+        "Inactive(file):   399592 kB\n"
+        "Unevictable:       15876 kB\n"
+        "Mlocked:           15876 kB\n"
+        "SwapTotal:        1515672 kB\n"
+        "SwapFree:         1515672 kB\n"
+        "Dirty:               236 kB\n"
+        "Writeback:             0 kB\n"
+        "AnonPages:        537644 kB\n"
+        "Mapped:           572208 kB\n"
+        "Shmem:              4536 kB\n"
+        "KReclaimable:      34340 kB\n"
+        "Slab:              93212 kB\n"
+        "SReclaimable:      34340 kB\n"
+        "SUnreclaim:        58872 kB\n"
+        "KernelStack:       16048 kB\n"
+        "PageTables:        27252 kB\n"
+        "SecPageTables:         0 kB\n"
+        "NFS_Unstable:          0 kB\n"
+        "Bounce:                0 kB\n"
+        "WritebackTmp:          0 kB\n"
+        "CommitLimit:     2526120 kB\n"
+        "Committed_AS:   29404428 kB\n"
+        "VmallocTotal:   34359738367 kB\n"
+        "VmallocUsed:       33956 kB\n"
+        "VmallocChunk:          0 kB\n"
+        "Percpu:             2304 kB\n"
+        "AnonHugePages:         0 kB\n"
+        "ShmemHugePages:        0 kB\n"
+        "ShmemPmdMapped:        0 kB\n"
+        "FileHugePages:         0 kB\n"
+        "FilePmdMapped:         0 kB\n"
+        "HugePages_Total:       0\n"
+        "HugePages_Free:        0\n"
+        "HugePages_Rsvd:        0\n"
+        "HugePages_Surp:        0\n"
+        "Hugepagesize:       2048 kB\n"
+        "Hugetlb:               0 kB\n"
+        "DirectMap4k:      104300 kB\n"
+        "DirectMap2M:     1992704 kB\n",
+        "Name:\tcom.example.game\n"
+        "Umask:\t0077\n"
+        "State:\tS (sleeping)\n"
+        "Tgid:\t4601\n"
+        "Ngid:\t0\n"
+        "Pid:\t4601\n"
+        "PPid:\t352\n"
+        "TracerPid:\t0\n"
+        "Uid:\t10150\t10150\t10150\t10150\n"
+        "Gid:\t10150\t10150\t10150\t10150\n"
+        "FDSize:\t128\n"
+        "Groups:\t3002 3003 9997 20150 50150\n"
+        "VmPeak:\t15244860 kB\n"
+        "VmSize:\t15137720 kB\n"
+        "VmLck:\t       0 kB\n"
+        "VmPin:\t       0 kB\n"
+        "VmHWM:\t  364228 kB\n"
+        "VmRSS:\t  352016 kB\n"
+        "RssAnon:\t  148828 kB\n"
+        "RssFile:\t  200740 kB\n"
+        "RssShmem:\t    2448 kB\n"
+        "VmData:\t  781972 kB\n"
+        "VmStk:\t    8192 kB\n"
+        "VmExe:\t      12 kB\n"
+        "VmLib:\t  177052 kB\n"
+        "VmPTE:\t    1956 kB\n"
+        "VmSwap:\t       0 kB\n"
+        "CoreDumping:\t0\n"
+        "THP_enabled:\t1\n"
+        "Threads:\t54\n"
+        "SigQ:\t0/7689\n"
+        "SigPnd:\t0000000000000000\n"
+        "ShdPnd:\t0000000000000000\n"
+        "SigBlk:\t0000000080001204\n"
+        "SigIgn:\t0000000000000001\n"
+        "SigCgt:\t0000006e400084f8\n"
+        "CapInh:\t0000000000000000\n"
+        "CapPrm:\t0000000000000000\n"
+        "CapEff:\t0000000000000000\n"
+        "CapBnd:\t0000000000000000\n"
+        "CapAmb:\t0000000000000000\n"
+        "NoNewPrivs:\t0\n"
+        "Seccomp:\t2\n"
+        "Seccomp_filters:\t1\n"
+        "Speculation_Store_Bypass:\tthread vulnerable\n"
+        "Cpus_allowed:\tf\n"
+        "Cpus_allowed_list:\t0-3\n"
+        "Mems_allowed:\t1\n"
+        "Mems_allowed_list:\t0\n"
+        "voluntary_ctxt_switches:\t733\n"
+        "nonvoluntary_ctxt_switches:\t211\n",
+        1,
+        "",
+        4,
+        4,
+        0,
+        50,
+        15,
+        2020900,
+        1515672,
+        352016,
+    };
+}
+
+}  // namespace
+
+const std::vector<DeviceSnapshot>& DeviceSnapshots() {
+    static const std::vector<DeviceSnapshot> snapshots = {
+        Pixel6(), GalaxyS10(), Snapdragon888WithOfflineCores(),
+        GoDeviceArm32(), EmulatorX86_64()};
+    return snapshots;
+}
+
+ScopedDeviceSnapshot::ScopedDeviceSnapshot(const DeviceSnapshot& snapshot,
+                                           pid_t pid) {
+    std::vector<char> dir(kSnapshotTemplate,
+                          kSnapshotTemplate + sizeof(kSnapshotTemplate));
+    EXPECT_NE(mkdtemp(dir.data()), nullptr);
+    root_ = dir.data();
+
+    const std::string cpu = "/sys/devices/system/cpu/";
+    Write(cpu + "present", std::string(snapshot.cpu_present) + "\n");
+    Write(cpu + "possible", std::string(snapshot.cpu_possible) + "\n");
+    Write(cpu + "kernel_max", std::to_string(snapshot.kernel_max) + "\n");
+    for (size_t i = 0; i < snapshot.max_freqs.size(); ++i) {
+        std::string dir = cpu + "cpu" + std::to_string(i) + "/";
+        Write(dir + "topology/physical_package_id", "0\n");
+        if (snapshot.max_freqs[i] != 0) {
+            Write(dir + "cpufreq/cpuinfo_max_freq",
+                  std::to_string(snapshot.max_freqs[i]) + "\n");
+        }
+    }
+
+    Write("/proc/cpuinfo", snapshot.cpuinfo);
+    Write("/proc/meminfo", snapshot.meminfo);
+    const std::string proc = "/proc/" + std::to_string(pid) + "/";
+    Write(proc + "status", snapshot.status);
+    Write(proc + "oom_score", std::to_string(snapshot.oom_score) + "\n");
+
+    EXPECT_TRUE(gamesdk::procfs::SetRoot(root_.c_str()));
+}
+
+ScopedDeviceSnapshot::~ScopedDeviceSnapshot() {
+    gamesdk::procfs::SetRoot(nullptr);
+    nftw(root_.c_str(), RemoveEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+void ScopedDeviceSnapshot::Write(const std::string& path,
+                                 const std::string& contents) {
+    std::string full_path = root_ + path;
+    for (size_t i = root_.size() + 1; i < full_path.size(); ++i) {
+        if (full_path[i] == '/') mkdir(full_path.substr(0, i).c_str(), 0770);
+    }
+    FILE* f = fopen(full_path.c_str(), "w");
+    ASSERT_NE(f, nullptr) << full_path;
+    fwrite(contents.data(), 1, contents.size(), f);
+    fclose(f);
+}
+
+}  // namespace gamesdk_test
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Snapshots of the /proc and /sys files read through gamesdk::procfs, taken
+// from different kinds of devices, with the values a reader should find in
+// them. Each library's tests run its own readers against all of them.
+
+namespace gamesdk_test {
+
+struct DeviceSnapshot {
+    const char* name;
+
+    // /sys/devices/system/cpu
+    const char* cpu_present;
+    const char* cpu_possible;
+    int kernel_max;
+    // cpuN/cpufreq/cpuinfo_max_freq of each possible CPU, 0 if the file is
+    // missing.
+    std::vector<int64_t> max_freqs;
+
+    std::string cpuinfo;
+    std::string meminfo;
+    // /proc/<pid>/status and /proc/<pid>/oom_score of the game.
+    std::string status;
+    int64_t oom_score;
+
+    // What the files hold.
+    // The value of the "Hardware" line of /proc/cpuinfo, or "" if none.
+    const char* hardware;
+    // Number of "processor" entries of /proc/cpuinfo, which are the online
+    // CPUs.
+    int num_processors;
+    // Number of these at the lowest maximum frequency.
+    int num_little_cores;
+    // Number of distinct words of the "Features" lines.
+    size_t num_cpu_extensions;
+    // Number of /proc/meminfo lines with a number, in kB or not.
+    size_t num_meminfo_numbers;
+    // Number of /proc/<pid>/status lines with a number in kB.
+    size_t num_status_kb_fields;
+    int64_t mem_total_kb;
+    int64_t swap_total_kb;
+    int64_t vm_rss_kb;
+};
+
+const std::vector<DeviceSnapshot>& DeviceSnapshots();
+
+// Writes a snapshot to a new temporary directory and makes it the procfs
+// root while the object lives, removing it after. The status and oom_score
+// files are written for pid.
+class ScopedDeviceSnapshot {
+   public:
+    ScopedDeviceSnapshot(const DeviceSnapshot& snapshot, pid_t pid);
+    ~ScopedDeviceSnapshot();
+
+    ScopedDeviceSnapshot(const ScopedDeviceSnapshot&) = delete;
+    ScopedDeviceSnapshot& operator=(const ScopedDeviceSnapshot&) = delete;
+
+   private:
+    void Write(const std::string& path, const std::string& contents);
+
+    std::string root_;
+};
+
+}  // namespace gamesdk_test
@@ -0,0 +1,269 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cpu_info.h"
+
+#include <ftw.h>
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "device_snapshots.h"
+#include "procfs.h"
+
+using namespace androidgamesdk_deviceinfo;
+using namespace gamesdk_test;
+namespace procfs = gamesdk::procfs;
+
+namespace {
+
+#ifdef __ANDROID__
+constexpr char kTreeTemplate[] = "/data/local/tmp/device_info_test_XXXXXX";
+#else
+constexpr char kTreeTemplate[] = "/tmp/device_info_test_XXXXXX";
+#endif
+
+// A fake /proc and /sys tree in a new temporary directory, used as the
+// procfs root while the object lives.
+class FakeTree {
+   public:
+    FakeTree() {
+        std::vector<char> dir(kTreeTemplate,
+                              kTreeTemplate + sizeof(kTreeTemplate));
+        EXPECT_NE(mkdtemp(dir.data()), nullptr);
+        root_ = dir.data();
+        EXPECT_TRUE(procfs::SetRoot(root_.c_str()));
+    }
+    ~FakeTree() {
+        procfs::SetRoot(nullptr);
+        nftw(root_.c_str(), RemoveEntry, 16, FTW_DEPTH | FTW_PHYS);
+    }
+
+    // Writes a file of the tree, creating the directories on the way.
+    void Write(const std::string& path, const std::string& contents) {
+        std::string full_path = root_ + path;
+        for (size_t i = root_.size() + 1; i < full_path.size(); ++i) {
+            if (full_path[i] == '/')
+                mkdir(full_path.substr(0, i).c_str(), 0770);
+        }
+        FILE* f = fopen(full_path.c_str(), "w");
+        ASSERT_NE(f, nullptr) << full_path;
+        fwrite(contents.data(), 1, contents.size(), f);
+        fclose(f);
+    }
+
+    void WriteCpuFreq(int cpu, const std::string& khz) {
+        Write("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                  "/cpufreq/cpuinfo_max_freq",
+              khz + "\n");
+    }
+
+   private:
+    static int RemoveEntry(const char* path, const struct stat*, int,
+                           struct FTW*) {
+        return remove(path);
+    }
+
+    std::string root_;
+};
+
+std::vector<std::string> ToVector(const ProtoDataHolder::StringVector& v) {
+    std::vector<std::string> result;
+    for (size_t i = 0; i < v.size; ++i) result.push_back(v.data[i].data.get());
+    return result;
+}
+
+std::vector<int64_t> ToVector(const ProtoDataHolder::Array<int64_t>& a) {
+    return std::vector<int64_t>(a.data.get(), a.data.get() + a.size);
+}
+
+constexpr char kArm64CpuInfo[] =
+    "processor\t: 0\n"
+    "BogoMIPS\t: 52.00\n"
+    "Features\t: fp asimd evtstrm aes pmull sha1 sha2 crc32\n"
+    "CPU implementer\t: 0x41\n"
+    "CPU part\t: 0xd05\n"
+    "\n"
+    "processor\t: 1\n"
+    "BogoMIPS\t: 52.00\n"
+    "Features\t: fp asimd evtstrm aes pmull sha1 sha2 crc32\n"
+    "CPU implementer\t: 0x41\n"
+    "CPU part\t: 0xd05\n"
+    "\n"
+    "processor\t: 2\n"
+    "BogoMIPS\t: 52.00\n"
+    "Features\t: fp asimd evtstrm aes pmull sha1 sha2 crc32 atomics\n"
+    "CPU implementer\t: 0x41\n"
+    "CPU part\t: 0xd41\n"
+    "\n"
+    "Hardware\t: Qualcomm Technologies, Inc SM8150\n";
+
+TEST(CpuInfoTest, ReadsFakeTree) {
+    FakeTree tree;
+    tree.Write("/sys/devices/system/cpu/present", "0-2\n");
+    tree.Write("/sys/devices/system/cpu/possible", "0-2\n");
+    tree.Write("/sys/devices/system/cpu/kernel_max", "7\n");
+    tree.WriteCpuFreq(0, "1785600");
+    tree.WriteCpuFreq(1, "1785600");
+    tree.WriteCpuFreq(2, "2841600");
+    tree.Write("/proc/cpuinfo", kArm64CpuInfo);
+
+    ProtoDataHolder data;
+    ProtoDataHolder::StringVector errors;
+    EXPECT_EQ(readCpuInfo(data, errors), 0);
+    EXPECT_EQ(errors.size, 0u);
+
+    EXPECT_STREQ(data.cpu_present.data.get(), "0-2");
+    EXPECT_STREQ(data.cpu_possible.data.get(), "0-2");
+    EXPECT_EQ(data.cpuIndexMax, 7);
+    // CPUs up to kernel_max that are not possible are left to 0.
+    std::vector<int64_t> freqs = {1785600, 1785600, 2841600, 0, 0, 0, 0, 0};
+    EXPECT_EQ(ToVector(data.cpuFreqs), freqs);
+    std::vector<std::string> hardware = {"Qualcomm Technologies, Inc SM8150"};
+    EXPECT_EQ(ToVector(data.hardware), hardware);
+    // Each feature is listed once, whatever the number of cores with it.
+    std::vector<std::string> extensions = {
+        "fp", "asimd", "evtstrm", "aes", "pmull", "sha1", "sha2", "crc32",
+        "atomics"};
+    EXPECT_EQ(ToVector(data.cpu_extension), extensions);
+}
+
+TEST(CpuInfoTest, ReadsOnlyPossibleCpus) {
+    FakeTree tree;
+    tree.Write("/sys/devices/system/cpu/present", "0-1,4\n");
+    tree.Write("/sys/devices/system/cpu/possible", "0-1,4\n");
+    tree.Write("/sys/devices/system/cpu/kernel_max", "5\n");
+    tree.WriteCpuFreq(0, "1000000");
+    tree.WriteCpuFreq(1, "1000000");
+    // Not possible, so never read.
+    tree.WriteCpuFreq(2, "1500000");
+    tree.WriteCpuFreq(4, "2000000");
+    tree.Write("/proc/cpuinfo", kArm64CpuInfo);
+
+    ProtoDataHolder data;
+    ProtoDataHolder::StringVector errors;
+    EXPECT_EQ(readCpuInfo(data, errors), 0);
+    std::vector<int64_t> freqs = {1000000, 1000000, 0, 0, 2000000, 0};
+    EXPECT_EQ(ToVector(data.cpuFreqs), freqs);
+}
+
+TEST(CpuInfoTest, MissingCpuFreqIsNotAnError) {
+    FakeTree tree;
+    tree.Write("/sys/devices/system/cpu/present", "0-3\n");
+    tree.Write("/sys/devices/system/cpu/possible", "0-3\n");
+    tree.Write("/sys/devices/system/cpu/kernel_max", "3\n");
+    tree.WriteCpuFreq(0, "1800000");
+    tree.WriteCpuFreq(1, "1800000");
+    // cpufreq of an offline CPU may be missing; cpu3 has no number at all.
+    tree.Write("/sys/devices/system/cpu/cpu3/cpufreq/cpuinfo_max_freq", "\n");
+    // An x86 emulator has no Hardware or Features lines.
+    tree.Write("/proc/cpuinfo",
+               "processor\t: 0\nvendor_id\t: GenuineIntel\n"
+               "flags\t\t: fpu vme de pse\n");
+
+    ProtoDataHolder data;
+    ProtoDataHolder::StringVector errors;
+    EXPECT_EQ(readCpuInfo(data, errors), 0);
+    EXPECT_EQ(errors.size, 0u);
+    std::vector<int64_t> freqs = {1800000, 1800000, 0, 0};
+    EXPECT_EQ(ToVector(data.cpuFreqs), freqs);
+    EXPECT_EQ(data.hardware.size, 0u);
+    EXPECT_EQ(data.cpu_extension.size, 0u);
+}
+
+TEST(CpuInfoTest, MissingFiles) {
+    FakeTree tree;
+
+    ProtoDataHolder data;
+    ProtoDataHolder::StringVector errors;
+    // A missing /proc/cpuinfo counts for both Hardware and Features.
+    EXPECT_EQ(readCpuInfo(data, errors), 5);
+    std::vector<std::string> expected = {
+        "Cpu present: Could not read file.",
+        "Cpu possible: Could not read file.",
+        "Cpu index max: Could not read file.",
+        "Hardware: Could not read file.",
+        "Features: Could not read file.",
+    };
+    EXPECT_EQ(ToVector(errors), expected);
+    EXPECT_EQ(data.cpu_present.data, nullptr);
+    EXPECT_EQ(data.cpu_possible.data, nullptr);
+    EXPECT_EQ(data.cpuFreqs.size, 0u);
+    EXPECT_EQ(data.hardware.size, 0u);
+}
+
+TEST(CpuInfoTest, MissingPossibleReadsUpToKernelMax) {
+    FakeTree tree;
+    tree.Write("/sys/devices/system/cpu/present", "0-1\n");
+    tree.Write("/sys/devices/system/cpu/kernel_max", "2\n");
+    tree.WriteCpuFreq(0, "1200000");
+    tree.WriteCpuFreq(2, "2400000");
+    tree.Write("/proc/cpuinfo", kArm64CpuInfo);
+
+    ProtoDataHolder data;
+    ProtoDataHolder::StringVector errors;
+    EXPECT_EQ(readCpuInfo(data, errors), 1);
+    std::vector<std::string> expected = {"Cpu possible: Could not read file."};
+    EXPECT_EQ(ToVector(errors), expected);
+    std::vector<int64_t> freqs = {1200000, 0, 2400000};
+    EXPECT_EQ(ToVector(data.cpuFreqs), freqs);
+}
+
+TEST(CpuInfoTest, BadKernelMax) {
+    FakeTree tree;
+    tree.Write("/sys/devices/system/cpu/present", "0\n");
+    tree.Write("/sys/devices/system/cpu/possible", "0\n");
+    tree.Write("/sys/devices/system/cpu/kernel_max", "-1\n");
+    tree.Write("/proc/cpuinfo", kArm64CpuInfo);
+
+    ProtoDataHolder data;
+    ProtoDataHolder::StringVector errors;
+    EXPECT_EQ(readCpuInfo(data, errors), 1);
+    std::vector<std::string> expected = {"Cpu index max: Could not read file."};
+    EXPECT_EQ(ToVector(errors), expected);
+    EXPECT_EQ(data.cpuFreqs.size, 0u);
+}
+
+TEST(CpuInfoTest, DeviceSnapshots) {
+    for (const DeviceSnapshot& snapshot : DeviceSnapshots()) {
+        SCOPED_TRACE(snapshot.name);
+        ScopedDeviceSnapshot root(snapshot, getpid());
+
+        ProtoDataHolder data;
+        ProtoDataHolder::StringVector errors;
+        EXPECT_EQ(readCpuInfo(data, errors), 0);
+        EXPECT_EQ(errors.size, 0u);
+
+        EXPECT_STREQ(data.cpu_present.data.get(), snapshot.cpu_present);
+        EXPECT_STREQ(data.cpu_possible.data.get(), snapshot.cpu_possible);
+        EXPECT_EQ(data.cpuIndexMax, snapshot.kernel_max);
+        std::vector<int64_t> freqs = snapshot.max_freqs;
+        freqs.resize(snapshot.kernel_max + 1, 0);
+        EXPECT_EQ(ToVector(data.cpuFreqs), freqs);
+        std::vector<std::string> hardware;
+        if (*snapshot.hardware != '\0') hardware.push_back(snapshot.hardware);
+        EXPECT_EQ(ToVector(data.hardware), hardware);
+        EXPECT_EQ(data.cpu_extension.size, snapshot.num_cpu_extensions);
+    }
+}
+
+}  // namespace
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Property tests of the GameTextInput gap buffer: random edits, in UTF-16
+// ranges, are checked against the same edits on a vector of code points. Long
+// texts exercise the offset index. Edits are applied either with replace or,
+// as GameTextInput does with the deltas of the IME, with applyDelta along with
+// random spans.
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "game-text-input/gametextdocument.h"
+#include "gtest/gtest.h"
+#include "reference_utf.h"
+
+using reference_utf::Text;
+
+namespace document_test {
+
+void expectSameText(GameTextDocument& document, const Text& text) {
+    ASSERT_EQ(document.length(), static_cast<int32_t>(text.utf8.size()));
+    ASSERT_EQ(document.utf16Length(), static_cast<int32_t>(text.utf16.size()));
+    ASSERT_EQ(std::string(document.text()), text.utf8.c_str());
+}
+
+// Checks byteOffset at random code units, including the middle of surrogate
+// pairs, which are converted to the end of the character.
+void expectByteOffsets(GameTextDocument& document, const Text& text,
+                       std::mt19937* rng) {
+    for (int k = 0; k < 8; ++k) {
+        size_t c = (*rng)() % text.bytes.size();
+        ASSERT_EQ(document.byteOffset(text.units[c]), text.bytes[c]);
+        if (c + 1 < text.units.size() &&
+            text.units[c + 1] - text.units[c] == 2) {
+            ASSERT_EQ(document.byteOffset(text.units[c] + 1),
+                      text.bytes[c + 1]);
+        }
+    }
+    ASSERT_EQ(document.byteOffset(text.units.back() + 5), text.bytes.back());
+}
+
+// The byte offset applyDelta converts a UTF-16 offset to.
+int32_t expectedByteOffset(const Text& text, int32_t unitIndex) {
+    if (unitIndex < 0) return unitIndex;
+    auto next = std::lower_bound(text.units.begin(), text.units.end(),
+                                 unitIndex);
+    if (next == text.units.end()) return text.bytes.back();
+    return text.bytes[next - text.units.begin()];
+}
+
+void runRandomEdits(uint32_t seed, int32_t initialLength, int32_t maxInsert,
+                    int edits, bool asDeltas = false) {
+    std::mt19937 rng(seed);
+    const uint32_t capacity = initialLength * 4 + maxInsert * 4 * 4;
+    GameTextDocument document(capacity);
+    std::vector<uint32_t> codePoints =
+        reference_utf::randomCodePoints(&rng, initialLength);
+    Text text = reference_utf::encode(codePoints);
+    document.setText(text.utf8.data(), static_cast<int32_t>(text.utf8.size()));
+    expectSameText(document, text);
+
+    for (int i = 0; i < edits; ++i) {
+        size_t count = codePoints.size() + 1;
+        // Mostly edits close to each other, like typing at a cursor.
+        size_t start = rng() % 4 ? (rng() % count) : count - 1;
+        if (i > 0 && rng() % 2) start = std::min(start, rng() % count);
+        size_t end = std::min(count - 1, start + rng() % 4);
+        std::vector<uint32_t> inserted =
+            reference_utf::randomCodePoints(&rng, rng() % (maxInsert + 1));
+        std::string insertedUtf8 = reference_utf::encode(inserted).utf8;
+
+        bool fits = text.utf8.size() - (text.bytes[end] - text.bytes[start]) +
+                        insertedUtf8.size() <=
+                    capacity;
+        // Spans anywhere in the new text, unset, in the middle of surrogate
+        // pairs or past the end.
+        int32_t spans[4];
+        int32_t maxUnits = text.units.back() + static_cast<int32_t>(
+                                                   inserted.size() * 2 + 2);
+        for (int32_t& span : spans) {
+            span = static_cast<int32_t>(rng() % (maxUnits + 2)) - 1;
+        }
+        int32_t originalSpans[4];
+        std::copy(spans, spans + 4, originalSpans);
+        bool applied =
+            asDeltas
+                ? document.applyDelta(
+                      text.units[start], text.units[end], insertedUtf8.data(),
+                      static_cast<int32_t>(insertedUtf8.size()), spans, 4)
+                : document.replace(text.units[start], text.units[end],
+                                   insertedUtf8.data(),
+                                   static_cast<int32_t>(insertedUtf8.size()));
+        ASSERT_EQ(applied, fits) << "edit " << i;
+        if (fits) {
+            codePoints.erase(codePoints.begin() + start,
+                             codePoints.begin() + end);
+            codePoints.insert(codePoints.begin() + start, inserted.begin(),
+                              inserted.end());
+            text = reference_utf::encode(codePoints);
+        }
+        if (asDeltas) {
+            for (int k = 0; k < 4; ++k) {
+                ASSERT_EQ(spans[k],
+                          fits ? expectedByteOffset(text, originalSpans[k])
+                               : originalSpans[k])
+                    << "edit " << i << ", span " << originalSpans[k];
+            }
+        }
+        // Reading the text moves the gap to the end, so only do it sometimes.
+        if (rng() % 8 == 0) expectSameText(document, text);
+        expectByteOffsets(document, text, &rng);
+    }
+    expectSameText(document, text);
+}
+
+TEST(GameTextDocument, ShortTextMatchesReference) {
+    for (uint32_t seed = 0; seed < 50; ++seed) {
+        runRandomEdits(seed, seed % 40, 8, 200);
+    }
+}
+
+TEST(GameTextDocument, LongTextMatchesReference) {
+    // Long enough, in bytes, for offsets to be found through the index.
+    for (uint32_t seed = 100; seed < 103; ++seed) {
+        runRandomEdits(seed, 6000, 16, 500);
+    }
+}
+
+TEST(GameTextDocument, ShortTextDeltasMatchReference) {
+    for (uint32_t seed = 200; seed < 250; ++seed) {
+        runRandomEdits(seed, seed % 40, 8, 200, true);
+    }
+}
+
+TEST(GameTextDocument, LongTextDeltasMatchReference) {
+    for (uint32_t seed = 300; seed < 303; ++seed) {
+        runRandomEdits(seed, 6000, 16, 500, true);
+    }
+}
+
+TEST(GameTextDocument, DeltaWithoutText) {
+    GameTextDocument document(16);
+    document.setText("abcdef", 6);
+    int32_t spans[] = {1, 1, -1, -1};
+    EXPECT_TRUE(document.applyDelta(1, 3, nullptr, 0, spans, 4));
+    EXPECT_STREQ(document.text(), "adef");
+    EXPECT_EQ(spans[0], 1);
+    EXPECT_EQ(spans[2], -1);
+    // A null text in an empty document.
+    document.setText(nullptr, 0);
+    EXPECT_TRUE(document.applyDelta(0, 0, nullptr, 0, nullptr, 0));
+    EXPECT_EQ(document.length(), 0);
+}
+
+TEST(GameTextDocument, RejectedDeltaKeepsSpans) {
+    GameTextDocument document(4);
+    document.setText("abc", 3);
+    int32_t spans[] = {2, 3, 0, 2};
+    EXPECT_FALSE(document.applyDelta(1, 2, "xyz", 3, spans, 4));
+    EXPECT_FALSE(document.applyDelta(2, 5, "", 0, spans, 4));
+    EXPECT_EQ(spans[0], 2);
+    EXPECT_EQ(spans[1], 3);
+    EXPECT_EQ(spans[2], 0);
+    EXPECT_EQ(spans[3], 2);
+    EXPECT_STREQ(document.text(), "abc");
+}
+
+TEST(GameTextDocument, RejectsRangesInsideCharacters) {
+    Text text = reference_utf::encode({'a', 0x1F600, 'b'});
+    GameTextDocument document(64);
+    document.setText(text.utf8.data(), static_cast<int32_t>(text.utf8.size()));
+    EXPECT_FALSE(document.replace(2, 3, "x", 1));
+    EXPECT_FALSE(document.replace(1, 2, "x", 1));
+    EXPECT_FALSE(document.replace(0, 5, "x", 1));
+    expectSameText(document, text);
+    EXPECT_TRUE(document.replace(1, 3, "x", 1));
+    EXPECT_STREQ(document.text(), "axb");
+}
+
+TEST(GameTextDocument, TruncatesTextToCapacity) {
+    GameTextDocument document(4);
+    document.setText("abcdef", 6);
+    EXPECT_STREQ(document.text(), "abcd");
+    EXPECT_EQ(document.utf16Length(), 4);
+    EXPECT_FALSE(document.replace(4, 4, "e", 1));
+}
+
+}  // namespace document_test
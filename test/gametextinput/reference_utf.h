@@ -0,0 +1,123 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// A straightforward encoder of code points, used as the reference of the
+// property tests, and a generator of random text covering all the planes.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace reference_utf {
+
+inline void appendUtf8(uint32_t c, std::string* out) {
+    if (c < 0x80) {
+        out->push_back(static_cast<char>(c));
+    } else if (c < 0x800) {
+        out->push_back(static_cast<char>(0xC0 | (c >> 6)));
+        out->push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    } else if (c < 0x10000) {
+        out->push_back(static_cast<char>(0xE0 | (c >> 12)));
+        out->push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    } else {
+        out->push_back(static_cast<char>(0xF0 | (c >> 18)));
+        out->push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+        out->push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    }
+}
+
+inline void appendUtf16(uint32_t c, std::u16string* out) {
+    if (c < 0x10000) {
+        out->push_back(static_cast<char16_t>(c));
+    } else {
+        out->push_back(static_cast<char16_t>(0xD800 + ((c - 0x10000) >> 10)));
+        out->push_back(static_cast<char16_t>(0xDC00 + ((c - 0x10000) & 0x3FF)));
+    }
+}
+
+// Text as code points, with the offset of each character boundary in both
+// encodings: character i starts at bytes[i] and units[i].
+struct Text {
+    std::vector<uint32_t> codePoints;
+    std::string utf8;
+    std::u16string utf16;
+    std::vector<int32_t> bytes;
+    std::vector<int32_t> units;
+};
+
+inline Text encode(const std::vector<uint32_t>& codePoints) {
+    Text text;
+    text.codePoints = codePoints;
+    for (uint32_t c : codePoints) {
+        text.bytes.push_back(static_cast<int32_t>(text.utf8.size()));
+        text.units.push_back(static_cast<int32_t>(text.utf16.size()));
+        appendUtf8(c, &text.utf8);
+        appendUtf16(c, &text.utf16);
+    }
+    text.bytes.push_back(static_cast<int32_t>(text.utf8.size()));
+    text.units.push_back(static_cast<int32_t>(text.utf16.size()));
+    return text;
+}
+
+// A random scalar value, from any plane and encoding length, biased towards
+// the limits of each encoding length.
+inline uint32_t randomCodePoint(std::mt19937* rng) {
+    static const uint32_t kEdges[] = {0x0,    0x7F,   0x80,    0x7FF,
+                                      0x800,  0xD7FF, 0xE000,  0xFFFD,
+                                      0xFFFF, 0x10000, 0x10FFFF};
+    switch ((*rng)() % 6) {
+        case 0:
+            return kEdges[(*rng)() % (sizeof(kEdges) / sizeof(kEdges[0]))];
+        case 1:
+            return 0x80 + (*rng)() % (0x800 - 0x80);
+        case 2: {
+            // Basic Multilingual Plane, without the surrogates.
+            uint32_t c = 0x800 + (*rng)() % (0x10000 - 0x800 - 0x800);
+            return c < 0xD800 ? c : c + 0x800;
+        }
+        case 3:
+            // Supplementary planes 1 to 16.
+            return 0x10000 + (*rng)() % (0x110000 - 0x10000);
+        default:
+            return (*rng)() % 0x80;
+    }
+}
+
+// Random text, with runs of ASCII long enough for the fast paths.
+inline std::vector<uint32_t> randomCodePoints(std::mt19937* rng,
+                                              int32_t length) {
+    std::vector<uint32_t> codePoints;
+    while (static_cast<int32_t>(codePoints.size()) < length) {
+        if ((*rng)() % 4 == 0) {
+            int32_t run = (*rng)() % 40;
+            for (int32_t i = 0; i < run; ++i) {
+                codePoints.push_back(' ' + (*rng)() % 95);
+            }
+        } else {
+            codePoints.push_back(randomCodePoint(rng));
+        }
+    }
+    codePoints.resize(length);
+    return codePoints;
+}
+
+}  // namespace reference_utf
@@ -0,0 +1,193 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Property tests of the UTF-16 / UTF-8 conversions of GameTextInput against
+// the reference encoder, on random text from all the Unicode planes.
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "game-text-input/gametextutf.h"
+#include "gtest/gtest.h"
+#include "reference_utf.h"
+
+using namespace gametextutf;
+using reference_utf::Text;
+
+namespace utf_test {
+
+constexpr int kIterations = 2000;
+
+std::string toUtf8(const std::u16string& in, int32_t* offsets = nullptr,
+                   int32_t offsetCount = 0) {
+    std::string out(in.size() * kMaxUtf8BytesPerUtf16Unit, '\0');
+    int32_t length = utf16ToUtf8(reinterpret_cast<const uint16_t*>(in.data()),
+                                 static_cast<int32_t>(in.size()), &out[0],
+                                 static_cast<int32_t>(out.size()), offsets,
+                                 offsetCount);
+    out.resize(length);
+    return out;
+}
+
+std::u16string toUtf16(const std::string& in, int32_t* offsets = nullptr,
+                       int32_t offsetCount = 0) {
+    std::u16string out(in.size(), u'\0');
+    int32_t length =
+        utf8ToUtf16(in.data(), static_cast<int32_t>(in.size()),
+                    reinterpret_cast<uint16_t*>(&out[0]), offsets, offsetCount);
+    out.resize(length);
+    return out;
+}
+
+TEST(GameTextUtf, RoundTripsRandomText) {
+    std::mt19937 rng(1);
+    for (int i = 0; i < kIterations; ++i) {
+        Text text = reference_utf::encode(
+            reference_utf::randomCodePoints(&rng, i % 300));
+        ASSERT_EQ(toUtf8(text.utf16), text.utf8) << "iteration " << i;
+        ASSERT_EQ(toUtf16(text.utf8), text.utf16) << "iteration " << i;
+    }
+}
+
+TEST(GameTextUtf, ConvertsEveryScalarValue) {
+    for (uint32_t c = 0; c < 0x110000; ++c) {
+        if (c >= 0xD800 && c <= 0xDFFF) continue;
+        Text text = reference_utf::encode({c});
+        ASSERT_EQ(toUtf8(text.utf16), text.utf8) << std::hex << c;
+        ASSERT_EQ(toUtf16(text.utf8), text.utf16) << std::hex << c;
+    }
+}
+
+TEST(GameTextUtf, ConvertsOffsetsAtCharacterBoundaries) {
+    std::mt19937 rng(2);
+    for (int i = 0; i < kIterations; ++i) {
+        Text text = reference_utf::encode(
+            reference_utf::randomCodePoints(&rng, i % 300));
+        int32_t count = static_cast<int32_t>(text.codePoints.size()) + 1;
+        // Unsorted offsets, with duplicates and an undefined one.
+        std::vector<int32_t> chars;
+        for (int k = 0; k < 6; ++k) chars.push_back(rng() % count);
+        int32_t units[7], bytes[7];
+        for (int k = 0; k < 6; ++k) {
+            units[k] = text.units[chars[k]];
+            bytes[k] = text.bytes[chars[k]];
+        }
+        units[6] = bytes[6] = -1;
+
+        toUtf8(text.utf16, units, 7);
+        toUtf16(text.utf8, bytes, 7);
+        for (int k = 0; k < 6; ++k) {
+            ASSERT_EQ(units[k], text.bytes[chars[k]]) << "iteration " << i;
+            ASSERT_EQ(bytes[k], text.units[chars[k]]) << "iteration " << i;
+        }
+        ASSERT_EQ(units[6], -1);
+        ASSERT_EQ(bytes[6], -1);
+    }
+}
+
+TEST(GameTextUtf, ConvertsOffsetsInsideCharactersToTheirEnd) {
+    std::mt19937 rng(3);
+    for (int i = 0; i < kIterations; ++i) {
+        Text text =
+            reference_utf::encode(reference_utf::randomCodePoints(&rng, 50));
+        for (size_t k = 0; k < text.codePoints.size(); ++k) {
+            int32_t units = text.units[k + 1] - text.units[k];
+            int32_t bytes = text.bytes[k + 1] - text.bytes[k];
+            if (units == 2) {
+                int32_t offset = text.units[k] + 1;
+                toUtf8(text.utf16, &offset, 1);
+                ASSERT_EQ(offset, text.bytes[k + 1]);
+            }
+            for (int32_t b = 1; b < bytes; ++b) {
+                int32_t offset = text.bytes[k] + b;
+                toUtf16(text.utf8, &offset, 1);
+                ASSERT_EQ(offset, text.units[k + 1]);
+            }
+        }
+    }
+}
+
+TEST(GameTextUtf, ConvertsOffsetsPastTheEndToTheEnd) {
+    Text text = reference_utf::encode({'a', 0x10400, 0xE9});
+    int32_t offset = 100;
+    toUtf8(text.utf16, &offset, 1);
+    EXPECT_EQ(offset, static_cast<int32_t>(text.utf8.size()));
+    offset = 100;
+    toUtf16(text.utf8, &offset, 1);
+    EXPECT_EQ(offset, static_cast<int32_t>(text.utf16.size()));
+}
+
+TEST(GameTextUtf, ReplacesUnpairedSurrogates) {
+    EXPECT_EQ(toUtf8(u"a\xD800"), "a\xEF\xBF\xBD");
+    EXPECT_EQ(toUtf8(u"\xDC00z"), "\xEF\xBF\xBDz");
+    EXPECT_EQ(toUtf8(u"\xD800\xD800\xDC00"),
+              "\xEF\xBF\xBD\xF0\x90\x80\x80");
+}
+
+TEST(GameTextUtf, ReplacesInvalidUtf8) {
+    const std::u16string kReplacement = u"\xFFFD";
+    // Lone continuation byte, overlong forms, encoded surrogate, values past
+    // U+10FFFF, bytes that never appear and truncated sequences.
+    const char* kInvalid[] = {"\x80",         "\xC0\xAF",     "\xC1\xBF",
+                              "\xE0\x80\xAF", "\xF0\x80\x80\xAF",
+                              "\xF4\x90\x80\x80", "\xF5",     "\xFF",
+                              "\xE2\x82",     "\xF0\x9F\x98"};
+    for (const char* invalid : kInvalid) {
+        std::u16string result = toUtf16(std::string(invalid) + "a");
+        EXPECT_EQ(result.substr(0, 1), kReplacement) << invalid;
+        EXPECT_EQ(result.back(), u'a') << invalid;
+    }
+    EXPECT_EQ(toUtf16("\xED\xA0\x80"), u"\xFFFD\xFFFD\xFFFD");
+}
+
+TEST(GameTextUtf, ConvertsRandomBytesToValidText) {
+    std::mt19937 rng(4);
+    for (int i = 0; i < kIterations; ++i) {
+        std::string bytes(rng() % 64, '\0');
+        for (char& b : bytes) b = static_cast<char>(rng());
+        // Anything decoded is valid, so it survives a round trip.
+        std::u16string decoded = toUtf16(bytes);
+        std::string encoded = toUtf8(decoded);
+        ASSERT_EQ(toUtf16(encoded), decoded) << "iteration " << i;
+        ASSERT_EQ(toUtf8(toUtf16(encoded)), encoded) << "iteration " << i;
+    }
+}
+
+TEST(GameTextUtf, StopsAtTheLastCharacterThatFits) {
+    std::mt19937 rng(5);
+    for (int i = 0; i < kIterations; ++i) {
+        Text text =
+            reference_utf::encode(reference_utf::randomCodePoints(&rng, 100));
+        int32_t capacity = rng() % (text.utf8.size() + 1);
+        std::string out(capacity, '\0');
+        int32_t offset = static_cast<int32_t>(text.utf16.size());
+        int32_t length = utf16ToUtf8(
+            reinterpret_cast<const uint16_t*>(text.utf16.data()),
+            static_cast<int32_t>(text.utf16.size()), &out[0], capacity,
+            &offset, 1);
+        // The output is the longest prefix of whole characters that fits.
+        size_t k = 0;
+        while (k + 1 < text.bytes.size() && text.bytes[k + 1] <= capacity) {
+            ++k;
+        }
+        ASSERT_EQ(length, text.bytes[k]) << "iteration " << i;
+        ASSERT_EQ(out.substr(0, length), text.utf8.substr(0, length));
+        ASSERT_EQ(offset, length);
+    }
+}
+
+}  // namespace utf_test
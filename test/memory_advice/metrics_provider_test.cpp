@@ -0,0 +1,68 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The /proc readers of DefaultMetricsProvider against snapshots of /proc from
+// different devices.
+
+#include <core/metrics_provider.h>
+#include <unistd.h>
+
+#include "device_snapshots.h"
+#include "gtest/gtest.h"
+#include "procfs.h"
+
+using namespace gamesdk_test;
+using namespace json11;
+
+namespace memory_advice_test {
+
+constexpr double kBytesInKb = 1024;
+
+TEST(MetricsProviderTest, DeviceSnapshots) {
+    for (const DeviceSnapshot& snapshot : DeviceSnapshots()) {
+        SCOPED_TRACE(snapshot.name);
+        ScopedDeviceSnapshot root(snapshot, getpid());
+        memory_advice::DefaultMetricsProvider provider;
+
+        Json::object meminfo = provider.GetMeminfoValues();
+        EXPECT_EQ(meminfo.size(), snapshot.num_meminfo_numbers);
+        EXPECT_EQ(meminfo["MemTotal"].number_value(),
+                  snapshot.mem_total_kb * kBytesInKb);
+        EXPECT_EQ(meminfo["SwapTotal"].number_value(),
+                  snapshot.swap_total_kb * kBytesInKb);
+
+        Json::object status = provider.GetStatusValues();
+        EXPECT_EQ(status.size(), snapshot.num_status_kb_fields);
+        EXPECT_EQ(status["VmRSS"].number_value(),
+                  snapshot.vm_rss_kb * kBytesInKb);
+        // Numbers not in kB, like the thread count, are skipped.
+        EXPECT_EQ(status.count("Threads"), 0u);
+
+        Json::object proc = provider.GetProcValues();
+        EXPECT_EQ(proc["oom_score"].int_value(), snapshot.oom_score);
+    }
+}
+
+TEST(MetricsProviderTest, MissingFiles) {
+    gamesdk::procfs::SetRoot("/nonexistent");
+    memory_advice::DefaultMetricsProvider provider;
+    EXPECT_TRUE(provider.GetMeminfoValues().empty());
+    EXPECT_TRUE(provider.GetStatusValues().empty());
+    EXPECT_EQ(provider.GetProcValues()["oom_score"].int_value(), -1);
+    gamesdk::procfs::SetRoot(nullptr);
+}
+
+}  // namespace memory_advice_test
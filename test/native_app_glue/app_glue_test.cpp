@@ -0,0 +1,291 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// android_native_app_glue driven through the GameActivity callbacks, as the
+// main thread does, with a game thread whose frames take a set time: how long
+// the callbacks block, with and without an acknowledgement timeout, what
+// happens to state saved after the timeout, and posts to a full mailbox.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "game-activity/native_app_glue/android_native_app_glue.h"
+#include "gtest/gtest.h"
+
+using namespace std::chrono_literals;
+
+namespace app_glue_test {
+
+constexpr auto kSlowFrameTime = 200ms;
+constexpr auto kFastFrameTime = 1ms;
+constexpr auto kAckTimeout = 20ms;
+
+// The game run by android_main. Between frames, it handles the commands like
+// a game would, unless it's paused.
+struct Game {
+    static Game* current;
+
+    std::atomic<std::chrono::nanoseconds> frameTime{kFastFrameTime};
+    std::atomic<bool> paused{false};
+    std::atomic<int> frames{0};
+    // Saved on APP_CMD_SAVE_STATE.
+    std::string state = "level 3";
+
+    std::mutex mutex;
+    std::vector<int32_t> commands;
+
+    // Waits for the start of the next frame.
+    void waitForFrameStart() {
+        int frame = frames;
+        while (frames == frame) std::this_thread::sleep_for(1ms);
+    }
+
+    int count(int32_t cmd) {
+        std::lock_guard<std::mutex> lock(mutex);
+        int n = 0;
+        for (int32_t c : commands) n += c == cmd;
+        return n;
+    }
+
+    static void onAppCmd(android_app* app, int32_t cmd) {
+        Game* game = static_cast<Game*>(app->userData);
+        {
+            std::lock_guard<std::mutex> lock(game->mutex);
+            game->commands.push_back(cmd);
+        }
+        if (cmd == APP_CMD_SAVE_STATE) {
+            app->savedState = malloc(game->state.size());
+            memcpy(app->savedState, game->state.data(), game->state.size());
+            app->savedStateSize = game->state.size();
+        }
+    }
+};
+
+Game* Game::current = nullptr;
+
+class AppGlueTest : public ::testing::Test {
+   protected:
+    void create(std::chrono::nanoseconds frameTime) {
+        game.frameTime = frameTime;
+        Game::current = &game;
+        activity.callbacks = &callbacks;
+        GameActivity_onCreate(&activity, nullptr, 0);
+        app = static_cast<android_app*>(activity.instance);
+        ASSERT_NE(app, nullptr);
+    }
+
+    void TearDown() override {
+        game.paused = false;
+        game.frameTime = kFastFrameTime;
+        if (app != nullptr) callbacks.onDestroy(&activity);
+    }
+
+    void setAckTimeout(std::chrono::nanoseconds timeout) {
+        android_app_set_cmd_ack_timeout(app, timeout.count());
+    }
+
+    int activityState() {
+        pthread_mutex_lock(&app->mutex);
+        int state = app->activityState;
+        pthread_mutex_unlock(&app->mutex);
+        return state;
+    }
+
+    void waitForActivityState(int state) {
+        pthread_mutex_lock(&app->mutex);
+        while (app->activityState != state) {
+            android_cmd_mailbox_wait(&app->cond, &app->mutex, -1);
+        }
+        pthread_mutex_unlock(&app->mutex);
+    }
+
+    // Calls onSaveInstanceState, returning the state passed to the recallback,
+    // and how many times it was called in calls.
+    std::string saveInstanceState(int* calls) {
+        struct Saved {
+            std::string state;
+            int calls = 0;
+        } saved;
+        callbacks.onSaveInstanceState(
+            &activity,
+            [](const char* bytes, int len, void* context) {
+                Saved* saved = static_cast<Saved*>(context);
+                saved->state.assign(bytes, len);
+                ++saved->calls;
+            },
+            &saved);
+        *calls = saved.calls;
+        return saved.state;
+    }
+
+    Game game;
+    GameActivityCallbacks callbacks = {};
+    GameActivity activity = {};
+    android_app* app = nullptr;
+};
+
+template <typename F>
+std::chrono::nanoseconds timeOf(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::steady_clock::now() - start;
+}
+
+TEST_F(AppGlueTest, LifecycleCallbacksWaitForTheFrame) {
+    create(kSlowFrameTime);
+    game.waitForFrameStart();
+    auto blocked = timeOf([this]() { callbacks.onStart(&activity); });
+    printf("Blocked %.1f ms without timeout\n", blocked.count() / 1e6);
+    EXPECT_GE(blocked, kSlowFrameTime / 2);
+    EXPECT_EQ(activityState(), APP_CMD_START);
+}
+
+TEST_F(AppGlueTest, AckTimeoutBoundsLifecycleCallbacks) {
+    create(kSlowFrameTime);
+    setAckTimeout(kAckTimeout);
+    game.waitForFrameStart();
+    auto blocked = timeOf([this]() { callbacks.onStart(&activity); });
+    printf("Blocked %.1f ms with a %lld ms timeout\n", blocked.count() / 1e6,
+           static_cast<long long>(kAckTimeout.count()));
+    EXPECT_GE(blocked, kAckTimeout);
+    EXPECT_LT(blocked, kSlowFrameTime / 2);
+    EXPECT_NE(activityState(), APP_CMD_START);
+
+    // The command is still handled, after the frame.
+    waitForActivityState(APP_CMD_START);
+}
+
+TEST_F(AppGlueTest, SaveInstanceStateReturnsTheSavedState) {
+    create(kFastFrameTime);
+    int calls;
+    EXPECT_EQ(saveInstanceState(&calls), game.state);
+    EXPECT_EQ(calls, 1);
+    pthread_mutex_lock(&app->mutex);
+    EXPECT_EQ(app->savedState, nullptr);
+    pthread_mutex_unlock(&app->mutex);
+}
+
+TEST_F(AppGlueTest, StateSavedAfterTheTimeoutIsDropped) {
+    create(kSlowFrameTime);
+    setAckTimeout(kAckTimeout);
+    game.waitForFrameStart();
+    int calls;
+    auto blocked = timeOf([&]() { saveInstanceState(&calls); });
+    EXPECT_LT(blocked, kSlowFrameTime / 2);
+    EXPECT_EQ(calls, 0);
+
+    // The game saves its state after the callback returned: nothing reports
+    // it, and it's freed on resume.
+    pthread_mutex_lock(&app->mutex);
+    while (!app->stateSaved) {
+        android_cmd_mailbox_wait(&app->cond, &app->mutex, -1);
+    }
+    EXPECT_NE(app->savedState, nullptr);
+    pthread_mutex_unlock(&app->mutex);
+    EXPECT_EQ(calls, 0);
+
+    // Nor is it reported by the next callback if that one times out too.
+    saveInstanceState(&calls);
+    EXPECT_EQ(calls, 0);
+
+    game.frameTime = kFastFrameTime;
+    setAckTimeout(std::chrono::nanoseconds(
+        NATIVE_APP_GLUE_CMD_ACK_TIMEOUT_INFINITE));
+    callbacks.onResume(&activity);
+    // APP_CMD_RESUME is done with once the next command is acknowledged.
+    callbacks.onPause(&activity);
+    pthread_mutex_lock(&app->mutex);
+    EXPECT_EQ(app->savedState, nullptr);
+    pthread_mutex_unlock(&app->mutex);
+}
+
+TEST_F(AppGlueTest, CoalescedCallbacksDontBlock) {
+    create(kSlowFrameTime);
+    game.waitForFrameStart();
+    auto blocked = timeOf([this]() {
+        for (int32_t i = 0; i < 10000; ++i) {
+            ARect rect = {0, 0, i, i};
+            callbacks.onContentRectChanged(&activity, &rect);
+        }
+    });
+    printf("Blocked %.3f ms for 10000 callbacks\n", blocked.count() / 1e6);
+    EXPECT_LT(blocked, kSlowFrameTime / 2);
+    // All of them were handled as one command, reading the last rect.
+    game.waitForFrameStart();
+    game.waitForFrameStart();
+    EXPECT_EQ(game.count(APP_CMD_CONTENT_RECT_CHANGED), 1);
+    pthread_mutex_lock(&app->mutex);
+    EXPECT_EQ(app->contentRect.right, 9999);
+    pthread_mutex_unlock(&app->mutex);
+}
+
+TEST_F(AppGlueTest, FullMailboxWaitsForRoom) {
+    create(kFastFrameTime);
+    game.paused = true;
+    game.waitForFrameStart();
+    for (int i = 0; i < ANDROID_CMD_MAILBOX_SIZE; ++i) {
+        callbacks.onWindowFocusChanged(&activity, i % 2 == 0);
+    }
+    std::atomic<bool> posted{false};
+    std::thread poster([&]() {
+        callbacks.onWindowFocusChanged(&activity, true);
+        posted = true;
+    });
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(posted);
+
+    game.paused = false;
+    poster.join();
+    EXPECT_TRUE(posted);
+    // Every command is handled, in order, by the time a later one is
+    // acknowledged.
+    callbacks.onStart(&activity);
+    std::lock_guard<std::mutex> lock(game.mutex);
+    ASSERT_GT(game.commands.size(), ANDROID_CMD_MAILBOX_SIZE);
+    for (int i = 0; i <= ANDROID_CMD_MAILBOX_SIZE; ++i) {
+        EXPECT_EQ(game.commands[i],
+                  i % 2 == 0 ? APP_CMD_GAINED_FOCUS : APP_CMD_LOST_FOCUS);
+    }
+}
+
+}  // namespace app_glue_test
+
+using app_glue_test::Game;
+
+extern "C" void android_main(android_app* app) {
+    Game* game = Game::current;
+    app->userData = game;
+    app->onAppCmd = Game::onAppCmd;
+    while (!app->destroyRequested) {
+        ++game->frames;
+        std::this_thread::sleep_for(game->frameTime.load());
+        if (game->paused) continue;
+        android_poll_source* source;
+        while (!app->destroyRequested &&
+               ALooper_pollOnce(0, nullptr, nullptr,
+                                reinterpret_cast<void**>(&source)) ==
+                   LOOPER_ID_MAIN) {
+            source->process(app, source);
+        }
+    }
+}
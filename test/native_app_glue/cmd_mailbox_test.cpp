@@ -0,0 +1,121 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The command mailbox of native_app_glue: ordering, coalescing, and
+// concurrent posts. See app_glue_test.cpp for how it's used by the glue.
+
+#include <poll.h>
+
+#include <thread>
+#include <vector>
+
+#include "game-activity/native_app_glue/android_cmd_mailbox.h"
+#include "gtest/gtest.h"
+
+namespace cmd_mailbox_test {
+
+constexpr int8_t kLifecycleCmd = 11;
+constexpr int8_t kStateChangedCmd = 5;
+constexpr int8_t kOtherStateChangedCmd = 9;
+
+class CmdMailboxTest : public ::testing::Test {
+   protected:
+    void SetUp() override { ASSERT_TRUE(android_cmd_mailbox_init(&mailbox)); }
+    void TearDown() override { android_cmd_mailbox_destroy(&mailbox); }
+
+    bool hasCommand() {
+        struct pollfd fd = {mailbox.eventFd, POLLIN, 0};
+        return poll(&fd, 1, 0) == 1;
+    }
+
+    android_cmd_mailbox mailbox;
+};
+
+TEST_F(CmdMailboxTest, ReadsCommandsInOrder) {
+    for (int8_t cmd = 0; cmd < 20; ++cmd) {
+        ASSERT_TRUE(android_cmd_mailbox_post(&mailbox, cmd, false));
+    }
+    for (int8_t cmd = 0; cmd < 20; ++cmd) {
+        ASSERT_TRUE(hasCommand());
+        EXPECT_EQ(android_cmd_mailbox_read(&mailbox), cmd);
+    }
+    EXPECT_FALSE(hasCommand());
+}
+
+TEST_F(CmdMailboxTest, CoalescesUnreadCommands) {
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(android_cmd_mailbox_post(&mailbox, kStateChangedCmd, true));
+        ASSERT_TRUE(
+            android_cmd_mailbox_post(&mailbox, kOtherStateChangedCmd, true));
+    }
+    EXPECT_EQ(android_cmd_mailbox_read(&mailbox), kStateChangedCmd);
+    EXPECT_EQ(android_cmd_mailbox_read(&mailbox), kOtherStateChangedCmd);
+    EXPECT_FALSE(hasCommand());
+
+    // A change after the command is read is reported again.
+    ASSERT_TRUE(android_cmd_mailbox_post(&mailbox, kStateChangedCmd, true));
+    EXPECT_EQ(android_cmd_mailbox_read(&mailbox), kStateChangedCmd);
+    EXPECT_FALSE(hasCommand());
+}
+
+TEST_F(CmdMailboxTest, ResetCoalescingKeepsOrder) {
+    ASSERT_TRUE(android_cmd_mailbox_post(&mailbox, kStateChangedCmd, true));
+    android_cmd_mailbox_reset_coalescing(&mailbox);
+    ASSERT_TRUE(android_cmd_mailbox_post(&mailbox, kLifecycleCmd, false));
+    ASSERT_TRUE(android_cmd_mailbox_post(&mailbox, kStateChangedCmd, true));
+    EXPECT_EQ(android_cmd_mailbox_read(&mailbox), kStateChangedCmd);
+    EXPECT_EQ(android_cmd_mailbox_read(&mailbox), kLifecycleCmd);
+    EXPECT_EQ(android_cmd_mailbox_read(&mailbox), kStateChangedCmd);
+    EXPECT_FALSE(hasCommand());
+}
+
+TEST_F(CmdMailboxTest, RejectsPostsWhenFull) {
+    for (int i = 0; i < ANDROID_CMD_MAILBOX_SIZE; ++i) {
+        ASSERT_TRUE(android_cmd_mailbox_post(&mailbox, kLifecycleCmd, false));
+    }
+    EXPECT_FALSE(android_cmd_mailbox_post(&mailbox, kLifecycleCmd, false));
+    EXPECT_FALSE(android_cmd_mailbox_post(&mailbox, kStateChangedCmd, true));
+    EXPECT_EQ(android_cmd_mailbox_read(&mailbox), kLifecycleCmd);
+    // The rejected coalesced command isn't considered queued.
+    EXPECT_TRUE(android_cmd_mailbox_post(&mailbox, kStateChangedCmd, true));
+}
+
+TEST_F(CmdMailboxTest, ReceivesConcurrentPosts) {
+    constexpr int kThreads = 4;
+    constexpr int kPostsPerThread = 20000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([this, t]() {
+            for (int i = 0; i < kPostsPerThread; ++i) {
+                while (!android_cmd_mailbox_post(&mailbox, t, false)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    int counts[kThreads] = {};
+    for (int i = 0; i < kThreads * kPostsPerThread; ++i) {
+        int8_t cmd = android_cmd_mailbox_read(&mailbox);
+        ASSERT_GE(cmd, 0);
+        ASSERT_LT(cmd, kThreads);
+        ++counts[cmd];
+    }
+    for (std::thread& thread : threads) thread.join();
+    for (int t = 0; t < kThreads; ++t) EXPECT_EQ(counts[t], kPostsPerThread);
+    EXPECT_FALSE(hasCommand());
+}
+
+}  // namespace cmd_mailbox_test
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// The part of the NDK's android/configuration.h used by native_app_glue, for
+// a Linux host. See fake_ndk.cpp for the implementation, in which every
+// configuration is empty.
+
+#include <stdint.h>
+
+#include "android/asset_manager.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct AConfiguration;
+typedef struct AConfiguration AConfiguration;
+
+AConfiguration* AConfiguration_new();
+void AConfiguration_delete(AConfiguration* config);
+void AConfiguration_fromAssetManager(AConfiguration* out, AAssetManager* am);
+
+int32_t AConfiguration_getMcc(AConfiguration* config);
+int32_t AConfiguration_getMnc(AConfiguration* config);
+void AConfiguration_getLanguage(AConfiguration* config, char* outLanguage);
+void AConfiguration_getCountry(AConfiguration* config, char* outCountry);
+int32_t AConfiguration_getOrientation(AConfiguration* config);
+int32_t AConfiguration_getTouchscreen(AConfiguration* config);
+int32_t AConfiguration_getDensity(AConfiguration* config);
+int32_t AConfiguration_getKeyboard(AConfiguration* config);
+int32_t AConfiguration_getNavigation(AConfiguration* config);
+int32_t AConfiguration_getKeysHidden(AConfiguration* config);
+int32_t AConfiguration_getNavHidden(AConfiguration* config);
+int32_t AConfiguration_getSdkVersion(AConfiguration* config);
+int32_t AConfiguration_getScreenSize(AConfiguration* config);
+int32_t AConfiguration_getScreenLong(AConfiguration* config);
+int32_t AConfiguration_getUiModeType(AConfiguration* config);
+int32_t AConfiguration_getUiModeNight(AConfiguration* config);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// The part of the NDK's android/log.h used by native_app_glue, logging to
+// stderr on a Linux host.
+
+#include <stdarg.h>
+#include <stdio.h>
+
+typedef enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT,
+} android_LogPriority;
+
+static inline int __android_log_print(int prio, const char *tag,
+                                      const char *fmt, ...) {
+    if (prio < ANDROID_LOG_WARN) return 0;
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "%s: ", tag);
+    int result = vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+    return result;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// The part of the NDK's android/looper.h used by native_app_glue, for a Linux
+// host. See fake_ndk.cpp for the implementation, which only supports one fd
+// per thread.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct ALooper;
+typedef struct ALooper ALooper;
+
+enum {
+    ALOOPER_PREPARE_ALLOW_NON_CALLBACKS = 1 << 0,
+};
+
+enum {
+    ALOOPER_POLL_WAKE = -1,
+    ALOOPER_POLL_CALLBACK = -2,
+    ALOOPER_POLL_TIMEOUT = -3,
+    ALOOPER_POLL_ERROR = -4,
+};
+
+enum {
+    ALOOPER_EVENT_INPUT = 1 << 0,
+};
+
+typedef int (*ALooper_callbackFunc)(int fd, int events, void* data);
+
+ALooper* ALooper_prepare(int opts);
+
+int ALooper_addFd(ALooper* looper, int fd, int ident, int events,
+                  ALooper_callbackFunc callback, void* data);
+
+int ALooper_pollOnce(int timeoutMillis, int* outFd, int* outEvents,
+                     void** outData);
+
+#ifdef __cplusplus
+}
+#endif
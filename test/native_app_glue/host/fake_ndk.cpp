@@ -0,0 +1,89 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The NDK functions called by native_app_glue, for tests on a host.
+
+#include <android/configuration.h>
+#include <android/looper.h>
+#include <poll.h>
+
+#include "game-activity/GameActivityEvents.h"
+
+struct ALooper {
+    int fd = -1;
+    int ident = 0;
+    void* data = nullptr;
+};
+
+struct AConfiguration {};
+
+extern "C" {
+
+ALooper* ALooper_prepare(int opts) {
+    static thread_local ALooper looper;
+    return &looper;
+}
+
+int ALooper_addFd(ALooper* looper, int fd, int ident, int events,
+                  ALooper_callbackFunc callback, void* data) {
+    looper->fd = fd;
+    looper->ident = ident;
+    looper->data = data;
+    return 1;
+}
+
+int ALooper_pollOnce(int timeoutMillis, int* outFd, int* outEvents,
+                     void** outData) {
+    ALooper* looper = ALooper_prepare(0);
+    struct pollfd fd = {looper->fd, POLLIN, 0};
+    int result = poll(&fd, 1, timeoutMillis);
+    if (result < 0) return ALOOPER_POLL_ERROR;
+    if (result == 0) return ALOOPER_POLL_TIMEOUT;
+    if (outFd != nullptr) *outFd = looper->fd;
+    if (outEvents != nullptr) *outEvents = ALOOPER_EVENT_INPUT;
+    if (outData != nullptr) *outData = looper->data;
+    return looper->ident;
+}
+
+AConfiguration* AConfiguration_new() { return new AConfiguration; }
+void AConfiguration_delete(AConfiguration* config) { delete config; }
+void AConfiguration_fromAssetManager(AConfiguration* out, AAssetManager* am) {}
+
+int32_t AConfiguration_getMcc(AConfiguration* config) { return 0; }
+int32_t AConfiguration_getMnc(AConfiguration* config) { return 0; }
+void AConfiguration_getLanguage(AConfiguration* config, char* outLanguage) {
+    outLanguage[0] = outLanguage[1] = 0;
+}
+void AConfiguration_getCountry(AConfiguration* config, char* outCountry) {
+    outCountry[0] = outCountry[1] = 0;
+}
+int32_t AConfiguration_getOrientation(AConfiguration* config) { return 0; }
+int32_t AConfiguration_getTouchscreen(AConfiguration* config) { return 0; }
+int32_t AConfiguration_getDensity(AConfiguration* config) { return 0; }
+int32_t AConfiguration_getKeyboard(AConfiguration* config) { return 0; }
+int32_t AConfiguration_getNavigation(AConfiguration* config) { return 0; }
+int32_t AConfiguration_getKeysHidden(AConfiguration* config) { return 0; }
+int32_t AConfiguration_getNavHidden(AConfiguration* config) { return 0; }
+int32_t AConfiguration_getSdkVersion(AConfiguration* config) { return 0; }
+int32_t AConfiguration_getScreenSize(AConfiguration* config) { return 0; }
+int32_t AConfiguration_getScreenLong(AConfiguration* config) { return 0; }
+int32_t AConfiguration_getUiModeType(AConfiguration* config) { return 0; }
+int32_t AConfiguration_getUiModeNight(AConfiguration* config) { return 0; }
+
+// The tests send no motion events, which are created by GameActivity.
+void GameActivityMotionEvent_destroy(GameActivityMotionEvent* c_event) {}
+
+}  // extern "C"
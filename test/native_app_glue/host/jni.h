@@ -0,0 +1,29 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// The JNI types named by the GameActivity headers, for a Linux host. Nothing
+// calls into Java in the tests.
+
+#include <stdint.h>
+
+#define JNIEXPORT __attribute__((visibility("default")))
+
+typedef int32_t jint;
+typedef void* jobject;
+typedef struct _JNIEnv JNIEnv;
+typedef struct _JavaVM JavaVM;
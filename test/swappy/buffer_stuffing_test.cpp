@@ -0,0 +1,174 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Reproduces buffer stuffing with a simulated compositor queue and checks
+// that BufferStuffingDetector drains it.
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "common/BufferStuffingDetector.h"
+#include "gtest/gtest.h"
+
+using namespace swappy;
+
+namespace buffer_stuffing_test {
+
+constexpr int64_t kRefreshPeriod = 16666667;
+
+struct SimulationResult {
+    // Average number of vsyncs frames were presented after their desired time.
+    double initialLateness;
+    double finalLateness;
+    int drains;
+    // First frame presented on time after the hitch, or -1.
+    int recoveredFrame;
+};
+
+// The app is paced to submit one frame per vsync and wants each frame to be
+// presented 2 vsyncs after it starts. The compositor presents one queued
+// frame per vsync. The GPU work of frame hitchFrame takes hitchVsyncs more
+// vsyncs than usual, which delays all the frames queued behind it. Present
+// times are reported statsLag frames later, as with
+// EGL_ANDROID_get_frame_timestamps.
+SimulationResult simulate(int frames, int hitchFrame, int hitchVsyncs,
+                          int32_t threshold, int statsLag = 3) {
+    BufferStuffingDetector detector;
+    detector.setStuffedFramesThreshold(threshold);
+
+    std::vector<int64_t> desired(frames);
+    std::vector<int64_t> actual(frames);
+    SimulationResult result = {0, 0, 0, -1};
+    int64_t startVsync = 0;
+    for (int i = 0; i < frames; ++i) {
+        if (detector.consumeDrainRequest()) {
+            startVsync++;
+            result.drains++;
+        }
+        desired[i] = startVsync + 2;
+        const int64_t ready = desired[i] + (i == hitchFrame ? hitchVsyncs : 0);
+        actual[i] = i == 0 ? ready : std::max(ready, actual[i - 1] + 1);
+        if (i > hitchFrame && actual[i] == desired[i] &&
+            result.recoveredFrame == -1) {
+            result.recoveredFrame = i;
+        }
+
+        if (i >= statsLag) {
+            const int reported = i - statsLag;
+            detector.onFramePresented(desired[reported] * kRefreshPeriod,
+                                      actual[reported] * kRefreshPeriod,
+                                      kRefreshPeriod);
+        }
+        startVsync++;
+    }
+
+    constexpr int kAveragedFrames = 60;
+    for (int i = 0; i < kAveragedFrames; ++i) {
+        result.initialLateness +=
+            actual[hitchFrame + 1 + i] - desired[hitchFrame + 1 + i];
+        result.finalLateness +=
+            actual[frames - 1 - i] - desired[frames - 1 - i];
+    }
+    result.initialLateness /= kAveragedFrames;
+    result.finalLateness /= kAveragedFrames;
+    return result;
+}
+
+}  // namespace buffer_stuffing_test
+
+using namespace buffer_stuffing_test;
+
+TEST(BufferStuffingTest, SingleHitchIsDrainedByOneFrame) {
+    constexpr int kFrames = 600;
+    constexpr int kHitchFrame = 100;
+
+    // Without the fix, the extra vsync of latency never goes away.
+    const auto stuffed = simulate(kFrames, kHitchFrame, 1, 0);
+    EXPECT_EQ(stuffed.drains, 0);
+    EXPECT_EQ(stuffed.recoveredFrame, -1);
+    EXPECT_DOUBLE_EQ(stuffed.finalLateness, 1.0);
+
+    const auto fixed =
+        simulate(kFrames, kHitchFrame, 1,
+                 BufferStuffingDetector::DEFAULT_STUFFED_FRAMES);
+    printf("Recovered %d frames after the hitch, with %d frame(s) dropped\n",
+           fixed.recoveredFrame - kHitchFrame, fixed.drains);
+    EXPECT_EQ(fixed.drains, 1);
+    EXPECT_DOUBLE_EQ(fixed.finalLateness, 0.0);
+    // The detector needs DEFAULT_STUFFED_FRAMES reports, which come statsLag
+    // frames late, and the frames already queued are presented late too.
+    EXPECT_LE(fixed.recoveredFrame - kHitchFrame, 10);
+    EXPECT_LT(fixed.initialLateness, stuffed.initialLateness);
+}
+
+TEST(BufferStuffingTest, DeeperStuffingIsDrainedOneFrameAtATime) {
+    constexpr int kFrames = 600;
+    constexpr int kHitchFrame = 100;
+    for (int hitchVsyncs = 2; hitchVsyncs <= 3; ++hitchVsyncs) {
+        SCOPED_TRACE(hitchVsyncs);
+        const auto stuffed = simulate(kFrames, kHitchFrame, hitchVsyncs, 0);
+        EXPECT_DOUBLE_EQ(stuffed.finalLateness, hitchVsyncs);
+
+        const auto fixed = simulate(
+            kFrames, kHitchFrame, hitchVsyncs,
+            BufferStuffingDetector::DEFAULT_STUFFED_FRAMES);
+        EXPECT_EQ(fixed.drains, hitchVsyncs);
+        EXPECT_DOUBLE_EQ(fixed.finalLateness, 0.0);
+        EXPECT_NE(fixed.recoveredFrame, -1);
+    }
+}
+
+TEST(BufferStuffingTest, IgnoresJankAndFallingBehind) {
+    BufferStuffingDetector detector;
+    int64_t desired = 0;
+
+    // Frames alternately on time and late: no build-up.
+    for (int i = 0; i < 100; ++i) {
+        desired += kRefreshPeriod;
+        detector.onFramePresented(desired, desired + (i % 2) * kRefreshPeriod,
+                                  kRefreshPeriod);
+        EXPECT_FALSE(detector.consumeDrainRequest());
+    }
+
+    // Frames later and later: the app can't keep up, dropping frames won't
+    // help.
+    for (int i = 0; i < 10; ++i) {
+        desired += kRefreshPeriod;
+        detector.onFramePresented(desired, desired + i * kRefreshPeriod,
+                                  kRefreshPeriod);
+        EXPECT_FALSE(detector.consumeDrainRequest());
+    }
+
+    // Frames without a desired present time are ignored.
+    detector.reset();
+    for (int i = 0; i < 10; ++i) {
+        desired += kRefreshPeriod;
+        detector.onFramePresented(-1, desired + kRefreshPeriod,
+                                  kRefreshPeriod);
+        EXPECT_FALSE(detector.consumeDrainRequest());
+    }
+
+    // A steady extra vsync triggers a single drain.
+    int drains = 0;
+    for (int i = 0; i < 10; ++i) {
+        desired += kRefreshPeriod;
+        detector.onFramePresented(desired, desired + kRefreshPeriod,
+                                  kRefreshPeriod);
+        if (detector.consumeDrainRequest()) drains++;
+    }
+    EXPECT_EQ(drains, 1);
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// CpuInfo against snapshots of /proc and /sys from different devices.
+
+#include <unistd.h>
+
+#include <string>
+
+#include "common/CpuInfo.h"
+#include "device_snapshots.h"
+#include "gtest/gtest.h"
+
+using namespace swappy;
+using namespace gamesdk_test;
+
+namespace cpu_info_test {
+
+TEST(CpuInfoTest, DeviceSnapshots) {
+    for (const DeviceSnapshot& snapshot : DeviceSnapshots()) {
+        SCOPED_TRACE(snapshot.name);
+        ScopedDeviceSnapshot root(snapshot, getpid());
+        CpuInfo info;
+
+        ASSERT_EQ(static_cast<int>(info.getNumberOfCpus()),
+                  snapshot.num_processors);
+        // The hardware keeps the space after the colon.
+        EXPECT_EQ(info.getHardware(), *snapshot.hardware == '\0'
+                                          ? std::string()
+                                          : std::string(" ") +
+                                                snapshot.hardware);
+        EXPECT_EQ(static_cast<int>(info.getNumberOfLittleCores()),
+                  snapshot.num_little_cores);
+        EXPECT_EQ(static_cast<int>(info.getNumberOfBigCores()),
+                  snapshot.num_processors - snapshot.num_little_cores);
+
+        cpu_set_t little = info.getLittleCoresMask();
+        cpu_set_t big = info.getBigCoresMask();
+        for (const CpuInfo::Cpu& cpu : info.getCpus()) {
+            EXPECT_EQ(cpu.package_id, 0);
+            EXPECT_EQ(cpu.frequency, snapshot.max_freqs[cpu.id]);
+            // Little cores come first in all the snapshots.
+            bool is_little = cpu.id < snapshot.num_little_cores;
+            EXPECT_EQ(CPU_ISSET(cpu.id, &little) != 0, is_little) << cpu.id;
+            EXPECT_EQ(CPU_ISSET(cpu.id, &big) != 0, !is_little) << cpu.id;
+        }
+    }
+}
+
+TEST(CpuInfoTest, EmptyCpuInfo) {
+    DeviceSnapshot snapshot = DeviceSnapshots()[0];
+    snapshot.cpuinfo.clear();
+    ScopedDeviceSnapshot root(snapshot, getpid());
+    CpuInfo info;
+    EXPECT_EQ(info.getNumberOfCpus(), 0u);
+    EXPECT_EQ(info.getHardware(), "");
+}
+
+}  // namespace cpu_info_test
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Checks with the trace recorder that the CPU frame time sections emitted by
+// SwappyCommon line up with the frames.
+
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "TraceRecorder.h"
+#include "common/Settings.h"
+#include "common/SwappyCommon.h"
+#include "gtest/gtest.h"
+
+using namespace swappy;
+using namespace std::chrono_literals;
+using gamesdk::TraceRecorder;
+
+namespace cpu_tracer_test {
+
+class SwappyCommonTest : public SwappyCommon {
+   public:
+    SwappyCommonTest(const SwappyCommonSettings& settings)
+        : SwappyCommon(settings) {}
+};
+
+struct FrameMarkers {
+    std::vector<int64_t> preWait;
+    std::vector<int64_t> startFrame;
+};
+
+int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void onPreWait(void* userData) {
+    static_cast<FrameMarkers*>(userData)->preWait.push_back(now());
+}
+
+void onStartFrame(void* userData, int, int64_t) {
+    static_cast<FrameMarkers*>(userData)->startFrame.push_back(now());
+}
+
+}  // namespace cpu_tracer_test
+
+using namespace cpu_tracer_test;
+
+TEST(SwappyCPUTracerTest, SectionsMatchFrames) {
+    constexpr int kFrames = 20;
+    constexpr auto kCpuTime = 2ms;
+    const SwappyCommonSettings settings{
+        {0, 0},      // SDK version
+        16666667ns,  // refresh period
+        0ns,         // app vsync offset
+        0ns          // sf vsync offset
+    };
+
+    Settings::getInstance()->reset();
+    SwappyCommonTest common(settings);
+    common.enableFramePacing(false);
+    common.enableBlockingWait(false);
+
+    FrameMarkers markers;
+    SwappyTracer tracer = {};
+    tracer.preWait = onPreWait;
+    tracer.startFrame = onStartFrame;
+    tracer.userData = &markers;
+    common.addTracerCallbacks(tracer);
+
+    const SwappyCommon::SwapHandlers handlers = {
+        .lastFrameIsComplete = [](void*) { return true; },
+        .getPrevFrameGpuTime = [](void*) -> std::chrono::nanoseconds {
+            return 0ns;
+        },
+        .userData = nullptr,
+    };
+
+    TraceRecorder::getInstance()->start();
+    for (int i = 0; i < kFrames; ++i) {
+        common.onPreSwap(handlers);
+        common.onPostSwap(handlers);
+        std::this_thread::sleep_for(kCpuTime);
+    }
+    TraceRecorder::getInstance()->stop();
+
+    std::vector<TraceRecorder::Event> begins, ends, counters;
+    std::set<int32_t> tids;
+    for (const auto& thread : TraceRecorder::getInstance()->snapshot()) {
+        for (const auto& event : thread.events) {
+            if (event.name == nullptr) continue;
+            if (strcmp(event.name, "Swappy: CPU frame time") == 0) {
+                if (event.type == TraceRecorder::EventType::AsyncBegin) {
+                    begins.push_back(event);
+                } else if (event.type == TraceRecorder::EventType::AsyncEnd) {
+                    ends.push_back(event);
+                }
+            } else if (strcmp(event.name, "Swappy: CPU frame time (ns)") ==
+                       0) {
+                counters.push_back(event);
+            } else {
+                continue;
+            }
+            tids.insert(thread.tid);
+        }
+    }
+
+    // Everything is emitted from the swapping thread, no helper thread is
+    // involved.
+    EXPECT_EQ(tids.size(), 1u);
+
+    // Every frame starts a section. The first swap has no section to close
+    // and the last section is still open.
+    ASSERT_EQ(begins.size(), static_cast<size_t>(kFrames));
+    ASSERT_EQ(ends.size(), static_cast<size_t>(kFrames - 1));
+    ASSERT_EQ(counters.size(), static_cast<size_t>(kFrames));
+    ASSERT_EQ(markers.startFrame.size(), static_cast<size_t>(kFrames));
+    ASSERT_EQ(markers.preWait.size(), static_cast<size_t>(kFrames));
+
+    for (size_t i = 0; i < ends.size(); ++i) {
+        EXPECT_EQ(begins[i].value, ends[i].value);
+        if (i > 0) EXPECT_EQ(begins[i].value, begins[i - 1].value + 1);
+
+        // The section starts just before the startFrame callback and ends just
+        // before the next preWait callback.
+        EXPECT_LE(begins[i].timestampNs, markers.startFrame[i]);
+        EXPECT_GT(ends[i].timestampNs, markers.startFrame[i]);
+        EXPECT_LE(ends[i].timestampNs, markers.preWait[i + 1]);
+        EXPECT_GE(ends[i].timestampNs - begins[i].timestampNs,
+                  std::chrono::nanoseconds(kCpuTime).count());
+
+        // The counter reports the same duration, measured by SwappyCommon.
+        const int64_t sectionDuration =
+            ends[i].timestampNs - begins[i].timestampNs;
+        EXPECT_NEAR(counters[i + 1].value, sectionDuration,
+                    std::chrono::nanoseconds(1ms).count());
+    }
+}
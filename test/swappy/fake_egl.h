@@ -0,0 +1,157 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// A minimal EGL implementation that can be handed to EGL::create so that the
+// OpenGL backend runs without a GPU. Each fence signals gpuTime after it is
+// created and the rendering complete timestamp of the frame being swapped is
+// the signal time of the last fence created before the swap. The other frame
+// timestamps become available a few frames after the swap. Nothing here
+// allocates, so it can be used by the allocation tests.
+
+#pragma once
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace fake_egl {
+
+constexpr EGLnsecsANDROID kFramePeriod = 16'666'667;
+constexpr EGLuint64KHR kTimestampLag = 3;
+constexpr size_t kMaxObjects = 64;
+
+inline std::atomic<std::chrono::nanoseconds> gpuTime = {
+    std::chrono::nanoseconds(0)};
+inline std::atomic<bool> frameTimestampsSupported = {true};
+
+// Counters for comparing the measurement modes.
+inline std::atomic<int> clientWaits = {0};
+inline std::atomic<int> statusPolls = {0};
+
+inline std::atomic<intptr_t> nextSync = {1};
+inline std::atomic<EGLuint64KHR> nextFrameId = {1};
+inline std::atomic<EGLnsecsANDROID> signalTimes[kMaxObjects];
+inline std::atomic<EGLnsecsANDROID> renderingCompleteTimes[kMaxObjects];
+
+inline EGLnsecsANDROID now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+inline void reset(std::chrono::nanoseconds newGpuTime) {
+    gpuTime = newGpuTime;
+    frameTimestampsSupported = true;
+    clientWaits = 0;
+    statusPolls = 0;
+}
+
+inline EGLnsecsANDROID signalTime(EGLSyncKHR sync) {
+    return signalTimes[reinterpret_cast<intptr_t>(sync) % kMaxObjects];
+}
+
+inline EGLBoolean swapBuffers(EGLDisplay, EGLSurface) {
+    ++nextFrameId;
+    return EGL_TRUE;
+}
+inline EGLBoolean presentationTime(EGLDisplay, EGLSurface, EGLnsecsANDROID) {
+    return EGL_TRUE;
+}
+inline EGLSyncKHR createSync(EGLDisplay, EGLenum, const EGLint*) {
+    const intptr_t sync = nextSync++;
+    const EGLnsecsANDROID signal = now() + gpuTime.load().count();
+    signalTimes[sync % kMaxObjects] = signal;
+    renderingCompleteTimes[nextFrameId % kMaxObjects] = signal;
+    return reinterpret_cast<EGLSyncKHR>(sync);
+}
+inline EGLBoolean destroySync(EGLDisplay, EGLSyncKHR) { return EGL_TRUE; }
+inline EGLBoolean getSyncAttrib(EGLDisplay, EGLSyncKHR sync, EGLint,
+                                EGLint* value) {
+    ++statusPolls;
+    *value = now() >= signalTime(sync) ? EGL_SIGNALED_KHR : EGL_UNSIGNALED_KHR;
+    return EGL_TRUE;
+}
+inline EGLBoolean clientWaitSync(EGLDisplay, EGLSyncKHR sync, EGLint,
+                                 EGLTimeKHR timeout) {
+    ++clientWaits;
+    const EGLnsecsANDROID wait = signalTime(sync) - now();
+    if (wait > static_cast<EGLnsecsANDROID>(timeout)) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(timeout));
+        return EGL_TIMEOUT_EXPIRED_KHR;
+    }
+    if (wait > 0) std::this_thread::sleep_for(std::chrono::nanoseconds(wait));
+    return EGL_CONDITION_SATISFIED_KHR;
+}
+inline EGLint getError() { return EGL_SUCCESS; }
+inline EGLBoolean surfaceAttrib(EGLDisplay, EGLSurface, EGLint, EGLint) {
+    return EGL_TRUE;
+}
+inline EGLBoolean getNextFrameId(EGLDisplay, EGLSurface,
+                                 EGLuint64KHR* frameId) {
+    *frameId = nextFrameId;
+    return EGL_TRUE;
+}
+inline EGLBoolean getFrameTimestamps(EGLDisplay, EGLSurface,
+                                     EGLuint64KHR frameId,
+                                     EGLint numTimestamps,
+                                     const EGLint* timestamps,
+                                     EGLnsecsANDROID* values) {
+    if (!frameTimestampsSupported) return EGL_FALSE;
+    const bool ready = frameId + kTimestampLag <= nextFrameId;
+    for (int i = 0; i < numTimestamps; ++i) {
+        if (timestamps[i] == EGL_RENDERING_COMPLETE_TIME_ANDROID) {
+            const EGLnsecsANDROID complete =
+                renderingCompleteTimes[frameId % kMaxObjects];
+            values[i] = now() >= complete ? complete
+                                          : EGL_TIMESTAMP_PENDING_ANDROID;
+        } else {
+            values[i] = ready ? (frameId + i) * kFramePeriod
+                              : EGL_TIMESTAMP_PENDING_ANDROID;
+        }
+    }
+    return EGL_TRUE;
+}
+
+using Proc = void (*)(void);
+
+inline Proc getProcAddress(const char* name) {
+    static const struct {
+        const char* name;
+        Proc proc;
+    } kFunctions[] = {
+        {"eglPresentationTimeANDROID",
+         reinterpret_cast<Proc>(presentationTime)},
+        {"eglCreateSyncKHR", reinterpret_cast<Proc>(createSync)},
+        {"eglDestroySyncKHR", reinterpret_cast<Proc>(destroySync)},
+        {"eglGetSyncAttribKHR", reinterpret_cast<Proc>(getSyncAttrib)},
+        {"eglClientWaitSyncKHR", reinterpret_cast<Proc>(clientWaitSync)},
+        {"eglGetError", reinterpret_cast<Proc>(getError)},
+        {"eglSurfaceAttrib", reinterpret_cast<Proc>(surfaceAttrib)},
+        {"eglGetNextFrameIdANDROID", reinterpret_cast<Proc>(getNextFrameId)},
+        {"eglGetFrameTimestampsANDROID",
+         reinterpret_cast<Proc>(getFrameTimestamps)},
+    };
+    for (const auto& f : kFunctions) {
+        if (strcmp(f.name, name) == 0) return f.proc;
+    }
+    return nullptr;
+}
+
+}  // namespace fake_egl
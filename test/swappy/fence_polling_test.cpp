@@ -0,0 +1,167 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares the GPU time measured by the fence waiter thread with the estimates
+// obtained by polling the fences, with and without frame timestamps, and checks
+// that polling doesn't change the frame pacing: the GPU is faster than the CPU,
+// so every frame's fence must be seen as complete by its swap, and the frames
+// must take the CPU time.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "fake_egl.h"
+#include "gtest/gtest.h"
+#include "opengl/EGL.h"
+
+using namespace swappy;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr auto kFenceTimeout = 50ms;
+constexpr auto kGpuTime = 6ms;
+// Time between inserting a frame's fence and checking that it completed, i.e.
+// the interval between two polls.
+constexpr auto kCpuTime = 10ms;
+constexpr int kFrames = 30;
+
+const EGLDisplay kDisplay = reinterpret_cast<EGLDisplay>(1);
+const EGLSurface kSurface = reinterpret_cast<EGLSurface>(2);
+
+struct Result {
+    std::chrono::nanoseconds meanError;
+    // Mean time between two swaps.
+    std::chrono::nanoseconds framePeriod;
+    // Frames whose fence wasn't seen as complete after the CPU time.
+    int lateFrames;
+    int clientWaits;
+    int statusPolls;
+};
+
+// Runs frames the way SwappyGL::swapInternal does when blocking wait is on and
+// returns how far the reported GPU time was from the simulated one, and how
+// the frames were paced.
+Result runFrames(EGL& egl) {
+    std::chrono::nanoseconds totalError(0);
+    int measured = 0;
+    int lateFrames = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kFrames; ++i) {
+        egl.insertSyncFence(kDisplay, kSurface);
+        std::this_thread::sleep_for(kCpuTime);
+        int spins = 0;
+        while (!egl.lastFrameIsComplete(kDisplay, false) && spins++ < 100) {
+            std::this_thread::sleep_for(1ms);
+        }
+        if (spins > 0) lateFrames++;
+        egl.swapBuffers(kDisplay, kSurface);
+        totalError += std::chrono::nanoseconds(
+            std::abs((egl.getFencePendingTime() - kGpuTime).count()));
+        measured++;
+    }
+    const auto period = (std::chrono::steady_clock::now() - start) / kFrames;
+    return {totalError / measured, period, lateFrames, fake_egl::clientWaits,
+            fake_egl::statusPolls};
+}
+
+void printResult(const char* mode, const Result& result) {
+    printf(
+        "%-24s mean error %6.3fms, frame period %6.3fms, %3d blocking waits, "
+        "%3d polls\n",
+        mode, result.meanError.count() / 1e6, result.framePeriod.count() / 1e6,
+        result.clientWaits, result.statusPolls);
+}
+
+// Polling mustn't delay the swaps: they're paced by the CPU time alone.
+void expectPacedByCpuTime(const Result& result) {
+    EXPECT_EQ(result.lateFrames, 0);
+    EXPECT_GE(result.framePeriod, kCpuTime);
+    EXPECT_LT(result.framePeriod, kCpuTime + 2ms);
+}
+
+}  // anonymous namespace
+
+TEST(SwappyFencePollingTest, WaiterThread) {
+    fake_egl::reset(kGpuTime);
+    auto egl = EGL::create(kFenceTimeout, fake_egl::getProcAddress,
+                           fake_egl::swapBuffers);
+    ASSERT_NE(egl, nullptr);
+
+    const Result result = runFrames(*egl);
+    printResult("waiter thread", result);
+
+    EXPECT_EQ(result.clientWaits, kFrames);
+    EXPECT_LT(result.meanError, 2ms);
+    expectPacedByCpuTime(result);
+}
+
+TEST(SwappyFencePollingTest, PollingWithoutFrameTimestamps) {
+    fake_egl::reset(kGpuTime);
+    fake_egl::frameTimestampsSupported = false;
+    auto egl = EGL::create(kFenceTimeout, fake_egl::getProcAddress,
+                           fake_egl::swapBuffers);
+    ASSERT_NE(egl, nullptr);
+    egl->setFencePolling(true);
+
+    const Result result = runFrames(*egl);
+    printResult("polling", result);
+
+    // No thread is waiting on the fences and the estimate is at most half a
+    // poll interval away.
+    EXPECT_EQ(result.clientWaits, 0);
+    EXPECT_GT(result.statusPolls, 0);
+    EXPECT_LT(result.meanError, kCpuTime / 2 + 1ms);
+    expectPacedByCpuTime(result);
+}
+
+TEST(SwappyFencePollingTest, PollingWithFrameTimestamps) {
+    fake_egl::reset(kGpuTime);
+    auto egl = EGL::create(kFenceTimeout, fake_egl::getProcAddress,
+                           fake_egl::swapBuffers);
+    ASSERT_NE(egl, nullptr);
+    ASSERT_TRUE(egl->statsSupported());
+    egl->setFencePolling(true);
+
+    const Result result = runFrames(*egl);
+    printResult("polling with timestamps", result);
+
+    EXPECT_EQ(result.clientWaits, 0);
+    EXPECT_LT(result.meanError, 1ms);
+    expectPacedByCpuTime(result);
+}
+
+TEST(SwappyFencePollingTest, SwitchModes) {
+    fake_egl::reset(kGpuTime);
+    auto egl = EGL::create(kFenceTimeout, fake_egl::getProcAddress,
+                           fake_egl::swapBuffers);
+    ASSERT_NE(egl, nullptr);
+
+    // Leave a fence pending while the waiter thread is stopped, it must still
+    // be retired by polling.
+    egl->insertSyncFence(kDisplay, kSurface);
+    egl->setFencePolling(true);
+    const int waitsBeforePolling = fake_egl::clientWaits;
+    runFrames(*egl);
+    EXPECT_EQ(fake_egl::clientWaits, waitsBeforePolling);
+    EXPECT_TRUE(egl->lastFrameIsComplete(kDisplay, false));
+
+    egl->setFencePolling(false);
+    runFrames(*egl);
+    EXPECT_EQ(fake_egl::clientWaits, waitsBeforePolling + kFrames);
+}
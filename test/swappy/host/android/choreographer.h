@@ -0,0 +1,34 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// The types of the NDK's android/choreographer.h used by Swappy, for a Linux
+// host. Swappy looks the AChoreographer functions up at run time.
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct AChoreographer AChoreographer;
+typedef struct AChoreographerFrameCallbackData AChoreographerFrameCallbackData;
+
+typedef void (*AChoreographer_frameCallback)(long frameTimeNanos, void* data);
+typedef void (*AChoreographer_frameCallback64)(int64_t frameTimeNanos,
+                                               void* data);
+typedef void (*AChoreographer_vsyncCallback)(
+    const AChoreographerFrameCallbackData* callbackData, void* data);
+typedef void (*AChoreographer_refreshRateCallback)(int64_t vsyncPeriodNanos,
+                                                   void* data);
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The NDK and bionic functions called by Swappy, for tests on a host.
+
+#include <android/looper.h>
+#include <android/native_window.h>
+#include <sys/system_properties.h>
+
+extern "C" {
+
+void ANativeWindow_acquire(ANativeWindow* window) {}
+void ANativeWindow_release(ANativeWindow* window) {}
+int32_t ANativeWindow_setFrameRate(ANativeWindow* window, float frameRate,
+                                   int8_t compatibility) {
+    return 0;
+}
+
+ALooper* ALooper_prepare(int opts) { return nullptr; }
+void ALooper_acquire(ALooper* looper) {}
+void ALooper_release(ALooper* looper) {}
+int ALooper_pollOnce(int timeoutMillis, int* outFd, int* outEvents,
+                     void** outData) {
+    return ALOOPER_POLL_TIMEOUT;
+}
+void ALooper_wake(ALooper* looper) {}
+
+int __system_property_get(const char* name, char* value) {
+    value[0] = 0;
+    return 0;
+}
+const prop_info* __system_property_find(const char* name) { return nullptr; }
+void __system_property_read_callback(
+    const prop_info* pi,
+    void (*callback)(void* cookie, const char* name, const char* value,
+                     uint32_t serial),
+    void* cookie) {}
+
+}  // extern "C"
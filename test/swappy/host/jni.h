@@ -0,0 +1,150 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// The JNI types and the JNIEnv and JavaVM methods used by Swappy, for a Linux
+// host. There is no Java VM in the tests: Swappy isn't given one, so these are
+// never called, and return zero if they were.
+
+#include <stdarg.h>
+#include <stdint.h>
+
+typedef uint8_t jboolean;
+typedef int8_t jbyte;
+typedef uint16_t jchar;
+typedef int16_t jshort;
+typedef int32_t jint;
+typedef int64_t jlong;
+typedef float jfloat;
+typedef double jdouble;
+typedef jint jsize;
+
+class _jobject {};
+class _jclass : public _jobject {};
+class _jstring : public _jobject {};
+class _jthrowable : public _jobject {};
+class _jarray : public _jobject {};
+class _jbyteArray : public _jarray {};
+class _jintArray : public _jarray {};
+class _jlongArray : public _jarray {};
+class _jfloatArray : public _jarray {};
+class _jobjectArray : public _jarray {};
+
+typedef _jobject* jobject;
+typedef _jclass* jclass;
+typedef _jstring* jstring;
+typedef _jthrowable* jthrowable;
+typedef _jarray* jarray;
+typedef _jbyteArray* jbyteArray;
+typedef _jintArray* jintArray;
+typedef _jlongArray* jlongArray;
+typedef _jfloatArray* jfloatArray;
+typedef _jobjectArray* jobjectArray;
+typedef jobject jweak;
+
+typedef struct _jfieldID* jfieldID;
+typedef struct _jmethodID* jmethodID;
+
+typedef struct {
+    const char* name;
+    const char* signature;
+    void* fnPtr;
+} JNINativeMethod;
+
+#define JNI_FALSE 0
+#define JNI_TRUE 1
+
+#define JNI_OK 0
+#define JNI_ERR (-1)
+#define JNI_EDETACHED (-2)
+#define JNI_EVERSION (-3)
+
+#define JNI_ABORT 2
+
+#define JNI_VERSION_1_1 0x00010001
+#define JNI_VERSION_1_2 0x00010002
+#define JNI_VERSION_1_4 0x00010004
+#define JNI_VERSION_1_6 0x00010006
+
+#define JNIEXPORT __attribute__((visibility("default")))
+#define JNICALL
+
+struct _JavaVM;
+typedef _JavaVM JavaVM;
+
+// A method taking any arguments and returning a zero R.
+#define JNI_HOST_METHOD(R, name) \
+    template <class... Args>     \
+    R name(Args...) {            \
+        using Result = R;        \
+        return Result();         \
+    }
+
+struct _JNIEnv {
+    JNI_HOST_METHOD(jboolean, CallBooleanMethod)
+    JNI_HOST_METHOD(jfloat, CallFloatMethod)
+    JNI_HOST_METHOD(jint, CallIntMethod)
+    JNI_HOST_METHOD(jlong, CallLongMethod)
+    JNI_HOST_METHOD(jobject, CallObjectMethod)
+    JNI_HOST_METHOD(jint, CallStaticIntMethod)
+    JNI_HOST_METHOD(jobject, CallStaticObjectMethod)
+    JNI_HOST_METHOD(void, CallStaticVoidMethod)
+    JNI_HOST_METHOD(void, CallVoidMethod)
+    JNI_HOST_METHOD(void, DeleteGlobalRef)
+    JNI_HOST_METHOD(void, DeleteLocalRef)
+    JNI_HOST_METHOD(jboolean, ExceptionCheck)
+    JNI_HOST_METHOD(void, ExceptionClear)
+    JNI_HOST_METHOD(void, ExceptionDescribe)
+    JNI_HOST_METHOD(jthrowable, ExceptionOccurred)
+    JNI_HOST_METHOD(jclass, FindClass)
+    JNI_HOST_METHOD(jsize, GetArrayLength)
+    JNI_HOST_METHOD(jfieldID, GetFieldID)
+    JNI_HOST_METHOD(jint*, GetIntArrayElements)
+    JNI_HOST_METHOD(jint, GetIntField)
+    JNI_HOST_METHOD(jlong*, GetLongArrayElements)
+    JNI_HOST_METHOD(jmethodID, GetMethodID)
+    JNI_HOST_METHOD(jclass, GetObjectClass)
+    JNI_HOST_METHOD(jobject, GetObjectField)
+    JNI_HOST_METHOD(jfieldID, GetStaticFieldID)
+    JNI_HOST_METHOD(jint, GetStaticIntField)
+    JNI_HOST_METHOD(jmethodID, GetStaticMethodID)
+    JNI_HOST_METHOD(jobject, GetStaticObjectField)
+    JNI_HOST_METHOD(const char*, GetStringUTFChars)
+    JNI_HOST_METHOD(jsize, GetStringUTFLength)
+    JNI_HOST_METHOD(jobject, NewDirectByteBuffer)
+    JNI_HOST_METHOD(jobject, NewGlobalRef)
+    JNI_HOST_METHOD(jobject, NewObject)
+    JNI_HOST_METHOD(jstring, NewStringUTF)
+    JNI_HOST_METHOD(jint, RegisterNatives)
+    JNI_HOST_METHOD(void, ReleaseIntArrayElements)
+    JNI_HOST_METHOD(void, ReleaseLongArrayElements)
+    JNI_HOST_METHOD(void, ReleaseStringUTFChars)
+
+    jint GetJavaVM(JavaVM** vm) {
+        *vm = nullptr;
+        return JNI_OK;
+    }
+};
+typedef _JNIEnv JNIEnv;
+
+struct _JavaVM {
+    JNI_HOST_METHOD(jint, AttachCurrentThread)
+    JNI_HOST_METHOD(jint, DetachCurrentThread)
+    JNI_HOST_METHOD(jint, GetEnv)
+};
+
+#undef JNI_HOST_METHOD
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// The part of bionic's sys/system_properties.h used by Swappy, for a Linux
+// host. See fake_ndk.cpp for the implementation, in which no property is set.
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PROP_VALUE_MAX 92
+
+typedef struct prop_info prop_info;
+
+int __system_property_get(const char* name, char* value);
+const prop_info* __system_property_find(const char* name);
+void __system_property_read_callback(
+    const prop_info* pi,
+    void (*callback)(void* cookie, const char* name, const char* value,
+                     uint32_t serial),
+    void* cookie);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// The part of vulkan/vulkan.h used by SwappyVk, for a Linux host without the
+// Vulkan headers. The tests give Swappy fake device functions.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define VK_NULL_HANDLE 0
+#define VK_TRUE 1
+
+#define VK_DEFINE_HANDLE(object) typedef struct object##_T* object;
+
+VK_DEFINE_HANDLE(VkInstance)
+VK_DEFINE_HANDLE(VkPhysicalDevice)
+VK_DEFINE_HANDLE(VkDevice)
+VK_DEFINE_HANDLE(VkQueue)
+VK_DEFINE_HANDLE(VkCommandBuffer)
+VK_DEFINE_HANDLE(VkCommandPool)
+VK_DEFINE_HANDLE(VkFence)
+VK_DEFINE_HANDLE(VkSemaphore)
+VK_DEFINE_HANDLE(VkEvent)
+VK_DEFINE_HANDLE(VkSwapchainKHR)
+
+typedef uint32_t VkBool32;
+typedef uint32_t VkFlags;
+typedef VkFlags VkPipelineStageFlags;
+
+typedef enum VkResult {
+    VK_SUCCESS = 0,
+    VK_NOT_READY = 1,
+    VK_TIMEOUT = 2,
+    VK_INCOMPLETE = 5,
+    VK_ERROR_INITIALIZATION_FAILED = -3,
+} VkResult;
+
+typedef enum VkStructureType {
+    VK_STRUCTURE_TYPE_SUBMIT_INFO = 4,
+    VK_STRUCTURE_TYPE_FENCE_CREATE_INFO = 8,
+    VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO = 9,
+    VK_STRUCTURE_TYPE_EVENT_CREATE_INFO = 10,
+    VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO = 39,
+    VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO = 40,
+    VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO = 42,
+    VK_STRUCTURE_TYPE_PRESENT_INFO_KHR = 1000001001,
+    VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE = 1000092000,
+} VkStructureType;
+
+typedef enum VkCommandBufferLevel {
+    VK_COMMAND_BUFFER_LEVEL_PRIMARY = 0,
+} VkCommandBufferLevel;
+
+enum {
+    VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT = 0x4,
+    VK_FENCE_CREATE_SIGNALED_BIT = 0x1,
+    VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT = 0x400,
+    VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT = 0x2000,
+};
+
+typedef struct VkAllocationCallbacks VkAllocationCallbacks;
+typedef struct VkCommandBufferInheritanceInfo VkCommandBufferInheritanceInfo;
+typedef struct VkDeviceCreateInfo VkDeviceCreateInfo;
+
+typedef struct VkCommandPoolCreateInfo {
+    VkStructureType sType;
+    const void* pNext;
+    VkFlags flags;
+    uint32_t queueFamilyIndex;
+} VkCommandPoolCreateInfo;
+
+typedef struct VkCommandBufferAllocateInfo {
+    VkStructureType sType;
+    const void* pNext;
+    VkCommandPool commandPool;
+    VkCommandBufferLevel level;
+    uint32_t commandBufferCount;
+} VkCommandBufferAllocateInfo;
+
+typedef struct VkCommandBufferBeginInfo {
+    VkStructureType sType;
+    const void* pNext;
+    VkFlags flags;
+    const VkCommandBufferInheritanceInfo* pInheritanceInfo;
+} VkCommandBufferBeginInfo;
+
+typedef struct VkFenceCreateInfo {
+    VkStructureType sType;
+    const void* pNext;
+    VkFlags flags;
+} VkFenceCreateInfo;
+
+typedef struct VkSemaphoreCreateInfo {
+    VkStructureType sType;
+    const void* pNext;
+    VkFlags flags;
+} VkSemaphoreCreateInfo;
+
+typedef struct VkEventCreateInfo {
+    VkStructureType sType;
+    const void* pNext;
+    VkFlags flags;
+} VkEventCreateInfo;
+
+typedef struct VkSubmitInfo {
+    VkStructureType sType;
+    const void* pNext;
+    uint32_t waitSemaphoreCount;
+    const VkSemaphore* pWaitSemaphores;
+    const VkPipelineStageFlags* pWaitDstStageMask;
+    uint32_t commandBufferCount;
+    const VkCommandBuffer* pCommandBuffers;
+    uint32_t signalSemaphoreCount;
+    const VkSemaphore* pSignalSemaphores;
+} VkSubmitInfo;
+
+typedef struct VkPresentInfoKHR {
+    VkStructureType sType;
+    const void* pNext;
+    uint32_t waitSemaphoreCount;
+    const VkSemaphore* pWaitSemaphores;
+    uint32_t swapchainCount;
+    const VkSwapchainKHR* pSwapchains;
+    const uint32_t* pImageIndices;
+    VkResult* pResults;
+} VkPresentInfoKHR;
+
+typedef struct VkExtensionProperties {
+    char extensionName[256];
+    uint32_t specVersion;
+} VkExtensionProperties;
+
+typedef struct VkRefreshCycleDurationGOOGLE {
+    uint64_t refreshDuration;
+} VkRefreshCycleDurationGOOGLE;
+
+typedef struct VkPastPresentationTimingGOOGLE {
+    uint32_t presentID;
+    uint64_t desiredPresentTime;
+    uint64_t actualPresentTime;
+    uint64_t earliestPresentTime;
+    uint64_t presentMargin;
+} VkPastPresentationTimingGOOGLE;
+
+typedef struct VkPresentTimeGOOGLE {
+    uint32_t presentID;
+    uint64_t desiredPresentTime;
+} VkPresentTimeGOOGLE;
+
+typedef struct VkPresentTimesInfoGOOGLE {
+    VkStructureType sType;
+    const void* pNext;
+    uint32_t swapchainCount;
+    const VkPresentTimeGOOGLE* pTimes;
+} VkPresentTimesInfoGOOGLE;
+
+typedef void (*PFN_vkVoidFunction)(void);
+typedef PFN_vkVoidFunction (*PFN_vkGetDeviceProcAddr)(VkDevice device,
+                                                      const char* pName);
+typedef VkResult (*PFN_vkCreateCommandPool)(
+    VkDevice device, const VkCommandPoolCreateInfo* pCreateInfo,
+    const VkAllocationCallbacks* pAllocator, VkCommandPool* pCommandPool);
+typedef void (*PFN_vkDestroyCommandPool)(
+    VkDevice device, VkCommandPool commandPool,
+    const VkAllocationCallbacks* pAllocator);
+typedef VkResult (*PFN_vkCreateFence)(VkDevice device,
+                                      const VkFenceCreateInfo* pCreateInfo,
+                                      const VkAllocationCallbacks* pAllocator,
+                                      VkFence* pFence);
+typedef void (*PFN_vkDestroyFence)(VkDevice device, VkFence fence,
+                                   const VkAllocationCallbacks* pAllocator);
+typedef VkResult (*PFN_vkWaitForFences)(VkDevice device, uint32_t fenceCount,
+                                        const VkFence* pFences,
+                                        VkBool32 waitAll, uint64_t timeout);
+typedef VkResult (*PFN_vkGetFenceStatus)(VkDevice device, VkFence fence);
+typedef VkResult (*PFN_vkResetFences)(VkDevice device, uint32_t fenceCount,
+                                      const VkFence* pFences);
+typedef VkResult (*PFN_vkCreateSemaphore)(
+    VkDevice device, const VkSemaphoreCreateInfo* pCreateInfo,
+    const VkAllocationCallbacks* pAllocator, VkSemaphore* pSemaphore);
+typedef void (*PFN_vkDestroySemaphore)(VkDevice device, VkSemaphore semaphore,
+                                       const VkAllocationCallbacks* pAllocator);
+typedef VkResult (*PFN_vkCreateEvent)(VkDevice device,
+                                      const VkEventCreateInfo* pCreateInfo,
+                                      const VkAllocationCallbacks* pAllocator,
+                                      VkEvent* pEvent);
+typedef void (*PFN_vkDestroyEvent)(VkDevice device, VkEvent event,
+                                   const VkAllocationCallbacks* pAllocator);
+typedef void (*PFN_vkCmdSetEvent)(VkCommandBuffer commandBuffer, VkEvent event,
+                                  VkPipelineStageFlags stageMask);
+typedef VkResult (*PFN_vkAllocateCommandBuffers)(
+    VkDevice device, const VkCommandBufferAllocateInfo* pAllocateInfo,
+    VkCommandBuffer* pCommandBuffers);
+typedef void (*PFN_vkFreeCommandBuffers)(
+    VkDevice device, VkCommandPool commandPool, uint32_t commandBufferCount,
+    const VkCommandBuffer* pCommandBuffers);
+typedef VkResult (*PFN_vkBeginCommandBuffer)(
+    VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo* pBeginInfo);
+typedef VkResult (*PFN_vkEndCommandBuffer)(VkCommandBuffer commandBuffer);
+typedef VkResult (*PFN_vkQueueSubmit)(VkQueue queue, uint32_t submitCount,
+                                      const VkSubmitInfo* pSubmits,
+                                      VkFence fence);
+typedef VkResult (*PFN_vkQueuePresentKHR)(
+    VkQueue queue, const VkPresentInfoKHR* pPresentInfo);
+typedef VkResult (*PFN_vkGetRefreshCycleDurationGOOGLE)(
+    VkDevice device, VkSwapchainKHR swapchain,
+    VkRefreshCycleDurationGOOGLE* pDisplayTimingProperties);
+typedef VkResult (*PFN_vkGetPastPresentationTimingGOOGLE)(
+    VkDevice device, VkSwapchainKHR swapchain,
+    uint32_t* pPresentationTimingCount,
+    VkPastPresentationTimingGOOGLE* pPresentationTimings);
@@ -0,0 +1,221 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Low latency mode: the LateWakeScheduler on simulated workloads, reporting
+// input-to-present latency against missed frames, and SwappyCommon delaying
+// the start of real frames.
+
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "common/LateWakeScheduler.h"
+#include "common/Settings.h"
+#include "common/SwappyCommon.h"
+#include "gtest/gtest.h"
+
+using namespace swappy;
+using namespace std::chrono_literals;
+using std::chrono::nanoseconds;
+
+namespace late_wake_test {
+
+constexpr nanoseconds kRefreshPeriod = 16666667ns;
+
+using Workload = std::function<nanoseconds(int frame)>;
+
+struct SimulationResult {
+    double averageLatencyMs;
+    int missedFrames;
+};
+
+// Simulates frames paced at 60Hz with a swap interval of 1. A frame reads its
+// input when it starts, and its work has to be done by the next vsync to be
+// presented one vsync later. A late frame is queued at the first vsync after
+// its work is done.
+SimulationResult simulate(const Workload& workload, bool lateWake,
+                          int frames) {
+    LateWakeScheduler scheduler;
+    int64_t vsync = 0;
+    nanoseconds totalLatency = 0ns;
+    int missedFrames = 0;
+    for (int i = 0; i < frames; ++i) {
+        const nanoseconds ready = vsync * kRefreshPeriod;
+        const nanoseconds deadline = (vsync + 1) * kRefreshPeriod;
+        const nanoseconds start =
+            ready + (lateWake ? scheduler.getWakeDelay(deadline - ready) : 0ns);
+        const nanoseconds work = workload(i);
+        const nanoseconds end = start + work;
+        const bool missed = end > deadline;
+        const int64_t queueVsync =
+            missed ? (end.count() + kRefreshPeriod.count() - 1) /
+                         kRefreshPeriod.count()
+                   : vsync + 1;
+        const nanoseconds present = (queueVsync + 1) * kRefreshPeriod;
+
+        totalLatency += present - start;
+        if (missed) missedFrames++;
+        scheduler.onFrameEnd(work, missed);
+        vsync = queueVsync;
+    }
+    return {std::chrono::duration<double, std::milli>(totalLatency).count() /
+                frames,
+            missedFrames};
+}
+
+class SwappyCommonTest : public SwappyCommon {
+   public:
+    SwappyCommonTest(const SwappyCommonSettings& settings)
+        : SwappyCommon(settings) {}
+};
+
+// Deterministic pseudo random work times in [min, max].
+Workload noisy(nanoseconds min, nanoseconds max) {
+    return [min, max](int frame) {
+        const uint32_t hash = static_cast<uint32_t>(frame) * 2654435761u;
+        return min + (max - min) * (hash % 1001) / 1000;
+    };
+}
+
+}  // namespace late_wake_test
+
+using namespace late_wake_test;
+
+TEST(LateWakeSchedulerTest, WaitsForSamplesAndFallsBackOnMiss) {
+    LateWakeScheduler scheduler;
+    for (size_t i = 0; i < LateWakeScheduler::MIN_SAMPLES - 1; ++i) {
+        scheduler.onFrameEnd(4ms, false);
+        EXPECT_EQ(scheduler.getWakeDelay(16ms), 0ns);
+    }
+    scheduler.onFrameEnd(5ms, false);
+    EXPECT_EQ(scheduler.getPredictedWorkTime(), 5ms);
+    EXPECT_EQ(scheduler.getWakeDelay(16ms),
+              16ms - 5ms - LateWakeScheduler::MIN_MARGIN);
+    // Never negative.
+    EXPECT_EQ(scheduler.getWakeDelay(3ms), 0ns);
+
+    // A miss doubles the margin and starts frames right away until the history
+    // has been refilled.
+    scheduler.onFrameEnd(6ms, true);
+    EXPECT_EQ(scheduler.getMargin(), 2 * LateWakeScheduler::MIN_MARGIN);
+    for (size_t i = 0; i < LateWakeScheduler::HISTORY_SIZE; ++i) {
+        EXPECT_EQ(scheduler.getWakeDelay(16ms), 0ns);
+        scheduler.onFrameEnd(4ms, false);
+    }
+    EXPECT_EQ(scheduler.getPredictedWorkTime(), 4ms);
+    EXPECT_EQ(scheduler.getWakeDelay(16ms),
+              16ms - 4ms - 2 * LateWakeScheduler::MIN_MARGIN);
+
+    // The margin decays back once frames make their deadline.
+    for (int i = 0; i < 10 * LateWakeScheduler::MARGIN_DECAY_FRAMES; ++i) {
+        scheduler.onFrameEnd(4ms, false);
+    }
+    EXPECT_EQ(scheduler.getMargin(), LateWakeScheduler::MIN_MARGIN);
+
+    // Repeated misses are capped.
+    for (int i = 0; i < 10; ++i) scheduler.onFrameEnd(20ms, true);
+    EXPECT_EQ(scheduler.getMargin(), LateWakeScheduler::MAX_MARGIN);
+}
+
+TEST(LateWakeSchedulerTest, SimulatedLatencyVersusMissedFrames) {
+    constexpr int kFrames = 6000;
+    struct Case {
+        const char* name;
+        Workload workload;
+        // Misses allowed on top of the ones happening without late wake.
+        int allowedExtraMisses;
+    };
+    const Case cases[] = {
+        {"steady 4ms", [](int) { return nanoseconds(4ms); }, 0},
+        {"noisy 3-8ms", noisy(3ms, 8ms), 0},
+        {"noisy 8-14ms", noisy(8ms, 14ms), kFrames / 100},
+        // Spikes that nothing predicts: each one is missed once.
+        {"4ms, 14ms every 120 frames",
+         [](int frame) { return frame % 120 == 119 ? 14ms : 4ms; },
+         kFrames / 120 + 1},
+    };
+
+    printf("%-28s %16s %16s\n", "workload", "baseline", "late wake");
+    for (const auto& c : cases) {
+        SCOPED_TRACE(c.name);
+        const auto baseline = simulate(c.workload, false, kFrames);
+        const auto late = simulate(c.workload, true, kFrames);
+        printf("%-28s %8.2fms %5d %8.2fms %5d\n", c.name,
+               baseline.averageLatencyMs, baseline.missedFrames,
+               late.averageLatencyMs, late.missedFrames);
+
+        EXPECT_LE(late.missedFrames,
+                  baseline.missedFrames + c.allowedExtraMisses);
+        EXPECT_LT(late.averageLatencyMs, baseline.averageLatencyMs - 1.0);
+    }
+}
+
+TEST(LateWakeSchedulerTest, SwappyCommonStartsFramesLate) {
+    constexpr int kFrames = 60;
+    constexpr int kWarmUpFrames = 20;
+    constexpr auto kCpuTime = 2ms;
+    const SwappyCommonSettings settings{
+        {0, 0},          // SDK version
+        kRefreshPeriod,  // refresh period
+        0ns,             // app vsync offset
+        0ns              // sf vsync offset
+    };
+    const SwappyCommon::SwapHandlers handlers = {
+        .lastFrameIsComplete = [](void*) { return true; },
+        .getPrevFrameGpuTime = [](void*) -> nanoseconds { return 0ns; },
+        .userData = nullptr,
+    };
+
+    // Average time from the start of a frame to its swap.
+    auto measure = [&](bool lowLatencyMode) {
+        Settings::getInstance()->reset();
+        SwappyCommonTest common(settings);
+        common.setAutoSwapInterval(false);
+        common.enableLowLatencyMode(lowLatencyMode);
+
+        std::atomic<bool> running = {true};
+        std::thread choreographer([&]() {
+            while (running) {
+                common.onChoreographer(0);
+                std::this_thread::sleep_for(kRefreshPeriod);
+            }
+        });
+
+        nanoseconds total = 0ns;
+        for (int i = 0; i < kFrames; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            std::this_thread::sleep_for(kCpuTime);
+            common.onPreSwap(handlers);
+            if (i >= kWarmUpFrames) {
+                total += std::chrono::steady_clock::now() - start;
+            }
+            common.onPostSwap(handlers);
+        }
+
+        running = false;
+        choreographer.join();
+        return std::chrono::duration<double, std::milli>(total).count() /
+               (kFrames - kWarmUpFrames);
+    };
+
+    const double baseline = measure(false);
+    const double late = measure(true);
+    printf("Frame start to swap: %.2fms, %.2fms in low latency mode\n",
+           baseline, late);
+    EXPECT_LT(late, baseline * 0.6);
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Plans over a synthetic 60/90/120/144Hz display.
+
+#include <cstdio>
+
+#include "common/RefreshRatePlanner.h"
+#include "gtest/gtest.h"
+
+using namespace swappy;
+using namespace std::chrono_literals;
+
+namespace refresh_rate_planner_test {
+
+constexpr auto k60Hz = 16666667ns;
+constexpr auto k90Hz = 11111111ns;
+constexpr auto k120Hz = 8333333ns;
+constexpr auto k144Hz = 6944444ns;
+
+const RefreshRatePlanner::RefreshPeriodMap kModes = {
+    {k60Hz, 1}, {k90Hz, 2}, {k120Hz, 3}, {k144Hz, 4}};
+
+using Clock = std::chrono::steady_clock;
+
+struct Expected {
+    std::chrono::nanoseconds refreshPeriod;
+    int32_t swapInterval;
+};
+
+void expectPlan(const RefreshRatePlanner::Option* plan, Expected expected) {
+    ASSERT_NE(plan, nullptr);
+    EXPECT_EQ(plan->refreshPeriod, expected.refreshPeriod);
+    EXPECT_EQ(plan->swapInterval, expected.swapInterval);
+    EXPECT_EQ(plan->modeId, kModes.at(expected.refreshPeriod));
+}
+
+}  // namespace refresh_rate_planner_test
+
+using namespace refresh_rate_planner_test;
+
+TEST(RefreshRatePlannerTest, OptionsTable) {
+    RefreshRatePlanner planner;
+    EXPECT_EQ(planner.plan(10ms, 0ns, Clock::now()), nullptr);
+
+    planner.setSupportedRefreshPeriods(kModes);
+    const auto& options = planner.getOptions();
+    // 6 intervals at 60Hz, 9 at 90Hz, 12 at 120Hz and 14 at 144Hz fit in
+    // MAX_SWAP_DURATION.
+    ASSERT_EQ(options.size(), 6u + 9u + 12u + 14u);
+    for (size_t i = 0; i < options.size(); ++i) {
+        const auto& option = options[i];
+        EXPECT_EQ(option.swapDuration,
+                  option.refreshPeriod * option.swapInterval);
+        EXPECT_EQ(option.modeId, kModes.at(option.refreshPeriod));
+        EXPECT_NEAR(option.powerCost, 1e9 / option.refreshPeriod.count(), 1);
+        if (i > 0) {
+            EXPECT_LE(options[i - 1].swapDuration, option.swapDuration);
+        }
+    }
+}
+
+TEST(RefreshRatePlannerTest, PicksShortestSwapDurationThenLowestPower) {
+    struct Case {
+        std::chrono::nanoseconds frameTime;
+        std::chrono::nanoseconds minSwapDuration;
+        Expected expected;
+    };
+    const Case cases[] = {
+        // 120Hz with a swap interval of 2 is as fast but costs more power.
+        {15ms, 0ns, {k60Hz, 1}},
+        {10ms, 0ns, {k90Hz, 1}},
+        {8ms, 0ns, {k120Hz, 1}},
+        {6ms, 0ns, {k144Hz, 1}},
+        {20ms, 0ns, {k144Hz, 3}},
+        // Capped at 30 FPS: all modes but 144Hz can do it.
+        {5ms, 33333333ns, {k60Hz, 2}},
+        // Frames longer than MAX_SWAP_DURATION are planned at 10 FPS.
+        {200ms, 0ns, {k60Hz, 6}},
+    };
+
+    RefreshRatePlanner planner;
+    planner.setSupportedRefreshPeriods(kModes);
+    for (const auto& c : cases) {
+        SCOPED_TRACE(c.frameTime.count());
+        planner.reset();
+        expectPlan(planner.plan(c.frameTime, c.minSwapDuration, Clock::now()),
+                   c.expected);
+        EXPECT_TRUE(planner.isPlanned(c.expected.refreshPeriod + 50us));
+    }
+}
+
+TEST(RefreshRatePlannerTest, HoldsOptionalModeSwitches) {
+    RefreshRatePlanner planner;
+    planner.setSupportedRefreshPeriods(kModes);
+    const auto start = Clock::now();
+
+    expectPlan(planner.plan(15ms, 0ns, start), {k60Hz, 1});
+
+    // 90Hz would be faster, but 60Hz still keeps up: wait for the workload to
+    // be stable before switching.
+    expectPlan(planner.plan(10ms, 0ns, start), {k60Hz, 1});
+    expectPlan(planner.plan(10ms, 0ns, start + 500ms), {k60Hz, 1});
+    const auto holdEnd = start + RefreshRatePlanner::MODE_SWITCH_HOLD_TIME;
+    expectPlan(planner.plan(10ms, 0ns, holdEnd), {k90Hz, 1});
+    EXPECT_TRUE(planner.isPlanned(k90Hz));
+    EXPECT_FALSE(planner.isPlanned(k60Hz));
+}
+
+TEST(RefreshRatePlannerTest, SwitchesImmediatelyWhenBehind) {
+    RefreshRatePlanner planner;
+    planner.setSupportedRefreshPeriods(kModes);
+    const auto start = Clock::now();
+
+    expectPlan(planner.plan(15ms, 0ns, start), {k60Hz, 1});
+    expectPlan(planner.plan(20ms, 0ns, start), {k144Hz, 3});
+
+    // The current mode can present as fast as the best one by changing the
+    // swap interval: no mode switch.
+    planner.reset();
+    expectPlan(planner.plan(8ms, 0ns, start), {k120Hz, 1});
+    expectPlan(planner.plan(15ms, 0ns, start), {k120Hz, 2});
+
+    // Moving to 60Hz only saves power, so it is held.
+    expectPlan(planner.plan(15ms, 0ns, start + 500ms), {k120Hz, 2});
+    expectPlan(planner.plan(15ms, 0ns, start + 1500ms), {k60Hz, 1});
+}
+
+TEST(RefreshRatePlannerTest, FewerModeSwitchesThanGreedy) {
+    constexpr int kFrames = 1000;
+    RefreshRatePlanner planner;
+    RefreshRatePlanner greedy;
+    planner.setSupportedRefreshPeriods(kModes);
+    greedy.setSupportedRefreshPeriods(kModes);
+
+    // Frame times between 10.5 and 11.5ms, around the 90Hz refresh period.
+    int plannerSwitches = 0;
+    int greedySwitches = 0;
+    int plannerMode = -1;
+    int greedyMode = -1;
+    auto now = Clock::now();
+    for (int i = 0; i < kFrames; ++i) {
+        const auto frameTime = 11ms + ((i * 7) % 5 - 2) * 250us;
+
+        const auto* plan = planner.plan(frameTime, 0ns, now);
+        ASSERT_NE(plan, nullptr);
+        if (plan->modeId != plannerMode) plannerSwitches++;
+        plannerMode = plan->modeId;
+        // The plan always keeps up with the frame time.
+        EXPECT_GE(plan->swapDuration + 500ns, frameTime);
+
+        greedy.reset();
+        const auto* greedyPlan = greedy.plan(frameTime, 0ns, now);
+        ASSERT_NE(greedyPlan, nullptr);
+        if (greedyPlan->modeId != greedyMode) greedySwitches++;
+        greedyMode = greedyPlan->modeId;
+
+        now += plan->swapDuration;
+    }
+
+    printf("Mode switches over %d frames: %d planned, %d greedy\n", kFrames,
+           plannerSwitches, greedySwitches);
+    EXPECT_LE(plannerSwitches, 2);
+    EXPECT_GT(greedySwitches, kFrames / 10);
+}
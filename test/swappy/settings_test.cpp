@@ -0,0 +1,220 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Settings snapshots: consistency under concurrent readers, SwappyCommon
+// picking up changes at frame boundaries while they are published, and
+// instances destroyed while others still use the settings.
+
+#include "common/Settings.h"
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "common/SwappyCommon.h"
+#include "gtest/gtest.h"
+
+using namespace swappy;
+using namespace std::chrono_literals;
+using std::chrono::nanoseconds;
+
+namespace settings_test {
+
+constexpr int kSettingsChanges = 10000;
+constexpr nanoseconds k60HzPeriod = 16666667ns;
+constexpr nanoseconds k90HzPeriod = 11111111ns;
+
+class SwappyCommonTest : public SwappyCommon {
+   public:
+    SwappyCommonTest(const SwappyCommonSettings& settings)
+        : SwappyCommon(settings) {}
+};
+
+}  // namespace settings_test
+
+using namespace settings_test;
+
+TEST(SettingsTest, ReadersSeeConsistentSnapshots) {
+    Settings::reset();
+    Settings* settings = Settings::getInstance();
+    const uint64_t startVersion = settings->getVersion();
+
+    std::atomic<bool> running = {true};
+    std::atomic<int> inconsistent = {0};
+    std::atomic<int> reads = {0};
+    auto reader = [&]() {
+        uint64_t lastVersion = 0;
+        while (running) {
+            // A snapshot loaded after a version is at least that recent.
+            const uint64_t version = settings->getVersion();
+            const auto snapshot = settings->getSnapshot();
+            // The writer keeps appOffset at half the refresh period.
+            const auto& timings = snapshot->displayTimings;
+            if (timings.appOffset * 2 != timings.refreshPeriod ||
+                snapshot->version < lastVersion ||
+                snapshot->version < version) {
+                inconsistent++;
+            }
+            lastVersion = snapshot->version;
+            reads++;
+        }
+    };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 2; ++i) readers.emplace_back(reader);
+    while (reads == 0) std::this_thread::yield();
+
+    for (int i = 1; i <= kSettingsChanges; ++i) {
+        settings->setDisplayTimings({i * 2ns, i * 1ns, 0ns});
+    }
+    running = false;
+    for (auto& thread : readers) thread.join();
+
+    EXPECT_EQ(inconsistent, 0);
+    EXPECT_EQ(settings->getVersion(), startVersion + kSettingsChanges);
+    EXPECT_EQ(settings->getSnapshot()->version,
+              startVersion + kSettingsChanges);
+    EXPECT_EQ(settings->getDisplayTimings().refreshPeriod,
+              kSettingsChanges * 2ns);
+    Settings::reset();
+}
+
+TEST(SettingsTest, SwappyCommonAppliesChangesAtFrameBoundaries) {
+    const SwappyCommonSettings commonSettings{
+        {0, 0},       // SDK version
+        k60HzPeriod,  // refresh period
+        0ns,          // app vsync offset
+        0ns           // sf vsync offset
+    };
+    const SwappyCommon::SwapHandlers handlers = {
+        .lastFrameIsComplete = [](void*) { return true; },
+        .getPrevFrameGpuTime = [](void*) -> nanoseconds { return 0ns; },
+        .userData = nullptr,
+    };
+
+    Settings::reset();
+    SwappyCommonTest common(commonSettings);
+    common.setAutoSwapInterval(false);
+
+    std::atomic<bool> running = {true};
+    std::thread choreographer([&]() {
+        while (running) {
+            common.onChoreographer(0);
+            std::this_thread::sleep_for(k60HzPeriod);
+        }
+    });
+
+    // Frames keep running while the settings change under them.
+    std::atomic<bool> changing = {true};
+    std::atomic<int> framesWhileChanging = {0};
+    std::thread settingsWriter([&]() {
+        Settings* settings = Settings::getInstance();
+        for (int i = 0; i < kSettingsChanges; ++i) {
+            switch (i % 3) {
+                case 0:
+                    settings->setDisplayTimings(
+                        {i % 2 ? k90HzPeriod : k60HzPeriod, 0ns, 0ns});
+                    break;
+                case 1:
+                    settings->setSwapDuration(
+                        (i % 2 ? k60HzPeriod : 2 * k60HzPeriod).count());
+                    break;
+                case 2:
+                    settings->setUseAffinity(i % 2);
+                    break;
+            }
+            std::this_thread::sleep_for(50us);
+        }
+        changing = false;
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    while (changing) {
+        common.onPreSwap(handlers);
+        common.onPostSwap(handlers);
+        framesWhileChanging++;
+    }
+    settingsWriter.join();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    printf("%d settings changes in %.0fms, %d frames\n", kSettingsChanges,
+           std::chrono::duration<double, std::milli>(elapsed).count(),
+           framesWhileChanging.load());
+    EXPECT_GT(framesWhileChanging, 0);
+
+    // The latest settings are applied on the next frame.
+    Settings::getInstance()->setDisplayTimings({k60HzPeriod, 0ns, 0ns});
+    Settings::getInstance()->setSwapDuration((2 * k60HzPeriod).count());
+    common.onPreSwap(handlers);
+    common.onPostSwap(handlers);
+    EXPECT_EQ(common.getRefreshPeriod(), k60HzPeriod);
+    EXPECT_EQ(common.getSwapDuration(), 2 * k60HzPeriod);
+
+    running = false;
+    choreographer.join();
+}
+
+TEST(SettingsTest, DestroyingOneSwappyCommonKeepsTheSettingsOfOthers) {
+    const SwappyCommonSettings commonSettings{
+        {0, 0},       // SDK version
+        k60HzPeriod,  // refresh period
+        0ns,          // app vsync offset
+        0ns           // sf vsync offset
+    };
+    const SwappyCommon::SwapHandlers handlers = {
+        .lastFrameIsComplete = [](void*) { return true; },
+        .getPrevFrameGpuTime = [](void*) -> nanoseconds { return 0ns; },
+        .userData = nullptr,
+    };
+
+    Settings::reset();
+    auto common = std::make_unique<SwappyCommonTest>(commonSettings);
+    common->setAutoSwapInterval(false);
+    Settings::getInstance()->setSwapDuration((2 * k60HzPeriod).count());
+
+    // The frames and choreographer ticks of one instance keep reading the
+    // settings while other instances come and go.
+    std::atomic<bool> running = {true};
+    std::thread choreographer([&]() {
+        while (running) {
+            common->onChoreographer(0);
+            std::this_thread::sleep_for(1ms);
+        }
+    });
+    std::thread frames([&]() {
+        while (running) {
+            common->onPreSwap(handlers);
+            common->onPostSwap(handlers);
+        }
+    });
+    for (int i = 0; i < 20; ++i) {
+        SwappyCommonTest other(commonSettings);
+        std::this_thread::sleep_for(1ms);
+    }
+    running = false;
+    choreographer.join();
+    frames.join();
+
+    EXPECT_EQ(Settings::getInstance()->getSwapDuration(), 2 * k60HzPeriod);
+    EXPECT_EQ(Settings::getInstance()->getDisplayTimings().refreshPeriod,
+              k60HzPeriod);
+
+    // The last one restores the defaults.
+    common.reset();
+    EXPECT_EQ(Settings::getInstance()->getSwapDuration(),
+              Settings::Snapshot().swapDuration);
+    EXPECT_EQ(Settings::getInstance()->getDisplayTimings().refreshPeriod, 0ns);
+}
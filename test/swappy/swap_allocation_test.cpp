@@ -0,0 +1,174 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Checks that the per-swap path of SwappyGL (fence insertion, pre/post swap
+// pacing and frame statistics capture) does not touch the heap. EGL is
+// replaced by the fake function table in fake_egl.h so this runs without a
+// GPU.
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+#include "common/Settings.h"
+#include "common/SwappyCommon.h"
+#include "fake_egl.h"
+#include "gtest/gtest.h"
+#include "opengl/EGL.h"
+#include "opengl/FrameStatisticsGL.h"
+
+using namespace swappy;
+
+namespace {
+
+thread_local bool sCountAllocations = false;
+std::atomic<int> sAllocationCount = {0};
+
+void* countedAlloc(size_t size) {
+    if (sCountAllocations) ++sAllocationCount;
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) abort();
+    return p;
+}
+
+}  // anonymous namespace
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+namespace swap_allocation_test {
+
+class SwappyCommonTest : public SwappyCommon {
+   public:
+    SwappyCommonTest(const SwappyCommonSettings& settings)
+        : SwappyCommon(settings) {}
+};
+
+struct SwapContext {
+    SwappyCommon* common;
+    EGL* egl;
+    EGLDisplay display;
+};
+
+void nopTracer(void*) {}
+void postWaitTracer(void*, int64_t, int64_t) {}
+void postSwapTracer(void*, int64_t) {}
+void startFrameTracer(void*, int, int64_t) {}
+
+}  // namespace swap_allocation_test
+
+using namespace swap_allocation_test;
+
+TEST(SwappyAllocationTest, CounterIsHooked) {
+    sAllocationCount = 0;
+    sCountAllocations = true;
+    int* volatile p = new int(1);
+    sCountAllocations = false;
+    delete p;
+    EXPECT_EQ(sAllocationCount, 1);
+}
+
+TEST(SwappyAllocationTest, GLSwapPathDoesNotAllocate) {
+    constexpr int kWarmupFrames = 30;
+    constexpr int kMeasuredFrames = 120;
+    const SwappyCommonSettings settings{
+        {0, 0},      // SDK version
+        16666667ns,  // refresh period
+        0ns,         // app vsync offset
+        0ns          // sf vsync offset
+    };
+
+    Settings::getInstance()->reset();
+    fake_egl::reset(0ns);
+    auto common = std::make_unique<SwappyCommonTest>(settings);
+    auto egl = EGL::create(common->getFenceTimeout(),
+                           fake_egl::getProcAddress, fake_egl::swapBuffers);
+    ASSERT_NE(egl, nullptr);
+    ASSERT_TRUE(egl->statsSupported());
+
+    FrameStatisticsGL stats(*egl, *common);
+    stats.enableStats(true);
+
+    SwappyTracer tracer = {nopTracer,      postWaitTracer,   nopTracer,
+                           postSwapTracer, startFrameTracer, nullptr,
+                           nopTracer};
+    common->addTracerCallbacks(tracer);
+
+    std::atomic<bool> running = {true};
+    std::thread choreographer([&]() {
+        while (running) {
+            common->onChoreographer(0);
+            std::this_thread::sleep_for(settings.refreshPeriod);
+        }
+    });
+
+    const EGLDisplay display = reinterpret_cast<EGLDisplay>(1);
+    const EGLSurface surface = reinterpret_cast<EGLSurface>(2);
+    SwapContext context = {common.get(), egl.get(), display};
+    const SwappyCommon::SwapHandlers handlers = {
+        .lastFrameIsComplete =
+            [](void* userData) {
+                auto context = static_cast<SwapContext*>(userData);
+                return context->egl->lastFrameIsComplete(
+                    context->display,
+                    context->common->getCurrentPipelineMode() ==
+                        SwappyCommon::PipelineMode::On);
+            },
+        .getPrevFrameGpuTime =
+            [](void* userData) {
+                return static_cast<SwapContext*>(userData)
+                    ->egl->getFencePendingTime();
+            },
+        .userData = &context,
+    };
+
+    // Mirrors SwappyGL::swapInternal followed by SwappyGL::recordFrameStart.
+    auto swapFrame = [&]() {
+        egl->insertSyncFence(display, surface);
+        common->onPreSwap(handlers);
+        if (common->needToSetPresentationTime()) {
+            egl->setPresentationTime(display, surface,
+                                     common->getPresentationTime());
+        }
+        egl->swapBuffers(display, surface);
+        common->onPostSwap(handlers);
+        if (auto timings = stats.capture(display, surface)) {
+            common->onFramePresented(timings->desiredPresentTime,
+                                     timings->actualPresentTime);
+        }
+    };
+
+    for (int i = 0; i < kWarmupFrames; ++i) swapFrame();
+
+    sAllocationCount = 0;
+    sCountAllocations = true;
+    for (int i = 0; i < kMeasuredFrames; ++i) swapFrame();
+    sCountAllocations = false;
+    const int allocations = sAllocationCount;
+
+    running = false;
+    choreographer.join();
+    common.reset();
+
+    EXPECT_EQ(allocations, 0) << allocations << " allocations in "
+                              << kMeasuredFrames << " frames";
+    EXPECT_GT(stats.getStats().totalFrames, 0u);
+}
@@ -0,0 +1,419 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Presents to two swapchains of the same device at different rates, through a
+// mock SwappyVkFunctionProvider.
+
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "SwappyVkFallback.h"
+#include "common/Settings.h"
+#include "gtest/gtest.h"
+
+using namespace swappy;
+using namespace std::chrono_literals;
+
+namespace swappyvk_multi_swapchain_test {
+
+// Fake driver: objects are plain counters, fences are always signaled and
+// presents are recorded.
+std::atomic<uint64_t> nextHandle = {1};
+
+template <typename T>
+T newHandle() {
+    // Non-dispatchable handles are pointers on 64-bit and integers on 32-bit.
+    return (T)(uintptr_t)nextHandle++;
+}
+
+std::mutex fakeMutex;
+std::map<VkSwapchainKHR, std::vector<std::chrono::steady_clock::time_point>>
+    presents;
+// Presents that didn't wait for a semaphore injected by Swappy, so were not
+// paced by a fence.
+std::map<VkSwapchainKHR, int> unfencedPresents;
+std::set<std::thread::id> fenceWaiters;
+// GPU time of the frames submitted to a queue.
+std::map<VkQueue, std::chrono::nanoseconds> queueGpuTimes;
+std::map<VkFence, VkQueue> fenceQueues;
+
+VkResult createCommandPool(VkDevice, const VkCommandPoolCreateInfo*,
+                           const VkAllocationCallbacks*, VkCommandPool* pool) {
+    *pool = newHandle<VkCommandPool>();
+    return VK_SUCCESS;
+}
+void destroyCommandPool(VkDevice, VkCommandPool, const VkAllocationCallbacks*) {
+}
+VkResult createFence(VkDevice, const VkFenceCreateInfo*,
+                     const VkAllocationCallbacks*, VkFence* fence) {
+    *fence = newHandle<VkFence>();
+    return VK_SUCCESS;
+}
+void destroyFence(VkDevice, VkFence, const VkAllocationCallbacks*) {}
+VkResult waitForFences(VkDevice, uint32_t, const VkFence* pFences, VkBool32,
+                       uint64_t) {
+    std::chrono::nanoseconds gpuTime = 0ns;
+    {
+        std::lock_guard<std::mutex> lock(fakeMutex);
+        fenceWaiters.insert(std::this_thread::get_id());
+        auto it = fenceQueues.find(pFences[0]);
+        if (it != fenceQueues.end()) gpuTime = queueGpuTimes[it->second];
+    }
+    std::this_thread::sleep_for(gpuTime);
+    return VK_SUCCESS;
+}
+VkResult getFenceStatus(VkDevice, VkFence) { return VK_SUCCESS; }
+VkResult resetFences(VkDevice, uint32_t, const VkFence*) { return VK_SUCCESS; }
+VkResult createSemaphore(VkDevice, const VkSemaphoreCreateInfo*,
+                         const VkAllocationCallbacks*, VkSemaphore* semaphore) {
+    *semaphore = newHandle<VkSemaphore>();
+    return VK_SUCCESS;
+}
+void destroySemaphore(VkDevice, VkSemaphore, const VkAllocationCallbacks*) {}
+VkResult createEvent(VkDevice, const VkEventCreateInfo*,
+                     const VkAllocationCallbacks*, VkEvent* event) {
+    *event = newHandle<VkEvent>();
+    return VK_SUCCESS;
+}
+void destroyEvent(VkDevice, VkEvent, const VkAllocationCallbacks*) {}
+void cmdSetEvent(VkCommandBuffer, VkEvent, VkPipelineStageFlags) {}
+VkResult allocateCommandBuffers(VkDevice, const VkCommandBufferAllocateInfo*,
+                                VkCommandBuffer* command) {
+    *command = newHandle<VkCommandBuffer>();
+    return VK_SUCCESS;
+}
+void freeCommandBuffers(VkDevice, VkCommandPool, uint32_t,
+                        const VkCommandBuffer*) {}
+VkResult beginCommandBuffer(VkCommandBuffer, const VkCommandBufferBeginInfo*) {
+    return VK_SUCCESS;
+}
+VkResult endCommandBuffer(VkCommandBuffer) { return VK_SUCCESS; }
+VkResult queueSubmit(VkQueue queue, uint32_t, const VkSubmitInfo*,
+                     VkFence fence) {
+    std::lock_guard<std::mutex> lock(fakeMutex);
+    fenceQueues[fence] = queue;
+    return VK_SUCCESS;
+}
+VkResult queuePresentKHR(VkQueue, const VkPresentInfoKHR* pPresentInfo) {
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(fakeMutex);
+    for (uint32_t i = 0; i < pPresentInfo->swapchainCount; i++) {
+        presents[pPresentInfo->pSwapchains[i]].push_back(now);
+        // The test presents don't wait for any semaphore of their own.
+        if (pPresentInfo->waitSemaphoreCount == 0) {
+            unfencedPresents[pPresentInfo->pSwapchains[i]]++;
+        }
+    }
+    return VK_SUCCESS;
+}
+
+void* getProcAddr(const char* name);
+
+PFN_vkVoidFunction getDeviceProcAddr(VkDevice, const char* name) {
+    return reinterpret_cast<PFN_vkVoidFunction>(getProcAddr(name));
+}
+
+void* getProcAddr(const char* name) {
+    static const std::map<std::string, void*> functions = {
+        {"vkGetDeviceProcAddr", reinterpret_cast<void*>(getDeviceProcAddr)},
+        {"vkCreateCommandPool", reinterpret_cast<void*>(createCommandPool)},
+        {"vkDestroyCommandPool", reinterpret_cast<void*>(destroyCommandPool)},
+        {"vkCreateFence", reinterpret_cast<void*>(createFence)},
+        {"vkDestroyFence", reinterpret_cast<void*>(destroyFence)},
+        {"vkWaitForFences", reinterpret_cast<void*>(waitForFences)},
+        {"vkGetFenceStatus", reinterpret_cast<void*>(getFenceStatus)},
+        {"vkResetFences", reinterpret_cast<void*>(resetFences)},
+        {"vkCreateSemaphore", reinterpret_cast<void*>(createSemaphore)},
+        {"vkDestroySemaphore", reinterpret_cast<void*>(destroySemaphore)},
+        {"vkCreateEvent", reinterpret_cast<void*>(createEvent)},
+        {"vkDestroyEvent", reinterpret_cast<void*>(destroyEvent)},
+        {"vkCmdSetEvent", reinterpret_cast<void*>(cmdSetEvent)},
+        {"vkAllocateCommandBuffers",
+         reinterpret_cast<void*>(allocateCommandBuffers)},
+        {"vkFreeCommandBuffers", reinterpret_cast<void*>(freeCommandBuffers)},
+        {"vkBeginCommandBuffer", reinterpret_cast<void*>(beginCommandBuffer)},
+        {"vkEndCommandBuffer", reinterpret_cast<void*>(endCommandBuffer)},
+        {"vkQueueSubmit", reinterpret_cast<void*>(queueSubmit)},
+        {"vkQueuePresentKHR", reinterpret_cast<void*>(queuePresentKHR)},
+    };
+    auto it = functions.find(name);
+    return it != functions.end() ? it->second : nullptr;
+}
+
+bool init() { return true; }
+void close() {}
+
+const SwappyVkFunctionProvider kFunctionProvider = {init, getProcAddr, close};
+
+class SwappyVkTest : public SwappyVkFallback {
+   public:
+    SwappyVkTest(const SwappyCommonSettings& settings)
+        : SwappyVkFallback(settings, newHandle<VkPhysicalDevice>(),
+                           newHandle<VkDevice>(), &kFunctionProvider) {}
+
+    void onChoreographer() { mCommonBase.onChoreographer(0); }
+    std::chrono::nanoseconds gpuTime(VkSwapchainKHR swapchain) {
+        return getLastFenceTime(swapchain);
+    }
+};
+
+VkPresentInfoKHR makePresentInfo(const VkSwapchainKHR* pSwapchain,
+                                 const uint32_t* pImageIndex) {
+    return {VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+            nullptr,
+            0,
+            nullptr,
+            1,
+            pSwapchain,
+            pImageIndex,
+            nullptr};
+}
+
+void resetFakeDriver() {
+    std::lock_guard<std::mutex> lock(fakeMutex);
+    presents.clear();
+    unfencedPresents.clear();
+    fenceWaiters.clear();
+    queueGpuTimes.clear();
+    fenceQueues.clear();
+}
+
+std::chrono::nanoseconds averageInterval(
+    const std::vector<std::chrono::steady_clock::time_point>& times) {
+    if (times.size() < 2) return 0ns;
+    return (times.back() - times.front()) / (times.size() - 1);
+}
+
+}  // namespace swappyvk_multi_swapchain_test
+
+using namespace swappyvk_multi_swapchain_test;
+
+TEST(SwappyVkMultiSwapchainTest, SharedPacingAtDifferentRates) {
+    constexpr auto kRefreshPeriod = 16666667ns;
+    constexpr int kMainFrames = 60;
+    constexpr int kExternalFrames = 30;
+    const SwappyCommonSettings settings{
+        {0, 0},          // SDK version
+        kRefreshPeriod,  // refresh period
+        0ns,             // app vsync offset
+        0ns              // sf vsync offset
+    };
+
+    Settings::getInstance()->reset();
+    LoadVulkanFunctions(&kFunctionProvider);
+    resetFakeDriver();
+
+    SwappyVkTest swappy(settings);
+    swappy.setAutoSwapInterval(false);
+
+    const VkSwapchainKHR mainSwapchain = newHandle<VkSwapchainKHR>();
+    const VkSwapchainKHR externalSwapchain = newHandle<VkSwapchainKHR>();
+    swappy.addSwapchain(mainSwapchain);
+    swappy.addSwapchain(externalSwapchain);
+
+    // The main display runs at 60Hz and the external one at 30Hz.
+    swappy.doSetSwapInterval(mainSwapchain, kRefreshPeriod.count());
+    swappy.doSetSwapInterval(externalSwapchain, 2 * kRefreshPeriod.count());
+    EXPECT_EQ(swappy.getSwapInterval(mainSwapchain), kRefreshPeriod);
+    EXPECT_EQ(swappy.getSwapInterval(externalSwapchain), 2 * kRefreshPeriod);
+
+    std::atomic<bool> running = {true};
+    std::thread choreographer([&]() {
+        while (running) {
+            swappy.onChoreographer();
+            std::this_thread::sleep_for(kRefreshPeriod);
+        }
+    });
+
+    // Each output is presented from its own thread, on its own queue.
+    auto presentLoop = [&swappy](VkSwapchainKHR swapchain, int frames) {
+        return std::thread([&swappy, swapchain, frames]() {
+            const VkQueue queue = newHandle<VkQueue>();
+            const uint32_t imageIndex = 0;
+            const VkPresentInfoKHR presentInfo =
+                makePresentInfo(&swapchain, &imageIndex);
+            for (int i = 0; i < frames; ++i) {
+                EXPECT_EQ(swappy.doQueuePresent(queue, 0, &presentInfo),
+                          VK_SUCCESS);
+            }
+        });
+    };
+    std::thread mainThread = presentLoop(mainSwapchain, kMainFrames);
+    std::thread externalThread =
+        presentLoop(externalSwapchain, kExternalFrames);
+    mainThread.join();
+    externalThread.join();
+
+    running = false;
+    choreographer.join();
+
+    std::lock_guard<std::mutex> lock(fakeMutex);
+    ASSERT_EQ(presents[mainSwapchain].size(), static_cast<size_t>(kMainFrames));
+    ASSERT_EQ(presents[externalSwapchain].size(),
+              static_cast<size_t>(kExternalFrames));
+
+    // Each swapchain keeps its own swap interval on the shared vsync.
+    EXPECT_NEAR(averageInterval(presents[mainSwapchain]).count(),
+                kRefreshPeriod.count(),
+                std::chrono::nanoseconds(3ms).count());
+    EXPECT_NEAR(averageInterval(presents[externalSwapchain]).count(),
+                2 * kRefreshPeriod.count(),
+                std::chrono::nanoseconds(5ms).count());
+
+    // The fences of both queues are waited for by a single thread.
+    EXPECT_EQ(fenceWaiters.size(), 1u);
+}
+
+TEST(SwappyVkMultiSwapchainTest, SharedQueue) {
+    constexpr auto kRefreshPeriod = 16666667ns;
+    constexpr auto kGpuTime = 6ms;
+    constexpr int kMainFrames = 60;
+    constexpr int kExternalFrames = 30;
+    const SwappyCommonSettings settings{
+        {0, 0},          // SDK version
+        kRefreshPeriod,  // refresh period
+        0ns,             // app vsync offset
+        0ns              // sf vsync offset
+    };
+
+    Settings::getInstance()->reset();
+    LoadVulkanFunctions(&kFunctionProvider);
+    resetFakeDriver();
+
+    SwappyVkTest swappy(settings);
+    swappy.setAutoSwapInterval(false);
+
+    const VkSwapchainKHR mainSwapchain = newHandle<VkSwapchainKHR>();
+    const VkSwapchainKHR externalSwapchain = newHandle<VkSwapchainKHR>();
+    swappy.addSwapchain(mainSwapchain);
+    swappy.addSwapchain(externalSwapchain);
+    swappy.doSetSwapInterval(mainSwapchain, kRefreshPeriod.count());
+    swappy.doSetSwapInterval(externalSwapchain, 2 * kRefreshPeriod.count());
+
+    // Both outputs are presented on the same queue, which is the usual case.
+    const VkQueue queue = newHandle<VkQueue>();
+    {
+        std::lock_guard<std::mutex> lock(fakeMutex);
+        queueGpuTimes[queue] = kGpuTime;
+    }
+
+    std::atomic<bool> running = {true};
+    std::thread choreographer([&]() {
+        while (running) {
+            swappy.onChoreographer();
+            std::this_thread::sleep_for(kRefreshPeriod);
+        }
+    });
+
+    auto presentLoop = [&swappy, queue](VkSwapchainKHR swapchain,
+                                        int frames) {
+        return std::thread([&swappy, queue, swapchain, frames]() {
+            const uint32_t imageIndex = 0;
+            const VkPresentInfoKHR presentInfo =
+                makePresentInfo(&swapchain, &imageIndex);
+            for (int i = 0; i < frames; ++i) {
+                EXPECT_EQ(swappy.doQueuePresent(queue, 0, &presentInfo),
+                          VK_SUCCESS);
+            }
+        });
+    };
+    std::thread mainThread = presentLoop(mainSwapchain, kMainFrames);
+    std::thread externalThread =
+        presentLoop(externalSwapchain, kExternalFrames);
+    mainThread.join();
+    externalThread.join();
+
+    running = false;
+    choreographer.join();
+
+    std::lock_guard<std::mutex> lock(fakeMutex);
+    ASSERT_EQ(presents[mainSwapchain].size(), static_cast<size_t>(kMainFrames));
+    ASSERT_EQ(presents[externalSwapchain].size(),
+              static_cast<size_t>(kExternalFrames));
+
+    // Each swapchain has fences of its own, so none runs out of them because
+    // of the other.
+    EXPECT_EQ(unfencedPresents[mainSwapchain], 0);
+    EXPECT_EQ(unfencedPresents[externalSwapchain], 0);
+
+    // The frames of one output don't hold back the other.
+    EXPECT_NEAR(averageInterval(presents[mainSwapchain]).count(),
+                kRefreshPeriod.count(),
+                std::chrono::nanoseconds(3ms).count());
+    EXPECT_NEAR(averageInterval(presents[externalSwapchain]).count(),
+                2 * kRefreshPeriod.count(),
+                std::chrono::nanoseconds(5ms).count());
+}
+
+TEST(SwappyVkMultiSwapchainTest, GpuTimePerSwapchain) {
+    constexpr auto kRefreshPeriod = 16666667ns;
+    constexpr auto kMainGpuTime = 1ms;
+    constexpr auto kExternalGpuTime = 10ms;
+    const SwappyCommonSettings settings{
+        {0, 0},          // SDK version
+        kRefreshPeriod,  // refresh period
+        0ns,             // app vsync offset
+        0ns              // sf vsync offset
+    };
+
+    Settings::getInstance()->reset();
+    LoadVulkanFunctions(&kFunctionProvider);
+    resetFakeDriver();
+
+    SwappyVkTest swappy(settings);
+    swappy.enableFramePacing(false);
+
+    const VkSwapchainKHR mainSwapchain = newHandle<VkSwapchainKHR>();
+    const VkSwapchainKHR externalSwapchain = newHandle<VkSwapchainKHR>();
+    swappy.addSwapchain(mainSwapchain);
+    swappy.addSwapchain(externalSwapchain);
+
+    const VkQueue mainQueue = newHandle<VkQueue>();
+    const VkQueue externalQueue = newHandle<VkQueue>();
+    {
+        std::lock_guard<std::mutex> lock(fakeMutex);
+        queueGpuTimes[mainQueue] = kMainGpuTime;
+        queueGpuTimes[externalQueue] = kExternalGpuTime;
+    }
+
+    const uint32_t imageIndex = 0;
+    const VkPresentInfoKHR mainPresent =
+        makePresentInfo(&mainSwapchain, &imageIndex);
+    const VkPresentInfoKHR externalPresent =
+        makePresentInfo(&externalSwapchain, &imageIndex);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(swappy.doQueuePresent(externalQueue, 0, &externalPresent),
+                  VK_SUCCESS);
+        EXPECT_EQ(swappy.doQueuePresent(mainQueue, 0, &mainPresent),
+                  VK_SUCCESS);
+    }
+    // Let the fence thread catch up with the last frames.
+    std::this_thread::sleep_for(4 * kExternalGpuTime);
+
+    // The slow frames of the external display don't show up in the GPU time
+    // that paces the main one.
+    EXPECT_GE(swappy.gpuTime(mainSwapchain), kMainGpuTime);
+    EXPECT_LT(swappy.gpuTime(mainSwapchain), kExternalGpuTime);
+    EXPECT_GE(swappy.gpuTime(externalSwapchain), kExternalGpuTime);
+
+    swappy.removeSwapchain(externalSwapchain);
+    EXPECT_EQ(swappy.gpuTime(externalSwapchain), 0ns);
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "Trace.h"
+#include "TraceRecorder.h"
+#include "gtest/gtest.h"
+
+using namespace gamesdk;
+
+namespace {
+
+using EventType = TraceRecorder::EventType;
+
+void emitFrame(int frame) {
+    gamesdk::ScopedTrace trace("frame");
+    Trace::getInstance()->beginAsyncSection("async", frame);
+    TRACE_INT("counter", frame);
+    Trace::getInstance()->endAsyncSection("async", frame);
+}
+
+size_t countSubstrings(const std::string& s, const char* pattern) {
+    size_t count = 0;
+    for (size_t pos = s.find(pattern); pos != std::string::npos;
+         pos = s.find(pattern, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+}  // anonymous namespace
+
+TEST(TraceRecorderTest, RecordsOnlyWhileStarted) {
+    auto recorder = TraceRecorder::getInstance();
+    recorder->stop();
+    EXPECT_FALSE(TRACE_ENABLED() && TraceRecorder::isRecording());
+    emitFrame(0);
+
+    recorder->start();
+    EXPECT_TRUE(TRACE_ENABLED());
+    emitFrame(1);
+    recorder->stop();
+    emitFrame(2);
+
+    auto threads = recorder->snapshot();
+    ASSERT_EQ(threads.size(), 1u);
+    const auto& events = threads[0].events;
+    ASSERT_EQ(events.size(), 5u);
+    EXPECT_EQ(events[0].type, EventType::Begin);
+    EXPECT_STREQ(events[0].name, "frame");
+    EXPECT_EQ(events[1].type, EventType::AsyncBegin);
+    EXPECT_EQ(events[1].value, 1);
+    EXPECT_EQ(events[2].type, EventType::Counter);
+    EXPECT_STREQ(events[2].name, "counter");
+    EXPECT_EQ(events[2].value, 1);
+    EXPECT_EQ(events[3].type, EventType::AsyncEnd);
+    EXPECT_EQ(events[4].type, EventType::End);
+    for (size_t i = 1; i < events.size(); ++i) {
+        EXPECT_LE(events[i - 1].timestampNs, events[i].timestampNs);
+    }
+
+    // Starting again discards the previous recording.
+    recorder->start();
+    recorder->stop();
+    EXPECT_TRUE(recorder->snapshot().empty());
+}
+
+TEST(TraceRecorderTest, PerThreadBuffersAndDroppedEvents) {
+    constexpr int kThreads = 4;
+    constexpr int kFrames = 100;
+    auto recorder = TraceRecorder::getInstance();
+    // Room for 2 frames more than the number of events each thread emits.
+    recorder->start(5 * (kFrames - 2));
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([]() {
+            for (int i = 0; i < kFrames; ++i) emitFrame(i);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    recorder->stop();
+
+    auto recorded = recorder->snapshot();
+    ASSERT_EQ(recorded.size(), static_cast<size_t>(kThreads));
+    for (const auto& thread : recorded) {
+        EXPECT_EQ(thread.events.size(), 5u * (kFrames - 2));
+        EXPECT_EQ(thread.dropped, 10u);
+    }
+}
+
+TEST(TraceRecorderTest, ExportsChromeJson) {
+    auto recorder = TraceRecorder::getInstance();
+    recorder->start();
+    emitFrame(7);
+    recorder->stop();
+
+    std::string json;
+    recorder->exportChromeJson(json);
+    EXPECT_EQ(json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["), 0u);
+    EXPECT_EQ(countSubstrings(json, "\"ph\":\"B\""), 1u);
+    EXPECT_EQ(countSubstrings(json, "\"ph\":\"E\""), 1u);
+    EXPECT_EQ(countSubstrings(json, "\"ph\":\"b\""), 1u);
+    EXPECT_EQ(countSubstrings(json, "\"ph\":\"e\""), 1u);
+    EXPECT_EQ(countSubstrings(json, "\"id\":\"0x7\""), 2u);
+    EXPECT_NE(json.find("{\"name\":\"counter\",\"ph\":\"C\","
+                        "\"args\":{\"value\":7}"),
+              std::string::npos);
+}
+
+TEST(TraceRecorderTest, ExportsPerfetto) {
+    auto recorder = TraceRecorder::getInstance();
+    recorder->start();
+    emitFrame(7);
+    recorder->stop();
+
+    std::string trace;
+    recorder->exportPerfetto(trace);
+    ASSERT_FALSE(trace.empty());
+
+    // The output is a sequence of Trace.packet fields: walk them to check the
+    // framing. 1 clock snapshot, 3 track descriptors and 5 events.
+    size_t packets = 0;
+    size_t pos = 0;
+    while (pos < trace.size()) {
+        ASSERT_EQ(trace[pos++], 0x0a);  // field 1, length delimited
+        uint64_t length = 0;
+        int shift = 0;
+        uint8_t byte;
+        do {
+            ASSERT_LT(pos, trace.size());
+            byte = trace[pos++];
+            length |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        pos += length;
+        packets++;
+    }
+    EXPECT_EQ(pos, trace.size());
+    EXPECT_EQ(packets, 9u);
+    EXPECT_NE(trace.find("counter"), std::string::npos);
+    EXPECT_NE(trace.find("async"), std::string::npos);
+}
+
+TEST(TraceRecorderTest, ReusesBuffersOfExitedThreads) {
+    auto recorder = TraceRecorder::getInstance();
+    recorder->start(1024);
+    // The events of exited threads are kept until the next recording, so the
+    // second thread can't take over the buffer of the first.
+    std::thread([]() { emitFrame(0); }).join();
+    std::thread([]() { emitFrame(1); }).join();
+    recorder->stop();
+    EXPECT_EQ(recorder->snapshot().size(), 2u);
+    const size_t buffers = recorder->threadBufferCount();
+
+    // Short-lived threads of later recordings recycle those buffers.
+    for (int i = 0; i < 100; ++i) {
+        recorder->start(1024);
+        std::thread([i]() { emitFrame(i); }).join();
+    }
+    recorder->stop();
+    EXPECT_EQ(recorder->snapshot().size(), 1u);
+    EXPECT_EQ(recorder->threadBufferCount(), buffers);
+}
+
+TEST(TraceRecorderTest, CostPerEvent) {
+    constexpr int kEvents = 200000;
+    constexpr int kRuns = 5;
+    auto recorder = TraceRecorder::getInstance();
+    recorder->start(kEvents);
+
+    // Warm up the thread buffer.
+    TRACE_INT("benchmark", 0);
+
+    // Keep the best run so that a descheduled thread doesn't fail the test.
+    double nsPerEvent = 0;
+    for (int run = 0; run < kRuns; ++run) {
+        recorder->start(kEvents);
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kEvents; ++i) {
+            TRACE_INT("benchmark", i);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        recorder->stop();
+        const double runNsPerEvent =
+            std::chrono::duration<double, std::nano>(elapsed).count() /
+            kEvents;
+        if (run == 0 || runNsPerEvent < nsPerEvent) {
+            nsPerEvent = runNsPerEvent;
+        }
+    }
+    printf("TraceRecorder: %.1f ns per event\n", nsPerEvent);
+
+    auto threads = recorder->snapshot();
+    ASSERT_EQ(threads.size(), 1u);
+    EXPECT_EQ(threads[0].events.size(), static_cast<size_t>(kEvents));
+    // Most of this is reading CLOCK_MONOTONIC.
+    EXPECT_LT(nsPerEvent, 50.0);
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Adds and removes tracers from several threads while frames are dispatched.
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "common/CopyOnWrite.h"
+#include "common/Settings.h"
+#include "common/SwappyCommon.h"
+#include "gtest/gtest.h"
+
+using namespace swappy;
+using namespace std::chrono_literals;
+
+namespace tracer_registry_test {
+
+class SwappyCommonTest : public SwappyCommon {
+   public:
+    SwappyCommonTest(const SwappyCommonSettings& settings)
+        : SwappyCommon(settings) {}
+};
+
+struct Counters {
+    std::atomic<int> preWait = {0};
+    std::atomic<int> postWait = {0};
+    std::atomic<int> preSwapBuffers = {0};
+    std::atomic<int> postSwapBuffers = {0};
+    std::atomic<int> startFrame = {0};
+};
+
+void countPreWait(void* userData) {
+    static_cast<Counters*>(userData)->preWait++;
+}
+void countPostWait(void* userData, int64_t, int64_t) {
+    static_cast<Counters*>(userData)->postWait++;
+}
+void countPreSwapBuffers(void* userData) {
+    static_cast<Counters*>(userData)->preSwapBuffers++;
+}
+void countPostSwapBuffers(void* userData, int64_t) {
+    static_cast<Counters*>(userData)->postSwapBuffers++;
+}
+void countStartFrame(void* userData, int, int64_t) {
+    static_cast<Counters*>(userData)->startFrame++;
+}
+
+// Removal is keyed on the function pointer, so each churning thread gets its
+// own function.
+template <int N>
+void churnPreWait(void* userData) {
+    static_cast<Counters*>(userData)->preWait++;
+}
+
+SwappyTracer makeTracer(Counters* counters) {
+    return {countPreWait,         countPostWait,   countPreSwapBuffers,
+            countPostSwapBuffers, countStartFrame, counters,
+            nullptr};
+}
+
+}  // namespace tracer_registry_test
+
+using namespace tracer_registry_test;
+
+TEST(CopyOnWriteTest, ReadersAlwaysSeeCompleteUpdates) {
+    constexpr int kWriters = 4;
+    constexpr int kUpdates = 2000;
+    CopyOnWrite<std::vector<int>> values;
+    std::atomic<bool> running = {true};
+    std::atomic<int> badSnapshots = {0};
+    std::atomic<int> reads = {0};
+
+    std::thread reader([&]() {
+        while (running) {
+            values.read([&](const std::vector<int>& v) {
+                // Every update adds or removes a pair summing to zero.
+                if (std::accumulate(v.begin(), v.end(), 0) != 0 ||
+                    v.size() % 2 != 0) {
+                    badSnapshots++;
+                }
+            });
+            reads++;
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < kWriters; ++w) {
+        writers.emplace_back([&values, w]() {
+            for (int i = 1; i <= kUpdates; ++i) {
+                const int value = w * kUpdates + i;
+                values.update([value](std::vector<int>& v) {
+                    v.push_back(value);
+                    v.push_back(-value);
+                });
+                if (i % 2 == 0) {
+                    values.update([value](std::vector<int>& v) {
+                        v.erase(std::remove_if(v.begin(), v.end(),
+                                               [value](int x) {
+                                                   return x == value ||
+                                                          x == -value;
+                                               }),
+                                v.end());
+                    });
+                }
+            }
+        });
+    }
+    for (auto& writer : writers) writer.join();
+    running = false;
+    reader.join();
+
+    size_t finalSize = 0;
+    values.read([&](const std::vector<int>& v) { finalSize = v.size(); });
+    EXPECT_EQ(badSnapshots, 0);
+    EXPECT_GT(reads, 0);
+    EXPECT_EQ(finalSize, static_cast<size_t>(kWriters * kUpdates));
+}
+
+TEST(SwappyTracerRegistryTest, ConcurrentAddRemoveDispatch) {
+    constexpr int kFrames = 2000;
+    const SwappyCommonSettings settings{
+        {0, 0},      // SDK version
+        16666667ns,  // refresh period
+        0ns,         // app vsync offset
+        0ns          // sf vsync offset
+    };
+
+    Settings::getInstance()->reset();
+    SwappyCommonTest common(settings);
+    // Dispatch as fast as possible, without waiting for vsync.
+    common.enableFramePacing(false);
+    common.enableBlockingWait(false);
+
+    Counters permanent;
+    common.addTracerCallbacks(makeTracer(&permanent));
+
+    Counters churned;
+    std::atomic<bool> running = {true};
+    auto churn = [&](auto function) {
+        return std::thread([&, function]() {
+            SwappyTracer tracer = {};
+            tracer.preWait = function;
+            tracer.userData = &churned;
+            while (running) {
+                common.addTracerCallbacks(tracer);
+                common.removeTracerCallbacks(tracer);
+            }
+        });
+    };
+    std::thread churn0 = churn(churnPreWait<0>);
+    std::thread churn1 = churn(churnPreWait<1>);
+    std::thread churn2 = churn(churnPreWait<2>);
+
+    const SwappyCommon::SwapHandlers handlers = {
+        .lastFrameIsComplete = [](void*) { return true; },
+        .getPrevFrameGpuTime = [](void*) -> std::chrono::nanoseconds {
+            return 1ms;
+        },
+        .userData = nullptr,
+    };
+    for (int i = 0; i < kFrames; ++i) {
+        common.onPreSwap(handlers);
+        common.onPostSwap(handlers);
+    }
+
+    running = false;
+    churn0.join();
+    churn1.join();
+    churn2.join();
+
+    // The permanent tracer must have seen every frame exactly once, no matter
+    // how the registry changed around it.
+    EXPECT_EQ(permanent.preWait, kFrames);
+    EXPECT_EQ(permanent.postWait, kFrames);
+    EXPECT_EQ(permanent.preSwapBuffers, kFrames);
+    EXPECT_EQ(permanent.postSwapBuffers, kFrames);
+    EXPECT_LE(permanent.startFrame, kFrames);
+    EXPECT_LE(churned.preWait, 3 * kFrames);
+
+    // All the churned tracers are gone.
+    const int churnedCalls = churned.preWait;
+    common.onPreSwap(handlers);
+    common.onPostSwap(handlers);
+    EXPECT_EQ(churned.preWait, churnedCalls);
+    EXPECT_EQ(permanent.preWait, kFrames + 1);
+
+    common.removeTracerCallbacks(makeTracer(&permanent));
+    common.onPreSwap(handlers);
+    common.onPostSwap(handlers);
+    EXPECT_EQ(permanent.preWait, kFrames + 1);
+}
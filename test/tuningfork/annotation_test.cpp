@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include "core/annotation_registry.h"
 #include "core/annotation_util.h"
 #include "gtest/gtest.h"
 
@@ -171,3 +172,30 @@ TEST(Annotation, WithLoadingAnnotationIndex) {
               57)
         << "Loading 21";
 }
+
+TEST(Annotation, RegistryHandles) {
+    tuningfork::AnnotationRegistry registry;
+    tuningfork::AnnotationHandle h1, h2, h3;
+    EXPECT_EQ(registry.GetOrRegister(1, {1 << 3, 1}, h1), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(registry.GetOrRegister(2, {1 << 3, 2}, h2), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(registry.GetOrRegister(1, {1 << 3, 1}, h3), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(h1, h3) << "Same annotation, same handle";
+    EXPECT_NE(h1, h2);
+    EXPECT_EQ(registry.Size(), 2u);
+    ASSERT_NE(registry.Get(h2), nullptr);
+    EXPECT_EQ(registry.Get(h2)->id, 2u);
+    EXPECT_EQ(registry.Get(2), nullptr) << "Unregistered handle";
+
+    // Handles in later blocks
+    const uint32_t n = 3 * tuningfork::AnnotationRegistry::kBlockSize;
+    for (uint32_t id = 3; id < n; ++id) {
+        tuningfork::AnnotationHandle h;
+        EXPECT_EQ(registry.GetOrRegister(id, {1 << 3, 1}, h),
+                  TUNINGFORK_ERROR_OK);
+        EXPECT_EQ(h, id - 1);
+    }
+    for (uint32_t h = 0; h < n - 1; ++h) {
+        ASSERT_NE(registry.Get(h), nullptr);
+        EXPECT_EQ(registry.Get(h)->id, h + 1);
+    }
+}
@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <chrono>
+#include <cstdio>
+
 #include "common.h"
 #include "test_utils.h"
 #include "tuningfork_test.h"
@@ -88,4 +91,80 @@ TEST(EndToEndTest, WithAnnotation) {
     CheckStrings("Annotation", result, ExpectedForAnnotationTest());
 }
 
+TEST(EndToEndTest, AnnotationHandles) {
+    auto settings =
+        TestSettings(tf::Settings::AggregationStrategy::Submission::TICK_BASED,
+                     100, 2, {3});
+    TuningForkTest test(settings, milliseconds(10));
+    std::vector<tf::ProtobufSerialization> serializations;
+    std::vector<tf::AnnotationHandle> handles;
+    for (auto level : {com::google::tuningfork::LEVEL_1,
+                       com::google::tuningfork::LEVEL_2,
+                       com::google::tuningfork::LEVEL_3}) {
+        Annotation ann;
+        ann.set_level(level);
+        serializations.push_back(tf::Serialize(ann));
+        tf::AnnotationHandle handle;
+        ASSERT_EQ(tf::RegisterAnnotation(serializations.back(), handle),
+                  TUNINGFORK_ERROR_OK);
+        handles.push_back(handle);
+    }
+    tf::AnnotationHandle again;
+    EXPECT_EQ(tf::RegisterAnnotation(serializations[1], again),
+              TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(again, handles[1]);
+    EXPECT_EQ(tf::SetCurrentAnnotation(tf::AnnotationHandle(1000)),
+              TUNINGFORK_ERROR_INVALID_ANNOTATION);
+
+    for (const auto& handle : handles) {
+        EXPECT_EQ(tf::SetCurrentAnnotation(handle), TUNINGFORK_ERROR_OK);
+    }
+
+    // Time switching through the C API by serialization and by handle.
+    std::vector<TuningFork_CProtobufSerialization> c_serializations;
+    for (auto& ser : serializations) {
+        c_serializations.push_back(
+            {ser.data(), static_cast<uint32_t>(ser.size()), nullptr});
+    }
+    constexpr int kSwitches = 100000;
+    int errors = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kSwitches; ++i) {
+        if (TuningFork_setCurrentAnnotation(&c_serializations[i % 3]) !=
+            TUNINGFORK_ERROR_OK)
+            ++errors;
+    }
+    std::chrono::duration<double> serialized =
+        std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kSwitches; ++i) {
+        if (TuningFork_setCurrentAnnotationHandle(handles[i % 3]) !=
+            TUNINGFORK_ERROR_OK)
+            ++errors;
+    }
+    std::chrono::duration<double> by_handle =
+        std::chrono::steady_clock::now() - start;
+    printf("Annotation switch: %.1fns serialized, %.1fns by handle\n",
+           serialized.count() / kSwitches * 1e9,
+           by_handle.count() / kSwitches * 1e9);
+    EXPECT_EQ(errors, 0);
+
+    // Frames are recorded against the annotation set by handle.
+    ASSERT_EQ(tf::SetCurrentAnnotation(handles[1]), TUNINGFORK_ERROR_OK);
+    const int NTICKS = 101;
+    std::unique_lock<std::mutex> lock(*test.rmutex_);
+    for (int i = 0; i < NTICKS; ++i) {
+        test.IncrementTime();
+        tf::FrameTick(TFTICK_PACED_FRAME_TIME);
+    }
+    EXPECT_TRUE(test.cv_->wait_for(lock, s_test_wait_time) ==
+                std::cv_status::no_timeout)
+        << "Timeout";
+
+    // LEVEL_2 serializes to CAI= where LEVEL_1 is CAE=.
+    TuningForkLogEvent expected = ExpectedForAnnotationTest();
+    expected.replace(expected.find("CAE="), 4, "CAI=");
+    CheckStrings("AnnotationHandles", test.Result(), expected);
+}
+
 }  // namespace tuningfork_test
@@ -15,6 +15,7 @@
  */
 
 #include "common.h"
+#include "core/live_trace_table.h"
 #include "test_utils.h"
 #include "tuningfork_test.h"
 
@@ -149,4 +150,31 @@ TEST(EndToEndTest, WithLoadingTimes) {
     CheckStrings("LoadingTimes", result, ExpectedResultWithLoading());
 }
 
+// Traces that end while loading aren't recorded, but must still free their
+// slot in the table of live traces.
+TEST(EndToEndTest, TraceEndedWhileLoading) {
+    auto settings =
+        TestSettings(tf::Settings::AggregationStrategy::Submission::TICK_BASED,
+                     100, 2, {}, {}, 0 /* use default */, 3);
+    TuningForkTest test(settings, milliseconds(10));
+    tf::SerializedAnnotation loading_annotation = {1, 2, 3};
+    for (uint32_t i = 0; i <= tf::LiveTraceTable::kNumSlots; ++i) {
+        tf::TraceHandle trace;
+        ASSERT_EQ(tf::StartTrace(TFTICK_PACED_FRAME_TIME, trace),
+                  TUNINGFORK_ERROR_OK);
+        tf::LoadingHandle loading_handle;
+        ASSERT_EQ(tf::StartRecordingLoadingTime(
+                      {tf::LoadingTimeMetadata::LoadingState::WARM_START,
+                       tf::LoadingTimeMetadata::LoadingSource::MEMORY},
+                      loading_annotation, loading_handle),
+                  TUNINGFORK_ERROR_OK);
+        ASSERT_EQ(tf::EndTrace(trace), TUNINGFORK_ERROR_OK);
+        EXPECT_EQ(tf::EndTrace(trace), TUNINGFORK_ERROR_OK)
+            << "Errors are ignored while loading";
+        ASSERT_EQ(tf::StopRecordingLoadingTime(loading_handle),
+                  TUNINGFORK_ERROR_OK);
+        EXPECT_EQ(tf::EndTrace(trace), TUNINGFORK_ERROR_INVALID_TRACE_HANDLE);
+    }
+}
+
 }  // namespace tuningfork_test
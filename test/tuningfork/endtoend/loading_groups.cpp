@@ -14,7 +14,13 @@
  * limitations under the License.
  */
 
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <thread>
+
 #include "common.h"
+#include "json11/json11.hpp"
 #include "test_utils.h"
 #include "tuningfork_test.h"
 
@@ -76,6 +82,7 @@ TuningForkLogEvent ExpectedResultWithLoadingGroups(bool use_stop,
     if (use_stop)
         extra_event += R"TF(
             {
+              "critical_path":"0.1s",
               "intervals":[{"end":"0.2s", "start":"0.1s"}],
               "loading_metadata":{
                 "group_id": )TF" +
@@ -229,4 +236,301 @@ TEST(EndToEndTest, WithLoadingGroupsWithAnnotation) {
         ExpectedResultWithLoadingGroups(use_stop_call, with_annotation));
 }
 
+// A thread that runs functions synchronously, so that a test can interleave
+// calls from several threads deterministically.
+class LoaderThread {
+   public:
+    LoaderThread() : thread_([this]() { Loop(); }) {}
+    ~LoaderThread() {
+        Run(nullptr);
+        thread_.join();
+    }
+    void Run(std::function<void()> f) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        bool quit = !f;
+        task_ = f ? std::move(f) : [this]() { quit_ = true; };
+        cv_.notify_all();
+        if (!quit) cv_.wait(lock, [this]() { return !task_; });
+    }
+
+   private:
+    void Loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!quit_) {
+            cv_.wait(lock, [this]() { return bool(task_); });
+            task_();
+            task_ = nullptr;
+            cv_.notify_all();
+        }
+    }
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::function<void()> task_;
+    bool quit_ = false;
+    std::thread thread_;
+};
+
+struct UploadedLoadingEvent {
+    int source;
+    int compression_level;
+    std::string group_id;
+    std::string parent_group_id;
+    std::string critical_path;
+    std::string start;
+    std::string end;
+};
+
+std::vector<UploadedLoadingEvent> UploadedLoadingEvents(
+    const TuningForkLogEvent& result) {
+    std::string error;
+    auto json = json11::Json::parse(result, error);
+    EXPECT_TRUE(error.empty()) << error;
+    std::vector<UploadedLoadingEvent> events;
+    for (auto& telemetry : json["telemetry"].array_items()) {
+        for (auto& e :
+             telemetry["report"]["loading"]["loading_events"].array_items()) {
+            auto& md = e["loading_metadata"];
+            auto& interval = e["intervals"][0];
+            events.push_back({md["source"].int_value(),
+                              md["compression_level"].int_value(),
+                              md["group_id"].string_value(),
+                              md["parent_group_id"].string_value(),
+                              e["critical_path"].string_value(),
+                              interval["start"].string_value(),
+                              interval["end"].string_value()});
+        }
+    }
+    return events;
+}
+
+// Group events all have the same source, so they are told apart by their
+// compression level in these tests.
+UploadedLoadingEvent FindLoadingEvent(
+    const std::vector<UploadedLoadingEvent>& events,
+    tf::LoadingTimeMetadata::LoadingSource source, int compression_level = 0) {
+    for (auto& e : events) {
+        if (e.source == source && e.compression_level == compression_level)
+            return e;
+    }
+    ADD_FAILURE() << "No loading event with source " << source
+                  << " and compression level " << compression_level;
+    return {};
+}
+
+void TickUntilUpload(TuningForkTest& test, int n_ticks) {
+    Annotation ann;
+    std::unique_lock<std::mutex> lock(*test.rmutex_);
+    for (int i = 0; i < n_ticks; ++i) {
+        test.IncrementTime();
+        ann.set_level(com::google::tuningfork::LEVEL_1);
+        tf::SetCurrentAnnotation(tf::Serialize(ann));
+        tf::FrameTick(TFTICK_PACED_FRAME_TIME);
+    }
+    // Wait for the upload thread to complete writing the string
+    EXPECT_TRUE(test.cv_->wait_for(lock, s_test_wait_time) ==
+                std::cv_status::no_timeout)
+        << "Timeout";
+}
+
+tf::LoadingTimeMetadata TestLoadingMetadata(
+    tf::LoadingTimeMetadata::LoadingSource source,
+    int32_t compression_level = 0) {
+    tf::LoadingTimeMetadata metadata{};
+    metadata.state = tf::LoadingTimeMetadata::LoadingState::INTER_LEVEL;
+    metadata.source = source;
+    metadata.compression_level = compression_level;
+    return metadata;
+}
+
+TEST(EndToEndTest, WithConcurrentLoadingGroups) {
+    using Source = tf::LoadingTimeMetadata::LoadingSource;
+    const int NTICKS = 101;
+    auto settings =
+        TestSettings(tf::Settings::AggregationStrategy::Submission::TICK_BASED,
+                     NTICKS - 1, 2, {}, {}, 0 /* use default */, 10);
+    TuningForkTest test(settings, milliseconds(10));
+    const int kLevel = 1, kGeometry = 2, kAudio = 3;
+    auto level_metadata = TestLoadingMetadata(Source::MEMORY, kLevel);
+    auto geometry_metadata = TestLoadingMetadata(Source::MEMORY, kGeometry);
+    auto audio_metadata = TestLoadingMetadata(Source::MEMORY, kAudio);
+    tf::LoadingHandle level, audio, geometry_load, audio_load, shader_load;
+    tf::ProtobufSerialization no_annotation;
+
+    // The level group is started on this thread and the geometry and audio
+    // groups on their own threads, at 0.1s.
+    LoaderThread geometry_thread, audio_thread;
+    ASSERT_EQ(tf::StartLoadingGroup(&level_metadata, nullptr, &level),
+              TUNINGFORK_ERROR_OK);
+    geometry_thread.Run([&]() {
+        EXPECT_EQ(tf::StartLoadingGroup(&geometry_metadata, nullptr, nullptr),
+                  TUNINGFORK_ERROR_OK);
+        EXPECT_EQ(tf::StartRecordingLoadingTime(
+                      TestLoadingMetadata(Source::DEVICE_STORAGE),
+                      no_annotation, geometry_load),
+                  TUNINGFORK_ERROR_OK);
+    });
+    audio_thread.Run([&]() {
+        EXPECT_EQ(tf::StartLoadingGroup(&audio_metadata, nullptr, &audio),
+                  TUNINGFORK_ERROR_OK);
+        EXPECT_EQ(
+            tf::StartRecordingLoadingTime(TestLoadingMetadata(Source::APK),
+                                          no_annotation, audio_load),
+            TUNINGFORK_ERROR_OK);
+    });
+    // Geometry finishes at 0.2s and audio at 0.3s.
+    test.IncrementTime(10);
+    geometry_thread.Run([&]() {
+        EXPECT_EQ(tf::StopRecordingLoadingTime(geometry_load),
+                  TUNINGFORK_ERROR_OK);
+        EXPECT_EQ(tf::StopLoadingGroup(0), TUNINGFORK_ERROR_OK);
+    });
+    test.IncrementTime(10);
+    audio_thread.Run([&]() {
+        EXPECT_EQ(tf::StopRecordingLoadingTime(audio_load),
+                  TUNINGFORK_ERROR_OK);
+        EXPECT_EQ(tf::StopLoadingGroup(audio), TUNINGFORK_ERROR_OK);
+    });
+    // Shaders are compiled from 0.35s to 0.4s, after an idle gap.
+    test.IncrementTime(5);
+    EXPECT_EQ(tf::StartRecordingLoadingTime(
+                  TestLoadingMetadata(Source::SHADER_COMPILATION),
+                  no_annotation, shader_load),
+              TUNINGFORK_ERROR_OK);
+    test.IncrementTime(5);
+    EXPECT_EQ(tf::StopRecordingLoadingTime(shader_load), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(tf::StopLoadingGroup(level), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(tf::StopLoadingGroup(level), TUNINGFORK_ERROR_BAD_PARAMETER);
+    EXPECT_EQ(tf::StopLoadingGroup(0),
+              TUNINGFORK_ERROR_NO_ACTIVE_LOADING_GROUP);
+
+    TickUntilUpload(test, NTICKS);
+    auto events = UploadedLoadingEvents(test.Result());
+    auto level_group =
+        FindLoadingEvent(events, Source::TOTAL_USER_WAIT_FOR_GROUP, kLevel);
+    auto geometry_group =
+        FindLoadingEvent(events, Source::TOTAL_USER_WAIT_FOR_GROUP, kGeometry);
+    auto audio_group =
+        FindLoadingEvent(events, Source::TOTAL_USER_WAIT_FOR_GROUP, kAudio);
+
+    // Loads are tagged with the current group of the thread they ran on.
+    EXPECT_EQ(FindLoadingEvent(events, Source::DEVICE_STORAGE).group_id,
+              geometry_group.group_id);
+    EXPECT_EQ(FindLoadingEvent(events, Source::APK).group_id,
+              audio_group.group_id);
+    EXPECT_EQ(FindLoadingEvent(events, Source::SHADER_COMPILATION).group_id,
+              level_group.group_id);
+
+    // Both streaming groups are children of the level group.
+    EXPECT_EQ(level_group.parent_group_id, "");
+    EXPECT_EQ(geometry_group.parent_group_id, level_group.group_id);
+    EXPECT_EQ(audio_group.parent_group_id, level_group.group_id);
+    EXPECT_EQ(geometry_group.end, "0.2s");
+    EXPECT_EQ(geometry_group.critical_path, "0.1s");
+    EXPECT_EQ(audio_group.end, "0.3s");
+    EXPECT_EQ(audio_group.critical_path, "0.2s");
+
+    // The critical path of the level group skips the idle gap and the
+    // geometry load, which ran in parallel with the longer audio load.
+    EXPECT_EQ(level_group.start, "0.1s");
+    EXPECT_EQ(level_group.end, "0.4s");
+    EXPECT_EQ(level_group.critical_path, "0.25s");
+}
+
+TEST(EndToEndTest, WithNestedLoadingGroups) {
+    using Source = tf::LoadingTimeMetadata::LoadingSource;
+    const int NTICKS = 101;
+    auto settings =
+        TestSettings(tf::Settings::AggregationStrategy::Submission::TICK_BASED,
+                     NTICKS - 1, 2, {}, {}, 0 /* use default */, 6);
+    TuningForkTest test(settings, milliseconds(10));
+    const int kOuter = 1, kInner = 2;
+    auto outer_metadata = TestLoadingMetadata(Source::MEMORY, kOuter);
+    auto inner_metadata = TestLoadingMetadata(Source::MEMORY, kInner);
+    tf::LoadingHandle outer, inner, load;
+    tf::ProtobufSerialization no_annotation;
+
+    // Starting a second group nests it in the first one instead of replacing
+    // it.
+    ASSERT_EQ(tf::StartLoadingGroup(&outer_metadata, nullptr, &outer),
+              TUNINGFORK_ERROR_OK);
+    test.IncrementTime(5);
+    ASSERT_EQ(tf::StartLoadingGroup(&inner_metadata, nullptr, &inner),
+              TUNINGFORK_ERROR_OK);
+    EXPECT_NE(outer, inner);
+    EXPECT_EQ(tf::StartRecordingLoadingTime(
+                  TestLoadingMetadata(Source::NETWORK), no_annotation, load),
+              TUNINGFORK_ERROR_OK);
+    test.IncrementTime(10);
+    EXPECT_EQ(tf::StopRecordingLoadingTime(load), TUNINGFORK_ERROR_OK);
+    // Stopping the inner group makes the outer one current again.
+    EXPECT_EQ(tf::StopLoadingGroup(0), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(tf::StartRecordingLoadingTime(
+                  TestLoadingMetadata(Source::DEVICE_STORAGE), no_annotation,
+                  load),
+              TUNINGFORK_ERROR_OK);
+    test.IncrementTime(5);
+    EXPECT_EQ(tf::StopRecordingLoadingTime(load), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(tf::StopLoadingGroup(0), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(tf::StopLoadingGroup(0),
+              TUNINGFORK_ERROR_NO_ACTIVE_LOADING_GROUP);
+
+    TickUntilUpload(test, NTICKS);
+    auto events = UploadedLoadingEvents(test.Result());
+    auto outer_group =
+        FindLoadingEvent(events, Source::TOTAL_USER_WAIT_FOR_GROUP, kOuter);
+    auto inner_group =
+        FindLoadingEvent(events, Source::TOTAL_USER_WAIT_FOR_GROUP, kInner);
+    EXPECT_EQ(inner_group.parent_group_id, outer_group.group_id);
+    EXPECT_EQ(FindLoadingEvent(events, Source::NETWORK).group_id,
+              inner_group.group_id);
+    EXPECT_EQ(FindLoadingEvent(events, Source::DEVICE_STORAGE).group_id,
+              outer_group.group_id);
+    EXPECT_EQ(inner_group.start, "0.15s");
+    EXPECT_EQ(inner_group.end, "0.25s");
+    EXPECT_EQ(inner_group.critical_path, "0.1s");
+    EXPECT_EQ(outer_group.start, "0.1s");
+    EXPECT_EQ(outer_group.end, "0.3s");
+    // The inner group, then the load that followed it.
+    EXPECT_EQ(outer_group.critical_path, "0.15s");
+}
+
+// A load and a group that are started before a session is submitted and
+// stopped after it are recorded in the next session, whose upload must still
+// see their metadata.
+TEST(EndToEndTest, WithLoadingAcrossFlush) {
+    using Source = tf::LoadingTimeMetadata::LoadingSource;
+    const int NTICKS = 101;
+    auto settings =
+        TestSettings(tf::Settings::AggregationStrategy::Submission::TICK_BASED,
+                     NTICKS - 1, 2, {}, {}, 0 /* use default */, 4);
+    TuningForkTest test(settings, milliseconds(10));
+    const int kLevel = 1;
+    auto level_metadata = TestLoadingMetadata(Source::MEMORY, kLevel);
+    tf::LoadingHandle level, load;
+    tf::ProtobufSerialization no_annotation;
+
+    ASSERT_EQ(tf::StartLoadingGroup(&level_metadata, nullptr, &level),
+              TUNINGFORK_ERROR_OK);
+    ASSERT_EQ(tf::StartRecordingLoadingTime(
+                  TestLoadingMetadata(Source::DEVICE_STORAGE), no_annotation,
+                  load),
+              TUNINGFORK_ERROR_OK);
+    TickUntilUpload(test, NTICKS);
+    EXPECT_TRUE(UploadedLoadingEvents(test.Result()).empty());
+
+    test.ClearResult();
+    EXPECT_EQ(tf::StopRecordingLoadingTime(load), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(tf::StopLoadingGroup(level), TUNINGFORK_ERROR_OK);
+    // The next submission recycles the metadata that isn't referenced by live
+    // loads or by the session being submitted.
+    TickUntilUpload(test, NTICKS);
+    auto events = UploadedLoadingEvents(test.Result());
+    ASSERT_EQ(events.size(), 2u);
+    auto level_group =
+        FindLoadingEvent(events, Source::TOTAL_USER_WAIT_FOR_GROUP, kLevel);
+    EXPECT_FALSE(level_group.group_id.empty());
+    EXPECT_EQ(FindLoadingEvent(events, Source::DEVICE_STORAGE).group_id,
+              level_group.group_id);
+}
+
 }  // namespace tuningfork_test
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// The JNI types named by the Tuning Fork headers, for the tests that don't use
+// Java and are built on a Linux host.
+
+#include <stdint.h>
+
+typedef uint8_t jboolean;
+typedef int8_t jbyte;
+typedef int32_t jint;
+typedef int64_t jlong;
+
+class _jobject {};
+class _jclass : public _jobject {};
+class _jstring : public _jobject {};
+class _jbyteArray : public _jobject {};
+
+typedef _jobject* jobject;
+typedef _jclass* jclass;
+typedef _jstring* jstring;
+typedef _jbyteArray* jbyteArray;
+
+struct _jfieldID;
+typedef struct _jfieldID* jfieldID;
+struct _jmethodID;
+typedef struct _jmethodID* jmethodID;
+
+struct _JNIEnv;
+typedef _JNIEnv JNIEnv;
+struct _JavaVM;
+typedef _JavaVM JavaVM;
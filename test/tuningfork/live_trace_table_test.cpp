@@ -0,0 +1,204 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/live_trace_table.h"
+#include "gtest/gtest.h"
+
+using namespace tuningfork;
+using std::chrono::milliseconds;
+
+namespace {
+
+constexpr int kNumThreads = 4;
+
+TimePoint T(int ms) { return TimePoint(milliseconds(ms)); }
+
+}  // namespace
+
+TEST(LiveTraceTable, StartAndEnd) {
+    LiveTraceTable table;
+    TraceHandle h1, h2;
+    auto id = MetricId::FrameTime(3, 1);
+    ASSERT_EQ(table.Start(id, T(10), h1), TUNINGFORK_ERROR_OK);
+    // A nested trace with the same key.
+    ASSERT_EQ(table.Start(id, T(15), h2), TUNINGFORK_ERROR_OK);
+    EXPECT_NE(h1, h2);
+    EXPECT_NE(h1, 0u);
+    EXPECT_EQ(table.Size(), 2u);
+
+    MetricId ended;
+    Duration dt;
+    ASSERT_EQ(table.End(h2, T(20), ended, dt), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(ended, id);
+    EXPECT_EQ(dt, milliseconds(5));
+    ASSERT_EQ(table.End(h1, T(30), ended, dt), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(dt, milliseconds(20));
+    EXPECT_EQ(table.Size(), 0u);
+
+    // Ending twice, or with a stale handle after the slot was reused, fails.
+    EXPECT_EQ(table.End(h1, T(40), ended, dt),
+              TUNINGFORK_ERROR_INVALID_TRACE_HANDLE);
+    TraceHandle h3;
+    ASSERT_EQ(table.Start(id, T(50), h3), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(LiveTraceTable::SlotIndex(h3), LiveTraceTable::SlotIndex(h1));
+    EXPECT_EQ(table.End(h1, T(60), ended, dt),
+              TUNINGFORK_ERROR_INVALID_TRACE_HANDLE);
+    EXPECT_EQ(table.End(h3, T(60), ended, dt), TUNINGFORK_ERROR_OK);
+
+    EXPECT_EQ(table.End(0, T(60), ended, dt),
+              TUNINGFORK_ERROR_INVALID_TRACE_HANDLE);
+    EXPECT_EQ(table.End(~0ull, T(60), ended, dt),
+              TUNINGFORK_ERROR_INVALID_TRACE_HANDLE);
+}
+
+TEST(LiveTraceTable, Full) {
+    LiveTraceTable table;
+    std::vector<TraceHandle> handles(LiveTraceTable::kNumSlots);
+    for (auto& h : handles)
+        ASSERT_EQ(table.Start(MetricId{}, T(0), h), TUNINGFORK_ERROR_OK);
+    TraceHandle h;
+    EXPECT_EQ(table.Start(MetricId{}, T(0), h),
+              TUNINGFORK_ERROR_NO_MORE_SPACE_FOR_FRAME_TIME_DATA);
+
+    MetricId id;
+    Duration dt;
+    ASSERT_EQ(table.End(handles[100], T(1), id, dt), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(table.Start(MetricId{}, T(0), h), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(table.Size(), LiveTraceTable::kNumSlots);
+}
+
+// Each thread starts nested traces of its own key, ends some of them itself
+// and hands the others to its neighbour, which races with a second ender.
+TEST(LiveTraceTable, Stress) {
+    LiveTraceTable table;
+    constexpr int kIterations = 10000;
+    constexpr int kDepth = 4;
+    constexpr size_t kMaxPending = 64;
+    struct Mailbox {
+        std::mutex mutex;
+        std::vector<TraceHandle> handles;
+    };
+    std::vector<Mailbox> mailboxes(kNumThreads);
+    std::atomic<int> ended{0}, double_ended{0}, errors{0};
+    std::atomic<int> done{0};
+
+    auto end_from_mailbox = [&](Mailbox& mailbox) {
+        std::vector<TraceHandle> handles;
+        {
+            std::lock_guard<std::mutex> lock(mailbox.mutex);
+            handles.swap(mailbox.handles);
+        }
+        for (auto h : handles) {
+            MetricId id;
+            Duration dt;
+            if (table.End(h, T(2), id, dt) == TUNINGFORK_ERROR_OK) {
+                ++ended;
+                if (dt != milliseconds(1)) ++errors;
+            } else {
+                ++double_ended;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            auto key = MetricId::FrameTime(0, t);
+            Mailbox& neighbour = mailboxes[(t + 1) % kNumThreads];
+            for (int i = 0; i < kIterations; ++i) {
+                TraceHandle stack[kDepth];
+                for (int d = 0; d < kDepth; ++d) {
+                    if (table.Start(key, T(1), stack[d]) !=
+                        TUNINGFORK_ERROR_OK)
+                        ++errors;
+                }
+                // The innermost trace is ended on another thread, twice.
+                while (true) {
+                    {
+                        std::lock_guard<std::mutex> lock(neighbour.mutex);
+                        // Don't fill the table with traces waiting to end.
+                        if (neighbour.handles.size() < kMaxPending) {
+                            neighbour.handles.push_back(stack[kDepth - 1]);
+                            neighbour.handles.push_back(stack[kDepth - 1]);
+                            break;
+                        }
+                    }
+                    end_from_mailbox(mailboxes[t]);
+                    std::this_thread::yield();
+                }
+                for (int d = kDepth - 2; d >= 0; --d) {
+                    MetricId id;
+                    Duration dt;
+                    if (table.End(stack[d], T(2), id, dt) !=
+                            TUNINGFORK_ERROR_OK ||
+                        !(id == key))
+                        ++errors;
+                    else
+                        ++ended;
+                }
+                end_from_mailbox(mailboxes[t]);
+            }
+            ++done;
+            while (done < kNumThreads) {
+                end_from_mailbox(mailboxes[t]);
+                std::this_thread::yield();
+            }
+            end_from_mailbox(mailboxes[t]);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(errors, 0);
+    EXPECT_EQ(ended, kNumThreads * kIterations * kDepth);
+    EXPECT_EQ(double_ended, kNumThreads * kIterations);
+    EXPECT_EQ(table.Size(), 0u);
+}
+
+TEST(LiveTraceTable, Benchmark) {
+    LiveTraceTable table;
+    constexpr int kPairsPerThread = 1000000;
+    for (int num_threads = 1; num_threads <= kNumThreads; num_threads *= 2) {
+        std::atomic<int> errors{0};
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t]() {
+                auto key = MetricId::FrameTime(0, t);
+                for (int i = 0; i < kPairsPerThread; ++i) {
+                    TraceHandle h;
+                    MetricId id;
+                    Duration dt;
+                    if (table.Start(key, T(0), h) != TUNINGFORK_ERROR_OK ||
+                        table.End(h, T(1), id, dt) != TUNINGFORK_ERROR_OK)
+                        ++errors;
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        printf("%d thread(s): %.1fM start/end pairs per second\n", num_threads,
+               num_threads * kPairsPerThread / elapsed.count() / 1e6);
+        EXPECT_EQ(errors, 0);
+    }
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <map>
+#include <string>
+
+#include "core/loading_span_tree.h"
+#include "gtest/gtest.h"
+
+using namespace tuningfork;
+using std::chrono::milliseconds;
+
+namespace {
+
+typedef LoadingSpanTree::SpanId SpanId;
+
+ProcessTime Ms(int ms) { return milliseconds(ms); }
+
+SpanId BeginSpan(LoadingSpanTree& tree, const std::string& name,
+                 SpanId parent, int start_ms) {
+    SpanId span = 0;
+    EXPECT_EQ(tree.Begin(name, parent, Ms(start_ms), span),
+              TUNINGFORK_ERROR_OK);
+    return span;
+}
+
+void EndSpan(LoadingSpanTree& tree, SpanId span, int end_ms) {
+    EXPECT_EQ(tree.End(span, Ms(end_ms)), TUNINGFORK_ERROR_OK);
+}
+
+SpanId AddSpan(LoadingSpanTree& tree, const std::string& name, SpanId parent,
+               int start_ms, int end_ms) {
+    SpanId span = BeginSpan(tree, name, parent, start_ms);
+    EndSpan(tree, span, end_ms);
+    return span;
+}
+
+std::map<std::string, LoadingSpanSummary::Span> ByName(
+    const LoadingSpanSummary& summary) {
+    std::map<std::string, LoadingSpanSummary::Span> spans;
+    for (auto& span : summary.slowest_spans) spans[span.name] = span;
+    return spans;
+}
+
+}  // namespace
+
+TEST(LoadingSpanTree, SequentialSpans) {
+    LoadingSpanTree tree(Ms(0));
+    auto a = BeginSpan(tree, "a", LoadingSpanTree::kRoot, 0);
+    AddSpan(tree, "a1", a, 0, 20);
+    AddSpan(tree, "a2", a, 20, 40);
+    EndSpan(tree, a, 40);
+    AddSpan(tree, "b", LoadingSpanTree::kRoot, 40, 100);
+
+    auto summary = tree.Summarize(Ms(100), 10);
+    EXPECT_EQ(summary.span_count, 4u);
+    EXPECT_EQ(summary.max_depth, 2u);
+    EXPECT_EQ(summary.critical_path, Ms(100));
+    EXPECT_DOUBLE_EQ(summary.parallelism, 1.0);
+    ASSERT_EQ(summary.slowest_spans.size(), 4u);
+    EXPECT_EQ(summary.slowest_spans[0].name, "b");
+    EXPECT_EQ(summary.slowest_spans[1].name, "a");
+    auto spans = ByName(summary);
+    EXPECT_EQ(spans["a"].self_time, Ms(0));
+    EXPECT_EQ(spans["a1"].self_time, Ms(20));
+    EXPECT_EQ(spans["a1"].depth, 2u);
+    for (auto& span : summary.slowest_spans)
+        EXPECT_TRUE(span.on_critical_path) << span.name;
+}
+
+// A 12 second level load where textures dominate.
+TEST(LoadingSpanTree, ParallelSpans) {
+    LoadingSpanTree tree(Ms(0));
+    const auto root = LoadingSpanTree::kRoot;
+    AddSpan(tree, "geometry", root, 0, 8000);
+    AddSpan(tree, "audio", root, 0, 3000);
+    auto textures = BeginSpan(tree, "textures", root, 0);
+    AddSpan(tree, "decode", textures, 0, 5000);
+    AddSpan(tree, "upload", textures, 5000, 11000);
+    EndSpan(tree, textures, 11000);
+    AddSpan(tree, "shaders", root, 11000, 12000);
+
+    auto summary = tree.Summarize(Ms(12000), 5);
+    EXPECT_EQ(summary.span_count, 6u);
+    EXPECT_EQ(summary.critical_path, Ms(12000));
+    // Self times: geometry 8s, audio 3s, decode 5s, upload 6s, shaders 1s.
+    EXPECT_DOUBLE_EQ(summary.parallelism, 23.0 / 12.0);
+
+    // Only the top 5 are uploaded: shaders is left out.
+    ASSERT_EQ(summary.slowest_spans.size(), 5u);
+    std::vector<std::string> names;
+    for (auto& span : summary.slowest_spans) names.push_back(span.name);
+    EXPECT_EQ(names, (std::vector<std::string>{"textures", "geometry",
+                                               "upload", "decode", "audio"}));
+    auto spans = ByName(summary);
+    EXPECT_TRUE(spans["textures"].on_critical_path);
+    EXPECT_TRUE(spans["decode"].on_critical_path);
+    EXPECT_TRUE(spans["upload"].on_critical_path);
+    EXPECT_FALSE(spans["geometry"].on_critical_path);
+    EXPECT_FALSE(spans["audio"].on_critical_path);
+    EXPECT_EQ(spans["textures"].self_time, Ms(0));
+    EXPECT_EQ(spans["geometry"].interval.End(), Ms(8000));
+}
+
+TEST(LoadingSpanTree, GapsAndUnfinishedSpans) {
+    LoadingSpanTree tree(Ms(100));
+    const auto root = LoadingSpanTree::kRoot;
+    AddSpan(tree, "first", root, 100, 200);
+    SpanId open;
+    ASSERT_EQ(tree.Begin("unfinished", root, Ms(300), open),
+              TUNINGFORK_ERROR_OK);
+
+    // The unfinished span ends with the group. The gap between the spans is
+    // the group's self time.
+    auto summary = tree.Summarize(Ms(500), 5);
+    EXPECT_EQ(summary.critical_path, Ms(300));
+    EXPECT_DOUBLE_EQ(summary.parallelism, 1.0);
+    auto spans = ByName(summary);
+    EXPECT_EQ(spans["unfinished"].interval.End(), Ms(500));
+    EXPECT_EQ(spans["unfinished"].self_time, Ms(200));
+}
+
+TEST(LoadingSpanTree, Errors) {
+    LoadingSpanTree tree(Ms(0));
+    SpanId span, child;
+    EXPECT_EQ(tree.Begin("bad parent", 1, Ms(0), span),
+              TUNINGFORK_ERROR_INVALID_LOADING_HANDLE);
+    ASSERT_EQ(tree.Begin(std::string(100, 'x'), LoadingSpanTree::kRoot, Ms(0),
+                         span),
+              TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(tree.End(LoadingSpanTree::kRoot, Ms(10)),
+              TUNINGFORK_ERROR_INVALID_LOADING_HANDLE);
+    EXPECT_EQ(tree.End(span, Ms(10)), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(tree.End(span, Ms(20)), TUNINGFORK_ERROR_INVALID_LOADING_HANDLE);
+    EXPECT_EQ(tree.Begin("child of ended", span, Ms(20), child),
+              TUNINGFORK_ERROR_INVALID_LOADING_HANDLE);
+    auto summary = tree.Summarize(Ms(20), 5);
+    ASSERT_EQ(summary.slowest_spans.size(), 1u);
+    EXPECT_EQ(summary.slowest_spans[0].name.size(),
+              LoadingSpanTree::kMaxNameLength);
+}
+
+TEST(LoadingSpanTree, BoundedSize) {
+    // A deep chain of nested spans, then more spans than fit.
+    LoadingSpanTree tree(Ms(0));
+    const int kDepth = 100;
+    SpanId parent = LoadingSpanTree::kRoot;
+    for (int i = 0; i < kDepth; ++i) {
+        SpanId span;
+        ASSERT_EQ(tree.Begin("nested", parent, Ms(i), span),
+                  TUNINGFORK_ERROR_OK);
+        parent = span;
+    }
+    const int kExtra = 10;
+    int added = kDepth;
+    for (; added < int(LoadingSpanTree::kMaxSpans) + kExtra; ++added) {
+        SpanId span;
+        auto err = tree.Begin("leaf", LoadingSpanTree::kRoot, Ms(added), span);
+        if (added < int(LoadingSpanTree::kMaxSpans)) {
+            ASSERT_EQ(err, TUNINGFORK_ERROR_OK);
+            tree.End(span, Ms(added + 1));
+        } else {
+            EXPECT_EQ(err,
+                      TUNINGFORK_ERROR_NO_MORE_SPACE_FOR_LOADING_TIME_DATA);
+        }
+    }
+    EXPECT_EQ(tree.Size(), LoadingSpanTree::kMaxSpans);
+
+    auto summary = tree.Summarize(Ms(1000), 3);
+    EXPECT_EQ(summary.span_count, LoadingSpanTree::kMaxSpans);
+    EXPECT_EQ(summary.dropped_spans, uint32_t(kExtra));
+    EXPECT_EQ(summary.max_depth, uint32_t(kDepth));
+    ASSERT_EQ(summary.slowest_spans.size(), 3u);
+    // The unfinished nested spans end with the group: the outermost one is
+    // the slowest and covers the whole group.
+    EXPECT_EQ(summary.slowest_spans[0].depth, 1u);
+    EXPECT_EQ(summary.slowest_spans[0].interval.Duration(), Ms(1000));
+    EXPECT_TRUE(summary.slowest_spans[0].on_critical_path);
+    EXPECT_EQ(summary.critical_path, Ms(1000));
+}
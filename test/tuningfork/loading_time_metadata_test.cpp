@@ -0,0 +1,230 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "core/loading_time_metadata_registry.h"
+#include "gtest/gtest.h"
+
+using namespace tuningfork;
+
+namespace {
+
+constexpr uint32_t kNumEntries = 100000;
+constexpr uint32_t kBatchSize = 10000;
+
+LoadingTimeMetadataWithGroup TestMetadata(uint32_t n) {
+    LoadingTimeMetadataWithGroup md{};
+    md.metadata.state = LoadingTimeMetadata::LoadingState::COLD_START;
+    md.metadata.source = LoadingTimeMetadata::LoadingSource::NETWORK;
+    md.metadata.network_latency_ns = n;
+    md.group_id = "group" + std::to_string(n % 7);
+    return md;
+}
+
+}  // namespace
+
+TEST(LoadingTimeMetadata, ForwardAndReverseLookup) {
+    LoadingTimeMetadataRegistry registry;
+    LoadingTimeMetadataId id1, id2, id3;
+    EXPECT_EQ(registry.GetOrRegister(TestMetadata(1), id1),
+              TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(registry.GetOrRegister(TestMetadata(2), id2),
+              TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(registry.GetOrRegister(TestMetadata(1), id3),
+              TUNINGFORK_ERROR_OK);
+    EXPECT_NE(id1, 0) << "Id 0 is reserved";
+    EXPECT_EQ(id1, id3) << "Same metadata, same id";
+    EXPECT_NE(id1, id2);
+    EXPECT_EQ(registry.Size(), 2u);
+
+    LoadingTimeMetadataWithGroup md;
+    ASSERT_EQ(registry.Get(id2, md), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(md, TestMetadata(2));
+    EXPECT_EQ(registry.Get(0, md), TUNINGFORK_ERROR_BAD_PARAMETER);
+    EXPECT_EQ(registry.Get(id2 + 1, md), TUNINGFORK_ERROR_BAD_PARAMETER);
+    EXPECT_EQ(registry.Get(60000, md), TUNINGFORK_ERROR_BAD_PARAMETER);
+}
+
+TEST(LoadingTimeMetadata, RunsOutOfIds) {
+    LoadingTimeMetadataRegistry registry;
+    LoadingTimeMetadataId id;
+    for (uint32_t n = 1; n < LoadingTimeMetadataRegistry::kMaxIds; ++n) {
+        ASSERT_EQ(registry.GetOrRegister(TestMetadata(n), id),
+                  TUNINGFORK_ERROR_OK);
+        ASSERT_EQ(id, n);
+    }
+    // Ids used to wrap around silently.
+    EXPECT_EQ(registry.GetOrRegister(TestMetadata(0), id),
+              TUNINGFORK_ERROR_NO_MORE_SPACE_FOR_LOADING_TIME_DATA);
+    EXPECT_EQ(registry.GetOrRegister(TestMetadata(1), id),
+              TUNINGFORK_ERROR_OK);
+
+    // Recycling after an upload frees the ids of metadata that wasn't used.
+    registry.Recycle({});
+    registry.Recycle({});
+    EXPECT_EQ(registry.Size(), 0u);
+    EXPECT_EQ(registry.GetOrRegister(TestMetadata(0), id),
+              TUNINGFORK_ERROR_OK);
+}
+
+TEST(LoadingTimeMetadata, RecyclesIdsAfterEachUpload) {
+    LoadingTimeMetadataRegistry registry;
+    std::vector<LoadingTimeMetadataId> ids(kNumEntries);
+    LoadingTimeMetadataId pinned_id;
+    ASSERT_EQ(registry.GetOrRegister(TestMetadata(kNumEntries), pinned_id),
+              TUNINGFORK_ERROR_OK);
+
+    for (uint32_t batch = 0; batch < kNumEntries; batch += kBatchSize) {
+        for (uint32_t n = batch; n < batch + kBatchSize; ++n) {
+            ASSERT_EQ(registry.GetOrRegister(TestMetadata(n), ids[n]),
+                      TUNINGFORK_ERROR_OK);
+        }
+        // The session with this batch is submitted, then the next one after
+        // it's serialized: only then can the batch's ids be reused.
+        registry.Recycle({pinned_id});
+        for (uint32_t n = batch; n < batch + kBatchSize; ++n) {
+            LoadingTimeMetadataWithGroup md;
+            ASSERT_EQ(registry.Get(ids[n], md), TUNINGFORK_ERROR_OK);
+            ASSERT_EQ(md, TestMetadata(n));
+        }
+        registry.Recycle({pinned_id});
+        EXPECT_EQ(registry.Size(), 1u);
+    }
+
+    LoadingTimeMetadataWithGroup md;
+    ASSERT_EQ(registry.Get(pinned_id, md), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(md, TestMetadata(kNumEntries));
+    EXPECT_EQ(registry.Get(ids[0], md), TUNINGFORK_ERROR_BAD_PARAMETER);
+
+    // Metadata used in every session keeps its id.
+    LoadingTimeMetadataId id, same_id;
+    ASSERT_EQ(registry.GetOrRegister(TestMetadata(1), id),
+              TUNINGFORK_ERROR_OK);
+    for (int i = 0; i < 3; ++i) {
+        registry.Recycle({});
+        ASSERT_EQ(registry.GetOrRegister(TestMetadata(1), same_id),
+                  TUNINGFORK_ERROR_OK);
+        EXPECT_EQ(same_id, id);
+    }
+}
+
+TEST(LoadingTimeMetadata, KeepsPinnedIdsForTheNextSession) {
+    LoadingTimeMetadataRegistry registry;
+    LoadingTimeMetadataId live_id, other_id;
+    ASSERT_EQ(registry.GetOrRegister(TestMetadata(1), live_id),
+              TUNINGFORK_ERROR_OK);
+    ASSERT_EQ(registry.GetOrRegister(TestMetadata(2), other_id),
+              TUNINGFORK_ERROR_OK);
+
+    // A loading event is live when its session is submitted.
+    registry.Recycle({live_id});
+    // It ends without looking up its metadata, recording in the next session,
+    // which is submitted in turn while still waiting to be serialized.
+    registry.Recycle({});
+    LoadingTimeMetadataWithGroup md;
+    ASSERT_EQ(registry.Get(live_id, md), TUNINGFORK_ERROR_OK);
+    EXPECT_EQ(md, TestMetadata(1));
+    EXPECT_EQ(registry.Get(other_id, md), TUNINGFORK_ERROR_BAD_PARAMETER);
+
+    // Using the id keeps it for the session it was used in.
+    EXPECT_EQ(registry.Use(live_id), TUNINGFORK_ERROR_OK);
+    registry.Recycle({});
+    EXPECT_EQ(registry.Get(live_id, md), TUNINGFORK_ERROR_OK);
+    registry.Recycle({});
+    EXPECT_EQ(registry.Get(live_id, md), TUNINGFORK_ERROR_BAD_PARAMETER);
+    EXPECT_EQ(registry.Use(live_id), TUNINGFORK_ERROR_BAD_PARAMETER);
+    EXPECT_EQ(registry.Size(), 0u);
+}
+
+TEST(LoadingTimeMetadata, GetDuringRecycle) {
+    LoadingTimeMetadataRegistry registry;
+    constexpr uint32_t kEntries = 1000;
+    std::atomic<bool> running{true};
+    std::atomic<int> errors{0};
+    // The uploader reads ids while they are being freed and reused.
+    std::thread reader([&]() {
+        while (running) {
+            for (LoadingTimeMetadataId id = 1; id <= kEntries; ++id) {
+                LoadingTimeMetadataWithGroup md;
+                if (registry.Get(id, md) == TUNINGFORK_ERROR_OK &&
+                    md.group_id.compare(0, 5, "group") != 0)
+                    errors++;
+            }
+        }
+    });
+    for (int round = 0; round < 200; ++round) {
+        for (uint32_t n = 0; n < kEntries; ++n) {
+            LoadingTimeMetadataId id;
+            registry.GetOrRegister(TestMetadata(round * kEntries + n), id);
+        }
+        registry.Recycle({});
+    }
+    running = false;
+    reader.join();
+    EXPECT_EQ(errors, 0);
+}
+
+TEST(LoadingTimeMetadata, ConcurrentLookups) {
+    LoadingTimeMetadataRegistry registry;
+    constexpr uint32_t kHotEntries = 64;
+    constexpr int kLookupsPerThread = 200000;
+    std::vector<LoadingTimeMetadataWithGroup> hot;
+    std::vector<LoadingTimeMetadataId> hot_ids(kHotEntries);
+    for (uint32_t n = 0; n < kHotEntries; ++n) {
+        hot.push_back(TestMetadata(n));
+        ASSERT_EQ(registry.GetOrRegister(hot[n], hot_ids[n]),
+                  TUNINGFORK_ERROR_OK);
+    }
+
+    std::atomic<int> errors{0};
+    std::atomic<bool> running{true};
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < kLookupsPerThread; ++i) {
+                LoadingTimeMetadataId id;
+                uint32_t n = (i + t) % kHotEntries;
+                if (registry.GetOrRegister(hot[n], id) != TUNINGFORK_ERROR_OK ||
+                    id != hot_ids[n])
+                    errors++;
+            }
+        });
+    }
+    // Register and recycle cold metadata meanwhile, as uploads would.
+    std::thread uploader([&]() {
+        uint32_t n = kHotEntries;
+        while (running) {
+            LoadingTimeMetadataId id;
+            for (int i = 0; i < 100; ++i)
+                registry.GetOrRegister(TestMetadata(n++), id);
+            registry.Recycle(hot_ids);
+        }
+    });
+    for (auto& thread : threads) thread.join();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    running = false;
+    uploader.join();
+
+    printf("%d lookups in %.1fms\n", 4 * kLookupsPerThread,
+           std::chrono::duration<double, std::milli>(elapsed).count());
+    EXPECT_EQ(errors, 0);
+}
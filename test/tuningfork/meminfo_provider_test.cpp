@@ -0,0 +1,72 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The /proc readers of DefaultMemInfoProvider against snapshots of /proc from
+// different devices.
+
+#include <unistd.h>
+
+#include "core/memory_telemetry.h"
+#include "device_snapshots.h"
+#include "gtest/gtest.h"
+#include "procfs.h"
+
+using namespace tuningfork;
+using namespace gamesdk_test;
+
+namespace {
+
+constexpr uint64_t kBytesInKb = 1024;
+
+// Reads the files of pid rather than those of the pid from JNI.
+class SnapshotMemInfoProvider : public DefaultMemInfoProvider {
+   public:
+    explicit SnapshotMemInfoProvider(pid_t pid) {
+        memInfo.pid = static_cast<uint32_t>(pid);
+        memInfo.oom_score = -1;
+    }
+    bool IsSwapTotalAvailable() const { return memInfo.swapTotal.second; }
+};
+
+}  // namespace
+
+TEST(MemInfoProvider, DeviceSnapshots) {
+    for (const DeviceSnapshot& snapshot : DeviceSnapshots()) {
+        SCOPED_TRACE(snapshot.name);
+        ScopedDeviceSnapshot root(snapshot, getpid());
+        SnapshotMemInfoProvider provider(getpid());
+
+        provider.UpdateMemInfo();
+        EXPECT_TRUE(provider.IsSwapTotalAvailable());
+        EXPECT_EQ(provider.GetMemInfoSwapTotalBytes(),
+                  snapshot.swap_total_kb * kBytesInKb);
+
+        provider.UpdateOomScore();
+        EXPECT_EQ(provider.GetMemInfoOomScore(),
+                  static_cast<uint64_t>(snapshot.oom_score));
+    }
+}
+
+TEST(MemInfoProvider, MissingFiles) {
+    gamesdk::procfs::SetRoot("/nonexistent");
+    SnapshotMemInfoProvider provider(getpid());
+    provider.UpdateMemInfo();
+    EXPECT_FALSE(provider.IsSwapTotalAvailable());
+    // The last score read is kept.
+    provider.UpdateOomScore();
+    EXPECT_EQ(provider.GetMemInfoOomScore(), static_cast<uint64_t>(-1));
+    gamesdk::procfs::SetRoot(nullptr);
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "procfs.h"
+
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace gamesdk::procfs;
+
+namespace {
+
+#ifdef __ANDROID__
+constexpr char kSnapshotDir[] = "/data/local/tmp/tuningfork_procfs_test";
+#else
+constexpr char kSnapshotDir[] = "/tmp/tuningfork_procfs_test";
+#endif
+
+// Writes a file of the snapshot, creating the directories on the way.
+void WriteSnapshotFile(const std::string& path, const std::string& contents) {
+    std::string full_path = kSnapshotDir + path;
+    for (size_t i = 1; i < full_path.size(); ++i) {
+        if (full_path[i] == '/') mkdir(full_path.substr(0, i).c_str(), 0770);
+    }
+    FILE* f = fopen(full_path.c_str(), "w");
+    ASSERT_NE(f, nullptr) << full_path;
+    fwrite(contents.data(), 1, contents.size(), f);
+    fclose(f);
+}
+
+class SnapshotRoot {
+   public:
+    SnapshotRoot() { EXPECT_TRUE(SetRoot(kSnapshotDir)); }
+    ~SnapshotRoot() { SetRoot(nullptr); }
+};
+
+std::vector<std::string> ReadLines(const std::string& path) {
+    std::vector<std::string> lines;
+    LineReader reader(path.c_str());
+    EXPECT_TRUE(reader.IsOpen());
+    size_t length;
+    while (const char* line = reader.NextLine(&length)) {
+        EXPECT_EQ(length, strlen(line));
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+TEST(ProcfsTest, ReadLines) {
+    WriteSnapshotFile("/proc/lines", "first\n\nthird\nlast without newline");
+    SnapshotRoot root;
+    std::vector<std::string> expected = {"first", "", "third",
+                                         "last without newline"};
+    EXPECT_EQ(ReadLines("/proc/lines"), expected);
+}
+
+TEST(ProcfsTest, LinesAcrossBufferBoundaries) {
+    std::string contents;
+    std::vector<std::string> expected;
+    for (int i = 0; i < 1000; ++i) {
+        std::string line(i % 37, 'a' + i % 26);
+        contents += line + "\n";
+        expected.push_back(line);
+    }
+    WriteSnapshotFile("/proc/many_lines", contents);
+    SnapshotRoot root;
+    EXPECT_EQ(ReadLines("/proc/many_lines"), expected);
+}
+
+TEST(ProcfsTest, LongLinesAreTruncated) {
+    std::string long_line(LineReader::kBufferSize + 100, 'x');
+    WriteSnapshotFile("/proc/long_line", "a\n" + long_line + "\nb\n");
+    SnapshotRoot root;
+    std::vector<std::string> expected = {
+        "a", long_line.substr(0, LineReader::kBufferSize), "b"};
+    EXPECT_EQ(ReadLines("/proc/long_line"), expected);
+}
+
+TEST(ProcfsTest, ParseField) {
+    Field field;
+    ASSERT_TRUE(ParseField("MemTotal:        7764144 kB", &field));
+    EXPECT_TRUE(field.KeyIs("MemTotal"));
+    EXPECT_TRUE(field.has_number);
+    EXPECT_EQ(field.number, 7764144);
+    EXPECT_TRUE(field.in_kb);
+
+    ASSERT_TRUE(ParseField("HugePages_Total:       0", &field));
+    EXPECT_TRUE(field.KeyIs("HugePages_Total"));
+    EXPECT_TRUE(field.has_number);
+    EXPECT_FALSE(field.in_kb);
+
+    ASSERT_TRUE(ParseField("processor\t: 7", &field));
+    EXPECT_TRUE(field.KeyIs("processor"));
+    EXPECT_FALSE(field.KeyIs("process"));
+    EXPECT_EQ(field.number, 7);
+
+    ASSERT_TRUE(ParseField("Hardware\t: Qualcomm Technologies, Inc", &field));
+    EXPECT_TRUE(field.KeyIs("Hardware"));
+    EXPECT_FALSE(field.has_number);
+    EXPECT_STREQ(field.value, "Qualcomm Technologies, Inc");
+
+    ASSERT_TRUE(ParseField("Cpus_allowed_list:\t0-7", &field));
+    EXPECT_FALSE(field.in_kb);
+
+    EXPECT_FALSE(ParseField("no colon", &field));
+}
+
+TEST(ProcfsTest, ReadFromSnapshot) {
+    WriteSnapshotFile("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq",
+                      "1804800\n");
+    WriteSnapshotFile("/sys/devices/system/cpu/possible", "0-7\n");
+    WriteSnapshotFile("/sys/devices/system/cpu/cpu1/cpufreq/cpuinfo_max_freq",
+                      "not a number\n");
+    SnapshotRoot root;
+    EXPECT_STREQ(GetRoot(), kSnapshotDir);
+
+    int64_t value = 0;
+    EXPECT_TRUE(
+        ReadInt64("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq",
+                  &value));
+    EXPECT_EQ(value, 1804800);
+    EXPECT_FALSE(ReadInt64(
+        "/sys/devices/system/cpu/cpu1/cpufreq/cpuinfo_max_freq", &value));
+    EXPECT_FALSE(ReadInt64("/sys/does/not/exist", &value));
+
+    char buffer[16];
+    EXPECT_TRUE(ReadLine("/sys/devices/system/cpu/possible", buffer,
+                         sizeof(buffer)));
+    EXPECT_STREQ(buffer, "0-7");
+
+    LineReader missing("/proc/does_not_exist");
+    EXPECT_FALSE(missing.IsOpen());
+    EXPECT_EQ(missing.NextLine(), nullptr);
+}
+
+TEST(ProcfsTest, RootTooLong) {
+    std::string root(kMaxPathLength, 'r');
+    EXPECT_FALSE(SetRoot(root.c_str()));
+    EXPECT_STREQ(GetRoot(), "");
+}
+
+}  // namespace